@@ -46,6 +46,7 @@
 #include "no_os_error.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
+#include <string.h>
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -53,6 +54,7 @@
 #define AD74413R_FRAME_SIZE 		4
 #define AD74413R_CRC_POLYNOMIAL 	0x7
 #define AD74413R_DIN_DEBOUNCE_LEN 	NO_OS_BIT(5)
+#define AD74413R_CONV_CTRL_EN_MASK	NO_OS_GENMASK(7, 0)
 
 /******************************************************************************/
 /************************ Variable Declarations ******************************/
@@ -201,6 +203,23 @@ int ad74413r_dac_voltage_to_code(uint32_t mvolts, uint32_t *code)
 	return 0;
 }
 
+/**
+ * @brief Mask the ADC_RDY interrupt while the driver uses the SPI bus from
+ * thread context, if continuous conversions are running.
+ * @param desc - The device structure.
+ * @param mask - true to mask, false to unmask.
+ */
+static void ad74413r_cont_mask(struct ad74413r_desc *desc, bool mask)
+{
+	if (!desc->cont)
+		return;
+
+	if (mask)
+		no_os_irq_disable(desc->cont->irq_ctrl, desc->cont->irq_id);
+	else
+		no_os_irq_enable(desc->cont->irq_ctrl, desc->cont->irq_id);
+}
+
 /**
  * @brief Load the address and value in a communication buffer using
  * the format that the device expects.
@@ -233,15 +252,87 @@ int ad74413r_reg_read_raw(struct ad74413r_desc *desc, uint32_t addr,
 	 */
 	ad74413r_format_reg_write(AD74413R_READ_SELECT, addr, desc->comm_buff);
 
+	/* A burst read from ADC_RDY must not split the two frames */
+	ad74413r_cont_mask(desc, true);
+
 	ret = no_os_spi_write_and_read(desc->comm_desc, desc->comm_buff,
 				       AD74413R_FRAME_SIZE);
 	if (ret)
-		return ret;
+		goto out;
 
 	/* Make sure that NOP sequence is written for the second frame */
 	ad74413r_format_reg_write(AD74413R_NOP, AD74413R_NOP, val);
 
-	return no_os_spi_write_and_read(desc->comm_desc, val, AD74413R_FRAME_SIZE);
+	ret = no_os_spi_write_and_read(desc->comm_desc, val,
+				       AD74413R_FRAME_SIZE);
+out:
+	ad74413r_cont_mask(desc, false);
+
+	return ret;
+}
+
+/**
+ * @brief Build a pipelined burst read. Each frame selects the next register
+ * while clocking out the one selected by the previous frame, a final NOP frame
+ * clocks out the last register.
+ * @param addr - The registers' addresses.
+ * @param nb - The number of registers.
+ * @param tx - Transmit buffer of (nb + 1) frames.
+ * @param first - Receive buffer of the first frame, which is discarded.
+ * @param frames - Receive buffer of nb frames.
+ * @param msgs - nb + 1 SPI messages.
+ */
+static void ad74413r_burst_prepare(const uint8_t *addr, uint32_t nb,
+				   uint8_t *tx, uint8_t *first,
+				   uint8_t *frames, struct no_os_spi_msg *msgs)
+{
+	uint32_t i;
+
+	for (i = 0; i <= nb; i++) {
+		if (i < nb)
+			ad74413r_format_reg_write(AD74413R_READ_SELECT, addr[i],
+						  &tx[i * AD74413R_FRAME_SIZE]);
+		else
+			ad74413r_format_reg_write(AD74413R_NOP, AD74413R_NOP,
+						  &tx[i * AD74413R_FRAME_SIZE]);
+
+		msgs[i] = (struct no_os_spi_msg) {
+			.tx_buff = &tx[i * AD74413R_FRAME_SIZE],
+			.rx_buff = i ? &frames[(i - 1) * AD74413R_FRAME_SIZE] :
+			first,
+			.bytes_number = AD74413R_FRAME_SIZE,
+			.cs_change = 1,
+		};
+	}
+}
+
+/**
+ * @brief Read the raw communication frames of multiple registers in a single
+ * SPI transfer of nb + 1 frames, instead of 2 * nb frames.
+ * @param desc - The device structure.
+ * @param addr - The registers' addresses.
+ * @param nb - The number of registers, at most AD74413R_BURST_MAX.
+ * @param frames - nb raw comm frames of 4 bytes (the CRC is not checked).
+ * @return 0 in case of success, negative error otherwise.
+ */
+int ad74413r_burst_read_raw(struct ad74413r_desc *desc, const uint8_t *addr,
+			    uint32_t nb, uint8_t *frames)
+{
+	struct no_os_spi_msg msgs[AD74413R_BURST_MAX + 1];
+	uint8_t tx[(AD74413R_BURST_MAX + 1) * AD74413R_FRAME_SIZE];
+	uint8_t first[AD74413R_FRAME_SIZE];
+	int ret;
+
+	if (!desc || !addr || !frames || !nb || nb > AD74413R_BURST_MAX)
+		return -EINVAL;
+
+	ad74413r_burst_prepare(addr, nb, tx, first, frames, msgs);
+
+	ad74413r_cont_mask(desc, true);
+	ret = no_os_spi_transfer(desc->comm_desc, msgs, nb + 1);
+	ad74413r_cont_mask(desc, false);
+
+	return ret;
 }
 
 /**
@@ -253,10 +344,17 @@ int ad74413r_reg_read_raw(struct ad74413r_desc *desc, uint32_t addr,
  */
 int ad74413r_reg_write(struct ad74413r_desc *desc, uint32_t addr, uint16_t val)
 {
+	int ret;
+
 	ad74413r_format_reg_write(addr, val, desc->comm_buff);
 
-	return no_os_spi_write_and_read(desc->comm_desc, desc->comm_buff,
-					AD74413R_FRAME_SIZE);
+	/* The ADC_RDY burst read must not interleave with this frame */
+	ad74413r_cont_mask(desc, true);
+	ret = no_os_spi_write_and_read(desc->comm_desc, desc->comm_buff,
+				       AD74413R_FRAME_SIZE);
+	ad74413r_cont_mask(desc, false);
+
+	return ret;
 }
 
 /**
@@ -716,6 +814,11 @@ int ad74413r_get_adc_single(struct ad74413r_desc *desc, uint32_t ch,
 	uint8_t nb_active_channels;
 	enum ad74413r_rejection rejection;
 
+	/* The sequencer is already running, no need to restart it */
+	if (desc->cont)
+		return ad74413r_cont_latest(desc, is_diag ?
+					    ch + AD74413R_N_CHANNELS : ch, val);
+
 	if (is_diag)
 		ret = ad74413r_set_diag_channel_enable(desc, ch, true);
 	else
@@ -1167,6 +1270,293 @@ int ad74413r_set_therm_rst(struct ad74413r_desc *desc, bool enable)
 	return ad74413r_reg_write(desc, AD74413R_THERM_RST, enable);
 }
 
+/**
+ * @brief ADC_RDY handler, reads the results of the whole conversion sequence
+ * in one burst and pushes them to the slot rings.
+ * @param ctx - The device structure.
+ */
+static void ad74413r_cont_irq(void *ctx)
+{
+	struct ad74413r_desc *desc = ctx;
+	struct ad74413r_cont *cont = desc->cont;
+	uint8_t *frame;
+	uint16_t val;
+	uint32_t i;
+	uint8_t slot;
+
+	if (!cont)
+		return;
+
+	if (no_os_spi_transfer(desc->comm_desc, cont->msgs, cont->nb_slots + 1))
+		return;
+
+	cont->stats.sequences++;
+	for (i = 0; i < cont->nb_slots; i++) {
+		frame = &cont->rx[(i + 1) * AD74413R_FRAME_SIZE];
+		if (no_os_crc8(_crc_table, frame, 3, 0) != frame[3]) {
+			cont->stats.crc_errors++;
+			continue;
+		}
+
+		slot = cont->slots[i];
+		val = no_os_get_unaligned_be16(&frame[1]);
+		cont->latest[slot] = val;
+		cont->valid |= NO_OS_BIT(slot);
+		if (no_os_lf_ring_write(cont->rings[slot], &val))
+			cont->stats.overflows++;
+	}
+}
+
+/**
+ * @brief Free the continuous conversion state.
+ * @param cont - The continuous conversion state.
+ */
+static void ad74413r_cont_free(struct ad74413r_cont *cont)
+{
+	uint32_t i;
+
+	for (i = 0; i < AD74413R_CONT_SLOTS; i++)
+		if (cont->rings[i])
+			no_os_lf_ring_remove(cont->rings[i]);
+
+	no_os_free(cont);
+}
+
+/**
+ * @brief Start continuous conversions. The conversion sequence is configured
+ * once and the results of all the enabled channels are read in a single burst
+ * on each ADC_RDY falling edge, instead of restarting the sequencer for each
+ * read. While running, ad74413r_get_adc_single() and ad74413r_adc_get_value()
+ * return the last result without any SPI traffic.
+ * @param desc - The device structure.
+ * @param param - Continuous conversion parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ad74413r_cont_start(struct ad74413r_desc *desc,
+			struct ad74413r_cont_param *param)
+{
+	uint8_t addr[AD74413R_CONT_SLOTS];
+	struct ad74413r_cont *cont;
+	uint8_t mask;
+	uint32_t i;
+	int ret;
+
+	if (!desc || !param || !param->irq_ctrl)
+		return -EINVAL;
+
+	if (desc->cont)
+		return -EBUSY;
+
+	mask = (param->ch_mask & NO_OS_GENMASK(AD74413R_N_CHANNELS - 1, 0)) |
+	       (param->diag_mask << AD74413R_N_CHANNELS);
+	if (!mask)
+		return -EINVAL;
+
+	cont = no_os_calloc(1, sizeof(*cont));
+	if (!cont)
+		return -ENOMEM;
+
+	for (i = 0; i < AD74413R_CONT_SLOTS; i++) {
+		if (!(mask & NO_OS_BIT(i)))
+			continue;
+
+		ret = no_os_lf_ring_init(&cont->rings[i], param->ring_size,
+					 sizeof(uint16_t));
+		if (ret)
+			goto free_cont;
+
+		cont->slots[cont->nb_slots] = i;
+		if (i < AD74413R_N_CHANNELS)
+			addr[cont->nb_slots] = AD74413R_ADC_RESULT(i);
+		else
+			addr[cont->nb_slots] =
+				AD74413R_DIAG_RESULT(i - AD74413R_N_CHANNELS);
+		cont->nb_slots++;
+	}
+
+	cont->slot_mask = mask;
+	cont->irq_ctrl = param->irq_ctrl;
+	cont->irq_id = param->adc_rdy_irq;
+	ad74413r_burst_prepare(addr, cont->nb_slots, cont->tx, cont->rx,
+			       &cont->rx[AD74413R_FRAME_SIZE], cont->msgs);
+
+	/* CH_EN and DIAG_EN are contiguous, enable the sequence at once */
+	ret = ad74413r_reg_update(desc, AD74413R_ADC_CONV_CTRL,
+				  AD74413R_CONV_CTRL_EN_MASK, mask);
+	if (ret)
+		goto free_cont;
+
+	for (i = 0; i < AD74413R_N_CHANNELS; i++)
+		desc->channel_configs[i].enabled = !!(mask & NO_OS_BIT(i));
+
+	cont->irq_cb.callback = ad74413r_cont_irq;
+	cont->irq_cb.ctx = desc;
+	cont->irq_cb.event = NO_OS_EVT_GPIO;
+	cont->irq_cb.peripheral = NO_OS_GPIO_IRQ;
+
+	ret = no_os_irq_register_callback(cont->irq_ctrl, cont->irq_id,
+					  &cont->irq_cb);
+	if (ret)
+		goto disable_ch;
+
+	ret = no_os_irq_trigger_level_set(cont->irq_ctrl, cont->irq_id,
+					  NO_OS_IRQ_EDGE_FALLING);
+	if (ret)
+		goto unregister;
+
+	ret = ad74413r_set_adc_conv_seq(desc, AD74413R_START_CONT);
+	if (ret)
+		goto unregister;
+
+	/* From now on, thread context reads mask the ADC_RDY interrupt */
+	desc->cont = cont;
+
+	ret = no_os_irq_enable(cont->irq_ctrl, cont->irq_id);
+	if (ret)
+		goto stop;
+
+	return 0;
+
+stop:
+	desc->cont = NULL;
+	ad74413r_set_adc_conv_seq(desc, AD74413R_STOP_PWR_DOWN);
+unregister:
+	no_os_irq_unregister_callback(cont->irq_ctrl, cont->irq_id,
+				      &cont->irq_cb);
+disable_ch:
+	ad74413r_reg_update(desc, AD74413R_ADC_CONV_CTRL,
+			    AD74413R_CONV_CTRL_EN_MASK, 0);
+	for (i = 0; i < AD74413R_N_CHANNELS; i++)
+		desc->channel_configs[i].enabled = false;
+free_cont:
+	ad74413r_cont_free(cont);
+
+	return ret;
+}
+
+/**
+ * @brief Stop continuous conversions, power down the ADC and disable the
+ * channels enabled by ad74413r_cont_start().
+ * @param desc - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ad74413r_cont_stop(struct ad74413r_desc *desc)
+{
+	struct ad74413r_cont *cont;
+	uint32_t i;
+	int ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	cont = desc->cont;
+	if (!cont)
+		return 0;
+
+	ret = no_os_irq_disable(cont->irq_ctrl, cont->irq_id);
+	if (ret)
+		return ret;
+
+	ret = no_os_irq_unregister_callback(cont->irq_ctrl, cont->irq_id,
+					    &cont->irq_cb);
+	if (ret)
+		return ret;
+
+	desc->cont = NULL;
+	ad74413r_cont_free(cont);
+
+	ret = ad74413r_set_adc_conv_seq(desc, AD74413R_STOP_PWR_DOWN);
+	if (ret)
+		return ret;
+
+	ret = ad74413r_reg_update(desc, AD74413R_ADC_CONV_CTRL,
+				  AD74413R_CONV_CTRL_EN_MASK, 0);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < AD74413R_N_CHANNELS; i++)
+		desc->channel_configs[i].enabled = false;
+
+	return 0;
+}
+
+/**
+ * @brief Pop the oldest results of a slot.
+ * @param desc - The device structure.
+ * @param slot - The ADC channel index, or AD74413R_N_CHANNELS + the diagnostic
+ * channel index.
+ * @param vals - Output raw results.
+ * @param nb - Maximum number of results.
+ * @return The number of results read, negative error code otherwise.
+ */
+int ad74413r_cont_read(struct ad74413r_desc *desc, uint32_t slot,
+		       uint16_t *vals, uint32_t nb)
+{
+	if (!desc || !vals || slot >= AD74413R_CONT_SLOTS)
+		return -EINVAL;
+
+	if (!desc->cont)
+		return -ENODEV;
+
+	if (!(desc->cont->slot_mask & NO_OS_BIT(slot)))
+		return -EBUSY;
+
+	return no_os_lf_ring_read_n(desc->cont->rings[slot], vals, nb);
+}
+
+/**
+ * @brief Get the last result of a slot.
+ * @param desc - The device structure.
+ * @param slot - The ADC channel index, or AD74413R_N_CHANNELS + the diagnostic
+ * channel index.
+ * @param val - Output raw result.
+ * @return 0 in case of success, -EAGAIN if no conversion finished yet,
+ * negative error code otherwise.
+ */
+int ad74413r_cont_latest(struct ad74413r_desc *desc, uint32_t slot,
+			 uint16_t *val)
+{
+	if (!desc || !val || slot >= AD74413R_CONT_SLOTS)
+		return -EINVAL;
+
+	if (!desc->cont)
+		return -ENODEV;
+
+	/* The slot is not part of the running sequence */
+	if (!(desc->cont->slot_mask & NO_OS_BIT(slot)))
+		return -EBUSY;
+
+	if (!(desc->cont->valid & NO_OS_BIT(slot)))
+		return -EAGAIN;
+
+	*val = desc->cont->latest[slot];
+
+	return 0;
+}
+
+/**
+ * @brief Get the continuous conversion statistics.
+ * @param desc - The device structure.
+ * @param stats - Output statistics.
+ * @param clear - Reset the statistics after reading them.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ad74413r_cont_stats_get(struct ad74413r_desc *desc,
+			    struct ad74413r_cont_stats *stats, bool clear)
+{
+	if (!desc || !stats)
+		return -EINVAL;
+
+	if (!desc->cont)
+		return -ENODEV;
+
+	*stats = desc->cont->stats;
+	if (clear)
+		memset(&desc->cont->stats, 0, sizeof(desc->cont->stats));
+
+	return 0;
+}
+
 /**
  * @brief Initialize the device structure.
  * @param desc - The device structure to be initialized.
@@ -1237,6 +1627,10 @@ int ad74413r_remove(struct ad74413r_desc *desc)
 	if (!desc)
 		return -EINVAL;
 
+	ret = ad74413r_cont_stop(desc);
+	if (ret)
+		return ret;
+
 	/* Perform a reset to bring the device in the default state */
 	ret = ad74413r_reset(desc);
 	if (ret)
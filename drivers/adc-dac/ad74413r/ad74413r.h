@@ -43,10 +43,18 @@
 #include "stdbool.h"
 #include "no_os_spi.h"
 #include "no_os_gpio.h"
+#include "no_os_irq.h"
+#include "no_os_lf_ring.h"
 
 #define AD74413R_N_CHANNELS             4
 #define AD74413R_N_DIAG_CHANNELS	4
 
+/** Result slots of the continuous engine: ADC_RESULTx, then DIAG_RESULTx */
+#define AD74413R_CONT_SLOTS		(AD74413R_N_CHANNELS + \
+					 AD74413R_N_DIAG_CHANNELS)
+/** Maximum number of registers read in one burst */
+#define AD74413R_BURST_MAX		AD74413R_CONT_SLOTS
+
 #define AD74413R_CH_A                   0
 #define AD74413R_CH_B                   1
 #define AD74413R_CH_C                   2
@@ -349,6 +357,61 @@ union ad74413r_live_status {
 	uint16_t value;
 };
 
+/**
+ * @brief Continuous conversion parameters.
+ */
+struct ad74413r_cont_param {
+	/** Interrupt controller the ADC_RDY pin is connected to */
+	struct no_os_irq_ctrl_desc *irq_ctrl;
+	/** ADC_RDY interrupt ID (GPIO number) */
+	uint32_t adc_rdy_irq;
+	/** I/O channels to convert, bit x for channel x */
+	uint8_t ch_mask;
+	/** Diagnostic channels to convert, bit x for diagnostic x */
+	uint8_t diag_mask;
+	/** Samples kept for each channel, power of two */
+	uint32_t ring_size;
+};
+
+/**
+ * @brief Continuous conversion statistics.
+ */
+struct ad74413r_cont_stats {
+	/** Conversion sequences read */
+	uint32_t sequences;
+	/** Results dropped because of a readback CRC error */
+	uint32_t crc_errors;
+	/** Results dropped because the channel ring was full */
+	uint32_t overflows;
+};
+
+/**
+ * @brief Continuous conversion state, results are read in one burst on each
+ * ADC_RDY falling edge.
+ */
+struct ad74413r_cont {
+	struct no_os_irq_ctrl_desc *irq_ctrl;
+	uint32_t irq_id;
+	struct no_os_callback_desc irq_cb;
+	/** Number of enabled result slots */
+	uint8_t nb_slots;
+	/** Bit mask of the enabled result slots */
+	uint8_t slot_mask;
+	/** Enabled result slots, in burst order */
+	uint8_t slots[AD74413R_CONT_SLOTS];
+	/** Read selects of the burst, followed by a NOP frame */
+	uint8_t tx[(AD74413R_BURST_MAX + 1) * 4];
+	uint8_t rx[(AD74413R_BURST_MAX + 1) * 4];
+	struct no_os_spi_msg msgs[AD74413R_BURST_MAX + 1];
+	/** Results of each slot */
+	struct no_os_lf_ring *rings[AD74413R_CONT_SLOTS];
+	/** Last result of each slot */
+	volatile uint16_t latest[AD74413R_CONT_SLOTS];
+	/** Slots holding at least one result */
+	volatile uint8_t valid;
+	struct ad74413r_cont_stats stats;
+};
+
 /**
  * @brief AD74413r device descriptor.
  */
@@ -358,6 +421,8 @@ struct ad74413r_desc {
 	uint8_t comm_buff[4];
 	struct ad74413r_channel_config channel_configs[AD74413R_N_CHANNELS];
 	struct no_os_gpio_desc *reset_gpio;
+	/** Continuous conversion state, NULL when not running */
+	struct ad74413r_cont *cont;
 };
 
 /** Converts a millivolt value in the corresponding DAC 13 bit code */
@@ -377,6 +442,10 @@ int ad74413r_reg_read_raw(struct ad74413r_desc *, uint32_t, uint8_t *);
 /** Read a register's value */
 int ad74413r_reg_read(struct ad74413r_desc *, uint32_t, uint16_t *);
 
+/** Read the raw frames of multiple registers in one pipelined burst */
+int ad74413r_burst_read_raw(struct ad74413r_desc *, const uint8_t *, uint32_t,
+			    uint8_t *);
+
 /** Update a register's field */
 int ad74413r_reg_update(struct ad74413r_desc *, uint32_t, uint16_t,
 			uint16_t);
@@ -521,6 +590,23 @@ int ad74413r_dac_slew_disable(struct ad74413r_desc *, uint32_t);
 /** Enable or disable the higher thermal reset */
 int ad74413r_set_therm_rst(struct ad74413r_desc *, bool);
 
+/** Start continuous conversions, results are read on ADC_RDY */
+int ad74413r_cont_start(struct ad74413r_desc *, struct ad74413r_cont_param *);
+
+/** Stop continuous conversions and power down the ADC */
+int ad74413r_cont_stop(struct ad74413r_desc *);
+
+/** Pop results of a slot (ADC channel or AD74413R_N_CHANNELS + diag) */
+int ad74413r_cont_read(struct ad74413r_desc *, uint32_t, uint16_t *,
+		       uint32_t);
+
+/** Get the last result of a slot */
+int ad74413r_cont_latest(struct ad74413r_desc *, uint32_t, uint16_t *);
+
+/** Get the continuous conversion statistics */
+int ad74413r_cont_stats_get(struct ad74413r_desc *,
+			    struct ad74413r_cont_stats *, bool);
+
 /** Initialize the device structure */
 int ad74413r_init(struct ad74413r_desc **, struct ad74413r_init_param *);
 
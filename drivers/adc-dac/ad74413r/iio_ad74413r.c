@@ -47,12 +47,16 @@
 #include "no_os_units.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
+#include "no_os_delay.h"
 #include "ad74413r.h"
 #include "iio_ad74413r.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
+/* A result is produced at least every 8 channels * 100 ms (10 SPS) */
+#define AD74413R_IIO_CONT_TIMEOUT_US	1000000
+
 #define AD74413R_ADC_CHANNEL(type, attrs)                       \
         {                                                       \
                 .ch_type = type,                                \
@@ -1357,6 +1361,45 @@ free_channels:
 	return ret;
 }
 
+/**
+ * @brief Start the continuous conversion engine for the enabled IIO channels.
+ * @param iio_desc - The iio device structure.
+ * @param mask - Bit mask that specifies the enabled channels.
+ * @return 0 in case of success, error code otherwise
+ */
+static int ad74413r_iio_cont_start(struct ad74413r_iio_desc *iio_desc,
+				   uint32_t mask)
+{
+	struct ad74413r_cont_param param = *iio_desc->cont_param;
+	uint32_t ch;
+	size_t i;
+	int ret;
+
+	param.ch_mask = 0;
+	param.diag_mask = 0;
+	for (i = 0; i < AD74413R_N_CHANNELS + AD74413R_N_DIAG_CHANNELS; i++) {
+		if (!(mask & NO_OS_BIT(i)))
+			continue;
+
+		ret = _get_ch_by_idx(iio_desc->iio_dev, i, &ch);
+		if (ret)
+			return ret;
+
+		if (ch < AD74413R_N_CHANNELS)
+			param.ch_mask |= NO_OS_BIT(ch);
+		else
+			param.diag_mask |= NO_OS_BIT(ch - AD74413R_N_CHANNELS);
+	}
+
+	ret = ad74413r_cont_start(iio_desc->ad74413r_desc, &param);
+	if (ret)
+		return ret;
+
+	iio_desc->conv_state = AD74413R_START_CONT;
+
+	return 0;
+}
+
 /**
  * @brief Enable IIO channels and start the ADC conversions in continuous mode.
  * @param dev - The iio device structure.
@@ -1373,6 +1416,9 @@ static int ad74413r_iio_update_channels(void *dev, uint32_t mask)
 	iio_desc->active_channels = mask;
 	iio_desc->no_of_active_channels = no_os_hweight8(mask);
 
+	if (iio_desc->cont_param && !iio_desc->trigger)
+		return ad74413r_iio_cont_start(iio_desc, mask);
+
 	for (i = 0; i < AD74413R_N_CHANNELS + AD74413R_N_DIAG_CHANNELS; i++) {
 		if (mask & NO_OS_BIT(i)) {
 			ret = _get_ch_by_idx(iio_desc->iio_dev, i, &ch);
@@ -1417,6 +1463,16 @@ static int ad74413r_iio_buffer_disable(void *dev)
 	int ret;
 	int i;
 
+	if (iio_desc->ad74413r_desc->cont) {
+		ret = ad74413r_cont_stop(iio_desc->ad74413r_desc);
+		if (ret)
+			return ret;
+
+		iio_desc->conv_state = AD74413R_STOP_PWR_DOWN;
+
+		return 0;
+	}
+
 	ret = ad74413r_set_adc_conv_seq(iio_desc->ad74413r_desc,
 					AD74413R_STOP_PWR_DOWN);
 	if (ret)
@@ -1439,6 +1495,73 @@ static int ad74413r_iio_buffer_disable(void *dev)
 	return 0;
 }
 
+/**
+ * @brief Wait for and pop the next result of a continuous conversion slot.
+ * @param desc - The device structure.
+ * @param slot - The result slot.
+ * @param val - Output raw result.
+ * @return 0 in case of success, an error code otherwise
+ */
+static int ad74413r_iio_cont_pop(struct ad74413r_desc *desc, uint32_t slot,
+				 uint16_t *val)
+{
+	uint32_t timeout = AD74413R_IIO_CONT_TIMEOUT_US;
+	int ret;
+
+	while (true) {
+		ret = ad74413r_cont_read(desc, slot, val, 1);
+		if (ret)
+			return ret < 0 ? ret : 0;
+
+		if (!timeout--)
+			return -ETIMEDOUT;
+
+		no_os_udelay(1);
+	}
+}
+
+/**
+ * @brief Read a number of samples from the channel rings filled on ADC_RDY by
+ * the continuous conversion engine, in the raw frame layout of the scan type.
+ * @param iio_desc - The iio device structure.
+ * @param buf - Buffer to store the samples in.
+ * @param samples - The number of samples
+ * @return The number of samples in case of success, an error code otherwise
+ */
+static int ad74413r_iio_cont_read_samples(struct ad74413r_iio_desc *iio_desc,
+		uint32_t *buf, uint32_t samples)
+{
+	struct ad74413r_desc *desc = iio_desc->ad74413r_desc;
+	uint32_t i, chan_i, ch;
+	uint32_t j = 0;
+	uint16_t code;
+	uint8_t *frame;
+	int ret;
+
+	for (i = 0; i < samples; i++) {
+		for (chan_i = 0; chan_i < AD74413R_N_CHANNELS +
+		     AD74413R_N_DIAG_CHANNELS; chan_i++) {
+			if (!(iio_desc->active_channels & NO_OS_BIT(chan_i)))
+				continue;
+
+			ret = _get_ch_by_idx(iio_desc->iio_dev, chan_i, &ch);
+			if (ret)
+				return ret;
+
+			ret = ad74413r_iio_cont_pop(desc, ch, &code);
+			if (ret)
+				return ret;
+
+			frame = (uint8_t *)&buf[j++];
+			frame[0] = 0;
+			no_os_put_unaligned_be16(code, &frame[1]);
+			frame[3] = 0;
+		}
+	}
+
+	return samples;
+}
+
 /**
  * @brief Read a number of samples from each enabled channel.
  * @param dev - The iio device structure.
@@ -1454,6 +1577,9 @@ static int ad74413r_iio_read_samples(void *dev, uint32_t *buf, uint32_t samples)
 	uint32_t i, chan_i;
 	struct ad74413r_iio_desc *iio_desc = dev;
 
+	if (iio_desc->ad74413r_desc->cont)
+		return ad74413r_iio_cont_read_samples(iio_desc, buf, samples);
+
 	for (i = 0; i < samples; i++) {
 		for (chan_i = 0; chan_i < AD74413R_N_CHANNELS; chan_i++) {
 			if (iio_desc->active_channels & NO_OS_BIT(chan_i)) {
@@ -1471,7 +1597,8 @@ static int ad74413r_iio_read_samples(void *dev, uint32_t *buf, uint32_t samples)
 }
 
 /**
- * @brief Read a sample for each enabled channel.
+ * @brief Read a sample for each enabled channel, all the result registers are
+ * read in a single burst.
  * @param dev_data - The iio device data structure.
  * @return 0 in case of success, an error code otherwise.
  */
@@ -1480,49 +1607,53 @@ static int ad74413r_iio_trigger_handler(struct iio_device_data *dev_data)
 	int ret;
 	uint32_t i;
 	uint32_t ch;
-	uint32_t diag_ch_idx;
+	uint32_t nb = 0;
 	uint32_t digital_val;
-	uint8_t buff[32] = {0};
-	uint32_t buffer_idx = 0;
+	uint8_t addr[AD74413R_BURST_MAX];
+	uint8_t ch_idx[AD74413R_BURST_MAX];
+	uint8_t buff[AD74413R_BURST_MAX * 4] = {0};
 	struct ad74413r_iio_desc *iio_desc;
 	struct ad74413r_channel_config *config;
-	struct ad74413r_desc *desc;
+	uint8_t *frame;
 
 	iio_desc = dev_data->dev;
-	desc = iio_desc->ad74413r_desc;
 	config = iio_desc->channel_configs;
 
-	for (i = 0; i < AD74413R_N_CHANNELS + AD74413R_N_CHANNELS; i++) {
-		if (iio_desc->active_channels & NO_OS_BIT(i)) {
-			ret = _get_ch_by_idx(iio_desc->iio_dev, i, &ch);
-			if (ret)
-				continue;
+	for (i = 0; i < AD74413R_N_CHANNELS + AD74413R_N_DIAG_CHANNELS; i++) {
+		if (!(iio_desc->active_channels & NO_OS_BIT(i)))
+			continue;
 
-			if (ch < AD74413R_N_DIAG_CHANNELS) {
-				if (config[ch].function == AD74413R_DIGITAL_INPUT ||
-				    config[ch].function == AD74413R_DIGITAL_INPUT_LOOP) {
-					ret = ad74413r_reg_read_raw(desc, AD74413R_DIN_COMP_OUT,
-								    &buff[buffer_idx]);
-					digital_val = no_os_field_get(AD74413R_DIN_COMP_CH(ch),
-								      buff[buffer_idx + 2]);
-					buff[buffer_idx + 1] = 0x0;
-					buff[buffer_idx + 2] = !!digital_val;
-				} else {
-					ret = ad74413r_reg_read_raw(desc, AD74413R_ADC_RESULT(ch),
-								    &buff[buffer_idx]);
-				}
-			} else {
-				diag_ch_idx = ch - AD74413R_N_DIAG_CHANNELS;
-				ret = ad74413r_reg_read_raw(desc,
-							    AD74413R_DIAG_RESULT(diag_ch_idx),
-							    &buff[buffer_idx]);
-			}
+		ret = _get_ch_by_idx(iio_desc->iio_dev, i, &ch);
+		if (ret)
+			continue;
 
-			if (ret)
-				return ret;
+		if (ch >= AD74413R_N_CHANNELS)
+			addr[nb] = AD74413R_DIAG_RESULT(ch -
+							AD74413R_N_CHANNELS);
+		else if (config[ch].function == AD74413R_DIGITAL_INPUT ||
+			 config[ch].function == AD74413R_DIGITAL_INPUT_LOOP)
+			addr[nb] = AD74413R_DIN_COMP_OUT;
+		else
+			addr[nb] = AD74413R_ADC_RESULT(ch);
+		ch_idx[nb++] = ch;
+	}
 
-			buffer_idx += 4;
-		}
+	if (nb) {
+		ret = ad74413r_burst_read_raw(iio_desc->ad74413r_desc, addr, nb,
+					      buff);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < nb; i++) {
+		if (addr[i] != AD74413R_DIN_COMP_OUT)
+			continue;
+
+		frame = &buff[i * 4];
+		digital_val = no_os_field_get(AD74413R_DIN_COMP_CH(ch_idx[i]),
+					      frame[2]);
+		frame[1] = 0x0;
+		frame[2] = !!digital_val;
 	}
 
 	return iio_buffer_push_scan(dev_data->buffer, buff);
@@ -1568,6 +1699,7 @@ int ad74413r_iio_init(struct ad74413r_iio_desc **iio_desc,
 		goto err;
 
 	descriptor->trigger = init_param->trigger;
+	descriptor->cont_param = init_param->cont_param;
 	descriptor->conv_state = AD74413R_STOP_PWR_DOWN;
 
 	*iio_desc = descriptor;
@@ -88,6 +88,8 @@ struct ad74413r_iio_desc {
 	enum ad74413r_conv_seq conv_state;
 	struct ad74413r_diag_channel_config
 		diag_channel_configs[AD74413R_N_DIAG_CHANNELS];
+	/** Continuous conversion parameters, used when there is no trigger */
+	struct ad74413r_cont_param *cont_param;
 };
 
 /**
@@ -99,6 +101,12 @@ struct ad74413r_iio_desc_init_param {
 	struct iio_hw_trig *trigger;
 	struct ad74413r_diag_channel_config
 		diag_channel_configs[AD74413R_N_DIAG_CHANNELS];
+	/**
+	 * Optional, when set (and no trigger is used) the buffer is filled by
+	 * the ADC_RDY driven continuous conversion engine. The channel masks
+	 * are taken from the enabled IIO channels.
+	 */
+	struct ad74413r_cont_param *cont_param;
 };
 
 /**
@@ -911,6 +911,72 @@ static void _ad4170_digif_remove(struct ad4170_dev *dev)
 	dev->digif = false;
 }
 
+/**
+ * @brief Decode a block of continuous read frames captured by the streaming
+ * engine.
+ * @param dev - The device structure.
+ * @param frames - Raw frames.
+ * @param frame_size - Size of a frame in bytes.
+ * @param nb_frames - Number of frames.
+ * @param samples - Output conversion results.
+ * @return Number of valid samples.
+ */
+static int32_t ad4170_stream_decode(void *dev, const uint8_t *frames,
+				    uint8_t frame_size, uint32_t nb_frames,
+				    uint32_t *samples)
+{
+	struct ad4170_dev *d = dev;
+	bool crc = d->spi_settings.crc_enabled;
+	uint32_t n, nb = 0;
+
+	for (n = 0; n < nb_frames; n++, frames += frame_size) {
+		if (crc && no_os_crc8(ad4170_crc8, frames, frame_size - 1,
+				      AD4170_CRC8_INITIAL_VALUE) !=
+		    frames[frame_size - 1])
+			continue;
+
+		samples[nb++] = ((uint32_t)frames[0] << 16) |
+				(frames[1] << 8) | frames[2];
+	}
+
+	return nb;
+}
+
+/**
+ * @brief Fill the streaming engine parameters for continuous read mode. The
+ * device must already be in continuous read mode, the frames are read on each
+ * falling edge of the DIG_AUX1 RDY signal. The interrupt controller, block
+ * size and sink are left to the caller.
+ * @param dev - The device structure.
+ * @param param - Streaming engine parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ad4170_stream_param_get(struct ad4170_dev *dev,
+			    struct no_os_adc_stream_init_param *param)
+{
+	if (!dev || !param)
+		return -EINVAL;
+
+	if (dev->config.adc_ctrl.cont_read != AD4170_CONT_READ_ON)
+		return -EACCES;
+
+	if (!dev->gpio_dig_aux1
+	    || (dev->config.pin_muxing.dig_aux1_ctrl != AD4170_DIG_AUX1_RDY))
+		return -ENOTSUP;
+
+	param->spi_desc = dev->spi_desc;
+	param->drdy_irq = dev->gpio_dig_aux1->number;
+	param->drdy_trig = NO_OS_IRQ_EDGE_FALLING;
+	param->cmd_size = 0;
+	param->frame_size = 3;
+	param->frame_size += (uint8_t)dev->config.adc_ctrl.cont_read_status_en;
+	param->frame_size += (uint8_t)dev->spi_settings.crc_enabled;
+	param->dev = dev;
+	param->decode = ad4170_stream_decode;
+
+	return 0;
+}
+
 /**
  * @brief Exit continuous read mode
  * @param dev - The device structure.
@@ -44,6 +44,7 @@
 #include "no_os_util.h"
 #include "no_os_gpio.h"
 #include "no_os_spi.h"
+#include "no_os_adc_stream.h"
 
 #ifndef ECOMM
 #define ECOMM 70
@@ -1094,6 +1095,8 @@ int ad4170_read32(struct ad4170_dev *dev, uint32_t *pbuf,
 int ad4170_continuous_read(struct ad4170_dev *dev, uint32_t *data_out,
 			   uint8_t *status_out, uint16_t nb_samples);
 int ad4170_continuous_read_exit(struct ad4170_dev *dev);
+int ad4170_stream_param_get(struct ad4170_dev *dev,
+			    struct no_os_adc_stream_init_param *param);
 int ad4170_continuous_transmit_exit(struct ad4170_dev *dev);
 int ad4170_reset(struct ad4170_dev *dev);
 int ad4170_get_status(struct ad4170_dev *dev, uint16_t *status);
@@ -47,6 +47,7 @@
 #include "no_os_delay.h"
 #include "no_os_alloc.h"
 #include "no_os_error.h"
+#include "no_os_crc8.h"
 
 /*
  * Post reset delay required to ensure all internal config done
@@ -55,6 +56,8 @@
  */
 #define AD7124_POST_RESET_DELAY	4
 
+NO_OS_DECLARE_CRC8_TABLE(ad7124_crc8);
+
 /***************************************************************************//**
  * @brief Reads the value of the specified register without checking if the
  *        device is ready to accept user requests.
@@ -1008,6 +1011,7 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 
 	dev->regs = init_param->regs;
 	dev->spi_rdy_poll_cnt = init_param->spi_rdy_poll_cnt;
+	dev->stream_init = init_param->stream_init;
 
 	/* Initialize the SPI communication. */
 	ret = no_os_spi_init(&dev->spi_desc, init_param->spi_init);
@@ -1125,6 +1129,87 @@ error_dev:
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief Decode a block of data register reads captured by the streaming
+ *        engine.
+ * @param dev        - The device structure.
+ * @param frames     - Raw frames, command byte included.
+ * @param frame_size - Size of a frame in bytes.
+ * @param nb_frames  - Number of frames.
+ * @param samples    - Output conversion results.
+ * @return Returns the number of valid samples.
+*******************************************************************************/
+static int32_t ad7124_stream_decode(void *dev, const uint8_t *frames,
+				    uint8_t frame_size, uint32_t nb_frames,
+				    uint32_t *samples)
+{
+	struct ad7124_dev *d = dev;
+	uint8_t size = d->regs[AD7124_Data].size;
+	bool status = d->regs[AD7124_ADC_Control].value &
+		      AD7124_ADC_CTRL_REG_DATA_STATUS;
+	bool crc = d->use_crc == AD7124_USE_CRC;
+	uint8_t cmd_crc, i;
+	uint32_t n, nb = 0;
+	uint32_t data;
+
+	/* The command byte is the same for every frame */
+	cmd_crc = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+		  AD7124_COMM_REG_RA(AD7124_DATA_REG);
+	cmd_crc = no_os_crc8(ad7124_crc8, &cmd_crc, 1, 0);
+
+	for (n = 0; n < nb_frames; n++, frames += frame_size) {
+		if (crc && no_os_crc8(ad7124_crc8, frames + 1, frame_size - 1,
+				      cmd_crc))
+			continue;
+
+		if (status && (frames[1 + size] & AD7124_STATUS_REG_ERROR_FLAG))
+			continue;
+
+		data = 0;
+		for (i = 1; i <= size; i++)
+			data = (data << 8) | frames[i];
+		samples[nb++] = data;
+	}
+
+	return nb;
+}
+
+/***************************************************************************//**
+ * @brief Fill the streaming engine parameters for reading the data register
+ *        on each DRDY (DOUT/RDY) falling edge. The ADC must be set in
+ *        continuous conversion mode before the stream is started. The
+ *        interrupt controller, DRDY line, block size and sink are left to the
+ *        caller.
+ * @param dev   - The device structure.
+ * @param param - Streaming engine parameters.
+ * @return Returns 0 for success or negative error code otherwise.
+*******************************************************************************/
+int ad7124_stream_param_get(struct ad7124_dev *dev,
+			    struct no_os_adc_stream_init_param *param)
+{
+	if (!dev || !param)
+		return -EINVAL;
+
+	no_os_crc8_populate_msb(ad7124_crc8,
+				AD7124_CRC8_POLYNOMIAL_REPRESENTATION);
+
+	param->spi_desc = dev->spi_desc;
+	param->drdy_trig = NO_OS_IRQ_EDGE_FALLING;
+	param->cmd[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+			AD7124_COMM_REG_RA(AD7124_DATA_REG);
+	param->cmd_size = 1;
+	param->frame_size = 1 + dev->regs[AD7124_Data].size;
+	if (dev->regs[AD7124_ADC_Control].value &
+	    AD7124_ADC_CTRL_REG_DATA_STATUS)
+		param->frame_size++;
+	if (dev->use_crc == AD7124_USE_CRC)
+		param->frame_size++;
+	param->dev = dev;
+	param->decode = ad7124_stream_decode;
+
+	return 0;
+}
+
 /***************************************************************************//**
  * @brief Free the resources allocated by ad7124_setup().
  * @param dev - The device structure.
@@ -48,6 +48,7 @@
 #include "no_os_spi.h"
 #include "no_os_delay.h"
 #include "no_os_util.h"
+#include "no_os_adc_stream.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -504,6 +505,8 @@ struct ad7124_dev {
 	struct ad7124_channel_setup setups[AD7124_MAX_SETUPS];
 	/* Channel Mapping*/
 	struct ad7124_channel_map chan_map[AD7124_MAX_CHANNELS];
+	/* DRDY stream for the IIO buffer reads, NULL to poll each sample */
+	struct no_os_adc_stream_init_param *stream_init;
 };
 
 struct ad7124_init_param {
@@ -525,6 +528,11 @@ struct ad7124_init_param {
 	struct ad7124_channel_setup setups[AD7124_MAX_SETUPS];
 	/* Channel Mapping*/
 	struct ad7124_channel_map chan_map[AD7124_MAX_CHANNELS];
+	/*
+	 * DRDY stream for the IIO buffer reads, NULL to poll each sample. Only
+	 * irq_ctrl, drdy_irq, block_size and dma are used.
+	 */
+	struct no_os_adc_stream_init_param *stream_init;
 };
 
 /******************************************************************************/
@@ -657,6 +665,10 @@ int ad7124_set_power_mode(struct ad7124_dev *device,
 int32_t ad7124_setup(struct ad7124_dev **device,
 		     struct ad7124_init_param *init_param);
 
+/* Fill the streaming engine parameters for data register reads. */
+int ad7124_stream_param_get(struct ad7124_dev *dev,
+			    struct no_os_adc_stream_init_param *param);
+
 /* Free the resources allocated by ad7124_setup(). */
 int32_t ad7124_remove(struct ad7124_dev *dev);
 
@@ -49,8 +49,16 @@
 #include "iio.h"
 #include "iio_ad7124.h"
 #include "no_os_util.h"
+#include "no_os_delay.h"
 #include "ad7124.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Stream polls of 100 us without a new conversion before giving up */
+#define IIO_AD7124_STREAM_TIMEOUT	20000
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -705,6 +713,114 @@ static int32_t iio_ad7124_read_samples(void *dev, int32_t *buff,
 	return nb_samples;
 }
 
+/**
+ * @brief Fill the IIO buffer through the DRDY driven stream. The stream
+ * pushes whole blocks, so the block size is reduced until the blocks fill the
+ * buffer exactly.
+ * @param [in] desc - Device descriptor.
+ * @param [in] buffer - IIO buffer.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t iio_ad7124_stream_samples(struct ad7124_dev *desc,
+		struct iio_buffer *buffer)
+{
+	struct no_os_adc_stream_init_param param = *desc->stream_init;
+	uint32_t timeout = IIO_AD7124_STREAM_TIMEOUT;
+	struct no_os_adc_stream_desc *stream;
+	struct no_os_adc_stream_stats stats;
+	enum ad7124_mode mode = desc->mode;
+	uint32_t nb, frames = 0;
+	int32_t ret, ret2;
+
+	nb = buffer->size / sizeof(uint32_t);
+	if (!nb || !param.block_size)
+		return -EINVAL;
+
+	param.block_size = no_os_min(param.block_size, nb);
+	while (nb % param.block_size)
+		param.block_size--;
+	param.sink = buffer->buf;
+
+	ret = ad7124_stream_param_get(desc, &param);
+	if (ret)
+		return ret;
+
+	ret = no_os_adc_stream_init(&stream, &param);
+	if (ret)
+		return ret;
+
+	ret = no_os_adc_stream_start(stream);
+	if (ret)
+		goto remove;
+
+	/* Restarts the sequence from the first enabled channel */
+	ret = ad7124_set_adc_mode(desc, AD7124_CONTINUOUS);
+	if (ret)
+		goto remove;
+
+	while (nb) {
+		ret = no_os_adc_stream_process(stream);
+		if (ret < 0)
+			break;
+		nb -= ret * param.block_size;
+
+		ret = no_os_adc_stream_stats_get(stream, &stats, false);
+		if (ret)
+			break;
+
+		/* A dropped frame would shift the channels of the scans */
+		if (stats.invalid || stats.dropped) {
+			ret = -EIO;
+			break;
+		}
+
+		if (stats.frames != frames) {
+			frames = stats.frames;
+			timeout = IIO_AD7124_STREAM_TIMEOUT;
+		} else if (!--timeout) {
+			ret = -ETIMEDOUT;
+			break;
+		} else {
+			no_os_udelay(100);
+		}
+	}
+
+	no_os_adc_stream_stop(stream);
+	ret2 = ad7124_set_adc_mode(desc, mode);
+	if (!ret)
+		ret = ret2;
+remove:
+	no_os_adc_stream_remove(stream);
+
+	return ret;
+}
+
+/**
+ * @brief Fill the IIO buffer, through the DRDY stream if one is configured.
+ * @param [in] dev_data - IIO device data.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t iio_ad7124_submit(struct iio_device_data *dev_data)
+{
+	struct ad7124_dev *desc = dev_data->dev;
+	struct iio_buffer *buffer = dev_data->buffer;
+	void *buff;
+	int32_t ret;
+
+	if (desc->stream_init)
+		return iio_ad7124_stream_samples(desc, buffer);
+
+	ret = iio_buffer_get_block(buffer, &buff);
+	if (ret)
+		return ret;
+
+	ret = iio_ad7124_read_samples(desc, buff, buffer->samples);
+	if (ret < 0)
+		return ret;
+
+	return iio_buffer_block_done(buffer);
+}
+
 struct iio_device iio_ad7124_device = {
 	.num_ch = NO_OS_ARRAY_SIZE(ad7124_channels),
 	.channels = ad7124_channels,
@@ -713,7 +829,7 @@ struct iio_device iio_ad7124_device = {
 	.buffer_attributes = NULL,
 	.pre_enable = iio_ad7124_update_active_channels,
 	.post_disable = iio_ad7124_close_channels,
-	.read_dev = (int32_t (*)())iio_ad7124_read_samples,
+	.submit = iio_ad7124_submit,
 	.debug_reg_read = (int32_t (*)())ad7124_read_register2,
 	.debug_reg_write = (int32_t (*)())ad7124_write_register2
 };
@@ -48,6 +48,9 @@
 #include "no_os_error.h"
 #include "no_os_delay.h"
 #include "no_os_alloc.h"
+#include "no_os_crc8.h"
+
+NO_OS_DECLARE_CRC8_TABLE(ad77681_crc8);
 
 /******************************************************************************/
 /************************** Functions Implementation **************************/
@@ -1741,6 +1744,90 @@ int32_t ad77681_status(struct ad77681_dev *dev,
 	return ret;
 }
 
+/**
+ * Decode a block of ADC data frames captured by the streaming engine.
+ * @param dev - The device structure.
+ * @param frames - Raw frames, the register read command byte included in
+ * 		   register data read mode.
+ * @param frame_size - Size of a frame in bytes.
+ * @param nb_frames - Number of frames.
+ * @param samples - Output conversion results.
+ * @return Number of valid samples.
+ */
+static int32_t ad77681_stream_decode(void *dev, const uint8_t *frames,
+				     uint8_t frame_size, uint32_t nb_frames,
+				     uint32_t *samples)
+{
+	struct ad77681_dev *d = dev;
+	uint8_t add = frame_size - d->data_frame_byte;
+	uint8_t len = d->data_frame_byte - 1;
+	const uint8_t *data;
+	uint32_t n, nb = 0;
+	uint8_t crc, i;
+
+	for (n = 0; n < nb_frames; n++, frames += frame_size) {
+		data = frames + add;
+
+		if (d->crc_sel == AD77681_CRC) {
+			crc = no_os_crc8(ad77681_crc8, data, len,
+					 INITIAL_CRC_CRC8);
+			if (crc != data[len])
+				continue;
+		} else if (d->crc_sel == AD77681_XOR) {
+			crc = INITIAL_CRC_XOR;
+			for (i = 0; i < len; i++)
+				crc ^= data[i];
+			if (crc != data[len])
+				continue;
+		}
+
+		if (d->conv_len == AD77681_CONV_24BIT)
+			samples[nb++] = ((uint32_t)data[0] << 16) |
+					(data[1] << 8) | data[2];
+		else
+			samples[nb++] = (data[0] << 8) | data[1];
+	}
+
+	return nb;
+}
+
+/**
+ * Fill the streaming engine parameters for reading a conversion on each
+ * DRDY falling edge. In continuous data read mode the device must already
+ * have continuous read enabled. The interrupt controller, DRDY line, block
+ * size and sink are left to the caller.
+ * @param dev - The device structure.
+ * @param mode - Data read mode
+ * 		Accepted values: AD77681_REGISTER_DATA_READ
+ *				 AD77681_CONTINUOUS_DATA_READ
+ * @param param - Streaming engine parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad77681_stream_param_get(struct ad77681_dev *dev,
+				 enum ad77681_data_read_mode mode,
+				 struct no_os_adc_stream_init_param *param)
+{
+	if (!dev || !param)
+		return -EINVAL;
+
+	no_os_crc8_populate_msb(ad77681_crc8, AD77681_CRC8_POLY);
+
+	param->spi_desc = dev->spi_desc;
+	param->drdy_trig = NO_OS_IRQ_EDGE_FALLING;
+	param->frame_size = ad77681_get_frame_byte(dev);
+	if (mode == AD77681_REGISTER_DATA_READ) {
+		param->cmd[0] = AD77681_REG_READ(AD77681_REG_ADC_DATA);
+		param->cmd_size = 1;
+		param->frame_size++;
+	} else {
+		param->cmd_size = 0;
+	}
+	param->dev = dev;
+	param->decode = ad77681_stream_decode;
+
+	return 0;
+}
+
 /**
  * Initialize the device.
  * @param device - The device structure.
@@ -41,6 +41,7 @@
 #define SRC_AD77681_H_
 
 #include "no_os_spi.h"
+#include "no_os_adc_stream.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -678,4 +679,7 @@ int32_t ad77681_SINC3_ODR(struct ad77681_dev *dev,
 			  float sinc3_odr);
 int32_t ad77681_status(struct ad77681_dev *dev,
 		       struct ad77681_status_registers *status);
+int32_t ad77681_stream_param_get(struct ad77681_dev *dev,
+				 enum ad77681_data_read_mode mode,
+				 struct no_os_adc_stream_init_param *param);
 #endif /* SRC_AD77681_H_ */
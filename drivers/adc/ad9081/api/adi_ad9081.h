@@ -292,6 +292,9 @@
 
 #define AD9081_USE_FLOATING_TYPE 0
 #define AD9081_USE_SPI_BURST_MODE 0
+#define AD9081_USE_SPI_PAGE_CACHE 1
+#define AD9081_HAL_SPI_STREAM_MAX 16
+#define AD9081_HAL_PAGE_REG_NUM 8
 
 /*============= ENUMS ==============*/
 
@@ -865,6 +868,11 @@ typedef struct {
 		tx_en_pin_ctrl; /*!< Function pointer to hal tx_enable pin control function */
 	adi_reset_pin_ctrl_t
 		reset_pin_ctrl; /*!< Function pointer to hal reset# pin control function */
+
+	uint8_t spi_stream_en; /*!< Address ascension set, streaming allowed */
+	uint8_t page_cache_valid; /*!< Bit n set when page_cache[n] is valid */
+	uint8_t page_cache
+		[AD9081_HAL_PAGE_REG_NUM]; /*!< Paging registers 0x18 - 0x1f */
 } adi_ad9081_hal_t;
 
 /*!
@@ -2939,6 +2947,45 @@ int32_t adi_ad9081_adc_ddc_coarse_nco_ftw_set(adi_ad9081_device_t *device,
 					      uint64_t modulus_a,
 					      uint64_t modulus_b);
 
+/**
+ * @ingroup rx_nco_setup
+ * @brief  Prepare the coarse DDCs for fast integer NCO hopping
+ *         Computes the frequency tuning words of a list of frequency shifts
+ *         and clears the modulus words once, so that
+ *         adi_ad9081_adc_ddc_coarse_nco_hop() only has to write the FTW.
+ *         Call after adi_ad9081_device_startup_rx().
+ *
+ * @param  device     Pointer to the device structure
+ * @param  cddcs      Coarse DDCs selection, @see adi_ad9081_adc_coarse_ddc_select_e
+ * @param  shift_hz   Array of frequency shifts in Hz
+ * @param  num        Number of entries in shift_hz
+ * @param  ftw        Array of num entries filled with the tuning words
+ *
+ * @return API_CMS_ERROR_OK                     API Completed Successfully
+ * @return <0                                   Failed. @see adi_cms_error_e for details.
+ */
+int32_t adi_ad9081_adc_ddc_coarse_nco_hop_prepare(adi_ad9081_device_t *device,
+						  uint8_t cddcs,
+						  const int64_t *shift_hz,
+						  uint32_t num, uint64_t *ftw);
+
+/**
+ * @ingroup rx_nco_setup
+ * @brief  Hop the coarse DDCs NCO to a precomputed integer tuning word
+ *         The page select, FTW and phase offset are written with streaming
+ *         SPI transfers, repeated page selects are served from the HAL page
+ *         cache. Call after adi_ad9081_adc_ddc_coarse_nco_hop_prepare().
+ *
+ * @param  device     Pointer to the device structure
+ * @param  cddcs      Coarse DDCs selection, @see adi_ad9081_adc_coarse_ddc_select_e
+ * @param  ftw        Value of frequency tuning word
+ *
+ * @return API_CMS_ERROR_OK                     API Completed Successfully
+ * @return <0                                   Failed. @see adi_cms_error_e for details.
+ */
+int32_t adi_ad9081_adc_ddc_coarse_nco_hop(adi_ad9081_device_t *device,
+					  uint8_t cddcs, uint64_t ftw);
+
 /**
  * @ingroup rx_nco_setup
  * @brief  Set Fine DDC's NCO Channel Selection Mode
@@ -1424,14 +1424,70 @@ int32_t adi_ad9081_adc_ddc_coarse_nco_ftw_set(adi_ad9081_device_t *device,
 	AD9081_ERROR_RETURN(err);
 #endif
 
-	if ((cddcs & AD9081_ADC_CDDC_0) > 0) {
+	/* CDDC0 and CDDC1 share the same phase offset, write both at once */
+	if ((cddcs & (AD9081_ADC_CDDC_0 | AD9081_ADC_CDDC_1)) > 0) {
 		err = adi_ad9081_adc_ddc_coarse_nco_phase_offset_set(
-			device, AD9081_ADC_CDDC_0, ftw << 3);
+			device, cddcs & (AD9081_ADC_CDDC_0 | AD9081_ADC_CDDC_1),
+			ftw << 3);
 		AD9081_ERROR_RETURN(err);
 	}
-	if ((cddcs & AD9081_ADC_CDDC_1) > 0) {
+
+	return API_CMS_ERROR_OK;
+}
+
+int32_t adi_ad9081_adc_ddc_coarse_nco_hop_prepare(adi_ad9081_device_t *device,
+						  uint8_t cddcs,
+						  const int64_t *shift_hz,
+						  uint32_t num, uint64_t *ftw)
+{
+	int32_t err;
+	uint32_t i;
+	AD9081_NULL_POINTER_RETURN(device);
+	AD9081_NULL_POINTER_RETURN(shift_hz);
+	AD9081_NULL_POINTER_RETURN(ftw);
+	AD9081_LOG_FUNC();
+	AD9081_INVALID_PARAM_RETURN(cddcs > AD9081_ADC_CDDC_ALL);
+
+	for (i = 0; i < num; i++) {
+		err = adi_ad9081_hal_calc_rx_nco_ftw(
+			device, device->dev_info.adc_freq_hz, shift_hz[i],
+			&ftw[i]);
+		AD9081_ERROR_RETURN(err);
+	}
+
+	/* integer mode, the modulus words stay cleared while hopping */
+	err = adi_ad9081_adc_ddc_coarse_select_set(device, cddcs);
+	AD9081_ERROR_RETURN(err);
+	err = adi_ad9081_hal_bf_set(device,
+				    REG_COARSE_DDC_PHASE_INC_FRAC_A0_ADDR,
+				    0x3000, 0);
+	AD9081_ERROR_RETURN(err);
+	err = adi_ad9081_hal_bf_set(device,
+				    REG_COARSE_DDC_PHASE_INC_FRAC_B0_ADDR,
+				    0x3000, 0);
+	AD9081_ERROR_RETURN(err);
+
+	return API_CMS_ERROR_OK;
+}
+
+int32_t adi_ad9081_adc_ddc_coarse_nco_hop(adi_ad9081_device_t *device,
+					  uint8_t cddcs, uint64_t ftw)
+{
+	int32_t err;
+	AD9081_NULL_POINTER_RETURN(device);
+	AD9081_LOG_FUNC();
+	AD9081_INVALID_PARAM_RETURN(cddcs > AD9081_ADC_CDDC_ALL);
+	AD9081_INVALID_PARAM_RETURN((ftw >> 48) > 0);
+
+	err = adi_ad9081_adc_ddc_coarse_select_set(device, cddcs);
+	AD9081_ERROR_RETURN(err);
+	err = adi_ad9081_hal_bf_set(device, REG_COARSE_DDC_PHASE_INC0_ADDR,
+				    0x3000, ftw);
+	AD9081_ERROR_RETURN(err);
+	if ((cddcs & (AD9081_ADC_CDDC_0 | AD9081_ADC_CDDC_1)) > 0) {
 		err = adi_ad9081_adc_ddc_coarse_nco_phase_offset_set(
-			device, AD9081_ADC_CDDC_1, ftw << 3);
+			device, cddcs & (AD9081_ADC_CDDC_0 | AD9081_ADC_CDDC_1),
+			ftw << 3);
 		AD9081_ERROR_RETURN(err);
 	}
 
@@ -15,6 +15,13 @@
 /*============= I N C L U D E S ============*/
 #include "adi_ad9081_hal.h"
 
+/*============= D E F I N E S ==============*/
+#define AD9081_HAL_IS_PAGE_REG(reg)                                            \
+	(((reg) >= REG_ADC_COARSE_PAGE_ADDR) &&                                \
+	 ((reg) < REG_ADC_COARSE_PAGE_ADDR + AD9081_HAL_PAGE_REG_NUM))
+#define AD9081_HAL_PAGE_IDX(reg) ((reg)-REG_ADC_COARSE_PAGE_ADDR)
+#define AD9081_HAL_PAGE_BIT(reg) (1 << AD9081_HAL_PAGE_IDX(reg))
+
 /*============= C O D E ====================*/
 int32_t adi_ad9081_hal_hw_open(adi_ad9081_device_t *device)
 {
@@ -61,6 +68,9 @@ int32_t adi_ad9081_hal_reset_pin_ctrl(adi_ad9081_device_t *device,
 					device->hal_info.user_data, enable)) {
 		return API_CMS_ERROR_RESET_PIN_CTRL;
 	}
+	/* registers return to their defaults */
+	device->hal_info.spi_stream_en = 0;
+	device->hal_info.page_cache_valid = 0;
 
 	return API_CMS_ERROR_OK;
 }
@@ -162,7 +172,7 @@ int32_t adi_ad9081_hal_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 			      uint32_t info, uint64_t value)
 {
 	int32_t err;
-	uint8_t reg_offset = 0, data8 = 0;
+	uint8_t reg_offset = 0, data8 = 0, data[9];
 	uint8_t offset = (uint8_t)(info >> 0), width = (uint8_t)(info >> 8);
 	uint32_t data32 = 0, mask = 0;
 	uint8_t reg_bytes =
@@ -172,7 +182,10 @@ int32_t adi_ad9081_hal_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 	AD9081_INVALID_PARAM_RETURN(width < 1);
 
 	if (reg < 0x4000) {
+		/* only partially written bytes are read back, the whole field
+		 * is then written with a single streaming transfer */
 		for (reg_offset = 0; reg_offset < reg_bytes; reg_offset++) {
+			data8 = 0;
 			if ((offset + width) <= 8) { /* last 8bits */
 				if ((offset > 0) || ((offset + width) < 8)) {
 					err = adi_ad9081_hal_reg_get(
@@ -197,10 +210,11 @@ int32_t adi_ad9081_hal_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 				width = offset + width - 8;
 				offset = 0;
 			}
-			err = adi_ad9081_hal_reg_set(device, reg + reg_offset,
-						     data8);
-			AD9081_ERROR_RETURN(err);
+			data[reg_offset] = data8;
 		}
+		err = adi_ad9081_hal_reg_stream_set(device, reg, data,
+						    reg_bytes);
+		AD9081_ERROR_RETURN(err);
 	} else { /* access extended space */
 		for (reg_offset = 0; reg_offset < reg_bytes; reg_offset += 4) {
 			if ((offset + width) <= 32) { /* last 32bits */
@@ -245,6 +259,15 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 	AD9081_NULL_POINTER_RETURN(data);
 
 	if (reg < 0x4000) {
+#if AD9081_USE_SPI_PAGE_CACHE > 0
+		if (AD9081_HAL_IS_PAGE_REG(reg) &&
+		    (device->hal_info.page_cache_valid &
+		     AD9081_HAL_PAGE_BIT(reg))) {
+			*data = device->hal_info.page_cache[AD9081_HAL_PAGE_IDX(
+				reg)];
+			return API_CMS_ERROR_OK;
+		}
+#endif
 		in_data[0] = ((reg >> 8) & 0x3F) | 0x80;
 		in_data[1] = ((reg >> 0) & 0xFF);
 		if (API_CMS_ERROR_OK !=
@@ -256,6 +279,14 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 		    AD9081_LOG_SPIR((in_data[0] << 8) + in_data[1],
 				    out_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
+#if AD9081_USE_SPI_PAGE_CACHE > 0
+		if (AD9081_HAL_IS_PAGE_REG(reg)) {
+			device->hal_info.page_cache[AD9081_HAL_PAGE_IDX(reg)] =
+				*data;
+			device->hal_info.page_cache_valid |=
+				AD9081_HAL_PAGE_BIT(reg);
+		}
+#endif
 	} else { /* access extended 32-bit data space */
 		in_data[0] = 0x3D;
 		in_data[1] = 0x21;
@@ -340,6 +371,14 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 	AD9081_NULL_POINTER_RETURN(device->hal_info.spi_xfer);
 
 	if (reg < 0x4000) {
+#if AD9081_USE_SPI_PAGE_CACHE > 0
+		if (AD9081_HAL_IS_PAGE_REG(reg) &&
+		    (device->hal_info.page_cache_valid &
+		     AD9081_HAL_PAGE_BIT(reg)) &&
+		    (device->hal_info.page_cache[AD9081_HAL_PAGE_IDX(reg)] ==
+		     (uint8_t)data))
+			return API_CMS_ERROR_OK;
+#endif
 		in_data[0] = (reg >> 8) & 0x3F;
 		in_data[1] = (reg >> 0) & 0xFF;
 		in_data[2] = (uint8_t)(data & 0xFF);
@@ -350,6 +389,22 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 		if (API_CMS_ERROR_OK !=
 		    AD9081_LOG_SPIW(reg & 0x3fff, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
+		if (reg == REG_SPI_INTFCONFA_ADDR) {
+			/* soft reset restores the register defaults, streaming
+			 * needs address ascension (bits 5 and 2) */
+			device->hal_info.page_cache_valid = 0;
+			device->hal_info.spi_stream_en =
+				((in_data[2] & 0x81) == 0) &&
+				((in_data[2] & 0x24) == 0x24);
+		}
+#if AD9081_USE_SPI_PAGE_CACHE > 0
+		if (AD9081_HAL_IS_PAGE_REG(reg)) {
+			device->hal_info.page_cache[AD9081_HAL_PAGE_IDX(reg)] =
+				in_data[2];
+			device->hal_info.page_cache_valid |=
+				AD9081_HAL_PAGE_BIT(reg);
+		}
+#endif
 	} else { /* access extended 32-bit data space */
 		in_data[0] = 0x3D;
 		in_data[1] = 0x21;
@@ -424,6 +479,57 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 	return API_CMS_ERROR_OK;
 }
 
+int32_t adi_ad9081_hal_reg_stream_set(adi_ad9081_device_t *device,
+				      uint32_t reg, const uint8_t *data,
+				      uint8_t len)
+{
+	int32_t err;
+	uint8_t i, in_data[AD9081_HAL_SPI_STREAM_MAX + 2],
+		out_data[AD9081_HAL_SPI_STREAM_MAX + 2];
+	AD9081_NULL_POINTER_RETURN(device);
+	AD9081_NULL_POINTER_RETURN(device->hal_info.spi_xfer);
+	AD9081_NULL_POINTER_RETURN(data);
+	AD9081_INVALID_PARAM_RETURN(len < 1);
+
+	/* the spi config and paging registers keep going through
+	 * adi_ad9081_hal_reg_set() so their side effects are tracked */
+	if ((len == 1) || (reg < 0x20) || ((reg + len) > 0x4000) ||
+	    (len > AD9081_HAL_SPI_STREAM_MAX) ||
+	    (device->hal_info.spi_stream_en == 0) ||
+	    (device->hal_info.msb != SPI_MSB_FIRST)) {
+		for (i = 0; i < len; i++) {
+			err = adi_ad9081_hal_reg_set(device, reg + i, data[i]);
+			AD9081_ERROR_RETURN(err);
+		}
+		return API_CMS_ERROR_OK;
+	}
+
+	in_data[0] = (reg >> 8) & 0x3F;
+	in_data[1] = (reg >> 0) & 0xFF;
+	for (i = 0; i < len; i++)
+		in_data[i + 2] = data[i];
+	if (API_CMS_ERROR_OK !=
+	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data,
+				      out_data, len + 2))
+		return API_CMS_ERROR_SPI_XFER;
+	for (i = 0; i < len; i++) {
+		if (API_CMS_ERROR_OK !=
+		    AD9081_LOG_SPIW((reg + i) & 0x3fff, data[i]))
+			return API_CMS_ERROR_LOG_WRITE;
+	}
+
+	return API_CMS_ERROR_OK;
+}
+
+int32_t adi_ad9081_hal_page_cache_invalidate(adi_ad9081_device_t *device)
+{
+	AD9081_NULL_POINTER_RETURN(device);
+
+	device->hal_info.page_cache_valid = 0;
+
+	return API_CMS_ERROR_OK;
+}
+
 int32_t adi_ad9081_hal_cbusjrx_reg_get(adi_ad9081_device_t *device,
 				       uint32_t reg, uint8_t *data,
 				       uint8_t lane)
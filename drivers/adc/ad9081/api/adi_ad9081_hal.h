@@ -159,6 +159,10 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 			       uint8_t *data);
 int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 			       uint32_t data);
+int32_t adi_ad9081_hal_reg_stream_set(adi_ad9081_device_t *device,
+				      uint32_t reg, const uint8_t *data,
+				      uint8_t len);
+int32_t adi_ad9081_hal_page_cache_invalidate(adi_ad9081_device_t *device);
 
 int32_t adi_ad9081_hal_cbusjrx_reg_get(adi_ad9081_device_t *device,
 				       uint32_t reg, uint8_t *data,
@@ -667,7 +667,7 @@ static int AD5940_FIFORd_Fast(struct no_os_spi_desc *spi, uint32_t *pBuffer,
 	}
 
 	if (iobuf_alloc_sz < iobuf_sz) {
-		buf = realloc(iobuf, iobuf_sz);
+		buf = no_os_realloc(iobuf, iobuf_sz);
 		if (!buf)
 			return -ENOMEM;
 
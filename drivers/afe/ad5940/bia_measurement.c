@@ -532,6 +532,7 @@ static int AppBiaRtiaCal(struct ad5940_dev *dev)
 		printf("RtiaReal:%.2f,Imag:%f\n", AppBiaCfg.RtiaCurrValue[0],
 		       AppBiaCfg.RtiaCurrValue[1]);
 	}
+	AppBiaCfg.BatchSweepIndex = 0;
 	return 0;
 }
 
@@ -673,16 +674,17 @@ static int AppEITRegModify(struct ad5940_dev *dev, int32_t * const pData,
 	return 0;
 }
 
+/* Data is 18bit in two's complement, bit17 is the sign bit */
+static inline int32_t signExtend18(uint32_t val)
+{
+	return (int32_t)(val << 14) >> 14;  /* @todo option to check ECC */
+}
+
 void signExtend18To32(uint32_t *const pData, uint16_t nLen)
 {
 	/* Convert Voltage values to int32_t type */
-	for (uint32_t i = 0; i < nLen; i++) {
-		pData[i] &= 0x3ffff;      /* @todo option to check ECC */
-		if (pData[i] & (1 << 17)) { /* Bit17 is sign bit */
-			pData[i] |=
-				0xfffc0000; /* Data is 18bit in two's complement, bit17 is the sign bit */
-		}
-	}
+	for (uint32_t i = 0; i < nLen; i++)
+		pData[i] = (uint32_t)signExtend18(pData[i]);
 }
 
 fImpCar_Type computeImpedance(uint32_t *const pData)
@@ -724,6 +726,112 @@ fImpCar_Type computeImpedance(uint32_t *const pData)
 	return fCarZval;
 }
 
+/**
+ * Convert a whole sequencer FIFO dump into calibrated impedance.
+ * Batch alternative to signExtend18To32() and computeImpedance() called for
+ * each result. The FIFO contains VRe, VIm, IRe, IIm for each result in
+ * impedance mode and VRe, VIm in voltage mode, in which case the voltage is
+ * returned. When the frequency sweep is enabled, the results are expected in
+ * sweep order, each one is calibrated with the Rtia of its own frequency.
+ * The computation is done in single precision float, for cores with an FPU.
+ * @param pData - FIFO data, not modified.
+ * @param nWords - Number of FIFO words in pData.
+ * @param pResult - Impedance results.
+ * @param pCount - In: size of pResult. Out: number of results.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int AppBiaProcessBatch(const uint32_t *pData, uint32_t nWords,
+		       fImpCar_Type *pResult, uint32_t *pCount)
+{
+	uint32_t rec_len = AppBiaCfg.bImpedanceReadMode ? 4 : 2;
+	const float *pRtia = AppBiaCfg.RtiaCurrValue;
+	float a, b, c, d, re, im, inv;
+	uint32_t n, i, idx;
+
+	if (!pData || !pResult || !pCount)
+		return -EINVAL;
+
+	n = nWords / rec_len;
+	if (n > *pCount)
+		n = *pCount;
+	*pCount = n;
+
+	if (!AppBiaCfg.bImpedanceReadMode) {
+		for (i = 0; i < n; i++, pData += 2) {
+			pResult[i].Real = (float)signExtend18(pData[0]);
+			pResult[i].Image = (float)signExtend18(pData[1]);
+		}
+
+		return 0;
+	}
+
+	for (i = 0; i < n; i++, pData += 4) {
+		/* Same conventions as computeImpedance() */
+		a = (float)signExtend18(pData[0]);
+		b = -(float)signExtend18(pData[1]);
+		c = -(float)signExtend18(pData[2]);
+		d = (float)signExtend18(pData[3]);
+
+		if (AppBiaCfg.SweepCfg.SweepEn) {
+			idx = AppBiaCfg.BatchSweepIndex;
+			pRtia = AppBiaCfg.RtiaCalTable[idx];
+			if (++idx >= AppBiaCfg.SweepCfg.SweepPoints)
+				idx = 0;
+			AppBiaCfg.BatchSweepIndex = idx;
+		}
+
+		/* One division per result instead of two */
+		inv = 1.0f / (c * c + d * d);
+		re = (a * c + b * d) * inv;
+		im = (b * c - a * d) * inv;
+		pResult[i].Real = re * pRtia[0] - im * pRtia[1];
+		pResult[i].Image = im * pRtia[0] + re * pRtia[1];
+	}
+
+	return 0;
+}
+
+/* atan2f() replacement, polynomial approximation within 1e-5 rad */
+static inline float AppBiaAtan2(float y, float x)
+{
+	float ax = fabsf(x);
+	float ay = fabsf(y);
+	float mx = ax > ay ? ax : ay;
+	float mn = ax > ay ? ay : ax;
+	float t = mx > 0.0f ? mn / mx : 0.0f;
+	float s = t * t;
+	float r;
+
+	r = t * (0.99997726f + s * (-0.33262347f + s * (0.19354346f +
+			s * (-0.11643287f + s * (0.05265332f -
+					s * 0.01172120f)))));
+	if (ay > ax)
+		r = MATH_PI / 2 - r;
+	if (x < 0.0f)
+		r = MATH_PI - r;
+
+	return y < 0.0f ? -r : r;
+}
+
+/**
+ * Magnitude and phase of the results of AppBiaProcessBatch(). The phase is in
+ * radians, in the range of atan2f().
+ * @param pCar - Results of AppBiaProcessBatch().
+ * @param pPol - Polar results, may not overlap pCar.
+ * @param nCount - Number of results.
+ */
+void AppBiaBatchToPolar(const fImpCar_Type *pCar, fImpPol_Type *pPol,
+			uint32_t nCount)
+{
+	uint32_t i;
+
+	for (i = 0; i < nCount; i++) {
+		pPol[i].Magnitude = sqrtf(pCar[i].Real * pCar[i].Real +
+					  pCar[i].Image * pCar[i].Image);
+		pPol[i].Phase = AppBiaAtan2(pCar[i].Image, pCar[i].Real);
+	}
+}
+
 /**
 
  */
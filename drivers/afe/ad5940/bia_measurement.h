@@ -94,6 +94,7 @@ typedef struct {
 	float SweepNextFreq;
 	float RtiaCurrValue[2];                 /* Calibrated Rtia value of current frequency */
 	float RtiaCalTable[MAXSWEEP_POINTS][2]; /* Calibrated Rtia Value table */
+	uint32_t BatchSweepIndex;               /* Sweep point of the next result of AppBiaProcessBatch */
 	float FreqofData;                       /* The frequency of latest data sampled */
 	bool BiaInited;                     /* If the program run firstly, generated sequence commands */
 	SEQInfo_Type InitSeqInfo;
@@ -115,5 +116,9 @@ int AppBiaISR(struct ad5940_dev *dev, void *pBuff, uint32_t *pCountd);
 int AppBiaCtrl(struct ad5940_dev *dev, int32_t BcmCtrl, void *pPara);
 void signExtend18To32(uint32_t *const pData, uint16_t nLen);
 fImpCar_Type computeImpedance(uint32_t *const pData);
+int AppBiaProcessBatch(const uint32_t *pData, uint32_t nWords,
+		       fImpCar_Type *pResult, uint32_t *pCount);
+void AppBiaBatchToPolar(const fImpCar_Type *pCar, fImpPol_Type *pPol,
+			uint32_t nCount);
 
 #endif /* BIA_MEASUREMENT_H_ */
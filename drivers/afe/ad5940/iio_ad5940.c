@@ -69,7 +69,7 @@ static int ad5940_iio_read_chan_raw(void *device, char *buf, uint32_t len,
 	struct ad5940_iio_dev *iiodev = (struct ad5940_iio_dev *)device;
 	int32_t *pval;
 	fImpCar_Type fCarZval;
-	iImpCar_Type iCarVval;
+	uint32_t nResults = 1;
 	float fMagVal;
 	uint32_t timeout = 100;
 	uint8_t gpio;
@@ -97,40 +97,32 @@ static int ad5940_iio_read_chan_raw(void *device, char *buf, uint32_t len,
 	AppBiaISR(iiodev->ad5940, iiodev->AppBuff, &count);
 	AppBiaCtrl(iiodev->ad5940, BIACTRL_STOPNOW, 0);
 
-	signExtend18To32(iiodev->AppBuff, count);
-
-	if (pBiaCfg->bImpedanceReadMode) {
-		fCarZval = computeImpedance(iiodev->AppBuff);
-		if (iiodev->magnitude_mode) {
-			// respond with magnitude of impedance (one ieee754 float value)
-			fMagVal = sqrt(fCarZval.Real*fCarZval.Real +
-				       fCarZval.Image*fCarZval.Image);
-			pval = (int32_t *)&fMagVal;
-			values[0] = *pval;
-			return iio_format_value(buf, len, IIO_VAL_INT, 1, values);
-		} else {
-			// respond with impedance as a complex number (two ieee754 float values)
-			pval = (int32_t *)&fCarZval.Real;
-			values[0] = *pval;
-			pval = (int32_t *)&fCarZval.Image;
-			values[1] = *pval;
-			return iio_format_value(buf, len, IIO_VAL_INT_MULTIPLE, 2, values);
-		}
-	} else {
-		if (iiodev->magnitude_mode) {
-			// respond with magnitude of voltage only (one ieee754 float value)
-			iCarVval = *((iImpCar_Type *)iiodev->AppBuff);
-			fMagVal = sqrt((iCarVval.Real*1.0)*(iCarVval.Real*1.0) +
-				       (iCarVval.Image*1.0)*(iCarVval.Image*1.0));
-			pval = (int32_t *)&fMagVal;
-			values[0] = *pval;
-			return iio_format_value(buf, len, IIO_VAL_INT, 1, values);
-		} else {
-			// respond with raw complex voltage (two integer values)
-			return iio_format_value(buf, len, IIO_VAL_INT_MULTIPLE, 2,
-						(int32_t *)iiodev->AppBuff);
-		}
+	if (!pBiaCfg->bImpedanceReadMode && !iiodev->magnitude_mode) {
+		// respond with raw complex voltage (two integer values)
+		signExtend18To32(iiodev->AppBuff, 2);
+		return iio_format_value(buf, len, IIO_VAL_INT_MULTIPLE, 2,
+					(int32_t *)iiodev->AppBuff);
 	}
+
+	AppBiaProcessBatch(iiodev->AppBuff, count, &fCarZval, &nResults);
+	if (!nResults)
+		return -EIO;
+
+	if (iiodev->magnitude_mode) {
+		// respond with magnitude (one ieee754 float value)
+		fMagVal = sqrtf(fCarZval.Real * fCarZval.Real +
+				fCarZval.Image * fCarZval.Image);
+		pval = (int32_t *)&fMagVal;
+		values[0] = *pval;
+		return iio_format_value(buf, len, IIO_VAL_INT, 1, values);
+	}
+
+	// respond with impedance as a complex number (two ieee754 float values)
+	pval = (int32_t *)&fCarZval.Real;
+	values[0] = *pval;
+	pval = (int32_t *)&fCarZval.Image;
+	values[1] = *pval;
+	return iio_format_value(buf, len, IIO_VAL_INT_MULTIPLE, 2, values);
 }
 
 int ad5940_iio_get_attr(void *device, char *buf, uint32_t len,
@@ -213,3 +213,54 @@ int32_t no_os_i2c_read(struct no_os_i2c_desc *desc,
 
 	return ret;
 }
+
+/**
+ * @brief Send a list of messages to a slave device in a single transaction.
+ * Messages are separated by repeated starts and a stop is generated after the
+ * last one. Platforms without a transfer operation fall back to the write and
+ * read operations, which limits each message to 255 bytes.
+ * @param desc - The I2C descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_i2c_transfer(struct no_os_i2c_desc *desc,
+			   struct no_os_i2c_msg *msgs,
+			   uint32_t len)
+{
+	int32_t (*xfer)(struct no_os_i2c_desc *, uint8_t *, uint8_t, uint8_t);
+	int32_t ret = 0;
+	uint32_t i;
+
+	if (!desc || !desc->platform_ops || (!msgs && len))
+		return -EINVAL;
+
+	if (desc->platform_ops->i2c_ops_transfer) {
+		no_os_mutex_lock(desc->bus->mutex);
+		ret = desc->platform_ops->i2c_ops_transfer(desc, msgs, len);
+		no_os_mutex_unlock(desc->bus->mutex);
+
+		return ret;
+	}
+
+	if (!desc->platform_ops->i2c_ops_write ||
+	    !desc->platform_ops->i2c_ops_read)
+		return -ENOSYS;
+
+	for (i = 0; i < len; i++)
+		if (msgs[i].bytes_number > UINT8_MAX)
+			return -EINVAL;
+
+	no_os_mutex_lock(desc->bus->mutex);
+	for (i = 0; i < len; i++) {
+		xfer = msgs[i].read ? desc->platform_ops->i2c_ops_read :
+		       desc->platform_ops->i2c_ops_write;
+		ret = xfer(desc, msgs[i].buff, msgs[i].bytes_number,
+			   i == len - 1);
+		if (ret)
+			break;
+	}
+	no_os_mutex_unlock(desc->bus->mutex);
+
+	return ret;
+}
@@ -220,6 +220,46 @@ out:
 	return ret;
 }
 
+/**
+ * @brief Queue messages, to be sent with the next transfer of the device or by
+ * 	  no_os_spi_flush(). Platforms able to merge transfers (linux spidev)
+ * 	  send the queued messages with fewer calls, the others send them right
+ * 	  away. The buffers must stay valid, and the received data is only
+ * 	  available, once no_os_spi_flush() or the next transfer returns.
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_spi_queue(struct no_os_spi_desc *desc,
+			struct no_os_spi_msg *msgs,
+			uint32_t len)
+{
+	if (!desc || !desc->platform_ops || !msgs || !len)
+		return -EINVAL;
+
+	if (desc->platform_ops->queue)
+		return desc->platform_ops->queue(desc, msgs, len);
+
+	return no_os_spi_transfer(desc, msgs, len);
+}
+
+/**
+ * @brief Send the messages queued with no_os_spi_queue().
+ * @param desc - The SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_spi_flush(struct no_os_spi_desc *desc)
+{
+	if (!desc || !desc->platform_ops)
+		return -EINVAL;
+
+	if (desc->platform_ops->flush)
+		return desc->platform_ops->flush(desc);
+
+	return 0;
+}
+
 /**
  * @brief Transfer a list of messages using DMA and busy wait for the completion
  * @param desc - The SPI descriptor.
@@ -181,6 +181,9 @@ int adxcvr_drp_read(struct adxcvr *xcvr,
 		drp_addr = ADXCVR_DRP_PORT_ADDR_CHANNEL;
 
 	drp_sel = drp_port & 0xFF;
+	/* Broadcast is only for writes, read the first lane or quad */
+	if (drp_sel == ADXCVR_BROADCAST)
+		drp_sel = 0;
 
 	adxcvr_write(xcvr, ADXCVR_REG_DRP_SEL(drp_addr), drp_sel);
 	adxcvr_write(xcvr, ADXCVR_REG_DRP_CTRL(drp_addr), ADXCVR_DRP_CTRL_ADDR(reg));
@@ -319,12 +322,15 @@ int adxcvr_clk_set_rate(struct adxcvr *xcvr,
 	struct xilinx_xcvr_cpll_config cpll_conf;
 	struct xilinx_xcvr_qpll_config qpll_conf;
 	uint32_t out_div, clk25_div, prog_div;
-	uint32_t i;
-	int ret;
+	uint32_t i, lane, nb_lanes;
+	int ret, flush_ret;
 
 	pr_debug("%s: Rate %lu Hz Parent Rate %lu Hz\n",
 		 __func__, rate, parent_rate);
 
+	/* Not all the callers go through the clock framework */
+	no_os_clk_invalidate(xcvr->clk_out);
+
 	clk25_div = NO_OS_DIV_ROUND_CLOSEST(parent_rate, 25000);
 
 	if (xcvr->cpll_enable)
@@ -336,24 +342,29 @@ int adxcvr_clk_set_rate(struct adxcvr *xcvr,
 	if (ret < 0)
 		return ret;
 
-	for (i = 0; i < xcvr->num_lanes; i++) {
+	/* With broadcast, all the lanes and quads are written at once */
+	nb_lanes = xcvr->drp_broadcast ? 1 : xcvr->num_lanes;
+
+	xilinx_xcvr_drp_batch_start(&xcvr->xlx_xcvr);
+	for (i = 0; i < nb_lanes; i++) {
+		lane = xcvr->drp_broadcast ? ADXCVR_BROADCAST : i;
 
 		if (xcvr->cpll_enable)
 			ret = xilinx_xcvr_cpll_write_config(&xcvr->xlx_xcvr,
-							    ADXCVR_DRP_PORT_CHANNEL(i), &cpll_conf);
+							    ADXCVR_DRP_PORT_CHANNEL(lane), &cpll_conf);
 		else if ((i % 4 == 0) && xcvr->qpll_enable)
 			ret = xilinx_xcvr_qpll_write_config(&xcvr->xlx_xcvr,
 							    xcvr->sys_clk_sel,
-							    ADXCVR_DRP_PORT_COMMON(i), &qpll_conf);
+							    ADXCVR_DRP_PORT_COMMON(lane), &qpll_conf);
 		if (ret < 0)
-			return ret;
+			goto out;
 
 		ret = xilinx_xcvr_write_out_div(&xcvr->xlx_xcvr,
-						ADXCVR_DRP_PORT_CHANNEL(i),
+						ADXCVR_DRP_PORT_CHANNEL(lane),
 						xcvr->tx_enable ? -1 : (int32_t)out_div,
 						xcvr->tx_enable ? (int32_t)out_div : -1);
 		if (ret < 0)
-			return ret;
+			goto out;
 
 		if (xcvr->out_clk_sel == ADXCVR_PROGDIV_CLK) {
 			unsigned int max_progdiv, div = 1, ratio;
@@ -365,7 +376,7 @@ int adxcvr_clk_set_rate(struct adxcvr *xcvr,
 
 			/* Set RX|TX_PROGDIV_RATE = 2 on GTY4 */
 			ret = xilinx_xcvr_write_prog_div_rate(&xcvr->xlx_xcvr,
-							      ADXCVR_DRP_PORT_CHANNEL(i),
+							      ADXCVR_DRP_PORT_CHANNEL(lane),
 							      xcvr->tx_enable ? -1 : 2,
 							      xcvr->tx_enable ? 2 : -1);
 			if (!ret)
@@ -388,7 +399,8 @@ int adxcvr_clk_set_rate(struct adxcvr *xcvr,
 				max_progdiv = 100;
 				break;
 			default:
-				return -EINVAL;
+				ret = -EINVAL;
+				goto out;
 			}
 
 			prog_div = NO_OS_DIV_ROUND_CLOSEST(ratio * out_div, 2 * div);
@@ -400,31 +412,38 @@ int adxcvr_clk_set_rate(struct adxcvr *xcvr,
 			}
 
 			ret = xilinx_xcvr_write_prog_div(&xcvr->xlx_xcvr,
-							 ADXCVR_DRP_PORT_CHANNEL(i),
+							 ADXCVR_DRP_PORT_CHANNEL(lane),
 							 xcvr->tx_enable ? -1 : (int32_t)prog_div,
 							 xcvr->tx_enable ? (int32_t)prog_div : -1);
 			if (ret < 0)
-				return ret;
+				goto out;
 		}
 
 		if (!xcvr->tx_enable) {
 			ret = xilinx_xcvr_configure_cdr(&xcvr->xlx_xcvr,
-							ADXCVR_DRP_PORT_CHANNEL(i), rate, out_div,
+							ADXCVR_DRP_PORT_CHANNEL(lane), rate, out_div,
 							xcvr->lpm_enable);
 			if (ret < 0)
-				return ret;
+				goto out;
 
 			ret = xilinx_xcvr_write_rx_clk25_div(&xcvr->xlx_xcvr,
-							     ADXCVR_DRP_PORT_CHANNEL(i), clk25_div);
+							     ADXCVR_DRP_PORT_CHANNEL(lane), clk25_div);
 		} else {
 			ret = xilinx_xcvr_write_tx_clk25_div(&xcvr->xlx_xcvr,
-							     ADXCVR_DRP_PORT_CHANNEL(i), clk25_div);
+							     ADXCVR_DRP_PORT_CHANNEL(lane), clk25_div);
 		}
 
 		if (ret < 0)
-			return ret;
+			goto out;
 	}
 
+out:
+	/* Write the lane configuration and verify it once */
+	flush_ret = xilinx_xcvr_drp_batch_flush(&xcvr->xlx_xcvr);
+	if (ret < 0)
+		return ret;
+	if (flush_ret < 0)
+		return flush_ret;
 
 	xcvr->lane_rate_khz = rate;
 
@@ -568,7 +587,7 @@ static void adxcvr_get_info(struct adxcvr *xcvr)
 int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 		    const struct adxcvr_init *init)
 {
-	struct no_os_clk_init_param clk_out_init;
+	struct no_os_clk_init_param clk_out_init = { 0 };
 	uint32_t synth_conf, xcvr_type;
 	struct adxcvr *xcvr;
 	int32_t ret;
@@ -587,6 +606,8 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 	else
 		xcvr->cpll_enable = 0;
 	xcvr->lpm_enable = init->lpm_enable;
+	xcvr->drp_broadcast = init->drp_broadcast;
+	xcvr->xlx_xcvr.drp_verify_sample = init->drp_verify_sample;
 
 	xcvr->lane_rate_khz = init->lane_rate_khz;
 	xcvr->ref_rate_khz = init->ref_rate_khz;
@@ -670,6 +691,8 @@ int32_t adxcvr_init(struct adxcvr **ad_xcvr,
 		clk_out_init.dev_desc = xcvr;
 		clk_out_init.platform_ops = &adxcvr_clk_ops;
 		clk_out_init.name = xcvr->name;
+		/* The lane rate is read back through several DRP accesses */
+		clk_out_init.flags = NO_OS_CLK_CACHE_RATE;
 		ret = no_os_clk_init(&xcvr->clk_out, &clk_out_init);
 		if (ret)
 			goto err;
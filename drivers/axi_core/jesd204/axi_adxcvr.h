@@ -97,6 +97,8 @@ struct adxcvr {
 	struct xilinx_xcvr xlx_xcvr;
 	/** Exported no-OS output clock */
 	struct no_os_clk_desc *clk_out;
+	/** Configure all the lanes at once with DRP broadcast writes */
+	bool drp_broadcast;
 };
 
 /**
@@ -125,6 +127,13 @@ struct adxcvr_init {
 	uint32_t ref_rate_khz;
 	/** Export no-OS output clock */
 	bool export_no_os_clk;
+	/** Configure all the lanes at once with DRP broadcast writes. Lanes and
+	 *  quads share the same configuration, so this can be used unless
+	 *  lanes are changed individually later.
+	 */
+	bool drp_broadcast;
+	/** Verify 1 of N DRP writes of a lane rate change. 0 verifies all. */
+	uint32_t drp_verify_sample;
 };
 
 /**
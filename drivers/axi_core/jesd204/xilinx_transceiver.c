@@ -120,9 +120,33 @@
 #define GTY4_QPLL_CLKOUT_RATE(xcvr, x)	\
 	(0x0E + xilinx_xcvr_qpll_sel((xcvr), (x)) * 0x80)
 
+/*******************************************************************************
+ * @brief Find a DRP write queued by the current DRP batch.
+ *
+ * @param xcvr - The device structure.
+ * @param drp_port - DRP of the write.
+ * @param reg - DRP address.
+ *
+ * @return The queued write or NULL if the register was not written.
+ *******************************************************************************/
+static struct xilinx_xcvr_drp_write *xilinx_xcvr_drp_queued(
+	struct xilinx_xcvr *xcvr, uint32_t drp_port, uint32_t reg)
+{
+	uint32_t i;
+
+	for (i = 0; i < xcvr->drp_nb_queued; i++)
+		if (xcvr->drp_queue[i].drp_port == drp_port &&
+		    xcvr->drp_queue[i].reg == reg)
+			return &xcvr->drp_queue[i];
+
+	return NULL;
+}
+
 /*******************************************************************************
  * @brief Read data from a dynamic reconfiguration port (DRP).
  *
+ * During a DRP batch, registers already written are read from the queue.
+ *
  * @param xcvr - The device structure.
  * @param drp_port - DRP to read data from.
  * @param reg - DRP address.
@@ -134,8 +158,17 @@
 static int xilinx_xcvr_drp_read(struct xilinx_xcvr *xcvr,
 				uint32_t drp_port, uint32_t reg, uint32_t *val)
 {
+	struct xilinx_xcvr_drp_write *queued;
 	int ret;
 
+	if (xcvr->drp_batch) {
+		queued = xilinx_xcvr_drp_queued(xcvr, drp_port, reg);
+		if (queued) {
+			*val = queued->val;
+			return 0;
+		}
+	}
+
 	ret = adxcvr_drp_read(xcvr->ad_xcvr, drp_port, reg, val);
 	if (ret) {
 		pr_err("%s: Failed to read reg %ld-%#06lx: %d\n",
@@ -147,9 +180,86 @@ static int xilinx_xcvr_drp_read(struct xilinx_xcvr *xcvr,
 	return ret;
 }
 
+/*******************************************************************************
+ * @brief Read back a DRP register and check it holds the written value.
+ *
+ * @param xcvr - The device structure.
+ * @param drp_port - DRP that was written.
+ * @param reg - DRP address.
+ * @param val - Written value.
+ *
+ * @return ret - Result of the reading operation (0 - success, negative
+ *               value for failure). A mismatch is only reported.
+ *******************************************************************************/
+static int xilinx_xcvr_drp_verify(struct xilinx_xcvr *xcvr,
+				  uint32_t drp_port, uint32_t reg, uint32_t val)
+{
+	uint32_t read_val;
+	int ret;
+
+	ret = adxcvr_drp_read(xcvr->ad_xcvr, drp_port, reg, &read_val);
+	if (ret) {
+		pr_err("%s: Failed to check reg %ld-%#06lx: %d\n",
+		       __func__, drp_port, reg, ret);
+		return ret;
+	}
+
+	if (read_val != val)
+		pr_err("%s: read-write mismatch: reg %#06lx,"
+		       "val %#06lx, expected val %#06lx.\n",
+		       __func__, reg, read_val, val);
+
+	return 0;
+}
+
+/*******************************************************************************
+ * @brief Write the DRP writes queued by the current batch, then verify them.
+ *
+ * Verifying after all the writes avoids a read back after each write. Only
+ * 1 of drp_verify_sample writes is verified.
+ *
+ * @param xcvr - The device structure.
+ *
+ * @return ret - Result of the writing operation (0 - success, negative
+ *               value for failure).
+ *******************************************************************************/
+static int xilinx_xcvr_drp_flush_queue(struct xilinx_xcvr *xcvr)
+{
+	struct xilinx_xcvr_drp_write *w;
+	uint32_t step = no_os_max(xcvr->drp_verify_sample, 1U);
+	uint32_t i;
+	int ret = 0;
+
+	for (i = 0; i < xcvr->drp_nb_queued; i++) {
+		w = &xcvr->drp_queue[i];
+		ret = adxcvr_drp_write(xcvr->ad_xcvr, w->drp_port, w->reg,
+				       w->val);
+		if (ret) {
+			pr_err("%s: Failed to write reg %ld-%#06x: %d\n",
+			       __func__, w->drp_port, w->reg, ret);
+			goto out;
+		}
+	}
+
+	for (i = 0; i < xcvr->drp_nb_queued; i += step) {
+		w = &xcvr->drp_queue[i];
+		ret = xilinx_xcvr_drp_verify(xcvr, w->drp_port, w->reg, w->val);
+		if (ret)
+			break;
+	}
+
+out:
+	xcvr->drp_nb_queued = 0;
+
+	return ret;
+}
+
 /*******************************************************************************
  * @brief Write data to a dynamic reconfiguration port (DRP).
  *
+ * During a DRP batch, the write is queued. Writes to the same register are
+ * merged.
+ *
  * @param xcvr - The device structure.
  * @param drp_port - DRP to write data to.
  * @param reg - DRP address.
@@ -161,12 +271,33 @@ static int xilinx_xcvr_drp_read(struct xilinx_xcvr *xcvr,
 static int xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
 				 uint32_t drp_port, uint32_t reg, uint32_t val)
 {
-	uint32_t read_val;
+	struct xilinx_xcvr_drp_write *queued;
 	int ret;
 
 	pr_debug("%s: drp_port: %ld, reg %#06lx, val %#06lx. \n",
 		 __func__, drp_port, reg, val);
 
+	if (xcvr->drp_batch) {
+		queued = xilinx_xcvr_drp_queued(xcvr, drp_port, reg);
+		if (queued) {
+			queued->val = val;
+			return 0;
+		}
+
+		if (xcvr->drp_nb_queued == XILINX_XCVR_DRP_QUEUE_SIZE) {
+			ret = xilinx_xcvr_drp_flush_queue(xcvr);
+			if (ret)
+				return ret;
+		}
+
+		queued = &xcvr->drp_queue[xcvr->drp_nb_queued++];
+		queued->drp_port = drp_port;
+		queued->reg = reg;
+		queued->val = val;
+
+		return 0;
+	}
+
 	ret = adxcvr_drp_write(xcvr->ad_xcvr, drp_port, reg, val);
 	if (ret) {
 		pr_err("%s: Failed to write reg %ld-%#06lx: %d\n",
@@ -174,19 +305,41 @@ static int xilinx_xcvr_drp_write(struct xilinx_xcvr *xcvr,
 		return ret;
 	}
 
-	ret = xilinx_xcvr_drp_read(xcvr, drp_port, reg, &read_val);
-	if (ret) {
-		pr_err("%s: Failed to check reg %ld-%#06lx: %d\n",
-		       __func__, drp_port, reg, ret);
-		return ret;
-	}
+	return xilinx_xcvr_drp_verify(xcvr, drp_port, reg, val);
+}
 
-	if (read_val != val)
-		pr_err("%s: read-write mismatch: reg %#06lx,"
-		       "val %#06lx, expected val %#06lx.\n",
-		       __func__, reg, read_val, val);
+/*******************************************************************************
+ * @brief Start queuing the DRP writes.
+ *
+ * Registers written several times (e.g. by read-modify-write of different
+ * fields) are written once, and reads of queued registers do not access the
+ * DRP. The writes are verified when xilinx_xcvr_drp_batch_flush() is called.
+ *
+ * @param xcvr - The device structure.
+ *******************************************************************************/
+void xilinx_xcvr_drp_batch_start(struct xilinx_xcvr *xcvr)
+{
+	xcvr->drp_nb_queued = 0;
+	xcvr->drp_batch = true;
+}
 
-	return 0;
+/*******************************************************************************
+ * @brief Write and verify the DRP writes queued since
+ *        xilinx_xcvr_drp_batch_start() and stop queuing.
+ *
+ * @param xcvr - The device structure.
+ *
+ * @return ret - Result of the writing operation (0 - success, negative
+ *               value for failure).
+ *******************************************************************************/
+int xilinx_xcvr_drp_batch_flush(struct xilinx_xcvr *xcvr)
+{
+	int ret;
+
+	ret = xilinx_xcvr_drp_flush_queue(xcvr);
+	xcvr->drp_batch = false;
+
+	return ret;
 }
 
 /*******************************************************************************
@@ -165,6 +165,19 @@ enum axi_fpga_dev_pack {
 	AXI_FPGA_DEV_FA,
 };
 
+/* Maximum number of distinct DRP registers queued by a DRP batch */
+#define XILINX_XCVR_DRP_QUEUE_SIZE	64
+
+/**
+ * @struct xilinx_xcvr_drp_write
+ * @brief DRP write queued until the DRP batch is flushed.
+ */
+struct xilinx_xcvr_drp_write {
+	uint32_t drp_port;
+	uint16_t reg;
+	uint16_t val;
+};
+
 /**
  * @struct xilinx_xcvr
  * @brief xilinx_xcvr parameters structure.
@@ -186,6 +199,13 @@ struct xilinx_xcvr {
 	uint32_t vco0_max; // kHz
 	uint32_t vco1_min; // kHz
 	uint32_t vco1_max; // kHz
+
+	// Verify 1 of N DRP writes when a batch is flushed, 0 and 1 verify all
+	uint32_t drp_verify_sample;
+	// DRP writes are queued between drp_batch_start and drp_batch_flush
+	bool drp_batch;
+	uint32_t drp_nb_queued;
+	struct xilinx_xcvr_drp_write drp_queue[XILINX_XCVR_DRP_QUEUE_SIZE];
 };
 
 struct xilinx_xcvr_drp_ops {
@@ -277,6 +297,13 @@ struct xilinx_xcvr_qpll_config {
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 
+/** Queue the DRP writes until xilinx_xcvr_drp_batch_flush(). */
+void xilinx_xcvr_drp_batch_start(struct xilinx_xcvr *xcvr);
+/** Write the queued DRP writes and verify them. */
+int xilinx_xcvr_drp_batch_flush(struct xilinx_xcvr *xcvr);
+/** Update bits of a DRP register. */
+int xilinx_xcvr_drp_update(struct xilinx_xcvr *xcvr, uint32_t drp_port,
+			   uint32_t reg, uint32_t mask, uint32_t val);
 /** Configure the Clock Data Recovery circuit. */
 int xilinx_xcvr_configure_cdr(struct xilinx_xcvr *xcvr,
 			      uint32_t drp_port, uint32_t lane_rate, uint32_t out_div,
@@ -89,6 +89,17 @@ static int max14906_iio_reg_read(struct max14906_iio_desc *, uint32_t,
 				 uint32_t *);
 static int max14906_iio_reg_write(struct max14906_iio_desc *, uint32_t,
 				  uint32_t);
+static int max14906_iio_submit(struct iio_device_data *);
+static int max14906_iio_trigger_handler(struct iio_device_data *);
+
+/* One byte per enabled input channel and scan, holding its level */
+static struct scan_type max14906_iio_scan_type = {
+	.sign = 'u',
+	.realbits = 1,
+	.storagebits = 8,
+	.shift = 0,
+	.is_big_endian = false,
+};
 
 static const uint32_t max14906_limit_avail[4] = {600, 130, 300, 1200};
 
@@ -158,6 +169,8 @@ static struct iio_attribute max14906_in_attrs[] = {
 };
 
 static struct iio_device max14906_iio_dev = {
+	.submit = (int32_t (*)())max14906_iio_submit,
+	.trigger_handler = (int32_t (*)())max14906_iio_trigger_handler,
 	.debug_reg_read = (int32_t (*)())max14906_iio_reg_read,
 	.debug_reg_write = (int32_t (*)())max14906_iio_reg_write,
 };
@@ -527,6 +540,9 @@ int max14906_iio_setup_channels(struct max14906_iio_desc *desc)
 		if (desc->channel_configs[i].function == MAX14906_IN) {
 			max14906_iio_channels[ch_offset].attributes = max14906_in_attrs;
 			max14906_iio_channels[ch_offset].ch_out = 0;
+			max14906_iio_channels[ch_offset].scan_index = ch_offset;
+			max14906_iio_channels[ch_offset].scan_type =
+				&max14906_iio_scan_type;
 		} else {
 			max14906_iio_channels[ch_offset].attributes = max14906_out_attrs;
 			max14906_iio_channels[ch_offset].ch_out = 1;
@@ -550,6 +566,65 @@ free_channels:
 	return ret;
 }
 
+/**
+ * @brief Push one scan of the enabled input channels to the buffer. All the
+ * levels are read with a single DoiLevel register access.
+ * @param dev_data - The iio device data structure.
+ * @return 0 in case of success, error code otherwise
+ */
+static int max14906_iio_push_scan(struct iio_device_data *dev_data)
+{
+	struct max14906_iio_desc *desc = dev_data->dev;
+	struct iio_channel *channels = desc->iio_dev->channels;
+	uint8_t scan[MAX14906_CHANNELS];
+	uint32_t levels;
+	uint32_t i, k = 0;
+	int ret;
+
+	ret = max14906_ch_get_all(desc->max14906_desc, &levels);
+	if (ret)
+		return ret;
+
+	for (i = 0; i < desc->iio_dev->num_ch; i++) {
+		if (!(dev_data->buffer->active_mask & NO_OS_BIT(i)))
+			continue;
+
+		scan[k++] = no_os_field_get(NO_OS_BIT(channels[i].address),
+					    levels);
+	}
+
+	return iio_buffer_push_scan(dev_data->buffer, scan);
+}
+
+/**
+ * @brief Fill the buffer with the requested number of input scans.
+ * @param dev_data - The iio device data structure.
+ * @return 0 in case of success, error code otherwise
+ */
+static int max14906_iio_submit(struct iio_device_data *dev_data)
+{
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < dev_data->buffer->samples; i++) {
+		ret = max14906_iio_push_scan(dev_data);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Read one scan of the input channels on each trigger event.
+ * @param dev_data - The iio device data structure.
+ * @return 0 in case of success, error code otherwise
+ */
+static int max14906_iio_trigger_handler(struct iio_device_data *dev_data)
+{
+	return max14906_iio_push_scan(dev_data);
+}
+
 /**
  * @brief Register read wrapper
  * @param dev - The iio device structure.
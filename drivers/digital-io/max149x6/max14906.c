@@ -83,6 +83,46 @@ int max14906_ch_set(struct max149x6_desc *desc, uint32_t ch, uint32_t val)
 				   MAX14906_HIGHO_MASK(ch) : 0);
 }
 
+/**
+ * @brief Read the (voltage) state of all the channels with a single frame.
+ * @param desc - device descriptor for the MAX14906
+ * @param vals - channel levels, bit n holding the level of channel n.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int max14906_ch_get_all(struct max149x6_desc *desc, uint32_t *vals)
+{
+	int ret;
+
+	if (!vals)
+		return -EINVAL;
+
+	ret = max149x6_reg_read(desc, MAX14906_DOILEVEL_REG, vals);
+	if (ret)
+		return ret;
+
+	*vals &= MAX14906_HIGHO_ALL_MASK;
+
+	return 0;
+}
+
+/**
+ * @brief Stage the (logic) state of several output channels. The SetOUT
+ * shadow copy is updated and the device is written by max149x6_commit()
+ * (or max149x6_chain_commit()), so all the outputs change with one frame.
+ * @param desc - device descriptor for the MAX14906
+ * @param mask - channels to change, bit n selecting channel n.
+ * @param vals - channel states, bit n holding the state of channel n.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int max14906_ch_set_multiple(struct max149x6_desc *desc, uint32_t mask,
+			     uint32_t vals)
+{
+	if (mask & ~MAX14906_HIGHO_ALL_MASK)
+		return -EINVAL;
+
+	return max149x6_reg_stage(desc, MAX14906_SETOUT_REG, mask, vals);
+}
+
 /**
  * @brief Configure a channel's function.
  * @param desc - device descriptor for the MAX14906
@@ -188,6 +228,7 @@ int max14906_init(struct max149x6_desc **desc,
 		goto err;
 
 	descriptor->crc_en = param->crc_en;
+	descriptor->shadow_mask = MAX14906_SHADOW_MASK;
 
 	ret = no_os_gpio_get_optional(&descriptor->en_gpio, param->en_gpio_param);
 	if (ret)
@@ -63,11 +63,18 @@
 #define MAX14906_CONFIG_CURR_LIM	0xE
 #define MAX14906_CONFIG_MASK		0xF
 
+/* Registers only changed by the host, kept in the shadow copy */
+#define MAX14906_SHADOW_MASK		(NO_OS_BIT(MAX14906_SETOUT_REG) | \
+					 NO_OS_BIT(MAX14906_SETLED_REG) | \
+					 NO_OS_GENMASK(MAX14906_CONFIG_MASK, \
+						       MAX14906_CONFIG1_REG))
+
 /* DoiLevel register */
 #define MAX14906_DOI_LEVEL_MASK(x)	NO_OS_BIT(x)
 
 /* SetOUT register */
 #define MAX14906_HIGHO_MASK(x)		NO_OS_BIT(x)
+#define MAX14906_HIGHO_ALL_MASK		NO_OS_GENMASK(3, 0)
 
 #define MAX14906_DO_MASK(x)		(NO_OS_GENMASK(1, 0) << (2 * (x)))
 #define MAX14906_CH_DIR_MASK(x)		NO_OS_BIT((x) + 4)
@@ -119,6 +126,12 @@ int max14906_ch_get(struct max149x6_desc *, uint32_t, uint32_t *);
 /** Set the state of a channel */
 int max14906_ch_set(struct max149x6_desc *, uint32_t, uint32_t);
 
+/** Read the state of all the channels */
+int max14906_ch_get_all(struct max149x6_desc *, uint32_t *);
+
+/** Stage the state of several channels, written by max149x6_commit() */
+int max14906_ch_set_multiple(struct max149x6_desc *, uint32_t, uint32_t);
+
 /** Configure a channel's function */
 int max14906_ch_func(struct max149x6_desc *, uint32_t, enum max14906_function);
 
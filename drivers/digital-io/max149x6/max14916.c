@@ -86,6 +86,39 @@ int max14916_ch_set(struct max149x6_desc *desc, uint32_t ch, uint32_t val)
 				   MAX14916_SETOUT_MASK(ch) : 0);
 }
 
+/**
+ * @brief Read the high-side switch state of all the channels with a single
+ * frame.
+ * @param desc - device descriptor for the MAX14916.
+ * @param vals - switch states, bit n holding the state of channel n.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int max14916_ch_get_all(struct max149x6_desc *desc, uint32_t *vals)
+{
+	if (!vals)
+		return -EINVAL;
+
+	return max149x6_reg_read(desc, MAX14916_SETOUT_REG, vals);
+}
+
+/**
+ * @brief Stage the (logic) state of several channels. The SetOUT shadow copy
+ * is updated and the device is written by max149x6_commit() (or
+ * max149x6_chain_commit()), so all the outputs change with one frame.
+ * @param desc - device descriptor for the MAX14916.
+ * @param mask - channels to change, bit n selecting channel n.
+ * @param vals - channel states, bit n holding the state of channel n.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int max14916_ch_set_multiple(struct max149x6_desc *desc, uint32_t mask,
+			     uint32_t vals)
+{
+	if (mask & ~MAX14916_SETOUT_ALL_MASK)
+		return -EINVAL;
+
+	return max149x6_reg_stage(desc, MAX14916_SETOUT_REG, mask, vals);
+}
+
 /**
  * @brief Read an output channel's current limit.
  * @param desc - device descriptor for the MAX14916.
@@ -222,6 +255,7 @@ int max14916_init(struct max149x6_desc **desc,
 		goto err;
 
 	descriptor->crc_en = param->crc_en;
+	descriptor->shadow_mask = MAX14916_SHADOW_MASK;
 
 	ret = no_os_gpio_get_optional(&descriptor->en_gpio,
 				      param->en_gpio_param);
@@ -65,7 +65,14 @@
 #define MAX14916_CONFIG2_REG		0xE
 #define MAX14916_MASK_REG		0xF
 
+/* Registers only changed by the host, kept in the shadow copy */
+#define MAX14916_SHADOW_MASK		(NO_OS_GENMASK(MAX14916_SET_SLED_REG, \
+						       MAX14916_SETOUT_REG) | \
+					 NO_OS_GENMASK(MAX14916_MASK_REG, \
+						       MAX14916_OW_OFF_EN_REG))
+
 #define MAX14916_SETOUT_MASK(x)		NO_OS_BIT(x)
+#define MAX14916_SETOUT_ALL_MASK	NO_OS_GENMASK(7, 0)
 #define MAX14916_SLED_CH_MASK(x)	NO_OS_BIT(x)
 #define MAX14916_SLED_MASK		NO_OS_BIT(1)
 #define MAX14916_FLED_MASK		NO_OS_BIT(0)
@@ -113,6 +120,12 @@ int max14916_ch_get(struct max149x6_desc *, uint32_t, uint32_t *);
 /** Set the state of a channel */
 int max14916_ch_set(struct max149x6_desc *, uint32_t, uint32_t);
 
+/** Read the state of all the channels */
+int max14916_ch_get_all(struct max149x6_desc *, uint32_t *);
+
+/** Stage the state of several channels, written by max149x6_commit() */
+int max14916_ch_set_multiple(struct max149x6_desc *, uint32_t, uint32_t);
+
 /** Set SLED to on/off */
 int max14916_sled_set(struct max149x6_desc *, uint32_t,
 		      enum max14916_sled_state);
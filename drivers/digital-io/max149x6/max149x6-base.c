@@ -108,6 +108,7 @@ int max149x6_reg_write(struct max149x6_desc *desc, uint32_t addr, uint32_t val)
 		.bytes_number = MAX149X6_FRAME_SIZE,
 		.cs_change = 1,
 	};
+	int ret;
 
 	desc->buff[0] = no_os_field_prep(MAX149X6_CHIP_ADDR_MASK, desc->chip_address) |
 			no_os_field_prep(MAX149X6_ADDR_MASK, addr) |
@@ -119,7 +120,17 @@ int max149x6_reg_write(struct max149x6_desc *desc, uint32_t addr, uint32_t val)
 		desc->buff[2] = max149x6_crc(desc->buff, true);
 	}
 
-	return no_os_spi_transfer(desc->comm_desc, &xfer, 1);
+	ret = no_os_spi_transfer(desc->comm_desc, &xfer, 1);
+	if (ret)
+		return ret;
+
+	if (addr < MAX149X6_NB_REGS) {
+		desc->shadow[addr] = val;
+		desc->shadow_valid |= NO_OS_BIT(addr);
+		desc->shadow_dirty &= ~NO_OS_BIT(addr);
+	}
+
+	return 0;
 }
 
 /**
@@ -163,11 +174,35 @@ int max149x6_reg_read(struct max149x6_desc *desc, uint32_t addr, uint32_t *val)
 
 	*val = desc->buff[1];
 
+	/* Don't drop the updates staged for this register */
+	if (addr < MAX149X6_NB_REGS &&
+	    !(desc->shadow_dirty & NO_OS_BIT(addr))) {
+		desc->shadow[addr] = *val;
+		desc->shadow_valid |= NO_OS_BIT(addr);
+	}
+
 	return 0;
 }
 
+/**
+ * @brief Check if a register is served from its shadow copy
+ * @param desc - device descriptor for the MAX149X6
+ * @param addr - address of the register
+ * @return true if the shadow copy matches the device (or holds staged updates)
+ */
+static bool max149x6_shadowed(struct max149x6_desc *desc, uint32_t addr)
+{
+	if (addr >= MAX149X6_NB_REGS)
+		return false;
+
+	return desc->shadow_mask & desc->shadow_valid & NO_OS_BIT(addr);
+}
+
 /**
  * @brief Update the value of a device register (read/write sequence).
+ * For the shadowed registers the read is skipped and the write is skipped as
+ * well if the value doesn't change. Updates previously staged for the
+ * register are written along.
  * @param desc - device descriptor for the MAX149X6
  * @param addr - address of the register
  * @param mask - bit mask of the field to be updated
@@ -180,13 +215,245 @@ int max149x6_reg_update(struct max149x6_desc *desc, uint32_t addr,
 {
 	int ret;
 	uint32_t reg_val = 0;
+	uint32_t new_val;
 
-	ret = max149x6_reg_read(desc, addr, &reg_val);
-	if (ret)
-		return ret;
+	if (max149x6_shadowed(desc, addr)) {
+		reg_val = desc->shadow[addr];
+	} else {
+		ret = max149x6_reg_read(desc, addr, &reg_val);
+		if (ret)
+			return ret;
+	}
+
+	new_val = (reg_val & ~mask) | (mask & val);
+	if (max149x6_shadowed(desc, addr) && new_val == reg_val &&
+	    !(desc->shadow_dirty & NO_OS_BIT(addr)))
+		return 0;
+
+	return max149x6_reg_write(desc, addr, new_val);
+}
+
+/**
+ * @brief Stage a field update of a shadowed register. Nothing is written to
+ * the device until max149x6_commit() (or a max149x6_reg_update() of the same
+ * register), so several fields or channels may be changed at once.
+ * @param desc - device descriptor for the MAX149X6
+ * @param addr - address of the register
+ * @param mask - bit mask of the field to be updated
+ * @param val - value of the masked field, already shifted
+ * @return 0 in case of success, negative error code otherwise
+ */
+int max149x6_reg_stage(struct max149x6_desc *desc, uint32_t addr,
+		       uint32_t mask, uint32_t val)
+{
+	uint32_t reg_val;
+	int ret;
+
+	if (!desc || addr >= MAX149X6_NB_REGS ||
+	    !(desc->shadow_mask & NO_OS_BIT(addr)))
+		return -EINVAL;
+
+	if (!max149x6_shadowed(desc, addr)) {
+		ret = max149x6_reg_read(desc, addr, &reg_val);
+		if (ret)
+			return ret;
+	}
+
+	desc->shadow[addr] = (desc->shadow[addr] & ~mask) | (mask & val);
+	desc->shadow_dirty |= NO_OS_BIT(addr);
+
+	return 0;
+}
+
+/**
+ * @brief Write the staged register updates to the device, one frame for
+ * each changed register.
+ * @param desc - device descriptor for the MAX149X6
+ * @return 0 in case of success, negative error code otherwise
+ */
+int max149x6_commit(struct max149x6_desc *desc)
+{
+	uint32_t addr;
+	int ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	while (desc->shadow_dirty) {
+		addr = no_os_find_first_set_bit(desc->shadow_dirty);
+		ret = max149x6_reg_write(desc, addr, desc->shadow[addr]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Build the frame of a register access
+ * @param desc - device descriptor for the MAX149X6
+ * @param addr - address of the register
+ * @param write - true for a write access
+ * @param val - value to write
+ * @param frame - frame buffer, MAX149X6_FRAME_SIZE + crc_en bytes
+ */
+static void max149x6_frame_prep(struct max149x6_desc *desc, uint32_t addr,
+				bool write, uint32_t val, uint8_t *frame)
+{
+	frame[0] = no_os_field_prep(MAX149X6_CHIP_ADDR_MASK,
+				    desc->chip_address) |
+		   no_os_field_prep(MAX149X6_ADDR_MASK, addr) |
+		   no_os_field_prep(MAX149X6_RW_MASK, write);
+	frame[1] = write ? val : 0;
+
+	if (desc->crc_en)
+		frame[2] = max149x6_crc(frame, true);
+}
+
+/**
+ * @brief Check that the devices can be accessed as one daisy chain
+ * @param devs - devices of the chain, devs[0] is connected to the controller's
+ * 		 SDO and devs[nb_devs - 1] to its SDI.
+ * @param nb_devs - number of devices in the chain
+ * @return frame size of every device, negative error code otherwise
+ */
+static int max149x6_chain_check(struct max149x6_desc **devs, uint32_t nb_devs)
+{
+	uint32_t i;
+
+	if (!devs || !nb_devs || nb_devs > MAX149X6_CHAIN_MAX || !devs[0])
+		return -EINVAL;
+
+	for (i = 1; i < nb_devs; i++)
+		if (!devs[i] || devs[i]->comm_desc != devs[0]->comm_desc ||
+		    devs[i]->crc_en != devs[0]->crc_en)
+			return -EINVAL;
+
+	return MAX149X6_FRAME_SIZE + devs[0]->crc_en;
+}
+
+/**
+ * @brief Write the staged register updates of the devices in a daisy chain.
+ * Every transaction carries one frame per device, so the devices are updated
+ * together and the number of transactions is given by the device with the
+ * most changed registers. Devices with nothing left to write get a read of
+ * their first register.
+ * @param devs - devices of the chain, devs[0] is connected to the controller's
+ * 		 SDO and devs[nb_devs - 1] to its SDI.
+ * @param nb_devs - number of devices in the chain
+ * @return 0 in case of success, negative error code otherwise
+ */
+int max149x6_chain_commit(struct max149x6_desc **devs, uint32_t nb_devs)
+{
+	uint8_t buf[MAX149X6_CHAIN_MAX * (MAX149X6_FRAME_SIZE + 1)];
+	int32_t addrs[MAX149X6_CHAIN_MAX];
+	struct no_os_spi_msg xfer = {
+		.tx_buff = buf,
+		.cs_change = 1,
+	};
+	struct max149x6_desc *dev;
+	uint8_t *slot;
+	bool pending;
+	uint32_t i;
+	int frame;
+	int ret;
+
+	frame = max149x6_chain_check(devs, nb_devs);
+	if (frame < 0)
+		return frame;
+
+	xfer.bytes_number = frame * nb_devs;
+
+	do {
+		pending = false;
+		/* The first frame shifted in ends up in the last device */
+		for (i = 0; i < nb_devs; i++) {
+			dev = devs[i];
+			slot = &buf[(nb_devs - 1 - i) * frame];
+			if (!dev->shadow_dirty) {
+				addrs[i] = -1;
+				max149x6_frame_prep(dev, 0, false, 0, slot);
+				continue;
+			}
 
-	reg_val &= ~mask;
-	reg_val |= mask & val;
+			addrs[i] = no_os_find_first_set_bit(dev->shadow_dirty);
+			max149x6_frame_prep(dev, addrs[i], true,
+					    dev->shadow[addrs[i]], slot);
+			pending = true;
+		}
 
-	return max149x6_reg_write(desc, addr, reg_val);
+		if (!pending)
+			break;
+
+		ret = no_os_spi_transfer(devs[0]->comm_desc, &xfer, 1);
+		if (ret)
+			return ret;
+
+		for (i = 0; i < nb_devs; i++) {
+			if (addrs[i] < 0)
+				continue;
+
+			devs[i]->shadow_valid |= NO_OS_BIT(addrs[i]);
+			devs[i]->shadow_dirty &= ~NO_OS_BIT(addrs[i]);
+		}
+	} while (pending);
+
+	return 0;
+}
+
+/**
+ * @brief Read the same register of every device in a daisy chain, e.g. the
+ * input levels. In daisy chain mode the read data is shifted out during the
+ * transaction following the read command, so two transactions are issued
+ * whatever the number of devices.
+ * @param devs - devices of the chain, devs[0] is connected to the controller's
+ * 		 SDO and devs[nb_devs - 1] to its SDI.
+ * @param nb_devs - number of devices in the chain
+ * @param addr - address of the register
+ * @param vals - register value of each device
+ * @return 0 in case of success, negative error code otherwise
+ */
+int max149x6_chain_reg_read(struct max149x6_desc **devs, uint32_t nb_devs,
+			    uint32_t addr, uint32_t *vals)
+{
+	uint8_t tx[MAX149X6_CHAIN_MAX * (MAX149X6_FRAME_SIZE + 1)];
+	uint8_t rx[MAX149X6_CHAIN_MAX * (MAX149X6_FRAME_SIZE + 1)];
+	struct no_os_spi_msg xfer = {
+		.tx_buff = tx,
+		.rx_buff = rx,
+		.cs_change = 1,
+	};
+	uint8_t *resp;
+	uint32_t i;
+	int frame;
+	int ret;
+
+	frame = max149x6_chain_check(devs, nb_devs);
+	if (frame < 0)
+		return frame;
+
+	if (!vals)
+		return -EINVAL;
+
+	xfer.bytes_number = frame * nb_devs;
+	for (i = 0; i < nb_devs; i++)
+		max149x6_frame_prep(devs[i], addr, false, 0,
+				    &tx[(nb_devs - 1 - i) * frame]);
+
+	for (i = 0; i < 2; i++) {
+		ret = no_os_spi_transfer(devs[0]->comm_desc, &xfer, 1);
+		if (ret)
+			return ret;
+	}
+
+	/* The last device in the chain is the first one to answer */
+	for (i = 0; i < nb_devs; i++) {
+		resp = &rx[(nb_devs - 1 - i) * frame];
+		if (devs[i]->crc_en && max149x6_crc(resp, false) != resp[2])
+			return -EINVAL;
+
+		vals[i] = resp[1];
+	}
+
+	return 0;
 }
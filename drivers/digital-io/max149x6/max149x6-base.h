@@ -54,6 +54,12 @@
 #define MAX149X6_ADDR_MASK		NO_OS_GENMASK(4, 1)
 #define MAX149X6_RW_MASK		NO_OS_BIT(0)
 
+/* Number of registers addressable by a frame */
+#define MAX149X6_NB_REGS		16
+
+/* Maximum number of devices in a daisy chain */
+#define MAX149X6_CHAIN_MAX		8
+
 /**
  * @brief Initialization parameter for the MAX149X6 device.
  */
@@ -79,6 +85,14 @@ struct max149x6_desc {
 	struct no_os_gpio_desc *synch_gpio;
 	uint8_t buff[MAX149X6_FRAME_SIZE + 1];
 	bool crc_en;
+	/* Shadow copies of the registers only changed by the host */
+	uint8_t shadow[MAX149X6_NB_REGS];
+	/* Registers which may be served from their shadow copy */
+	uint16_t shadow_mask;
+	/* Shadow copies known to match the device */
+	uint16_t shadow_valid;
+	/* Shadow copies staged but not yet written to the device */
+	uint16_t shadow_dirty;
 };
 
 /** Write the value of a device register */
@@ -90,4 +104,17 @@ int max149x6_reg_read(struct max149x6_desc *, uint32_t, uint32_t *);
 /** Update the value of a device register */
 int max149x6_reg_update(struct max149x6_desc *, uint32_t, uint32_t, uint32_t);
 
+/** Stage a register field update, written by max149x6_commit() */
+int max149x6_reg_stage(struct max149x6_desc *, uint32_t, uint32_t, uint32_t);
+
+/** Write the staged register updates to the device */
+int max149x6_commit(struct max149x6_desc *);
+
+/** Write the staged register updates of a daisy chain */
+int max149x6_chain_commit(struct max149x6_desc **, uint32_t);
+
+/** Read the same register of every device in a daisy chain */
+int max149x6_chain_reg_read(struct max149x6_desc **, uint32_t, uint32_t,
+			    uint32_t *);
+
 #endif
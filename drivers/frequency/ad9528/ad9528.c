@@ -722,7 +722,7 @@ int32_t ad9528_setup(struct ad9528_dev **device,
 	uint32_t pll2_ndiv, pll2_ndiv_a_cnt, pll2_ndiv_b_cnt;
 	struct ad9528_dev *dev;
 	struct no_os_clk_desc **clocks = NULL;
-	struct no_os_clk_init_param clk_init;
+	struct no_os_clk_init_param clk_init = { 0 };
 	const char *names[AD9528_NUM_CHAN] = {
 		"ad9528-1_out0", "ad9528-1_out1", "ad9528-1_out2", "ad9528-1_out3", "ad9528-1_out4",
 		"ad9528-1_out5", "ad9528-1_out6", "ad9528-1_out7", "ad9528-1_out8", "ad9528-1_out9",
@@ -1477,7 +1477,7 @@ int32_t hmc7044_init(struct hmc7044_dev **device,
 	int32_t ret;
 	unsigned int i;
 	struct no_os_clk_desc **clocks = NULL;
-	struct no_os_clk_init_param clk_init;
+	struct no_os_clk_init_param clk_init = { 0 };
 	const char *names[HMC7044_NUM_CHAN] = {
 		"clock_0", "clock_1", "clock_2", "clock_3", "clock_4",
 		"clock_5", "clock_6", "clock_7", "clock_8", "clock_9",
@@ -1691,6 +1691,65 @@ int32_t hmc7044_set_rate(struct no_os_clk_desc *desc,
 				    rate);
 }
 
+/**
+ * @brief Set the rate of several channels in one pass. All the dividers are
+ * computed first, so nothing is written if one of the channels is unknown,
+ * and only the dividers that change are written.
+ *
+ * @param descs - The CLK descriptors, all of the same device.
+ * @param rates - The desired rates.
+ * @param nb_clks - Number of channels.
+ *
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int hmc7044_set_rates(struct no_os_clk_desc **descs,
+			     const uint64_t *rates, uint32_t nb_clks)
+{
+	struct hmc7044_chan_spec *chans[HMC7044_NUM_CHAN];
+	struct hmc7044_chan_spec *chan;
+	uint32_t divs[HMC7044_NUM_CHAN];
+	struct hmc7044_dev *dev;
+	uint32_t i, j;
+	int32_t ret;
+
+	if (!nb_clks || nb_clks > HMC7044_NUM_CHAN)
+		return -EINVAL;
+
+	dev = descs[0]->dev_desc;
+	for (i = 0; i < nb_clks; i++) {
+		chans[i] = NULL;
+		for (j = 0; j < dev->num_channels; j++) {
+			if (dev->channels[j].num == descs[i]->hw_ch_num) {
+				chans[i] = &dev->channels[j];
+				break;
+			}
+		}
+		if (!chans[i])
+			return -EINVAL;
+
+		divs[i] = hmc7044_calc_out_div(rates[i], dev->pll2_freq);
+	}
+
+	for (i = 0; i < nb_clks; i++) {
+		chan = chans[i];
+		if (chan->divider == divs[i])
+			continue;
+
+		chan->divider = divs[i];
+		ret = hmc7044_write(dev, HMC7044_REG_CH_OUT_CRTL_1(chan->num),
+				    HMC7044_DIV_LSB(divs[i]));
+		if (ret < 0)
+			return ret;
+
+		ret = hmc7044_write(dev, HMC7044_REG_CH_OUT_CRTL_2(chan->num),
+				    HMC7044_DIV_MSB(divs[i]));
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
 /**
  * @brief hmc7044 clock ops
  */
@@ -1698,4 +1757,5 @@ const struct no_os_clk_platform_ops hmc7044_clk_ops = {
 	.clk_recalc_rate =&hmc7044_recalc_rate,
 	.clk_round_rate = &hmc7044_round_rate,
 	.clk_set_rate = &hmc7044_set_rate,
+	.clk_set_rates = &hmc7044_set_rates,
 };
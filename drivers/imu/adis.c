@@ -4091,6 +4091,54 @@ int adis_read_burst_data(struct adis_dev *adis, struct adis_burst_data *data,
 	return 0;
 }
 
+/**
+ * @brief Read multiple bursts from the device FIFO in a single SPI transfer.
+ * @param adis      - The adis device.
+ * @param buf       - Buffer for nb_bursts frames, each of the size given by
+ *		      adis_get_fifo_burst_layout().
+ * @param nb_bursts - Number of frames to read. All the requests but the last
+ *		      one pop the FIFO.
+ * @param burst32   - True if 32-bit data is requested for accel
+ *		      and gyro (or delta angle and delta velocity)
+ *		      measurements, false if 16-bit data is requested.
+ * @param burst_sel - 0 if accel and gyro data is requested, 1
+ *		      if delta angle and delta velocity is requested.
+ * @param valid     - Mask of the frames which hold data and passed the
+ *		      checksum validation.
+ * @return 0 in case of success, error code otherwise.
+ * -EAGAIN in case the request has to be sent again due to the burst
+ * configuration being changed.
+ */
+int adis_read_fifo_bursts(struct adis_dev *adis, uint8_t *buf,
+			  uint32_t nb_bursts, bool burst32, uint8_t burst_sel,
+			  uint32_t *valid)
+{
+	if (!adis || !buf || !valid || !nb_bursts
+	    || nb_bursts > ADIS_FIFO_BURSTS_MAX)
+		return -EINVAL;
+
+	if (!adis->info->read_fifo_bursts)
+		return -ENOSYS;
+
+	return adis->info->read_fifo_bursts(adis, buf, nb_bursts, burst32,
+					    burst_sel, valid);
+}
+
+/**
+ * @brief Get the layout of a FIFO burst frame.
+ * @param adis    - The adis device.
+ * @param burst32 - True for the 32-bit burst frame, false for the 16-bit one.
+ * @return the frame layout, NULL if the device has no FIFO.
+ */
+const struct adis_burst_layout *adis_get_fifo_burst_layout(
+	struct adis_dev *adis, bool burst32)
+{
+	if (!adis || !adis->info->fifo_burst_layout)
+		return NULL;
+
+	return &adis->info->fifo_burst_layout[burst32];
+}
+
 /**
  * @brief Update external clock frequency.
  * @param adis     - The adis device.
@@ -70,6 +70,9 @@
 #define ADIS_SYNC_OUTPUT	3
 #define ADIS_SYNC_PULSE		5
 
+/* Maximum number of FIFO bursts read in a single SPI transfer */
+#define ADIS_FIFO_BURSTS_MAX	32
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -270,6 +273,23 @@ struct adis_burst_data {
 	uint16_t z_accel_msb;
 };
 
+/** @struct adis_burst_layout
+ *  @brief ADIS burst frame layout, offsets in bytes from the frame start
+ *  (including the burst command)
+ */
+struct adis_burst_layout {
+	/** Frame size in bytes, including the command and the checksum. */
+	uint8_t size;
+	/** Offset of the first gyroscope (or delta angle) word. */
+	uint8_t axis_offset;
+	/** Offset of the temperature word. */
+	uint8_t temp_offset;
+	/** Offset of the data counter word. */
+	uint8_t data_cntr_offset;
+	/** Offset of the first byte covered by the checksum. */
+	uint8_t checksum_idx;
+};
+
 /** @struct adis_dev
  *  @brief ADIS device descriptor structure
  */
@@ -914,6 +934,15 @@ int adis_write_fir_coef(struct adis_dev *adis, uint8_t coef_idx, uint32_t coef);
 int adis_read_burst_data(struct adis_dev *adis,struct adis_burst_data *data,
 			 bool burst32, uint8_t burst_sel, bool fifo_pop, bool crc_check);
 
+/*! Read multiple bursts from the device FIFO in a single SPI transfer */
+int adis_read_fifo_bursts(struct adis_dev *adis, uint8_t *buf,
+			  uint32_t nb_bursts, bool burst32, uint8_t burst_sel,
+			  uint32_t *valid);
+
+/*! Get the layout of a FIFO burst frame */
+const struct adis_burst_layout *adis_get_fifo_burst_layout(
+	struct adis_dev *adis, bool burst32);
+
 /*! Update external clock frequency. */
 int adis_update_ext_clk_freq(struct adis_dev *adis, uint32_t clk_freq);
 
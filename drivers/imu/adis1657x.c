@@ -55,6 +55,8 @@
 #define ADIS1657X_MSG_SIZE_32_BIT_BURST_FIFO	34 /* in bytes */
 #define ADIS1657X_READ_BURST_DATA_NO_POP	0x00
 #define ADIS1657X_CHECKSUM_BUF_IDX_FIFO		2
+/* From data-sheet, minimum time between FIFO reads */
+#define ADIS1657X_FIFO_READ_DELAY_US		10
 
 /******************************************************************************/
 /************************** Variable Definitions ******************************/
@@ -145,6 +147,26 @@ static const struct adis_data_field_map_def adis1657x_def = {
 	.diag_aduc_mcu_fault_mask 		= NO_OS_BIT(15),
 };
 
+/* FIFO burst frames: diag, axis data, temperature, data counter, checksum */
+static const struct adis_burst_layout adis1657x_fifo_burst_layout[] = {
+	{
+		.size = ADIS_READ_BURST_DATA_CMD_SIZE +
+		ADIS1657X_MSG_SIZE_16_BIT_BURST_FIFO,
+		.axis_offset = 4,
+		.temp_offset = 16,
+		.data_cntr_offset = 18,
+		.checksum_idx = 4,
+	},
+	{
+		.size = ADIS_READ_BURST_DATA_CMD_SIZE +
+		ADIS1657X_MSG_SIZE_32_BIT_BURST_FIFO,
+		.axis_offset = 4,
+		.temp_offset = 28,
+		.data_cntr_offset = 30,
+		.checksum_idx = 4,
+	},
+};
+
 static const struct adis_timeout adis1657x_timeouts = {
 	.reset_ms 			= 350,
 	.fact_calib_restore_ms		= 150,
@@ -384,6 +406,100 @@ int adis1657x_read_burst_data(struct adis_dev *adis,
 	return 0;
 }
 
+/**
+ * @brief Read multiple bursts from the FIFO in a single SPI transfer.
+ * @param adis      - The adis device.
+ * @param buf       - Buffer for nb_bursts frames.
+ * @param nb_bursts - Number of frames to read. The last request does not pop
+ *		      the FIFO, it only clocks out the previously popped sample.
+ * @param burst32   - True if 32-bit data is requested for accel
+ *		      and gyro (or delta angle and delta velocity)
+ *		      measurements, false if 16-bit data is requested.
+ * @param burst_sel - 0 if accel and gyro data is requested, 1
+ *		      if delta angle and delta velocity is requested.
+ * @param valid     - Mask of the frames which hold data and passed the
+ *		      checksum validation.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int adis1657x_read_fifo_bursts(struct adis_dev *adis, uint8_t *buf,
+				      uint32_t nb_bursts, bool burst32,
+				      uint8_t burst_sel, uint32_t *valid)
+{
+	const struct adis_burst_layout *layout;
+	struct no_os_spi_msg msgs[ADIS_FIFO_BURSTS_MAX];
+	bool checksum_err = false;
+	uint8_t *frame;
+	uint8_t diag = 0;
+	uint32_t i, j;
+	int ret = 0;
+
+	if (adis->burst32 != burst32) {
+		ret = adis_write_burst32(adis, burst32);
+		if (ret)
+			return ret;
+		ret = -EAGAIN;
+	}
+	if (adis->burst_sel != burst_sel) {
+		ret = adis_write_burst_sel(adis, burst_sel);
+		if (ret)
+			return ret;
+		ret = -EAGAIN;
+	}
+
+	/* The new burst format is available only after the next data ready */
+	if (ret == -EAGAIN)
+		return ret;
+
+	layout = &adis1657x_fifo_burst_layout[burst32];
+	for (i = 0; i < nb_bursts; i++) {
+		frame = &buf[i * layout->size];
+		if (i == nb_bursts - 1)
+			frame[0] = ADIS1657X_READ_BURST_DATA_NO_POP;
+		else
+			frame[0] = ADIS_READ_BURST_DATA_CMD_MSB;
+		frame[1] = ADIS_READ_BURST_DATA_CMD_LSB;
+
+		msgs[i] = (struct no_os_spi_msg) {
+			.tx_buff = frame,
+			.rx_buff = frame,
+			.bytes_number = layout->size,
+			.cs_change = 1,
+			.cs_change_delay = ADIS1657X_FIFO_READ_DELAY_US,
+		};
+	}
+
+	ret = no_os_spi_transfer(adis->spi_desc, msgs, nb_bursts);
+	if (ret)
+		return ret;
+
+	*valid = 0;
+	for (i = 0; i < nb_bursts; i++) {
+		frame = &buf[i * layout->size];
+
+		/* An empty FIFO is read as all zeros */
+		for (j = ADIS_READ_BURST_DATA_CMD_SIZE; j < layout->size; j++)
+			if (frame[j])
+				break;
+		if (j == layout->size)
+			continue;
+
+		if (!adis_validate_checksum(frame, layout->size,
+					    layout->checksum_idx)) {
+			checksum_err = true;
+			continue;
+		}
+
+		diag = frame[ADIS_READ_BURST_DATA_CMD_SIZE];
+		*valid |= NO_OS_BIT(i);
+	}
+
+	adis->diag_flags.checksum_err = checksum_err;
+	if (*valid)
+		adis_update_diag_flags(adis, diag);
+
+	return 0;
+}
+
 const struct adis_chip_info adis1657x_chip_info = {
 	.field_map		= &adis1657x_def,
 	.sync_clk_freq_limits	= adis1657x_sync_clk_freq_limits,
@@ -401,4 +517,6 @@ const struct adis_chip_info adis1657x_chip_info = {
 	.flags			= ADIS_HAS_BURST32 | ADIS_HAS_BURST_DELTA_DATA | ADIS_HAS_FIFO,
 	.get_scale		= &adis1657x_get_scale,
 	.read_burst_data	= &adis1657x_read_burst_data,
+	.fifo_burst_layout	= adis1657x_fifo_burst_layout,
+	.read_fifo_bursts	= &adis1657x_read_fifo_bursts,
 };
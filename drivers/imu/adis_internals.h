@@ -479,6 +479,12 @@ struct adis_chip_info {
 	/** Chip specifc implementation for reading burst data. */
 	int (*read_burst_data)(struct adis_dev *adis,struct adis_burst_data *data,
 			       bool burst32, uint8_t burst_sel, bool fifo_pop, bool crc_check);
+	/** Chip specific FIFO burst frame layouts, indexed by burst32. */
+	const struct adis_burst_layout		*fifo_burst_layout;
+	/** Chip specific implementation for reading multiple FIFO bursts. */
+	int (*read_fifo_bursts)(struct adis_dev *adis, uint8_t *buf,
+				uint32_t nb_bursts, bool burst32,
+				uint8_t burst_sel, uint32_t *valid);
 	/** Chip specific implementation for reading channel offset. */
 	int (*get_offset)(struct adis_dev *adis,
 			  int *offset,
@@ -43,9 +43,11 @@
 
 #include "iio_adis_internals.h"
 #include "no_os_delay.h"
+#include "no_os_alloc.h"
 #include "no_os_units.h"
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
 #include "adis.h"
 #include "adis_internals.h"
 #include "iio_trigger.h"
@@ -57,10 +59,38 @@
 #define ADIS_BURST_DATA_SEL_0_CHN_MASK	NO_OS_GENMASK(5, 0)
 #define ADIS_BURST_DATA_SEL_1_CHN_MASK	NO_OS_GENMASK(12, 7)
 
+/* Sample-set word which is not read from the device */
+#define ADIS_IIO_SCAN_ZERO		0xFF
+/* Burst word pairs: gyro x, y, z, accel x, y, z and temperature */
+#define ADIS_IIO_BURST_PAIRS		7
+#define ADIS_IIO_TEMP_PAIR		6
+/* Data counter period in scaled sync mode */
+#define ADIS_IIO_SCALED_CNTR_PERIOD_US	49
+
+#define ADIS_IIO_BURST_SRC(field) { \
+	offsetof(struct adis_burst_data, field##_msb), \
+	offsetof(struct adis_burst_data, field##_lsb), \
+}
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/******************************************************************************/
+/************************** Variable Definitions ******************************/
+/******************************************************************************/
+
+/* Upper and lower word offsets in struct adis_burst_data for each pair */
+static const uint8_t adis_iio_burst_data_src[ADIS_IIO_BURST_PAIRS][2] = {
+	ADIS_IIO_BURST_SRC(x_gyro),
+	ADIS_IIO_BURST_SRC(y_gyro),
+	ADIS_IIO_BURST_SRC(z_gyro),
+	ADIS_IIO_BURST_SRC(x_accel),
+	ADIS_IIO_BURST_SRC(y_accel),
+	ADIS_IIO_BURST_SRC(z_accel),
+	ADIS_IIO_BURST_SRC(temp),
+};
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -1409,6 +1439,182 @@ int adis_iio_write_debug_attrs(void *dev, char *buf, uint32_t len,
 	}
 }
 
+/**
+ * @brief Build the table which maps each word of a sample-set to a word of the
+ *        burst data, based on the active channels.
+ * @param iio_adis - The iio adis structure.
+ * @param mask     - The active channels mask.
+ * @param src      - Upper and lower word byte offsets of each burst pair.
+ * @param map      - The sample-set map to be filled.
+ */
+static void adis_iio_build_scan_map(struct adis_iio_dev *iio_adis,
+				    uint32_t mask,
+				    const uint8_t (*src)[2], uint8_t *map)
+{
+	struct iio_channel *channels = iio_adis->iio_dev->channels;
+	uint8_t storagebits;
+	uint8_t chan;
+	uint8_t pair;
+	uint8_t i = 0;
+	bool delta;
+
+	for (chan = 0; chan < ADIS_NUM_CHAN; chan++) {
+		if (!(mask & NO_OS_BIT(chan)))
+			continue;
+
+		if (chan == ADIS_TEMP) {
+			storagebits = channels[chan].scan_type->storagebits;
+			if (storagebits == 32)
+				map[i++] = src[ADIS_IIO_TEMP_PAIR][0];
+
+			map[i++] = src[ADIS_IIO_TEMP_PAIR][1];
+			/*
+			 * The temperature channel has 16-bit storage size.
+			 * We need to perform the padding to have the buffer
+			 * elements naturally aligned in case there are any
+			 * 32-bit storage size channels enabled which have a
+			 * scan index higher than the temperature channel scan
+			 * index.
+			 */
+			if (mask & ADIS_BURST_DATA_SEL_1_CHN_MASK
+			    && storagebits == 16)
+				map[i++] = ADIS_IIO_SCAN_ZERO;
+			continue;
+		}
+
+		/* Burst select chooses between gyro/accel and delta data */
+		delta = chan > ADIS_TEMP;
+		pair = delta ? chan - ADIS_DELTA_ANGL_X : chan;
+		if (delta != !!iio_adis->burst_sel) {
+			map[i++] = ADIS_IIO_SCAN_ZERO;
+			map[i++] = ADIS_IIO_SCAN_ZERO;
+		} else {
+			/* upper 16 */
+			map[i++] = src[pair][0];
+			/* lower 16 */
+			map[i++] = src[pair][1];
+		}
+	}
+
+	iio_adis->scan_words = i;
+}
+
+/**
+ * @brief Fill the sample-set buffer from burst data, using a sample-set map.
+ * @param iio_adis - The iio adis structure.
+ * @param map      - The sample-set map.
+ * @param src      - The burst data.
+ */
+static void adis_iio_repack(struct adis_iio_dev *iio_adis, const uint8_t *map,
+			    const uint8_t *src)
+{
+	uint8_t i;
+
+	for (i = 0; i < iio_adis->scan_words; i++) {
+		if (map[i] == ADIS_IIO_SCAN_ZERO)
+			iio_adis->data[i] = 0;
+		else
+			memcpy(&iio_adis->data[i], &src[map[i]], 2);
+	}
+}
+
+/**
+ * @brief Allocate the FIFO frame buffer and build the FIFO sample-set map.
+ * @param iio_adis - The iio adis structure.
+ * @param mask     - The active channels mask.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int adis_iio_fifo_setup(struct adis_iio_dev *iio_adis, uint32_t mask)
+{
+	const struct adis_burst_layout *layout;
+	uint8_t src[ADIS_IIO_BURST_PAIRS][2];
+	uint8_t i;
+
+	/* Size the frame buffer for the largest (32-bit) burst */
+	layout = adis_get_fifo_burst_layout(iio_adis->adis_dev, true);
+	if (!layout)
+		return -EINVAL;
+
+	if (!iio_adis->fifo_buf) {
+		iio_adis->fifo_buf = no_os_calloc(ADIS_FIFO_BURSTS_MAX,
+						  layout->size);
+		if (!iio_adis->fifo_buf)
+			return -ENOMEM;
+	}
+
+	layout = adis_get_fifo_burst_layout(iio_adis->adis_dev,
+					    iio_adis->burst_size);
+	for (i = 0; i < ADIS_IIO_TEMP_PAIR; i++) {
+		if (iio_adis->burst_size) {
+			/* Lower word is sent first */
+			src[i][0] = layout->axis_offset + 4 * i + 2;
+			src[i][1] = layout->axis_offset + 4 * i;
+		} else {
+			src[i][0] = layout->axis_offset + 2 * i;
+			src[i][1] = ADIS_IIO_SCAN_ZERO;
+		}
+	}
+	src[ADIS_IIO_TEMP_PAIR][0] = ADIS_IIO_SCAN_ZERO;
+	src[ADIS_IIO_TEMP_PAIR][1] = layout->temp_offset;
+
+	adis_iio_build_scan_map(iio_adis, mask, src, iio_adis->fifo_scan_map);
+
+	return 0;
+}
+
+/**
+ * @brief Account the data counter of a sample, updating the lost samples
+ *        count and the reconstructed sample timestamp.
+ * @param iio_adis  - The iio adis structure.
+ * @param data_cntr - The data counter of the sample.
+ * @return true if the sample is new, false if it was already pushed.
+ */
+static bool adis_iio_update_data_cntr(struct adis_iio_dev *iio_adis,
+				      uint32_t data_cntr)
+{
+	uint32_t elapsed_us;
+	uint32_t period_us;
+	uint32_t lost = 0;
+	uint32_t delta;
+
+	if (!iio_adis->data_cntr_valid) {
+		iio_adis->data_cntr_valid = true;
+		iio_adis->data_cntr = data_cntr;
+		return true;
+	}
+
+	/* No new data */
+	if (data_cntr == iio_adis->data_cntr)
+		return false;
+
+	/* 16-bit data counters overflow at NO_OS_U16_MAX */
+	if (data_cntr < iio_adis->data_cntr &&
+	    iio_adis->data_cntr <= NO_OS_U16_MAX)
+		delta = (uint16_t)(data_cntr - iio_adis->data_cntr);
+	else
+		delta = data_cntr - iio_adis->data_cntr;
+
+	iio_adis->data_cntr = data_cntr;
+
+	if (iio_adis->sync_mode != ADIS_SYNC_SCALED) {
+		lost = delta - 1;
+		iio_adis->stats.timestamp_ns += (uint64_t)delta *
+						iio_adis->sample_period_ns;
+	} else {
+		elapsed_us = delta * ADIS_IIO_SCALED_CNTR_PERIOD_US;
+		period_us = iio_adis->sample_period_ns / 1000;
+		if (period_us && elapsed_us > period_us)
+			lost = NO_OS_DIV_ROUND_CLOSEST(elapsed_us,
+						       period_us) - 1;
+		iio_adis->stats.timestamp_ns += (uint64_t)elapsed_us * 1000;
+	}
+
+	iio_adis->samples_lost += lost;
+	iio_adis->stats.lost += lost;
+
+	return true;
+}
+
 /**
  * @brief API to be called before trigger is enabled.
  * @param dev  - The iio device structure.
@@ -1448,10 +1654,27 @@ int adis_iio_pre_enable(void* dev, uint32_t mask)
 	else
 		iio_adis->burst_size = 0;
 
+	ret = adis_iio_get_freq(adis, &iio_adis->sampling_frequency);
+	if (ret)
+		return ret;
+
 	iio_adis->samples_lost = 0;
 	iio_adis->data_cntr = 0;
+	iio_adis->data_cntr_valid = false;
+	iio_adis->sample_period_ns = 0;
+	if (iio_adis->sampling_frequency)
+		iio_adis->sample_period_ns = NO_OS_DIV_ROUND_CLOSEST(1000000000,
+					     iio_adis->sampling_frequency);
+	memset(&iio_adis->stats, 0, sizeof(iio_adis->stats));
+
+	adis_iio_build_scan_map(iio_adis, mask, adis_iio_burst_data_src,
+				iio_adis->scan_map);
 
 	if (iio_adis->has_fifo) {
+		ret = adis_iio_fifo_setup(iio_adis, mask);
+		if (ret)
+			return ret;
+
 		/* Set FIFO overflow behavior to overwrite old data when FIFO is full. */
 		ret = adis_cmd_fifo_flush(adis);
 		if (ret)
@@ -1499,25 +1722,20 @@ int adis_iio_post_disable(void* dev, uint32_t mask)
 /**
  * @brief API to be called to get one single sample-set based on the given mask.
  * @param iio_adis - The iio adis structure.
- * @param mask     - The active channels mask.
  * @param buffer   - IIO buffer to push the sample set to.
+ * @param pop      - True to pop the device FIFO.
  * @return 0 in case of success, error code otherwise.
  */
 static int adis_iio_trigger_push_single_sample(struct adis_iio_dev *iio_adis,
-		uint32_t mask, struct iio_buffer *buffer, bool pop)
+		struct iio_buffer *buffer, bool pop)
 {
-	struct adis_dev *adis;
-	int ret;
 	struct adis_burst_data data;
-	uint8_t i = 0;
-	uint32_t res1;
-	uint32_t res2;
-	uint8_t chan;
-
-	adis = iio_adis->adis_dev;
+	uint32_t data_cntr;
+	int ret;
 
-	ret = adis_read_burst_data(adis, &data, iio_adis->burst_size,
-				   iio_adis->burst_sel, pop, false);
+	ret = adis_read_burst_data(iio_adis->adis_dev, &data,
+				   iio_adis->burst_size, iio_adis->burst_sel,
+				   pop, false);
 
 	/* If ret ==  EAGAIN then no data is available to read (will happen
 	for a burst request or in case burst32 or burst select has been changed) */
@@ -1527,197 +1745,19 @@ static int adis_iio_trigger_push_single_sample(struct adis_iio_dev *iio_adis,
 	if (ret)
 		return ret;
 
-	uint32_t current_data_cntr = data.data_cntr_lsb | data.data_cntr_msb << 16;
-
-	if (iio_adis->data_cntr) {
-		if(current_data_cntr > iio_adis->data_cntr) {
-			if (iio_adis->sync_mode != ADIS_SYNC_SCALED)
-				iio_adis->samples_lost += current_data_cntr - iio_adis->data_cntr - 1;
-			else {
-				res1 = (current_data_cntr - iio_adis->data_cntr) * 49;
-				res2 = NO_OS_DIV_ROUND_CLOSEST(1000000, iio_adis->sampling_frequency);
-
-				if(res1 > res2) {
-					iio_adis->samples_lost += res1 / res2;
-					if(res1 % res2 < res2 / 2)
-						iio_adis->samples_lost--;
-				}
-			}
-
-		} else if (current_data_cntr == iio_adis->data_cntr) {
-			/* No new data, nothing else to do */
-			return 0;
-		}
+	data_cntr = data.data_cntr_lsb | data.data_cntr_msb << 16;
+	if (!adis_iio_update_data_cntr(iio_adis, data_cntr))
+		return 0;
 
-		else { /* data counter overflowed occurred */
-			if (iio_adis->sync_mode != ADIS_SYNC_SCALED)
-				iio_adis->samples_lost += NO_OS_U16_MAX - iio_adis->data_cntr +
-							  current_data_cntr;
-		}
-	}
+	adis_iio_repack(iio_adis, iio_adis->scan_map, (uint8_t *)&data);
 
-	iio_adis->data_cntr = current_data_cntr;
+	ret = iio_buffer_push_scan(buffer, &iio_adis->data[0]);
+	if (ret)
+		return ret;
 
-	for (chan = 0; chan < ADIS_NUM_CHAN; chan++) {
-		if (mask & (1 << chan)) {
-			switch(chan) {
-			case ADIS_TEMP:
-
-				if (iio_adis->iio_dev->channels[chan].scan_type->storagebits == 32)
-					iio_adis->data[i++] = data.temp_msb;
-
-				iio_adis->data[i++] = data.temp_lsb;
-				/*
-				 * The temperature channel has 16-bit storage size.
-				 * We need to perform the padding to have the buffer
-				 * elements naturally aligned in case there are any
-				 * 32-bit storage size channels enabled which have a
-				 * scan index higher than the temperature channel scan
-				 * index.
-				 */
-				if (mask & NO_OS_GENMASK(ADIS_DELTA_VEL_Z, ADIS_DELTA_ANGL_X)
-				    && iio_adis->iio_dev->channels[chan].scan_type->storagebits == 16)
-					iio_adis->data[i++] = 0;
-				break;
-			case ADIS_GYRO_X:
-				if(iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.x_gyro_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.x_gyro_lsb;
-				}
-				break;
-			case ADIS_GYRO_Y:
-				if(iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.y_gyro_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.y_gyro_lsb;
-				}
-				break;
-			case ADIS_GYRO_Z:
-				if(iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.z_gyro_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.z_gyro_lsb;
-				}
-				break;
-			case ADIS_ACCEL_X:
-				if(iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.x_accel_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.x_accel_lsb;
-				}
-				break;
-			case ADIS_ACCEL_Y:
-				if(iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.y_accel_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.y_accel_lsb;
-				}
-				break;
-			case ADIS_ACCEL_Z:
-				if(iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.z_accel_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.z_accel_lsb;
-				}
-				break;
-			case ADIS_DELTA_ANGL_X:
-				if(!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.x_gyro_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.x_gyro_lsb;
-				}
-				break;
-			case ADIS_DELTA_ANGL_Y:
-				if(!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.y_gyro_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.y_gyro_lsb;
-				}
-				break;
-			case ADIS_DELTA_ANGL_Z:
-				if(!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.z_gyro_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.z_gyro_lsb;
-				}
-				break;
-			case ADIS_DELTA_VEL_X:
-				if(!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.x_accel_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.x_accel_lsb;
-				}
-				break;
-			case ADIS_DELTA_VEL_Y:
-				if(!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.y_accel_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.y_accel_lsb;
-				}
-				break;
-			case ADIS_DELTA_VEL_Z:
-				if(!iio_adis->burst_sel) {
-					iio_adis->data[i++] = 0;
-					iio_adis->data[i++] = 0;
-				} else {
-					/* upper 16 */
-					iio_adis->data[i++] = data.z_accel_msb;
-					/* lower 16 */
-					iio_adis->data[i++] =  data.z_accel_lsb;
-				}
-				break;
-			default:
-				break;
-			}
-		}
-	}
+	iio_adis->stats.samples++;
 
-	return iio_buffer_push_scan(buffer, &iio_adis->data[0]);
+	return 0;
 }
 
 /**
@@ -1737,8 +1777,8 @@ int adis_iio_trigger_handler(struct iio_device_data *dev_data)
 	if (!iio_adis->adis_dev)
 		return -EINVAL;
 
-	return adis_iio_trigger_push_single_sample(iio_adis,
-			dev_data->buffer->active_mask, dev_data->buffer, false);
+	return adis_iio_trigger_push_single_sample(iio_adis, dev_data->buffer,
+			false);
 }
 
 /**
@@ -1749,18 +1789,23 @@ int adis_iio_trigger_handler(struct iio_device_data *dev_data)
  */
 int adis_iio_trigger_handler_with_fifo(struct iio_device_data *dev_data)
 {
+	const struct adis_burst_layout *layout;
 	struct adis_iio_dev *iio_adis;
 	struct adis_dev *adis;
-	int ret;
 	uint32_t fifo_cnt;
-	uint16_t j;
+	uint32_t nb_pop;
+	uint32_t valid;
+	uint32_t data_cntr;
+	uint8_t *frame;
+	uint32_t i;
+	int ret;
 
 	if (!dev_data)
 		return -EINVAL;
 
 	iio_adis = (struct adis_iio_dev *)dev_data->dev;
 
-	if (!iio_adis->adis_dev)
+	if (!iio_adis->adis_dev || !iio_adis->fifo_buf)
 		return -EINVAL;
 
 	iio_trig_disable(iio_adis->hw_trig_desc);
@@ -1776,29 +1821,50 @@ int adis_iio_trigger_handler_with_fifo(struct iio_device_data *dev_data)
 	if (fifo_cnt > dev_data->buffer->samples)
 		fifo_cnt = dev_data->buffer->samples;
 
-	if (fifo_cnt > 2) {
-		/* Burst request */
-		ret = adis_iio_trigger_push_single_sample(iio_adis,
-				dev_data->buffer->active_mask, dev_data->buffer, true);
-		if (ret)
-			goto trig_enable;
+	if (fifo_cnt <= 2)
+		goto trig_enable;
 
-		/* From data-sheet, minimum time between reads */
-		no_os_udelay(10);
+	if (fifo_cnt > iio_adis->stats.max_batch)
+		iio_adis->stats.max_batch = fifo_cnt;
 
-		for (j = 0; j < fifo_cnt - 1; j++) {
-			ret = adis_iio_trigger_push_single_sample(iio_adis,
-					dev_data->buffer->active_mask, dev_data->buffer, true);
+	layout = adis_get_fifo_burst_layout(adis, iio_adis->burst_size);
+	while (fifo_cnt) {
+		/*
+		 * Each transfer ends with a request which does not pop the
+		 * FIFO, to clock out the last popped sample.
+		 */
+		nb_pop = no_os_min(fifo_cnt, ADIS_FIFO_BURSTS_MAX - 1);
+		ret = adis_read_fifo_bursts(adis, iio_adis->fifo_buf,
+					    nb_pop + 1, iio_adis->burst_size,
+					    iio_adis->burst_sel, &valid);
+		if (ret == -EAGAIN) {
+			ret = 0;
+			break;
+		}
+		if (ret)
+			break;
+
+		for (i = 0; i <= nb_pop; i++) {
+			if (!(valid & NO_OS_BIT(i)))
+				continue;
+
+			frame = &iio_adis->fifo_buf[i * layout->size];
+			data_cntr = no_os_get_unaligned_be16(
+					    &frame[layout->data_cntr_offset]);
+			if (!adis_iio_update_data_cntr(iio_adis, data_cntr))
+				continue;
+
+			adis_iio_repack(iio_adis, iio_adis->fifo_scan_map,
+					frame);
+			ret = iio_buffer_push_scan(dev_data->buffer,
+						   &iio_adis->data[0]);
 			if (ret)
 				goto trig_enable;
 
-			/* From data-sheet, minimum time between reads */
-			no_os_udelay(10);
+			iio_adis->stats.samples++;
 		}
-		ret = adis_iio_trigger_push_single_sample(iio_adis,
-				dev_data->buffer->active_mask, dev_data->buffer, false);
-		/* From data-sheet, minimum time between reads */
-		no_os_udelay(10);
+
+		fifo_cnt -= nb_pop;
 	}
 
 trig_enable:
@@ -1806,6 +1872,23 @@ trig_enable:
 	return ret;
 }
 
+/**
+ * @brief Get the buffer streaming statistics.
+ * @param iio_adis - The iio adis structure.
+ * @param stats    - The streaming statistics since the buffer was enabled.
+ * @return 0 in case of success, error code otherwise.
+ */
+int adis_iio_get_stream_stats(struct adis_iio_dev *iio_adis,
+			      struct adis_iio_stream_stats *stats)
+{
+	if (!iio_adis || !stats)
+		return -EINVAL;
+
+	*stats = iio_adis->stats;
+
+	return 0;
+}
+
 struct iio_attribute adis_dev_attrs[] = {
 	{
 		.name   = "filter_low_pass_3db_frequency",
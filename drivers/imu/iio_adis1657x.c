@@ -531,5 +531,6 @@ void adis1657x_iio_remove(struct adis_iio_dev *desc)
 	if (!desc)
 		return;
 	adis_remove(desc->adis_dev);
+	no_os_free(desc->fifo_buf);
 	no_os_free(desc);
 }
@@ -52,6 +52,9 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/* Maximum number of 16-bit words in one sample-set */
+#define ADIS_IIO_SCAN_WORDS	26
+
 /** @struct adis_iio_chan_type
  *  @brief ADIS IIO channels enumeration
  */
@@ -218,6 +221,22 @@ struct adis_iio_scale_fractional_log2 {
 	uint32_t power;
 };
 
+/** @struct adis_iio_stream_stats
+ *  @brief ADIS IIO buffer streaming statistics
+ */
+struct adis_iio_stream_stats {
+	/** Samples pushed to the IIO buffer. */
+	uint32_t samples;
+	/** Samples lost, detected from gaps in the data counter. */
+	uint32_t lost;
+	/** Largest number of samples drained from the FIFO at once. */
+	uint32_t max_batch;
+	/** Time of the last pushed sample in nanoseconds since the buffer was
+	 *  enabled, reconstructed from the data counter.
+	 */
+	uint64_t timestamp_ns;
+};
+
 /** @struct adis_iio_dev
  *  @brief ADIS IIO device descriptor structure
  */
@@ -238,8 +257,22 @@ struct adis_iio_dev {
 	uint32_t burst_sel;
 	/** Current setting for adis sync mode. */
 	uint32_t sync_mode;
+	/** True if data_cntr holds the counter of a pushed sample. */
+	bool data_cntr_valid;
+	/** Sample period in nanoseconds for the current buffer reading. */
+	uint32_t sample_period_ns;
 	/** Data buffer to store one sample-set. */
-	uint16_t data[26];
+	uint16_t data[ADIS_IIO_SCAN_WORDS];
+	/** Number of 16-bit words in one sample-set. */
+	uint8_t scan_words;
+	/** Burst data byte offset for each sample-set word. */
+	uint8_t scan_map[ADIS_IIO_SCAN_WORDS];
+	/** FIFO burst frame byte offset for each sample-set word. */
+	uint8_t fifo_scan_map[ADIS_IIO_SCAN_WORDS];
+	/** Buffer for the FIFO burst frames read in one SPI transfer. */
+	uint8_t *fifo_buf;
+	/** Buffer streaming statistics. */
+	struct adis_iio_stream_stats stats;
 	/** True if iio device offers FIFO support for buffer reading. */
 	bool has_fifo;
 	/** Gyroscope measurement range value in text. */
@@ -342,6 +375,9 @@ int adis_iio_read_samples(void* dev, int* buff, uint32_t samples);
 /*! Callback for adis iio data ready trigger. */
 int adis_iio_trigger_handler(struct iio_device_data *dev_data);
 int adis_iio_trigger_handler_with_fifo(struct iio_device_data *dev_data);
+/*! Get the buffer streaming statistics. */
+int adis_iio_get_stream_stats(struct adis_iio_dev *iio_adis,
+			      struct adis_iio_stream_stats *stats);
 
 /*! Callback for adis iio debug attributes reading. */
 int adis_iio_read_debug_attrs(void *dev, char *buf, uint32_t len,
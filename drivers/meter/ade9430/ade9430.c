@@ -280,6 +280,349 @@ int ade9430_set_egy_model(struct ade9430_dev *dev, enum ade9430_egy_model model,
 	return ade9430_write(dev, ADE9430_REG_RUN, 1);
 }
 
+/**
+ * @brief Start streaming the waveform buffer.
+ *
+ * The buffer is filled continuously with fixed data rate samples and the page
+ * full interrupt is raised at the end of each buffer half. Every half is then
+ * read with a single auto-incrementing burst by ade9430_wfb_process() while
+ * the device fills the other one. The narrowest BURST_CHAN setting covering
+ * param->chan_mask is used, so fewer channels also mean shorter bursts: the
+ * device still stores full sample sets, but only returns the BURST_CHAN words
+ * of each set.
+ * @param dev - The device structure.
+ * @param param - The streaming parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ade9430_wfb_start(struct ade9430_dev *dev,
+		      struct ade9430_wfb_param *param)
+{
+	struct ade9430_wfb *wfb;
+	uint32_t burst_chan;
+	uint32_t scan_words;
+	uint32_t pair;
+	uint32_t cfg;
+	int ret;
+
+	if (!dev || !param || !param->chan_mask ||
+	    param->chan_mask >= NO_OS_BIT(ADE9430_WFB_NB_CHAN))
+		return -EINVAL;
+
+	if (dev->wfb)
+		return -EBUSY;
+
+	wfb = no_os_calloc(1, sizeof(*wfb));
+	if (!wfb)
+		return -ENOMEM;
+
+	/* IA/VA, IB/VB or IC/VC */
+	pair = no_os_find_first_set_bit(param->chan_mask) / 2;
+
+	if (no_os_hweight8(param->chan_mask) == 1) {
+		burst_chan = ADE9430_BURST_CHAN_SINGLE(no_os_find_first_set_bit(
+				param->chan_mask));
+		wfb->set_words = 1;
+		wfb->set_mask = 1;
+	} else if (!(param->chan_mask & ~(0x3 << (2 * pair)))) {
+		burst_chan = ADE9430_BURST_CHAN_PAIR(pair);
+		wfb->set_words = 2;
+		wfb->set_mask = param->chan_mask >> (2 * pair);
+	} else {
+		burst_chan = ADE9430_BURST_CHAN_ALL;
+		wfb->set_words = 8;
+		wfb->set_mask = param->chan_mask;
+	}
+	wfb->last_half = -1;
+
+	scan_words = ADE9430_WFB_HALF_SETS * no_os_hweight8(wfb->set_mask);
+	if (param->ring_size < scan_words) {
+		ret = -EINVAL;
+		goto error_wfb;
+	}
+
+	wfb->buff = no_os_calloc(ADE9430_WFB_BURST_SIZE(wfb->set_words),
+				 sizeof(uint8_t));
+	if (!wfb->buff) {
+		ret = -ENOMEM;
+		goto error_wfb;
+	}
+
+	ret = no_os_lf_ring_init(&wfb->ring, param->ring_size, sizeof(int32_t));
+	if (ret)
+		goto error_buff;
+
+	/* Stop any capture in progress before changing the configuration */
+	ret = ade9430_write(dev, ADE9430_REG_WFB_CFG, 0);
+	if (ret)
+		goto error_ring;
+
+	ret = ade9430_write(dev, ADE9430_REG_WFB_PG_IRQEN,
+			    NO_OS_BIT(ADE9430_WFB_HALF_PAGES - 1) |
+			    NO_OS_BIT(ADE9430_WFB_PAGES - 1));
+	if (ret)
+		goto error_ring;
+
+	ret = ade9430_write(dev, ADE9430_REG_STATUS0,
+			    ADE9430_STATUS0_PAGE_FULL);
+	if (ret)
+		goto error_ring;
+
+	ret = ade9430_update_bits(dev, ADE9430_REG_MASK0,
+				  ADE9430_MASK0_PAGE_FULL,
+				  ADE9430_MASK0_PAGE_FULL);
+	if (ret)
+		goto error_ring;
+
+	ret = ade9430_write(dev, ADE9430_REG_RUN, 1);
+	if (ret)
+		goto error_ring;
+
+	cfg = no_os_field_prep(ADE9430_WF_SRC, param->src) |
+	      no_os_field_prep(ADE9430_WF_MODE, ADE9430_WF_MODE_CONT) |
+	      no_os_field_prep(ADE9430_WF_CAP_SEL, ADE9430_WF_CAP_SEL_FIXED) |
+	      no_os_field_prep(ADE9430_WF_CAP_EN, 1) |
+	      no_os_field_prep(ADE9430_BURST_CHAN, burst_chan);
+	if (param->chan_mask & NO_OS_BIT(ADE9430_WFB_IN))
+		cfg |= ADE9430_WF_IN_EN;
+
+	dev->wfb = wfb;
+
+	ret = ade9430_write(dev, ADE9430_REG_WFB_CFG, cfg);
+	if (ret) {
+		dev->wfb = NULL;
+		goto error_ring;
+	}
+
+	return 0;
+
+error_ring:
+	no_os_lf_ring_remove(wfb->ring);
+error_buff:
+	no_os_free(wfb->buff);
+error_wfb:
+	no_os_free(wfb);
+
+	return ret;
+}
+
+/**
+ * @brief Stop streaming the waveform buffer and release the sample ring.
+ * @param dev - The device structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ade9430_wfb_stop(struct ade9430_dev *dev)
+{
+	struct ade9430_wfb *wfb;
+	int ret;
+
+	if (!dev || !dev->wfb)
+		return -EINVAL;
+
+	ret = ade9430_update_bits(dev, ADE9430_REG_WFB_CFG, ADE9430_WF_CAP_EN,
+				  0);
+	if (ret)
+		return ret;
+
+	ret = ade9430_update_bits(dev, ADE9430_REG_MASK0,
+				  ADE9430_MASK0_PAGE_FULL, 0);
+	if (ret)
+		return ret;
+
+	ret = ade9430_write(dev, ADE9430_REG_WFB_PG_IRQEN, 0);
+	if (ret)
+		return ret;
+
+	wfb = dev->wfb;
+	dev->wfb = NULL;
+
+	no_os_lf_ring_remove(wfb->ring);
+	no_os_free(wfb->buff);
+	no_os_free(wfb);
+
+	return 0;
+}
+
+/**
+ * @brief Get the buffer half the device is not writing to.
+ * @param dev - The device structure.
+ * @param half - The buffer half that is safe to read.
+ * @param page - The last page written by the device.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int ade9430_wfb_idle_half(struct ade9430_dev *dev, uint32_t *half,
+				 uint32_t *page)
+{
+	uint32_t stat;
+	int ret;
+
+	ret = ade9430_read(dev, ADE9430_REG_WFB_TRG_STAT, &stat);
+	if (ret)
+		return ret;
+
+	*page = no_os_field_get(ADE9430_WFB_LAST_PAGE, stat);
+	/* The device is filling the half that holds the page after the last */
+	*half = !(((*page + 1) % ADE9430_WFB_PAGES) / ADE9430_WFB_HALF_PAGES);
+
+	return 0;
+}
+
+/**
+ * @brief Keep the enabled channels of a burst, converted to CPU endianness.
+ *
+ * The samples are compacted in place at the start of the burst buffer, which
+ * never overwrites a word that was not read yet.
+ * @param wfb - The streaming state.
+ * @return The number of samples kept.
+ */
+static uint32_t ade9430_wfb_unpack(struct ade9430_wfb *wfb)
+{
+	int32_t *out = (int32_t *)wfb->buff;
+	uint8_t *in = &wfb->buff[2];
+	uint32_t words = ADE9430_WFB_HALF_SETS * wfb->set_words;
+	uint32_t nb = 0;
+	int32_t val;
+	uint32_t i;
+
+	for (i = 0; i < words; i++, in += 4) {
+		if (!(wfb->set_mask & NO_OS_BIT(i & (wfb->set_words - 1))))
+			continue;
+
+		val = (int32_t)no_os_get_unaligned_be32(in);
+		out[nb++] = val;
+	}
+
+	return nb;
+}
+
+/**
+ * @brief Service the waveform buffer page full event.
+ *
+ * Reads the buffer half completed by the device with one burst and pushes the
+ * samples of the enabled channels to the sample ring. A half that the device
+ * started to overwrite while it was being read is dropped. Can be called from
+ * the IRQ pin callback or polled.
+ * @param dev - The device structure.
+ * @return 1 if a buffer half was read, 0 if there was no page full event or
+ * 	   the half was dropped, negative error code otherwise.
+ */
+int ade9430_wfb_process(struct ade9430_dev *dev)
+{
+	struct ade9430_wfb *wfb;
+	uint32_t half, page, status, addr, nb;
+	int ret;
+
+	if (!dev || !dev->wfb)
+		return -EINVAL;
+
+	wfb = dev->wfb;
+
+	ret = ade9430_read(dev, ADE9430_REG_STATUS0, &status);
+	if (ret)
+		return ret;
+
+	if (!(status & ADE9430_STATUS0_PAGE_FULL))
+		return 0;
+
+	/* Clear first, so a page filled during the burst raises a new event */
+	ret = ade9430_write(dev, ADE9430_REG_STATUS0,
+			    ADE9430_STATUS0_PAGE_FULL);
+	if (ret)
+		return ret;
+
+	ret = ade9430_wfb_idle_half(dev, &half, &page);
+	if (ret)
+		return ret;
+
+	if (page % ADE9430_WFB_HALF_PAGES != ADE9430_WFB_HALF_PAGES - 1)
+		wfb->stats.late++;
+
+	/* The same half twice in a row, the other one was overwritten */
+	if (wfb->last_half == (int8_t)half)
+		wfb->stats.overruns++;
+	wfb->last_half = half;
+
+	nb = ADE9430_WFB_HALF_SETS * no_os_hweight8(wfb->set_mask);
+	if (no_os_lf_ring_space(wfb->ring) < nb) {
+		wfb->stats.ring_full++;
+		return 0;
+	}
+
+	addr = ADE9430_WFB_ADDR + half * ADE9430_WFB_HALF_WORDS;
+	wfb->buff[0] = addr >> 4;
+	wfb->buff[1] = ADE9430_SPI_READ | addr << 4;
+
+	ret = no_os_spi_write_and_read(dev->spi_desc, wfb->buff,
+				       ADE9430_WFB_BURST_SIZE(wfb->set_words));
+	if (ret)
+		return ret;
+
+	ret = ade9430_wfb_idle_half(dev, &addr, &page);
+	if (ret)
+		return ret;
+
+	if (addr != half) {
+		wfb->stats.overruns++;
+		return 0;
+	}
+
+	nb = ade9430_wfb_unpack(wfb);
+	no_os_lf_ring_write_n(wfb->ring, wfb->buff, nb);
+	wfb->stats.halves++;
+
+	return 1;
+}
+
+/**
+ * @brief Page full IRQ callback, services the event with
+ * ade9430_wfb_process().
+ * @param context - The device structure.
+ */
+void ade9430_wfb_irq_handler(void *context)
+{
+	struct ade9430_dev *dev = context;
+
+	if (!dev || !dev->wfb)
+		return;
+
+	if (ade9430_wfb_process(dev) < 0)
+		dev->wfb->stats.errors++;
+}
+
+/**
+ * @brief Read streamed waveform samples.
+ *
+ * The samples of the enabled channels are interleaved in enum ade9430_wfb_chan
+ * order, one sample set after the other.
+ * @param dev - The device structure.
+ * @param samples - The samples read.
+ * @param nb - The maximum number of samples to read.
+ * @return The number of samples read, negative error code otherwise.
+ */
+int ade9430_wfb_read(struct ade9430_dev *dev, int32_t *samples, uint32_t nb)
+{
+	if (!dev || !dev->wfb || !samples)
+		return -EINVAL;
+
+	return no_os_lf_ring_read_n(dev->wfb->ring, samples, nb);
+}
+
+/**
+ * @brief Get the waveform buffer streaming statistics.
+ * @param dev - The device structure.
+ * @param stats - The statistics.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int ade9430_wfb_stats_get(struct ade9430_dev *dev,
+			  struct ade9430_wfb_stats *stats)
+{
+	if (!dev || !dev->wfb || !stats)
+		return -EINVAL;
+
+	*stats = dev->wfb->stats;
+
+	return 0;
+}
+
 /**
  * @brief Initialize the device.
  * @param device - The device structure.
@@ -350,6 +693,12 @@ int ade9430_remove(struct ade9430_dev *dev)
 {
 	int ret;
 
+	if (dev->wfb) {
+		ret = ade9430_wfb_stop(dev);
+		if (ret)
+			return ret;
+	}
+
 	ret = no_os_spi_remove(dev->spi_desc);
 	if (ret)
 		return ret;
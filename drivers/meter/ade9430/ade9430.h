@@ -47,6 +47,7 @@
 #include <string.h>
 #include "no_os_util.h"
 #include "no_os_spi.h"
+#include "no_os_lf_ring.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -766,7 +767,7 @@
 /* ADE9430_REG_WFB_CFG Bit Definition */
 #define ADE9430_WF_IN_EN		NO_OS_BIT(12)
 #define ADE9430_WF_SRC			NO_OS_GENMASK(9, 8)
-#define ADE9430_WF_MODE			NO_OS_BIT(7, 6)
+#define ADE9430_WF_MODE			NO_OS_GENMASK(7, 6)
 #define ADE9430_WF_CAP_SEL		NO_OS_BIT(5)
 #define ADE9430_WF_CAP_EN		NO_OS_BIT(4)
 #define ADE9430_BURST_CHAN		NO_OS_GENMASK(3, 0)
@@ -851,6 +852,28 @@
 #define ADE9430_V_RES_NV		13357ULL
 #define ADE9430_W_RES_UW		7203ULL
 
+/* Waveform buffer */
+#define ADE9430_WFB_ADDR		0x0800
+#define ADE9430_WFB_WORDS		2048
+#define ADE9430_WFB_PAGES		16
+#define ADE9430_WFB_HALF_WORDS		(ADE9430_WFB_WORDS / 2)
+#define ADE9430_WFB_HALF_PAGES		(ADE9430_WFB_PAGES / 2)
+#define ADE9430_WFB_NB_CHAN		7
+/* The buffer always stores 8 word sample sets, whatever BURST_CHAN is */
+#define ADE9430_WFB_SET_WORDS		8
+#define ADE9430_WFB_HALF_SETS		(ADE9430_WFB_HALF_WORDS / \
+					 ADE9430_WFB_SET_WORDS)
+/* Command bytes followed by the BURST_CHAN words of one buffer half */
+#define ADE9430_WFB_BURST_SIZE(set_words) \
+	(2 + ADE9430_WFB_HALF_SETS * (set_words) * 4)
+/* Continuous fill, only save the address of the enabled trigger events */
+#define ADE9430_WF_MODE_CONT		3
+/* Fixed data rate samples instead of resampled data */
+#define ADE9430_WF_CAP_SEL_FIXED	1
+#define ADE9430_BURST_CHAN_ALL		0
+#define ADE9430_BURST_CHAN_PAIR(n)	(1 + (n))
+#define ADE9430_BURST_CHAN_SINGLE(n)	(8 + (n))
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -875,6 +898,82 @@ enum ade9430_egy_model {
 	ADE9430_EGY_NR_SAMPLES
 };
 
+/**
+ * @enum ade9430_wfb_src
+ * @brief ADE9430 waveform buffer fixed data rate sources.
+ */
+enum ade9430_wfb_src {
+	/** Sinc4 output, 32 kSPS */
+	ADE9430_WFB_SRC_SINC4 = 0,
+	/** Sinc4 + IIR LPF output, 8 kSPS */
+	ADE9430_WFB_SRC_SINC4_IIR_LPF = 2,
+	/** Current and voltage channel DSP output, 8 kSPS */
+	ADE9430_WFB_SRC_DSP = 3
+};
+
+/**
+ * @enum ade9430_wfb_chan
+ * @brief ADE9430 waveform buffer channels, in sample set order.
+ */
+enum ade9430_wfb_chan {
+	ADE9430_WFB_IA,
+	ADE9430_WFB_VA,
+	ADE9430_WFB_IB,
+	ADE9430_WFB_VB,
+	ADE9430_WFB_IC,
+	ADE9430_WFB_VC,
+	ADE9430_WFB_IN
+};
+
+/**
+ * @struct ade9430_wfb_param
+ * @brief ADE9430 waveform buffer streaming parameters.
+ */
+struct ade9430_wfb_param {
+	/** Fixed data rate source */
+	enum ade9430_wfb_src		src;
+	/** Captured channels, bit n set for enum ade9430_wfb_chan n */
+	uint8_t				chan_mask;
+	/** Sample ring size in 32-bit words, must be a power of two */
+	uint32_t			ring_size;
+};
+
+/**
+ * @struct ade9430_wfb_stats
+ * @brief ADE9430 waveform buffer streaming statistics.
+ */
+struct ade9430_wfb_stats {
+	/** Buffer halves read and pushed to the sample ring */
+	uint32_t			halves;
+	/** Buffer halves overwritten by the device before they were read */
+	uint32_t			overruns;
+	/** Buffer halves dropped because the sample ring was full */
+	uint32_t			ring_full;
+	/** Page full events serviced after the next page was written */
+	uint32_t			late;
+	/** Page full events that failed with a communication error */
+	uint32_t			errors;
+};
+
+/**
+ * @struct ade9430_wfb
+ * @brief ADE9430 waveform buffer streaming state.
+ */
+struct ade9430_wfb {
+	/** Samples of the enabled channels, interleaved per sample set */
+	struct no_os_lf_ring		*ring;
+	/** Burst read buffer, the command followed by one buffer half */
+	uint8_t				*buff;
+	/** Words returned per sample set for the selected BURST_CHAN */
+	uint8_t				set_words;
+	/** Words of each sample set pushed to the ring */
+	uint8_t				set_mask;
+	/** Last buffer half read, -1 before the first one */
+	int8_t				last_half;
+	/** Statistics */
+	struct ade9430_wfb_stats	stats;
+};
+
 /**
  * @struct ade9430_init_param
  * @brief ADE9430 Device initialization parameters.
@@ -901,6 +1000,8 @@ struct ade9430_dev {
 	uint32_t			vrms_val;
 	/** Variable storing the temperature value in degrees */
 	int32_t				temp_deg;
+	/** Waveform buffer streaming state, NULL when not streaming */
+	struct ade9430_wfb		*wfb;
 };
 
 /******************************************************************************/
@@ -929,6 +1030,26 @@ int ade9430_read_data_ph(struct ade9430_dev *dev, enum ade9430_phase phase);
 int ade9430_set_egy_model(struct ade9430_dev *dev, enum ade9430_egy_model model,
 			  uint16_t value);
 
+/* Start streaming the waveform buffer. */
+int ade9430_wfb_start(struct ade9430_dev *dev,
+		      struct ade9430_wfb_param *param);
+
+/* Stop streaming the waveform buffer. */
+int ade9430_wfb_stop(struct ade9430_dev *dev);
+
+/* Service the waveform buffer page full event. */
+int ade9430_wfb_process(struct ade9430_dev *dev);
+
+/* Page full IRQ callback, the context is the device structure. */
+void ade9430_wfb_irq_handler(void *context);
+
+/* Read streamed waveform samples. */
+int ade9430_wfb_read(struct ade9430_dev *dev, int32_t *samples, uint32_t nb);
+
+/* Get the waveform buffer streaming statistics. */
+int ade9430_wfb_stats_get(struct ade9430_dev *dev,
+			  struct ade9430_wfb_stats *stats);
+
 /* Initialize the device. */
 int ade9430_init(struct ade9430_dev **device,
 		 struct ade9430_init_param init_param);
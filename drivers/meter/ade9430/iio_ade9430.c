@@ -0,0 +1,295 @@
+/***************************************************************************//**
+ *   @file   iio_ade9430.c
+ *   @brief  Implementation of the ADE9430 IIO driver.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <errno.h>
+#include "iio_ade9430.h"
+#include "no_os_alloc.h"
+#include "no_os_delay.h"
+#include "no_os_util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADE9430_IIO_CHAN(_type, _ch, _idx, _reg) {	\
+	.ch_type = _type,				\
+	.channel = _ch,					\
+	.address = _reg,				\
+	.scan_index = _idx,				\
+	.scan_type = &ade9430_iio_scan_type,		\
+	.attributes = ade9430_iio_ch_attrs,		\
+	.ch_out = IIO_DIRECTION_INPUT,			\
+	.indexed = true,				\
+}
+
+#define ADE9430_IIO_POLL_US		100
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Read the instantaneous waveform sample of a channel.
+ * @param dev - The iio device structure.
+ * @param buf - Command buffer to be filled with requested data.
+ * @param len - Length of the received command buffer in bytes.
+ * @param channel - Command channel info.
+ * @param priv - Command attribute id.
+ * @return The length of the buffer in case of success, error code otherwise.
+ */
+static int ade9430_iio_read_raw(void *dev, char *buf, uint32_t len,
+				const struct iio_ch_info *channel,
+				intptr_t priv)
+{
+	struct ade9430_iio_dev *iio_ade9430 = dev;
+	uint32_t val;
+	int ret;
+
+	ret = ade9430_read(iio_ade9430->ade9430_dev, channel->address, &val);
+	if (ret)
+		return ret;
+
+	return iio_format_value(buf, len, IIO_VAL_INT, 1, (int32_t *)&val);
+}
+
+/**
+ * @brief Read a device register.
+ * @param dev - The iio device structure.
+ * @param reg - The register address.
+ * @param readval - The register value.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t ade9430_iio_reg_read(void *dev, uint32_t reg, uint32_t *readval)
+{
+	struct ade9430_iio_dev *iio_ade9430 = dev;
+
+	return ade9430_read(iio_ade9430->ade9430_dev, reg, readval);
+}
+
+/**
+ * @brief Write a device register.
+ * @param dev - The iio device structure.
+ * @param reg - The register address.
+ * @param writeval - The register value.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t ade9430_iio_reg_write(void *dev, uint32_t reg,
+				     uint32_t writeval)
+{
+	struct ade9430_iio_dev *iio_ade9430 = dev;
+
+	return ade9430_write(iio_ade9430->ade9430_dev, reg, writeval);
+}
+
+/**
+ * @brief Start streaming the waveform buffer for the enabled channels.
+ * @param dev - The iio device structure.
+ * @param mask - Bit mask of the enabled channels, in enum ade9430_wfb_chan
+ * 		 order.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t ade9430_iio_buffer_enable(void *dev, uint32_t mask)
+{
+	struct ade9430_iio_dev *iio_ade9430 = dev;
+	struct ade9430_wfb_param param = {
+		.src = iio_ade9430->src,
+		.chan_mask = mask,
+		.ring_size = iio_ade9430->ring_size,
+	};
+
+	return ade9430_wfb_start(iio_ade9430->ade9430_dev, &param);
+}
+
+/**
+ * @brief Stop streaming the waveform buffer.
+ * @param dev - The iio device structure.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t ade9430_iio_buffer_disable(void *dev)
+{
+	struct ade9430_iio_dev *iio_ade9430 = dev;
+
+	return ade9430_wfb_stop(iio_ade9430->ade9430_dev);
+}
+
+/**
+ * @brief Fill the IIO buffer with streamed waveform samples.
+ *
+ * Without the IRQ the page full event is polled while waiting for samples.
+ * @param dev_data - The iio device data structure.
+ * @return 0 in case of success, error code otherwise.
+ */
+static int32_t ade9430_iio_submit(struct iio_device_data *dev_data)
+{
+	struct ade9430_iio_dev *iio_ade9430 = dev_data->dev;
+	struct ade9430_dev *dev = iio_ade9430->ade9430_dev;
+	uint32_t timeout = ADE9430_IIO_WFB_TIMEOUT_US;
+	uint32_t nb = dev_data->buffer->size / sizeof(int32_t);
+	int32_t *samples;
+	uint32_t i = 0;
+	int ret;
+
+	ret = iio_buffer_get_block(dev_data->buffer, (void **)&samples);
+	if (ret)
+		return ret;
+
+	while (i < nb) {
+		ret = ade9430_wfb_read(dev, &samples[i], nb - i);
+		if (ret < 0)
+			return ret;
+		if (ret) {
+			i += ret;
+			timeout = ADE9430_IIO_WFB_TIMEOUT_US;
+			continue;
+		}
+
+		if (!iio_ade9430->irq_en) {
+			ret = ade9430_wfb_process(dev);
+			if (ret < 0)
+				return ret;
+			if (ret)
+				continue;
+		}
+
+		if (timeout < ADE9430_IIO_POLL_US)
+			return -ETIMEDOUT;
+
+		timeout -= ADE9430_IIO_POLL_US;
+		no_os_udelay(ADE9430_IIO_POLL_US);
+	}
+
+	return iio_buffer_block_done(dev_data->buffer);
+}
+
+static struct scan_type ade9430_iio_scan_type = {
+	.sign = 's',
+	.realbits = 32,
+	.storagebits = 32,
+	.shift = 0,
+	.is_big_endian = false
+};
+
+static struct iio_attribute ade9430_iio_ch_attrs[] = {
+	{
+		.name = "raw",
+		.show = ade9430_iio_read_raw,
+	},
+	END_ATTRIBUTES_ARRAY
+};
+
+/* Same order as enum ade9430_wfb_chan, the scan index is the WFB channel */
+static struct iio_channel ade9430_iio_channels[] = {
+	ADE9430_IIO_CHAN(IIO_CURRENT, 0, ADE9430_WFB_IA, ADE9430_REG_AI_PCF),
+	ADE9430_IIO_CHAN(IIO_VOLTAGE, 0, ADE9430_WFB_VA, ADE9430_REG_AV_PCF),
+	ADE9430_IIO_CHAN(IIO_CURRENT, 1, ADE9430_WFB_IB, ADE9430_REG_BI_PCF),
+	ADE9430_IIO_CHAN(IIO_VOLTAGE, 1, ADE9430_WFB_VB, ADE9430_REG_BV_PCF),
+	ADE9430_IIO_CHAN(IIO_CURRENT, 2, ADE9430_WFB_IC, ADE9430_REG_CI_PCF),
+	ADE9430_IIO_CHAN(IIO_VOLTAGE, 2, ADE9430_WFB_VC, ADE9430_REG_CV_PCF),
+	ADE9430_IIO_CHAN(IIO_CURRENT, 3, ADE9430_WFB_IN, ADE9430_REG_NI_PCF),
+};
+
+static struct iio_device ade9430_iio_dev = {
+	.num_ch = NO_OS_ARRAY_SIZE(ade9430_iio_channels),
+	.channels = ade9430_iio_channels,
+	.pre_enable = ade9430_iio_buffer_enable,
+	.post_disable = ade9430_iio_buffer_disable,
+	.submit = ade9430_iio_submit,
+	.debug_reg_read = ade9430_iio_reg_read,
+	.debug_reg_write = ade9430_iio_reg_write,
+};
+
+/**
+ * @brief Initialize the ADE9430 IIO driver.
+ * @param dev - The iio device structure.
+ * @param init_param - The iio device initialization parameters.
+ * @return 0 in case of success, error code otherwise.
+ */
+int ade9430_iio_init(struct ade9430_iio_dev **dev,
+		     struct ade9430_iio_init_param *init_param)
+{
+	struct ade9430_iio_dev *iio_ade9430;
+	int ret;
+
+	if (!init_param || !init_param->init_param)
+		return -EINVAL;
+
+	iio_ade9430 = no_os_calloc(1, sizeof(*iio_ade9430));
+	if (!iio_ade9430)
+		return -ENOMEM;
+
+	ret = ade9430_init(&iio_ade9430->ade9430_dev, *init_param->init_param);
+	if (ret)
+		goto error;
+
+	iio_ade9430->iio_dev = &ade9430_iio_dev;
+	iio_ade9430->src = init_param->src;
+	iio_ade9430->ring_size = init_param->ring_size;
+	iio_ade9430->irq_en = init_param->irq_en;
+
+	*dev = iio_ade9430;
+
+	return 0;
+
+error:
+	no_os_free(iio_ade9430);
+
+	return ret;
+}
+
+/**
+ * @brief Free the resources allocated by ade9430_iio_init().
+ * @param dev - The iio device structure.
+ * @return 0 in case of success, error code otherwise.
+ */
+int ade9430_iio_remove(struct ade9430_iio_dev *dev)
+{
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	ret = ade9430_remove(dev->ade9430_dev);
+	if (ret)
+		return ret;
+
+	no_os_free(dev);
+
+	return 0;
+}
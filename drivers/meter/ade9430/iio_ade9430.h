@@ -0,0 +1,106 @@
+/***************************************************************************//**
+ *   @file   iio_ade9430.h
+ *   @brief  Header file of the ADE9430 IIO driver.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef __IIO_ADE9430_H__
+#define __IIO_ADE9430_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "iio.h"
+#include "iio_types.h"
+#include "ade9430.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADE9430_IIO_WFB_TIMEOUT_US	1000000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct ade9430_iio_dev
+ * @brief ADE9430 IIO device structure.
+ */
+struct ade9430_iio_dev {
+	/** ADE9430 driver handler */
+	struct ade9430_dev *ade9430_dev;
+	/** Generic IIO device handler */
+	struct iio_device *iio_dev;
+	/** Waveform buffer fixed data rate source */
+	enum ade9430_wfb_src src;
+	/** Sample ring size in 32-bit words, power of two */
+	uint32_t ring_size;
+	/** ade9430_wfb_irq_handler() is registered on the IRQ0 pin */
+	bool irq_en;
+};
+
+/**
+ * @struct ade9430_iio_init_param
+ * @brief ADE9430 IIO initialization structure.
+ */
+struct ade9430_iio_init_param {
+	/** ADE9430 driver initialization parameters */
+	struct ade9430_init_param *init_param;
+	/** Waveform buffer fixed data rate source */
+	enum ade9430_wfb_src src;
+	/** Sample ring size in 32-bit words, power of two */
+	uint32_t ring_size;
+	/**
+	 * The application registers ade9430_wfb_irq_handler() on the IRQ0 pin,
+	 * otherwise the page full event is polled while filling the buffer.
+	 */
+	bool irq_en;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize the ADE9430 IIO driver. */
+int ade9430_iio_init(struct ade9430_iio_dev **dev,
+		     struct ade9430_iio_init_param *init_param);
+
+/* Free the resources allocated by ade9430_iio_init(). */
+int ade9430_iio_remove(struct ade9430_iio_dev *dev);
+
+#endif /* __IIO_ADE9430_H__ */
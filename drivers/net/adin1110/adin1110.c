@@ -52,6 +52,14 @@
 
 NO_OS_DECLARE_CRC8_TABLE(_crc_table);
 
+/*
+ * Some SPI controllers only clock the messages which have a buffer, so the
+ * frame padding is sent from a zero buffer and the discarded RX FIFO bytes are
+ * received in a scratch buffer.
+ */
+static uint8_t adin1110_tx_zeros[64];
+static uint8_t adin1110_rx_discard[ADIN1110_BUFF_LEN + 4];
+
 struct _adin1110_priv {
 	uint32_t phy_id;
 	uint32_t num_ports;
@@ -485,6 +493,43 @@ int adin1110_broadcast_filter(struct adin1110_desc *desc, bool enabled)
 	return adin1110_clear_mac_addr(desc, broadcast_addr);
 }
 
+/**
+ * @brief Make sure the TX FIFO has room for a frame. The TX_SPACE register is
+ * only read when the space left from the last read isn't enough, the space
+ * taken by each frame is then subtracted from it. The MAC only frees space,
+ * so the tracked value is never larger than the actual one.
+ * @param desc - the device descriptor
+ * @param padded_len - length of the frame, including the frame header.
+ * @return 0 in case of success, -EAGAIN if the frame doesn't fit in the FIFO,
+ * negative error code otherwise
+ */
+static int adin1110_tx_space_reserve(struct adin1110_desc *desc,
+				     uint32_t padded_len)
+{
+	uint32_t needed;
+	int ret;
+
+	/*
+	 * The space is expressed in 16 bit words, an extra frame header worth
+	 * of words is kept free for the FIFO frame separator.
+	 */
+	needed = no_os_align(padded_len, 4) / 2 + ADIN1110_FRAME_HEADER_LEN;
+
+	if (desc->tx_space < needed) {
+		ret = adin1110_reg_read(desc, ADIN1110_TX_SPACE_REG,
+					&desc->tx_space);
+		if (ret)
+			return ret;
+
+		if (desc->tx_space < needed)
+			return -EAGAIN;
+	}
+
+	desc->tx_space -= needed;
+
+	return 0;
+}
+
 /**
  * @brief Write a frame to the TX FIFO.
  * @param desc - the device descriptor
@@ -500,7 +545,6 @@ int adin1110_write_fifo(struct adin1110_desc *desc, uint32_t port,
 	uint32_t padding = 0;
 	uint32_t padded_len;
 	uint32_t round_len;
-	uint32_t tx_space;
 	int ret;
 
 	struct no_os_spi_msg xfer = {
@@ -520,17 +564,10 @@ int adin1110_write_fifo(struct adin1110_desc *desc, uint32_t port,
 	/** Align the frame length to 4 bytes */
 	round_len = no_os_align(padded_len, 4);
 
-	ret = adin1110_reg_read(desc, ADIN1110_TX_SPACE_REG, &tx_space);
+	ret = adin1110_tx_space_reserve(desc, padded_len);
 	if (ret)
 		return ret;
 
-	/*
-	 * Check if there is enough space for the frame in the TX FIFO.
-	 * The tx_space value is expressed in 16 bit words.
-	 */
-	if (padded_len > 2 * (tx_space - ADIN1110_FRAME_HEADER_LEN))
-		return -EAGAIN;
-
 	ret = adin1110_reg_write(desc, ADIN1110_TX_FSIZE_REG, padded_len);
 	if (ret)
 		return ret;
@@ -557,6 +594,24 @@ int adin1110_write_fifo(struct adin1110_desc *desc, uint32_t port,
 	return no_os_spi_transfer(desc->comm_desc, &xfer, 1);
 }
 
+/**
+ * @brief Get the FIFO registers of a port.
+ * @param port - the port number.
+ * @param fifo_reg - the RX FIFO register.
+ * @param fifo_fsize_reg - the RX frame size register.
+ */
+static void adin1110_rx_regs(uint32_t port, uint32_t *fifo_reg,
+			     uint32_t *fifo_fsize_reg)
+{
+	if (!port) {
+		*fifo_reg = ADIN1110_RX_REG;
+		*fifo_fsize_reg = ADIN1110_RX_FSIZE_REG;
+	} else {
+		*fifo_reg = ADIN2111_RX_P2_REG;
+		*fifo_fsize_reg = ADIN2111_RX_P2_FSIZE_REG;
+	}
+}
+
 /**
  * @brief Read a frame from the RX FIFO.
  * @param desc - the device descriptor
@@ -583,13 +638,7 @@ int adin1110_read_fifo(struct adin1110_desc *desc, uint32_t port,
 	if (port >= driver_data[desc->chip_type].num_ports)
 		return -EINVAL;
 
-	if (!port) {
-		fifo_reg = ADIN1110_RX_REG;
-		fifo_fsize_reg = ADIN1110_RX_FSIZE_REG;
-	} else {
-		fifo_reg = ADIN2111_RX_P2_REG;
-		fifo_fsize_reg = ADIN2111_RX_P2_FSIZE_REG;
-	}
+	adin1110_rx_regs(port, &fifo_reg, &fifo_fsize_reg);
 
 	ret = adin1110_reg_read(desc, fifo_fsize_reg, &frame_size);
 	if (ret)
@@ -632,6 +681,195 @@ int adin1110_read_fifo(struct adin1110_desc *desc, uint32_t port,
 	return 0;
 }
 
+/**
+ * @brief Write a frame to the TX FIFO without copying it. The SPI header,
+ * the frame segments and the padding are sent as separate messages of the
+ * same SPI transfer.
+ * @param desc - the device descriptor
+ * @param port - the port for the frame to be transmitted on.
+ * @param segs - the frame segments, starting with the destination MAC address.
+ * @param nb_segs - number of segments, at most ADIN1110_MAX_FRAME_SEGS.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adin1110_write_fifo_sg(struct adin1110_desc *desc, uint32_t port,
+			   const struct adin1110_buf_seg *segs,
+			   uint32_t nb_segs)
+{
+	struct no_os_spi_msg xfer[ADIN1110_MAX_FRAME_SEGS + 2] = {0};
+	uint32_t header_len = ADIN1110_WR_HEADER_LEN;
+	uint32_t padding = 0;
+	uint32_t padded_len;
+	uint32_t round_len;
+	uint32_t nb_msgs;
+	uint32_t len = 0;
+	uint32_t i;
+	int ret;
+
+	if (port >= driver_data[desc->chip_type].num_ports || !segs ||
+	    !nb_segs || nb_segs > ADIN1110_MAX_FRAME_SEGS)
+		return -EINVAL;
+
+	for (i = 0; i < nb_segs; i++)
+		len += segs[i].len;
+
+	if (len > ADIN1110_BUFF_LEN)
+		return -EINVAL;
+
+	/* The minimum frame length is 64 bytes */
+	if (len + ADIN1110_FCS_LEN < 64)
+		padding = 64 - (len + ADIN1110_FCS_LEN);
+
+	padded_len = len + padding + ADIN1110_FRAME_HEADER_LEN;
+	round_len = no_os_align(padded_len, 4);
+
+	ret = adin1110_tx_space_reserve(desc, padded_len);
+	if (ret)
+		return ret;
+
+	ret = adin1110_reg_write(desc, ADIN1110_TX_FSIZE_REG, padded_len);
+	if (ret)
+		return ret;
+
+	no_os_put_unaligned_be16(ADIN1110_TX_REG, &desc->data[0]);
+	desc->data[0] |= ADIN1110_SPI_CD | ADIN1110_SPI_RW;
+
+	if (desc->append_crc) {
+		desc->data[2] = no_os_crc8(_crc_table, desc->data, 2, 0);
+		header_len++;
+	}
+
+	/* Set the port on which to send the frame */
+	no_os_put_unaligned_be16(port, &desc->data[header_len]);
+	xfer[0].tx_buff = desc->data;
+	xfer[0].bytes_number = header_len + ADIN1110_FRAME_HEADER_LEN;
+	nb_msgs = 1;
+
+	for (i = 0; i < nb_segs; i++) {
+		if (!segs[i].len)
+			continue;
+		xfer[nb_msgs].tx_buff = segs[i].buf;
+		xfer[nb_msgs].bytes_number = segs[i].len;
+		nb_msgs++;
+	}
+
+	/* Zeros for the padding and the 4 byte alignment */
+	if (round_len > len + ADIN1110_FRAME_HEADER_LEN) {
+		xfer[nb_msgs].tx_buff = adin1110_tx_zeros;
+		xfer[nb_msgs].bytes_number = round_len - len -
+					     ADIN1110_FRAME_HEADER_LEN;
+		nb_msgs++;
+	}
+	xfer[nb_msgs - 1].cs_change = 1;
+
+	return no_os_spi_transfer(desc->comm_desc, xfer, nb_msgs);
+}
+
+/**
+ * @brief Get the length of the next frame in the RX FIFO.
+ * @param desc - the device descriptor
+ * @param port - the port from which the frame shall be received.
+ * @param len - length of the frame, without the frame header, 0 if there is
+ * no frame to be read.
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adin1110_rx_frame_len(struct adin1110_desc *desc, uint32_t port,
+			  uint32_t *len)
+{
+	uint32_t fifo_fsize_reg;
+	uint32_t frame_size;
+	uint32_t fifo_reg;
+	int ret;
+
+	if (port >= driver_data[desc->chip_type].num_ports || !len)
+		return -EINVAL;
+
+	adin1110_rx_regs(port, &fifo_reg, &fifo_fsize_reg);
+
+	ret = adin1110_reg_read(desc, fifo_fsize_reg, &frame_size);
+	if (ret)
+		return ret;
+
+	if (frame_size < ADIN1110_FRAME_HEADER_LEN + ADIN1110_FEC_LEN ||
+	    frame_size > ADIN1110_BUFF_LEN)
+		*len = 0;
+	else
+		*len = frame_size - ADIN1110_FRAME_HEADER_LEN;
+
+	return 0;
+}
+
+/**
+ * @brief Read a frame from the RX FIFO without copying it. The SPI header and
+ * the frame header are received in the descriptor buffer and the frame is
+ * received directly in the segments, as messages of the same SPI transfer.
+ * @param desc - the device descriptor
+ * @param port - the port from which the frame shall be received.
+ * @param segs - the memory segments receiving the frame, the bytes that don't
+ * fit are discarded.
+ * @param nb_segs - number of segments, at most ADIN1110_MAX_FRAME_SEGS.
+ * @param len - length of the frame, as returned by adin1110_rx_frame_len().
+ * @return 0 in case of success, negative error code otherwise
+ */
+int adin1110_read_fifo_sg(struct adin1110_desc *desc, uint32_t port,
+			  const struct adin1110_buf_seg *segs,
+			  uint32_t nb_segs, uint32_t len)
+{
+	struct no_os_spi_msg xfer[ADIN1110_MAX_FRAME_SEGS + 2] = {0};
+	uint32_t header_len = ADIN1110_RD_HEADER_LEN;
+	uint32_t fifo_fsize_reg;
+	uint32_t rounded_len;
+	uint32_t fifo_reg;
+	uint32_t nb_msgs;
+	uint32_t left;
+	uint32_t i;
+
+	if (port >= driver_data[desc->chip_type].num_ports || !len ||
+	    len > ADIN1110_BUFF_LEN || (nb_segs && !segs) ||
+	    nb_segs > ADIN1110_MAX_FRAME_SEGS)
+		return -EINVAL;
+
+	adin1110_rx_regs(port, &fifo_reg, &fifo_fsize_reg);
+
+	no_os_put_unaligned_be16(fifo_reg, &desc->data[0]);
+	desc->data[0] |= ADIN1110_SPI_CD;
+	desc->data[2] = 0x0;
+
+	if (desc->append_crc) {
+		desc->data[2] = no_os_crc8(_crc_table, desc->data, 2, 0);
+		desc->data[3] = 0x0;
+		header_len++;
+	}
+
+	/* Set the port from which to receive the frame */
+	no_os_put_unaligned_be16(port, &desc->data[header_len]);
+	xfer[0].tx_buff = desc->data;
+	xfer[0].rx_buff = desc->data;
+	xfer[0].bytes_number = header_len + ADIN1110_FRAME_HEADER_LEN;
+	nb_msgs = 1;
+
+	left = len;
+	for (i = 0; i < nb_segs && left; i++) {
+		if (!segs[i].len)
+			continue;
+		xfer[nb_msgs].rx_buff = segs[i].buf;
+		xfer[nb_msgs].bytes_number = no_os_min(segs[i].len, left);
+		left -= xfer[nb_msgs].bytes_number;
+		nb_msgs++;
+	}
+
+	/* Can only read multiples of 4 bytes, the extra bytes are dropped */
+	rounded_len = no_os_align(len + ADIN1110_FRAME_HEADER_LEN, 4);
+	left += rounded_len - len - ADIN1110_FRAME_HEADER_LEN;
+	if (left) {
+		xfer[nb_msgs].rx_buff = adin1110_rx_discard;
+		xfer[nb_msgs].bytes_number = left;
+		nb_msgs++;
+	}
+	xfer[nb_msgs - 1].cs_change = 1;
+
+	return no_os_spi_transfer(desc->comm_desc, xfer, nb_msgs);
+}
+
 /**
  * @brief Reset the MAC device.
  * @param desc - the device descriptor
@@ -185,6 +185,9 @@
 #define ADIN1110_CRC_LEN			1
 #define ADIN1110_FEC_LEN			4
 
+/* Maximum number of memory segments of a zero-copy frame transfer */
+#define ADIN1110_MAX_FRAME_SEGS			6
+
 #define ADIN_MAC_MULTICAST_ADDR_SLOT		0
 #define ADIN_MAC_BROADCAST_ADDR_SLOT		1
 #define ADIN_MAC_P1_ADDR_SLOT			2
@@ -209,6 +212,8 @@ struct adin1110_desc {
 	uint8_t data[ADIN1110_BUFF_LEN];
 	struct no_os_gpio_desc *reset_gpio;
 	bool append_crc;
+	/* TX FIFO space (16 bit words) left since the last TX_SPACE read */
+	uint32_t tx_space;
 };
 
 /**
@@ -233,6 +238,14 @@ struct adin1110_eth_buff {
 	uint8_t *payload;
 };
 
+/**
+ * @brief Memory segment of a frame, used for the zero-copy FIFO access.
+ */
+struct adin1110_buf_seg {
+	uint8_t *buf;
+	uint32_t len;
+};
+
 /* Reset both the MAC and PHY. */
 int adin1110_sw_reset(struct adin1110_desc *);
 
@@ -253,6 +266,17 @@ int adin1110_write_fifo(struct adin1110_desc *, uint32_t,
 int adin1110_read_fifo(struct adin1110_desc *, uint32_t,
 		       struct adin1110_eth_buff *);
 
+/* Write a frame stored in several memory segments to the TX FIFO */
+int adin1110_write_fifo_sg(struct adin1110_desc *, uint32_t,
+			   const struct adin1110_buf_seg *, uint32_t);
+
+/* Get the length of the next frame in the RX FIFO, 0 if it's empty */
+int adin1110_rx_frame_len(struct adin1110_desc *, uint32_t, uint32_t *);
+
+/* Read a frame from the RX FIFO directly into several memory segments */
+int adin1110_read_fifo_sg(struct adin1110_desc *, uint32_t,
+			  const struct adin1110_buf_seg *, uint32_t, uint32_t);
+
 /* Write a PHY register using clause 22 */
 int adin1110_mdio_write(struct adin1110_desc *, uint32_t, uint32_t, uint16_t);
 
@@ -232,11 +232,13 @@ static int32_t aducm3029_i2c_write(struct no_os_i2c_desc *desc,
 	}
 
 	if (stop_bit == 0) {
-		aducm_i2c->prologue_size = bytes_number;
 		if (aducm_i2c->prologue_data) {
-			temp_ptr = realloc(aducm_i2c->prologue_data, bytes_number);
+			temp_ptr = no_os_realloc(aducm_i2c->prologue_data,
+						 bytes_number);
 			if (!temp_ptr) {
 				no_os_free(aducm_i2c->prologue_data);
+				aducm_i2c->prologue_data = NULL;
+				aducm_i2c->prologue_size = 0;
 				return -1;
 			}
 			aducm_i2c->prologue_data = temp_ptr;
@@ -245,6 +247,7 @@ static int32_t aducm3029_i2c_write(struct no_os_i2c_desc *desc,
 			if (!aducm_i2c->prologue_data)
 				return -1;
 		}
+		aducm_i2c->prologue_size = bytes_number;
 		memcpy(aducm_i2c->prologue_data, data, bytes_number);
 
 		return 0;
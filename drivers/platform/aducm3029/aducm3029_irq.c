@@ -45,6 +45,7 @@
 #include "aducm3029_irq.h"
 #include "no_os_error.h"
 #include <stdlib.h>
+#include <stdatomic.h>
 #include "no_os_uart.h"
 #include "aducm3029_uart.h"
 #include "no_os_rtc.h"
@@ -55,8 +56,8 @@
 #include "no_os_timer.h"
 #include "aducm3029_timer.h"
 #include "no_os_util.h"
-#include "no_os_list.h"
 #include "no_os_alloc.h"
+#include "no_os_irq_table.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -83,23 +84,45 @@ int32_t irq_action_cmp(void *data1, void *data2)
 	       ((struct irq_action *)data2)->irq_id;
 }
 
+/** Events from NO_OS_EVT_UART_TX_COMPLETE to NO_OS_EVT_TIM_ELAPSED */
+#define NB_IRQ_EVENTS	(NO_OS_EVT_TIM_ELAPSED - NO_OS_EVT_UART_TX_COMPLETE + 1)
+
+/* There is a single UART, RTC and Timer1, so one slot for each event */
+static struct no_os_irq_slot aducm_irq_slots[NB_IRQ_EVENTS];
+static struct no_os_irq_table aducm_irq_table = {
+	.slots = aducm_irq_slots,
+	.first_event = NO_OS_EVT_UART_TX_COMPLETE,
+	.nb_events = NB_IRQ_EVENTS,
+	.nb_slots = 1,
+};
+
 /**
- * @brief Struct that stores all the actions for a specific event
+ * @brief Get the slot of an event if a callback is registered for it.
+ * @param event - The event.
+ * @return The slot, NULL if there is no callback.
  */
-struct event_list {
-	enum no_os_irq_event event;
-	struct no_os_list_desc *actions;
-	uint32_t hal_event;
-};
+static struct no_os_irq_slot *aducm_irq_slot_used(uint32_t event)
+{
+	struct no_os_irq_slot *slot;
 
-static struct event_list _events[] = {
-	[NO_OS_EVT_GPIO] = {.event = NO_OS_EVT_GPIO},
-	[NO_OS_EVT_UART_TX_COMPLETE] = {.event = NO_OS_EVT_UART_TX_COMPLETE, .hal_event = UART_EVT_IRQn},
-	[NO_OS_EVT_UART_RX_COMPLETE] = {.event = NO_OS_EVT_UART_RX_COMPLETE, .hal_event = UART_EVT_IRQn},
-	[NO_OS_EVT_UART_ERROR] = {.event = NO_OS_EVT_UART_ERROR, .hal_event = UART_EVT_IRQn},
-	[NO_OS_EVT_RTC] {.event = NO_OS_EVT_RTC},
-	[NO_OS_EVT_TIM_ELAPSED] = {.event = NO_OS_EVT_TIM_ELAPSED, .hal_event = TMR1_EVT_IRQn},
-};
+	slot = no_os_irq_table_get(&aducm_irq_table, event, 0);
+	if (!slot || !atomic_load_explicit(&slot->callback,
+					   memory_order_acquire))
+		return NULL;
+
+	return slot;
+}
+
+/**
+ * @brief Check if a callback is registered for any of the UART events.
+ * @return true/false
+ */
+static bool aducm_uart_irq_used(void)
+{
+	return aducm_irq_slot_used(NO_OS_EVT_UART_TX_COMPLETE) ||
+	       aducm_irq_slot_used(NO_OS_EVT_UART_RX_COMPLETE) ||
+	       aducm_irq_slot_used(NO_OS_EVT_UART_ERROR);
+}
 
 /**
  * @brief Call the user defined callback when a read/write operation completed.
@@ -111,7 +134,6 @@ static void aducm_uart_callback(void *ctx, uint32_t event, void *buff)
 {
 	struct no_os_aducm_uart_desc	*extra = ctx;
 	uint32_t		len;
-	struct irq_action *action;
 
 	switch(event) {
 	/* Read done */
@@ -127,10 +149,8 @@ static void aducm_uart_callback(void *ctx, uint32_t event, void *buff)
 			extra->read_desc.buff += len;
 		} else {
 			extra->read_desc.is_nonblocking = false;
-			no_os_list_read_last(_events[NO_OS_EVT_UART_RX_COMPLETE].actions,
-					     (void **)&action);
-			if (action)
-				action->callback(action->ctx);
+			no_os_irq_table_dispatch(&aducm_irq_table,
+						 NO_OS_EVT_UART_RX_COMPLETE, 0);
 		}
 		break;
 	/* Write done */
@@ -146,20 +166,16 @@ static void aducm_uart_callback(void *ctx, uint32_t event, void *buff)
 			extra->write_desc.buff += len;
 		} else {
 			extra->write_desc.is_nonblocking = false;
-			no_os_list_read_last(_events[NO_OS_EVT_UART_TX_COMPLETE].actions,
-					     (void **)&action);
-			if (action)
-				action->callback(action->ctx);
+			no_os_irq_table_dispatch(&aducm_irq_table,
+						 NO_OS_EVT_UART_TX_COMPLETE, 0);
 		}
 		break;
 	default:
 		extra->errors |= (uint32_t)buff;
 		extra->read_desc.is_nonblocking = false;
 		extra->write_desc.is_nonblocking = false;
-		no_os_list_read_last(_events[NO_OS_EVT_UART_ERROR].actions,
-				     (void **)&action);
-		if (action)
-			action->callback(action->ctx);
+		no_os_irq_table_dispatch(&aducm_irq_table, NO_OS_EVT_UART_ERROR,
+					 0);
 		break;
 	}
 }
@@ -172,12 +188,7 @@ static void aducm_uart_callback(void *ctx, uint32_t event, void *buff)
  */
 static void aducm_rtc_callback(void *ctx, uint32_t event, void *buff)
 {
-	struct irq_action *action;
-
-	no_os_list_read_last(_events[NO_OS_EVT_RTC].actions,
-			     (void **)&action);
-	if (action)
-		action->callback(action->ctx);
+	no_os_irq_table_dispatch(&aducm_irq_table, NO_OS_EVT_RTC, 0);
 }
 
 /**
@@ -188,13 +199,9 @@ static void aducm_rtc_callback(void *ctx, uint32_t event, void *buff)
  */
 static void aducm_timer_callback(void *ctx, uint32_t event, void *buff)
 {
-	struct irq_action *action;
-	if (event == ADI_TMR_EVENT_TIMEOUT) {
-		no_os_list_read_last(_events[NO_OS_EVT_TIM_ELAPSED].actions,
-				     (void **)&action);
-		if (action)
-			action->callback(action->ctx);
-	}
+	if (event == ADI_TMR_EVENT_TIMEOUT)
+		no_os_irq_table_dispatch(&aducm_irq_table,
+					 NO_OS_EVT_TIM_ELAPSED, 0);
 }
 
 /******************************************************************************/
@@ -243,9 +250,7 @@ int32_t aducm3029_irq_ctrl_remove(struct no_os_irq_ctrl_desc *desc)
 	if (!desc || !desc->extra)
 		return -1;
 
-	no_os_irq_unregister_callback(desc, ADUCM_UART_INT_ID, NULL);
-	no_os_irq_unregister_callback(desc, ADUCM_RTC_INT_ID, NULL);
-	no_os_irq_unregister_callback(desc, ADUCM_TIMER1_INT_ID, NULL);
+	no_os_irq_table_clear(&aducm_irq_table);
 	no_os_free(desc->extra);
 	no_os_free(desc);
 
@@ -269,9 +274,6 @@ int32_t aducm3029_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 	struct aducm_rtc_desc		*rtc_extra;
 	struct no_os_timer_desc			*timer_desc;
 	struct aducm_timer_desc		*timer_extra;
-	int32_t				ret;
-	struct irq_action	*action;
-	int32_t i;
 
 	if (!desc || !desc->extra ||  irq_id >= NB_INTERRUPTS)
 		return -1;
@@ -281,47 +283,34 @@ int32_t aducm3029_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 
 	switch (irq_id) {
 	case ADUCM_UART_INT_ID:
+		if (callback_desc->event < NO_OS_EVT_UART_TX_COMPLETE ||
+		    callback_desc->event > NO_OS_EVT_UART_ERROR)
+			return -EINVAL;
+
 		aducm_uart = callback_desc->handle;
-		for (i = NO_OS_EVT_UART_TX_COMPLETE; i <= NO_OS_EVT_UART_ERROR; i++)
-			if (!no_os_list_get_last(_events[callback_desc->event].actions,
-						 (void **)&action))
-				break;
-		if (i > NO_OS_EVT_UART_ERROR)
+		if (!aducm_uart_irq_used())
 			adi_uart_RegisterCallback(aducm_uart->uart_handler,
 						  aducm_uart_callback, callback_desc->handle);
 
-		if (_events[callback_desc->event].actions == NULL) {
-			ret = no_os_list_init(&_events[callback_desc->event].actions,
-					      NO_OS_LIST_PRIORITY_LIST,
-					      irq_action_cmp);
-			if (ret)
-				return ret;
-		}
-
 		break;
 	case ADUCM_RTC_INT_ID:
+		if (callback_desc->event != NO_OS_EVT_RTC)
+			return -EINVAL;
+
 		rtc_desc = callback_desc->handle;
 		rtc_extra = rtc_desc->extra;
-		if (_events[callback_desc->event].actions == NULL) {
-			ret = no_os_list_init(&_events[callback_desc->event].actions,
-					      NO_OS_LIST_PRIORITY_LIST,
-					      irq_action_cmp);
-			if (ret)
-				return ret;
+		if (!aducm_irq_slot_used(NO_OS_EVT_RTC))
 			adi_rtc_RegisterCallback(rtc_extra->instance, aducm_rtc_callback,
 						 callback_desc->handle);
-		}
 
 		break;
 	case ADUCM_TIMER1_INT_ID:
+		if (callback_desc->event != NO_OS_EVT_TIM_ELAPSED)
+			return -EINVAL;
+
 		timer_desc = callback_desc->handle;
 		timer_extra = timer_desc->extra;
-		if (_events[callback_desc->event].actions == NULL) {
-			ret = no_os_list_init(&_events[callback_desc->event].actions,
-					      NO_OS_LIST_PRIORITY_LIST,
-					      irq_action_cmp);
-			if (ret)
-				return ret;
+		if (!aducm_irq_slot_used(NO_OS_EVT_TIM_ELAPSED)) {
 			/* Init function is called again to register the needed callback.
 			   This implementation can be changed in the future if adi_tmr_RegisterCallback will be available. */
 			adi_tmr_Init(timer_desc->id, aducm_timer_callback, callback_desc->handle,
@@ -337,34 +326,8 @@ int32_t aducm3029_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 		return -1;
 	}
 
-	ret = no_os_list_read_last(_events[callback_desc->event].actions,
-				   (void **)&action);
-	if (ret) {
-		action = no_os_calloc(1, sizeof(*action));
-		if (!action)
-			return -ENOMEM;
-
-		action->irq_id = callback_desc->event;
-		action->handle = callback_desc->handle;
-		action->callback = callback_desc->callback;
-		action->ctx = callback_desc->ctx;
-
-		ret = no_os_list_add_last(_events[callback_desc->event].actions,
-					  action);
-		if (ret)
-			goto free_action;
-	} else {
-		action->irq_id = callback_desc->event;
-		action->handle = callback_desc->handle;
-		action->callback = callback_desc->callback;
-		action->ctx = callback_desc->ctx;
-	}
-
-	return 0;
-free_action:
-	no_os_free(action);
-
-	return ret;
+	return no_os_irq_table_register(&aducm_irq_table, 0, irq_id,
+					callback_desc);
 }
 
 /**
@@ -377,35 +340,40 @@ free_action:
 int32_t aducm3029_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 		uint32_t irq_id, struct no_os_callback_desc *cb)
 {
-	struct irq_action			*action;
-	uint32_t					ret;
-	int i;
+	int32_t					ret;
 	struct no_os_aducm_uart_desc	*aducm_uart;
 
-	if (!desc || !desc->extra || irq_id >= NB_INTERRUPTS)
+	if (!desc || !desc->extra || irq_id >= NB_INTERRUPTS || !cb)
 		return -1;
 
-	aducm_uart = cb->handle;
-
-	ret = no_os_list_get_last(_events[cb->event].actions, (void **)&action);
-	if (ret)
-		return ret;
-
-	ret = no_os_list_remove(_events[cb->event].actions);
+	ret = no_os_irq_table_unregister(&aducm_irq_table, cb->event, 0);
 	if (ret)
 		return ret;
 
-	_events[cb->event].actions = NULL;
-
-	for (i = NO_OS_EVT_UART_TX_COMPLETE; i <= NO_OS_EVT_UART_ERROR; i++)
-		if (!no_os_list_get_last(_events[cb->event].actions, (void **)&action))
-			break;
-	if (i > NO_OS_EVT_UART_ERROR)
+	if (irq_id == ADUCM_UART_INT_ID && !aducm_uart_irq_used()) {
+		aducm_uart = cb->handle;
 		adi_uart_RegisterCallback(aducm_uart->uart_handler, NULL, NULL);
+	}
 
 	return 0;
 }
 
+/**
+ * @brief Get the dispatch statistics of a registered callback.
+ * @param cb - Callback descriptor, only the event is used.
+ * @param count - Number of dispatched interrupts.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t aducm3029_irq_stats_get(struct no_os_callback_desc *cb,
+				uint32_t *count)
+{
+	if (!cb)
+		return -EINVAL;
+
+	return no_os_irq_table_stats(&aducm_irq_table, cb->event, 0, count,
+				     NULL);
+}
+
 /**
  * @brief Enable all previously enabled interrupts by \ref no_os_irq_enable().
  * @param desc - Interrupt controller descriptor.
@@ -460,8 +428,7 @@ int32_t aducm3029_irq_enable(struct no_os_irq_ctrl_desc *desc,
 {
 	struct no_os_rtc_desc		*rtc_desc;
 	struct aducm_rtc_desc		*aducm_rtc;
-	struct irq_action			*action;
-	int32_t						ret;
+	struct no_os_irq_slot		*slot;
 
 	if (!desc || !desc->extra || irq_id >= NB_INTERRUPTS)
 		return -1;
@@ -471,12 +438,11 @@ int32_t aducm3029_irq_enable(struct no_os_irq_ctrl_desc *desc,
 		NVIC_EnableIRQ(UART_EVT_IRQn);
 		break;
 	case ADUCM_RTC_INT_ID:
-		ret = no_os_list_read_last(_events[NO_OS_EVT_RTC].actions,
-					   (void **)&action);
-		if (ret)
-			return ret;
+		slot = aducm_irq_slot_used(NO_OS_EVT_RTC);
+		if (!slot)
+			return -1;
 
-		rtc_desc = action->handle;
+		rtc_desc = slot->handle;
 		aducm_rtc = rtc_desc->extra;
 		adi_rtc_EnableInterrupts(aducm_rtc->instance, RTC_COUNT_ROLLOVER_INT, true);
 		break;
@@ -502,8 +468,7 @@ int32_t aducm3029_irq_disable(struct no_os_irq_ctrl_desc *desc,
 {
 	struct no_os_rtc_desc		*rtc_desc;
 	struct aducm_rtc_desc		*aducm_rtc;
-	struct irq_action			*action;
-	int32_t						ret;
+	struct no_os_irq_slot		*slot;
 
 	if (!desc || !desc->extra || irq_id >= NB_INTERRUPTS)
 		return -1;
@@ -513,12 +478,11 @@ int32_t aducm3029_irq_disable(struct no_os_irq_ctrl_desc *desc,
 		NVIC_DisableIRQ(UART_EVT_IRQn);
 		break;
 	case ADUCM_RTC_INT_ID:
-		ret = no_os_list_read_last(_events[NO_OS_EVT_RTC].actions,
-					   (void **)&action);
-		if (ret)
-			return ret;
+		slot = aducm_irq_slot_used(NO_OS_EVT_RTC);
+		if (!slot)
+			return -1;
 
-		rtc_desc = action->handle;
+		rtc_desc = slot->handle;
 		aducm_rtc = rtc_desc->extra;
 		adi_rtc_EnableInterrupts(aducm_rtc->instance, RTC_COUNT_INT, false);
 		break;
@@ -137,4 +137,8 @@ struct irq_action {
 /** Action comparator function */
 int32_t irq_action_cmp(void *data1, void *data2);
 
+/** Get the dispatch statistics of a registered callback */
+int32_t aducm3029_irq_stats_get(struct no_os_callback_desc *cb,
+				uint32_t *count);
+
 #endif // ADUCM3029_IRQ_H
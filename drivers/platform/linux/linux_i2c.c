@@ -51,6 +51,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 
 /******************************************************************************/
@@ -64,12 +65,38 @@
 struct linux_i2c_desc {
 	/** /dev/i2c-"device_id" file descriptor */
 	int fd;
+	/** Slave address last selected with I2C_SLAVE, -1 if none */
+	int slave_address;
 };
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * @brief Select the slave address used by read() and write(), only when it
+ * changed since the previous call.
+ * @param desc - The I2C descriptor.
+ * @return 0 in case of success, -1 otherwise.
+ */
+static int32_t linux_i2c_select(struct no_os_i2c_desc *desc)
+{
+	struct linux_i2c_desc *linux_desc = desc->extra;
+	int32_t ret;
+
+	if (linux_desc->slave_address == desc->slave_address)
+		return 0;
+
+	ret = ioctl(linux_desc->fd, I2C_SLAVE, desc->slave_address);
+	if (ret < 0) {
+		printf("%s: Can't select device\n\r", __func__);
+		return -1;
+	}
+	linux_desc->slave_address = desc->slave_address;
+
+	return 0;
+}
+
 /**
  * @brief Initialize the I2C communication peripheral.
  * @param desc - The I2C descriptor.
@@ -105,6 +132,7 @@ int32_t linux_i2c_init(struct no_os_i2c_desc **desc,
 	}
 
 	descriptor->slave_address = param->slave_address;
+	linux_desc->slave_address = -1;
 
 	*desc = descriptor;
 
@@ -162,11 +190,9 @@ int32_t linux_i2c_write(struct no_os_i2c_desc *desc,
 
 	linux_desc = desc->extra;
 
-	ret = ioctl(linux_desc->fd, I2C_SLAVE, desc->slave_address);
-	if (ret < 0) {
-		printf("%s: Can't select device\n\r", __func__);
-		return -1;
-	}
+	ret = linux_i2c_select(desc);
+	if (ret)
+		return ret;
 
 	ret = write(linux_desc->fd, data, bytes_number);
 	if (ret < 0) {
@@ -201,11 +227,9 @@ int32_t linux_i2c_read(struct no_os_i2c_desc *desc,
 
 	linux_desc = desc->extra;
 
-	ret = ioctl(linux_desc->fd, I2C_SLAVE, desc->slave_address);
-	if (ret < 0) {
-		printf("%s: Can't select device\n\r", __func__);
-		return -1;
-	}
+	ret = linux_i2c_select(desc);
+	if (ret)
+		return ret;
 
 	ret = read(linux_desc->fd, data, bytes_number);
 	if (ret < 0) {
@@ -220,6 +244,54 @@ int32_t linux_i2c_read(struct no_os_i2c_desc *desc,
 	return 0;
 }
 
+/**
+ * @brief Send a list of messages with a single I2C_RDWR ioctl. Messages are
+ * separated by repeated starts and a stop is generated after the last one.
+ * @param desc - The I2C descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t linux_i2c_transfer(struct no_os_i2c_desc *desc,
+			   struct no_os_i2c_msg *msgs,
+			   uint32_t len)
+{
+	struct i2c_msg i2c_msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+	struct i2c_rdwr_ioctl_data rdwr;
+	struct linux_i2c_desc *linux_desc;
+	uint32_t i;
+	int ret;
+
+	if (!len)
+		return 0;
+
+	if (len > I2C_RDWR_IOCTL_MAX_MSGS)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	for (i = 0; i < len; i++) {
+		if (msgs[i].bytes_number > UINT16_MAX)
+			return -EINVAL;
+
+		i2c_msgs[i].addr = desc->slave_address;
+		i2c_msgs[i].flags = msgs[i].read ? I2C_M_RD : 0;
+		i2c_msgs[i].len = msgs[i].bytes_number;
+		i2c_msgs[i].buf = msgs[i].buff;
+	}
+
+	rdwr.msgs = i2c_msgs;
+	rdwr.nmsgs = len;
+
+	ret = ioctl(linux_desc->fd, I2C_RDWR, &rdwr);
+	if (ret < 0) {
+		printf("%s: Can't transfer messages\n\r", __func__);
+		return -EIO;
+	}
+
+	return 0;
+}
+
 /**
  * @brief Linux platform specific I2C platform ops structure
  */
@@ -227,5 +299,6 @@ const struct no_os_i2c_platform_ops linux_i2c_ops = {
 	.i2c_ops_init = &linux_i2c_init,
 	.i2c_ops_write = &linux_i2c_write,
 	.i2c_ops_read = &linux_i2c_read,
-	.i2c_ops_remove = &linux_i2c_remove
+	.i2c_ops_remove = &linux_i2c_remove,
+	.i2c_ops_transfer = &linux_i2c_transfer
 };
@@ -44,17 +44,37 @@
 #include "no_os_error.h"
 #include "no_os_spi.h"
 #include "no_os_alloc.h"
+#include "no_os_util.h"
 #include "linux_spi.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <linux/spi/spidev.h>
 
 #warning SPI cs_delay_first and cs_delay_last delays are not supported on the linux platform
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* spidev buffer size, used when the module parameter can't be read */
+#define LINUX_SPI_BUFSIZ_DEFAULT	4096
+#define LINUX_SPI_BUFSIZ_PATH		"/sys/module/spidev/parameters/bufsiz"
+/* spidev accounts each buffer aligned to ARCH_KMALLOC_MINALIGN (128 max) */
+#define LINUX_SPI_LEN_ALIGN		128
+/* Largest transfer array that fits in the SPI_IOC_MESSAGE() size field */
+#define LINUX_SPI_MAX_TRANSFERS		\
+	(((1 << _IOC_SIZEBITS) - 1) / sizeof(struct spi_ioc_transfer))
+/* Transfer array entries allocated at init */
+#define LINUX_SPI_INIT_TRANSFERS	16
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -66,12 +86,255 @@
 struct linux_spi_desc {
 	/** /dev/spidev"device_id"."chip_select" file descriptor */
 	int spidev_fd;
+	/** Transfer array, reused by all the SPI_IOC_MESSAGE() calls */
+	struct spi_ioc_transfer *tr;
+	/** Number of entries allocated in tr */
+	uint32_t tr_size;
+	/** Number of transfers queued in tr */
+	uint32_t nb_tr;
+	/** Bytes spidev accounts for the queued transfers */
+	uint32_t nb_bytes;
+	/** Maximum number of bytes of a SPI_IOC_MESSAGE() call */
+	uint32_t bufsiz;
+	/** Serializes the transfer array between the caller and the worker */
+	pthread_mutex_t lock;
+	/** Signals a new request, or the stop, to the worker */
+	pthread_cond_t cond;
+	/** Worker running the asynchronous transfers */
+	pthread_t worker;
+	bool worker_running;
+	bool worker_stop;
+	/** Pending asynchronous request, NULL if none */
+	struct no_os_spi_msg *async_msgs;
+	uint32_t async_len;
+	void (*async_callback)(void *);
+	void *async_ctx;
+	/** Result of the last asynchronous request */
+	int32_t async_ret;
 };
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/**
+ * @brief Read the spidev buffer size module parameter.
+ * @return The maximum number of bytes of a SPI_IOC_MESSAGE() call.
+ */
+static uint32_t linux_spi_bufsiz(void)
+{
+	unsigned int bufsiz;
+	FILE *f;
+	int ret;
+
+	f = fopen(LINUX_SPI_BUFSIZ_PATH, "r");
+	if (!f)
+		return LINUX_SPI_BUFSIZ_DEFAULT;
+
+	ret = fscanf(f, "%u", &bufsiz);
+	fclose(f);
+	if (ret != 1 || !bufsiz)
+		return LINUX_SPI_BUFSIZ_DEFAULT;
+
+	return bufsiz;
+}
+
+/**
+ * @brief Make room for one more transfer in the transfer array.
+ * @param linux_desc - The Linux SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_grow(struct linux_spi_desc *linux_desc)
+{
+	struct spi_ioc_transfer *tr;
+	uint32_t size;
+
+	if (linux_desc->nb_tr < linux_desc->tr_size)
+		return 0;
+
+	size = no_os_min(2 * linux_desc->tr_size,
+			 (uint32_t)LINUX_SPI_MAX_TRANSFERS);
+	tr = no_os_calloc(size, sizeof(*tr));
+	if (!tr)
+		return -ENOMEM;
+
+	memcpy(tr, linux_desc->tr, linux_desc->nb_tr * sizeof(*tr));
+	no_os_free(linux_desc->tr);
+	linux_desc->tr = tr;
+	linux_desc->tr_size = size;
+
+	return 0;
+}
+
+/**
+ * @brief Send the queued transfers with one SPI_IOC_MESSAGE() call.
+ *
+ * Inside the array, cs_change set releases CS after the transfer. On the
+ * last transfer spidev inverts it: cs_change set keeps CS asserted for the
+ * next call, which is what a message split over two calls needs.
+ *
+ * @param linux_desc - The Linux SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_submit(struct linux_spi_desc *linux_desc)
+{
+	struct spi_ioc_transfer *last;
+	uint32_t nb_tr = linux_desc->nb_tr;
+	int ret;
+
+	if (!nb_tr)
+		return 0;
+
+	last = &linux_desc->tr[nb_tr - 1];
+	last->cs_change = !last->cs_change;
+
+	linux_desc->nb_tr = 0;
+	linux_desc->nb_bytes = 0;
+
+	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(nb_tr),
+		    linux_desc->tr);
+	if (ret < 0) {
+		ret = errno;
+		printf("%s: Can't send spi message (%d)\n\r", __func__, ret);
+		return -ret;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Append messages to the transfer array.
+ *
+ * The array is sent before it would exceed the spidev buffer size or the
+ * SPI_IOC_MESSAGE() size. Messages larger than the buffer size are split,
+ * CS stays asserted between the parts. CS is always released after the
+ * last message of the list.
+ *
+ * @param linux_desc - The Linux SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_add(struct linux_spi_desc *linux_desc,
+			     struct no_os_spi_msg *msgs, uint32_t len)
+{
+	struct spi_ioc_transfer *tr;
+	uint32_t max_chunk;
+	uint32_t bufsiz;
+	uint32_t aligned;
+	uint32_t offset;
+	uint32_t chunk;
+	bool release;
+	int32_t ret;
+	uint32_t i;
+
+	bufsiz = linux_desc->bufsiz;
+	max_chunk = bufsiz - bufsiz % LINUX_SPI_LEN_ALIGN;
+	if (!max_chunk)
+		max_chunk = bufsiz;
+
+	for (i = 0; i < len; i++) {
+		release = msgs[i].cs_change || i == len - 1;
+		offset = 0;
+		do {
+			chunk = no_os_min(msgs[i].bytes_number - offset,
+					  max_chunk);
+			aligned = NO_OS_DIV_ROUND_UP(chunk,
+						     LINUX_SPI_LEN_ALIGN);
+			aligned = no_os_min(aligned * LINUX_SPI_LEN_ALIGN,
+					    bufsiz);
+
+			if (linux_desc->nb_bytes + aligned > bufsiz ||
+			    linux_desc->nb_tr == LINUX_SPI_MAX_TRANSFERS) {
+				ret = linux_spi_submit(linux_desc);
+				if (ret)
+					return ret;
+			}
+
+			ret = linux_spi_grow(linux_desc);
+			if (ret)
+				return ret;
+
+			tr = &linux_desc->tr[linux_desc->nb_tr++];
+			memset(tr, 0, sizeof(*tr));
+			if (msgs[i].tx_buff)
+				tr->tx_buf = (unsigned long)(msgs[i].tx_buff +
+							     offset);
+			if (msgs[i].rx_buff)
+				tr->rx_buf = (unsigned long)(msgs[i].rx_buff +
+							     offset);
+			tr->len = chunk;
+			tr->word_delay_usecs = msgs[i].cs_change_delay;
+			offset += chunk;
+			tr->cs_change = release &&
+					offset == msgs[i].bytes_number;
+
+			linux_desc->nb_bytes += aligned;
+		} while (offset < msgs[i].bytes_number);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Queue messages and send them with one SPI_IOC_MESSAGE() call.
+ * @param linux_desc - The Linux SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_send(struct linux_spi_desc *linux_desc,
+			      struct no_os_spi_msg *msgs, uint32_t len)
+{
+	int32_t ret;
+
+	ret = linux_spi_add(linux_desc, msgs, len);
+	if (ret) {
+		linux_desc->nb_tr = 0;
+		linux_desc->nb_bytes = 0;
+		return ret;
+	}
+
+	return linux_spi_submit(linux_desc);
+}
+
+/**
+ * @brief Run the asynchronous transfers, one request at a time.
+ * @param arg - The Linux SPI descriptor.
+ * @return NULL.
+ */
+static void *linux_spi_worker(void *arg)
+{
+	struct linux_spi_desc *linux_desc = arg;
+	void (*callback)(void *);
+	void *ctx;
+
+	pthread_mutex_lock(&linux_desc->lock);
+	while (true) {
+		while (!linux_desc->worker_stop && !linux_desc->async_msgs)
+			pthread_cond_wait(&linux_desc->cond, &linux_desc->lock);
+		if (linux_desc->worker_stop)
+			break;
+
+		linux_desc->async_ret = linux_spi_send(linux_desc,
+						       linux_desc->async_msgs,
+						       linux_desc->async_len);
+
+		callback = linux_desc->async_callback;
+		ctx = linux_desc->async_ctx;
+		linux_desc->async_msgs = NULL;
+
+		/* The callback may start the next transfer */
+		pthread_mutex_unlock(&linux_desc->lock);
+		if (callback)
+			callback(ctx);
+		pthread_mutex_lock(&linux_desc->lock);
+	}
+	pthread_mutex_unlock(&linux_desc->lock);
+
+	return NULL;
+}
+
 /**
  * @brief Initialize the SPI communication peripheral.
  * @param desc - The SPI descriptor.
@@ -91,13 +354,20 @@ int32_t linux_spi_init(struct no_os_spi_desc **desc,
 	if (!descriptor)
 		return -1;
 
-	linux_desc = (struct linux_spi_desc*) no_os_malloc(sizeof(
+	linux_desc = (struct linux_spi_desc*) no_os_calloc(1, sizeof(
 				struct linux_spi_desc));
 	if (!linux_desc)
 		goto free_desc;
 
 	descriptor->extra = linux_desc;
 
+	linux_desc->tr = no_os_calloc(LINUX_SPI_INIT_TRANSFERS,
+				      sizeof(*linux_desc->tr));
+	if (!linux_desc->tr)
+		goto free_linux_desc;
+	linux_desc->tr_size = LINUX_SPI_INIT_TRANSFERS;
+	linux_desc->bufsiz = linux_spi_bufsiz();
+
 	snprintf(path, sizeof(path), "/dev/spidev%d.%d",
 		 param->device_id, param->chip_select);
 
@@ -111,27 +381,34 @@ int32_t linux_spi_init(struct no_os_spi_desc **desc,
 		    &param->mode);
 	if (ret == -1) {
 		printf("%s: Can't set SPI mode\n\r", __func__);
-		goto free;
+		goto close_fd;
 	}
 
 	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_WR_BITS_PER_WORD,
 		    &bits);
 	if (ret == -1) {
 		printf("%s: Can't set SPI bits per word\n\r", __func__);
-		goto free;
+		goto close_fd;
 	}
 
 	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_WR_MAX_SPEED_HZ,
 		    &param->max_speed_hz);
 	if (ret == -1) {
 		printf("%s: Can't set SPI max speed hz\n\r", __func__);
-		goto free;
+		goto close_fd;
 	}
 
+	pthread_mutex_init(&linux_desc->lock, NULL);
+	pthread_cond_init(&linux_desc->cond, NULL);
+
 	*desc = descriptor;
 
 	return 0;
+close_fd:
+	close(linux_desc->spidev_fd);
 free:
+	no_os_free(linux_desc->tr);
+free_linux_desc:
 	no_os_free(linux_desc);
 free_desc:
 	no_os_free(descriptor);
@@ -141,6 +418,10 @@ free_desc:
 
 /**
  * @brief Write and read data to/from SPI.
+ *
+ * The messages queued with no_os_spi_queue() are sent first, in the same
+ * SPI_IOC_MESSAGE() call.
+ *
  * @param desc - The SPI descriptor.
  * @param data - The buffer with the transmitted/received data.
  * @param bytes_number - Number of bytes to write/read.
@@ -150,43 +431,130 @@ int32_t linux_spi_write_and_read(struct no_os_spi_desc *desc,
 				 uint8_t *data,
 				 uint16_t bytes_number)
 {
-	struct spi_ioc_transfer tr = {
-		.tx_buf = (unsigned long)data,
-		.rx_buf = (unsigned long)data,
-		.len = bytes_number,
+	struct no_os_spi_msg msg = {
+		.tx_buff = data,
+		.rx_buff = data,
+		.bytes_number = bytes_number,
+		.cs_change = 1,
 	};
 	struct linux_spi_desc *linux_desc;
-	int ret;
+	int32_t ret;
 
 	linux_desc = desc->extra;
 
-	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(1), &tr);
-	if (ret == 1) {
-		printf("%s: Can't send spi message\n\r", __func__);
-		return -1;
+	pthread_mutex_lock(&linux_desc->lock);
+	ret = linux_spi_send(linux_desc, &msg, 1);
+	pthread_mutex_unlock(&linux_desc->lock);
+
+	return ret ? -1 : 0;
+}
+
+/**
+ * @brief Queue messages, to be sent with the next ones.
+ *
+ * The queued messages are sent by no_os_spi_flush() or by the next
+ * transfer, in as few SPI_IOC_MESSAGE() calls as the spidev buffer size
+ * allows. When a message doesn't fit anymore, the messages queued before
+ * it are sent right away by this call. CS is released after the last
+ * message of each queued list. The buffers must stay valid, and the
+ * received data is only available, once no_os_spi_flush() or the next
+ * transfer returns.
+ *
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_queue(struct no_os_spi_desc *desc,
+			       struct no_os_spi_msg *msgs, uint32_t len)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret;
+
+	if (!desc || !msgs || !len)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	pthread_mutex_lock(&linux_desc->lock);
+	ret = linux_spi_add(linux_desc, msgs, len);
+	if (ret) {
+		linux_desc->nb_tr = 0;
+		linux_desc->nb_bytes = 0;
 	}
+	pthread_mutex_unlock(&linux_desc->lock);
 
-	return 0;
+	return ret;
+}
+
+/**
+ * @brief Send the messages queued with no_os_spi_queue().
+ * @param desc - The SPI descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_flush(struct no_os_spi_desc *desc)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	pthread_mutex_lock(&linux_desc->lock);
+	ret = linux_spi_submit(linux_desc);
+	pthread_mutex_unlock(&linux_desc->lock);
+
+	return ret;
 }
 
 /**
  * @brief Free the resources allocated by linux_spi_init().
+ *
+ * An asynchronous request the worker didn't start is cancelled, its callback
+ * is called and linux_spi_async_status() returns -ECANCELED from it. A
+ * request already started completes first.
+ *
  * @param desc - The SPI descriptor.
  * @return 0 in case of success, -1 otherwise.
  */
 int32_t linux_spi_remove(struct no_os_spi_desc *desc)
 {
 	struct linux_spi_desc *linux_desc;
+	void (*callback)(void *) = NULL;
+	void *ctx = NULL;
 	int32_t ret;
 
 	linux_desc = desc->extra;
 
+	if (linux_desc->worker_running) {
+		pthread_mutex_lock(&linux_desc->lock);
+		/* The worker clears async_msgs before releasing the lock */
+		if (linux_desc->async_msgs) {
+			linux_desc->async_msgs = NULL;
+			linux_desc->async_ret = -ECANCELED;
+			callback = linux_desc->async_callback;
+			ctx = linux_desc->async_ctx;
+		}
+		linux_desc->worker_stop = true;
+		pthread_cond_signal(&linux_desc->cond);
+		pthread_mutex_unlock(&linux_desc->lock);
+		pthread_join(linux_desc->worker, NULL);
+
+		if (callback)
+			callback(ctx);
+	}
+
 	ret = close(linux_desc->spidev_fd);
 	if (ret < 0) {
 		printf("%s: Can't close device\n\r", __func__);
 		return -1;
 	}
 
+	pthread_cond_destroy(&linux_desc->cond);
+	pthread_mutex_destroy(&linux_desc->lock);
+	no_os_free(linux_desc->tr);
 	no_os_free(desc->extra);
 	no_os_free(desc);
 
@@ -198,36 +566,91 @@ static int32_t linux_spi_transfer(struct no_os_spi_desc *desc,
 				  uint32_t len)
 
 {
-	struct spi_ioc_transfer *tr;
 	struct linux_spi_desc	*linux_desc;
-	int			ret;
-	uint32_t		i;
+	int32_t			ret;
 
 	linux_desc = desc->extra;
 
-	tr = (struct spi_ioc_transfer *)no_os_calloc(len, sizeof(*tr));
-	if (!tr)
-		return -ENOMEM;
+	pthread_mutex_lock(&linux_desc->lock);
+	ret = linux_spi_send(linux_desc, msgs, len);
+	pthread_mutex_unlock(&linux_desc->lock);
 
-	for (i = 0; i < len; i++) {
-		tr[i].tx_buf = (unsigned long) msgs[i].tx_buff;
-		tr[i].rx_buf = (unsigned long) msgs[i].rx_buff;
-		tr[i].len = msgs[i].bytes_number;
-		tr[i].cs_change = msgs[i].cs_change;
-		tr[i].word_delay_usecs = msgs[i].cs_change_delay;
-	}
+	return ret;
+}
 
-	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(len), tr);
+/**
+ * @brief Transfer a list of messages from a worker thread, then call the
+ * 	  callback from that thread. Only one request can be pending, its
+ * 	  result is read with linux_spi_async_status().
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages, valid until the callback is called.
+ * @param len - Number of messages in the array.
+ * @param callback - Function called after all the transfers are done.
+ * @param ctx - User specific data passed to the callback function.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t linux_spi_transfer_async(struct no_os_spi_desc *desc,
+					struct no_os_spi_msg *msgs,
+					uint32_t len,
+					void (*callback)(void *),
+					void *ctx)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret = 0;
 
-	no_os_free(tr);
+	linux_desc = desc->extra;
 
-	if (ret < 0) {
-		printf("%s: Can't send spi message (%d)\n\r", __func__, errno);
-		return ret;
+	pthread_mutex_lock(&linux_desc->lock);
+	if (linux_desc->async_msgs) {
+		ret = -EBUSY;
+		goto unlock;
 	}
 
-	return 0;
+	if (!linux_desc->worker_running) {
+		ret = -pthread_create(&linux_desc->worker, NULL,
+				      linux_spi_worker, linux_desc);
+		if (ret)
+			goto unlock;
+		linux_desc->worker_running = true;
+	}
+
+	linux_desc->async_msgs = msgs;
+	linux_desc->async_len = len;
+	linux_desc->async_callback = callback;
+	linux_desc->async_ctx = ctx;
+	pthread_cond_signal(&linux_desc->cond);
+unlock:
+	pthread_mutex_unlock(&linux_desc->lock);
+
+	return ret;
 }
+
+/**
+ * @brief Get the result of the last dma_transfer_async request.
+ *
+ * Can be called from the callback of the request.
+ *
+ * @param desc - The SPI descriptor.
+ * @return 0 if the transfers succeeded, -EINPROGRESS while the request is
+ * pending, negative error code otherwise.
+ */
+int32_t linux_spi_async_status(struct no_os_spi_desc *desc)
+{
+	struct linux_spi_desc *linux_desc;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	pthread_mutex_lock(&linux_desc->lock);
+	ret = linux_desc->async_msgs ? -EINPROGRESS : linux_desc->async_ret;
+	pthread_mutex_unlock(&linux_desc->lock);
+
+	return ret;
+}
+
 /**
  * @brief Linux platform specific SPI platform ops structure
  */
@@ -235,5 +658,9 @@ const struct no_os_spi_platform_ops linux_spi_ops = {
 	.init = &linux_spi_init,
 	.write_and_read = &linux_spi_write_and_read,
 	.remove = &linux_spi_remove,
-	.transfer = &linux_spi_transfer
+	.transfer = &linux_spi_transfer,
+	.dma_transfer_sync = &linux_spi_transfer,
+	.dma_transfer_async = &linux_spi_transfer_async,
+	.queue = &linux_spi_queue,
+	.flush = &linux_spi_flush
 };
@@ -40,9 +40,15 @@
 #ifndef LINUX_SPI_H_
 #define LINUX_SPI_H_
 
+#include <stdint.h>
+#include "no_os_spi.h"
+
 /**
  * @brief Linux specific SPI platform ops structure
  */
 extern const struct no_os_spi_platform_ops linux_spi_ops;
 
+/* Get the result of the last dma_transfer_async request */
+int32_t linux_spi_async_status(struct no_os_spi_desc *desc);
+
 #endif // LINUX_SPI_H_
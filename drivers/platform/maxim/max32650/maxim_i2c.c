@@ -245,15 +245,18 @@ static int32_t max_i2c_write(struct no_os_i2c_desc *desc,
 	max_i2c_desc = desc->extra;
 
 	if (stop_bit == 0) {
-		max_i2c_desc->prologue_size = bytes_number;
 		if (max_i2c_desc->prologue_data) {
-			ptr = realloc(max_i2c_desc->prologue_data, bytes_number);
+			ptr = no_os_realloc(max_i2c_desc->prologue_data,
+					    bytes_number);
+			if (!ptr)
+				return -ENOMEM;
 			max_i2c_desc->prologue_data = ptr;
 		} else {
 			max_i2c_desc->prologue_data = no_os_malloc(bytes_number);
 			if (!max_i2c_desc->prologue_data)
 				return -ENOMEM;
 		}
+		max_i2c_desc->prologue_size = bytes_number;
 		memcpy(max_i2c_desc->prologue_data, data, bytes_number);
 
 		return 0;
@@ -41,26 +41,30 @@
 
 #include "max32655.h"
 #include "no_os_irq.h"
-#include "no_os_list.h"
 #include "uart.h"
 
+#ifdef NO_OS_IRQ_LATENCY
 /**
- * @brief Struct used to store a (peripheral, callback) pair
+ * @brief Start the cycle counter used to measure the callback dispatch time
  */
-struct irq_action {
-	uint32_t irq_id;
-	void *handle;
-	void (*callback)(void *context);
-	void *ctx;
-};
+static inline void max_irq_ticks_enable(void)
+{
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
 
 /**
- * @brief Struct that stores all the actions for a specific event
+ * @brief Read the cycle counter
  */
-struct event_list {
-	enum no_os_irq_event event;
-	struct no_os_list_desc *actions;
-};
+static inline uint32_t max_irq_get_ticks(void)
+{
+	return DWT->CYCCNT;
+}
+
+#define MAX_IRQ_GET_TICKS	max_irq_get_ticks
+#else
+#define MAX_IRQ_GET_TICKS	NULL
+#endif
 
 /**
  * @brief maxim platform specific irq platform ops structure
@@ -73,8 +77,9 @@ extern const struct no_os_irq_platform_ops max_irq_ops;
 void max_uart_callback(mxc_uart_req_t *, int);
 
 /**
- * @brief irq_action compare function
+ * @brief Get the dispatch statistics of a registered callback
  */
-int32_t irq_action_cmp(void *data1, void *data2);
+int max_irq_stats_get(uint32_t irq_id, struct no_os_callback_desc *cb,
+		      uint32_t *count, uint32_t *max_ticks);
 
 #endif
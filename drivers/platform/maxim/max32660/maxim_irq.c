@@ -44,6 +44,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <errno.h>
 #include "rtc.h"
 #include "uart.h"
@@ -54,20 +55,55 @@
 #include "no_os_uart.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
+#include "no_os_irq_table.h"
 
 #define MAX_UART_ERROR_FLAGS (MXC_F_UART_INT_FL_FRAME | \
 			      MXC_F_UART_INT_FL_PARITY | \
 			      MXC_F_UART_INT_FL_RX_OVR)
 
-static struct event_list _events[] = {
-	[NO_OS_EVT_GPIO] = {.event = NO_OS_EVT_GPIO},
-	[NO_OS_EVT_UART_TX_COMPLETE] = {.event = NO_OS_EVT_UART_TX_COMPLETE},
-	[NO_OS_EVT_UART_RX_COMPLETE] = {.event = NO_OS_EVT_UART_RX_COMPLETE},
-	[NO_OS_EVT_UART_ERROR] = {.event = NO_OS_EVT_UART_ERROR},
-	[NO_OS_EVT_RTC] = {.event = NO_OS_EVT_RTC},
-	[NO_OS_EVT_TIM_ELAPSED] = {.event = NO_OS_EVT_TIM_ELAPSED},
-	[NO_OS_EVT_DMA_RX_COMPLETE] = {.event = NO_OS_EVT_DMA_RX_COMPLETE},
-	[NO_OS_EVT_DMA_TX_COMPLETE] = {.event = NO_OS_EVT_DMA_TX_COMPLETE},
+/* UART and DMA events are consecutive in enum no_os_irq_event */
+#define MAX_UART_EVENTS	(NO_OS_EVT_UART_ERROR - NO_OS_EVT_UART_TX_COMPLETE + 1)
+#define MAX_DMA_EVENTS	(NO_OS_EVT_DMA_TX_COMPLETE - \
+			 NO_OS_EVT_DMA_RX_COMPLETE + 1)
+
+static struct no_os_irq_slot uart_slots[MAX_UART_EVENTS * MXC_UART_INSTANCES];
+static struct no_os_irq_table uart_table = {
+	.slots = uart_slots,
+	.first_event = NO_OS_EVT_UART_TX_COMPLETE,
+	.nb_events = MAX_UART_EVENTS,
+	.nb_slots = MXC_UART_INSTANCES,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
+
+static struct no_os_irq_slot tmr_slots[MXC_CFG_TMR_INSTANCES];
+static struct no_os_irq_table tmr_table = {
+	.slots = tmr_slots,
+	.first_event = NO_OS_EVT_TIM_ELAPSED,
+	.nb_events = 1,
+	.nb_slots = MXC_CFG_TMR_INSTANCES,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
+
+static struct no_os_irq_slot dma_slots[MAX_DMA_EVENTS * MXC_DMA_CHANNELS];
+static struct no_os_irq_table dma_table = {
+	.slots = dma_slots,
+	.first_event = NO_OS_EVT_DMA_RX_COMPLETE,
+	.nb_events = MAX_DMA_EVENTS,
+	.nb_slots = MXC_DMA_CHANNELS,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
+
+static struct no_os_irq_slot rtc_slot;
+static struct no_os_irq_table rtc_table = {
+	.slots = &rtc_slot,
+	.first_event = NO_OS_EVT_RTC,
+	.nb_events = 1,
+	.nb_slots = 1,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
+
+static struct no_os_irq_table *const max_irq_tables[] = {
+	&uart_table, &tmr_table, &dma_table, &rtc_table
 };
 
 static struct no_os_irq_ctrl_desc *nvic;
@@ -79,15 +115,61 @@ extern bool is_callback;
 /******************************************************************************/
 
 /**
- * @brief Action comparator function
- * @param data1 - List element
- * @param data2 - Key
- * @return 0 if the two are equal, any other integer otherwise
+ * @brief Get the interrupt id of a DMA channel.
+ * @param ch_num - The DMA channel number.
+ * @return The interrupt vector entry id of the channel.
  */
-int32_t irq_action_cmp(void *data1, void *data2)
+static uint32_t max_irq_dma_ch_irq(uint32_t ch_num)
 {
-	return ((struct irq_action *)data1)->irq_id -
-	       ((struct irq_action *)data2)->irq_id;
+	return max_dma_get_irq(0, ch_num);
+}
+
+/**
+ * @brief Get the dispatch table and the slot of an interrupt.
+ * @param peripheral - Type of the peripheral generating the interrupt.
+ * @param irq_id - The interrupt vector entry id of the peripheral.
+ * @param slot - Set to the index of the peripheral instance in the table.
+ * @return The dispatch table, NULL if the interrupt is not handled here.
+ */
+static struct no_os_irq_table *max_irq_table_find(enum no_os_irq_peripheral
+		peripheral, uint32_t irq_id, uint32_t *slot)
+{
+	uint32_t i;
+
+	switch (peripheral) {
+	case NO_OS_UART_IRQ:
+		for (i = 0; i < MXC_UART_INSTANCES; i++) {
+			if (irq_id == MXC_UART_GET_IRQ(i)) {
+				*slot = i;
+				return &uart_table;
+			}
+		}
+		break;
+	case NO_OS_TIM_IRQ:
+		for (i = 0; i < MXC_CFG_TMR_INSTANCES; i++) {
+			if (irq_id == MXC_TMR_GET_IRQ(i)) {
+				*slot = i;
+				return &tmr_table;
+			}
+		}
+		break;
+	case NO_OS_SPI_DMA_IRQ:
+	case NO_OS_DMA_IRQ:
+		for (i = 0; i < MXC_DMA_CHANNELS; i++) {
+			if (irq_id == max_irq_dma_ch_irq(i)) {
+				*slot = i;
+				return &dma_table;
+			}
+		}
+		break;
+	case NO_OS_RTC_IRQ:
+		*slot = 0;
+		return &rtc_table;
+	default:
+		break;
+	}
+
+	return NULL;
 }
 
 /**
@@ -112,18 +194,10 @@ static bool is_gpio_irq_id(uint32_t irq_id)
  */
 static void _timer_common_callback(mxc_tmr_regs_t *tmr)
 {
-	int ret;
-	struct irq_action key = {.irq_id = MXC_TMR_GET_IRQ(MXC_TMR_GET_IDX(tmr))};
-	struct irq_action *action;
-	struct event_list *evt_list = &_events[NO_OS_EVT_TIM_ELAPSED];
-
-	ret = no_os_list_read_find(evt_list->actions, (void **)&action, &key);
-	if (ret)
+	if (!no_os_irq_table_dispatch(&tmr_table, NO_OS_EVT_TIM_ELAPSED,
+				      MXC_TMR_GET_IDX(tmr)))
 		return;
 
-	if (action->callback)
-		action->callback(action->ctx);
-
 	MXC_TMR_ClearFlags(tmr);
 }
 
@@ -198,26 +272,11 @@ void TMR2_IRQHandler()
  */
 static void max_dma_handler(uint32_t ch_num)
 {
-	struct event_list *rx_evt_list = &_events[NO_OS_EVT_DMA_RX_COMPLETE];
-	struct event_list *tx_evt_list = &_events[NO_OS_EVT_DMA_TX_COMPLETE];
-	struct irq_action *rx_action, *tx_action;
-	struct irq_action key = {.irq_id = max_dma_get_irq(0, ch_num)};
-	int ret;
-
 	/* Clear the DMA interrupt flag */
 	MAX_DMA->ch[ch_num].st |= NO_OS_BIT(2);
 
-	if (rx_evt_list->actions) {
-		ret = no_os_list_read_find(rx_evt_list->actions, (void **)&rx_action, &key);
-		if (!ret && rx_action->callback)
-			rx_action->callback(rx_action->ctx);
-	}
-
-	if (tx_evt_list->actions) {
-		ret = no_os_list_read_find(tx_evt_list->actions, (void **)&tx_action, &key);
-		if (!ret && tx_action->callback)
-			tx_action->callback(tx_action->ctx);
-	}
+	no_os_irq_table_dispatch(&dma_table, NO_OS_EVT_DMA_RX_COMPLETE, ch_num);
+	no_os_irq_table_dispatch(&dma_table, NO_OS_EVT_DMA_TX_COMPLETE, ch_num);
 }
 
 void DMA0_IRQHandler()
@@ -302,19 +361,11 @@ void DMA15_IRQHandler()
 
 void RTC_IRQHandler()
 {
-	int ret;
 	uint32_t flags = MXC_RTC_GetFlags();
-	struct event_list *evt_list = &_events[NO_OS_EVT_RTC];
-	struct irq_action *action;
 
 	if (flags & MXC_RTC_INT_FL_LONG) {
 		MXC_RTC_ClearFlags(MXC_RTC_INT_FL_LONG);
-		ret = no_os_list_read_first(evt_list->actions, (void **)&action);
-		if (ret < 0)
-			return;
-
-		if (action->callback)
-			action->callback(action->ctx);
+		no_os_irq_table_dispatch(&rtc_table, NO_OS_EVT_RTC, 0);
 	}
 }
 
@@ -326,34 +377,31 @@ void RTC_IRQHandler()
  */
 void max_uart_callback(mxc_uart_req_t *req, int result)
 {
-	struct event_list *ee;
-	struct irq_action *a;
+	struct no_os_irq_slot *slot;
 	uint32_t uart_id = MXC_UART_GET_IDX(req->uart);
-	struct irq_action key = {.irq_id = MXC_UART_GET_IRQ(uart_id)};
-	int ret;
+	uint32_t event;
 
 	if (result) {
-		ee = &_events[NO_OS_EVT_UART_ERROR];
+		event = NO_OS_EVT_UART_ERROR;
 		MXC_UART_ClearFlags(MXC_UART_GET_UART(uart_id),
 				    MAX_UART_ERROR_FLAGS);
 	} else if (req->txLen == req->txCnt && req->txLen != 0) {
-		ee = &_events[NO_OS_EVT_UART_TX_COMPLETE];
+		event = NO_OS_EVT_UART_TX_COMPLETE;
 	} else if (req->rxLen == req->rxCnt && req->rxLen != 0) {
-		ee = &_events[NO_OS_EVT_UART_RX_COMPLETE];
+		event = NO_OS_EVT_UART_RX_COMPLETE;
 	} else {
 		return;
 	}
 
-	ret = no_os_list_read_find(ee->actions, (void **)&a, &key);
-	if (ret)
+	slot = no_os_irq_table_get(&uart_table, event, uart_id);
+	if (!slot || !atomic_load_explicit(&slot->callback,
+					   memory_order_acquire))
 		return;
 
 	uart_irq_state[uart_id].uart = NULL;
-	if (a->callback) {
-		is_callback = true;
-		a->callback(a->ctx);
-		is_callback = false;
-	}
+	is_callback = true;
+	no_os_irq_slot_dispatch(&uart_table, slot);
+	is_callback = false;
 }
 
 /**
@@ -382,6 +430,10 @@ int32_t max_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
 	descriptor->irq_ctrl_id = param->irq_ctrl_id;
 	descriptor->extra = param->extra;
 
+#ifdef NO_OS_IRQ_LATENCY
+	max_irq_ticks_enable();
+#endif
+
 	*desc = descriptor;
 	nvic = descriptor;
 
@@ -395,16 +447,14 @@ int32_t max_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
  */
 int32_t max_irq_ctrl_remove(struct no_os_irq_ctrl_desc *desc)
 {
-	void *discard;
+	uint32_t i;
+
 	if (!desc)
 		return -EINVAL;
 
-	for (uint32_t i = 0; i < NO_OS_ARRAY_SIZE(_events); i++) {
-		while (0 == no_os_list_get_first(_events[i].actions, &discard))
-			no_os_free(discard);
-		no_os_list_remove(_events[i].actions);
-		_events[i].actions = NULL;
-	}
+	for (i = 0; i < NO_OS_ARRAY_SIZE(max_irq_tables); i++)
+		no_os_irq_table_clear(max_irq_tables[i]);
+
 	no_os_free(desc);
 	nvic = NULL;
 
@@ -424,87 +474,38 @@ int32_t max_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 				  struct no_os_callback_desc *callback_desc)
 {
 	int ret;
-	void *discard;
-	bool new_action = false;
-	struct irq_action *action;
-	struct irq_action action_key = {.irq_id = irq_id};
+	uint32_t slot;
+	struct no_os_irq_table *table;
 
 	if(is_gpio_irq_id(irq_id))
 		return -ENOSYS;
 
-	if (!desc || !callback_desc
-	    || callback_desc->event >= NO_OS_ARRAY_SIZE(_events))
+	if (!desc || !callback_desc)
 		return -EINVAL;
 
-	if (_events[callback_desc->event].actions == NULL) {
-		ret = no_os_list_init(&_events[callback_desc->event].actions,
-				      NO_OS_LIST_PRIORITY_LIST,
-				      irq_action_cmp);
-		if (ret)
-			return ret;
-	}
+	table = max_irq_table_find(callback_desc->peripheral, irq_id, &slot);
+	if (!table)
+		return -EINVAL;
 
-	ret = no_os_list_read_find(_events[callback_desc->event].actions,
-				   (void **)&action,
-				   &action_key);
-	/*
-	 * If an action with the same irq_id as the function parameter does not exists, insert a new one,
-	 * otherwise update
-	 */
-	if (ret) {
-		action = no_os_calloc(1, sizeof(*action));
-		if (!action)
-			return -ENOMEM;
-
-		action->irq_id = irq_id;
-		action->handle = callback_desc->handle;
-		action->callback = callback_desc->callback;
-		action->ctx = callback_desc->ctx;
-
-		ret = no_os_list_add_last(_events[callback_desc->event].actions, action);
-		if (ret)
-			goto free_action;
-
-		new_action = true;
-	}
+	ret = no_os_irq_table_register(table, slot, irq_id, callback_desc);
+	if (ret)
+		return ret;
 
 	switch (callback_desc->peripheral) {
-	case NO_OS_SPI_DMA_IRQ:
-	case NO_OS_DMA_IRQ:
-	case NO_OS_UART_IRQ:
-	case NO_OS_TIM_IRQ:
-		break;
-
 	case NO_OS_RTC_IRQ:
 		ret = MXC_RTC_EnableInt(MXC_RTC_INT_EN_LONG);
-		if (ret)
+		if (ret) {
+			no_os_irq_table_unregister(table, callback_desc->event,
+						   slot);
 			return -EBUSY;
+		}
 
 		break;
-
 	default:
-		if (new_action) {
-			ret = -EINVAL;
-			goto remove_new_action;
-		}
-
-		return -EINVAL;
-	}
-
-	if (!new_action) {
-		action->irq_id = irq_id;
-		action->handle = callback_desc->handle;
-		action->callback = callback_desc->callback;
-		action->ctx = callback_desc->ctx;
+		break;
 	}
 
 	return 0;
-
-remove_new_action:
-	no_os_list_get_last(_events[callback_desc->event].actions, &discard);
-free_action:
-	no_os_free(action);
-	return ret;
 }
 
 /**
@@ -517,9 +518,8 @@ free_action:
 int32_t max_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 				    uint32_t irq_id, struct no_os_callback_desc *cb)
 {
-	int ret;
-	void *discard_action = NULL;
-	struct irq_action action_key= {.irq_id = irq_id};
+	uint32_t slot;
+	struct no_os_irq_table *table;
 
 	if(is_gpio_irq_id(irq_id))
 		return -ENOSYS;
@@ -527,26 +527,44 @@ int32_t max_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 	if (!desc || !cb)
 		return -EINVAL;
 
+	table = max_irq_table_find(cb->peripheral, irq_id, &slot);
+	if (!table)
+		return -ENODEV;
+
 	switch (cb->peripheral) {
-	case NO_OS_UART_IRQ:
-		action_key.handle = cb->handle;
-		break;
 	case NO_OS_RTC_IRQ:
-		action_key.handle = MXC_RTC;
 		MXC_RTC_DisableInt(MXC_RTC_INT_EN_LONG);
 		break;
 	default:
 		break;
 	}
 
-	ret = no_os_list_get_find(_events[cb->event].actions, &discard_action,
-				  &action_key);
-	if (ret)
-		return -ENODEV;
+	return no_os_irq_table_unregister(table, cb->event, slot);
+}
+
+/**
+ * @brief Get the dispatch statistics of a registered callback.
+ * @param irq_id - The interrupt vector entry id of the peripheral.
+ * @param cb - Callback descriptor, the event and peripheral are used.
+ * @param count - Number of dispatched interrupts.
+ * @param max_ticks - Worst case dispatch time in CPU cycles, only measured
+ * when built with NO_OS_IRQ_LATENCY.
+ * @return 0 in case of success, errno error codes otherwise.
+ */
+int max_irq_stats_get(uint32_t irq_id, struct no_os_callback_desc *cb,
+		      uint32_t *count, uint32_t *max_ticks)
+{
+	uint32_t slot;
+	struct no_os_irq_table *table;
 
-	no_os_free(discard_action);
+	if (!cb)
+		return -EINVAL;
+
+	table = max_irq_table_find(cb->peripheral, irq_id, &slot);
+	if (!table)
+		return -ENODEV;
 
-	return ret;
+	return no_os_irq_table_stats(table, cb->event, slot, count, max_ticks);
 }
 
 /**
@@ -48,7 +48,7 @@
 #include "no_os_error.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
-#include "no_os_list.h"
+#include "no_os_irq_table.h"
 #include "no_os_irq.h"
 #include "no_os_gpio.h"
 
@@ -59,32 +59,31 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
-static struct no_os_list_desc *actions[MXC_CFG_GPIO_INSTANCES];
+#define MAX_GPIO_IRQ_PINS (MXC_CFG_GPIO_INSTANCES * MXC_CFG_GPIO_PINS_PORT)
+#define MAX_GPIO_IRQ_SLOT(port, pin) ((port) * MXC_CFG_GPIO_PINS_PORT + (pin))
+
+/* One slot for each pin, the pins of a port are consecutive */
+static struct no_os_irq_slot gpio_slots[MAX_GPIO_IRQ_PINS];
+static struct no_os_irq_table gpio_table = {
+	.slots = gpio_slots,
+	.first_event = NO_OS_EVT_GPIO,
+	.nb_events = 1,
+	.nb_slots = MAX_GPIO_IRQ_PINS,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 /**
- * @brief GPIO callback function that sets the event and further calls
- * the user registered callback
- * @param cbdata - Used to pass an action reference
+ * @brief GPIO callback function that further calls the user registered
+ * callback
+ * @param cbdata - The dispatch table slot of the pin
  */
 static void gpio_irq_callback(void *cbdata)
 {
-	int ret;
-	struct irq_action *action;
-	struct irq_action *key = cbdata;
-
-	/* key->handle is the address of the GPIO port */
-	uint32_t id = MXC_GPIO_GET_IDX(key->handle);
-
-	ret = no_os_list_read_find(actions[id], (void **)&action, key);
-	if (ret)
-		return;
-
-	if (action->callback)
-		action->callback(action->ctx);
+	no_os_irq_slot_dispatch(&gpio_table, cbdata);
 }
 
 void GPIO0_IRQHandler()
@@ -115,10 +114,9 @@ void GPIO2_IRQHandler()
 static int max_gpio_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
 				  const struct no_os_irq_init_param *param)
 {
-	int ret;
 	struct no_os_irq_ctrl_desc *descriptor;
 
-	if (!param)
+	if (!param || param->irq_ctrl_id >= MXC_CFG_GPIO_INSTANCES)
 		return -EINVAL;
 
 	descriptor = no_os_calloc(1, sizeof(*descriptor));
@@ -128,21 +126,13 @@ static int max_gpio_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
 	descriptor->irq_ctrl_id = param->irq_ctrl_id;
 	descriptor->extra = param->extra;
 
-	if (!actions[param->irq_ctrl_id]) {
-		ret = no_os_list_init(&actions[param->irq_ctrl_id],
-				      NO_OS_LIST_PRIORITY_LIST, irq_action_cmp);
-		if (ret)
-			goto error;
-	}
+#ifdef NO_OS_IRQ_LATENCY
+	max_irq_ticks_enable();
+#endif
 
 	*desc = descriptor;
 
 	return 0;
-
-error:
-	no_os_free(descriptor);
-
-	return ret;
 }
 
 /**
@@ -152,15 +142,16 @@ error:
  */
 static int max_gpio_irq_ctrl_remove(struct no_os_irq_ctrl_desc *desc)
 {
-	struct no_os_callback_desc *discard;
+	uint32_t i, slot;
 
 	if (!desc)
 		return -EINVAL;
 
-	while (0 == no_os_list_get_first(actions[desc->irq_ctrl_id], (void **)&discard))
-		no_os_free(discard);
+	slot = MAX_GPIO_IRQ_SLOT(desc->irq_ctrl_id, 0);
+	for (i = 0; i < MXC_CFG_GPIO_PINS_PORT; i++)
+		no_os_irq_table_unregister(&gpio_table, NO_OS_EVT_GPIO,
+					   slot + i);
 
-	no_os_list_remove(actions[desc->irq_ctrl_id]);
 	no_os_free(desc);
 
 	return 0;
@@ -179,49 +170,31 @@ static int max_gpio_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 		struct no_os_callback_desc *callback_desc)
 {
 	int ret;
-	struct irq_action *action;
-	struct irq_action action_key = {.irq_id = irq_id};
+	uint32_t slot;
 	mxc_gpio_cfg_t cfg;
+	struct no_os_callback_desc cb;
 
-	if (!desc || !callback_desc)
+	if (!desc || !callback_desc || irq_id >= MXC_CFG_GPIO_PINS_PORT)
 		return -EINVAL;
 
-	ret = no_os_list_read_find(actions[desc->irq_ctrl_id], (void **)&action,
-				   &action_key);
-	/*
-	* If no action was found, insert a new one, otherwise update it
-	*/
-	if (ret) {
-		action = no_os_calloc(1, sizeof(*action));
-		if (!action)
-			return -ENOMEM;
-
-		action->irq_id = irq_id;
-		action->handle = MXC_GPIO_GET_GPIO(desc->irq_ctrl_id);
-		action->ctx = callback_desc->ctx;
-		action->callback = callback_desc->callback;
-
-		ret = no_os_list_add_last(actions[desc->irq_ctrl_id], action);
-		if (ret)
-			goto free_action;
-	} else {
-		action->irq_id = irq_id;
-		action->handle = MXC_GPIO_GET_GPIO(desc->irq_ctrl_id);
-		action->ctx = callback_desc->ctx;
-		action->callback = callback_desc->callback;
-	}
+	/* The pin is the slot, the port address is the handle */
+	cb = *callback_desc;
+	cb.event = NO_OS_EVT_GPIO;
+	cb.handle = MXC_GPIO_GET_GPIO(desc->irq_ctrl_id);
+	slot = MAX_GPIO_IRQ_SLOT(desc->irq_ctrl_id, irq_id);
+
+	ret = no_os_irq_table_register(&gpio_table, slot, irq_id, &cb);
+	if (ret)
+		return ret;
 
 	cfg = (mxc_gpio_cfg_t) {
 		.mask = NO_OS_BIT(irq_id),
 		.port = MXC_GPIO_GET_GPIO(desc->irq_ctrl_id)
 	};
-	MXC_GPIO_RegisterCallback(&cfg, gpio_irq_callback, action);
+	MXC_GPIO_RegisterCallback(&cfg, gpio_irq_callback,
+				  &gpio_slots[slot]);
 
 	return 0;
-
-free_action:
-	no_os_free(action);
-	return ret;
 }
 
 /**
@@ -236,15 +209,14 @@ static int max_gpio_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 		struct no_os_callback_desc *callback_desc)
 {
 	int ret;
-	struct irq_action *discard_action = NULL;
-	struct irq_action action_key = {.irq_id = irq_id};
+	uint32_t slot;
 	mxc_gpio_cfg_t cfg;
 
 	if (!desc || !callback_desc || irq_id >= MXC_CFG_GPIO_PINS_PORT)
 		return -EINVAL;
 
-	ret = no_os_list_read_find(actions[desc->irq_ctrl_id], (void **)&discard_action,
-				   &action_key);
+	slot = MAX_GPIO_IRQ_SLOT(desc->irq_ctrl_id, irq_id);
+	ret = no_os_irq_table_unregister(&gpio_table, NO_OS_EVT_GPIO, slot);
 	if (ret)
 		return -ENODEV;
 
@@ -253,7 +225,6 @@ static int max_gpio_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 		.mask = NO_OS_BIT(irq_id)
 	};
 	MXC_GPIO_RegisterCallback(&cfg, NULL, NULL);
-	no_os_free(discard_action);
 
 	return 0;
 }
@@ -368,6 +339,29 @@ static int max_gpio_irq_set_priority(struct no_os_irq_ctrl_desc *desc,
 	return 0;
 }
 
+/**
+ * @brief Get the dispatch statistics of a pin interrupt.
+ * @param desc - the GPIO irq descriptor.
+ * @param irq_id - the pin on which the interrupt signal will be.
+ * @param count - Number of dispatched interrupts.
+ * @param max_ticks - Worst case dispatch time in CPU cycles, only measured
+ * when built with NO_OS_IRQ_LATENCY.
+ * @return 0 in case of success, errno error codes otherwise.
+ */
+int max_gpio_irq_stats_get(struct no_os_irq_ctrl_desc *desc, uint32_t irq_id,
+			   uint32_t *count, uint32_t *max_ticks)
+{
+	uint32_t slot;
+
+	if (!desc || irq_id >= MXC_CFG_GPIO_PINS_PORT)
+		return -EINVAL;
+
+	slot = MAX_GPIO_IRQ_SLOT(desc->irq_ctrl_id, irq_id);
+
+	return no_os_irq_table_stats(&gpio_table, NO_OS_EVT_GPIO, slot, count,
+				     max_ticks);
+}
+
 /**
  * @brief maxim specific GPIO IRQ platform ops structure
  */
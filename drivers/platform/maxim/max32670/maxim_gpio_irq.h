@@ -62,4 +62,10 @@ struct max_gpio_irq_param {
  */
 extern const struct no_os_irq_platform_ops max_gpio_irq_ops;
 
+/**
+ * @brief Get the dispatch statistics of a pin interrupt
+ */
+int max_gpio_irq_stats_get(struct no_os_irq_ctrl_desc *desc, uint32_t irq_id,
+			   uint32_t *count, uint32_t *max_ticks);
+
 #endif
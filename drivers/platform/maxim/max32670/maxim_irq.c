@@ -44,6 +44,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <errno.h>
 #include "rtc.h"
 #include "uart.h"
@@ -53,14 +54,40 @@
 #include "no_os_uart.h"
 #include "no_os_util.h"
 #include "no_os_alloc.h"
+#include "no_os_irq_table.h"
+
+/* UART and DMA events are consecutive in enum no_os_irq_event */
+#define MAX_UART_EVENTS	(NO_OS_EVT_UART_ERROR - NO_OS_EVT_UART_TX_COMPLETE + 1)
+
+static struct no_os_irq_slot uart_slots[MAX_UART_EVENTS * MXC_UART_INSTANCES];
+static struct no_os_irq_table uart_table = {
+	.slots = uart_slots,
+	.first_event = NO_OS_EVT_UART_TX_COMPLETE,
+	.nb_events = MAX_UART_EVENTS,
+	.nb_slots = MXC_UART_INSTANCES,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
+
+static struct no_os_irq_slot tmr_slots[MXC_CFG_TMR_INSTANCES];
+static struct no_os_irq_table tmr_table = {
+	.slots = tmr_slots,
+	.first_event = NO_OS_EVT_TIM_ELAPSED,
+	.nb_events = 1,
+	.nb_slots = MXC_CFG_TMR_INSTANCES,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
+
+static struct no_os_irq_slot rtc_slot;
+static struct no_os_irq_table rtc_table = {
+	.slots = &rtc_slot,
+	.first_event = NO_OS_EVT_RTC,
+	.nb_events = 1,
+	.nb_slots = 1,
+	.get_ticks = MAX_IRQ_GET_TICKS,
+};
 
-static struct event_list _events[] = {
-	[NO_OS_EVT_GPIO] = {.event = NO_OS_EVT_GPIO},
-	[NO_OS_EVT_UART_TX_COMPLETE] = {.event = NO_OS_EVT_UART_TX_COMPLETE},
-	[NO_OS_EVT_UART_RX_COMPLETE] = {.event = NO_OS_EVT_UART_RX_COMPLETE},
-	[NO_OS_EVT_UART_ERROR] = {.event = NO_OS_EVT_UART_ERROR},
-	[NO_OS_EVT_RTC] = {.event = NO_OS_EVT_RTC},
-	[NO_OS_EVT_TIM_ELAPSED] = {.event = NO_OS_EVT_TIM_ELAPSED},
+static struct no_os_irq_table *const max_irq_tables[] = {
+	&uart_table, &tmr_table, &rtc_table
 };
 
 static struct no_os_irq_ctrl_desc *nvic;
@@ -72,15 +99,42 @@ extern bool is_callback;
 /******************************************************************************/
 
 /**
- * @brief Action comparator function
- * @param data1 - List element
- * @param data2 - Key
- * @return 0 if the two are equal, any other integer otherwise
+ * @brief Get the dispatch table and the slot of an interrupt.
+ * @param peripheral - Type of the peripheral generating the interrupt.
+ * @param irq_id - The interrupt vector entry id of the peripheral.
+ * @param slot - Set to the index of the peripheral instance in the table.
+ * @return The dispatch table, NULL if the interrupt is not handled here.
  */
-int irq_action_cmp(void *data1, void *data2)
+static struct no_os_irq_table *max_irq_table_find(enum no_os_irq_peripheral
+		peripheral, uint32_t irq_id, uint32_t *slot)
 {
-	return ((struct irq_action *)data1)->irq_id -
-	       ((struct irq_action *)data2)->irq_id;
+	uint32_t i;
+
+	switch (peripheral) {
+	case NO_OS_UART_IRQ:
+		for (i = 0; i < MXC_UART_INSTANCES; i++) {
+			if (irq_id == MXC_UART_GET_IRQ(i)) {
+				*slot = i;
+				return &uart_table;
+			}
+		}
+		break;
+	case NO_OS_TIM_IRQ:
+		for (i = 0; i < MXC_CFG_TMR_INSTANCES; i++) {
+			if (irq_id == MXC_TMR_GET_IRQ(i)) {
+				*slot = i;
+				return &tmr_table;
+			}
+		}
+		break;
+	case NO_OS_RTC_IRQ:
+		*slot = 0;
+		return &rtc_table;
+	default:
+		break;
+	}
+
+	return NULL;
 }
 
 /**
@@ -107,18 +161,10 @@ static bool is_gpio_irq_id(uint32_t irq_id)
  */
 static void _timer_common_callback(mxc_tmr_regs_t *tmr)
 {
-	int ret;
-	struct irq_action key = {.irq_id = MXC_TMR_GET_IRQ(MXC_TMR_GET_IDX(tmr))};
-	struct irq_action *action;
-	struct event_list *evt_list = &_events[NO_OS_EVT_TIM_ELAPSED];
-
-	ret = no_os_list_read_find(evt_list->actions, (void **)&action, &key);
-	if (ret)
+	if (!no_os_irq_table_dispatch(&tmr_table, NO_OS_EVT_TIM_ELAPSED,
+				      MXC_TMR_GET_IDX(tmr)))
 		return;
 
-	if (action->callback)
-		action->callback(action->ctx);
-
 	MXC_TMR_ClearFlags(tmr);
 }
 
@@ -189,19 +235,11 @@ void TMR2_IRQHandler()
 
 void RTC_IRQHandler()
 {
-	int ret;
 	uint32_t flags = MXC_RTC_GetFlags();
-	struct event_list *evt_list = &_events[NO_OS_EVT_RTC];
-	struct irq_action *action;
 
 	if (flags & MXC_RTC_INT_FL_LONG) {
 		MXC_RTC_ClearFlags(MXC_RTC_INT_FL_LONG);
-		ret = no_os_list_read_first(evt_list->actions, (void **)&action);
-		if (ret < 0)
-			return;
-
-		if (action->callback)
-			action->callback(action->ctx);
+		no_os_irq_table_dispatch(&rtc_table, NO_OS_EVT_RTC, 0);
 	}
 }
 
@@ -213,31 +251,28 @@ void RTC_IRQHandler()
  */
 void max_uart_callback(mxc_uart_req_t *req, int result)
 {
-	struct event_list *ee;
-	struct irq_action *a;
+	struct no_os_irq_slot *slot;
 	uint32_t uart_id = MXC_UART_GET_IDX(req->uart);
-	struct irq_action key = {.irq_id = MXC_UART_GET_IRQ(uart_id)};
-	int ret;
+	uint32_t event;
 
 	if (result)
-		ee = &_events[NO_OS_EVT_UART_ERROR];
+		event = NO_OS_EVT_UART_ERROR;
 	else if (req->txLen == req->txCnt && req->txLen != 0)
-		ee = &_events[NO_OS_EVT_UART_TX_COMPLETE];
+		event = NO_OS_EVT_UART_TX_COMPLETE;
 	else if (req->rxLen == req->rxCnt && req->rxLen != 0)
-		ee = &_events[NO_OS_EVT_UART_RX_COMPLETE];
+		event = NO_OS_EVT_UART_RX_COMPLETE;
 	else
 		return;
 
-	ret = no_os_list_read_find(ee->actions, (void **)&a, &key);
-	if (ret)
+	slot = no_os_irq_table_get(&uart_table, event, uart_id);
+	if (!slot || !atomic_load_explicit(&slot->callback,
+					   memory_order_acquire))
 		return;
 
 	uart_irq_state[uart_id].uart = NULL;
-	if (a->callback) {
-		is_callback = true;
-		a->callback(a->ctx);
-		is_callback = false;
-	}
+	is_callback = true;
+	no_os_irq_slot_dispatch(&uart_table, slot);
+	is_callback = false;
 }
 
 /**
@@ -266,6 +301,10 @@ int max_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
 	descriptor->irq_ctrl_id = param->irq_ctrl_id;
 	descriptor->extra = param->extra;
 
+#ifdef NO_OS_IRQ_LATENCY
+	max_irq_ticks_enable();
+#endif
+
 	*desc = descriptor;
 	nvic = descriptor;
 
@@ -280,16 +319,13 @@ int max_irq_ctrl_init(struct no_os_irq_ctrl_desc **desc,
 int max_irq_ctrl_remove(struct no_os_irq_ctrl_desc *desc)
 {
 	uint32_t i;
-	void *discard;
+
 	if (!desc)
 		return -EINVAL;
 
-	for (i = 0; i < NO_OS_ARRAY_SIZE(_events); i++) {
-		while (0 == no_os_list_get_first(_events[i].actions, &discard))
-			no_os_free(discard);
-		no_os_list_remove(_events[i].actions);
-		_events[i].actions = NULL;
-	}
+	for (i = 0; i < NO_OS_ARRAY_SIZE(max_irq_tables); i++)
+		no_os_irq_table_clear(max_irq_tables[i]);
+
 	no_os_free(desc);
 	nvic = NULL;
 
@@ -309,8 +345,8 @@ int max_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 			      struct no_os_callback_desc *callback_desc)
 {
 	int ret;
-	struct irq_action *action;
-	struct irq_action action_key = {.irq_id = irq_id};
+	uint32_t slot;
+	struct no_os_irq_table *table;
 
 	if(is_gpio_irq_id(irq_id))
 		return -ENOSYS;
@@ -318,127 +354,29 @@ int max_irq_register_callback(struct no_os_irq_ctrl_desc *desc,
 	if (!desc || !callback_desc)
 		return -EINVAL;
 
-	switch (callback_desc->peripheral) {
-	case NO_OS_UART_IRQ:
-		if (_events[callback_desc->event].actions == NULL) {
-			ret = no_os_list_init(&_events[callback_desc->event].actions,
-					      NO_OS_LIST_PRIORITY_LIST,
-					      irq_action_cmp);
-			if (ret)
-				return ret;
-		}
-
-		ret = no_os_list_read_find(_events[callback_desc->event].actions,
-					   (void **)&action,
-					   &action_key);
-		/*
-		 * If an action with the same irq_id as the function parameter does not exists, insert a new one,
-		 * otherwise update
-		 */
-		if (ret) {
-			action = no_os_calloc(1, sizeof(*action));
-			if (!action)
-				return -ENOMEM;
-
-			action->irq_id = irq_id;
-			action->handle = callback_desc->handle;
-			action->callback = callback_desc->callback;
-			action->ctx = callback_desc->ctx;
-
-			ret = no_os_list_add_last(_events[callback_desc->event].actions, action);
-			if (ret)
-				goto free_action;
-		} else {
-			action->irq_id = irq_id;
-			action->handle = callback_desc->handle;
-			action->callback = callback_desc->callback;
-			action->ctx = callback_desc->ctx;
-		}
-		break;
-	case NO_OS_RTC_IRQ:
-		if (_events[NO_OS_EVT_RTC].actions == NULL) {
-			ret = no_os_list_init(&_events[NO_OS_EVT_RTC].actions, NO_OS_LIST_PRIORITY_LIST,
-					      irq_action_cmp);
-			if (ret)
-				return ret;
-		}
+	table = max_irq_table_find(callback_desc->peripheral, irq_id, &slot);
+	if (!table)
+		return -EINVAL;
 
-		/*
-		 * This is a special case for RTC on Maxim platform. Since there is only 1 RTC peripheral, there should
-		 * be only 1 registered callback at a time.
-		 */
-		ret = no_os_list_read_first(_events[NO_OS_EVT_RTC].actions, (void **)&action);
-		if (ret) {
-			action = no_os_calloc(1, sizeof(*action));
-			if (!action)
-				return -ENOMEM;
-
-			action->irq_id = irq_id;
-			action->handle = callback_desc->handle;
-			action->callback = callback_desc->callback;
-			action->ctx = callback_desc->ctx;
-
-			ret = no_os_list_add_first(_events[NO_OS_EVT_RTC].actions, action);
-			if (ret)
-				goto free_action;
-
-		} else {
-			action->irq_id = irq_id;
-			action->handle = callback_desc->handle;
-			action->callback = callback_desc->callback;
-			action->ctx = callback_desc->ctx;
-		}
+	ret = no_os_irq_table_register(table, slot, irq_id, callback_desc);
+	if (ret)
+		return ret;
 
+	switch (callback_desc->peripheral) {
+	case NO_OS_RTC_IRQ:
 		ret = MXC_RTC_EnableInt(MXC_RTC_INT_EN_LONG);
-		if (ret)
+		if (ret) {
+			no_os_irq_table_unregister(table, callback_desc->event,
+						   slot);
 			return -EBUSY;
-		break;
-	case NO_OS_TIM_IRQ:
-		if (_events[NO_OS_EVT_TIM_ELAPSED].actions == NULL) {
-			ret = no_os_list_init(&_events[NO_OS_EVT_TIM_ELAPSED].actions,
-					      NO_OS_LIST_PRIORITY_LIST,
-					      irq_action_cmp);
-			if (ret)
-				return ret;
 		}
 
-		ret = no_os_list_read_find(_events[callback_desc->event].actions,
-					   (void **)&action,
-					   &action_key);
-		/*
-		 * If an action with the same irq_id as the function parameter does not exists, insert a new one,
-		 * otherwise update
-		 */
-		if (ret) {
-			action = no_os_calloc(1, sizeof(*action));
-			if (!action)
-				return -ENOMEM;
-
-			action->irq_id = irq_id;
-			action->handle = callback_desc->handle;
-			action->callback = callback_desc->callback;
-			action->ctx = callback_desc->ctx;
-
-			ret = no_os_list_add_last(_events[callback_desc->event].actions, action);
-			if (ret)
-				goto free_action;
-
-		} else {
-			action->irq_id = irq_id;
-			action->handle = callback_desc->handle;
-			action->callback = callback_desc->callback;
-			action->ctx = callback_desc->ctx;
-		}
 		break;
 	default:
-		return -EINVAL;
+		break;
 	}
 
 	return 0;
-
-free_action:
-	no_os_free(action);
-	return ret;
 }
 
 /**
@@ -451,9 +389,8 @@ free_action:
 int max_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 				uint32_t irq_id, struct no_os_callback_desc *cb)
 {
-	int ret;
-	void *discard_action = NULL;
-	struct irq_action action_key= {.irq_id = irq_id};
+	uint32_t slot;
+	struct no_os_irq_table *table;
 
 	if(is_gpio_irq_id(irq_id))
 		return -ENOSYS;
@@ -461,26 +398,44 @@ int max_irq_unregister_callback(struct no_os_irq_ctrl_desc *desc,
 	if (!desc || !cb)
 		return -EINVAL;
 
+	table = max_irq_table_find(cb->peripheral, irq_id, &slot);
+	if (!table)
+		return -ENODEV;
+
 	switch (cb->peripheral) {
-	case NO_OS_UART_IRQ:
-		action_key.handle = cb->handle;
-		break;
 	case NO_OS_RTC_IRQ:
-		action_key.handle = MXC_RTC;
 		MXC_RTC_DisableInt(MXC_RTC_INT_EN_LONG);
 		break;
 	default:
 		break;
 	}
 
-	ret = no_os_list_get_find(_events[cb->event].actions, &discard_action,
-				  &action_key);
-	if (ret)
-		return -ENODEV;
+	return no_os_irq_table_unregister(table, cb->event, slot);
+}
 
-	no_os_free(discard_action);
+/**
+ * @brief Get the dispatch statistics of a registered callback.
+ * @param irq_id - The interrupt vector entry id of the peripheral.
+ * @param cb - Callback descriptor, the event and peripheral are used.
+ * @param count - Number of dispatched interrupts.
+ * @param max_ticks - Worst case dispatch time in CPU cycles, only measured
+ * when built with NO_OS_IRQ_LATENCY.
+ * @return 0 in case of success, errno error codes otherwise.
+ */
+int max_irq_stats_get(uint32_t irq_id, struct no_os_callback_desc *cb,
+		      uint32_t *count, uint32_t *max_ticks)
+{
+	uint32_t slot;
+	struct no_os_irq_table *table;
+
+	if (!cb)
+		return -EINVAL;
+
+	table = max_irq_table_find(cb->peripheral, irq_id, &slot);
+	if (!table)
+		return -ENODEV;
 
-	return ret;
+	return no_os_irq_table_stats(table, cb->event, slot, count, max_ticks);
 }
 
 /**
@@ -49,12 +49,9 @@
 #include "no_os_pwm.h"
 #include "no_os_i2c.h"
 #include "no_os_gpio.h"
-#include "no_os_crc8.h"
 
 #include "lt7182s.h"
 
-NO_OS_DECLARE_CRC8_TABLE(lt7182s_crc_table);
-
 static const struct lt7182s_chip_info lt7182s_info[] = {
 	[ID_LT7182S] = {
 		.name = "LT7182S",
@@ -134,223 +131,6 @@ static bool lt7182s_cmd_is_paged(uint8_t cmd)
 	}
 }
 
-/**
- * @brief Converts value to LINEAR16 register data
- *
- * @param dev - Device structure
- * @param data - Value to convert
- * @param reg - Address of converted register data
- * @param scale - Value scaling factor
- * @return 0 in case of success, negative error code otherwise
- */
-static int lt7182s_data2reg_linear16(struct lt7182s_dev *dev, int data,
-				     uint16_t *reg, int scale)
-{
-	if (data <= 0)
-		return -EINVAL;
-	data <<= -(dev->lin16_exp);
-
-	data = NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale);
-	*reg = (uint16_t)no_os_clamp(data, 0, 0xFFFF);
-
-	return 0;
-}
-
-/**
- * @brief Converts value to LINEAR11 register data
- *
- * @param dev - Device structure
- * @param data - Value to convert
- * @param reg - Address of converted register data
- * @param scale - Value scaling factor
- * @return 0 in case of success, negative error code otherwise
- */
-static int lt7182s_data2reg_linear11(struct lt7182s_dev *dev, int data,
-				     uint16_t *reg, int scale)
-{
-	int exp = 0, mant = 0;
-	uint8_t negative = 0;
-
-	if (data < 0) {
-		negative = 1;
-		data = -data;
-	}
-
-	/* If value too high, continuously do m/2 until m < 1023. */
-	while (data >= LT7182S_LIN11_MANTISSA_MAX * scale &&
-	       exp < LT7182S_LIN11_EXPONENT_MAX) {
-		exp++;
-		data >>= 1;
-	}
-
-	/* If value too low, increase mantissa. */
-	while (data < LT7182S_LIN11_MANTISSA_MIN * scale &&
-	       exp > LT7182S_LIN11_EXPONENT_MIN) {
-		exp--;
-		data <<= 1;
-	}
-
-	mant = no_os_clamp(NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale),
-			   0, 0x3FF);
-	if (negative)
-		mant = -mant;
-
-	*reg = no_os_field_prep(LT7182S_LIN11_MANTISSA_MSK, mant) |
-	       no_os_field_prep(LT7182S_LIN11_EXPONENT_MSK, exp);
-
-	return 0;
-}
-
-/**
- * @brief Converts value to IEEE754 register data
- *
- * @param dev - Device structure
- * @param data - Value to convert
- * @param reg - Address of converted register data
- * @param scale - Value scaling factor
- * @return 0 in case of success, negative error code otherwise
- */
-static int lt7182s_data2reg_ieee754(struct lt7182s_dev *dev, int data,
-				    uint16_t *reg, int scale)
-{
-	uint16_t exponent = (15 + 10);
-	uint16_t sign = 0;
-	int mantissa;
-
-	/* simple case */
-	if (data == 0)
-		return 0;
-
-	if (data < 0) {
-		sign = 1;
-		data = -data;
-	}
-
-	if (scale > (int)MILLI)
-		data = NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale/MILLI);
-	else
-		data *= (int)MILLI / scale;
-
-	/* Reduce large mantissa until it fits into 10 bit */
-	while ((data > LT7182S_IEEE754_MAX_MANTISSA * scale) && exponent < 30) {
-		exponent++;
-		data >>= 1;
-	}
-	/*
-	 * Increase small mantissa to generate valid 'normal'
-	 * number
-	 */
-	while ((data < LT7182S_IEEE754_MIN_MANTISSA * scale) && exponent > 1) {
-		exponent--;
-		data <<= 1;
-	}
-
-	/* Convert mantissa from scaled-units to units */
-	mantissa = NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale);
-
-	mantissa = no_os_clamp(mantissa, LT7182S_IEEE754_MIN_MANTISSA,
-			       LT7182S_IEEE754_MAX_MANTISSA);
-
-	/* Convert to sign, 5 bit exponent, 10 bit mantissa */
-	*reg = no_os_field_prep(LT7182S_IEEE754_SIGN_BIT, sign) |
-	       no_os_field_prep(LT7182S_IEEE754_MANTISSA_MSK, mantissa) |
-	       no_os_field_prep(LT7182S_IEEE754_EXPONENT_MSK, exponent);
-
-	return 0;
-}
-
-/**
- * @brief Converts raw LINEAR16 register data to its actual value
- *
- * @param dev - Device structure
- * @param reg - LINEAR16 data to convert
- * @param data - Address of value
- * @param scale - Value scaling factor
- * @return 0 in case of success, negative error code otherwise
- */
-static int lt7182s_reg2data_linear16(struct lt7182s_dev *dev, uint16_t reg,
-				     int *data, int scale)
-{
-	int exp = dev->lin16_exp;
-	if (exp < 0)
-		exp = -exp;
-
-	*data = ((int)(reg) * scale) >> exp;
-
-	return 0;
-}
-
-/**
- * @brief Converts raw LINEAR11 register data to its actual value
- *
- * @param dev - Device structure
- * @param reg - LINEAR11 data to convert
- * @param data - Address of value
- * @param scale - Value scaling factor
- * @return 0 in case of success, negative error code otherwise
- */
-static int lt7182s_reg2data_linear11(struct lt7182s_dev *dev, uint16_t reg,
-				     int *data, int scale)
-{
-	int val, exp, mant;
-
-	exp = LT7182S_LIN11_EXPONENT(reg);
-	mant = LT7182S_LIN11_MANTISSA(reg);
-
-	val = mant * scale;
-	if (exp >= 0)
-		*data = val << exp;
-	else
-		*data = val >> -exp;
-
-	return 0;
-}
-
-/**
- * @brief Converts raw IEEE754 register data to its actual value
- *
- * @param dev - Device structure
- * @param reg - IEEE754 data to convert
- * @param data - Address of value
- * @param scale - Value scaling factor
- * @return 0 in case of success, negative error code otherwise
- */
-static int lt7182s_reg2data_ieee754(struct lt7182s_dev *dev, uint16_t reg,
-				    int *data, int scale)
-{
-	int val;
-	int exponent;
-	bool sign;
-
-	sign = no_os_field_get(LT7182S_IEEE754_SIGN_BIT, reg);
-	exponent = no_os_field_get(LT7182S_IEEE754_EXPONENT_MSK, reg);
-	val = no_os_field_get(LT7182S_IEEE754_MANTISSA_MSK, reg);
-
-	if (exponent == 0) {			/* subnormal */
-		exponent = -(14 + 10);
-	} else if (exponent ==  0x1f) {		/* NaN, convert to min/max */
-		exponent = 0;
-		val = 65504;
-	} else {
-		exponent -= (15 + 10);		/* normal */
-		val |= 0x400;
-	}
-
-	val *= scale;
-
-	if (exponent >= 0)
-		val <<= exponent;
-	else
-		val >>= -exponent;
-
-	if (sign)
-		val = -val;
-
-	*data = val;
-
-	return 0;
-}
-
 /**
  * @brief Convert value to register data
  *
@@ -375,11 +155,11 @@ static int lt7182s_data2reg(struct lt7182s_dev *dev, uint8_t cmd,
 	case LT7182S_READ_VOUT:
 	case LT7182S_MFR_VOUT_PEAK:
 		if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
-			return lt7182s_data2reg_linear16(dev, data, reg,
-							 MILLIVOLT_PER_VOLT);
+			return pmbus_data_to_linear16(data, dev->lin16_exp,
+						      MILLIVOLT_PER_VOLT, reg);
 		else
-			return lt7182s_data2reg_ieee754(dev, data, reg,
-							MILLIVOLT_PER_VOLT);
+			return pmbus_data_to_ieee754(data, MILLIVOLT_PER_VOLT,
+						     reg);
 	case LT7182S_FREQUENCY_SWITCH:
 	case LT7182S_VIN_ON:
 	case LT7182S_VIN_OFF:
@@ -405,18 +185,16 @@ static int lt7182s_data2reg(struct lt7182s_dev *dev, uint8_t cmd,
 	case LT7182S_MFR_NOT_PGOOD_DELAY:
 	case LT7182S_MFR_PWM_PHASE:
 		if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
-			return lt7182s_data2reg_linear11(dev, data, reg,
-							 MILLI);
+			return pmbus_data_to_linear11(data, MILLI, reg);
 		else
-			return lt7182s_data2reg_ieee754(dev, data, reg,
-							MILLI);
+			return pmbus_data_to_ieee754(data, MILLI, reg);
 	case LT7182S_READ_POUT:
 		if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
-			return lt7182s_data2reg_linear11(dev, data, reg,
-							 MICROWATT_PER_WATT);
+			return pmbus_data_to_linear11(data, MICROWATT_PER_WATT,
+						      reg);
 		else
-			return lt7182s_data2reg_ieee754(dev, data, reg,
-							MICROWATT_PER_WATT);
+			return pmbus_data_to_ieee754(data, MICROWATT_PER_WATT,
+						     reg);
 	default:
 		return -EINVAL;
 	}
@@ -446,11 +224,11 @@ static int lt7182s_reg2data(struct lt7182s_dev *dev, uint8_t cmd,
 	case LT7182S_READ_VOUT:
 	case LT7182S_MFR_VOUT_PEAK:
 		if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
-			return lt7182s_reg2data_linear16(dev, reg, data,
-							 MILLIVOLT_PER_VOLT);
+			return pmbus_linear16_to_data(reg, dev->lin16_exp,
+						      MILLIVOLT_PER_VOLT, data);
 		else
-			return lt7182s_reg2data_ieee754(dev, reg, data,
-							MILLIVOLT_PER_VOLT);
+			return pmbus_ieee754_to_data(reg, MILLIVOLT_PER_VOLT,
+						     data);
 	case LT7182S_FREQUENCY_SWITCH:
 	case LT7182S_VIN_ON:
 	case LT7182S_VIN_OFF:
@@ -476,49 +254,21 @@ static int lt7182s_reg2data(struct lt7182s_dev *dev, uint8_t cmd,
 	case LT7182S_MFR_NOT_PGOOD_DELAY:
 	case LT7182S_MFR_PWM_PHASE:
 		if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
-			return lt7182s_reg2data_linear11(dev, reg, data,
-							 MILLI);
+			return pmbus_linear11_to_data(reg, MILLI, data);
 		else
-			return lt7182s_reg2data_ieee754(dev, reg, data,
-							MILLI);
+			return pmbus_ieee754_to_data(reg, MILLI, data);
 	case LT7182S_READ_POUT:
 		if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
-			return lt7182s_reg2data_linear11(dev, reg, data,
-							 MICROWATT_PER_WATT);
+			return pmbus_linear11_to_data(reg, MICROWATT_PER_WATT,
+						      data);
 		else
-			return lt7182s_reg2data_ieee754(dev, reg, data,
-							MICROWATT_PER_WATT);
+			return pmbus_ieee754_to_data(reg, MICROWATT_PER_WATT,
+						     data);
 	default:
 		return -EINVAL;
 	}
 }
 
-/**
- * @brief Perform packet-error checking via CRC
- *
- * @param dev - Device structure
- * @param cmd - PMBus command
- * @param buf - Pointer to the first packet buffer
- * @param nbytes - Packet buffer size
- * @param op - Operation performed. 0 for write, 1 for read
- * @return PEC code of the PMBus packet
- */
-static uint8_t lt7182s_pec(struct lt7182s_dev *dev, uint8_t cmd, uint8_t *buf,
-			   size_t nbytes, uint8_t op)
-{
-	uint8_t crc_buf[nbytes + op + 2];
-
-	crc_buf[0] = (dev->i2c_desc->slave_address << 1);
-	crc_buf[1] = cmd;
-	if (op)
-		crc_buf[2] = (dev->i2c_desc->slave_address << 1) | 1;
-
-	if (buf != NULL && nbytes > 0)
-		memcpy(&crc_buf[2 + op], buf, nbytes);
-
-	return no_os_crc8(lt7182s_crc_table, crc_buf, nbytes + op + 2, 0);
-}
-
 /**
  * @brief Initialize the device structure
  *
@@ -529,6 +279,11 @@ static uint8_t lt7182s_pec(struct lt7182s_dev *dev, uint8_t cmd, uint8_t *buf,
 int lt7182s_init(struct lt7182s_dev **device,
 		 struct lt7182s_init_param *init_param)
 {
+	struct pmbus_init_param pmbus_param = {
+		.i2c_init = init_param->i2c_init,
+		.page_verify = true,
+		.chain_max = init_param->chain_max,
+	};
 	struct lt7182s_dev *dev;
 	int ret;
 	uint16_t word;
@@ -538,8 +293,8 @@ int lt7182s_init(struct lt7182s_dev **device,
 	if (!dev)
 		return -ENOMEM;
 
-	/* Initialize I2C */
-	ret = no_os_i2c_init(&dev->i2c_desc, init_param->i2c_init);
+	/* Initialize the PMBus core and I2C */
+	ret = pmbus_init(&dev->pmbus, &pmbus_param);
 	if (ret)
 		goto i2c_err;
 
@@ -576,14 +331,11 @@ int lt7182s_init(struct lt7182s_dev **device,
 	if (ret)
 		goto dev_err;
 
-	dev->crc_en = init_param->crc_en;
+	/* A write with a bad PEC is rejected, PAGE readback isn't needed */
+	dev->pmbus->pec_en = init_param->crc_en;
+	dev->pmbus->page_verify = !init_param->crc_en;
 	dev->format = init_param->format;
 
-	/* Populate CRC table for PEC */
-	if (dev->crc_en)
-		no_os_crc8_populate_msb(lt7182s_crc_table,
-					LT7182S_CRC_POLYNOMIAL);
-
 	if (dev->format == LT7182S_DATA_FORMAT_LINEAR)
 		dev->lin16_exp = LT7182S_LIN16_EXPONENT;
 
@@ -707,7 +459,7 @@ dev_err:
 	no_os_gpio_remove(dev->run0_desc);
 	no_os_gpio_remove(dev->pg1_desc);
 	no_os_gpio_remove(dev->pg0_desc);
-	no_os_i2c_remove(dev->i2c_desc);
+	pmbus_remove(dev->pmbus);
 i2c_err:
 	no_os_free(dev);
 	return ret;
@@ -723,7 +475,7 @@ int lt7182s_remove(struct lt7182s_dev *dev)
 {
 	int ret;
 
-	ret = no_os_i2c_remove(dev->i2c_desc);
+	ret = pmbus_remove(dev->pmbus);
 	if (ret)
 		return ret;
 
@@ -767,7 +519,8 @@ int lt7182s_remove(struct lt7182s_dev *dev)
 }
 
 /**
- * @brief Set page of the device.
+ * @brief Set page of the device. PAGE is only written when it differs from
+ * the page cached by the PMBus core.
  * 	  Page 0x0 - Channel 0
  * 	  Page 0x1 - Channel 1
  * 	  Page 0xff - Both channels
@@ -778,56 +531,46 @@ int lt7182s_remove(struct lt7182s_dev *dev)
  */
 int lt7182s_set_page(struct lt7182s_dev *dev, int page)
 {
-	int ret = 0;
-	uint8_t read_page;
-	uint8_t tx_buf[3] = {0};
-	uint8_t rx_buf[2] = {0};
+	int ret;
 
 	if (!(page == LT7182S_CHAN_0 || page == LT7182S_CHAN_1 ||
 	      page == LT7182S_CHAN_ALL))
 		return -EINVAL;
 
-	if (dev->page != page) {
-		tx_buf[0] = LT7182S_PAGE;
-		tx_buf[1] = page & 0xFF;
-
-		if (dev->crc_en)
-			tx_buf[2] = lt7182s_pec(dev, LT7182S_PAGE,
-						(uint8_t *)&page, 1, 0);
-
-		ret = no_os_i2c_write(dev->i2c_desc, tx_buf,
-				      dev->crc_en + 2, 1);
-		if(ret)
-			return ret;
+	ret = pmbus_set_page(dev->pmbus, page);
+	if (ret)
+		return ret;
 
-		ret = no_os_i2c_write(dev->i2c_desc, tx_buf, 1, 0);
-		if(ret)
-			return ret;
+	dev->page = page;
 
-		if (dev->crc_en) {
-			ret = no_os_i2c_read(dev->i2c_desc, rx_buf, 2, 1);
-			if (ret)
-				return ret;
+	return 0;
+}
 
-			if (lt7182s_pec(dev, LT7182S_PAGE, rx_buf, 1, 1) !=
-			    rx_buf[1])
-				return -EBADMSG;
+/**
+ * @brief Get the page to be passed to the PMBus core for a command
+ *
+ * @param dev - Device structure
+ * @param page - Page or channel of the command
+ * @param cmd - PMBus command
+ * @param pmbus_page - PMBus core page, PMBUS_PAGE_NONE if not paged
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int lt7182s_cmd_page(struct lt7182s_dev *dev, int page, uint8_t cmd,
+			    int *pmbus_page)
+{
+	int ret;
 
-			read_page = rx_buf[0];
+	*pmbus_page = PMBUS_PAGE_NONE;
+	if (!lt7182s_cmd_is_paged(cmd))
+		return 0;
 
-		} else {
-			ret = no_os_i2c_read(dev->i2c_desc, &read_page, 1, 1);
-			if(ret)
-				return ret;
-		}
+	ret = lt7182s_set_page(dev, page);
+	if (ret)
+		return ret;
 
-		if(read_page != page)
-			return -EIO;
+	*pmbus_page = page;
 
-		dev->page = page;
-	}
-
-	return ret;
+	return 0;
 }
 
 /**
@@ -841,19 +584,12 @@ int lt7182s_set_page(struct lt7182s_dev *dev, int page)
 int lt7182s_send_byte(struct lt7182s_dev *dev, int page, uint8_t cmd)
 {
 	int ret;
-	uint8_t tx_buf[2] = {0};
 
-	if (lt7182s_cmd_is_paged(cmd)) {
-		ret = lt7182s_set_page(dev, page);
-		if(ret)
-			return ret;
-	}
-
-	tx_buf[0] = cmd;
-	if (dev->crc_en)
-		tx_buf[1] = lt7182s_pec(dev, cmd, NULL, 0, 0);
+	ret = lt7182s_cmd_page(dev, page, cmd, &page);
+	if (ret)
+		return ret;
 
-	return no_os_i2c_write(dev->i2c_desc, tx_buf, dev->crc_en + 1, 1);
+	return pmbus_send_byte(dev->pmbus, page, cmd);
 }
 
 /**
@@ -869,30 +605,12 @@ int lt7182s_read_byte(struct lt7182s_dev *dev, int page,
 		      uint8_t cmd, uint8_t *data)
 {
 	int ret;
-	uint8_t rx_buf[2];
-
-	if (lt7182s_cmd_is_paged(cmd)) {
-		ret = lt7182s_set_page(dev, page);
-		if(ret)
-			return ret;
-	}
 
-	ret = no_os_i2c_write(dev->i2c_desc, &cmd, 1, 0);
+	ret = lt7182s_cmd_page(dev, page, cmd, &page);
 	if (ret)
 		return ret;
 
-	if (dev->crc_en) {
-		ret = no_os_i2c_read(dev->i2c_desc, rx_buf, 2, 1);
-		if (ret)
-			return ret;
-
-		if (lt7182s_pec(dev, cmd, rx_buf, 1, 1) != rx_buf[1])
-			return -EBADMSG;
-
-		*data = rx_buf[0];
-		return ret;
-	} else
-		return no_os_i2c_read(dev->i2c_desc, data, 1, 1);
+	return pmbus_read_byte(dev->pmbus, page, cmd, data);
 }
 
 /**
@@ -908,21 +626,12 @@ int lt7182s_write_byte(struct lt7182s_dev *dev, int page,
 		       uint8_t cmd, uint8_t value)
 {
 	int ret;
-	uint8_t tx_buf[3] = {0};
-
-	if (lt7182s_cmd_is_paged(cmd)) {
-		ret = lt7182s_set_page(dev, page);
-		if(ret)
-			return ret;
-	}
-
-	tx_buf[0] = cmd;
-	tx_buf[1] = value;
 
-	if (dev->crc_en)
-		tx_buf[2] = lt7182s_pec(dev, cmd, &value, 1, 0);
+	ret = lt7182s_cmd_page(dev, page, cmd, &page);
+	if (ret)
+		return ret;
 
-	return no_os_i2c_write(dev->i2c_desc, tx_buf, dev->crc_en + 2, 1);
+	return pmbus_write_byte(dev->pmbus, page, cmd, value);
 }
 
 /**
@@ -938,33 +647,12 @@ int lt7182s_read_word(struct lt7182s_dev *dev, int page,
 		      uint8_t cmd, uint16_t *word)
 {
 	int ret;
-	uint8_t rx_buf[3] = {0};
-
-	if (lt7182s_cmd_is_paged(cmd)) {
-		ret = lt7182s_set_page(dev, page);
-		if(ret)
-			return ret;
-	}
 
-	ret = no_os_i2c_write(dev->i2c_desc, &cmd, 1, 0);
+	ret = lt7182s_cmd_page(dev, page, cmd, &page);
 	if (ret)
 		return ret;
 
-	if (dev->crc_en) {
-		ret = no_os_i2c_read(dev->i2c_desc, rx_buf, 3, 1);
-		if (ret)
-			return ret;
-
-		if (lt7182s_pec(dev, cmd, rx_buf, 2, 1) != rx_buf[2])
-			return -EBADMSG;
-	} else {
-		ret = no_os_i2c_read(dev->i2c_desc, rx_buf, 2, 1);
-		if(ret)
-			return ret;
-	}
-
-	*word = no_os_get_unaligned_le16(rx_buf);
-	return 0;
+	return pmbus_read_word(dev->pmbus, page, cmd, word);
 }
 
 /**
@@ -980,21 +668,12 @@ int lt7182s_write_word(struct lt7182s_dev *dev, int page,
 		       uint8_t cmd, uint16_t word)
 {
 	int ret;
-	uint8_t tx_buf[4] = {0};
 
-	if (lt7182s_cmd_is_paged(cmd)) {
-		ret = lt7182s_set_page(dev, page);
-		if(ret)
-			return ret;
-	}
-
-	tx_buf[0] = cmd;
-	no_os_put_unaligned_le16(word, &tx_buf[1]);
-
-	if (dev->crc_en)
-		tx_buf[3] = lt7182s_pec(dev, cmd, &tx_buf[1], 2, 0);
+	ret = lt7182s_cmd_page(dev, page, cmd, &page);
+	if (ret)
+		return ret;
 
-	return no_os_i2c_write(dev->i2c_desc, tx_buf, dev->crc_en + 3, 1);
+	return pmbus_write_word(dev->pmbus, page, cmd, word);
 }
 
 /**
@@ -1055,41 +734,12 @@ int lt7182s_read_block_data(struct lt7182s_dev *dev, int page, uint8_t cmd,
 			    uint8_t *data, size_t nbytes)
 {
 	int ret;
-	uint8_t rxbuf[nbytes + 2];
 
-	if (lt7182s_cmd_is_paged(cmd)) {
-		ret = lt7182s_set_page(dev, page);
-		if(ret)
-			return ret;
-	}
-
-	ret = no_os_i2c_write(dev->i2c_desc, &cmd, 1, 0);
-	if(ret)
+	ret = lt7182s_cmd_page(dev, page, cmd, &page);
+	if (ret)
 		return ret;
 
-	if (dev->crc_en) {
-		ret = no_os_i2c_read(dev->i2c_desc, rxbuf, nbytes + 2, 1);
-		if (ret)
-			return ret;
-
-		if ((size_t)rxbuf[0] > nbytes)
-			return -EMSGSIZE;
-
-		if (lt7182s_pec(dev, cmd, rxbuf, nbytes + 1, 1) !=
-		    rxbuf[nbytes + 1])
-			return -EBADMSG;
-	} else {
-		ret = no_os_i2c_read(dev->i2c_desc, rxbuf, nbytes + 1, 1);
-		if(ret)
-			return ret;
-
-		if((size_t)rxbuf[0] > nbytes)
-			return -EMSGSIZE;
-	}
-
-	memcpy(data, &rxbuf[1], nbytes);
-
-	return 0;
+	return pmbus_read_block(dev->pmbus, page, cmd, data, nbytes);
 }
 
 /**
@@ -1116,6 +766,61 @@ int lt7182s_read_value(struct lt7182s_dev *dev,
 				      (uint8_t)value_type, value);
 }
 
+/**
+ * @brief Read the input, output and temperature telemetry of both channels.
+ * All readings go through one PMBus scan list, so PAGE is written at most
+ * twice and the reads are chained as configured by chain_max.
+ *
+ * @param dev - Device structure
+ * @param telemetry - Address of the telemetry values
+ * @return 0 in case of success, negative error code otherwise
+ */
+int lt7182s_read_telemetry(struct lt7182s_dev *dev,
+			   struct lt7182s_telemetry *telemetry)
+{
+	static const uint8_t pages[] = {LT7182S_CHAN_0, LT7182S_CHAN_1};
+	static const uint8_t cmds[] = {
+		LT7182S_READ_VIN, LT7182S_READ_VOUT, LT7182S_READ_IOUT,
+		LT7182S_READ_POUT, LT7182S_READ_TEMPERATURE_1,
+	};
+	const struct pmbus_scan scan = {
+		.pages = pages,
+		.nb_pages = NO_OS_ARRAY_SIZE(pages),
+		.cmds = cmds,
+		.nb_cmds = NO_OS_ARRAY_SIZE(cmds),
+	};
+	uint16_t raw[NO_OS_ARRAY_SIZE(pages)][NO_OS_ARRAY_SIZE(cmds)];
+	int *vals[NO_OS_ARRAY_SIZE(cmds)];
+	uint32_t i, j;
+	int ret;
+
+	if (!dev || !telemetry)
+		return -EINVAL;
+
+	ret = pmbus_scan(dev->pmbus, &scan, &raw[0][0]);
+	if (ret)
+		return ret;
+
+	dev->page = dev->pmbus->page;
+
+	for (i = 0; i < NO_OS_ARRAY_SIZE(pages); i++) {
+		vals[0] = &telemetry->vin[i];
+		vals[1] = &telemetry->vout[i];
+		vals[2] = &telemetry->iout[i];
+		vals[3] = &telemetry->pout[i];
+		vals[4] = &telemetry->temp[i];
+
+		for (j = 0; j < NO_OS_ARRAY_SIZE(cmds); j++) {
+			ret = lt7182s_reg2data(dev, cmds[j], raw[i][j],
+					       vals[j]);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return 0;
+}
+
 /**
  * @brief Read statuses
  *
@@ -1533,6 +1238,7 @@ int lt7182s_nvm_cmd(struct lt7182s_dev *dev, enum lt7182s_nvm_cmd_type cmd)
 		if (ret)
 			return ret;
 
+		pmbus_invalidate(dev->pmbus);
 		dev->format = LT7182S_DATA_FORMAT_IEEE754;
 		break;
 	default:
@@ -1567,6 +1273,8 @@ int lt7182s_software_reset(struct lt7182s_dev *dev)
 	if (ret)
 		return ret;
 
+	pmbus_invalidate(dev->pmbus);
+
 	dev->format = LT7182S_DATA_FORMAT_IEEE754;
 
 	return 0;
@@ -48,6 +48,7 @@
 #include <string.h>
 #include "no_os_util.h"
 #include "no_os_i2c.h"
+#include "pmbus.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -323,7 +324,7 @@ enum lt7182s_pwm_mode {
 };
 
 struct lt7182s_dev {
-	struct no_os_i2c_desc *i2c_desc;
+	struct pmbus_dev *pmbus;
 	struct no_os_gpio_desc *pg0_desc;
 	struct no_os_gpio_desc *pg1_desc;
 	struct no_os_gpio_desc *run0_desc;
@@ -337,7 +338,6 @@ struct lt7182s_dev {
 	enum lt7182s_data_format format;
 	int page;
 	int lin16_exp;
-	bool crc_en;
 };
 
 struct lt7182s_init_param {
@@ -358,6 +358,16 @@ struct lt7182s_init_param {
 
 	bool external_clk_en;
 	bool crc_en;
+	/* Telemetry reads chained in one transfer, 0 or 1 to disable */
+	uint8_t chain_max;
+};
+
+struct lt7182s_telemetry {
+	int vin[2];
+	int vout[2];
+	int iout[2];
+	int pout[2];
+	int temp[2];
 };
 
 struct lt7182s_chip_info {
@@ -425,6 +435,10 @@ int lt7182s_read_value(struct lt7182s_dev *dev, int channel,
 		       enum lt7182s_value_type value_type,
 		       int *value);
 
+/* Read the telemetry of both channels */
+int lt7182s_read_telemetry(struct lt7182s_dev *dev,
+			   struct lt7182s_telemetry *telemetry);
+
 /* Read status */
 int lt7182s_read_status(struct lt7182s_dev *dev, int channel,
 			enum lt7182s_status_type status_type,
@@ -300,13 +300,14 @@ int ltc2992_read_reg(struct ltc2992_dev *dev, uint8_t addr,
 {
 	int ret;
 	uint8_t rx_buf[3] = {0};
+	struct no_os_i2c_msg msgs[] = {
+		{ .buff = &addr, .bytes_number = 1 },
+		{ .buff = rx_buf, .read = 1 },
+	};
 
 	num_bytes = no_os_clamp_t(uint8_t, num_bytes, 0, 3);
-	ret = no_os_i2c_write(dev->i2c_desc, &addr, 1, 0);
-	if (ret)
-		return ret;
-
-	ret = no_os_i2c_read(dev->i2c_desc, rx_buf, num_bytes, 0);
+	msgs[1].bytes_number = num_bytes;
+	ret = no_os_i2c_transfer(dev->i2c_desc, msgs, NO_OS_ARRAY_SIZE(msgs));
 	if (ret)
 		return ret;
 
@@ -0,0 +1,990 @@
+/***************************************************************************//**
+ *   @file   pmbus.c
+ *   @brief  Source code of the shared PMBus core
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include "no_os_units.h"
+#include "no_os_util.h"
+#include "no_os_alloc.h"
+#include "no_os_i2c.h"
+#include "no_os_crc8.h"
+
+#include "pmbus.h"
+
+NO_OS_DECLARE_CRC8_TABLE(pmbus_crc_table);
+static bool pmbus_crc_ready;
+
+/**
+ * @brief Command part of a (possibly paged) access
+ */
+struct pmbus_frame {
+	/** Command, or PAGE_PLUS_READ/WRITE, count, page and command */
+	uint8_t buf[4];
+	uint8_t len;
+	/** Response starts with a block byte count */
+	bool plus;
+};
+
+/**
+ * @brief Compute the PEC of a transaction. The read address byte is only
+ * included when rlen is non zero.
+ *
+ * @param addr - 7 bit slave address
+ * @param wbuf - Bytes written, starting with the command code
+ * @param wlen - Number of bytes written
+ * @param rbuf - Bytes read, without the PEC byte
+ * @param rlen - Number of bytes read
+ * @return PEC of the transaction
+ */
+uint8_t pmbus_pec(uint8_t addr, const uint8_t *wbuf, uint32_t wlen,
+		  const uint8_t *rbuf, uint32_t rlen)
+{
+	uint8_t byte = addr << 1;
+	uint8_t crc;
+
+	if (!pmbus_crc_ready) {
+		no_os_crc8_populate_msb(pmbus_crc_table, PMBUS_CRC_POLYNOMIAL);
+		pmbus_crc_ready = true;
+	}
+
+	crc = no_os_crc8(pmbus_crc_table, &byte, 1, 0);
+	crc = no_os_crc8(pmbus_crc_table, wbuf, wlen, crc);
+	if (!rlen)
+		return crc;
+
+	byte |= 1;
+	crc = no_os_crc8(pmbus_crc_table, &byte, 1, crc);
+
+	return no_os_crc8(pmbus_crc_table, rbuf, rlen, crc);
+}
+
+/**
+ * @brief Issue a combined transfer
+ *
+ * @param dev - Device structure
+ * @param msgs - Messages of the transfer
+ * @param nb_msgs - Number of messages
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int pmbus_transfer(struct pmbus_dev *dev, struct no_os_i2c_msg *msgs,
+			  uint32_t nb_msgs)
+{
+	dev->transfers++;
+
+	return no_os_i2c_transfer(dev->i2c_desc, msgs, nb_msgs);
+}
+
+/**
+ * @brief Write a command, appending the PEC byte if enabled
+ *
+ * @param dev - Device structure
+ * @param buf - Command code followed by data, with one spare byte at the end
+ * @param len - Number of bytes without the PEC byte
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int pmbus_write(struct pmbus_dev *dev, uint8_t *buf, uint32_t len)
+{
+	struct no_os_i2c_msg msg = {
+		.buff = buf,
+		.bytes_number = len,
+	};
+
+	if (dev->pec_en) {
+		buf[len] = pmbus_pec(dev->i2c_desc->slave_address, buf, len,
+				     NULL, 0);
+		msg.bytes_number++;
+	}
+
+	return pmbus_transfer(dev, &msg, 1);
+}
+
+/**
+ * @brief Check the PEC byte following a response
+ *
+ * @param dev - Device structure
+ * @param wbuf - Bytes written
+ * @param wlen - Number of bytes written
+ * @param rbuf - Bytes read, followed by the PEC byte
+ * @param rlen - Number of bytes read without the PEC byte
+ * @return 0 in case of success, -EBADMSG on mismatch
+ */
+static int pmbus_pec_check(struct pmbus_dev *dev, const uint8_t *wbuf,
+			   uint32_t wlen, const uint8_t *rbuf, uint32_t rlen)
+{
+	if (!dev->pec_en)
+		return 0;
+
+	if (pmbus_pec(dev->i2c_desc->slave_address, wbuf, wlen, rbuf,
+		      rlen) == rbuf[rlen])
+		return 0;
+
+	dev->pec_errors++;
+
+	return -EBADMSG;
+}
+
+/**
+ * @brief Write a byte to one of the cached selection commands
+ *
+ * @param dev - Device structure
+ * @param cmd - PMBUS_PAGE or PMBUS_PHASE
+ * @param cache - Cached value of the command
+ * @param val - Value to select, PMBUS_PAGE_NONE to keep the current one
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int pmbus_select(struct pmbus_dev *dev, uint8_t cmd, int *cache,
+			int val)
+{
+	struct no_os_i2c_msg msgs[2];
+	uint8_t buf[3] = {cmd, val};
+	uint8_t rx[2];
+	int ret;
+
+	if (val == PMBUS_PAGE_NONE || val == *cache)
+		return 0;
+
+	if (val < 0 || val > PMBUS_PAGE_ALL)
+		return -EINVAL;
+
+	/* Whatever happens next, the device state is not known anymore */
+	*cache = PMBUS_PAGE_NONE;
+
+	ret = pmbus_write(dev, buf, 2);
+	if (ret)
+		return ret;
+
+	/* With PEC enabled a corrupted write is rejected by the device */
+	if (dev->page_verify) {
+		msgs[0] = (struct no_os_i2c_msg) {
+			.buff = buf, .bytes_number = 1
+		};
+		msgs[1] = (struct no_os_i2c_msg) {
+			.buff = rx, .bytes_number = 1 + dev->pec_en, .read = 1
+		};
+		ret = pmbus_transfer(dev, msgs, 2);
+		if (ret)
+			return ret;
+
+		ret = pmbus_pec_check(dev, buf, 1, rx, 1);
+		if (ret)
+			return ret;
+
+		if (rx[0] != val)
+			return -EIO;
+	}
+
+	*cache = val;
+
+	return 0;
+}
+
+/**
+ * @brief Select the page of the following commands. PAGE is only written
+ * when it differs from the cached value.
+ *
+ * @param dev - Device structure
+ * @param page - Page to select, PMBUS_PAGE_NONE to keep the current one
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_set_page(struct pmbus_dev *dev, int page)
+{
+	if (!dev)
+		return -EINVAL;
+
+	return pmbus_select(dev, PMBUS_PAGE, &dev->page, page);
+}
+
+/**
+ * @brief Select the phase of the following commands. PHASE is only written
+ * when it differs from the cached value.
+ *
+ * @param dev - Device structure
+ * @param phase - Phase to select, PMBUS_PAGE_NONE to keep the current one
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_set_phase(struct pmbus_dev *dev, int phase)
+{
+	if (!dev)
+		return -EINVAL;
+
+	return pmbus_select(dev, PMBUS_PHASE, &dev->phase, phase);
+}
+
+/**
+ * @brief Forget the cached page and phase, so that the next paged command
+ * writes them again. Needed after a reset or a restore from NVM.
+ *
+ * @param dev - Device structure
+ */
+void pmbus_invalidate(struct pmbus_dev *dev)
+{
+	if (!dev)
+		return;
+
+	dev->page = PMBUS_PAGE_NONE;
+	dev->phase = PMBUS_PAGE_NONE;
+}
+
+/**
+ * @brief Build the command part of an access. If the device supports it and
+ * the page has to change, PAGE_PLUS_READ/WRITE is used instead of a separate
+ * PAGE write.
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param nb_data - Number of data bytes written after the command
+ * @param read - Build a read access
+ * @param frame - Built frame
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int pmbus_frame_prepare(struct pmbus_dev *dev, int page, uint8_t cmd,
+			       uint8_t nb_data, bool read,
+			       struct pmbus_frame *frame)
+{
+	int ret;
+
+	if (!dev->page_plus || page == PMBUS_PAGE_NONE || page == dev->page) {
+		ret = pmbus_set_page(dev, page);
+		if (ret)
+			return ret;
+
+		frame->buf[0] = cmd;
+		frame->len = 1;
+		frame->plus = false;
+
+		return 0;
+	}
+
+	if (page < 0 || page > PMBUS_PAGE_ALL)
+		return -EINVAL;
+
+	frame->buf[0] = read ? PMBUS_PAGE_PLUS_READ : PMBUS_PAGE_PLUS_WRITE;
+	frame->buf[1] = 2 + nb_data;
+	frame->buf[2] = page;
+	frame->buf[3] = cmd;
+	frame->len = 4;
+	frame->plus = read;
+
+	return 0;
+}
+
+/**
+ * @brief Write a command followed by up to two data bytes
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param data - Data bytes, least significant byte first
+ * @param nb_data - Number of data bytes
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int pmbus_write_data(struct pmbus_dev *dev, int page, uint8_t cmd,
+			    const uint8_t *data, uint8_t nb_data)
+{
+	struct pmbus_frame frame;
+	uint8_t buf[sizeof(frame.buf) + 3];
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	ret = pmbus_frame_prepare(dev, page, cmd, nb_data, false, &frame);
+	if (ret)
+		return ret;
+
+	memcpy(buf, frame.buf, frame.len);
+	memcpy(&buf[frame.len], data, nb_data);
+
+	return pmbus_write(dev, buf, frame.len + nb_data);
+}
+
+/**
+ * @brief Read up to two data bytes of a command
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param data - Data bytes, least significant byte first
+ * @param nb_data - Number of data bytes
+ * @return 0 in case of success, negative error code otherwise
+ */
+static int pmbus_read_data(struct pmbus_dev *dev, int page, uint8_t cmd,
+			   uint8_t *data, uint8_t nb_data)
+{
+	struct no_os_i2c_msg msgs[2];
+	struct pmbus_frame frame;
+	uint8_t rx[4];
+	int ret;
+
+	if (!dev || !data)
+		return -EINVAL;
+
+	ret = pmbus_frame_prepare(dev, page, cmd, 0, true, &frame);
+	if (ret)
+		return ret;
+
+	msgs[0] = (struct no_os_i2c_msg) {
+		.buff = frame.buf, .bytes_number = frame.len
+	};
+	msgs[1] = (struct no_os_i2c_msg) {
+		.buff = rx, .bytes_number = frame.plus + nb_data + dev->pec_en,
+		.read = 1
+	};
+	ret = pmbus_transfer(dev, msgs, 2);
+	if (ret)
+		return ret;
+
+	ret = pmbus_pec_check(dev, frame.buf, frame.len, rx,
+			      frame.plus + nb_data);
+	if (ret)
+		return ret;
+
+	if (frame.plus && rx[0] != nb_data)
+		return -EIO;
+
+	memcpy(data, &rx[frame.plus], nb_data);
+
+	return 0;
+}
+
+/**
+ * @brief Send a command without data
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_send_byte(struct pmbus_dev *dev, int page, uint8_t cmd)
+{
+	return pmbus_write_data(dev, page, cmd, NULL, 0);
+}
+
+/**
+ * @brief Read a byte
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param data - Address of the read byte
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_read_byte(struct pmbus_dev *dev, int page, uint8_t cmd,
+		    uint8_t *data)
+{
+	return pmbus_read_data(dev, page, cmd, data, 1);
+}
+
+/**
+ * @brief Write a byte
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param data - Byte to write
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_write_byte(struct pmbus_dev *dev, int page, uint8_t cmd,
+		     uint8_t data)
+{
+	return pmbus_write_data(dev, page, cmd, &data, 1);
+}
+
+/**
+ * @brief Read a word
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param word - Address of the read word
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_read_word(struct pmbus_dev *dev, int page, uint8_t cmd,
+		    uint16_t *word)
+{
+	uint8_t buf[2];
+	int ret;
+
+	if (!word)
+		return -EINVAL;
+
+	ret = pmbus_read_data(dev, page, cmd, buf, 2);
+	if (ret)
+		return ret;
+
+	*word = no_os_get_unaligned_le16(buf);
+
+	return 0;
+}
+
+/**
+ * @brief Write a word
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param word - Word to write
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_write_word(struct pmbus_dev *dev, int page, uint8_t cmd,
+		     uint16_t word)
+{
+	uint8_t buf[2];
+
+	no_os_put_unaligned_le16(word, buf);
+
+	return pmbus_write_data(dev, page, cmd, buf, 2);
+}
+
+/**
+ * @brief Read a block. Bytes past the length reported by the device are
+ * cleared.
+ *
+ * @param dev - Device structure
+ * @param page - Page of the command, PMBUS_PAGE_NONE if not paged
+ * @param cmd - PMBus command
+ * @param data - Address of the read block
+ * @param nbytes - Size of the block in bytes
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_read_block(struct pmbus_dev *dev, int page, uint8_t cmd,
+		     uint8_t *data, uint32_t nbytes)
+{
+	struct no_os_i2c_msg msgs[2];
+	uint8_t rx[PMBUS_BLOCK_MAX + 2];
+	uint8_t count;
+	int ret;
+
+	if (!dev || !data || nbytes > PMBUS_BLOCK_MAX)
+		return -EINVAL;
+
+	ret = pmbus_set_page(dev, page);
+	if (ret)
+		return ret;
+
+	msgs[0] = (struct no_os_i2c_msg) {
+		.buff = &cmd, .bytes_number = 1
+	};
+	msgs[1] = (struct no_os_i2c_msg) {
+		.buff = rx, .bytes_number = nbytes + 1 + dev->pec_en, .read = 1
+	};
+	ret = pmbus_transfer(dev, msgs, 2);
+	if (ret)
+		return ret;
+
+	count = rx[0];
+	if (count > nbytes)
+		return -EMSGSIZE;
+
+	ret = pmbus_pec_check(dev, &cmd, 1, rx, count + 1);
+	if (ret)
+		return ret;
+
+	memcpy(data, &rx[1], count);
+	memset(&data[count], 0, nbytes - count);
+
+	return 0;
+}
+
+/**
+ * @brief Read a telemetry scan list. Every command is read on every page
+ * and the read word accesses are chained, up to chain_max of them, into
+ * combined transfers. The scan starts on the cached page and PAGE is
+ * written once per page, or not at all when PAGE_PLUS_READ is supported.
+ * A response with a bad PEC leaves its raw entry untouched, the scan goes
+ * on and -EBADMSG is returned at the end.
+ *
+ * @param dev - Device structure
+ * @param scan - Scan list
+ * @param raw - Raw words, nb_pages * nb_cmds entries, page major
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_scan(struct pmbus_dev *dev, const struct pmbus_scan *scan,
+	       uint16_t *raw)
+{
+	struct no_os_i2c_msg msgs[2 * PMBUS_CHAIN_MAX];
+	struct pmbus_frame frames[PMBUS_CHAIN_MAX];
+	uint8_t rx[PMBUS_CHAIN_MAX][4];
+	uint16_t *dst[PMBUS_CHAIN_MAX];
+	uint32_t i, j, n, total, chain, start = 0;
+	uint8_t page;
+	int ret, err = 0;
+
+	if (!dev || !scan || !scan->pages || !scan->cmds || !raw)
+		return -EINVAL;
+
+	chain = no_os_clamp(dev->chain_max, 1, PMBUS_CHAIN_MAX);
+	total = scan->nb_pages * scan->nb_cmds;
+
+	for (i = 0; i < scan->nb_pages; i++) {
+		if (scan->pages[i] == dev->page) {
+			start = i;
+			break;
+		}
+	}
+
+	n = 0;
+	for (i = 0; i < total; i++) {
+		j = (start + i / scan->nb_cmds) % scan->nb_pages;
+		page = scan->pages[j];
+		dst[n] = &raw[j * scan->nb_cmds + i % scan->nb_cmds];
+
+		ret = pmbus_frame_prepare(dev, page,
+					  scan->cmds[i % scan->nb_cmds], 0,
+					  true, &frames[n]);
+		if (ret)
+			return ret;
+
+		msgs[2 * n] = (struct no_os_i2c_msg) {
+			.buff = frames[n].buf, .bytes_number = frames[n].len
+		};
+		msgs[2 * n + 1] = (struct no_os_i2c_msg) {
+			.buff = rx[n],
+			.bytes_number = frames[n].plus + 2 + dev->pec_en,
+			.read = 1
+		};
+		n++;
+
+		/* Without PAGE_PLUS a chain can't cross a page boundary */
+		if (n < chain && i + 1 < total &&
+		    (dev->page_plus || (i + 1) % scan->nb_cmds))
+			continue;
+
+		ret = pmbus_transfer(dev, msgs, 2 * n);
+		if (ret)
+			return ret;
+
+		for (j = 0; j < n; j++) {
+			ret = pmbus_pec_check(dev, frames[j].buf, frames[j].len,
+					      rx[j], frames[j].plus + 2);
+			if (!ret && frames[j].plus && rx[j][0] != 2)
+				ret = -EIO;
+			if (ret) {
+				err = ret;
+				continue;
+			}
+
+			*dst[j] = no_os_get_unaligned_le16(
+					  &rx[j][frames[j].plus]);
+		}
+		n = 0;
+	}
+
+	return err;
+}
+
+/**
+ * @brief Write one command to several devices in a single PMBus GROUP
+ * COMMAND: the packets are separated by repeated starts and all devices
+ * execute them on the final stop. Paged commands use PAGE_PLUS_WRITE when
+ * supported, otherwise PAGE is written to each device beforehand, so a
+ * device can then only appear with a single page.
+ *
+ * @param cmds - Device packets
+ * @param nb_cmds - Number of device packets
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_group_command(struct pmbus_group_cmd *cmds, uint32_t nb_cmds)
+{
+	struct pmbus_frame frame;
+	uint8_t buf[sizeof(frame.buf) + PMBUS_BLOCK_MAX + 1];
+	struct pmbus_dev *dev;
+	uint32_t i, j, len;
+	int ret;
+
+	if (!cmds || !nb_cmds)
+		return -EINVAL;
+
+	for (i = 0; i < nb_cmds; i++) {
+		if (!cmds[i].dev || cmds[i].len > PMBUS_BLOCK_MAX ||
+		    (cmds[i].len && !cmds[i].data))
+			return -EINVAL;
+
+		if (cmds[i].dev->page_plus || cmds[i].page == PMBUS_PAGE_NONE)
+			continue;
+
+		for (j = 0; j < i; j++)
+			if (cmds[j].dev == cmds[i].dev &&
+			    cmds[j].page != cmds[i].page)
+				return -EINVAL;
+	}
+
+	/* PAGE writes can't be part of the group */
+	for (i = 0; i < nb_cmds; i++) {
+		if (cmds[i].dev->page_plus)
+			continue;
+
+		ret = pmbus_set_page(cmds[i].dev, cmds[i].page);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < nb_cmds; i++) {
+		dev = cmds[i].dev;
+
+		/* The page is already selected if PAGE_PLUS isn't supported */
+		ret = pmbus_frame_prepare(dev, cmds[i].page, cmds[i].cmd,
+					  cmds[i].len, false, &frame);
+		if (ret)
+			return ret;
+
+		memcpy(buf, frame.buf, frame.len);
+		if (cmds[i].len)
+			memcpy(&buf[frame.len], cmds[i].data, cmds[i].len);
+		len = frame.len + cmds[i].len;
+
+		if (dev->pec_en) {
+			buf[len] = pmbus_pec(dev->i2c_desc->slave_address,
+					     buf, len, NULL, 0);
+			len++;
+		}
+
+		ret = no_os_i2c_write(dev->i2c_desc, buf, len,
+				      i == nb_cmds - 1);
+		if (ret)
+			return ret;
+	}
+
+	cmds[nb_cmds - 1].dev->transfers++;
+
+	return 0;
+}
+
+/**
+ * @brief Convert LINEAR11 register data to a scaled value
+ *
+ * @param reg - LINEAR11 data to convert
+ * @param scale - Value scaling factor
+ * @param data - Address of the value
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_linear11_to_data(uint16_t reg, int scale, int *data)
+{
+	int val, exp;
+
+	if (!data)
+		return -EINVAL;
+
+	exp = PMBUS_LIN11_EXPONENT(reg);
+	val = PMBUS_LIN11_MANTISSA(reg) * scale;
+
+	if (exp >= 0)
+		*data = val << exp;
+	else
+		*data = val >> -exp;
+
+	return 0;
+}
+
+/**
+ * @brief Convert a scaled value to LINEAR11 register data
+ *
+ * @param data - Value to convert
+ * @param scale - Value scaling factor
+ * @param reg - Address of the register data
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_data_to_linear11(int data, int scale, uint16_t *reg)
+{
+	int exp = 0, mant;
+	bool negative = false;
+
+	if (!reg || scale <= 0)
+		return -EINVAL;
+
+	if (data < 0) {
+		negative = true;
+		data = -data;
+	}
+
+	/* If value too high, continuously do m/2 until m < 1023. */
+	while (data >= PMBUS_LIN11_MANTISSA_MAX * scale &&
+	       exp < PMBUS_LIN11_EXPONENT_MAX) {
+		exp++;
+		data >>= 1;
+	}
+
+	/* If value too low, increase mantissa. */
+	while (data < PMBUS_LIN11_MANTISSA_MIN * scale &&
+	       exp > PMBUS_LIN11_EXPONENT_MIN) {
+		exp--;
+		data <<= 1;
+	}
+
+	mant = no_os_clamp(NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale),
+			   0, 0x3FF);
+	if (negative)
+		mant = -mant;
+
+	*reg = no_os_field_prep(PMBUS_LIN11_MANTISSA_MSK, mant) |
+	       no_os_field_prep(PMBUS_LIN11_EXPONENT_MSK, exp);
+
+	return 0;
+}
+
+/**
+ * @brief Convert LINEAR16 register data to a scaled value
+ *
+ * @param reg - LINEAR16 mantissa to convert
+ * @param exp - Exponent, see pmbus_vout_mode_exp()
+ * @param scale - Value scaling factor
+ * @param data - Address of the value
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_linear16_to_data(uint16_t reg, int exp, int scale, int *data)
+{
+	int64_t val = (int64_t)reg * scale;
+
+	if (!data)
+		return -EINVAL;
+
+	if (exp >= 0)
+		*data = val << exp;
+	else
+		*data = val >> -exp;
+
+	return 0;
+}
+
+/**
+ * @brief Convert a scaled value to LINEAR16 register data
+ *
+ * @param data - Value to convert, has to be positive
+ * @param exp - Exponent, see pmbus_vout_mode_exp()
+ * @param scale - Value scaling factor
+ * @param reg - Address of the register data
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_data_to_linear16(int data, int exp, int scale, uint16_t *reg)
+{
+	int64_t val = data;
+
+	if (!reg || data <= 0 || scale <= 0)
+		return -EINVAL;
+
+	if (exp < 0)
+		val <<= -exp;
+	else
+		val >>= exp;
+
+	val = NO_OS_DIV_ROUND_CLOSEST_ULL(val, scale);
+	*reg = (uint16_t)no_os_clamp(val, 0, 0xFFFF);
+
+	return 0;
+}
+
+/**
+ * @brief Convert IEEE754 half precision register data to a scaled value
+ *
+ * @param reg - IEEE754 data to convert
+ * @param scale - Value scaling factor
+ * @param data - Address of the value
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_ieee754_to_data(uint16_t reg, int scale, int *data)
+{
+	int val;
+	int exponent;
+	bool sign;
+
+	if (!data)
+		return -EINVAL;
+
+	sign = no_os_field_get(PMBUS_IEEE754_SIGN_BIT, reg);
+	exponent = no_os_field_get(PMBUS_IEEE754_EXPONENT_MSK, reg);
+	val = no_os_field_get(PMBUS_IEEE754_MANTISSA_MSK, reg);
+
+	if (exponent == 0) {			/* subnormal */
+		exponent = -(14 + 10);
+	} else if (exponent == 0x1f) {		/* NaN, convert to min/max */
+		exponent = 0;
+		val = 65504;
+	} else {
+		exponent -= (15 + 10);		/* normal */
+		val |= 0x400;
+	}
+
+	val *= scale;
+
+	if (exponent >= 0)
+		val <<= exponent;
+	else
+		val >>= -exponent;
+
+	if (sign)
+		val = -val;
+
+	*data = val;
+
+	return 0;
+}
+
+/**
+ * @brief Convert a scaled value to IEEE754 half precision register data
+ *
+ * @param data - Value to convert
+ * @param scale - Value scaling factor
+ * @param reg - Address of the register data
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_data_to_ieee754(int data, int scale, uint16_t *reg)
+{
+	uint16_t exponent = (15 + 10);
+	uint16_t sign = 0;
+	int mantissa;
+
+	if (!reg || scale <= 0)
+		return -EINVAL;
+
+	/* simple case */
+	if (data == 0) {
+		*reg = 0;
+		return 0;
+	}
+
+	if (data < 0) {
+		sign = 1;
+		data = -data;
+	}
+
+	if (scale > (int)MILLI)
+		data = NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale / MILLI);
+	else
+		data *= (int)MILLI / scale;
+
+	/* Reduce large mantissa until it fits into 10 bit */
+	while ((data > PMBUS_IEEE754_MAX_MANTISSA * scale) && exponent < 30) {
+		exponent++;
+		data >>= 1;
+	}
+	/*
+	 * Increase small mantissa to generate valid 'normal'
+	 * number
+	 */
+	while ((data < PMBUS_IEEE754_MIN_MANTISSA * scale) && exponent > 1) {
+		exponent--;
+		data <<= 1;
+	}
+
+	/* Convert mantissa from scaled-units to units */
+	mantissa = NO_OS_DIV_ROUND_CLOSEST_ULL(data, scale);
+
+	mantissa = no_os_clamp(mantissa, PMBUS_IEEE754_MIN_MANTISSA,
+			       PMBUS_IEEE754_MAX_MANTISSA);
+
+	/* Convert to sign, 5 bit exponent, 10 bit mantissa */
+	*reg = no_os_field_prep(PMBUS_IEEE754_SIGN_BIT, sign) |
+	       no_os_field_prep(PMBUS_IEEE754_MANTISSA_MSK, mantissa) |
+	       no_os_field_prep(PMBUS_IEEE754_EXPONENT_MSK, exponent);
+
+	return 0;
+}
+
+/**
+ * @brief Get the LINEAR16 exponent from a VOUT_MODE value
+ *
+ * @param vout_mode - VOUT_MODE command value
+ * @return The signed 5 bit exponent
+ */
+int pmbus_vout_mode_exp(uint8_t vout_mode)
+{
+	return ((int8_t)(no_os_field_get(PMBUS_VOUT_MODE_EXP_MSK,
+					 vout_mode) << 3)) >> 3;
+}
+
+/**
+ * @brief Initialize the PMBus core
+ *
+ * @param dev - Device structure
+ * @param init_param - Initialization parameters
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_init(struct pmbus_dev **dev, struct pmbus_init_param *init_param)
+{
+	struct pmbus_dev *pmbus;
+	int ret;
+
+	if (!dev || !init_param)
+		return -EINVAL;
+
+	pmbus = (struct pmbus_dev *)no_os_calloc(1, sizeof(*pmbus));
+	if (!pmbus)
+		return -ENOMEM;
+
+	ret = no_os_i2c_init(&pmbus->i2c_desc, init_param->i2c_init);
+	if (ret) {
+		no_os_free(pmbus);
+		return ret;
+	}
+
+	pmbus->pec_en = init_param->pec_en;
+	pmbus->page_plus = init_param->page_plus;
+	pmbus->page_verify = init_param->page_verify;
+	pmbus->chain_max = init_param->chain_max;
+	pmbus_invalidate(pmbus);
+
+	*dev = pmbus;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated by pmbus_init()
+ *
+ * @param dev - Device structure
+ * @return 0 in case of success, negative error code otherwise
+ */
+int pmbus_remove(struct pmbus_dev *dev)
+{
+	int ret;
+
+	if (!dev)
+		return -EINVAL;
+
+	ret = no_os_i2c_remove(dev->i2c_desc);
+	if (ret)
+		return ret;
+
+	no_os_free(dev);
+
+	return 0;
+}
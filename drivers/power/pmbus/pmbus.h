@@ -0,0 +1,255 @@
+/***************************************************************************//**
+ *   @file   pmbus.h
+ *   @brief  Header file of the shared PMBus core
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef __PMBUS_H__
+#define __PMBUS_H__
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "no_os_util.h"
+#include "no_os_i2c.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Standard PMBus commands used by the core */
+#define PMBUS_PAGE				0x00
+#define PMBUS_OPERATION				0x01
+#define PMBUS_CLEAR_FAULTS			0x03
+#define PMBUS_PHASE				0x04
+#define PMBUS_PAGE_PLUS_WRITE			0x05
+#define PMBUS_PAGE_PLUS_READ			0x06
+#define PMBUS_VOUT_MODE				0x20
+#define PMBUS_VOUT_COMMAND			0x21
+#define PMBUS_STATUS_BYTE			0x78
+#define PMBUS_STATUS_WORD			0x79
+#define PMBUS_READ_VIN				0x88
+#define PMBUS_READ_IIN				0x89
+#define PMBUS_READ_VOUT				0x8B
+#define PMBUS_READ_IOUT				0x8C
+#define PMBUS_READ_TEMPERATURE_1		0x8D
+#define PMBUS_READ_POUT				0x96
+
+/* PAGE and PHASE values */
+#define PMBUS_PAGE_ALL				0xFF
+#define PMBUS_PHASE_ALL				0xFF
+/* Command is not paged, or the cached page/phase is not known */
+#define PMBUS_PAGE_NONE				-1
+
+#define PMBUS_CRC_POLYNOMIAL			0x07
+
+/* Maximum number of read word commands chained in one combined transfer */
+#define PMBUS_CHAIN_MAX				8
+/* Maximum SMBus block size */
+#define PMBUS_BLOCK_MAX				32
+
+/* LINEAR11 data format */
+#define PMBUS_LIN11_MANTISSA_MAX		1023L
+#define PMBUS_LIN11_MANTISSA_MIN		511L
+#define PMBUS_LIN11_EXPONENT_MAX		15
+#define PMBUS_LIN11_EXPONENT_MIN		-15
+#define PMBUS_LIN11_MANTISSA_MSK		NO_OS_GENMASK(10, 0)
+#define PMBUS_LIN11_EXPONENT_MSK		NO_OS_GENMASK(15, 11)
+#define PMBUS_LIN11_EXPONENT(x)			((int16_t)(x) >> 11)
+#define PMBUS_LIN11_MANTISSA(x)			\
+	(((int16_t)(((x) & 0x7FF) << 5)) >> 5)
+
+/* VOUT_MODE exponent for the LINEAR16 data format */
+#define PMBUS_VOUT_MODE_EXP_MSK			NO_OS_GENMASK(4, 0)
+
+/* IEEE754 half precision data format */
+#define PMBUS_IEEE754_SIGN_BIT			NO_OS_BIT(15)
+#define PMBUS_IEEE754_EXPONENT_MSK		NO_OS_GENMASK(14, 10)
+#define PMBUS_IEEE754_MANTISSA_MSK		NO_OS_GENMASK(9, 0)
+#define PMBUS_IEEE754_MAX_MANTISSA		0x7ff
+#define PMBUS_IEEE754_MIN_MANTISSA		0x400
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct pmbus_init_param
+ * @brief PMBus core initialization parameters
+ */
+struct pmbus_init_param {
+	/** I2C initialization parameters */
+	struct no_os_i2c_init_param *i2c_init;
+	/** Append and check a PEC byte on every transaction */
+	bool pec_en;
+	/** Device supports PAGE_PLUS_WRITE and PAGE_PLUS_READ */
+	bool page_plus;
+	/** Read back PAGE after every page change */
+	bool page_verify;
+	/**
+	 * Number of read word commands chained in one combined transfer by
+	 * pmbus_scan(), 0 or 1 for one command per transfer.
+	 */
+	uint8_t chain_max;
+};
+
+/**
+ * @struct pmbus_dev
+ * @brief PMBus core descriptor
+ */
+struct pmbus_dev {
+	/** I2C descriptor */
+	struct no_os_i2c_desc *i2c_desc;
+	bool pec_en;
+	bool page_plus;
+	bool page_verify;
+	uint8_t chain_max;
+	/** Cached PAGE, PMBUS_PAGE_NONE if not known */
+	int page;
+	/** Cached PHASE, PMBUS_PAGE_NONE if not known */
+	int phase;
+	/** Number of I2C transfers issued */
+	uint32_t transfers;
+	/** Number of responses dropped because of a PEC mismatch */
+	uint32_t pec_errors;
+};
+
+/**
+ * @struct pmbus_scan
+ * @brief Telemetry scan list: every command is read on every page, the
+ * results are stored page major (raw[page_idx * nb_cmds + cmd_idx]).
+ */
+struct pmbus_scan {
+	/** Pages to scan */
+	const uint8_t *pages;
+	uint8_t nb_pages;
+	/** Read word commands issued on each page */
+	const uint8_t *cmds;
+	uint8_t nb_cmds;
+};
+
+/**
+ * @struct pmbus_group_cmd
+ * @brief One device packet of a PMBus GROUP COMMAND
+ */
+struct pmbus_group_cmd {
+	/** Target device */
+	struct pmbus_dev *dev;
+	/** Page of the command, PMBUS_PAGE_NONE for unpaged commands */
+	int page;
+	uint8_t cmd;
+	/** Data bytes, least significant byte first */
+	const uint8_t *data;
+	uint8_t len;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize the PMBus core */
+int pmbus_init(struct pmbus_dev **dev, struct pmbus_init_param *init_param);
+
+/* Free the resources allocated by pmbus_init() */
+int pmbus_remove(struct pmbus_dev *dev);
+
+/* Compute the PEC of a transaction */
+uint8_t pmbus_pec(uint8_t addr, const uint8_t *wbuf, uint32_t wlen,
+		  const uint8_t *rbuf, uint32_t rlen);
+
+/* Select the page of the following commands, only written on change */
+int pmbus_set_page(struct pmbus_dev *dev, int page);
+
+/* Select the phase of the following commands, only written on change */
+int pmbus_set_phase(struct pmbus_dev *dev, int phase);
+
+/* Forget the cached page and phase, e.g. after a device reset */
+void pmbus_invalidate(struct pmbus_dev *dev);
+
+/* Send a command without data */
+int pmbus_send_byte(struct pmbus_dev *dev, int page, uint8_t cmd);
+
+/* Read a byte */
+int pmbus_read_byte(struct pmbus_dev *dev, int page, uint8_t cmd,
+		    uint8_t *data);
+
+/* Write a byte */
+int pmbus_write_byte(struct pmbus_dev *dev, int page, uint8_t cmd,
+		     uint8_t data);
+
+/* Read a word */
+int pmbus_read_word(struct pmbus_dev *dev, int page, uint8_t cmd,
+		    uint16_t *word);
+
+/* Write a word */
+int pmbus_write_word(struct pmbus_dev *dev, int page, uint8_t cmd,
+		     uint16_t word);
+
+/* Read a block */
+int pmbus_read_block(struct pmbus_dev *dev, int page, uint8_t cmd,
+		     uint8_t *data, uint32_t nbytes);
+
+/* Read a telemetry scan list with the least number of transfers */
+int pmbus_scan(struct pmbus_dev *dev, const struct pmbus_scan *scan,
+	       uint16_t *raw);
+
+/* Write one command to several devices in a single GROUP COMMAND */
+int pmbus_group_command(struct pmbus_group_cmd *cmds, uint32_t nb_cmds);
+
+/* Convert LINEAR11 register data to a scaled value */
+int pmbus_linear11_to_data(uint16_t reg, int scale, int *data);
+
+/* Convert a scaled value to LINEAR11 register data */
+int pmbus_data_to_linear11(int data, int scale, uint16_t *reg);
+
+/* Convert LINEAR16 register data to a scaled value */
+int pmbus_linear16_to_data(uint16_t reg, int exp, int scale, int *data);
+
+/* Convert a scaled value to LINEAR16 register data */
+int pmbus_data_to_linear16(int data, int exp, int scale, uint16_t *reg);
+
+/* Convert IEEE754 half precision register data to a scaled value */
+int pmbus_ieee754_to_data(uint16_t reg, int scale, int *data);
+
+/* Convert a scaled value to IEEE754 half precision register data */
+int pmbus_data_to_ieee754(int data, int scale, uint16_t *reg);
+
+/* Get the LINEAR16 exponent from a VOUT_MODE value */
+int pmbus_vout_mode_exp(uint8_t vout_mode);
+
+#endif /* __PMBUS_H__ */
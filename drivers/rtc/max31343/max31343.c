@@ -53,13 +53,12 @@
 int max31343_reg_read(struct max31343_dev *dev, uint8_t reg_addr,
 		      uint8_t *reg_data)
 {
-	int ret;
-
-	ret = no_os_i2c_write(dev->i2c_desc, &reg_addr, 1, 0);
-	if (ret)
-		return ret;
+	struct no_os_i2c_msg msgs[] = {
+		{ .buff = &reg_addr, .bytes_number = 1 },
+		{ .buff = reg_data, .bytes_number = 1, .read = 1 },
+	};
 
-	return no_os_i2c_read(dev->i2c_desc, reg_data, 1, 1);
+	return no_os_i2c_transfer(dev->i2c_desc, msgs, NO_OS_ARRAY_SIZE(msgs));
 }
 
 /**
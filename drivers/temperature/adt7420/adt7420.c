@@ -452,20 +452,21 @@ int adt7420_i2c_reg_read(struct adt7420_dev *dev, uint16_t register_address,
 			 uint16_t *data)
 {
 	uint8_t data_buffer[3] = { 0, 0 };
-	uint8_t num_bytes;
+	uint8_t reg = register_address;
+	struct no_os_i2c_msg msgs[] = {
+		{ .buff = &reg, .bytes_number = 1 },
+		{ .buff = data_buffer, .read = 1 },
+	};
 
 	if (no_os_field_get(ADT7320_L16, register_address))
-		num_bytes = 2;
+		msgs[1].bytes_number = 2;
 	else
-		num_bytes = 1;
+		msgs[1].bytes_number = 1;
 
-	if (no_os_i2c_write(dev->i2c_desc, &register_address, 1,
-			    0)) //add a repeat start
-		return -1;
-	if (no_os_i2c_read(dev->i2c_desc, data_buffer, num_bytes, 1))
+	if (no_os_i2c_transfer(dev->i2c_desc, msgs, NO_OS_ARRAY_SIZE(msgs)))
 		return -1;
 
-	if (num_bytes == 1)
+	if (msgs[1].bytes_number == 1)
 		*data = data_buffer[0];
 	else
 		*data = no_os_get_unaligned_be16(data_buffer);
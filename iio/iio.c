@@ -207,6 +207,19 @@ struct iio_trig_priv {
 	bool	triggered;
 };
 
+/**
+ * @struct iio_conn
+ * @brief Connection handled by iiod.
+ */
+struct iio_conn {
+	/** Id returned by iiod_conn_add */
+	uint32_t	id;
+	/** Set for network connections, whose socket can be polled */
+	bool		is_socket;
+	/** Connection instance (socket, UART descriptor or NULL) */
+	void		*conn;
+};
+
 struct iio_desc {
 	struct iiod_desc	*iiod;
 	struct iiod_ops		iiod_ops;
@@ -222,8 +235,14 @@ struct iio_desc {
 	struct no_os_uart_desc	*uart_desc;
 	int (*recv)(void *conn, uint8_t *buf, uint32_t len);
 	int (*send)(void *conn, uint8_t *buf, uint32_t len);
-	/* FIFO for socket descriptors */
-	struct no_os_circular_buffer	*conns;
+	/* Active connections */
+	struct iio_conn		*conns;
+	/* Number of active connections */
+	uint32_t		nb_conns;
+	/* Maximum number of connections (size of conns) */
+	uint32_t		max_conns;
+	/* Connection buffers released by closed connections, kept for reuse */
+	void			*free_bufs;
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
 	struct tcp_socket_desc	*current_sock;
 	/* Instance of server socket */
@@ -235,31 +254,57 @@ struct iio_desc {
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
-static inline int32_t _pop_conn(struct iio_desc *desc, uint32_t *conn_id)
+static inline int32_t _push_conn(struct iio_desc *desc, uint32_t conn_id,
+				 void *conn, bool is_socket)
 {
-	uint32_t size;
+	if (desc->nb_conns == desc->max_conns)
+		return -EBUSY;
 
-	no_os_cb_size(desc->conns, &size);
-	if (size < sizeof(uint32_t))
-		return -EAGAIN;
+	desc->conns[desc->nb_conns].id = conn_id;
+	desc->conns[desc->nb_conns].conn = conn;
+	desc->conns[desc->nb_conns].is_socket = is_socket;
+	desc->nb_conns++;
 
-	return no_os_cb_read(desc->conns, conn_id, sizeof(*conn_id));
+	return 0;
 }
 
-static inline int32_t _push_conn(struct iio_desc *desc, uint32_t conn_id)
+static inline void _del_conn(struct iio_desc *desc, uint32_t idx)
 {
-	return no_os_cb_write(desc->conns, &conn_id, sizeof(conn_id));
+	desc->conns[idx] = desc->conns[--desc->nb_conns];
 }
 
-static inline int32_t _nb_active_conns(struct iio_desc *desc)
+/*
+ * Connection buffers are recycled through a free list, the link to the next
+ * free buffer being stored in the first bytes of each buffer.
+ */
+static void *_get_conn_buf(struct iio_desc *desc)
 {
-	uint32_t size;
+	void *buf = desc->free_bufs;
 
-	no_os_cb_size(desc->conns, &size);
+	if (!buf)
+		return no_os_calloc(1, IIOD_CONN_BUFFER_SIZE);
+
+	desc->free_bufs = *(void **)buf;
+
+	return buf;
+}
 
-	return size / sizeof(uint32_t);
+static void _put_conn_buf(struct iio_desc *desc, void *buf)
+{
+	*(void **)buf = desc->free_bufs;
+	desc->free_bufs = buf;
 }
 
+static void _free_conn_bufs(struct iio_desc *desc)
+{
+	void *buf;
+
+	while (desc->free_bufs) {
+		buf = desc->free_bufs;
+		desc->free_bufs = *(void **)buf;
+		no_os_free(buf);
+	}
+}
 
 static int iio_recv(struct iiod_ctx *ctx, uint8_t *buf, uint32_t len)
 {
@@ -1450,8 +1495,14 @@ static int32_t accept_network_clients(struct iio_desc *desc)
 		if (NO_OS_IS_ERR_VALUE(ret))
 			return ret;
 
+		/* Refuse the client if the connection table is full */
+		if (desc->nb_conns == desc->max_conns) {
+			ret = -EBUSY;
+			goto close_socket;
+		}
+
 		data.conn = sock;
-		data.buf = no_os_calloc(1, IIOD_CONN_BUFFER_SIZE);
+		data.buf = _get_conn_buf(desc);
 		data.len = IIOD_CONN_BUFFER_SIZE;
 
 		if (!data.buf) {
@@ -1463,7 +1514,7 @@ static int32_t accept_network_clients(struct iio_desc *desc)
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto free_buf;
 
-		ret = _push_conn(desc, id);
+		ret = _push_conn(desc, id, sock, true);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto remove_conn;
 	} while (true);
@@ -1473,31 +1524,88 @@ static int32_t accept_network_clients(struct iio_desc *desc)
 remove_conn:
 	iiod_conn_remove(desc->iiod, id, &data);
 free_buf:
-	no_os_free(data.buf);
+	_put_conn_buf(desc, data.buf);
 close_socket:
 	socket_remove(sock);
 
 	return ret;
 }
+
+/**
+ * @brief Close a network connection and release its resources.
+ * @param desc - IIo descriptor
+ * @param idx - Index of the connection in desc->conns
+ */
+static void iio_close_network_conn(struct iio_desc *desc, uint32_t idx)
+{
+	struct iiod_conn_data data;
+
+	iiod_conn_remove(desc->iiod, desc->conns[idx].id, &data);
+	socket_remove(data.conn);
+	_put_conn_buf(desc, data.buf);
+	_del_conn(desc, idx);
+}
+#endif
+
+/**
+ * @brief Check if a connection has work to do.
+ *
+ * Connections in the middle of a command are always ready. Idle network
+ * connections are ready only when the client sent data.
+ * @param desc - IIo descriptor
+ * @param conn - Connection
+ * @return true if the connection must be stepped.
+ */
+static bool iio_conn_ready(struct iio_desc *desc, struct iio_conn *conn)
+{
+	if (!conn->is_socket || iiod_conn_is_busy(desc->iiod, conn->id))
+		return true;
+
+#if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
+	return socket_readable(conn->conn) != 0;
+#else
+	return true;
+#endif
+}
+
+/**
+ * @brief Cork a lwIP connection while it is stepped.
+ *
+ * A response is written in several pieces (value, newline, data). While
+ * corked they are queued in full segments, uncorking pushes them with a
+ * single tcp_output().
+ * @param conn - Connection
+ * @param cork - true before the step, false after it
+ */
+static void iio_conn_cork(struct iio_conn *conn, bool cork)
+{
+#if defined(NO_OS_LWIP_NETWORKING)
+	struct tcp_socket_desc *sock = conn->conn;
+
+	if (conn->is_socket)
+		lwip_socket_set_cork(sock->net->net, sock->id, cork);
 #endif
+}
 
 /**
  * @brief Execute an iio step
+ *
+ * Each connection with pending I/O is advanced once.
  * @param desc - IIo descriptor
  * @return 0 in case of success or negative value otherwise.
  */
 int iio_step(struct iio_desc *desc)
 {
-	struct iiod_conn_data data;
-	uint32_t conn_id;
+	uint32_t i;
 	int32_t ret;
+	bool stepped = false;
 
 	iio_process_async_triggers(desc);
 
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
 	if (desc->server) {
 		ret = accept_network_clients(desc);
-		if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN)
+		if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN && ret != -EBUSY)
 			return ret;
 #if defined(NO_OS_LWIP_NETWORKING)
 		no_os_lwip_step(desc->server->net->net, desc->server->net->net);
@@ -1505,287 +1613,462 @@ int iio_step(struct iio_desc *desc)
 	}
 #endif
 
-	ret = _pop_conn(desc, &conn_id);
-	if (NO_OS_IS_ERR_VALUE(ret))
-		return ret;
+	i = 0;
+	while (i < desc->nb_conns) {
+		if (!iio_conn_ready(desc, &desc->conns[i])) {
+			i++;
+			continue;
+		}
 
-	ret = iiod_conn_step(desc->iiod, conn_id);
-	if (ret == -ENOTCONN) {
+		stepped = true;
+		iio_conn_cork(&desc->conns[i], true);
+		ret = iiod_conn_step(desc->iiod, desc->conns[i].id);
+		iio_conn_cork(&desc->conns[i], false);
+		if (NO_OS_IS_ERR_VALUE(ret) && ret != -EAGAIN) {
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
-		iiod_conn_remove(desc->iiod, conn_id, &data);
-		socket_remove(data.conn);
-		no_os_free(data.buf);
+			/*
+			 * A client leaving (e.g. reset while a stream is sent)
+			 * only drops its own connection.
+			 */
+			if (desc->conns[i].is_socket) {
+				/* Last connection was moved at index i */
+				iio_close_network_conn(desc, i);
+				continue;
+			}
 #endif
-	} else {
-		_push_conn(desc, conn_id);
+			if (ret != -ENOTCONN)
+				return ret;
+		}
+		i++;
 	}
 
-	return ret;
+	return stepped ? 0 : -EAGAIN;
 }
 
-/**
- * @brief Add context attributes into xml string buffer.
- * @param desc - IIo descriptor.
- * @param buff - xml buffer.
- * @param buff_size - size of buffer
- * @return 0 in case of success or negative value otherwise.
+/*
+ * The context xml is split in pieces (header, one context attribute, one
+ * device tag, one channel, one attribute, ...) so that it can be generated
+ * either in a single buffer at init or in chunks while it is sent.
  */
-static uint32_t iio_add_ctx_attr_in_xml(struct iio_desc *desc, char *buff,
-					uint32_t buff_size)
-{
-	struct iio_ctx_attr *attr;
-	char dummy_buff[50];
-	int32_t i;
-	int32_t j;
-	int32_t n;
-
-	if ((int32_t)buff_size == -1)
-		n = 0;
-	else
-		n = buff_size;
-
-	if (buff == NULL)
-		/* Set dummy value for buff. It is used only for counting */
-		buff = dummy_buff;
-
-	i = 0;
-
-	attr = desc->ctx_attrs;
-	if (attr)
-		for (j = 0; j < (int32_t)desc->nb_ctx_attr; j++) {
-			i += snprintf(buff + i,
-				      no_os_max(n - i, 0),
-				      "<context-attribute name=\"%s\" ",
-				      attr[j].name);
-
-			i += snprintf(buff + i,
-				      no_os_max(n - i, 0),
-				      "value=\"%s\" />",
-				      attr[j].value);
-		}
+enum iio_xml_section {
+	IIO_XML_HEADER,
+	IIO_XML_CTX_ATTR,
+	IIO_XML_DEVICE,
+	IIO_XML_TRIGGER,
+	IIO_XML_FOOTER,
+	IIO_XML_DONE
+};
 
-	return i;
-}
+enum iio_xml_dev_part {
+	IIO_XML_DEV_HEAD,
+	IIO_XML_DEV_CH,
+	IIO_XML_DEV_ATTR,
+	IIO_XML_DEV_DEBUG_ATTR,
+	IIO_XML_DEV_REG_ACCESS,
+	IIO_XML_DEV_BUF_ATTR,
+	IIO_XML_DEV_END
+};
 
 /*
- * Generate an xml describing a device and write it to buff.
- * Will return the size of the xml.
+ * Generate the xml describing a channel and its attributes and write it to
+ * buff. Will return the size of the xml or a negative error code.
  * If buff_size is 0, no data will be written to buff, but size will be returned
  */
-static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
-					char *id, char *buff,
+static int32_t iio_generate_channel_xml(struct iio_channel *ch, char *buff,
 					uint32_t buff_size)
 {
-	struct iio_channel	*ch;
 	struct iio_attribute	*attr;
 	char			ch_id[50];
 	int32_t			i;
-	int32_t			j;
 	int32_t			k;
 	int32_t			n;
 
-	if ((int32_t)buff_size == -1)
-		n = 0;
-	else
-		n = buff_size;
-
+	n = buff_size;
 	if (buff == NULL)
 		/* Set dummy value for buff. It is used only for counting */
 		buff = ch_id;
 
 	i = 0;
 
+	_print_ch_id(ch_id, ch);
 	i += snprintf(buff + i, no_os_max(n - i, 0),
-		      "<device id=\"%s\" name=\"%s\">", id, name);
-
-	/* Write channels */
-	if (device->channels)
-		for (j = 0; j < device->num_ch; j++) {
-			ch = &device->channels[j];
-			_print_ch_id(ch_id, ch);
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<channel id=\"%s\"",
-				      ch_id);
-			if(ch->name)
-				i += snprintf(buff + i, no_os_max(n - i, 0),
-					      " name=\"%s\"",
-					      ch->name);
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      " type=\"%s\" >",
-				      ch->ch_out ? "output" : "input");
-
-			if (ch->scan_type)
-				i += snprintf(buff + i, no_os_max(n - i, 0),
-					      "<scan-element index=\"%d\""
-					      " format=\"%s:%c%d/%d>>%d\" />",
-					      ch->scan_index,
-					      ch->scan_type->is_big_endian ? "be" : "le",
-					      ch->scan_type->sign,
-					      ch->scan_type->realbits,
-					      ch->scan_type->storagebits,
-					      ch->scan_type->shift);
-
-			/* Write channel attributes */
-			if (ch->attributes)
-				for (k = 0; ch->attributes[k].name; k++) {
-					attr = &ch->attributes[k];
-					i += snprintf(buff + i, no_os_max(n - i, 0), "<attribute name=\"%s\" ",
+		      "<channel id=\"%s\"",
+		      ch_id);
+	if(ch->name)
+		i += snprintf(buff + i, no_os_max(n - i, 0),
+			      " name=\"%s\"",
+			      ch->name);
+	i += snprintf(buff + i, no_os_max(n - i, 0),
+		      " type=\"%s\" >",
+		      ch->ch_out ? "output" : "input");
+
+	if (ch->scan_type)
+		i += snprintf(buff + i, no_os_max(n - i, 0),
+			      "<scan-element index=\"%d\""
+			      " format=\"%s:%c%d/%d>>%d\" />",
+			      ch->scan_index,
+			      ch->scan_type->is_big_endian ? "be" : "le",
+			      ch->scan_type->sign,
+			      ch->scan_type->realbits,
+			      ch->scan_type->storagebits,
+			      ch->scan_type->shift);
+
+	/* Write channel attributes */
+	if (ch->attributes)
+		for (k = 0; ch->attributes[k].name; k++) {
+			attr = &ch->attributes[k];
+			i += snprintf(buff + i, no_os_max(n - i, 0), "<attribute name=\"%s\" ",
+				      attr->name);
+			if (ch->diferential) {
+				switch (attr->shared) {
+				case IIO_SHARED_BY_ALL:
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s\"",
 						      attr->name);
-					if (ch->diferential) {
-						switch (attr->shared) {
-						case IIO_SHARED_BY_ALL:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s\"",
-								      attr->name);
-							break;
-						case IIO_SHARED_BY_DIR:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      attr->name);
-							break;
-						case IIO_SHARED_BY_TYPE:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s-%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      iio_chan_type_string[ch->ch_type],
-								      iio_chan_type_string[ch->ch_type],
-								      attr->name);
-							break;
-						case IIO_SEPARATE:
-							if (!ch->indexed) {
-								// Differential channels must be indexed!
-								return -EINVAL;
-							}
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s%d-%s%d_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      iio_chan_type_string[ch->ch_type],
-								      ch->channel,
-								      iio_chan_type_string[ch->ch_type],
-								      ch->channel2,
-								      attr->name);
-							break;
-						}
-					} else {
-						switch (attr->shared) {
-						case IIO_SHARED_BY_ALL:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s\"",
-								      attr->name);
-							break;
-						case IIO_SHARED_BY_DIR:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      attr->name);
-							break;
-						case IIO_SHARED_BY_TYPE:
-							i += snprintf(buff + i, no_os_max(n - i, 0),
-								      "filename=\"%s_%s_%s\"",
-								      ch->ch_out ? "out" : "in",
-								      iio_chan_type_string[ch->ch_type],
-								      attr->name);
-							break;
-						case IIO_SEPARATE:
-							if (ch->indexed)
-								i += snprintf(buff + i, no_os_max(n - i, 0),
-									      "filename=\"%s_%s%d_%s\"",
-									      ch->ch_out ? "out" : "in",
-									      iio_chan_type_string[ch->ch_type],
-									      ch->channel,
-									      attr->name);
-							else
-								i += snprintf(buff + i, no_os_max(n - i, 0),
-									      "filename=\"%s_%s_%s\"",
-									      ch->ch_out ? "out" : "in",
-									      iio_chan_type_string[ch->ch_type],
-									      attr->name);
-							break;
-						}
+					break;
+				case IIO_SHARED_BY_DIR:
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s_%s\"",
+						      ch->ch_out ? "out" : "in",
+						      attr->name);
+					break;
+				case IIO_SHARED_BY_TYPE:
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s_%s-%s_%s\"",
+						      ch->ch_out ? "out" : "in",
+						      iio_chan_type_string[ch->ch_type],
+						      iio_chan_type_string[ch->ch_type],
+						      attr->name);
+					break;
+				case IIO_SEPARATE:
+					if (!ch->indexed) {
+						// Differential channels must be indexed!
+						return -EINVAL;
 					}
-					i += snprintf(buff + i, no_os_max(n - i, 0), " />");
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s_%s%d-%s%d_%s\"",
+						      ch->ch_out ? "out" : "in",
+						      iio_chan_type_string[ch->ch_type],
+						      ch->channel,
+						      iio_chan_type_string[ch->ch_type],
+						      ch->channel2,
+						      attr->name);
+					break;
 				}
+			} else {
+				switch (attr->shared) {
+				case IIO_SHARED_BY_ALL:
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s\"",
+						      attr->name);
+					break;
+				case IIO_SHARED_BY_DIR:
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s_%s\"",
+						      ch->ch_out ? "out" : "in",
+						      attr->name);
+					break;
+				case IIO_SHARED_BY_TYPE:
+					i += snprintf(buff + i, no_os_max(n - i, 0),
+						      "filename=\"%s_%s_%s\"",
+						      ch->ch_out ? "out" : "in",
+						      iio_chan_type_string[ch->ch_type],
+						      attr->name);
+					break;
+				case IIO_SEPARATE:
+					if (ch->indexed)
+						i += snprintf(buff + i, no_os_max(n - i, 0),
+							      "filename=\"%s_%s%d_%s\"",
+							      ch->ch_out ? "out" : "in",
+							      iio_chan_type_string[ch->ch_type],
+							      ch->channel,
+							      attr->name);
+					else
+						i += snprintf(buff + i, no_os_max(n - i, 0),
+							      "filename=\"%s_%s_%s\"",
+							      ch->ch_out ? "out" : "in",
+							      iio_chan_type_string[ch->ch_type],
+							      attr->name);
+					break;
+				}
+			}
+			i += snprintf(buff + i, no_os_max(n - i, 0), " />");
+		}
+
+	i += snprintf(buff + i, no_os_max(n - i, 0), "</channel>");
+
+	return i;
+}
+
+/**
+ * @brief Get the device (or trigger) described by the xml position.
+ * @param desc - IIO descriptor.
+ * @param pos - Position in the xml. Must be in a device or trigger section.
+ * @param dummy - Storage used to describe a trigger as a device.
+ * @param name - Where to store the device name.
+ * @param id - Where to store the device id.
+ * @return Device descriptor or NULL if pos is past the last device.
+ */
+static struct iio_device *iio_xml_get_dev(struct iio_desc *desc,
+		struct iiod_xml_pos *pos,
+		struct iio_device *dummy,
+		char **name, char **id)
+{
+	struct iio_trig_priv *trig;
+	struct iio_dev_priv *dev;
+
+	if (pos->section == IIO_XML_DEVICE) {
+		if (pos->idx >= desc->nb_devs)
+			return NULL;
+		dev = desc->devs + pos->idx;
+		*name = (char *)dev->name;
+		*id = dev->dev_id;
+
+		return dev->dev_descriptor;
+	}
+
+	if (pos->idx >= desc->nb_trigs)
+		return NULL;
+	trig = desc->trigs + pos->idx;
+	memset(dummy, 0, sizeof(*dummy));
+	dummy->attributes = trig->descriptor->attributes;
+	*name = trig->name;
+	*id = trig->id;
+
+	return dummy;
+}
+
+/**
+ * @brief Check whether a device part exists in the xml.
+ * @param dev - Device descriptor.
+ * @param part - Part of the device description.
+ * @param sub - Index inside the part.
+ * @return true if the piece exists, false otherwise.
+ */
+static bool iio_xml_dev_part_exists(struct iio_device *dev,
+				    enum iio_xml_dev_part part, uint32_t sub)
+{
+	switch (part) {
+	case IIO_XML_DEV_HEAD:
+	case IIO_XML_DEV_END:
+		return !sub;
+	case IIO_XML_DEV_CH:
+		return dev->channels && sub < (uint32_t)dev->num_ch;
+	case IIO_XML_DEV_ATTR:
+		return dev->attributes && dev->attributes[sub].name;
+	case IIO_XML_DEV_DEBUG_ATTR:
+		return dev->debug_attributes && dev->debug_attributes[sub].name;
+	case IIO_XML_DEV_REG_ACCESS:
+		return !sub && (dev->debug_reg_read || dev->debug_reg_write);
+	case IIO_XML_DEV_BUF_ATTR:
+		return dev->buffer_attributes && dev->buffer_attributes[sub].name;
+	default:
+		return false;
+	}
+}
 
-			i += snprintf(buff + i, no_os_max(n - i, 0), "</channel>");
+/**
+ * @brief Move the xml position forward until it points to an existing piece.
+ * @param desc - IIO descriptor.
+ * @param pos - Position in the xml.
+ */
+static void iio_xml_seek(struct iio_desc *desc, struct iiod_xml_pos *pos)
+{
+	struct iio_device dummy, *dev;
+	char *name, *id;
+
+	while (pos->section != IIO_XML_DONE) {
+		switch (pos->section) {
+		case IIO_XML_HEADER:
+		case IIO_XML_FOOTER:
+			if (!pos->idx)
+				return;
+			break;
+		case IIO_XML_CTX_ATTR:
+			if (desc->ctx_attrs && pos->idx < desc->nb_ctx_attr)
+				return;
+			break;
+		case IIO_XML_DEVICE:
+		case IIO_XML_TRIGGER:
+			dev = iio_xml_get_dev(desc, pos, &dummy, &name, &id);
+			if (!dev)
+				break;
+			if (iio_xml_dev_part_exists(dev, pos->part, pos->sub))
+				return;
+			pos->sub = 0;
+			if (++pos->part > IIO_XML_DEV_END) {
+				pos->part = IIO_XML_DEV_HEAD;
+				pos->idx++;
+			}
+			continue;
+		default:
+			return;
 		}
 
-	/* Write device attributes */
-	if (device->attributes)
-		for (j = 0; device->attributes[j].name; j++)
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<attribute name=\"%s\" />",
-				      device->attributes[j].name);
-
-	/* Write debug attributes */
-	if (device->debug_attributes)
-		for (j = 0; device->debug_attributes[j].name; j++)
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<debug-attribute name=\"%s\" />",
-				      device->debug_attributes[j].name);
-	if (device->debug_reg_read || device->debug_reg_write)
-		i += snprintf(buff + i, no_os_max(n - i, 0),
-			      "<debug-attribute name=\""REG_ACCESS_ATTRIBUTE"\" />");
+		pos->section++;
+		pos->idx = 0;
+		pos->part = IIO_XML_DEV_HEAD;
+		pos->sub = 0;
+	}
+}
 
-	/* Write buffer attributes */
-	if (device->buffer_attributes)
-		for (j = 0; device->buffer_attributes[j].name; j++)
-			i += snprintf(buff + i, no_os_max(n - i, 0),
-				      "<buffer-attribute name=\"%s\" />",
-				      device->buffer_attributes[j].name);
+/**
+ * @brief Move the xml position to the next piece.
+ * @param desc - IIO descriptor.
+ * @param pos - Position in the xml. Must point to an existing piece.
+ */
+static void iio_xml_advance(struct iio_desc *desc, struct iiod_xml_pos *pos)
+{
+	if (pos->section == IIO_XML_DEVICE || pos->section == IIO_XML_TRIGGER)
+		pos->sub++;
+	else
+		pos->idx++;
 
-	i += snprintf(buff + i, no_os_max(n - i, 0), "</device>");
+	iio_xml_seek(desc, pos);
+}
 
-	return i;
+/**
+ * @brief Write the xml piece pointed by pos to buff.
+ * @param desc - IIO descriptor.
+ * @param pos - Position in the xml. Must point to an existing piece.
+ * @param buff - xml buffer. Can be NULL if buff_size is 0.
+ * @param buff_size - size of buffer
+ * @return Size of the piece (as snprintf) or negative error code.
+ */
+static int32_t iio_xml_piece(struct iio_desc *desc, struct iiod_xml_pos *pos,
+			     char *buff, uint32_t buff_size)
+{
+	struct iio_ctx_attr *ctx_attr;
+	struct iio_device dummy, *dev;
+	char *name, *id;
+
+	switch (pos->section) {
+	case IIO_XML_HEADER:
+		return snprintf(buff, buff_size, "%s", header);
+	case IIO_XML_FOOTER:
+		return snprintf(buff, buff_size, "%s", header_end);
+	case IIO_XML_CTX_ATTR:
+		ctx_attr = &desc->ctx_attrs[pos->idx];
+		return snprintf(buff, buff_size,
+				"<context-attribute name=\"%s\" value=\"%s\" />",
+				ctx_attr->name, ctx_attr->value);
+	case IIO_XML_DEVICE:
+	case IIO_XML_TRIGGER:
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	dev = iio_xml_get_dev(desc, pos, &dummy, &name, &id);
+	if (!dev)
+		return -EINVAL;
+
+	switch (pos->part) {
+	case IIO_XML_DEV_HEAD:
+		return snprintf(buff, buff_size,
+				"<device id=\"%s\" name=\"%s\">", id, name);
+	case IIO_XML_DEV_CH:
+		return iio_generate_channel_xml(&dev->channels[pos->sub], buff,
+						buff_size);
+	case IIO_XML_DEV_ATTR:
+		return snprintf(buff, buff_size, "<attribute name=\"%s\" />",
+				dev->attributes[pos->sub].name);
+	case IIO_XML_DEV_DEBUG_ATTR:
+		return snprintf(buff, buff_size,
+				"<debug-attribute name=\"%s\" />",
+				dev->debug_attributes[pos->sub].name);
+	case IIO_XML_DEV_REG_ACCESS:
+		return snprintf(buff, buff_size,
+				"<debug-attribute name=\""REG_ACCESS_ATTRIBUTE"\" />");
+	case IIO_XML_DEV_BUF_ATTR:
+		return snprintf(buff, buff_size,
+				"<buffer-attribute name=\"%s\" />",
+				dev->buffer_attributes[pos->sub].name);
+	case IIO_XML_DEV_END:
+		return snprintf(buff, buff_size, "</device>");
+	default:
+		return -EINVAL;
+	}
 }
 
-static int32_t iio_init_xml(struct iio_desc *desc)
+/**
+ * @brief Write as many whole xml pieces as fit in buff, starting from pos.
+ * @param desc - IIO descriptor.
+ * @param pos - Position in the xml. Updated to the first piece not written.
+ * @param buff - xml buffer.
+ * @param buff_size - size of buffer
+ * @return Number of bytes written, 0 when the whole xml was generated or
+ * negative error code.
+ */
+static int32_t iio_xml_fill(struct iio_desc *desc, struct iiod_xml_pos *pos,
+			    char *buff, uint32_t buff_size)
 {
-	struct iio_dev_priv *dev;
-	struct iio_trig_priv *trig;
-	struct iio_device dummy = { 0 };
-	uint32_t i, size, of;
+	int32_t ret;
+	uint32_t i = 0;
 
-	/* -2 because of the 0 character */
-	size = sizeof(header) + sizeof(header_end) - 2;
-	size += iio_add_ctx_attr_in_xml(desc, NULL, -1);
-	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		size += iio_generate_device_xml(dev->dev_descriptor,
-						(char *)dev->name,
-						dev->dev_id, NULL, -1);
+	iio_xml_seek(desc, pos);
+	while (pos->section != IIO_XML_DONE) {
+		ret = iio_xml_piece(desc, pos, buff + i, buff_size - i);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		/* snprintf needs room for the terminating null character */
+		if ((uint32_t)ret >= buff_size - i) {
+			if (!i)
+				return -ENOBUFS;
+			break;
+		}
+
+		i += ret;
+		iio_xml_advance(desc, pos);
 	}
-	for (i = 0; i < desc->nb_trigs; i++) {
-		trig = desc->trigs + i;
-		dummy.attributes = trig->descriptor->attributes;
-		size += iio_generate_device_xml(&dummy, trig->name, trig->id,
-						NULL, -1);
+
+	return i;
+}
+
+static int iio_read_xml(struct iiod_ctx *ctx, struct iiod_xml_pos *pos,
+			char *buf, uint32_t len)
+{
+	return iio_xml_fill(ctx->instance, pos, buf, len);
+}
+
+/**
+ * @brief Compute the context xml size and, unless it is streamed, render it.
+ * @param desc - IIO descriptor.
+ * @param streaming - If set, the xml is generated in chunks on each PRINT.
+ * @return 0 in case of success or negative value otherwise.
+ */
+static int32_t iio_init_xml(struct iio_desc *desc, bool streaming)
+{
+	struct iiod_xml_pos pos = { 0 };
+	uint32_t size = 0;
+	int32_t ret;
+
+	iio_xml_seek(desc, &pos);
+	while (pos.section != IIO_XML_DONE) {
+		ret = iio_xml_piece(desc, &pos, NULL, 0);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+		size += ret;
+		iio_xml_advance(desc, &pos);
 	}
 
+	desc->xml_size = size;
+	if (streaming)
+		return 0;
+
 	desc->xml_desc = (char *)no_os_calloc(size + 1, sizeof(*desc->xml_desc));
 	if (!desc->xml_desc)
 		return -ENOMEM;
 
-	desc->xml_size = size;
-
-	strcpy(desc->xml_desc, header);
-	of = sizeof(header) - 1;
-	of += iio_add_ctx_attr_in_xml(desc, desc->xml_desc + of, size - of);
-	for (i = 0; i < desc->nb_devs; i++) {
-		dev = desc->devs + i;
-		of += iio_generate_device_xml(dev->dev_descriptor,
-					      (char *)dev->name, dev->dev_id,
-					      desc->xml_desc + of, size - of);
-	}
-	for (i = 0; i < desc->nb_trigs; i++) {
-		trig = desc->trigs + i;
-		dummy.attributes = trig->descriptor->attributes;
-		of += iio_generate_device_xml(&dummy, trig->name, trig->id,
-					      desc->xml_desc + of, size - of);
+	memset(&pos, 0, sizeof(pos));
+	ret = iio_xml_fill(desc, &pos, desc->xml_desc, size + 1);
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		no_os_free(desc->xml_desc);
+		desc->xml_desc = NULL;
+		return ret;
 	}
 
-	strcpy(desc->xml_desc + of, header_end);
-
 	return 0;
 }
 
@@ -1883,6 +2166,8 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 
 	ldesc->ctx_attrs = init_param->ctx_attrs;
 	ldesc->nb_ctx_attr = init_param->nb_ctx_attr;
+	ldesc->max_conns = init_param->max_conns ? init_param->max_conns :
+			   IIOD_MAX_CONNECTIONS;
 
 	ret = iio_init_trigs(ldesc, init_param->trigs, init_param->nb_trigs);
 	if (NO_OS_IS_ERR_VALUE(ret))
@@ -1892,7 +2177,7 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	if (NO_OS_IS_ERR_VALUE(ret))
 		goto free_desc;
 
-	ret = iio_init_xml(ldesc);
+	ret = iio_init_xml(ldesc, init_param->xml_streaming);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		goto free_trigs;
 
@@ -1911,21 +2196,27 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->send = iio_send;
 	ops->recv = iio_recv;
 	ops->set_buffers_count = iio_set_buffers_count;
+	ops->read_xml = iio_read_xml;
 
 	iiod_param.instance = ldesc;
 	iiod_param.ops = ops;
 	iiod_param.xml = ldesc->xml_desc;
 	iiod_param.xml_len = ldesc->xml_size;
+	iiod_param.zxml = init_param->compressed_xml;
+	iiod_param.zxml_len = init_param->compressed_xml_len;
 	iiod_param.phy_type = init_param->phy_type;
+	iiod_param.max_conns = ldesc->max_conns;
 
 	ret = iiod_init(&ldesc->iiod, &iiod_param);
 	if (NO_OS_IS_ERR_VALUE(ret))
 		goto free_xml;
 
-	ret = no_os_cb_init(&ldesc->conns,
-			    sizeof(uint32_t) * (IIOD_MAX_CONNECTIONS + 1));
-	if (NO_OS_IS_ERR_VALUE(ret))
+	ldesc->conns = (struct iio_conn *)no_os_calloc(ldesc->max_conns,
+			sizeof(*ldesc->conns));
+	if (!ldesc->conns) {
+		ret = -ENOMEM;
 		goto free_iiod;
+	}
 
 	if (init_param->phy_type == USE_UART) {
 		ldesc->send = (int (*)())no_os_uart_write;
@@ -1940,7 +2231,7 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 		ret = iiod_conn_add(ldesc->iiod, &data, &conn_id);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto free_conns;
-		_push_conn(ldesc, conn_id);
+		_push_conn(ldesc, conn_id, ldesc->uart_desc, false);
 	}
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
 	else if (init_param->phy_type == USE_NETWORK) {
@@ -1970,7 +2261,7 @@ int iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 		ret = iiod_conn_add(ldesc->iiod, &data, &conn_id);
 		if (NO_OS_IS_ERR_VALUE(ret))
 			goto free_conns;
-		_push_conn(ldesc, conn_id);
+		_push_conn(ldesc, conn_id, NULL, false);
 	} else {
 		ret = -EINVAL;
 		goto free_conns;
@@ -1985,7 +2276,7 @@ free_pylink:
 	socket_remove(ldesc->server);
 #endif
 free_conns:
-	no_os_cb_remove(ldesc->conns);
+	no_os_free(ldesc->conns);
 free_iiod:
 	iiod_remove(ldesc->iiod);
 free_xml:
@@ -2007,23 +2298,21 @@ free_desc:
  */
 int iio_remove(struct iio_desc *desc)
 {
-	struct iiod_conn_data data;
-	int ret;
-
 	if (!desc)
 		return -EINVAL;
 
 #if defined(NO_OS_NETWORKING) || defined(NO_OS_LWIP_NETWORKING)
-	for (int i = 0; i < IIOD_MAX_CONNECTIONS; i++) {
-		ret = iiod_conn_remove(desc->iiod, i, &data);
-		if (!ret) {
-			no_os_free(data.buf);
-			socket_remove(data.conn);
+	while (desc->nb_conns) {
+		if (desc->conns[desc->nb_conns - 1].is_socket) {
+			iio_close_network_conn(desc, desc->nb_conns - 1);
+			continue;
 		}
+		desc->nb_conns--;
 	}
 	socket_remove(desc->server);
 #endif
-	no_os_cb_remove(desc->conns);
+	_free_conn_bufs(desc);
+	no_os_free(desc->conns);
 	iiod_remove(desc->iiod);
 	no_os_free(desc->devs);
 	no_os_free(desc->trigs);
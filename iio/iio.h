@@ -122,6 +122,24 @@ struct iio_init_param {
 	uint32_t nb_devs;
 	struct iio_trigger_init *trigs;
 	uint32_t nb_trigs;
+	/*
+	 * If set, the context xml is not kept in memory. It is generated in
+	 * chunks straight into the connection buffer on each PRINT command.
+	 */
+	bool xml_streaming;
+	/*
+	 * Optional context xml compressed with zstd (e.g. generated at build
+	 * time), served to clients sending the ZPRINT command. If NULL, the
+	 * xml is compressed on the first ZPRINT and kept in RAM.
+	 */
+	const char *compressed_xml;
+	/* Size of compressed_xml in bytes */
+	uint32_t compressed_xml_len;
+	/*
+	 * Maximum number of simultaneous clients. If 0, IIOD_MAX_CONNECTIONS
+	 * is used. Clients above this limit are refused.
+	 */
+	uint32_t max_conns;
 };
 
 /******************************************************************************/
@@ -303,7 +303,7 @@ int iio_app_init(struct iio_app_desc **app,
 		 struct iio_app_init_param app_init_param)
 {
 	struct iio_device_init *iio_init_devs = NULL;
-	struct iio_init_param iio_init_param;
+	struct iio_init_param iio_init_param = { 0 };
 	struct no_os_uart_desc *uart_desc;
 	struct iio_app_desc *application;
 	struct iio_data_buffer *buff;
@@ -398,6 +398,10 @@ int iio_app_init(struct iio_app_desc **app,
 	iio_init_param.nb_trigs = app_init_param.nb_trigs;
 	iio_init_param.ctx_attrs = app_init_param.ctx_attrs;
 	iio_init_param.nb_ctx_attr = app_init_param.nb_ctx_attr;
+	iio_init_param.xml_streaming = app_init_param.xml_streaming;
+	iio_init_param.compressed_xml = app_init_param.compressed_xml;
+	iio_init_param.compressed_xml_len = app_init_param.compressed_xml_len;
+	iio_init_param.max_conns = app_init_param.max_conns;
 
 	status = iio_init(&application->iio_desc, &iio_init_param);
 	if(status < 0)
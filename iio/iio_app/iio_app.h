@@ -125,6 +125,14 @@ struct iio_app_init_param {
 	int (*post_step_callback)(void *arg);
 	/** Function parameteres */
 	void *arg;
+	/** Generate the context xml in chunks instead of keeping it in RAM */
+	bool xml_streaming;
+	/** zstd compressed context xml for ZPRINT, compressed on use if NULL */
+	const char *compressed_xml;
+	/** Size of the compressed context xml */
+	uint32_t compressed_xml_len;
+	/** Maximum number of simultaneous clients, 0 for the default */
+	uint32_t max_conns;
 
 #ifdef NO_OS_LWIP_NETWORKING
 	struct lwip_network_param lwip_param;
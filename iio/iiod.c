@@ -48,6 +48,8 @@
 
 #include "no_os_error.h"
 #include "no_os_util.h"
+#include "no_os_alloc.h"
+#include "no_os_zstd.h"
 
 #define SET_DUMMY_IF_NULL(func, dummy) ((func) ? (func) : (dummy))
 
@@ -65,6 +67,7 @@ static struct iiod_str cmds[] = {
 	[IIOD_CMD_HELP]		= IIOD_STR("HELP"),
 	[IIOD_CMD_EXIT]		= IIOD_STR("EXIT"),
 	[IIOD_CMD_PRINT]	= IIOD_STR("PRINT"),
+	[IIOD_CMD_ZPRINT]	= IIOD_STR("ZPRINT"),
 	[IIOD_CMD_VERSION]	= IIOD_STR("VERSION"),
 	[IIOD_CMD_TIMEOUT]	= IIOD_STR("TIMEOUT"),
 	[IIOD_CMD_OPEN]		= IIOD_STR("OPEN"),
@@ -75,11 +78,14 @@ static struct iiod_str cmds[] = {
 	[IIOD_CMD_WRITEBUF]	= IIOD_STR("WRITEBUF"),
 	[IIOD_CMD_GETTRIG]	= IIOD_STR("GETTRIG"),
 	[IIOD_CMD_SETTRIG]	= IIOD_STR("SETTRIG"),
-	[IIOD_CMD_SET]		= IIOD_STR("SET")
+	[IIOD_CMD_SET]		= IIOD_STR("SET"),
+	[IIOD_CMD_STREAM]	= IIOD_STR("STREAM"),
+	[IIOD_CMD_CREDIT]	= IIOD_STR("CREDIT")
 };
 static const uint32_t priority_array[] = {
 	/* Order not tested, just personal expectation. Function can
 	 * be improved, this improvement is chosen for simplicity */
+	IIOD_CMD_CREDIT,
 	IIOD_CMD_READBUF,
 	IIOD_CMD_WRITEBUF,
 	IIOD_CMD_READ,
@@ -87,13 +93,15 @@ static const uint32_t priority_array[] = {
 	IIOD_CMD_OPEN,
 	IIOD_CMD_CLOSE,
 	IIOD_CMD_PRINT,
+	IIOD_CMD_ZPRINT,
 	IIOD_CMD_EXIT,
 	IIOD_CMD_TIMEOUT,
 	IIOD_CMD_VERSION,
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
 	IIOD_CMD_HELP,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_STREAM
 };
 
 static_assert(NO_OS_ARRAY_SIZE(cmds) == NO_OS_ARRAY_SIZE(priority_array),
@@ -179,6 +187,34 @@ static int32_t iiod_parse_set(const char *token, struct comand_desc *res,
 	return parse_num(token, &res->count, 10);
 }
 
+static int32_t iiod_parse_stream(const char *token, struct comand_desc *res,
+				 char **ctx)
+{
+	int32_t ret;
+
+	if (!token)
+		return -EINVAL;
+
+	ret = parse_num(token, &res->bytes_count, 10);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	if (!res->bytes_count)
+		return -EINVAL;
+
+	/* Credits are optional, 0 means no flow control */
+	res->count = 0;
+	token = strtok_r(NULL, delim, ctx);
+	if (!token)
+		return 0;
+
+	ret = parse_num(token, &res->count, 10);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	return res->count ? 0 : -EINVAL;
+}
+
 static int32_t iiod_parse_rw_attr(const char *token, struct comand_desc *res,
 				  char **ctx)
 {
@@ -245,14 +281,22 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 	case IIOD_CMD_HELP:
 	case IIOD_CMD_EXIT:
 	case IIOD_CMD_PRINT:
+	case IIOD_CMD_ZPRINT:
 	case IIOD_CMD_VERSION:
 		return 0;
 	case IIOD_CMD_TIMEOUT:
 		return parse_num(token, &res->timeout, 10);
+	case IIOD_CMD_CREDIT:
+		if (!token)
+			return -EINVAL;
+		return parse_num(token, &res->count, 10);
 	default:
 		break;
 	}
 
+	if (!token)
+		return -EINVAL;
+
 	strncpy(res->device, token, sizeof(res->device));
 	token = strtok_r(NULL, delim, ctx);
 	switch (res->cmd) {
@@ -276,6 +320,8 @@ int32_t iiod_parse_line(char *buf, struct comand_desc *res, char **ctx)
 		return 0;
 	case IIOD_CMD_SET:
 		return iiod_parse_set(token, res, ctx);
+	case IIOD_CMD_STREAM:
+		return iiod_parse_stream(token, res, ctx);
 	default:
 		break;
 	}
@@ -346,6 +392,8 @@ int32_t iiod_copy_ops(struct iiod_ops *ops, struct iiod_ops *new_ops)
 					       dummy_close);
 	ops->push_buffer = SET_DUMMY_IF_NULL(new_ops->push_buffer,
 					     dummy_close);
+	/* Optional, only used when no xml is provided */
+	ops->read_xml = new_ops->read_xml;
 
 	return 0;
 }
@@ -358,21 +406,28 @@ int32_t iiod_init(struct iiod_desc **desc, struct iiod_init_param *param)
 	if (!desc || !param || !param->ops)
 		return -EINVAL;
 
-	ldesc = (struct iiod_desc *)calloc(1, sizeof(*ldesc));
+	if (!param->xml && !param->ops->read_xml)
+		return -EINVAL;
+
+	ldesc = (struct iiod_desc *)no_os_calloc(1, sizeof(*ldesc));
 	if (!ldesc)
 		return -ENOMEM;
 
 	ret = iiod_copy_ops(&ldesc->ops, param->ops);
 	if (NO_OS_IS_ERR_VALUE(ret)) {
-		free(ldesc);
+		no_os_free(ldesc);
 
 		return ret;
 	}
 
 	ldesc->xml = param->xml;
 	ldesc->xml_len = param->xml_len;
+	ldesc->zxml = param->zxml;
+	ldesc->zxml_len = param->zxml_len;
 	ldesc->app_instance = param->instance;
 	ldesc->phy_type = param->phy_type;
+	ldesc->max_conns = param->max_conns ? param->max_conns :
+			   IIOD_MAX_CONNECTIONS;
 
 	*desc = ldesc;
 
@@ -381,7 +436,16 @@ int32_t iiod_init(struct iiod_desc **desc, struct iiod_init_param *param)
 
 void iiod_remove(struct iiod_desc *desc)
 {
-	free(desc);
+	uint32_t i;
+
+	if (!desc)
+		return;
+
+	for (i = 0; i < desc->nb_conns; i++)
+		no_os_free(desc->conns[i]);
+	no_os_free(desc->conns);
+	no_os_free(desc->zxml_buf);
+	no_os_free(desc);
 }
 
 static void conn_clean_state(struct iiod_conn_priv *conn)
@@ -393,47 +457,90 @@ static void conn_clean_state(struct iiod_conn_priv *conn)
 	conn->res.buf.buf = NULL;
 	conn->res.buf.idx = 0;
 	conn->parser_idx = 0;
+	conn->xml_pending = false;
 	conn->state = IIOD_READING_LINE;
 }
 
+/*
+ * Double the size of the connection table, without exceeding max_conns.
+ * Connection ids are indexes in the table so they remain valid. The table
+ * holds pointers, the connections themselves don't move since they point
+ * into their own buffers.
+ */
+static int32_t iiod_grow_conns(struct iiod_desc *desc)
+{
+	struct iiod_conn_priv **conns;
+	uint32_t n;
+
+	if (desc->nb_conns >= desc->max_conns)
+		return -EBUSY;
+
+	n = no_os_min(no_os_max(desc->nb_conns * 2, 1U), desc->max_conns);
+	conns = (struct iiod_conn_priv **)no_os_calloc(n, sizeof(*conns));
+	if (!conns)
+		return -ENOMEM;
+
+	if (desc->conns)
+		memcpy(conns, desc->conns, desc->nb_conns * sizeof(*conns));
+	no_os_free(desc->conns);
+	desc->conns = conns;
+	desc->nb_conns = n;
+
+	return 0;
+}
+
 int32_t iiod_conn_add(struct iiod_desc *desc, struct iiod_conn_data *data,
 		      uint32_t *new_conn_id)
 {
 	uint32_t i;
 	struct iiod_conn_priv *conn;
+	int32_t ret;
 
 	if (!desc || !new_conn_id)
 		return -EINVAL;
 
-	for (i = 0; i < IIOD_MAX_CONNECTIONS; ++i)
-		if (!desc->conns[i].used) {
-			conn = &desc->conns[i];
-			memset(conn, 0, sizeof(*conn));
-			conn->used = 1;
-			conn->conn = data->conn;
-			/*
-			 * TODO in future:
-			 * think of using other buffer (e.g. ciruclar_buffer)
-			 * to somehow implement zero copy
-			 */
-			conn->payload_buf = data->buf;
-			conn->payload_buf_len = data->len;
-			*new_conn_id = i;
+	for (i = 0; i < desc->nb_conns; ++i)
+		if (!desc->conns[i] || !desc->conns[i]->used)
+			break;
 
-			return 0;
-		}
+	if (i == desc->nb_conns) {
+		ret = iiod_grow_conns(desc);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	/* Allocated on first use, then reused */
+	if (!desc->conns[i]) {
+		desc->conns[i] = (struct iiod_conn_priv *)no_os_calloc(1,
+				 sizeof(*desc->conns[i]));
+		if (!desc->conns[i])
+			return -ENOMEM;
+	}
+
+	conn = desc->conns[i];
+	memset(conn, 0, sizeof(*conn));
+	conn->used = 1;
+	conn->conn = data->conn;
+	/*
+	 * TODO in future:
+	 * think of using other buffer (e.g. ciruclar_buffer)
+	 * to somehow implement zero copy
+	 */
+	conn->payload_buf = data->buf;
+	conn->payload_buf_len = data->len;
+	*new_conn_id = i;
 
-	return -EBUSY;
+	return 0;
 }
 
 int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 			 struct iiod_conn_data *data)
 {
-	if (!desc || conn_id > IIOD_MAX_CONNECTIONS ||
-	    !desc->conns[conn_id].used)
+	if (!desc || conn_id >= desc->nb_conns ||
+	    !desc->conns[conn_id] || !desc->conns[conn_id]->used)
 		return -EINVAL;
 	struct iiod_conn_priv *conn;
-	conn = &desc->conns[conn_id];
+	conn = desc->conns[conn_id];
 	data->conn = conn->conn;
 	data->len = conn->payload_buf_len;
 	data->buf = conn->payload_buf;
@@ -442,6 +549,15 @@ int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 	return 0;
 }
 
+bool iiod_conn_is_busy(struct iiod_desc *desc, uint32_t conn_id)
+{
+	if (!desc || conn_id >= desc->nb_conns ||
+	    !desc->conns[conn_id] || !desc->conns[conn_id]->used)
+		return false;
+
+	return desc->conns[conn_id]->state != IIOD_READING_LINE;
+}
+
 static int32_t call_op(struct iiod_ops *ops, struct comand_desc *data,
 		       struct iiod_ctx *ctx)
 {
@@ -537,6 +653,117 @@ static int32_t do_read_buff_delayed(struct iiod_desc *desc,
 	return 0;
 }
 
+static int32_t iiod_read_line(struct iiod_desc *desc,
+			      struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = {
+		.instance = desc->app_instance,
+		.conn = conn->conn
+	};
+	int32_t ret;
+	char *ch;
+
+	while (conn->parser_idx < IIOD_PARSER_MAX_BUF_SIZE - 1) {
+		ch = conn->parser_buf + conn->parser_idx;
+		ret = desc->ops.recv(&ctx,(uint8_t *)ch, 1);
+		if (ret == -EAGAIN || ret == 0)
+			return -EAGAIN;
+
+		if (NO_OS_IS_ERR_VALUE(ret))
+			goto end;
+
+		if (conn->parser_idx == 0 && (*ch == '\n' || *ch == '\r'))
+			continue ;
+
+		++conn->parser_idx;
+		if (*ch == '\n') {
+			conn->parser_buf[conn->parser_idx] = '\0';
+			ret = 0;
+			goto end;
+		}
+	}
+
+	ret = -EIO;
+end:
+	conn->parser_idx = 0;
+	return ret;
+}
+
+/*
+ * Send the blocks requested with STREAM as soon as the device provides data.
+ * Returns -EAGAIN while streaming and 0 when a CLOSE was received between
+ * two blocks, in which case the close is run as a normal command.
+ */
+static int32_t do_stream_buff(struct iiod_desc *desc,
+			      struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	struct comand_desc data;
+	uint32_t len;
+	int32_t ret;
+
+	if (!conn->nb_buf.len && conn->stream_left == conn->cmd_data.bytes_count) {
+		/* Between two blocks. Check for credits or close from client */
+		ret = iiod_read_line(desc, conn);
+		if (ret == 0) {
+			memset(&data, 0, sizeof(data));
+			ret = iiod_parse_line(conn->parser_buf, &data,
+					      &conn->strtok_ctx);
+			if (ret == 0 && data.cmd == IIOD_CMD_CLOSE) {
+				conn->cmd_data = data;
+				conn->state = IIOD_RUNNING_CMD;
+
+				return 0;
+			}
+			/* All other commands are ignored while streaming */
+			if (ret == 0 && data.cmd == IIOD_CMD_CREDIT)
+				conn->stream_credits += data.count;
+		} else if (ret != -EAGAIN) {
+			return ret;
+		}
+
+		if (!conn->stream_unlimited && !conn->stream_credits)
+			return -EAGAIN;
+	}
+
+	if (!conn->nb_buf.len) {
+		conn->nb_buf.buf = conn->payload_buf;
+		conn->nb_buf.idx = 0;
+		len = no_os_min(conn->payload_buf_len, conn->stream_left);
+		ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
+					    conn->nb_buf.buf, len);
+		if (ret == -EAGAIN) {
+			/* Buffer was drained. Start next acquisition */
+			ret = desc->ops.refill_buffer(&ctx,
+						      conn->cmd_data.device);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+
+			ret = desc->ops.read_buffer(&ctx, conn->cmd_data.device,
+						    conn->nb_buf.buf, len);
+		}
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		conn->nb_buf.len = ret;
+		conn->stream_left -= ret;
+	}
+
+	ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+	if (NO_OS_IS_ERR_VALUE(ret))
+		return ret;
+
+	conn->nb_buf.len = 0;
+	if (!conn->stream_left) {
+		conn->stream_left = conn->cmd_data.bytes_count;
+		if (!conn->stream_unlimited)
+			conn->stream_credits--;
+	}
+
+	/* Let other connections run between chunks */
+	return -EAGAIN;
+}
+
 static int32_t do_read_buff(struct iiod_desc *desc, struct iiod_conn_priv *conn)
 {
 	struct iiod_ctx ctx;
@@ -611,6 +838,93 @@ static int32_t do_write_buff(struct iiod_desc *desc,
 	return 0;
 }
 
+/*
+ * Generate the xml in chunks in the connection buffer and send them without
+ * blocking. Returns -EAGAIN while there is still data to be sent.
+ */
+static int32_t do_write_xml(struct iiod_desc *desc, struct iiod_conn_priv *conn)
+{
+	struct iiod_ctx ctx = IIOD_CTX(desc, conn);
+	int32_t ret;
+
+	do {
+		if (conn->nb_buf.idx == conn->nb_buf.len) {
+			ret = desc->ops.read_xml(&ctx, &conn->xml_pos,
+						 conn->payload_buf,
+						 conn->payload_buf_len);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				return ret;
+
+			conn->nb_buf.buf = conn->payload_buf;
+			conn->nb_buf.len = ret;
+			conn->nb_buf.idx = 0;
+			/* Whole xml was sent */
+			if (!ret)
+				return rw_iiod_buff(desc, conn, &conn->nb_buf,
+						    IIOD_ENDL);
+		}
+
+		ret = rw_iiod_buff(desc, conn, &conn->nb_buf, IIOD_WR);
+	} while (!ret);
+
+	return ret;
+}
+
+/*
+ * Compress the xml on the first ZPRINT and keep the result for the next ones.
+ * A streamed xml is generated in a temporary buffer for the compression.
+ */
+static int32_t iiod_compress_xml(struct iiod_desc *desc, struct iiod_ctx *ctx)
+{
+	struct iiod_xml_pos pos = { 0 };
+	uint32_t size = NO_OS_ZSTD_BOUND(desc->xml_len);
+	char *xml = desc->xml;
+	uint32_t len = 0;
+	char *zxml, *tmp;
+	int32_t ret;
+
+	if (!xml) {
+		xml = (char *)no_os_malloc(desc->xml_len + 1);
+		if (!xml)
+			return -ENOMEM;
+
+		do {
+			ret = desc->ops.read_xml(ctx, &pos, xml + len,
+						 desc->xml_len + 1 - len);
+			if (NO_OS_IS_ERR_VALUE(ret))
+				goto free_xml;
+			len += ret;
+		} while (ret);
+	}
+
+	zxml = (char *)no_os_malloc(size);
+	if (!zxml) {
+		ret = -ENOMEM;
+		goto free_xml;
+	}
+
+	ret = no_os_zstd_compress(xml, desc->xml_len, zxml, size);
+	if (NO_OS_IS_ERR_VALUE(ret)) {
+		no_os_free(zxml);
+		goto free_xml;
+	}
+
+	/* Give back the unused part of the worst case buffer */
+	tmp = (char *)no_os_realloc(zxml, ret);
+	if (tmp)
+		zxml = tmp;
+
+	desc->zxml_buf = zxml;
+	desc->zxml = zxml;
+	desc->zxml_len = ret;
+	ret = 0;
+free_xml:
+	if (xml != desc->xml)
+		no_os_free(xml);
+
+	return ret;
+}
+
 static int32_t iiod_run_cmd(struct iiod_desc *desc,
 			    struct iiod_conn_priv *conn)
 {
@@ -649,9 +963,28 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	case IIOD_CMD_PRINT:
 		conn->res.val = desc->xml_len;
 		conn->res.write_val = 1;
+		if (!desc->xml) {
+			/* Sent in chunks in IIOD_WRITING_XML state */
+			memset(&conn->xml_pos, 0, sizeof(conn->xml_pos));
+			conn->xml_pending = true;
+			break;
+		}
 		conn->res.buf.buf = desc->xml;
 		conn->res.buf.len = desc->xml_len;
 		break;
+	case IIOD_CMD_ZPRINT:
+		conn->res.write_val = 1;
+		if (!desc->zxml) {
+			ret = iiod_compress_xml(desc, &ctx);
+			if (NO_OS_IS_ERR_VALUE(ret)) {
+				conn->res.val = ret;
+				break;
+			}
+		}
+		conn->res.val = desc->zxml_len;
+		conn->res.buf.buf = (char *)desc->zxml;
+		conn->res.buf.len = desc->zxml_len;
+		break;
 	case IIOD_CMD_VERSION:
 		conn->res.buf.buf = IIOD_VERSION;
 		conn->res.buf.len = IIOD_VERSION_LEN;
@@ -698,6 +1031,19 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 		conn->res.val = data->bytes_count;
 		conn->res.write_val = 1;
 		break;
+	case IIOD_CMD_STREAM:
+		/* Data is acquired later, in IIOD_STREAMING_BUF state */
+		conn->res.write_val = 1;
+		conn->res.val = data->bytes_count;
+		ret = snprintf(conn->buf_mask, 10, "%08"PRIx32, conn->mask);
+		conn->res.buf.buf = conn->buf_mask;
+		conn->res.buf.len = ret;
+		break;
+	case IIOD_CMD_CREDIT:
+		/* Only valid while streaming */
+		conn->res.write_val = 1;
+		conn->res.val = -EINVAL;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -705,42 +1051,6 @@ static int32_t iiod_run_cmd(struct iiod_desc *desc,
 	return 0;
 }
 
-static int32_t iiod_read_line(struct iiod_desc *desc,
-			      struct iiod_conn_priv *conn)
-{
-	struct iiod_ctx ctx = {
-		.instance = desc->app_instance,
-		.conn = conn->conn
-	};
-	int32_t ret;
-	char *ch;
-
-	while (conn->parser_idx < IIOD_PARSER_MAX_BUF_SIZE - 1) {
-		ch = conn->parser_buf + conn->parser_idx;
-		ret = desc->ops.recv(&ctx,(uint8_t *)ch, 1);
-		if (ret == -EAGAIN || ret == 0)
-			return -EAGAIN;
-
-		if (NO_OS_IS_ERR_VALUE(ret))
-			goto end;
-
-		if (conn->parser_idx == 0 && (*ch == '\n' || *ch == '\r'))
-			continue ;
-
-		++conn->parser_idx;
-		if (*ch == '\n') {
-			conn->parser_buf[conn->parser_idx] = '\0';
-			ret = 0;
-			goto end;
-		}
-	}
-
-	ret = -EIO;
-end:
-	conn->parser_idx = 0;
-	return ret;
-}
-
 /*
  * Function will return SUCCESS when a state was processed.
  * If a state is still in processing state, it will return -EAGAIN.
@@ -818,8 +1128,22 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 				return ret;
 		}
 
-		if (conn->cmd_data.cmd != IIOD_CMD_READBUF &&
-		    conn->cmd_data.cmd != IIOD_CMD_WRITEBUF) {
+		if (conn->xml_pending) {
+			memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+			conn->state = IIOD_WRITING_XML;
+		} else if (conn->cmd_data.cmd == IIOD_CMD_STREAM) {
+			if ((int32_t)conn->res.val < 0) {
+				conn->state = IIOD_LINE_DONE;
+				return 0;
+			}
+			/* Prepare for IIOD_STREAMING_BUF state */
+			memset(&conn->nb_buf, 0, sizeof(conn->nb_buf));
+			conn->stream_left = conn->cmd_data.bytes_count;
+			conn->stream_credits = conn->cmd_data.count;
+			conn->stream_unlimited = !conn->cmd_data.count;
+			conn->state = IIOD_STREAMING_BUF;
+		} else if (conn->cmd_data.cmd != IIOD_CMD_READBUF &&
+			   conn->cmd_data.cmd != IIOD_CMD_WRITEBUF) {
 			if (conn->is_cyclic_buffer && conn->cmd_data.cmd != IIOD_CMD_OPEN)
 				conn->state = IIOD_PUSH_CYCLIC_BUFFER;
 			else
@@ -901,6 +1225,20 @@ static int32_t iiod_run_state(struct iiod_desc *desc,
 			conn->is_cyclic_buffer = false;
 		}
 		return 0;
+	case IIOD_STREAMING_BUF:
+		return do_stream_buff(desc, conn);
+	case IIOD_WRITING_XML:
+		ret = do_write_xml(desc, conn);
+		if (NO_OS_IS_ERR_VALUE(ret))
+			return ret;
+
+		conn->xml_pending = false;
+		if (conn->is_cyclic_buffer)
+			conn->state = IIOD_PUSH_CYCLIC_BUFFER;
+		else
+			conn->state = IIOD_LINE_DONE;
+
+		return 0;
 
 	default:
 		/* Should never get here */
@@ -913,11 +1251,11 @@ int32_t iiod_conn_step(struct iiod_desc *desc, uint32_t conn_id)
 	struct iiod_conn_priv *conn;
 	int32_t ret;
 
-	if (!desc || conn_id > IIOD_MAX_CONNECTIONS ||
-	    !desc->conns[conn_id].used)
+	if (!desc || conn_id >= desc->nb_conns ||
+	    !desc->conns[conn_id] || !desc->conns[conn_id]->used)
 		return -EINVAL;
 
-	conn = &desc->conns[conn_id];
+	conn = desc->conns[conn_id];
 	do {
 		ret = iiod_run_state(desc, conn);
 		if (ret == -EAGAIN)
@@ -45,7 +45,7 @@
 
 #include "iio.h"
 
-/* Maximum nomber of iiod connections to allocate simultaneously */
+/* Default maximum number of iiod connections to handle simultaneously */
 #define IIOD_MAX_CONNECTIONS	10
 #define IIOD_VERSION		"1.1.0000000"
 #define IIOD_VERSION_LEN	(sizeof(IIOD_VERSION) - 1)
@@ -81,6 +81,14 @@ struct iiod_ctx {
 	void *conn;
 };
 
+/* Position in the context xml while it is generated in chunks */
+struct iiod_xml_pos {
+	uint32_t section;
+	uint32_t idx;
+	uint32_t part;
+	uint32_t sub;
+};
+
 struct iiod_conn_data {
 	/* Value to be used in iiod_ctx */
 	void *conn;
@@ -154,6 +162,15 @@ struct iiod_ops {
 	/* I don't know what this should be used for :) */
 	int (*set_buffers_count)(struct iiod_ctx *ctx, const char *device,
 				 uint32_t buffers_count);
+
+	/*
+	 * Optional. Used when iiod_init_param.xml is NULL to generate the xml
+	 * in chunks. pos is zeroed before the first call and must be updated
+	 * by the callback. Must return the number of bytes written in buf and
+	 * 0 when the whole xml was generated.
+	 */
+	int (*read_xml)(struct iiod_ctx *ctx, struct iiod_xml_pos *pos,
+			char *buf, uint32_t len);
 };
 
 /*
@@ -174,6 +191,19 @@ struct iiod_init_param {
 	char *xml;
 	/* Size of xml in bytes */
 	uint32_t xml_len;
+	/*
+	 * Maximum number of simultaneous connections. The connection table
+	 * is grown on demand up to this value. If 0, IIOD_MAX_CONNECTIONS
+	 * is used.
+	 */
+	uint32_t max_conns;
+	/*
+	 * Optional compressed xml to be sent on ZPRINT. If NULL, the xml is
+	 * compressed on the first ZPRINT.
+	 */
+	const char *zxml;
+	/* Size of zxml in bytes */
+	uint32_t zxml_len;
 	/* Backend used by IIOD */
 	enum physical_link_type phy_type;
 };
@@ -194,5 +224,10 @@ int32_t iiod_conn_remove(struct iiod_desc *desc, uint32_t conn_id,
 			 struct iiod_conn_data *data);
 /* Advance in the state machine of a connection. Will not block */
 int32_t iiod_conn_step(struct iiod_desc *desc, uint32_t conn_id);
+/*
+ * Return true if the connection is in the middle of a command and must be
+ * stepped even if no new data was received from the client.
+ */
+bool iiod_conn_is_busy(struct iiod_desc *desc, uint32_t conn_id);
 
 #endif //IIOD_H
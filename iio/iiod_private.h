@@ -62,11 +62,20 @@ struct iiod_str {
 /*
  * Commads are the ones documented int the link:
  * https://wiki.analog.com/resources/tools-software/linux-software/libiio_internals#the_network_backend_and_iio_daemon
+ *
+ * STREAM and CREDIT are no-OS extensions for continuous capture:
+ * - "STREAM <device> <block_bytes> [credits]" is answered like READBUF
+ *   (block size and mask) and then blocks of block_bytes are sent as soon
+ *   as they are acquired, without any other request from the client.
+ * - Each block consumes one credit. "CREDIT <n>" grants n more blocks. If
+ *   credits are not specified in STREAM, the flow is not limited.
+ * - "CLOSE <device>" ends the stream once the block in progress was sent.
  */
 enum iiod_cmd {
 	IIOD_CMD_HELP,
 	IIOD_CMD_EXIT,
 	IIOD_CMD_PRINT,
+	IIOD_CMD_ZPRINT,
 	IIOD_CMD_VERSION,
 	IIOD_CMD_TIMEOUT,
 	IIOD_CMD_OPEN,
@@ -77,7 +86,9 @@ enum iiod_cmd {
 	IIOD_CMD_WRITEBUF,
 	IIOD_CMD_GETTRIG,
 	IIOD_CMD_SETTRIG,
-	IIOD_CMD_SET
+	IIOD_CMD_SET,
+	IIOD_CMD_STREAM,
+	IIOD_CMD_CREDIT
 };
 
 /*
@@ -142,6 +153,10 @@ struct iiod_conn_priv {
 		IIOD_LINE_DONE,
 		/* Pushing  cyclic buffer until IIO device is closed  */
 		IIOD_PUSH_CYCLIC_BUFFER,
+		/* Generating and sending the xml in chunks for PRINT cmd */
+		IIOD_WRITING_XML,
+		/* Sending buffer blocks continuously for STREAM cmd */
+		IIOD_STREAMING_BUF,
 	} state;
 
 	/* Buffer to store received line */
@@ -163,12 +178,26 @@ struct iiod_conn_priv {
 	char *strtok_ctx;
 	/* True if the device was open with cyclic buffer flag */
 	bool is_cyclic_buffer;
+	/* Set when the xml must be generated in chunks after the PRINT result */
+	bool xml_pending;
+	/* Position in the xml while it is generated in chunks */
+	struct iiod_xml_pos xml_pos;
+	/* Bytes of the current STREAM block still to be sent */
+	uint32_t stream_left;
+	/* Blocks the client accepts before sending more credits */
+	uint32_t stream_credits;
+	/* Set when STREAM was opened without credits (no flow control) */
+	bool stream_unlimited;
 };
 
 /* Private iiod information */
 struct iiod_desc {
-	/* Pool of iiod connections */
-	struct iiod_conn_priv conns[IIOD_MAX_CONNECTIONS];
+	/* Pool of iiod connections. Grown on demand up to max_conns */
+	struct iiod_conn_priv **conns;
+	/* Number of allocated entries in conns */
+	uint32_t nb_conns;
+	/* Maximum number of connections */
+	uint32_t max_conns;
 	/* Application operations */
 	struct iiod_ops ops;
 	/* Application instance */
@@ -177,6 +206,12 @@ struct iiod_desc {
 	char *xml;
 	/* XML length in bytes */
 	uint32_t xml_len;
+	/* Address of compressed xml */
+	const char *zxml;
+	/* Compressed XML length in bytes */
+	uint32_t zxml_len;
+	/* Compressed XML generated on the first ZPRINT, owned by iiod */
+	char *zxml_buf;
 	/* Backend used by IIOD */
 	enum physical_link_type phy_type;
 };
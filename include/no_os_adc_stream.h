@@ -0,0 +1,184 @@
+/***************************************************************************//**
+ *   @file   no_os_adc_stream.h
+ *   @brief  DRDY driven continuous-read streaming engine for sigma-delta ADCs.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_ADC_STREAM_H_
+#define _NO_OS_ADC_STREAM_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "no_os_spi.h"
+#include "no_os_irq.h"
+#include "no_os_circular_buffer.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Maximum number of command bytes clocked out at the start of a frame */
+#define NO_OS_ADC_STREAM_CMD_MAX	4
+/* Maximum size of a conversion frame, command included */
+#define NO_OS_ADC_STREAM_FRAME_MAX	8
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Decode a block of raw frames.
+ * @param dev - Device the frames were read from.
+ * @param frames - nb_frames frames of frame_size bytes each.
+ * @param frame_size - Size of a frame, command bytes included.
+ * @param nb_frames - Number of frames in the block.
+ * @param samples - Output, one 32 bit sample for each valid frame.
+ * @return Number of valid samples stored in samples (frames failing the
+ * CRC or status check are dropped), negative error code otherwise.
+ */
+typedef int32_t (*no_os_adc_stream_decode_t)(void *dev, const uint8_t *frames,
+		uint8_t frame_size,
+		uint32_t nb_frames,
+		uint32_t *samples);
+
+/**
+ * @struct no_os_adc_stream_init_param
+ * @brief Streaming engine initialization parameters.
+ */
+struct no_os_adc_stream_init_param {
+	/** SPI descriptor of the converter */
+	struct no_os_spi_desc *spi_desc;
+	/** Interrupt controller the DRDY line is connected to */
+	struct no_os_irq_ctrl_desc *irq_ctrl;
+	/** DRDY interrupt ID (GPIO number for GPIO interrupt controllers) */
+	uint32_t drdy_irq;
+	/** DRDY active edge, usually NO_OS_IRQ_EDGE_FALLING */
+	enum no_os_irq_trig_level drdy_trig;
+	/** Bytes sent at the start of each frame (e.g. data register read) */
+	uint8_t cmd[NO_OS_ADC_STREAM_CMD_MAX];
+	/** Number of command bytes, 0 in continuous read mode */
+	uint8_t cmd_size;
+	/** Size of a frame, command bytes included */
+	uint8_t frame_size;
+	/** Number of frames in each half of the double buffer */
+	uint32_t block_size;
+	/** Read the frames with no_os_spi_transfer_dma_async() */
+	bool dma;
+	/** Device passed to decode */
+	void *dev;
+	/** Block decoder provided by the converter driver */
+	no_os_adc_stream_decode_t decode;
+	/** Destination of the decoded samples (e.g. an IIO buffer) */
+	struct no_os_circular_buffer *sink;
+};
+
+/**
+ * @struct no_os_adc_stream_stats
+ * @brief Streaming statistics.
+ */
+struct no_os_adc_stream_stats {
+	/** Frames read from the converter */
+	uint32_t frames;
+	/** Frames dropped by the decoder (CRC or status errors) */
+	uint32_t invalid;
+	/** Conversions skipped because both halves were waiting for decode */
+	uint32_t dropped;
+	/** Blocks decoded and pushed to the sink */
+	uint32_t blocks;
+};
+
+/**
+ * @struct no_os_adc_stream_desc
+ * @brief Streaming engine descriptor.
+ */
+struct no_os_adc_stream_desc {
+	struct no_os_spi_desc *spi_desc;
+	struct no_os_irq_ctrl_desc *irq_ctrl;
+	uint32_t drdy_irq;
+	struct no_os_callback_desc irq_cb;
+	uint8_t cmd[NO_OS_ADC_STREAM_CMD_MAX];
+	uint8_t cmd_size;
+	uint8_t frame_size;
+	uint32_t block_size;
+	bool dma;
+	void *dev;
+	no_os_adc_stream_decode_t decode;
+	struct no_os_circular_buffer *sink;
+	/** Double buffer, block_size frames in each half */
+	uint8_t *frames[2];
+	/** Decoded samples of one block */
+	uint32_t *samples;
+	/** Transfer of the frame in flight */
+	struct no_os_spi_msg msg;
+	/** Half being filled from the DRDY interrupt */
+	volatile uint8_t active;
+	/** Frames already read in the active half */
+	volatile uint32_t fill;
+	/** Set when a half is full and waits to be decoded */
+	volatile bool ready[2];
+	/** Next half to be decoded */
+	uint8_t next;
+	volatile bool running;
+	struct no_os_adc_stream_stats stats;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate the double buffer and register the DRDY handler. */
+int no_os_adc_stream_init(struct no_os_adc_stream_desc **desc,
+			  struct no_os_adc_stream_init_param *param);
+/* Stop the stream and free the resources. */
+int no_os_adc_stream_remove(struct no_os_adc_stream_desc *desc);
+
+/* Enable the DRDY interrupt, the converter must already be converting. */
+int no_os_adc_stream_start(struct no_os_adc_stream_desc *desc);
+/* Disable the DRDY interrupt, the partially filled block is dropped. */
+int no_os_adc_stream_stop(struct no_os_adc_stream_desc *desc);
+
+/* Decode the completed blocks and push them to the sink. */
+int no_os_adc_stream_process(struct no_os_adc_stream_desc *desc);
+
+/* Get the streaming statistics and optionally clear them. */
+int no_os_adc_stream_stats_get(struct no_os_adc_stream_desc *desc,
+			       struct no_os_adc_stream_stats *stats,
+			       bool clear);
+
+#endif // _NO_OS_ADC_STREAM_H_
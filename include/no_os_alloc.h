@@ -41,6 +41,91 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Maximum number of block size classes */
+#define NO_OS_ALLOC_MAX_POOLS	8
+
+/* Alignment of the pool blocks and of the arena allocations */
+#define NO_OS_ALLOC_ALIGN	8
+
+/**
+ * @struct no_os_alloc_pool_param
+ * @brief Size class of fixed blocks.
+ */
+struct no_os_alloc_pool_param {
+	/** Size of a block, in bytes (rounded up to NO_OS_ALLOC_ALIGN) */
+	uint32_t block_size;
+	/** Number of blocks of the class */
+	uint32_t nb_blocks;
+};
+
+/**
+ * @struct no_os_alloc_init_param
+ * @brief Memory handed to the deterministic allocator.
+ *
+ * The pools are carved at the start of the memory, the arena gets the rest.
+ * Until no_os_alloc_seal() is called, allocations come from the arena, which
+ * is meant for the descriptors created at init time. After sealing, only the
+ * pools are used and a request they cannot serve fails.
+ *
+ * The allocator is used through no_os_alloc_malloc(), no_os_alloc_calloc(),
+ * no_os_alloc_realloc() and no_os_alloc_free(). no_os_malloc(),
+ * no_os_calloc(), no_os_realloc() and no_os_free() are only routed to it when
+ * the project is built with NO_OS_ALLOC_POOLS (NO_OS_ALLOC_POOLS = y in the
+ * project Makefile).
+ */
+struct no_os_alloc_init_param {
+	/** Backing memory, aligned to NO_OS_ALLOC_ALIGN */
+	void *mem;
+	/** Size of the backing memory, in bytes */
+	uint32_t mem_size;
+	/** Size classes, in increasing block size order */
+	const struct no_os_alloc_pool_param *pools;
+	/** Number of size classes */
+	uint32_t nb_pools;
+	/**
+	 * Lock serializing the allocator calls, NULL if not needed. It must
+	 * not allocate, e.g. no_os_mutex_lock() on a mutex created beforehand.
+	 */
+	void (*lock)(void *ctx);
+	/** Release the lock, NULL if lock is NULL */
+	void (*unlock)(void *ctx);
+	/** Argument of lock and unlock */
+	void *lock_ctx;
+	/**
+	 * Called, outside the lock, with the size of every request that fails
+	 * after no_os_alloc_seal(), e.g. to assert or to log the failure. NULL
+	 * to only count the failures.
+	 */
+	void (*seal_failure)(size_t size);
+};
+
+/**
+ * @struct no_os_alloc_stats
+ * @brief Usage of a pool, or of the arena (in bytes, block_size is 1).
+ *
+ * The failures of the arena count all the requests that could not be served,
+ * the failures of a pool the ones that found all the fitting classes empty.
+ */
+struct no_os_alloc_stats {
+	/** Size of a block */
+	uint32_t block_size;
+	/** Number of blocks */
+	uint32_t nb_blocks;
+	/** Blocks currently allocated */
+	uint32_t used;
+	/** Maximum number of blocks allocated at the same time */
+	uint32_t high_water;
+	/** Requests that could not be served */
+	uint32_t failures;
+	/**
+	 * Arena only: frees of an allocation other than the last one, the
+	 * memory is not given back
+	 */
+	uint32_t invalid_frees;
+};
 
 /* Allocate memory and return a pointer to it */
 void *no_os_malloc(size_t size);
@@ -48,8 +133,39 @@ void *no_os_malloc(size_t size);
 /* Allocate memory and return a pointer to it, set memory to 0 */
 void *no_os_calloc(size_t nitems, size_t size);
 
+/* Change the size of memory allocated by no_os_malloc or no_os_calloc */
+void *no_os_realloc(void *ptr, size_t size);
+
 /* Deallocate memory previously allocated by a call to no_os_calloc or
  * no_os_malloc */
 void no_os_free(void *ptr);
 
+/* Serve no_os_alloc_malloc/no_os_alloc_calloc from fixed-block pools and a
+ * bump arena */
+int no_os_alloc_init(const struct no_os_alloc_init_param *param);
+
+/* Go back to the libc allocator, fails if pool blocks are still in use */
+int no_os_alloc_remove(void);
+
+/* Close the arena, only the pools serve the allocations from now on */
+void no_os_alloc_seal(void);
+
+/* Get the statistics of a pool */
+int no_os_alloc_pool_stats(uint32_t pool, struct no_os_alloc_stats *stats);
+
+/* Get the statistics of the arena */
+int no_os_alloc_arena_stats(struct no_os_alloc_stats *stats);
+
+/* Allocate from the pools or the arena, from libc before the init */
+void *no_os_alloc_malloc(size_t size);
+
+/* Allocate zeroed memory from the pools or the arena */
+void *no_os_alloc_calloc(size_t nitems, size_t size);
+
+/* Resize memory allocated by no_os_alloc_malloc or no_os_alloc_calloc */
+void *no_os_alloc_realloc(void *ptr, size_t size);
+
+/* Give back memory allocated by no_os_alloc_malloc or no_os_alloc_calloc */
+void no_os_alloc_free(void *ptr);
+
 #endif // _NO_OS_ALLOC_H_
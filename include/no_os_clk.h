@@ -43,6 +43,17 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/*
+ * Keep the last rate read from or written to the clock. Only set it for clocks
+ * whose rate can't change behind the back of the framework, or call
+ * no_os_clk_invalidate() when it does.
+ */
+#define NO_OS_CLK_CACHE_RATE	0x1
 
 /******************************************************************************/
 /************************* Structure Declarations *****************************/
@@ -56,6 +67,10 @@ struct no_os_clk_init_param {
 	const struct no_os_clk_platform_ops *platform_ops;
 	/**  CLK hardware device descriptor */
 	void		*dev_desc;
+	/** Optional parent clock */
+	struct no_os_clk_desc *parent;
+	/** NO_OS_CLK_* flags */
+	uint32_t	flags;
 };
 
 struct no_os_clk_hw {
@@ -74,6 +89,21 @@ struct no_os_clk {
 	const struct no_os_clk_desc *clk_desc;
 };
 
+/**
+ * @struct no_os_clk_stats
+ * @brief Device accesses done and avoided by the framework for a clock.
+ */
+struct no_os_clk_stats {
+	/** clk_recalc_rate calls */
+	uint32_t	hw_reads;
+	/** Rates returned from the cache */
+	uint32_t	cached_reads;
+	/** clk_set_rate calls, or clocks programmed through clk_set_rates */
+	uint32_t	hw_writes;
+	/** Rate changes skipped because the clock already had the rate */
+	uint32_t	skipped_writes;
+};
+
 /**
  * @struct no_os_clk_desc
  * @brief Structure holding CLK descriptor.
@@ -87,6 +117,19 @@ typedef struct no_os_clk_desc {
 	const struct no_os_clk_platform_ops *platform_ops;
 	/**  CLK hardware device descriptor */
 	void		*dev_desc;
+	/** Parent clock, NULL for a root clock */
+	struct no_os_clk_desc *parent;
+	/** First child clock */
+	struct no_os_clk_desc *child;
+	/** Next clock with the same parent */
+	struct no_os_clk_desc *sibling;
+	/** NO_OS_CLK_* flags */
+	uint32_t	flags;
+	/** Cached rate, valid if rate_valid is set */
+	uint64_t	rate;
+	bool		rate_valid;
+	/** Access statistics */
+	struct no_os_clk_stats stats;
 } no_os_clk_desc;
 
 /**
@@ -107,6 +150,12 @@ struct no_os_clk_platform_ops {
 	int (*clk_round_rate)(struct no_os_clk_desc *, uint64_t, uint64_t *);
 	/* Change CLK frequency function pointer. */
 	int (*clk_set_rate)(struct no_os_clk_desc *, uint64_t);
+	/*
+	 * Optional, change the frequency of several clocks of the same device
+	 * in one pass.
+	 */
+	int (*clk_set_rates)(struct no_os_clk_desc **, const uint64_t *,
+			     uint32_t);
 	/** CLK remove function pointer */
 	int (*remove)(struct no_os_clk_desc *);
 };
@@ -141,4 +190,24 @@ int32_t no_os_clk_round_rate(struct no_os_clk_desc *desc,
 int32_t no_os_clk_set_rate(struct no_os_clk_desc *desc,
 			   uint64_t rate);
 
+/* Change the frequency of several clocks, parents first. */
+int32_t no_os_clk_set_rates(struct no_os_clk_desc **descs,
+			    const uint64_t *rates,
+			    uint32_t nb_clks);
+
+/* Get the parent of the clock. */
+struct no_os_clk_desc *no_os_clk_get_parent(struct no_os_clk_desc *desc);
+
+/* Attach the clock to a new parent, NULL to make it a root clock. */
+int32_t no_os_clk_set_parent(struct no_os_clk_desc *desc,
+			     struct no_os_clk_desc *parent);
+
+/* Drop the cached rate of the clock and of all its descendants. */
+void no_os_clk_invalidate(struct no_os_clk_desc *desc);
+
+/* Read and optionally clear the access statistics of the clock. */
+int32_t no_os_clk_get_stats(struct no_os_clk_desc *desc,
+			    struct no_os_clk_stats *stats,
+			    bool clear);
+
 #endif // _NO_OS_CLK_H_
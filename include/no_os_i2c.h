@@ -80,6 +80,20 @@ struct no_os_i2c_init_param {
 	void		*extra;
 };
 
+/**
+ * @struct no_os_i2c_msg
+ * @brief Message of a combined I2C transfer. Consecutive messages are
+ * separated by a repeated start, a stop is generated after the last one.
+ */
+struct no_os_i2c_msg {
+	/** Buffer with the data to write or where to store the read data */
+	uint8_t		*buff;
+	/** Number of bytes to transfer */
+	uint32_t	bytes_number;
+	/** Set to read from the slave, clear to write to it */
+	uint8_t		read;
+};
+
 /**
  * @struct no_os_i2cbus_desc
  * @brief Structure holding I2C bus descriptor
@@ -134,6 +148,9 @@ struct no_os_i2c_platform_ops {
 	int32_t (*i2c_ops_read)(struct no_os_i2c_desc *, uint8_t *, uint8_t, uint8_t);
 	/** i2c remove function pointer */
 	int32_t (*i2c_ops_remove)(struct no_os_i2c_desc *);
+	/** i2c combined transfer function pointer */
+	int32_t (*i2c_ops_transfer)(struct no_os_i2c_desc *,
+				    struct no_os_i2c_msg *, uint32_t);
 };
 
 /******************************************************************************/
@@ -159,6 +176,11 @@ int32_t no_os_i2c_read(struct no_os_i2c_desc *desc,
 		       uint8_t bytes_number,
 		       uint8_t stop_bit);
 
+/* Send a list of messages separated by repeated starts. */
+int32_t no_os_i2c_transfer(struct no_os_i2c_desc *desc,
+			   struct no_os_i2c_msg *msgs,
+			   uint32_t len);
+
 /* Initialize I2C bus descriptor*/
 int32_t no_os_i2cbus_init(const struct no_os_i2c_init_param *param);
 
@@ -0,0 +1,130 @@
+/***************************************************************************//**
+ *   @file   no_os_irq_table.h
+ *   @brief  Constant time IRQ callback dispatch table.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_IRQ_TABLE_H_
+#define _NO_OS_IRQ_TABLE_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "no_os_irq.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_irq_slot
+ * @brief Callback registered for one (event, peripheral instance) pair.
+ *
+ * The callback is published last with release semantics and cleared first on
+ * unregister, so an interrupt handler preempting the (un)register call either
+ * sees a free slot or a complete one.
+ */
+struct no_os_irq_slot {
+	/** Interrupt id the callback was registered for */
+	uint32_t irq_id;
+	/** Platform specific peripheral handle */
+	void *handle;
+	/** Parameter passed to the callback */
+	void *ctx;
+	/** Callback, NULL when the slot is free */
+	void (*_Atomic callback)(void *context);
+	/** Number of dispatched interrupts */
+	uint32_t count;
+	/** Worst case dispatch time, in get_ticks() units */
+	uint32_t max_ticks;
+};
+
+/**
+ * @struct no_os_irq_table
+ * @brief Statically sized table of nb_events rows of nb_slots entries.
+ *
+ * The table covers the events first_event to first_event + nb_events - 1,
+ * a platform usually has one table per peripheral type, e.g. the three UART
+ * events by UART instance or the DMA events by channel.
+ */
+struct no_os_irq_table {
+	/** Storage of nb_events * nb_slots slots, provided by the platform */
+	struct no_os_irq_slot *slots;
+	/** Event of the first row */
+	uint32_t first_event;
+	/** Number of rows, one for each event */
+	uint32_t nb_events;
+	/** Number of peripheral instances per event */
+	uint32_t nb_slots;
+	/** Optional free running counter used to measure the dispatch time */
+	uint32_t (*get_ticks)(void);
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Get the slot of (event, slot), NULL if out of the table. */
+struct no_os_irq_slot *no_os_irq_table_get(struct no_os_irq_table *table,
+		uint32_t event, uint32_t slot);
+
+/* Register or update the callback of (callback_desc->event, slot). */
+int no_os_irq_table_register(struct no_os_irq_table *table, uint32_t slot,
+			     uint32_t irq_id,
+			     const struct no_os_callback_desc *callback_desc);
+/* Free the slot of (event, slot). */
+int no_os_irq_table_unregister(struct no_os_irq_table *table, uint32_t event,
+			       uint32_t slot);
+/* Free all the slots. */
+void no_os_irq_table_clear(struct no_os_irq_table *table);
+
+/* Call the callback of a slot, return false if it is free. */
+bool no_os_irq_slot_dispatch(struct no_os_irq_table *table,
+			     struct no_os_irq_slot *slot);
+/* Call the callback of (event, slot), return false if there is none. */
+bool no_os_irq_table_dispatch(struct no_os_irq_table *table, uint32_t event,
+			      uint32_t slot);
+
+/* Read the dispatch counter and worst case dispatch time of (event, slot). */
+int no_os_irq_table_stats(struct no_os_irq_table *table, uint32_t event,
+			  uint32_t slot, uint32_t *count, uint32_t *max_ticks);
+/* Clear the statistics of all the slots. */
+void no_os_irq_table_stats_reset(struct no_os_irq_table *table);
+
+#endif // _NO_OS_IRQ_TABLE_H_
@@ -45,6 +45,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/*
+ * Byte-wide ring kept for the existing UART drivers. For other element sizes,
+ * capacities or bulk/zero-copy access use no_os_lf_ring.h instead.
+ */
 struct lf256fifo;
 
 int lf256fifo_init(struct lf256fifo **);
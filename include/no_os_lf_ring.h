@@ -0,0 +1,102 @@
+/***************************************************************************//**
+ *   @file   no_os_lf_ring.h
+ *   @brief  SPSC lock-free ring of power-of-two size and arbitrary element size.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_LF_RING_H_
+#define _NO_OS_LF_RING_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_lf_ring
+ * @brief Opaque ring descriptor.
+ *
+ * The ring is safe to use without locking as long as there is exactly one
+ * producer (write, write_n, write_peek/write_commit) and exactly one consumer
+ * (read, read_n, read_peek/read_commit, flush). The producer and consumer may
+ * run on different cores or one of them may be an interrupt handler.
+ */
+struct no_os_lf_ring;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate a ring of nb_elem elements (power of two) of elem_size bytes. */
+int no_os_lf_ring_init(struct no_os_lf_ring **ring, uint32_t nb_elem,
+		       uint32_t elem_size);
+/* Free the resources allocated by no_os_lf_ring_init(). */
+int no_os_lf_ring_remove(struct no_os_lf_ring *ring);
+
+/* Number of elements available for reading. */
+uint32_t no_os_lf_ring_count(struct no_os_lf_ring *ring);
+/* Number of free element slots available for writing. */
+uint32_t no_os_lf_ring_space(struct no_os_lf_ring *ring);
+bool no_os_lf_ring_is_empty(struct no_os_lf_ring *ring);
+bool no_os_lf_ring_is_full(struct no_os_lf_ring *ring);
+
+/* Single element access. */
+int no_os_lf_ring_write(struct no_os_lf_ring *ring, const void *elem);
+int no_os_lf_ring_read(struct no_os_lf_ring *ring, void *elem);
+
+/* Bulk access, return the number of elements actually transferred. */
+uint32_t no_os_lf_ring_write_n(struct no_os_lf_ring *ring, const void *elems,
+			       uint32_t nb_elem);
+uint32_t no_os_lf_ring_read_n(struct no_os_lf_ring *ring, void *elems,
+			      uint32_t nb_elem);
+
+/* Zero-copy access to the contiguous free/filled region of the ring. */
+int no_os_lf_ring_write_peek(struct no_os_lf_ring *ring, void **buff,
+			     uint32_t *nb_elem);
+int no_os_lf_ring_write_commit(struct no_os_lf_ring *ring, uint32_t nb_elem);
+int no_os_lf_ring_read_peek(struct no_os_lf_ring *ring, void **buff,
+			    uint32_t *nb_elem);
+int no_os_lf_ring_read_commit(struct no_os_lf_ring *ring, uint32_t nb_elem);
+
+/* Drop all the elements currently in the ring (consumer side). */
+void no_os_lf_ring_flush(struct no_os_lf_ring *ring);
+
+#endif // _NO_OS_LF_RING_H_
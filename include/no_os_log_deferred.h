@@ -0,0 +1,262 @@
+/***************************************************************************//**
+ *   @file   no_os_log_deferred.h
+ *   @brief  Deferred binary logging backend for the pr_* macros.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef _NO_OS_LOG_DEFERRED_H_
+#define _NO_OS_LOG_DEFERRED_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Number of records of the log ring, must be a power of two. */
+#ifndef NO_OS_LOG_RING_SIZE
+#define NO_OS_LOG_RING_SIZE	64
+#endif
+
+/* Maximum number of arguments of a deferred call, at most 8. */
+#define NO_OS_LOG_MAX_ARGS	8
+
+/* Bytes of each record holding copies of the "%s" arguments. */
+#ifndef NO_OS_LOG_STR_SIZE
+#define NO_OS_LOG_STR_SIZE	32
+#endif
+
+/* Size of the line buffer used by no_os_log_drain(). */
+#ifndef NO_OS_LOG_LINE_SIZE
+#define NO_OS_LOG_LINE_SIZE	256
+#endif
+
+#define NO_OS_LOG_CAT_(a, b)	a ## b
+#define NO_OS_LOG_CAT(a, b)	NO_OS_LOG_CAT_(a, b)
+
+/* Number of arguments, 0 to 16. */
+#define NO_OS_LOG_NARGS(...)	NO_OS_LOG_NARGS_(_, ##__VA_ARGS__, 16, 15, 14, \
+		13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define NO_OS_LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, \
+		_12, _13, _14, _15, _16, n, ...)	n
+
+/*
+ * Store one argument in its record cell. The argument keeps its promoted type
+ * and size, floats are flagged so that the formatter knows how to read them.
+ * Strings are copied in the record, the caller's buffer may be gone by the
+ * time the record is drained.
+ */
+#define NO_OS_LOG_IS_STR(x)	_Generic((x) + 0, char *: 1,		\
+					 const char *: 1, default: 0)
+#define NO_OS_LOG_ARG(rec, i, x) do {					\
+	__typeof__((x) + 0) _v = (x);					\
+	_Static_assert(sizeof(_v) <= sizeof(uint64_t),			\
+		       "argument too large for a deferred log call");	\
+	if (NO_OS_LOG_IS_STR(x))					\
+		no_os_log_str(rec, i, &_v);				\
+	else								\
+		memcpy(&(rec)->args[i], &_v, sizeof(_v));		\
+	(rec)->float_mask |= _Generic((x) + 0, float: 1, default: 0) << (i); \
+} while (0)
+
+#define NO_OS_LOG_ARGS_0(r)
+#define NO_OS_LOG_ARGS_1(r, a)	NO_OS_LOG_ARG(r, 0, a)
+#define NO_OS_LOG_ARGS_2(r, a, b)	\
+	NO_OS_LOG_ARGS_1(r, a); NO_OS_LOG_ARG(r, 1, b)
+#define NO_OS_LOG_ARGS_3(r, a, b, c)	\
+	NO_OS_LOG_ARGS_2(r, a, b); NO_OS_LOG_ARG(r, 2, c)
+#define NO_OS_LOG_ARGS_4(r, a, b, c, d)	\
+	NO_OS_LOG_ARGS_3(r, a, b, c); NO_OS_LOG_ARG(r, 3, d)
+#define NO_OS_LOG_ARGS_5(r, a, b, c, d, e)	\
+	NO_OS_LOG_ARGS_4(r, a, b, c, d); NO_OS_LOG_ARG(r, 4, e)
+#define NO_OS_LOG_ARGS_6(r, a, b, c, d, e, f)	\
+	NO_OS_LOG_ARGS_5(r, a, b, c, d, e); NO_OS_LOG_ARG(r, 5, f)
+#define NO_OS_LOG_ARGS_7(r, a, b, c, d, e, f, g)	\
+	NO_OS_LOG_ARGS_6(r, a, b, c, d, e, f); NO_OS_LOG_ARG(r, 6, g)
+#define NO_OS_LOG_ARGS_8(r, a, b, c, d, e, f, g, h)	\
+	NO_OS_LOG_ARGS_7(r, a, b, c, d, e, f, g); NO_OS_LOG_ARG(r, 7, h)
+
+/* Calls with up to NO_OS_LOG_MAX_ARGS arguments are deferred. */
+#define NO_OS_LOG_CALL_0	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_1	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_2	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_3	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_4	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_5	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_6	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_7	NO_OS_LOG_DEFER
+#define NO_OS_LOG_CALL_8	NO_OS_LOG_DEFER
+/* Longer calls are rare and formatted right away. */
+#define NO_OS_LOG_CALL_9	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_10	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_11	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_12	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_13	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_14	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_15	NO_OS_LOG_DIRECT
+#define NO_OS_LOG_CALL_16	NO_OS_LOG_DIRECT
+
+#define NO_OS_LOG_DEFER(lvl, format, n, ...) do {			\
+	static const struct no_os_log_site _site = {			\
+		.fmt = format, .file = __FILE__, .func = __func__,	\
+		.line = __LINE__, .level = lvl,				\
+	};								\
+	struct no_os_log_record *_rec;					\
+	if (0)								\
+		printf(format, ##__VA_ARGS__);				\
+	_rec = no_os_log_reserve(&_site);				\
+	if (_rec) {							\
+		NO_OS_LOG_CAT(NO_OS_LOG_ARGS_, n)(_rec, ##__VA_ARGS__);	\
+		no_os_log_commit(_rec);					\
+	}								\
+} while (0)
+
+#define NO_OS_LOG_DIRECT(lvl, format, n, ...) do {			\
+	static const struct no_os_log_site _site = {			\
+		.fmt = format, .file = __FILE__, .func = __func__,	\
+		.line = __LINE__, .level = lvl,				\
+	};								\
+	no_os_log_direct(&_site, ##__VA_ARGS__);			\
+} while (0)
+
+/**
+ * @brief Record a log call. Only the call site and the raw arguments are
+ * stored, formatting is done later by no_os_log_drain().
+ *
+ * The dead printf() call keeps the compiler format checks. "%s" arguments
+ * are copied in the record, up to NO_OS_LOG_STR_SIZE bytes for all the
+ * strings of the call, the longer ones are truncated.
+ */
+#define no_os_log_deferred(lvl, format, ...)				\
+	NO_OS_LOG_CAT(NO_OS_LOG_CALL_, NO_OS_LOG_NARGS(__VA_ARGS__))	\
+		(lvl, format, NO_OS_LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_log_site
+ * @brief Constant description of a log call, placed in read only memory.
+ *
+ * The address of the site is the format ID stored in the records. A host
+ * tool reading raw records can resolve it using the symbols of the image.
+ */
+struct no_os_log_site {
+	/** Format string */
+	const char *fmt;
+	/** Source file of the call */
+	const char *file;
+	/** Function of the call */
+	const char *func;
+	/** Source line of the call */
+	uint32_t line;
+	/** NO_OS_LOG_* level */
+	uint32_t level;
+};
+
+/**
+ * @struct no_os_log_record
+ * @brief Binary log record, one ring slot.
+ */
+struct no_os_log_record {
+	/** Ring sequence number, owned by the ring */
+	_Atomic uint32_t seq;
+	/** Bit i is set if args[i] holds a float instead of a double */
+	uint32_t float_mask;
+	/** Bit i is set if args[i] is the offset of a string in strs */
+	uint16_t str_mask;
+	/** Bytes used in strs */
+	uint16_t str_len;
+	/** Call site */
+	const struct no_os_log_site *site;
+#if defined(PRINT_TIME)
+	/** Time of the call */
+	uint32_t s;
+	uint32_t us;
+#endif
+	/** Raw arguments, in their promoted type */
+	uint64_t args[NO_OS_LOG_MAX_ARGS];
+	/** Copies of the string arguments */
+	char strs[NO_OS_LOG_STR_SIZE];
+};
+
+/**
+ * @struct no_os_log_stats
+ * @brief Deferred logging statistics.
+ */
+struct no_os_log_stats {
+	/** Records written */
+	uint32_t recorded;
+	/** Records lost because the ring was full */
+	uint32_t dropped;
+	/** Highest number of records waiting in the ring */
+	uint32_t high_water;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Claim a ring slot for a call site, NULL if the ring is full. */
+struct no_os_log_record *no_os_log_reserve(const struct no_os_log_site *site);
+/* Copy a string argument in a record claimed by no_os_log_reserve(). */
+void no_os_log_str(struct no_os_log_record *rec, uint32_t i, const void *str);
+/* Publish a record filled after no_os_log_reserve(). */
+void no_os_log_commit(struct no_os_log_record *rec);
+/* Format and print a call right away, used for long argument lists. */
+void no_os_log_direct(const struct no_os_log_site *site, ...);
+
+/* Pop the oldest published record, -EAGAIN if there is none. */
+int no_os_log_read(struct no_os_log_record *rec);
+/* Format a record, return the length of the whole line like snprintf(). */
+int no_os_log_format(const struct no_os_log_record *rec, char *buf,
+		     size_t size);
+/* Print up to max records (all of them if 0), return how many were printed. */
+uint32_t no_os_log_drain(uint32_t max);
+
+/* Read and optionally clear the statistics. */
+void no_os_log_stats_get(struct no_os_log_stats *stats, bool clear);
+
+#endif // _NO_OS_LOG_DEFERRED_H_
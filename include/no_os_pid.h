@@ -74,7 +74,39 @@ struct no_os_pid_config {
 	int initial;
 };
 
+/** Fractional bits of the batch PID gains and filter coefficient */
+#define NO_OS_PID_BATCH_Q	16
+
+/** Convert a real number to a batch PID gain */
+#define NO_OS_PID_BATCH_GAIN(x)	((int32_t)((x) * (1 << NO_OS_PID_BATCH_Q)))
+
+/**
+ * @struct no_os_pid_batch_config
+ * @brief Configuration of one loop of a batch PID.
+ *
+ * output = Kp * err + sum(Ki * err) + Kd * filtered(-dPV), with err = SP - PV.
+ * The derivative acts on the process variable, so set point steps do not
+ * kick the output. Reverse acting loops use negative gains. The set point
+ * and process variable must stay within +/- 2^22, the internal products are
+ * 32 x 32 -> 64 bits.
+ */
+struct no_os_pid_batch_config {
+	/** Proportional gain (Q15.16) */
+	int32_t Kp;
+	/** Integral gain, per update (Q15.16) */
+	int32_t Ki;
+	/** Derivative gain, per update (Q15.16) */
+	int32_t Kd;
+	/** Derivative low pass coefficient, (0, 1] in Q16, 1 for no filter */
+	int32_t d_alpha;
+	/** Boundary limits for the output, required */
+	struct no_os_pid_range output_clip;
+	/** (Optional) Boundary limits for the integral component */
+	struct no_os_pid_range i_clip;
+};
+
 struct no_os_pid;
+struct no_os_pid_batch;
 
 int no_os_pid_init(struct no_os_pid **pid, struct no_os_pid_config config);
 int no_os_pid_control(struct no_os_pid *pid, int SP, int PV, int *output);
@@ -82,4 +114,12 @@ int no_os_pid_hysteresis(struct no_os_pid *pid, unsigned int hyst);
 int no_os_pid_reset(struct no_os_pid *pid);
 int no_os_pid_remove(struct no_os_pid *pid);
 
+int no_os_pid_batch_init(struct no_os_pid_batch **batch, uint32_t nb_loops);
+int no_os_pid_batch_config(struct no_os_pid_batch *batch, uint32_t loop,
+			   const struct no_os_pid_batch_config *config);
+int no_os_pid_batch_control(struct no_os_pid_batch *batch, const int32_t *SP,
+			    const int32_t *PV, int32_t *output);
+int no_os_pid_batch_reset(struct no_os_pid_batch *batch, uint32_t loop);
+int no_os_pid_batch_remove(struct no_os_pid_batch *batch);
+
 #endif
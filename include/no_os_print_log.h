@@ -41,6 +41,13 @@
 #define _NO_OS_PRINT_LOG_H_
 
 #include <stdio.h>
+/*
+ * With NO_OS_LOG_DEFERRED, the pr_* calls only record their arguments and the
+ * text is printed by no_os_log_drain() (util/no_os_log_deferred.c).
+ */
+#if defined(NO_OS_LOG_DEFERRED)
+#include "no_os_log_deferred.h"
+#endif
 
 #define NO_OS_LOG_EMERG	0x0
 #define NO_OS_LOG_ALERT	0x1
@@ -64,73 +71,107 @@
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_EMERG && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_emerg(fmt, args...) no_os_log_deferred(NO_OS_LOG_EMERG, fmt, ##args)
+#else
 #define pr_emerg(fmt, args...) do {							\
 	pr_time										\
 	printf("EMERG: %s:%d:%s(): " fmt, __FILE__, __LINE__, __func__, ##args);	\
 } while (0)
+#endif
 #else
 #define pr_emerg(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_ALERT && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_alert(fmt, args...) no_os_log_deferred(NO_OS_LOG_ALERT, fmt, ##args)
+#else
 #define pr_alert(fmt, args...) do {							\
 	pr_time										\
 	printf("ALERT: %s:%d:%s(): " fmt, __FILE__, __LINE__, __func__, ##args);	\
 } while (0)
+#endif
 #else
 #define pr_alert(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_CRIT && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_crit(fmt, args...) no_os_log_deferred(NO_OS_LOG_CRIT, fmt, ##args)
+#else
 #define pr_crit(fmt, args...) do { 						\
 	pr_time									\
 	printf("CRIT: %s:%d:%s(): " fmt, __FILE__, __LINE__, __func__, ##args);	\
 } while (0)
+#endif
 #else
 #define pr_crit(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_ERR && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_err(fmt, args...) no_os_log_deferred(NO_OS_LOG_ERR, fmt, ##args)
+#else
 #define pr_err(fmt, args...) do {						\
 	pr_time									\
 	printf("ERR: %s:%d:%s(): " fmt, __FILE__, __LINE__, __func__, ##args);	\
 } while (0)
+#endif
 #else
 #define pr_err(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_WARNING && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_warning(fmt, args...) \
+	no_os_log_deferred(NO_OS_LOG_WARNING, fmt, ##args)
+#else
 #define pr_warning(fmt, args...) do {		\
 	pr_time					\
 	printf("WARNING: " fmt, ##args);	\
 } while (0)
+#endif
 #else
 #define pr_warning(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_NOTICE && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_notice(fmt, args...) \
+	no_os_log_deferred(NO_OS_LOG_NOTICE, fmt, ##args)
+#else
 #define pr_notice(fmt, args...) do {	\
 	pr_time				\
 	printf("NOTICE: " fmt, ##args);	\
 } while (0)
+#endif
 #else
 #define pr_notice(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL >= NO_OS_LOG_INFO && NO_OS_LOG_LEVEL <= NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_info(fmt, args...) no_os_log_deferred(NO_OS_LOG_INFO, fmt, ##args)
+#else
 #define pr_info(fmt, args...) do {	\
 	pr_time 			\
 	printf(fmt, ##args);		\
 } while(0)
+#endif
 #else
 #define pr_info(fmt, args...)
 #endif
 
 #if defined(NO_OS_LOG_LEVEL) && NO_OS_LOG_LEVEL == NO_OS_LOG_DEBUG
+#if defined(NO_OS_LOG_DEFERRED)
+#define pr_debug(fmt, args...) no_os_log_deferred(NO_OS_LOG_DEBUG, fmt, ##args)
+#else
 #define pr_debug(fmt, args...) do {	\
 	pr_time				\
 	printf("DEBUG: " fmt, ##args);	\
 } while(0)
+#endif
 #else
 #define pr_debug(fmt, args...)
 #endif
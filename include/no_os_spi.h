@@ -220,6 +220,13 @@ struct no_os_spi_platform_ops {
 				      uint32_t, void (*)(void *), void *);
 	/** SPI remove function pointer */
 	int32_t (*remove)(struct no_os_spi_desc *);
+	/** Queue messages, sent with the next ones or by flush. Platforms
+	 * without it send the messages right away.
+	 */
+	int32_t (*queue)(struct no_os_spi_desc *, struct no_os_spi_msg *,
+			 uint32_t);
+	/** Send the queued messages */
+	int32_t (*flush)(struct no_os_spi_desc *);
 };
 
 /******************************************************************************/
@@ -243,6 +250,14 @@ int32_t no_os_spi_transfer(struct no_os_spi_desc *desc,
 			   struct no_os_spi_msg *msgs,
 			   uint32_t len);
 
+/* Queue messages, to be sent with the next transfer or by no_os_spi_flush() */
+int32_t no_os_spi_queue(struct no_os_spi_desc *desc,
+			struct no_os_spi_msg *msgs,
+			uint32_t len);
+
+/* Send the messages queued with no_os_spi_queue() */
+int32_t no_os_spi_flush(struct no_os_spi_desc *desc);
+
 /* Transfer a list of messages using DMA. Wait until all transfers are done */
 int32_t no_os_spi_transfer_dma_sync(struct no_os_spi_desc *desc,
 				    struct no_os_spi_msg *msgs,
@@ -121,6 +121,7 @@ int32_t mqtt_init(struct mqtt_desc **desc,
 	ldesc->network.sock = param->sock;
 	ldesc->network.mqttread = mqtt_noos_read;
 	ldesc->network.mqttwrite = mqtt_noos_write;
+	ldesc->network.pub = param->pub;
 
 	app_handler = param->message_handler;
 
@@ -111,6 +111,7 @@
 /******************************************************************************/
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "tcp_socket.h"
 
 /******************************************************************************/
@@ -230,6 +231,13 @@ struct mqtt_init_param {
 	 * @param Message received from the broker.
 	 */
 	void			(*message_handler)(struct mqtt_message_data *);
+	/**
+	 * Optional publish queue sharing the connection. The packets read by
+	 * the client are forwarded to it, so it sees the PUBACKs of its QoS1
+	 * publishes, and the client writes only start once a partially
+	 * written publish is complete. NULL if not used.
+	 */
+	struct mqtt_pub_desc	*pub;
 };
 
 /**
@@ -238,6 +246,9 @@ struct mqtt_init_param {
  */
 struct mqtt_desc;
 
+/* Publish queue, see mqtt_pub.h */
+struct mqtt_pub_desc;
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -42,6 +42,7 @@
 /******************************************************************************/
 
 #include "mqtt_noos_support.h"
+#include "mqtt_pub.h"
 #include <stdlib.h>
 #include "no_os_timer.h"
 #include "no_os_error.h"
@@ -168,6 +169,7 @@ int mqtt_noos_read(Network* net, unsigned char* buff, int len, int timeout)
 			if (NO_OS_IS_ERR_VALUE(rc))
 				return rc;
 
+			mqtt_pub_rx(net->pub, buff + sent, rc);
 			sent += rc;
 			if (sent >= len)
 				return sent;
@@ -183,8 +185,19 @@ int mqtt_noos_read(Network* net, unsigned char* buff, int len, int timeout)
 /* Implementation of mqtt_noos_write used by MQTTClient.c */
 int mqtt_noos_write(Network* net, unsigned char* buff, int len, int timeout)
 {
-	/* non blocking read is not implemented */
-	NO_OS_UNUSED_PARAM(timeout);
+	int32_t rc;
+
+	/* Don't interleave with a publish partially written by the queue */
+	rc = mqtt_pub_resume(net->pub);
+	while (rc == -EAGAIN && timeout-- > 0) {
+		no_os_mdelay(1);
+#ifdef NO_OS_LWIP_NETWORKING
+		no_os_lwip_step(net->sock->net->net, NULL);
+#endif
+		rc = mqtt_pub_resume(net->pub);
+	}
+	if (rc)
+		return rc;
 
 	return socket_send(net->sock, (const void *)buff, (uint32_t)len);
 }
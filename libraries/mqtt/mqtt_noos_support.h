@@ -81,6 +81,8 @@ struct network_port_noos {
 	/** Reference to no-os network wrapper write function */
 	int			(*mqttwrite)(Network*, unsigned char*, int,
 					     int);
+	/** Publish queue fed with the received bytes, can be NULL */
+	struct mqtt_pub_desc	*pub;
 };
 
 /******************************************************************************/
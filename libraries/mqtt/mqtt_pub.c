@@ -0,0 +1,802 @@
+/***************************************************************************//**
+ *   @file   mqtt_pub.c
+ *   @brief  Batched non-blocking MQTT publish queue.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include "mqtt_pub.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define MQTT_PUB_PUBLISH	0x30
+#define MQTT_PUB_DUP		NO_OS_BIT(3)
+#define MQTT_PUB_PUBACK		4
+/* Fixed header: type byte and up to 4 remaining length bytes */
+#define MQTT_PUB_FIXED_MAX	5
+#define MQTT_PUB_CBOR_HEAD_MAX	5
+#define MQTT_PUB_CBOR_UINT	0
+#define MQTT_PUB_CBOR_NINT	1
+#define MQTT_PUB_CBOR_ARRAY	4
+#define MQTT_PUB_RX_BUFF_SIZE	64
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+enum mqtt_pub_slot_state {
+	MQTT_PUB_SLOT_FREE,
+	/* Samples are being appended */
+	MQTT_PUB_SLOT_FILLING,
+	/* Complete packet waiting in the transmit queue */
+	MQTT_PUB_SLOT_QUEUED,
+	/* QoS1 packet written to the socket, waiting for the PUBACK */
+	MQTT_PUB_SLOT_INFLIGHT
+};
+
+enum mqtt_pub_rx_state {
+	MQTT_PUB_RX_TYPE,
+	MQTT_PUB_RX_LEN,
+	MQTT_PUB_RX_BODY
+};
+
+/* One publish packet, built in place so it is sent without a copy */
+struct mqtt_pub_slot {
+	uint8_t			*buff;
+	/* First byte of the packet, the headers end where the payload starts */
+	uint32_t		start;
+	/* End of the payload */
+	uint32_t		end;
+	/* Bytes of the packet already written to the socket */
+	uint32_t		sent;
+	uint32_t		nb_samples;
+	uint32_t		sent_ms;
+	uint16_t		packet_id;
+	uint8_t			topic;
+	uint8_t			state;
+	/* Queued again after the resend timeout */
+	bool			resend;
+	/* PUBACK received while queued for a resend */
+	bool			acked;
+};
+
+struct mqtt_pub_topic_state {
+	struct mqtt_pub_topic	cfg;
+	uint16_t		name_len;
+	/* Bytes reserved in front of the payload for the headers */
+	uint16_t		headroom;
+	/* Worst case size of an encoded sample */
+	uint16_t		max_sample;
+	struct mqtt_pub_slot	*filling;
+	uint32_t		since_ms;
+	bool			since_valid;
+};
+
+struct mqtt_pub_desc {
+	struct tcp_socket_desc	*sock;
+	struct mqtt_pub_topic_state *topics;
+	uint32_t		nb_topics;
+	struct mqtt_pub_slot	*slots;
+	uint8_t			*slot_mem;
+	uint32_t		nb_slots;
+	uint32_t		slot_size;
+	/* Slot indexes, the free ones first and the transmit queue after */
+	uint32_t		*free_slots;
+	uint32_t		nb_free;
+	uint32_t		*txq;
+	uint32_t		txq_head;
+	uint32_t		txq_count;
+	uint32_t		window;
+	uint32_t		retry_ms;
+	/* Time of the last poll */
+	uint32_t		now_ms;
+	bool			read_socket;
+	uint16_t		next_id;
+	/* Framing of the packets received from the broker */
+	uint8_t			rx_state;
+	uint8_t			rx_type;
+	uint8_t			rx_shift;
+	uint16_t		rx_id;
+	uint32_t		rx_len;
+	uint32_t		rx_got;
+	uint8_t			rx_buff[MQTT_PUB_RX_BUFF_SIZE];
+	struct mqtt_pub_stats	stats;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/* Encode a CBOR head, return its size */
+static uint32_t mqtt_pub_cbor_head(uint8_t *buff, uint8_t major, uint32_t val)
+{
+	major <<= 5;
+	if (val < 24) {
+		buff[0] = major | val;
+		return 1;
+	}
+	if (val <= 0xff) {
+		buff[0] = major | 24;
+		buff[1] = val;
+		return 2;
+	}
+	if (val <= 0xffff) {
+		buff[0] = major | 25;
+		no_os_put_unaligned_be16(val, &buff[1]);
+		return 3;
+	}
+
+	buff[0] = major | 26;
+	no_os_put_unaligned_be32(val, &buff[1]);
+
+	return 5;
+}
+
+/* Encode a CBOR integer, negative integers are encoded as -1 - val */
+static uint32_t mqtt_pub_cbor_int(uint8_t *buff, int32_t val)
+{
+	if (val < 0)
+		return mqtt_pub_cbor_head(buff, MQTT_PUB_CBOR_NINT,
+					  ~(uint32_t)val);
+
+	return mqtt_pub_cbor_head(buff, MQTT_PUB_CBOR_UINT, val);
+}
+
+/* Encode the MQTT remaining length, return its size */
+static uint32_t mqtt_pub_varint(uint8_t *buff, uint32_t val)
+{
+	uint32_t len = 0;
+
+	do {
+		buff[len] = val & 0x7f;
+		val >>= 7;
+		if (val)
+			buff[len] |= 0x80;
+		len++;
+	} while (val);
+
+	return len;
+}
+
+static void mqtt_pub_slot_free(struct mqtt_pub_desc *desc,
+			       struct mqtt_pub_slot *slot)
+{
+	slot->state = MQTT_PUB_SLOT_FREE;
+	desc->free_slots[desc->nb_free++] = slot - desc->slots;
+}
+
+static void mqtt_pub_txq_push(struct mqtt_pub_desc *desc,
+			      struct mqtt_pub_slot *slot)
+{
+	uint32_t idx = (desc->txq_head + desc->txq_count) % desc->nb_slots;
+
+	slot->state = MQTT_PUB_SLOT_QUEUED;
+	slot->sent = 0;
+	desc->txq[idx] = slot - desc->slots;
+	desc->txq_count++;
+}
+
+static struct mqtt_pub_slot *mqtt_pub_txq_pop(struct mqtt_pub_desc *desc)
+{
+	struct mqtt_pub_slot *slot = &desc->slots[desc->txq[desc->txq_head]];
+
+	desc->txq_head = (desc->txq_head + 1) % desc->nb_slots;
+	desc->txq_count--;
+
+	return slot;
+}
+
+/*
+ * Queue a resend ahead of the publishes waiting for room in the QoS1 window,
+ * but behind a packet already partially written to the socket.
+ */
+static void mqtt_pub_txq_push_front(struct mqtt_pub_desc *desc,
+				    struct mqtt_pub_slot *slot)
+{
+	struct mqtt_pub_slot *head = NULL;
+
+	if (desc->txq_count && desc->slots[desc->txq[desc->txq_head]].sent)
+		head = mqtt_pub_txq_pop(desc);
+
+	slot->state = MQTT_PUB_SLOT_QUEUED;
+	slot->sent = 0;
+	desc->txq_head = (desc->txq_head + desc->nb_slots - 1) % desc->nb_slots;
+	desc->txq[desc->txq_head] = slot - desc->slots;
+	desc->txq_count++;
+
+	if (head) {
+		desc->txq_head = (desc->txq_head + desc->nb_slots - 1) %
+				 desc->nb_slots;
+		desc->txq[desc->txq_head] = head - desc->slots;
+		desc->txq_count++;
+	}
+}
+
+/*
+ * Write the headers in front of the payload of the pending publish of a
+ * topic and queue it for sending.
+ */
+static void mqtt_pub_seal(struct mqtt_pub_desc *desc,
+			  struct mqtt_pub_topic_state *topic)
+{
+	struct mqtt_pub_slot *slot = topic->filling;
+	uint8_t head[MQTT_PUB_FIXED_MAX];
+	uint32_t pos = topic->headroom;
+	uint32_t len;
+
+	if (!slot)
+		return;
+
+	if (topic->cfg.format == MQTT_PUB_FORMAT_CBOR) {
+		len = mqtt_pub_cbor_head(head, MQTT_PUB_CBOR_ARRAY,
+					 slot->nb_samples *
+					 (topic->cfg.sample_size / 4));
+		pos -= len;
+		memcpy(&slot->buff[pos], head, len);
+	}
+
+	if (topic->cfg.qos == MQTT_QOS1) {
+		slot->packet_id = desc->next_id;
+		desc->next_id = desc->next_id == 0xffff ? MQTT_PUB_ID_FIRST :
+				desc->next_id + 1;
+		pos -= 2;
+		no_os_put_unaligned_be16(slot->packet_id, &slot->buff[pos]);
+	}
+
+	pos -= topic->name_len;
+	memcpy(&slot->buff[pos], topic->cfg.name, topic->name_len);
+	pos -= 2;
+	no_os_put_unaligned_be16(topic->name_len, &slot->buff[pos]);
+
+	len = mqtt_pub_varint(head, slot->end - pos);
+	pos -= len;
+	memcpy(&slot->buff[pos], head, len);
+	slot->buff[--pos] = MQTT_PUB_PUBLISH | (topic->cfg.qos << 1);
+
+	slot->start = pos;
+	slot->resend = false;
+	slot->acked = false;
+	mqtt_pub_txq_push(desc, slot);
+
+	topic->filling = NULL;
+	topic->since_valid = false;
+}
+
+/**
+ * @brief Allocate the publish queue.
+ *
+ * All the packet buffers are allocated here, enqueueing and sending never
+ * allocate memory.
+ * @param desc - Address where to store the publish queue reference.
+ * @param param - Parameters of the publish queue.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t mqtt_pub_init(struct mqtt_pub_desc **desc,
+		      const struct mqtt_pub_init_param *param)
+{
+	struct mqtt_pub_topic_state *topic;
+	struct mqtt_pub_desc *ldesc;
+	uint32_t i;
+
+	if (!desc || !param || !param->sock || !param->topics ||
+	    !param->nb_topics || param->nb_topics > UINT8_MAX + 1 ||
+	    !param->nb_slots)
+		return -EINVAL;
+
+	ldesc = no_os_calloc(1, sizeof(*ldesc));
+	if (!ldesc)
+		return -ENOMEM;
+
+	ldesc->topics = no_os_calloc(param->nb_topics, sizeof(*ldesc->topics));
+	ldesc->slots = no_os_calloc(param->nb_slots, sizeof(*ldesc->slots));
+	ldesc->free_slots = no_os_calloc(2 * param->nb_slots,
+					 sizeof(*ldesc->free_slots));
+	ldesc->slot_mem = no_os_calloc(param->nb_slots, param->slot_size);
+	if (!ldesc->topics || !ldesc->slots || !ldesc->free_slots ||
+	    !ldesc->slot_mem) {
+		mqtt_pub_remove(ldesc);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < param->nb_topics; i++) {
+		topic = &ldesc->topics[i];
+		topic->cfg = param->topics[i];
+		if (!topic->cfg.name || !topic->cfg.sample_size ||
+		    topic->cfg.qos > MQTT_QOS1 ||
+		    (topic->cfg.qos == MQTT_QOS1 && !param->window))
+			goto error;
+
+		topic->name_len = strlen(topic->cfg.name);
+		topic->headroom = MQTT_PUB_FIXED_MAX + 2 + topic->name_len;
+		if (topic->cfg.qos == MQTT_QOS1)
+			topic->headroom += 2;
+
+		topic->max_sample = topic->cfg.sample_size;
+		if (topic->cfg.format == MQTT_PUB_FORMAT_CBOR) {
+			if (topic->cfg.sample_size % 4)
+				goto error;
+			topic->headroom += MQTT_PUB_CBOR_HEAD_MAX;
+			/* A head with a 32-bit argument for each value */
+			topic->max_sample = topic->cfg.sample_size / 4 *
+					    MQTT_PUB_CBOR_HEAD_MAX;
+		}
+
+		if (param->slot_size < topic->headroom + topic->max_sample)
+			goto error;
+	}
+
+	ldesc->txq = &ldesc->free_slots[param->nb_slots];
+	for (i = 0; i < param->nb_slots; i++) {
+		ldesc->slots[i].buff = &ldesc->slot_mem[i * param->slot_size];
+		ldesc->free_slots[i] = param->nb_slots - 1 - i;
+	}
+
+	ldesc->sock = param->sock;
+	ldesc->nb_topics = param->nb_topics;
+	ldesc->nb_slots = param->nb_slots;
+	ldesc->nb_free = param->nb_slots;
+	ldesc->slot_size = param->slot_size;
+	ldesc->window = param->window;
+	ldesc->retry_ms = param->retry_ms;
+	ldesc->read_socket = param->read_socket;
+	ldesc->next_id = MQTT_PUB_ID_FIRST;
+
+	*desc = ldesc;
+
+	return 0;
+
+error:
+	mqtt_pub_remove(ldesc);
+
+	return -EINVAL;
+}
+
+/**
+ * @brief Free the resources allocated by mqtt_pub_init().
+ *
+ * Queued and unacknowledged publishes are discarded.
+ * @param desc - Reference to the publish queue.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t mqtt_pub_remove(struct mqtt_pub_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	no_os_free(desc->slot_mem);
+	no_os_free(desc->free_slots);
+	no_os_free(desc->slots);
+	no_os_free(desc->topics);
+	no_os_free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Append one sample to the pending publish of a topic.
+ *
+ * Only copies the sample, the network is not touched. The publish is closed
+ * and queued once it holds flush_samples samples or its buffer is full.
+ * @param desc - Reference to the publish queue.
+ * @param topic - Index of the topic.
+ * @param sample - The sample, sample_size bytes.
+ * @return 0 in case of success, -ENOSPC if the sample was dropped because all
+ * 	   the packet buffers are in use, negative error code otherwise.
+ */
+int32_t mqtt_pub_enqueue(struct mqtt_pub_desc *desc, uint32_t topic,
+			 const void *sample)
+{
+	struct mqtt_pub_topic_state *t;
+	struct mqtt_pub_slot *slot;
+	const uint8_t *src = sample;
+	uint8_t *dst;
+	int32_t val;
+	uint32_t i;
+
+	if (!desc || topic >= desc->nb_topics || !sample)
+		return -EINVAL;
+
+	t = &desc->topics[topic];
+	if (!t->filling) {
+		if (!desc->nb_free) {
+			desc->stats.dropped++;
+			return -ENOSPC;
+		}
+
+		slot = &desc->slots[desc->free_slots[--desc->nb_free]];
+		slot->state = MQTT_PUB_SLOT_FILLING;
+		slot->topic = topic;
+		slot->end = t->headroom;
+		slot->nb_samples = 0;
+		t->filling = slot;
+	}
+
+	slot = t->filling;
+	dst = &slot->buff[slot->end];
+	if (t->cfg.format == MQTT_PUB_FORMAT_RAW) {
+		memcpy(dst, sample, t->cfg.sample_size);
+		dst += t->cfg.sample_size;
+	} else {
+		for (i = 0; i < t->cfg.sample_size; i += 4) {
+			memcpy(&val, &src[i], sizeof(val));
+			dst += mqtt_pub_cbor_int(dst, val);
+		}
+	}
+
+	slot->end = dst - slot->buff;
+	slot->nb_samples++;
+	desc->stats.samples++;
+
+	if (t->cfg.flush_samples && slot->nb_samples >= t->cfg.flush_samples)
+		mqtt_pub_seal(desc, t);
+	else if (desc->slot_size - slot->end < t->max_sample)
+		mqtt_pub_seal(desc, t);
+
+	return 0;
+}
+
+/**
+ * @brief Close the pending publishes of all the topics, they are sent by the
+ * next mqtt_pub_poll().
+ * @param desc - Reference to the publish queue.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t mqtt_pub_flush(struct mqtt_pub_desc *desc)
+{
+	uint32_t i;
+
+	if (!desc)
+		return -EINVAL;
+
+	for (i = 0; i < desc->nb_topics; i++)
+		mqtt_pub_seal(desc, &desc->topics[i]);
+
+	return 0;
+}
+
+/* Handle a PUBACK */
+static void mqtt_pub_ack(struct mqtt_pub_desc *desc, uint16_t packet_id)
+{
+	struct mqtt_pub_slot *slot;
+	uint32_t i;
+
+	for (i = 0; i < desc->nb_slots; i++) {
+		slot = &desc->slots[i];
+		if (slot->packet_id != packet_id || slot->acked ||
+		    desc->topics[slot->topic].cfg.qos != MQTT_QOS1)
+			continue;
+
+		if (slot->state == MQTT_PUB_SLOT_INFLIGHT) {
+			mqtt_pub_slot_free(desc, slot);
+		} else if (slot->state == MQTT_PUB_SLOT_QUEUED &&
+			   slot->resend) {
+			/* Still in the transmit queue, released when reached */
+			slot->acked = true;
+		} else {
+			continue;
+		}
+
+		desc->stats.inflight--;
+		desc->stats.acked++;
+
+		return;
+	}
+}
+
+/**
+ * @brief Feed packets received from the broker.
+ *
+ * Only the packet framing is tracked, PUBACKs release the QoS1 publishes and
+ * everything else is skipped. The MQTT client calls this for all the bytes
+ * read by mqtt_yield() when the queue is set in mqtt_init_param.pub.
+ * @param desc - Reference to the publish queue.
+ * @param data - Received bytes.
+ * @param len - Number of received bytes.
+ */
+void mqtt_pub_rx(struct mqtt_pub_desc *desc, const uint8_t *data,
+		 uint32_t len)
+{
+	bool puback;
+	uint32_t i = 0;
+	uint32_t skip;
+
+	if (!desc || !data)
+		return;
+
+	while (i < len) {
+		switch (desc->rx_state) {
+		case MQTT_PUB_RX_TYPE:
+			desc->rx_type = data[i++] >> 4;
+			desc->rx_len = 0;
+			desc->rx_shift = 0;
+			desc->rx_state = MQTT_PUB_RX_LEN;
+			break;
+		case MQTT_PUB_RX_LEN:
+			desc->rx_len |= (data[i] & 0x7f) << desc->rx_shift;
+			desc->rx_shift += 7;
+			if (data[i++] & 0x80)
+				break;
+
+			desc->rx_got = 0;
+			desc->rx_id = 0;
+			desc->rx_state = desc->rx_len ? MQTT_PUB_RX_BODY :
+					 MQTT_PUB_RX_TYPE;
+			break;
+		case MQTT_PUB_RX_BODY:
+			puback = desc->rx_type == MQTT_PUB_PUBACK;
+			if (puback && desc->rx_got < 2) {
+				desc->rx_id = (desc->rx_id << 8) | data[i++];
+				desc->rx_got++;
+			} else {
+				skip = no_os_min(len - i,
+						 desc->rx_len - desc->rx_got);
+				i += skip;
+				desc->rx_got += skip;
+			}
+
+			if (desc->rx_got < desc->rx_len)
+				break;
+
+			if (puback && desc->rx_len >= 2)
+				mqtt_pub_ack(desc, desc->rx_id);
+			desc->rx_state = MQTT_PUB_RX_TYPE;
+			break;
+		}
+	}
+}
+
+/* Read everything the broker sent, without blocking */
+static int32_t mqtt_pub_read(struct mqtt_pub_desc *desc)
+{
+	int32_t ret;
+
+	while (true) {
+		ret = socket_recv(desc->sock, desc->rx_buff,
+				  sizeof(desc->rx_buff));
+		if (ret == -EAGAIN || !ret)
+			return 0;
+		if (ret < 0)
+			return ret;
+
+		mqtt_pub_rx(desc, desc->rx_buff, ret);
+	}
+}
+
+/*
+ * Write the rest of the packet at the head of the transmit queue, return
+ * -EAGAIN if the socket doesn't take all of it.
+ */
+static int32_t mqtt_pub_write(struct mqtt_pub_desc *desc,
+			      struct mqtt_pub_slot *slot)
+{
+	uint32_t len = slot->end - slot->start;
+	int32_t ret;
+
+	/* The packet is written straight from its slot */
+	ret = socket_send(desc->sock, &slot->buff[slot->start + slot->sent],
+			  len - slot->sent);
+	if (ret < 0 && ret != -EAGAIN)
+		return ret;
+	if (ret > 0)
+		slot->sent += ret;
+	if (slot->sent < len)
+		return -EAGAIN;
+
+	mqtt_pub_txq_pop(desc);
+	desc->stats.packets++;
+
+	if (desc->topics[slot->topic].cfg.qos != MQTT_QOS1 || slot->acked) {
+		mqtt_pub_slot_free(desc, slot);
+		return 0;
+	}
+
+	if (!slot->resend)
+		desc->stats.inflight++;
+	slot->state = MQTT_PUB_SLOT_INFLIGHT;
+	slot->sent_ms = desc->now_ms;
+
+	return 0;
+}
+
+/* Write queued packets until the socket or the QoS1 window is full */
+static int32_t mqtt_pub_send(struct mqtt_pub_desc *desc)
+{
+	struct mqtt_pub_slot *slot;
+	int32_t ret;
+
+	while (desc->txq_count) {
+		slot = &desc->slots[desc->txq[desc->txq_head]];
+		if (slot->acked && !slot->sent) {
+			mqtt_pub_slot_free(desc, mqtt_pub_txq_pop(desc));
+			continue;
+		}
+
+		if (desc->topics[slot->topic].cfg.qos == MQTT_QOS1 &&
+		    !slot->resend && !slot->sent &&
+		    desc->stats.inflight >= desc->window)
+			return 0;
+
+		ret = mqtt_pub_write(desc, slot);
+		if (ret == -EAGAIN) {
+			/*
+			 * Back-pressure, resume from here on the next poll or
+			 * before the next write of the MQTT client
+			 */
+			desc->stats.blocked++;
+			return 0;
+		}
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/* Youngest QoS1 publish not acknowledged within retry_ms */
+static struct mqtt_pub_slot *mqtt_pub_expired(struct mqtt_pub_desc *desc,
+		uint32_t now_ms)
+{
+	struct mqtt_pub_slot *slot, *found = NULL;
+	uint16_t age, min_age = UINT16_MAX;
+	uint32_t i;
+
+	for (i = 0; i < desc->nb_slots; i++) {
+		slot = &desc->slots[i];
+		if (slot->state != MQTT_PUB_SLOT_INFLIGHT ||
+		    now_ms - slot->sent_ms < desc->retry_ms)
+			continue;
+
+		/* Identifiers are allocated in order, wrapping to the first */
+		age = (desc->next_id - slot->packet_id) &
+		      (MQTT_PUB_ID_FIRST - 1);
+		if (age < min_age) {
+			min_age = age;
+			found = slot;
+		}
+	}
+
+	return found;
+}
+
+/**
+ * @brief Send queued publishes without blocking.
+ *
+ * Closes the pending publishes older than their flush interval, queues again
+ * the QoS1 publishes not acknowledged within retry_ms and writes as much as
+ * the socket takes. A partially written packet is resumed by the next call,
+ * or by mqtt_pub_resume() when the MQTT client writes first.
+ * @param desc - Reference to the publish queue.
+ * @param now_ms - Current time in milliseconds.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t mqtt_pub_poll(struct mqtt_pub_desc *desc, uint32_t now_ms)
+{
+	struct mqtt_pub_topic_state *t;
+	struct mqtt_pub_slot *slot;
+	uint32_t i;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	desc->now_ms = now_ms;
+
+	if (desc->read_socket) {
+		ret = mqtt_pub_read(desc);
+		if (ret)
+			return ret;
+	}
+
+	for (i = 0; i < desc->nb_topics; i++) {
+		t = &desc->topics[i];
+		if (!t->filling || !t->cfg.flush_ms)
+			continue;
+
+		/* The age is counted from the first poll that sees samples */
+		if (!t->since_valid) {
+			t->since_ms = now_ms;
+			t->since_valid = true;
+		} else if (now_ms - t->since_ms >= t->cfg.flush_ms) {
+			mqtt_pub_seal(desc, t);
+		}
+	}
+
+	/*
+	 * Resends are queued at the front, the youngest first, so they go out
+	 * in their original order and are not held back by the window.
+	 */
+	while (desc->retry_ms) {
+		slot = mqtt_pub_expired(desc, now_ms);
+		if (!slot)
+			break;
+
+		slot->buff[slot->start] |= MQTT_PUB_DUP;
+		slot->resend = true;
+		mqtt_pub_txq_push_front(desc, slot);
+		desc->stats.retries++;
+	}
+
+	return mqtt_pub_send(desc);
+}
+
+/**
+ * @brief Complete the publish partially written by mqtt_pub_poll().
+ *
+ * The publishes and the packets of the MQTT client share the connection.
+ * The client calls this before each of its writes, so its packets never
+ * land in the middle of a publish.
+ * @param desc - Reference to the publish queue, NULL if there is none.
+ * @return 0 when no publish is partially written, -EAGAIN if the socket
+ * still doesn't take the rest, negative error code otherwise.
+ */
+int32_t mqtt_pub_resume(struct mqtt_pub_desc *desc)
+{
+	struct mqtt_pub_slot *slot;
+
+	if (!desc || !desc->txq_count)
+		return 0;
+
+	slot = &desc->slots[desc->txq[desc->txq_head]];
+	if (!slot->sent)
+		return 0;
+
+	return mqtt_pub_write(desc, slot);
+}
+
+/**
+ * @brief Get the publish queue statistics.
+ * @param desc - Reference to the publish queue.
+ * @param stats - The statistics.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t mqtt_pub_stats_get(struct mqtt_pub_desc *desc,
+			   struct mqtt_pub_stats *stats)
+{
+	if (!desc || !stats)
+		return -EINVAL;
+
+	*stats = desc->stats;
+
+	return 0;
+}
@@ -0,0 +1,178 @@
+/***************************************************************************//**
+ *   @file   mqtt_pub.h
+ *   @brief  Batched non-blocking MQTT publish queue.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef MQTT_PUB_H_
+#define MQTT_PUB_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mqtt_client.h"
+#include "tcp_socket.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/*
+ * Packet identifiers used for QoS1 publishes. They are kept apart from the
+ * ones the paho client allocates from 1 upwards for its blocking commands.
+ */
+#define MQTT_PUB_ID_FIRST	0x8000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @enum mqtt_pub_format
+ * @brief Payload format of a coalesced publish.
+ */
+enum mqtt_pub_format {
+	/** Samples copied back to back, sample_size bytes each */
+	MQTT_PUB_FORMAT_RAW,
+	/**
+	 * CBOR array of all the int32_t values of the coalesced samples,
+	 * sample_size / 4 values for each sample
+	 */
+	MQTT_PUB_FORMAT_CBOR
+};
+
+/**
+ * @struct mqtt_pub_topic
+ * @brief Topic the samples of one measurement are published to.
+ */
+struct mqtt_pub_topic {
+	/** Topic name */
+	const char		*name;
+	/** MQTT_QOS0 or MQTT_QOS1 */
+	enum mqtt_qos		qos;
+	/** Payload format */
+	enum mqtt_pub_format	format;
+	/** Size of a sample in bytes, a multiple of 4 for CBOR */
+	uint16_t		sample_size;
+	/** Publish once this many samples are coalesced, 0 for a full slot */
+	uint16_t		flush_samples;
+	/** Publish samples waiting for longer than this, 0 to disable */
+	uint32_t		flush_ms;
+};
+
+/**
+ * @struct mqtt_pub_init_param
+ * @brief Parameters of the publish queue.
+ */
+struct mqtt_pub_init_param {
+	/** Connected socket, shared with the MQTT client if there is one */
+	struct tcp_socket_desc	*sock;
+	/** Topics, referenced by their index in mqtt_pub_enqueue() */
+	const struct mqtt_pub_topic *topics;
+	/** Number of topics */
+	uint32_t		nb_topics;
+	/** Number of packet buffers in the outbound queue */
+	uint32_t		nb_slots;
+	/** Size of a packet buffer, headers included */
+	uint32_t		slot_size;
+	/** Maximum number of unacknowledged QoS1 publishes */
+	uint32_t		window;
+	/** Resend an unacknowledged QoS1 publish after this time */
+	uint32_t		retry_ms;
+	/**
+	 * Read PUBACKs from the socket in mqtt_pub_poll(). Must be false when
+	 * mqtt_yield() reads the connection, the client then forwards the
+	 * received packets through mqtt_init_param.pub.
+	 */
+	bool			read_socket;
+};
+
+/**
+ * @struct mqtt_pub_stats
+ * @brief Publish queue statistics.
+ */
+struct mqtt_pub_stats {
+	/** Samples accepted by mqtt_pub_enqueue() */
+	uint32_t		samples;
+	/** Samples dropped because no packet buffer was free */
+	uint32_t		dropped;
+	/** Publish packets completely written to the socket */
+	uint32_t		packets;
+	/** QoS1 publishes acknowledged by the broker */
+	uint32_t		acked;
+	/** QoS1 publishes sent again with the DUP flag */
+	uint32_t		retries;
+	/** Polls that stopped because the socket did not take all the data */
+	uint32_t		blocked;
+	/** QoS1 publishes currently waiting for a PUBACK */
+	uint32_t		inflight;
+};
+
+/**
+ * @struct mqtt_pub_desc
+ * @brief Reference to a publish queue.
+ */
+struct mqtt_pub_desc;
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate the publish queue, all the buffers are allocated here. */
+int32_t mqtt_pub_init(struct mqtt_pub_desc **desc,
+		      const struct mqtt_pub_init_param *param);
+/* Free the resources allocated by mqtt_pub_init(). */
+int32_t mqtt_pub_remove(struct mqtt_pub_desc *desc);
+
+/* Append one sample to the pending publish of a topic, never blocks. */
+int32_t mqtt_pub_enqueue(struct mqtt_pub_desc *desc, uint32_t topic,
+			 const void *sample);
+/* Close the pending publishes of all the topics. */
+int32_t mqtt_pub_flush(struct mqtt_pub_desc *desc);
+/* Send queued publishes and handle flush intervals and QoS1 resends. */
+int32_t mqtt_pub_poll(struct mqtt_pub_desc *desc, uint32_t now_ms);
+/* Complete a partially written publish, used by the MQTT client. */
+int32_t mqtt_pub_resume(struct mqtt_pub_desc *desc);
+/* Feed packets received from the broker, used by the MQTT client. */
+void mqtt_pub_rx(struct mqtt_pub_desc *desc, const uint8_t *data,
+		 uint32_t len);
+/* Get the publish queue statistics. */
+int32_t mqtt_pub_stats_get(struct mqtt_pub_desc *desc,
+			   struct mqtt_pub_stats *stats);
+
+#endif /* MQTT_PUB_H_ */
@@ -59,6 +59,7 @@
 #include <netdb.h>
 #include <string.h>
 #include <fcntl.h>
+#include <poll.h>
 
 /******************************************************************************/
 /*************************** FUnctions Declarations *******************************/
@@ -137,12 +138,14 @@ static int32_t linux_socket_send(void *desc, uint32_t sock_id,
 {
 	int32_t ret;
 
-	ret = send(sock_id, data, size, 0);
+	/* A client closing the connection must not raise SIGPIPE */
+	ret = send(sock_id, data, size, MSG_NOSIGNAL);
 
 	if(ret < 0)
 		return -errno;
 
-	return size;
+	/* The socket is non-blocking, only part of the data may be sent */
+	return ret;
 }
 
 /** @brief See \ref network_interface.socket_recv */
@@ -254,17 +257,41 @@ static int32_t linux_socket_accept(void *desc, uint32_t sock_id,
 				   uint32_t *client_socket_id)
 {
 	int32_t ret;
+	int one = 1;
 
 	ret = accept4(sock_id, NULL, NULL, SOCK_NONBLOCK);
 
 	if(ret < 0)
 		return -errno;
 
+	/*
+	 * Replies are written in several small sends (value, then payload).
+	 * Without TCP_NODELAY each of them waits for the delayed ACK.
+	 */
+	setsockopt(ret, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
 	*client_socket_id = ret;
 
 	return 0;
 }
 
+/** @brief See \ref network_interface.socket_readable */
+static int32_t linux_socket_readable(void *desc, uint32_t sock_id)
+{
+	struct pollfd pfd = {
+		.fd = sock_id,
+		.events = POLLIN
+	};
+	int32_t ret;
+
+	ret = poll(&pfd, 1, 0);
+	if (ret < 0)
+		return -errno;
+
+	/* POLLHUP and POLLERR are reported so that the caller sees the error */
+	return ret && pfd.revents;
+}
+
 struct network_interface linux_net = {
 	.socket_open = (int32_t (*)(void *, uint32_t *, enum socket_protocol,
 				    uint32_t)) linux_socket_open,
@@ -277,7 +304,8 @@ struct network_interface linux_net = {
 	.socket_recvfrom = (int32_t (*)(void *, uint32_t, void *, uint32_t, struct socket_address* from))linux_socket_recvfrom,
 	.socket_bind = (int32_t (*)(void *, uint32_t, uint16_t))linux_socket_bind,
 	.socket_listen = (int32_t (*)(void *, uint32_t, uint32_t))linux_socket_listen,
-	.socket_accept= (int32_t (*)(void *, uint32_t, uint32_t*))linux_socket_accept
+	.socket_accept= (int32_t (*)(void *, uint32_t, uint32_t*))linux_socket_accept,
+	.socket_readable = (int32_t (*)(void *, uint32_t))linux_socket_readable
 };
 
 #endif
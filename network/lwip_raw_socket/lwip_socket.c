@@ -561,6 +561,7 @@ static int32_t lwip_socket_open(void *net, uint32_t *sock_id,
 	desc->sockets[socket_id].desc = desc;
 	desc->sockets[socket_id].id = socket_id;
 	desc->sockets[socket_id].p = NULL;
+	desc->sockets[socket_id].cork = false;
 
 	lwip_config_socket(&desc->sockets[socket_id]);
 
@@ -571,36 +572,34 @@ static int32_t lwip_socket_open(void *net, uint32_t *sock_id,
 }
 
 /**
- * @brief Send a TCP packet.
- * @param net - lwip sockets layer specific descriptor.
- * @param sock_id - index of the socket to send data to.
+ * @brief Queue data on a TCP connection.
+ * @param sock - lwip socket descriptor.
  * @param data - pointer to the data array.
  * @param size - size of data array.
- * @return 0 in the case of success, negative error code otherwise
+ * @param flags - TCP_WRITE_FLAG_COPY if lwip should keep its own copy of the
+ * data, 0 if the data is referenced until acknowledged by the remote.
+ * @return number of queued bytes in the case of success, negative error code
+ * otherwise
  */
-static int32_t lwip_socket_send(void *net, uint32_t sock_id, const void *data,
-				uint32_t size)
+static int32_t _lwip_socket_write(struct lwip_socket_desc *sock,
+				  const void *data, uint32_t size,
+				  uint8_t flags)
 {
-	struct lwip_network_desc *desc = net;
-	struct lwip_socket_desc *sock;
 	uint32_t avail;
-	uint32_t flags;
 	err_t err;
 
-	sock = _get_sock(desc, sock_id);
-	if (!sock)
-		return -EINVAL;
-
 	if (sock->state != SOCKET_CONNECTED)
 		return -ENOTCONN;
 
 	avail = tcp_sndbuf(sock->pcb);
-	flags = TCP_WRITE_FLAG_COPY;
-	if (avail < size)
-		/* Partial write */
+	if (avail < size || sock->cork)
+		/* Partial or corked write, more data will follow */
 		flags |= TCP_WRITE_FLAG_MORE;
 
 	size = no_os_min(avail, size);
+	if (!size)
+		return 0;
+
 	err = tcp_write(sock->pcb, data, size, flags);
 	if (err != ERR_OK)
 		return err;
@@ -615,6 +614,54 @@ static int32_t lwip_socket_send(void *net, uint32_t sock_id, const void *data,
 	return size;
 }
 
+/**
+ * @brief Send a TCP packet.
+ * @param net - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket to send data to.
+ * @param data - pointer to the data array.
+ * @param size - size of data array.
+ * @return 0 in the case of success, negative error code otherwise
+ */
+static int32_t lwip_socket_send(void *net, uint32_t sock_id, const void *data,
+				uint32_t size)
+{
+	struct lwip_network_desc *desc = net;
+	struct lwip_socket_desc *sock;
+
+	sock = _get_sock(desc, sock_id);
+	if (!sock)
+		return -EINVAL;
+
+	return _lwip_socket_write(sock, data, size, TCP_WRITE_FLAG_COPY);
+}
+
+/**
+ * @brief Mark bytes at the head of the receive chain as read and release the
+ * pbufs that were fully consumed.
+ * @param socket - lwip socket descriptor.
+ * @param len - number of bytes to consume, at most the length of the current
+ * pbuf segment.
+ */
+static void _lwip_socket_consume(struct lwip_socket_desc *socket, uint32_t len)
+{
+	struct pbuf *p = socket->p;
+
+	socket->p_idx += len;
+	if (socket->p_idx < p->len)
+		return;
+
+	/* Done with current p. Cleanup and mark as read */
+	socket->p = p->next;
+	if (socket->p)
+		pbuf_ref(socket->p);
+
+	if (p->ref > 0)
+		pbuf_free(p);
+
+	tcp_recved(socket->pcb, socket->p_idx);
+	socket->p_idx = 0;
+}
+
 /**
  * @brief Receive a TCP packet.
  * @param net - lwip sockets layer specific descriptor.
@@ -628,7 +675,6 @@ static int32_t lwip_socket_recv(void *net, uint32_t sock_id, void *data,
 {
 	struct lwip_network_desc *desc = net;
 	struct lwip_socket_desc *socket;
-	struct pbuf *p, *old_p;
 	uint8_t *buf, *pdata;
 	uint32_t i, len;
 
@@ -640,36 +686,186 @@ static int32_t lwip_socket_recv(void *net, uint32_t sock_id, void *data,
 		return -ENOTCONN;
 
 	i = 0;
-	p = socket->p;
 	pdata = data;
 
 	/* Iterate over payloads until requested data has been read */
-	while (p && i < size) {
-		len = no_os_min(size - i, p->len - socket->p_idx);
-		buf = p->payload;
+	while (socket->p && i < size) {
+		len = no_os_min(size - i, socket->p->len - socket->p_idx);
+		buf = socket->p->payload;
 		buf += socket->p_idx;
 		memcpy(pdata + i, buf, len);
 		i += len;
-		socket->p_idx += len;
-		if (socket->p_idx == p->len) {
-			/* Done with current p. Cleanup and mark as read */
-			old_p = p;
-			p = p->next;
-			if (p)
-				pbuf_ref(p);
-
-			if (old_p->ref > 0)
-				pbuf_free(old_p);
-
-			tcp_recved(socket->pcb, socket->p_idx);
-			socket->p_idx = 0;
-		}
+		_lwip_socket_consume(socket, len);
 	}
-	socket->p = p;
 
 	return i;
 }
 
+/**
+ * @brief Send data without copying it into the lwip buffers.
+ * @param desc - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket to send data to.
+ * @param data - pointer to the data array. It is referenced by the queued
+ * segments and must not be modified until lwip_socket_unacked() reports that
+ * the remote acknowledged it.
+ * @param size - size of data array.
+ * @return number of queued bytes in the case of success, negative error code
+ * otherwise
+ */
+int32_t lwip_socket_send_nocopy(struct lwip_network_desc *desc,
+				uint32_t sock_id, const void *data,
+				uint32_t size)
+{
+	struct lwip_socket_desc *sock;
+
+	sock = _get_sock(desc, sock_id);
+	if (!sock)
+		return -EINVAL;
+
+	return _lwip_socket_write(sock, data, size, 0);
+}
+
+/**
+ * @brief Push the data queued on a socket to the network.
+ * @param desc - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket.
+ * @return 0 in the case of success, negative error code otherwise
+ */
+int32_t lwip_socket_flush(struct lwip_network_desc *desc, uint32_t sock_id)
+{
+	struct lwip_socket_desc *sock;
+
+	sock = _get_sock(desc, sock_id);
+	if (!sock)
+		return -EINVAL;
+
+	if (sock->state != SOCKET_CONNECTED)
+		return -ENOTCONN;
+
+	return tcp_output(sock->pcb);
+}
+
+/**
+ * @brief Cork or uncork a socket. While corked, send calls only queue data
+ * and lwip emits full segments. Uncorking flushes the queued data.
+ * @param desc - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket.
+ * @param cork - true to cork, false to uncork.
+ * @return 0 in the case of success, negative error code otherwise
+ */
+int32_t lwip_socket_set_cork(struct lwip_network_desc *desc, uint32_t sock_id,
+			     bool cork)
+{
+	struct lwip_socket_desc *sock;
+
+	sock = _get_sock(desc, sock_id);
+	if (!sock)
+		return -EINVAL;
+
+	sock->cork = cork;
+	if (cork || sock->state != SOCKET_CONNECTED)
+		return 0;
+
+	return tcp_output(sock->pcb);
+}
+
+/**
+ * @brief Get the number of bytes that were queued on a socket but not yet
+ * acknowledged by the remote.
+ * @param desc - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket.
+ * @return number of bytes in the case of success, negative error code
+ * otherwise
+ */
+int32_t lwip_socket_unacked(struct lwip_network_desc *desc, uint32_t sock_id)
+{
+	struct lwip_socket_desc *sock;
+
+	sock = _get_sock(desc, sock_id);
+	if (!sock)
+		return -EINVAL;
+
+	if (!sock->pcb)
+		return 0;
+
+	return sock->pcb->snd_lbb - sock->pcb->lastack;
+}
+
+/**
+ * @brief Get the next received segment without copying it.
+ * @param desc - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket to receive data from.
+ * @param data - set to the first unread byte of the segment.
+ * @return number of bytes available at data, 0 if there is nothing to read,
+ * negative error code otherwise. The data stays valid until it is released
+ * with lwip_socket_recv_done().
+ */
+int32_t lwip_socket_recv_peek(struct lwip_network_desc *desc, uint32_t sock_id,
+			      const void **data)
+{
+	struct lwip_socket_desc *socket;
+
+	socket = _get_sock(desc, sock_id);
+	if (!socket || !data)
+		return -EINVAL;
+
+	if (!socket->p) {
+		if (socket->state != SOCKET_CONNECTED)
+			return -ENOTCONN;
+
+		return 0;
+	}
+
+	*data = (uint8_t *)socket->p->payload + socket->p_idx;
+
+	return socket->p->len - socket->p_idx;
+}
+
+/**
+ * @brief Release bytes handed out by lwip_socket_recv_peek().
+ * @param desc - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket.
+ * @param len - number of bytes consumed from the current segment.
+ * @return 0 in the case of success, negative error code otherwise
+ */
+int32_t lwip_socket_recv_done(struct lwip_network_desc *desc, uint32_t sock_id,
+			      uint32_t len)
+{
+	struct lwip_socket_desc *socket;
+
+	socket = _get_sock(desc, sock_id);
+	if (!socket)
+		return -EINVAL;
+
+	if (!socket->p || len > socket->p->len - socket->p_idx)
+		return -EINVAL;
+
+	if (len)
+		_lwip_socket_consume(socket, len);
+
+	return 0;
+}
+
+/**
+ * @brief Check if a socket has received data that was not read yet.
+ * @param net - lwip sockets layer specific descriptor.
+ * @param sock_id - index of the socket.
+ * @return 1 if data is available or the socket is not connected anymore,
+ * 0 if there is nothing to read, negative error code otherwise.
+ */
+static int32_t lwip_socket_readable(void *net, uint32_t sock_id)
+{
+	struct lwip_network_desc *desc = net;
+	struct lwip_socket_desc *socket;
+
+	socket = _get_sock(desc, sock_id);
+	if (!socket)
+		return -EINVAL;
+
+	/* Report a closed socket as readable, recv will return the error */
+	return socket->p || socket->state != SOCKET_CONNECTED;
+}
+
 /**
  * @brief Bind a socket to a port.
  * @param net - lwip sockets layer specific descriptor.
@@ -916,6 +1112,7 @@ struct network_interface lwip_socket_ops = {
 	.socket_bind = lwip_socket_bind,
 	.socket_listen = lwip_socket_listen,
 	.socket_accept = lwip_socket_accept,
+	.socket_readable = lwip_socket_readable,
 };
 
 /**
@@ -937,6 +1134,7 @@ static void lwip_config_if(struct lwip_network_desc *desc)
 	net->socket_bind = lwip_socket_bind;
 	net->socket_listen = lwip_socket_listen;
 	net->socket_accept = lwip_socket_accept;
+	net->socket_readable = lwip_socket_readable;
 
 	net->net = desc;
 }
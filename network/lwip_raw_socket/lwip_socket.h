@@ -42,6 +42,7 @@
 
 #ifdef NO_OS_LWIP_NETWORKING
 
+#include <stdbool.h>
 #include "lwip/netif.h"
 #include "network_interface.h"
 #include "tcp_socket.h"
@@ -82,6 +83,8 @@ struct lwip_socket_desc {
 	struct pbuf *p;
 	/* Index of the current read byte in the first pbuf of the chain */
 	uint32_t p_idx;
+	/* Send calls only queue data until uncorked or flushed */
+	bool cork;
 	/* Reference to the parent network descriptor. */
 	struct lwip_network_desc *desc;
 };
@@ -126,5 +129,23 @@ int32_t no_os_lwip_step(struct lwip_network_desc *, void *);
 
 extern struct network_interface lwip_socket_ops;
 
+/* Send data that stays referenced by lwip until acknowledged */
+int32_t lwip_socket_send_nocopy(struct lwip_network_desc *desc,
+				uint32_t sock_id, const void *data,
+				uint32_t size);
+/* Push the queued data of a socket to the network */
+int32_t lwip_socket_flush(struct lwip_network_desc *desc, uint32_t sock_id);
+/* Cork or uncork a socket */
+int32_t lwip_socket_set_cork(struct lwip_network_desc *desc, uint32_t sock_id,
+			     bool cork);
+/* Number of bytes sent but not yet acknowledged by the remote */
+int32_t lwip_socket_unacked(struct lwip_network_desc *desc, uint32_t sock_id);
+/* Get the next received segment without copying it */
+int32_t lwip_socket_recv_peek(struct lwip_network_desc *desc, uint32_t sock_id,
+			      const void **data);
+/* Release bytes obtained with lwip_socket_recv_peek() */
+int32_t lwip_socket_recv_done(struct lwip_network_desc *desc, uint32_t sock_id,
+			      uint32_t len);
+
 #endif /* NO_OS_LWIP_NETWORKING */
 #endif
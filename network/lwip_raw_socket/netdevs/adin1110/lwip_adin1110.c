@@ -66,7 +66,35 @@
 static uint8_t lwip_buff[ADIN1110_LWIP_BUFF_SIZE];
 
 /**
- * @brief Read a frame from the RX FIFO.
+ * @brief Get the memory segments of a pbuf chain.
+ * @param p - the pbuf chain.
+ * @param segs - the segments, ADIN1110_MAX_FRAME_SEGS entries.
+ * @return the number of segments, 0 if the chain has too many pbufs.
+ */
+static uint32_t adin1110_pbuf_segs(struct pbuf *p,
+				   struct adin1110_buf_seg *segs)
+{
+	uint32_t nb_segs = 0;
+	struct pbuf *q;
+
+	for (q = p; q; q = q->next) {
+		if (nb_segs == ADIN1110_MAX_FRAME_SEGS)
+			return 0;
+
+		segs[nb_segs].buf = q->payload;
+		segs[nb_segs].len = q->len;
+		nb_segs++;
+
+		if (q->tot_len == q->len)
+			break;
+	}
+
+	return nb_segs;
+}
+
+/**
+ * @brief Read a frame from the RX FIFO. The frame is received directly in the
+ * pool pbufs, unless the chain is too long for a single SPI transfer.
  * @param desc - ADIN1110 descriptor.
  * @param p - the received pbuf.
  * @param len - length of the frame.
@@ -75,27 +103,48 @@ static uint8_t lwip_buff[ADIN1110_LWIP_BUFF_SIZE];
 static int adin1110_read_frames(struct adin1110_desc *desc, struct pbuf **p,
 				uint32_t *len)
 {
+	struct adin1110_buf_seg segs[ADIN1110_MAX_FRAME_SEGS];
 	struct adin1110_eth_buff mac_buff = {0};
+	uint32_t nb_segs;
 	int ret;
 
-	mac_buff.payload = &lwip_buff[ADIN1110_ETH_HDR_LEN];
-
-	ret = adin1110_read_fifo(desc, 0, &mac_buff);
-	if (ret)
+	ret = adin1110_rx_frame_len(desc, 0, len);
+	if (ret || !*len)
 		return ret;
 
-	*len = mac_buff.len;
-	if (!mac_buff.len)
-		return 0;
+	*p = pbuf_alloc(PBUF_RAW, *len, PBUF_POOL);
+	if (!*p) {
+		/* Drop the frame, so that the next ones can still be read */
+		LINK_STATS_INC(link.memerr);
+		LINK_STATS_INC(link.drop);
+		adin1110_read_fifo_sg(desc, 0, NULL, 0, *len);
 
-	memcpy(lwip_buff, mac_buff.mac_dest, ADIN1110_ETH_HDR_LEN);
-	*p = pbuf_alloc(PBUF_RAW, mac_buff.len, PBUF_POOL);
-	if (!*p)
 		return -ENOMEM;
+	}
 
+	nb_segs = adin1110_pbuf_segs(*p, segs);
+	if (nb_segs) {
+		ret = adin1110_read_fifo_sg(desc, 0, segs, nb_segs, *len);
+		if (ret)
+			goto free_pbuf;
+
+		return 0;
+	}
+
+	mac_buff.payload = &lwip_buff[ADIN1110_ETH_HDR_LEN];
+	ret = adin1110_read_fifo(desc, 0, &mac_buff);
+	if (ret)
+		goto free_pbuf;
+
+	memcpy(lwip_buff, mac_buff.mac_dest, ADIN1110_ETH_HDR_LEN);
 	pbuf_take(*p, lwip_buff, mac_buff.len);
 
 	return 0;
+
+free_pbuf:
+	pbuf_free(*p);
+
+	return ret;
 }
 
 /**
@@ -134,22 +183,30 @@ static int32_t adin1110_step(struct lwip_network_desc *desc, void *data)
 }
 
 /**
- * @brief Write the data inside a pbuf on the wire.
+ * @brief Write the data inside a pbuf on the wire. The pbuf chain is sent
+ * directly, unless it's too long for a single SPI transfer.
  * @param net - lwip network descriptor to send data to.
  * @param p - pbuf to be sent.
  * @return 0 in case of success, negative error otherwise.
  */
 static int32_t adin1110_netif_output(struct netif *net, struct pbuf *p)
 {
+	struct adin1110_buf_seg segs[ADIN1110_MAX_FRAME_SEGS];
 	struct lwip_network_desc *lwip_desc;
 	struct adin1110_desc *mac_desc;
 	struct adin1110_eth_buff buff;
 	uint32_t frame_len;
+	uint32_t nb_segs;
 
 	lwip_desc = net->state;
 	mac_desc = lwip_desc->mac_desc;
 
 	LINK_STATS_INC(link.xmit);
+
+	nb_segs = adin1110_pbuf_segs(p, segs);
+	if (nb_segs)
+		return adin1110_write_fifo_sg(mac_desc, 0, segs, nb_segs);
+
 	frame_len = pbuf_copy_partial(p, lwip_buff, p->tot_len, 0);
 
 	memcpy(&buff.mac_dest, lwip_buff, ADIN1110_ETH_HDR_LEN);
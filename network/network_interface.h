@@ -218,6 +218,19 @@ struct network_interface {
 	 */
 	int32_t (*socket_accept)(void *net, uint32_t sock_id,
 				 uint32_t *client_socket_id);
+
+	/**
+	 * @brief Check if a socket can be read without blocking.
+	 *
+	 * Optional. If not implemented, the socket is considered readable.
+	 * @param net - Network interface
+	 * @param sock_id - Socket id
+	 * @return
+	 *  - 1 : Data is available or the connection was closed by the remote
+	 *  - 0 : No data is available
+	 *  - \ref Negative error code on failure
+	 */
+	int32_t (*socket_readable)(void *net, uint32_t sock_id);
 };
 
 #endif
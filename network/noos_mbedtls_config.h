@@ -99,6 +99,25 @@
  */
 #define ENABLE_MEMORY_OPTIMIZATIONS
 
+/*
+ * Resume sessions with session tickets (RFC 5077) in addition to session IDs.
+ * Resumption is enabled for a socket by secure_init_param.session.
+ */
+//#define ENABLE_SESSION_TICKETS
+
+/*
+ * Negotiate a smaller record size with secure_init_param.max_frag_len
+ * (RFC 6066), for servers that support it.
+ */
+//#define ENABLE_MAX_FRAGMENT_LENGTH
+
+/*
+ * Allocate all the memory of the library from a static buffer of this size
+ * instead of the heap. The size needed depends on MAX_CONTENT_LEN, the
+ * certificates and the number of simultaneous connections.
+ */
+//#define STATIC_MEMORY_SIZE 32768
+
 /******************************************************************************/
 /********************* Minimal tls client requirements ************************/
 /******************************************************************************/
@@ -161,6 +180,26 @@
 
 #endif /* ENABLE_PEM_CERT */
 
+#ifdef ENABLE_SESSION_TICKETS
+
+#define MBEDTLS_SSL_SESSION_TICKETS
+
+#endif /* ENABLE_SESSION_TICKETS */
+
+#ifdef ENABLE_MAX_FRAGMENT_LENGTH
+
+#define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+
+#endif /* ENABLE_MAX_FRAGMENT_LENGTH */
+
+#ifdef STATIC_MEMORY_SIZE
+
+#define MBEDTLS_PLATFORM_C
+#define MBEDTLS_PLATFORM_MEMORY
+#define MBEDTLS_MEMORY_BUFFER_ALLOC_C
+
+#endif /* STATIC_MEMORY_SIZE */
+
 /******************************************************************************/
 /**************** Solve dependencies needed by modules ************************/
 /******************************************************************************/
@@ -43,6 +43,7 @@
 /******************************************************************************/
 
 #include <stdlib.h>
+#include <string.h>
 #include "no_os_error.h"
 #include "tcp_socket.h"
 #include "no_os_util.h"
@@ -51,6 +52,9 @@
 #ifndef DISABLE_SECURE_SOCKET
 #include "noos_mbedtls_config.h"
 #include "no_os_trng.h"
+#ifdef MBEDTLS_MEMORY_BUFFER_ALLOC_C
+#include "mbedtls/memory_buffer_alloc.h"
+#endif
 #endif /* DISABLE_SECURE_SOCKET */
 
 /******************************************************************************/
@@ -96,7 +100,25 @@ struct secure_socket_desc {
 	mbedtls_ssl_config	conf;
 	/** Mbedtls tls context */
 	mbedtls_ssl_context	ssl;
+	/** Session to resume, owned by the application */
+	struct secure_session	*session;
+	/** Small writes coalesced into one record */
+	uint8_t			*tx_buff;
+	/** Size of tx_buff, 0 if writes are not coalesced */
+	uint32_t		tx_size;
+	/** Bytes in tx_buff */
+	uint32_t		tx_len;
+	/** Bytes of tx_buff already taken by the TLS layer */
+	uint32_t		tx_sent;
+	/** Partial record written, mbedtls_ssl_write() must be repeated */
+	bool			tx_pending;
 };
+
+#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) && defined(STATIC_MEMORY_SIZE)
+/* All the memory of the TLS library, the heap is not used */
+static unsigned char tls_heap[STATIC_MEMORY_SIZE];
+static bool tls_heap_ready;
+#endif
 #endif /* DISABLE_SECURE_SOCKET */
 
 /******************************************************************************/
@@ -117,16 +139,143 @@ static int tls_net_recv(struct tcp_socket_desc *sock, unsigned char *buff,
 	return ret;
 }
 
-/* Wrapper over socket_recv */
+/* Wrapper over socket_send */
 static int tls_net_send(struct tcp_socket_desc *sock, unsigned char *buff,
 			size_t len)
 {
-	return sock->net->socket_send(sock->net->net, sock->id, buff, len);
+	int32_t ret;
+
+	ret = sock->net->socket_send(sock->net->net, sock->id, buff, len);
+	if (ret == -EAGAIN)
+		return MBEDTLS_ERR_SSL_WANT_WRITE;
+
+	return ret;
+}
+
+/* Write a record, -EAGAIN if the call must be repeated with the same data */
+static int32_t stcp_socket_write(struct secure_socket_desc *desc,
+				 const void *data, uint32_t len)
+{
+	int ret;
+
+	ret = mbedtls_ssl_write(&desc->ssl, data, len);
+	desc->tx_pending = ret == MBEDTLS_ERR_SSL_WANT_WRITE ||
+			   ret == MBEDTLS_ERR_SSL_WANT_READ;
+	if (desc->tx_pending)
+		return -EAGAIN;
+
+	return ret;
+}
+
+/* Write the coalesced data, -EAGAIN if the socket did not take all of it */
+static int32_t stcp_socket_flush(struct secure_socket_desc *desc)
+{
+	int32_t ret;
+
+	while (desc->tx_len) {
+		ret = stcp_socket_write(desc, &desc->tx_buff[desc->tx_sent],
+					desc->tx_len - desc->tx_sent);
+		if (ret < 0)
+			return ret;
+
+		desc->tx_sent += ret;
+		if (desc->tx_sent == desc->tx_len) {
+			desc->tx_sent = 0;
+			desc->tx_len = 0;
+		}
+	}
+
+	return 0;
+}
+
+/* Coalesce small writes, larger ones are written as records of their own */
+static int32_t stcp_socket_send(struct secure_socket_desc *desc,
+				const void *data, uint32_t len)
+{
+	uint32_t n;
+	int32_t ret;
+
+	if (!desc->tx_size)
+		return stcp_socket_write(desc, data, len);
+
+	/*
+	 * mbedtls only completes a partial record when the write is repeated,
+	 * the data given to that write counts as sent without being encrypted.
+	 * The pending record must be finished before new data is taken.
+	 */
+	if (desc->tx_pending) {
+		/* A record written directly, the caller repeats its data */
+		if (!desc->tx_len)
+			return stcp_socket_write(desc, data, len);
+
+		ret = stcp_socket_flush(desc);
+		if (ret)
+			return ret;
+	}
+
+	if (desc->tx_len == desc->tx_size) {
+		ret = stcp_socket_flush(desc);
+		if (ret)
+			return ret;
+	}
+
+	if (!desc->tx_len && len >= desc->tx_size)
+		return stcp_socket_write(desc, data, len);
+
+	n = no_os_min(len, desc->tx_size - desc->tx_len);
+	memcpy(&desc->tx_buff[desc->tx_len], data, n);
+	desc->tx_len += n;
+	if (desc->tx_len == desc->tx_size) {
+		/* The data is taken, a full socket only delays the record */
+		ret = stcp_socket_flush(desc);
+		if (ret && ret != -EAGAIN)
+			return ret;
+	}
+
+	return n;
+}
+
+/* Offer the saved session, the server may still ask for a full handshake */
+static void stcp_socket_resume(struct secure_socket_desc *desc)
+{
+	if (!desc->session || !desc->session->valid)
+		return;
+
+	if (mbedtls_ssl_set_session(&desc->ssl, &desc->session->session))
+		socket_session_free(desc->session);
+}
+
+/* Keep the session of the handshake just done for the next connection */
+static void stcp_socket_save(struct secure_socket_desc *desc)
+{
+	if (!desc->session)
+		return;
+
+	socket_session_free(desc->session);
+	if (!mbedtls_ssl_get_session(&desc->ssl, &desc->session->session))
+		desc->session->valid = true;
+}
+
+/**
+ * @brief Forget a TLS session saved for resumption.
+ *
+ * Must be called before the storage of the session is released.
+ * @param session - The session.
+ */
+void socket_session_free(struct secure_session *session)
+{
+	if (!session)
+		return;
+
+	mbedtls_ssl_session_free(&session->session);
+	session->valid = false;
 }
 
 /* Remove secure descriptor*/
 static void stcp_socket_remove(struct secure_socket_desc *desc)
 {
+	no_os_free(desc->tx_buff);
+	mbedtls_ssl_free(&desc->ssl);
 	mbedtls_pk_free(&desc->pkey);
 	mbedtls_x509_crt_free(&desc->clicert);
 	mbedtls_x509_crt_free(&desc->cacert);
@@ -143,11 +292,19 @@ static int32_t stcp_socket_init(struct secure_socket_desc **desc,
 				struct secure_init_param *param)
 {
 	struct secure_socket_desc	*ldesc;
+	uint32_t			max_len;
 	int32_t				ret;
 
 	if (!desc || !param)
 		return -1;
 
+#if defined(MBEDTLS_MEMORY_BUFFER_ALLOC_C) && defined(STATIC_MEMORY_SIZE)
+	if (!tls_heap_ready) {
+		mbedtls_memory_buffer_alloc_init(tls_heap, sizeof(tls_heap));
+		tls_heap_ready = true;
+	}
+#endif
+
 	ldesc = (typeof(ldesc))no_os_calloc(1, sizeof(*ldesc));
 	if (!ldesc)
 		return -1;
@@ -220,6 +377,39 @@ static int32_t stcp_socket_init(struct secure_socket_desc **desc,
 			goto exit;
 	}
 
+	/* Records larger than the negotiated fragment length are split */
+	max_len = MBEDTLS_SSL_MAX_CONTENT_LEN;
+	if (param->max_frag_len) {
+#ifdef MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
+		ret = mbedtls_ssl_conf_max_frag_len(&ldesc->conf,
+						    param->max_frag_len);
+		if (ret)
+			goto exit;
+		/* Codes start at 1 for 512 bytes, each next one doubles it */
+		max_len = no_os_min(max_len, 256u << param->max_frag_len);
+#else
+		ret = -ENOTSUP;
+		goto exit;
+#endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+	}
+
+	if (param->tx_buff_size) {
+		ldesc->tx_size = no_os_min(param->tx_buff_size, max_len);
+		ldesc->tx_buff = no_os_malloc(ldesc->tx_size);
+		if (!ldesc->tx_buff) {
+			ret = -ENOMEM;
+			goto exit;
+		}
+	}
+
+	if (param->session) {
+		ldesc->session = param->session;
+#ifdef MBEDTLS_SSL_SESSION_TICKETS
+		mbedtls_ssl_conf_session_tickets(&ldesc->conf,
+				MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+	}
+
 	/* Config Random number generator */
 	mbedtls_ssl_conf_rng(&ldesc->conf,
 			     (int (*)(void *, unsigned char *, size_t))
@@ -348,11 +538,17 @@ int32_t socket_connect(struct tcp_socket_desc *desc,
 
 #ifndef DISABLE_SECURE_SOCKET
 	if (desc->secure) {
+		stcp_socket_resume(desc->secure);
 		do {
 			ret = mbedtls_ssl_handshake(&desc->secure->ssl);
-		} while (ret == MBEDTLS_ERR_SSL_WANT_READ);
-		if (NO_OS_IS_ERR_VALUE(ret))
+		} while (ret == MBEDTLS_ERR_SSL_WANT_READ ||
+			 ret == MBEDTLS_ERR_SSL_WANT_WRITE);
+		if (NO_OS_IS_ERR_VALUE(ret)) {
+			socket_session_free(desc->secure->session);
 			return ret;
+		}
+
+		stcp_socket_save(desc->secure);
 	}
 #endif /* DISABLE_SECURE_SOCKET */
 
@@ -366,14 +562,26 @@ int32_t socket_disconnect(struct tcp_socket_desc *desc)
 		return -1;
 
 #ifndef DISABLE_SECURE_SOCKET
-	if (desc->secure)
+	if (desc->secure) {
+		stcp_socket_flush(desc->secure);
 		mbedtls_ssl_close_notify(&desc->secure->ssl);
+		/* Ready for a new handshake if the socket connects again */
+		mbedtls_ssl_session_reset(&desc->secure->ssl);
+		desc->secure->tx_len = 0;
+		desc->secure->tx_sent = 0;
+		desc->secure->tx_pending = false;
+	}
 #endif /* DISABLE_SECURE_SOCKET */
 
 	return desc->net->socket_disconnect(desc->net->net, desc->id);
 }
 
-/** @brief See \ref network_interface.socket_send */
+/**
+ * @brief See \ref network_interface.socket_send
+ *
+ * On TLS sockets -EAGAIN means a record is pending in the TLS layer, the
+ * call must be repeated with the same data.
+ */
 int32_t socket_send(struct tcp_socket_desc *desc, const void *data,
 		    uint32_t len)
 {
@@ -383,14 +591,20 @@ int32_t socket_send(struct tcp_socket_desc *desc, const void *data,
 
 #ifndef DISABLE_SECURE_SOCKET
 	if (desc->secure)
-		return mbedtls_ssl_write(&desc->secure->ssl, data, len);
+		return stcp_socket_send(desc->secure, data, len);
 #endif /* DISABLE_SECURE_SOCKET */
 
 	return desc->net->socket_send(desc->net->net, desc->id,
 				      data, len);
 }
 
-/** @brief See \ref network_interface.socket_recv */
+/**
+ * @brief See \ref network_interface.socket_recv
+ *
+ * On TLS sockets the coalesced data is written first. Nothing is read and
+ * -EAGAIN is returned while a record is partially written, mbedtls doesn't
+ * allow a read before the pending write completes.
+ */
 int32_t socket_recv(struct tcp_socket_desc *desc, void *data, uint32_t len)
 {
 	if (!desc)
@@ -400,6 +614,15 @@ int32_t socket_recv(struct tcp_socket_desc *desc, void *data, uint32_t len)
 	int32_t ret;
 
 	if (desc->secure) {
+		/* The peer may be waiting for the coalesced request */
+		ret = stcp_socket_flush(desc->secure);
+		if (ret)
+			return ret;
+
+		/* A socket_send() returned -EAGAIN and wasn't repeated yet */
+		if (desc->secure->tx_pending)
+			return -EAGAIN;
+
 		ret = mbedtls_ssl_read(&desc->secure->ssl, data, len);
 		if (ret == MBEDTLS_ERR_SSL_WANT_READ)
 			return -EAGAIN;
@@ -461,3 +684,43 @@ int32_t socket_accept(struct tcp_socket_desc *desc,
 	return 0;
 }
 
+
+/** @brief See \ref network_interface.socket_readable */
+int32_t socket_readable(struct tcp_socket_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+#ifndef DISABLE_SECURE_SOCKET
+	/* Decrypted data may already be waiting in the TLS layer */
+	if (desc->secure && mbedtls_ssl_get_bytes_avail(&desc->secure->ssl))
+		return 1;
+#endif
+
+	if (!desc->net->socket_readable)
+		return 1;
+
+	return desc->net->socket_readable(desc->net->net, desc->id);
+}
+
+/**
+ * @brief Write the data coalesced by socket_send().
+ *
+ * Only TLS sockets with secure_init_param.tx_buff_size set coalesce writes,
+ * for the others this does nothing.
+ * @param desc - Socket descriptor
+ * @return 0 if everything was written, -EAGAIN if the socket is full and the
+ * 	   call must be repeated, negative error code otherwise.
+ */
+int32_t socket_flush(struct tcp_socket_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+#ifndef DISABLE_SECURE_SOCKET
+	if (desc->secure)
+		return stcp_socket_flush(desc->secure);
+#endif /* DISABLE_SECURE_SOCKET */
+
+	return 0;
+}
@@ -50,6 +50,7 @@
 #include "mbedtls/ssl.h"
 #endif
 #include <stdint.h>
+#include <stdbool.h>
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -69,6 +70,18 @@ struct tcp_socket_desc {
 };
 
 #ifndef DISABLE_SECURE_SOCKET
+/**
+ * @struct secure_session
+ * @brief TLS session kept across connections to skip the full handshake on
+ * reconnect. Zero initialized storage holds no session.
+ */
+struct secure_session {
+	/** Session ID or ticket of the last successful handshake */
+	mbedtls_ssl_session	session;
+	/** True if session can be offered to the server */
+	bool			valid;
+};
+
 /**
  * @struct stcp_socket_init_param
  * @brief Parameter to initialize a TCP Socket
@@ -109,6 +122,25 @@ struct secure_init_param {
 	uint8_t			*cli_pk;
 	/** cli_pk length */
 	uint32_t		cli_pk_len;
+	/**
+	 * Session to resume, updated after each successful handshake. It must
+	 * outlive the socket so it can be reused by the next one. NULL to
+	 * always do a full handshake.
+	 */
+	struct secure_session	*session;
+	/**
+	 * Maximum fragment length to negotiate, one of
+	 * MBEDTLS_SSL_MAX_FRAG_LEN_*. Needs MBEDTLS_SSL_MAX_FRAGMENT_LENGTH,
+	 * 0 to not negotiate it.
+	 */
+	uint8_t			max_frag_len;
+	/**
+	 * Size of the buffer coalescing small writes into a single record, 0
+	 * to write a record for each socket_send(). It is limited to the
+	 * maximum record payload. The buffer is written when full, by
+	 * socket_flush() and before reading.
+	 */
+	uint32_t		tx_buff_size;
 };
 
 #endif /* DISABLE_SECURE_SOCKET */
@@ -170,4 +202,15 @@ int32_t socket_listen(struct tcp_socket_desc *desc, uint32_t back_log);
 int32_t socket_accept(struct tcp_socket_desc *desc,
 		      struct tcp_socket_desc **new_client);
 
+/* Check if socket can be read without blocking */
+int32_t socket_readable(struct tcp_socket_desc *desc);
+
+/* Write the data coalesced by socket_send() */
+int32_t socket_flush(struct tcp_socket_desc *desc);
+
+#ifndef DISABLE_SECURE_SOCKET
+/* Forget a TLS session saved for resumption */
+void socket_session_free(struct secure_session *session);
+#endif /* DISABLE_SECURE_SOCKET */
+
 #endif
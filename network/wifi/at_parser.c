@@ -42,6 +42,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include <ctype.h>
 #include <inttypes.h>
 #include <stdarg.h>
 #include <stdlib.h>
@@ -55,13 +56,12 @@
 #include "no_os_util.h"
 #include "no_os_error.h"
 #include "no_os_alloc.h"
+#include "no_os_lf_ring.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
-/* Should be sizeof(async_msgs)/sizeof(*async_msgs) */
-#define NB_ASYNC_MESSAGES	3
 /* Should be sizeof(responses)/sizeof(*responses) */
 #define NB_RESPONSE_MESSAGES	4
 /* Max command length: at+cwsap=max_ssid_32,max_pass_64,0,0 -> 110 characters */
@@ -72,6 +72,8 @@
 #define PUI8(X)			((uint8_t *)(X))
 /* Timeout waiting for module response. (20 seconds) */
 #define MODULE_TIMEOUT		20000
+/* Length of "+IPD," */
+#define AT_IPD_PREFIX_LEN	5
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -119,6 +121,18 @@ struct connection_desc {
 	enum socket_type	type;
 };
 
+/* State of the receive path */
+enum at_operation {
+	/* Normal mode. Read each char and interpret the result */
+	READING_RESPONSES,
+	/* When an +IPD is received, callback enter in this mode */
+	READING_PAYLOAD,
+	/* Used when a reset command have been sent */
+	RESETTING_MODULE,
+	/* Used when using AT_SEND to wait for the character '>' */
+	WAITING_SEND
+};
+
 /* Structure storing the status of the parser */
 struct at_desc {
 	/* - Uart related fields */
@@ -128,6 +142,8 @@ struct at_desc {
 	struct no_os_irq_ctrl_desc	*irq_desc;
 	/* Uart irq id */
 	uint32_t		uart_irq_id;
+	/* Ring filled by the application UART handler, NULL if not used */
+	struct no_os_lf_ring	*rx_ring;
 
 	/* - Connection related fields */
 	/* Structures storing connections status */
@@ -157,34 +173,13 @@ struct at_desc {
 	/* Store the wifi status */
 	bool is_wifi_connected;
 	/* State of the callback */
-	volatile enum {
-		/* Normal mode. Read each char and interpret the result */
-		READING_RESPONSES,
-		/* When an +IPD is received, callback enter in this mode */
-		READING_PAYLOAD,
-		/* Used when a reset command have been sent */
-		RESETTING_MODULE,
-		/* Used when using AT_SEND to wait for the character '>' */
-		WAITING_SEND
-
-	}			callback_operation;
-	/* Indexes in the ready message */
-	uint8_t			ready_idx;
-	/* Indexes in the async response given by the driver */
-	uint8_t			async_idx[NB_ASYNC_MESSAGES];
+	volatile enum at_operation	callback_operation;
+	/* State to return to once a payload is read */
+	enum at_operation	resume_operation;
+	/* Start of the line being received in the result buffer */
+	uint32_t		line_start;
 	/* Indexes in the response given by the driver */
 	uint8_t			resp_idx[NB_RESPONSE_MESSAGES];
-	/* Ipd idx */
-	uint8_t			ipd_idx;
-	/* State of ipd command message */
-	enum {
-		NOT_MATCH,
-		RAEDING_CONN,
-		WAITING_COMMA,
-		READING_LEN
-	}			ipd_stat;
-	/* Variable where current message length is built */
-	uint32_t		ipd_len;
 	/* Will be called when a new connection is created or closed */
 	void			(*connection_callback)(void *ctx, enum at_event,
 			uint32_t conn_id, struct no_os_circular_buffer **cb);
@@ -215,145 +210,274 @@ static inline bool match_message(const struct at_buff *msg, uint8_t *idx,
 	return false;
 }
 
-/* Check if new payload message have been received and set the payload size in
- * to_read if so.
+/* True if the line is exactly the message */
+static inline bool line_is(const uint8_t *line, uint32_t len,
+			   const struct at_buff *msg)
+{
+	return len == msg->len && !memcmp(line, msg->buff, len);
+}
+
+/* Notify the application the first time a connection receives data */
+static void conn_open(struct at_desc *desc)
+{
+	struct connection_desc	*conn;
+
+	conn = &desc->conn[desc->current_conn];
+	if (conn->active)
+		return;
+
+	/*
+	 * Notify that a new connection has started. Application needs
+	 * to set a cbuff for the connection where data will be written.
+	 */
+	desc->connection_callback(desc->callback_ctx, AT_NEW_CONNECTION,
+				  desc->current_conn, &conn->cbuff);
+	if (conn->cbuff)
+		conn->active = true;
+	/*
+	 * Else, a AT_STOP_CONNECTION command should be sent to the
+	 * esp8266 module. (Application rejects the connection)
+	 * This could be done only if implement at_run_cmd with
+	 * no_os_uart_write_nonblocking
+	 */
+}
+
+/* Payload completely received, go back to what was done before the +IPD */
+static inline void conn_done(struct at_desc *desc)
+{
+	desc->callback_operation = desc->resume_operation;
+	desc->current_conn = -1;
+}
+
+/* Copy payload received in a chunk to the connection buffer */
+static uint32_t conn_write(struct at_desc *desc, const uint8_t *data,
+			   uint32_t len)
+{
+	struct connection_desc	*conn;
+	uint32_t		n;
+
+	conn = &desc->conn[desc->current_conn];
+	n = no_os_min(len, conn->to_read);
+	/* Data is discarded if there is no buffer for the connection */
+	if (conn->cbuff && no_os_cb_write(conn->cbuff, data, n))
+		desc->errors |= AT_ERROR_CONN_BUFFER_OVERRUN;
+
+	conn->to_read -= n;
+	if (!conn->to_read)
+		conn_done(desc);
+
+	return n;
+}
+
+/*
+ * Parse "+IPD,[<id>,]<len>" and start reading the payload. line points to the
+ * '+' and len excludes the ':'.
  */
-static inline bool is_payload_message(struct at_desc *desc, uint8_t ch)
+static bool parse_ipd(struct at_desc *desc, const uint8_t *line, uint32_t len)
 {
-	static const struct at_buff	at_ipd = {PUI8("\r\n+IPD,"), 7};
-	/* max_ch_search = at_ipd.len + sizeof("0,1024") */
-	bool		ret;
-
-	ret = false;
-	/* Update ipd_idx until at_ipd message is matched */
-	if (desc->ipd_idx < at_ipd.len) {
-		if (match_message(&at_ipd, &desc->ipd_idx, ch)) {
-			if (desc->multiple_conections)
-				desc->ipd_stat = RAEDING_CONN;
-			else
-				desc->ipd_stat = READING_LEN;
-		}
-		return false;
+	const uint8_t	*end = line + len;
+	uint32_t	id = 0;
+	uint32_t	size = 0;
+
+	line += AT_IPD_PREFIX_LEN;
+	if (desc->multiple_conections) {
+		if (end - line < 2 || line[0] < '0' ||
+		    line[0] >= '0' + MAX_CONNECTIONS || line[1] != ',')
+			return false;
+		id = line[0] - '0';
+		line += 2;
 	}
-	/* Update ipd_idx until ':' is found. Similar to match_messages but
-	 * the message is not fix so we could use that function
-	 */
-	switch (desc->ipd_stat) {
-	case RAEDING_CONN:
-		if (ch < '0' || ch > '4')
-			goto reset;
-		desc->current_conn = ch - '0';
-		desc->ipd_stat = WAITING_COMMA;
-		desc->ipd_idx++;
-		break;
-	case WAITING_COMMA:
-		if (ch != ',')
-			goto reset;
-		desc->ipd_stat = READING_LEN;
-		desc->ipd_idx++;
-		break;
-	case READING_LEN:
-		if (ch < '0' || ch > '9') {
-			if (ch == ':' && desc->ipd_len > 0) {
-				desc->conn[desc->current_conn].to_read =
-					desc->ipd_len;
-				desc->result.len -= desc->ipd_idx;
-				ret = true;
-			}
-			goto reset;
-		}
-		desc->ipd_len = desc->ipd_len * 10 + (ch - '0');
-		desc->ipd_idx++;
-		break;
-	default:
-		goto reset;
+
+	if (line == end)
+		return false;
+
+	for (; line < end; line++) {
+		if (*line < '0' || *line > '9')
+			return false;
+		size = size * 10 + (*line - '0');
 	}
+	if (!size)
+		return false;
 
-	return false;
-reset:
-	desc->ipd_idx = 0;
-	desc->ipd_len = 0;
-	desc->ipd_stat = NOT_MATCH;
+	desc->current_conn = id;
+	desc->conn[id].to_read = size;
+	conn_open(desc);
+	desc->resume_operation = desc->callback_operation;
+	desc->callback_operation = READING_PAYLOAD;
 
-	return ret;
+	return true;
 }
 
-static inline int32_t check_conn_id(struct at_desc *desc, struct at_buff *msg,
-				    int32_t msg_idx)
+/* Update the connection state on "[<id>,]CLOSED\r\n" */
+static bool parse_closed(struct at_desc *desc, const uint8_t *line,
+			 uint32_t len)
 {
-	int32_t	id;
-	int32_t	j;
+	static const struct at_buff closed = {PUI8("CLOSED\r\n"), 8};
+	int32_t id = 0;
 
-	/* Get the connection number of the closed connection */
-	desc->result.len -= (msg->len - 1);
-	/* Update connection state */
-	id = 0;
 	if (desc->multiple_conections) {
-		//Response: 2,CLOSED -> id = 0
-		j = desc->result.len - 2;
-		if (j < 0) {
-			id = -1;
-		} else {
-			if (desc->result.buff[j] >= '0' &&
-			    desc->result.buff[j] <= '3') {
-				id = desc->result.buff[j] - '0';
-				desc->result.len -= 2;
-			} else {
-				id = -1;
-			}
-		}
+		//Response: 2,CLOSED -> id = 2
+		if (len < 2 || line[0] < '0' ||
+		    line[0] >= '0' + MAX_CONNECTIONS || line[1] != ',')
+			return false;
+		id = line[0] - '0';
+		line += 2;
+		len -= 2;
 	}
-	if (id >= 0 && id < 4) {//Maximum of 4 connections
-		/* Close connection */
-		desc->current_conn = id;
-		desc->conn[id].active = false;
-		desc->conn[id].cbuff = NULL;
-		/* Notify that a connection was closed */
-		desc->connection_callback(desc->callback_ctx,
-					  AT_CLOSED_CONNECTION, id, NULL);
-	} else {//Not id
-		desc->async_idx[msg_idx] = 0;
+
+	if (!line_is(line, len, &closed))
 		return false;
-	}
+
+	/* Close connection */
+	desc->current_conn = id;
+	desc->conn[id].active = false;
+	desc->conn[id].cbuff = NULL;
+	/* Notify that a connection was closed */
+	desc->connection_callback(desc->callback_ctx, AT_CLOSED_CONNECTION,
+				  id, NULL);
 
 	return true;
 }
 
-/* Check if an asynchronous messages was sent by the module and update desc */
-static bool is_async_messages(struct at_desc *desc, uint8_t ch)
+/*
+ * Handle the line ending at the end of the result buffer, ch is the character
+ * that ended it. Asynchronous messages are dispatched on their first
+ * character, so each line is compared with at most two messages.
+ */
+static void parse_line(struct at_desc *desc, uint8_t ch)
 {
-	const static struct at_buff async_msgs[NB_ASYNC_MESSAGES] = {
-		{PUI8("CLOSED\r\n"), 8},
-		{PUI8("WIFI DISCONNECT\r\n"), 17},
-		{PUI8("WIFI GOT IP\r\n"), 13}
-	};
+	static const struct at_buff ready_msg = {PUI8("ready\r\n"), 7};
+	static const struct at_buff got_ip = {PUI8("WIFI GOT IP\r\n"), 13};
+	static const struct at_buff disconnect =
+	{PUI8("WIFI DISCONNECT\r\n"), 17};
+	uint8_t		*line = &desc->result.buff[desc->line_start];
+	uint32_t	len = desc->result.len - desc->line_start;
+	bool		async = false;
+
+	if (ch == ':') {
+		/* Not ended by a new line, the payload follows the ':' */
+		if (len <= AT_IPD_PREFIX_LEN ||
+		    memcmp(line, "+IPD,", AT_IPD_PREFIX_LEN) ||
+		    !parse_ipd(desc, line, len - 1))
+			return;
+
+		/* Drop the header together with the new line in front of it */
+		len = desc->line_start;
+		if (len >= 2 && !memcmp(&desc->result.buff[len - 2], "\r\n", 2))
+			len -= 2;
+		desc->result.len = len;
+		desc->line_start = len;
 
-	int32_t	i;
+		return;
+	}
 
-	for (i = 0; i < NB_ASYNC_MESSAGES; i++) {
-		if (match_message(&async_msgs[i], &desc->async_idx[i], ch))
-			break;
+	if (desc->callback_operation == RESETTING_MODULE) {
+		/* The boot messages are discarded, the baud rate may differ */
+		if (len >= ready_msg.len &&
+		    !memcmp(&line[len - ready_msg.len], ready_msg.buff,
+			    ready_msg.len))
+			desc->callback_operation = READING_RESPONSES;
+		desc->result.len = desc->line_start;
+
+		return;
 	}
 
-	switch (i) {
-	case 0: //Match CLOSED\r\n
-		if (check_conn_id(desc, (struct at_buff *)&async_msgs[i], i))
-			return false;
-		break;
-	case 1: //WIFI DISCONNECT\r\n
-		desc->is_wifi_connected = false;
-		break;
-	case 2:
-		desc->is_wifi_connected = true;
-		break;
-	default:
-		return false;
+	if (line[0] == 'W') {
+		if (line_is(line, len, &got_ip)) {
+			desc->is_wifi_connected = true;
+			async = true;
+		} else if (line_is(line, len, &disconnect)) {
+			desc->is_wifi_connected = false;
+			async = true;
+		}
+	} else if (line[0] == 'C' || isdigit(line[0])) {
+		async = parse_closed(desc, line, len);
 	}
 
-	/* Clear response indexes */
-	memset(desc->async_idx, 0, sizeof(desc->async_idx));
+	/* Asynchronous messages are not part of the command response */
+	if (async)
+		desc->result.len = desc->line_start;
+	desc->line_start = desc->result.len;
+}
 
-	return true;
+/* Append received characters to the result buffer */
+static void store_result(struct at_desc *desc, const uint8_t *data,
+			 uint32_t len)
+{
+	if (desc->result.len + len > RESULT_BUFF_LEN) {
+		if (desc->callback_operation != RESETTING_MODULE)
+			desc->errors |= AT_ERROR_INTERNAL_BUFFER_OVERFLOW;
+		desc->result.len = 0;
+		desc->line_start = 0;
+		len = no_os_min(len, RESULT_BUFF_LEN);
+	}
+
+	memcpy(&desc->result.buff[desc->result.len], data, len);
+	desc->result.len += len;
+}
+
+/*
+ * Parse a chunk of data received from the module. Text is copied to the
+ * result buffer up to the next character that may end a message and payload
+ * is copied to the connection buffer in one go.
+ */
+static void at_parse(struct at_desc *desc, const uint8_t *data, uint32_t len)
+{
+	uint32_t	i;
+	uint8_t		ch;
+
+	/* The result may have been consumed since the last chunk */
+	if (desc->line_start > desc->result.len)
+		desc->line_start = desc->result.len;
+
+	while (len) {
+		if (desc->callback_operation == READING_PAYLOAD) {
+			i = conn_write(desc, data, len);
+			data += i;
+			len -= i;
+			continue;
+		}
+
+		for (i = 0; i < len; i++) {
+			ch = data[i];
+			if (ch == '\n' || ch == ':' || ch == '>')
+				break;
+		}
+
+		if (i == len) {
+			store_result(desc, data, len);
+			return;
+		}
+
+		if (ch == '>' && desc->callback_operation == WAITING_SEND) {
+			/* The prompt is not part of the response */
+			store_result(desc, data, i);
+			desc->callback_operation = READING_RESPONSES;
+		} else {
+			store_result(desc, data, i + 1);
+			if (ch != '>')
+				parse_line(desc, ch);
+		}
+
+		data += i + 1;
+		len -= i + 1;
+	}
+}
+
+/* Parse everything the UART handler put in the receive ring */
+static void at_drain(struct at_desc *desc)
+{
+	uint8_t		*buff;
+	uint32_t	len;
+
+	if (!desc->rx_ring)
+		return;
+
+	while (!no_os_lf_ring_read_peek(desc->rx_ring, (void **)&buff, &len) &&
+	       len) {
+		at_parse(desc, buff, len);
+		no_os_lf_ring_read_commit(desc->rx_ring, len);
+	}
 }
 
 /* Mark the circular buffer transaction as ended */
@@ -363,11 +487,12 @@ static inline void end_conn_read(struct at_desc *desc)
 
 	conn = &desc->conn[desc->current_conn];
 
-	no_os_cb_end_async_write(conn->cbuff);
+	if (conn->cbuff)
+		no_os_cb_end_async_write(conn->cbuff);
 }
 
 /* Start new read operation */
-static inline void start_conn_read(struct at_desc *desc, bool is_new_message)
+static inline void start_conn_read(struct at_desc *desc)
 {
 	struct connection_desc	*conn;
 	uint8_t			*buff;
@@ -376,25 +501,6 @@ static inline void start_conn_read(struct at_desc *desc, bool is_new_message)
 
 	conn = &desc->conn[desc->current_conn];
 
-	if (is_new_message && !conn->active) {
-		/*
-		 * Notify that a new connection has started. Application needs
-		 * to set a cbuff for the connection where data will be written.
-		 */
-		desc->connection_callback(desc->callback_ctx,
-					  AT_NEW_CONNECTION,
-					  desc->current_conn,
-					  &conn->cbuff);
-		if (conn->cbuff)
-			conn->active = true;
-		/*
-		 * Else, a AT_STOP_CONNECTION command should be sent to the
-		 * esp8266 module. (Application rejects the connection)
-		 * This could be done only if implement at_run_cmd with
-		 * no_os_uart_write_nonblocking
-		 */
-	}
-
 	if (!conn->cbuff)
 		/* There is no buffer set for this connection */
 		goto dummy_read;
@@ -420,47 +526,21 @@ dummy_read:
 /* Handle the uart read done */
 static void at_callback_rd_done(struct at_desc *desc)
 {
-	static const struct at_buff ready_msg = {PUI8("ready\r\n"), 7};
-
-	switch (desc->callback_operation) {
-	case RESETTING_MODULE:
-		if (match_message(&ready_msg, &desc->ready_idx,
-				  desc->read_ch))
-			desc->callback_operation = READING_RESPONSES;
-		break;
-	case WAITING_SEND:
-	case READING_RESPONSES:
-		if (is_payload_message(desc, desc->read_ch)) {
-			/* New payload received */
-			desc->callback_operation = READING_PAYLOAD;
-			start_conn_read(desc, true);
-			return ;
-		}
-
-		if (desc->read_ch == '>' && desc->callback_operation ==
-		    WAITING_SEND) {
-			desc->callback_operation = READING_RESPONSES;
-		} else if (desc->result.len >= RESULT_BUFF_LEN) {
-			desc->errors |=
-				AT_ERROR_INTERNAL_BUFFER_OVERFLOW;
-			desc->result.len = 0;
-		} else if (!is_async_messages(desc, desc->read_ch))
-			/* Add received character to result buffer */
-			desc->result.buff[desc->result.len++] =
-				desc->read_ch;
-		break;
-	case READING_PAYLOAD:
+	if (desc->callback_operation == READING_PAYLOAD) {
 		/* Receiving payload from connection */
 		end_conn_read(desc);
-		if (!desc->conn[desc->current_conn].to_read) {
-			desc->callback_operation = READING_RESPONSES;
-			desc->current_conn = -1;
-			break;
-		} else {
-			start_conn_read(desc, false);
+		if (desc->conn[desc->current_conn].to_read) {
+			start_conn_read(desc);
+			return ;
+		}
+		conn_done(desc);
+	} else {
+		at_parse(desc, &desc->read_ch, 1);
+		if (desc->callback_operation == READING_PAYLOAD) {
+			/* The payload is read straight into the conn buffer */
+			start_conn_read(desc);
 			return ;
 		}
-		break;
 	}
 
 	/* Submit buffer to read the next char */
@@ -495,7 +575,9 @@ static int32_t wait_for_response(struct at_desc *desc)
 	timeout = MODULE_TIMEOUT;
 	result = -1;
 	do {
-		if (i < desc->result.len) {
+		at_drain(desc);
+		/* Check everything received before waiting again */
+		while (i < desc->result.len) {
 			for (j = 0; j < NB_RESPONSE_MESSAGES; j++)
 				if (match_message(&responses[j],
 						  &desc->resp_idx[j],
@@ -542,6 +624,7 @@ static int32_t send_cmd(struct at_desc *desc, enum at_cmd cmd,
 			return -1;
 		/* Wait until '>' is received */
 		while (timeout--) {
+			at_drain(desc);
 			if (WAITING_SEND != desc->callback_operation)
 				break;
 			no_os_mdelay(1);
@@ -555,6 +638,7 @@ static int32_t send_cmd(struct at_desc *desc, enum at_cmd cmd,
 		if (desc->is_wifi_connected) {
 			/* Wait for WIFI_DISCONNECT */
 			do {
+				at_drain(desc);
 				if (desc->is_wifi_connected == 0)
 					break;
 				no_os_mdelay(1);
@@ -799,6 +883,7 @@ static int32_t handle_special(struct at_desc *desc, enum at_cmd cmd)
 		timeout = MODULE_TIMEOUT;
 		do {
 			/* Wait for "ready" message */
+			at_drain(desc);
 			if (desc->callback_operation != RESETTING_MODULE)
 				break;
 			no_os_mdelay(1);
@@ -928,6 +1013,11 @@ int32_t at_init(struct at_desc **desc, const struct at_init_param *param)
 	ldesc->uart_desc = param->uart_desc;
 	ldesc->irq_desc = param->irq_desc;
 	ldesc->uart_irq_id = param->uart_irq_id;
+	ldesc->rx_ring = param->rx_ring;
+
+	/* The application fills the ring from its own UART handler */
+	if (ldesc->rx_ring)
+		goto irq_done;
 
 	callback_desc_rd.ctx = ldesc;
 	callback_desc_rd.event = NO_OS_EVT_UART_RX_COMPLETE;
@@ -951,6 +1041,8 @@ int32_t at_init(struct at_desc **desc, const struct at_init_param *param)
 	if (0 != no_os_irq_enable(ldesc->irq_desc, ldesc->uart_irq_id))
 		goto free_irq;
 
+irq_done:
+
 	/* Link buffer structure with static buffers */
 	ldesc->result.buff = ldesc->buffers.result_buff;
 	ldesc->result.len = 0;
@@ -960,7 +1052,9 @@ int32_t at_init(struct at_desc **desc, const struct at_init_param *param)
 	ldesc->callback_operation = READING_RESPONSES;
 
 	/* The read will be handled by the callback */
-	no_os_uart_read_nonblocking(ldesc->uart_desc, &ldesc->read_ch, 1);
+	if (!ldesc->rx_ring)
+		no_os_uart_read_nonblocking(ldesc->uart_desc, &ldesc->read_ch,
+					    1);
 
 	/** Software reset */
 	if (param->sw_reset_en)
@@ -996,7 +1090,9 @@ int32_t at_init(struct at_desc **desc, const struct at_init_param *param)
 	return 0;
 
 free_irq:
-	no_os_irq_unregister_callback(ldesc->irq_desc, ldesc->uart_irq_id, NULL);
+	if (!ldesc->rx_ring)
+		no_os_irq_unregister_callback(ldesc->irq_desc,
+					      ldesc->uart_irq_id, NULL);
 free_desc:
 	no_os_free(ldesc);
 	*desc = NULL;
@@ -1015,12 +1111,35 @@ int32_t at_remove(struct at_desc *desc)
 	if (!desc)
 		return -1;
 
-	no_os_irq_unregister_callback(desc->irq_desc, desc->uart_irq_id, NULL);
+	if (!desc->rx_ring)
+		no_os_irq_unregister_callback(desc->irq_desc, desc->uart_irq_id,
+					      NULL);
 	no_os_free(desc);
 
 	return 0;
 }
 
+/**
+ * @brief Parse the data received in at_init_param.rx_ring
+ *
+ * Commands parse the ring while waiting for their response, this must be
+ * called to receive connection data and asynchronous messages in between.
+ * Does nothing when the parser reads the UART itself.
+ * @param desc - AT parser reference
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Invalid parameter
+ */
+int32_t at_poll(struct at_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	at_drain(desc);
+
+	return 0;
+}
+
 /**
  * @brief Convert null terminated string to at_buff
  * @param dest - Destination buffer
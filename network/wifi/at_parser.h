@@ -92,6 +92,7 @@
 #include <stdbool.h>
 #include "at_params.h"
 #include "no_os_circular_buffer.h"
+#include "no_os_lf_ring.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -331,6 +332,14 @@ struct at_init_param {
 			struct no_os_circular_buffer **cb);
 	/* Software reset enable */
 	bool		sw_reset_en;
+	/*
+	 * Ring of bytes received from the module, filled by the application
+	 * from a DMA or UART idle line interrupt. The parser then processes
+	 * the data in chunks from at_poll() and while waiting for command
+	 * responses, instead of reading the UART one byte at a time from its
+	 * RX interrupt. NULL to read the UART from the parser.
+	 */
+	struct no_os_lf_ring	*rx_ring;
 };
 
 /**
@@ -347,6 +356,8 @@ struct at_desc;
 int32_t at_init(struct at_desc **desc,const struct at_init_param *param);
 /* Free resources used by parser */
 int32_t at_remove(struct at_desc *desc);
+/* Parse the data received in at_init_param.rx_ring */
+int32_t at_poll(struct at_desc *desc);
 
 /* Execute an AT command */
 int32_t at_run_cmd(struct at_desc *desc, enum at_cmd cmd, enum cmd_operation op,
@@ -325,6 +325,7 @@ int32_t wifi_init(struct wifi_desc **desc, struct wifi_init_param *param)
 	at_param.connection_callback = _wifi_connection_callback;
 	at_param.callback_ctx = ldesc;
 	at_param.sw_reset_en = param->sw_reset_en;
+	at_param.rx_ring = param->rx_ring;
 
 	result = at_init(&ldesc->at, &at_param);
 	if (NO_OS_IS_ERR_VALUE(result))
@@ -678,6 +679,7 @@ static int32_t wifi_socket_recv(struct wifi_desc *desc, uint32_t sock_id,
 
 	/* TODO read data even if disconnected ? */
 	sock = &desc->sockets[sock_id];
+	at_poll(desc->at);
 	if (sock->state != SOCKET_CONNECTED)
 		return -ENOTCONN;
 
@@ -823,6 +825,9 @@ static int32_t wifi_socket_accept(struct wifi_desc *desc, uint32_t sock_id,
 	if (desc->sockets[desc->server.id].state != SOCKET_LISTENING)
 		return -ENOTCONN;
 
+	/* New connections are noticed when their first data is parsed */
+	at_poll(desc->at);
+
 	for (i = 0; i < NB_SOCKETS; i++)
 		if (desc->sockets[i].state == SOCKET_WAITING_ACCEPT) {
 			desc->sockets[i].state = SOCKET_CONNECTED;
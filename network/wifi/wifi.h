@@ -49,6 +49,7 @@
 #include "network_interface.h"
 #include "no_os_uart.h"
 #include "no_os_irq.h"
+#include "no_os_lf_ring.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -75,6 +76,12 @@ struct wifi_init_param {
 	void			*uart_irq_conf;
 	/** ESP8266 Software reset enable */
 	bool			sw_reset_en;
+	/**
+	 * Ring filled with the bytes received from the module by a DMA or
+	 * UART idle line handler, NULL to read the UART byte by byte.
+	 * See \ref at_init_param.rx_ring
+	 */
+	struct no_os_lf_ring	*rx_ring;
 };
 
 /******************************************************************************/
@@ -10,12 +10,14 @@ INCS +=	$(DRIVERS)/adc/ad7616/iio_ad7616.h \
 		$(NO-OS)/iio/iiod.h \
 		$(NO-OS)/iio/iiod_private.h \
 		$(NO-OS)/iio/iio_types.h \
-		$(NO-OS)/iio/iio_app/iio_app.h
+		$(NO-OS)/iio/iio_app/iio_app.h \
+		$(INCLUDE)/no_os_zstd.h
 
 SRCS += $(DRIVERS)/adc/ad7616/iio_ad7616.c \
 		$(NO-OS)/iio/iio.c \
 		$(NO-OS)/iio/iiod.c \
-		$(NO-OS)/iio/iio_app/iio_app.c
+		$(NO-OS)/iio/iio_app/iio_app.c \
+		$(NO-OS)/util/no_os_zstd.c
 endif
 
 INCS += $(INCLUDE)/no_os_list.h \
@@ -261,28 +261,28 @@ void SendResultIeee754(float *data, uint32_t DataCount)
 void SendResult(uint32_t *pData, uint16_t len,
 		bool bImpedanceReadMode, bool bMagnitudeMode)
 {
-	float fMagVal = 0;
 	fImpCar_Type fCarZval;
-	iImpCar_Type iCarVval;
-	signExtend18To32(pData, len);
-	if (bImpedanceReadMode && (len == 4)) { // Send Impedance
-		fCarZval = computeImpedance(pData);
-		if (bMagnitudeMode) { // Complex to Magnitude
-			fMagVal = sqrt(fCarZval.Real*fCarZval.Real +
-				       fCarZval.Image*fCarZval.Image);
-			SendResultIeee754(&fMagVal, 1); // Impedance Magnitude only. Float
-		} else { // Complex Impedance in IEE754 uint32 hex string.
-			SendResultIeee754((float *)&fCarZval, 2);
-		}
-	} else if((!bImpedanceReadMode) && (len == 2)) { // Send Voltage
-		if (bMagnitudeMode) { // Complex to Magnitude
-			iCarVval = *((iImpCar_Type *)pData);
-			fMagVal = sqrt((iCarVval.Real*1.0)*(iCarVval.Real*1.0) +
-				       (iCarVval.Image*1.0)*(iCarVval.Image*1.0));
-			SendResultIeee754(&fMagVal, 1); // Voltage Magnitude only. Float
-		} else { // Complex Voltage in uint32 hex string.
-			SendResultUint32(pData, 2);
-		}
+	float fMagVal;
+	uint32_t nResults = 1;
+
+	if (bImpedanceReadMode ? (len != 4) : (len != 2))
+		return;
+
+	if (!bImpedanceReadMode && !bMagnitudeMode) {
+		// Complex Voltage in uint32 hex string.
+		signExtend18To32(pData, len);
+		SendResultUint32(pData, 2);
+		return;
+	}
+
+	AppBiaProcessBatch(pData, len, &fCarZval, &nResults);
+	if (bMagnitudeMode) { // Complex to Magnitude
+		fMagVal = sqrtf(fCarZval.Real * fCarZval.Real +
+				fCarZval.Image * fCarZval.Image);
+		// Impedance or Voltage Magnitude only. Float
+		SendResultIeee754(&fMagVal, 1);
+	} else { // Complex Impedance in IEE754 uint32 hex string.
+		SendResultIeee754((float *)&fCarZval, 2);
 	}
 }
 
@@ -45,6 +45,57 @@
 #include "iio_dac_demo.h"
 #include "common_data.h"
 #include "no_os_util.h"
+#include "no_os_alloc.h"
+#include "no_os_zstd.h"
+#include "no_os_print_log.h"
+#include "iiod.h"
+
+#ifdef NO_OS_ALLOC_POOLS
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Init time descriptors, the context XML and the connection table */
+#define IIO_EXAMPLE_ARENA_SIZE	16384
+/* One receive buffer for each IIOD connection */
+#define IIO_EXAMPLE_CONN_BUFF	4096
+/*
+ * The context XML compressed on the first ZPRINT: the output buffer, kept in
+ * the 1024 pool once shrunk, and the encoder work area
+ */
+#define IIO_EXAMPLE_ZXML_BUFF	1024
+#define IIO_EXAMPLE_ZSTD_WORK	NO_OS_ZSTD_WORK_SIZE
+
+/* Sockets, list elements and IIOD connections created while running */
+static const struct no_os_alloc_pool_param iio_example_pools[] = {
+	{.block_size = 32, .nb_blocks = 2 * IIOD_MAX_CONNECTIONS},
+	{.block_size = 128, .nb_blocks = 8},
+	{.block_size = 1024, .nb_blocks = IIOD_MAX_CONNECTIONS + 1},
+	{
+		.block_size = IIO_EXAMPLE_CONN_BUFF,
+		.nb_blocks = IIOD_MAX_CONNECTIONS + 1
+	},
+	{.block_size = IIO_EXAMPLE_ZSTD_WORK, .nb_blocks = 1},
+};
+
+static uint64_t iio_example_mem[(32 * 2 * IIOD_MAX_CONNECTIONS + 128 * 8 +
+				 1024 * IIOD_MAX_CONNECTIONS +
+				 IIO_EXAMPLE_ZXML_BUFF +
+				 IIO_EXAMPLE_CONN_BUFF *
+				 (IIOD_MAX_CONNECTIONS + 1) +
+				 IIO_EXAMPLE_ZSTD_WORK +
+				 IIO_EXAMPLE_ARENA_SIZE) / sizeof(uint64_t)];
+
+/***************************************************************************//**
+ * @brief Report an allocation failure after the initialization, the pools
+ * are too small for the load.
+ *
+ * @param size - Size of the request that failed.
+*******************************************************************************/
+static void iio_example_seal_failure(size_t size)
+{
+	pr_err("Out of pool memory, %u bytes requested\n", (unsigned int)size);
+}
+#endif
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -81,6 +132,20 @@ int iio_example_main()
 		.size = MAX_SIZE_BASE_ADDR
 	};
 
+#ifdef NO_OS_ALLOC_POOLS
+	struct no_os_alloc_init_param alloc_init_param = {
+		.mem = iio_example_mem,
+		.mem_size = sizeof(iio_example_mem),
+		.pools = iio_example_pools,
+		.nb_pools = NO_OS_ARRAY_SIZE(iio_example_pools),
+		.seal_failure = iio_example_seal_failure,
+	};
+
+	status = no_os_alloc_init(&alloc_init_param);
+	if (status)
+		return status;
+#endif
+
 	status = adc_demo_init(&adc_desc, &adc_init_par);
 	if (status)
 		return status;
@@ -104,5 +169,10 @@ int iio_example_main()
 	if (status)
 		return status;
 
+#ifdef NO_OS_ALLOC_POOLS
+	/* Only the pools serve the allocations of the connections */
+	no_os_alloc_seal();
+#endif
+
 	return iio_app_run(app);
 }
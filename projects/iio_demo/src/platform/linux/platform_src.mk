@@ -21,3 +21,6 @@ SRCS += $(DRIVERS)/platform/linux/linux_uart.c \
 
 INCS += $(INCLUDE)/no_os_gpio.h \
 	$(INCLUDE)/no_os_trng.h		
+
+# Serve the allocations of the IIOD connections from the no_os_alloc pools
+NO_OS_ALLOC_POOLS = y
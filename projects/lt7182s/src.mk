@@ -42,5 +42,8 @@ SRCS += $(NO-OS)/util/no_os_lf256fifo.c 	\
 		$(NO-OS)/util/no_os_mutex.c	\
 		$(NO-OS)/util/no_os_crc8.c
 
+INCS += $(DRIVERS)/power/pmbus/pmbus.h
+SRCS += $(DRIVERS)/power/pmbus/pmbus.c
+
 INCS += $(DRIVERS)/power/lt7182s/lt7182s.h
 SRCS += $(DRIVERS)/power/lt7182s/lt7182s.c
@@ -45,8 +45,9 @@
 int basic_example_main()
 {
 	struct lt7182s_dev *dev;
+	struct lt7182s_telemetry telemetry;
 	struct lt7182s_status status;
-	int ret, chan, vals[4];
+	int ret, chan;
 
 	pr_info("Running basic example.\n");
 
@@ -55,27 +56,11 @@ int basic_example_main()
 		goto exit;
 
 	while(1) {
-		for (chan = LT7182S_CHAN_0; chan <= LT7182S_CHAN_1; chan++) {
-			ret = lt7182s_read_value(dev, chan,
-						 LT7182S_VIN, &vals[0]);
-			if (ret)
-				goto exit;
-
-			ret = lt7182s_read_value(dev, chan,
-						 LT7182S_VOUT, &vals[1]);
-			if (ret)
-				goto exit;
-
-			ret = lt7182s_read_value(dev, chan,
-						 LT7182S_IOUT, &vals[2]);
-			if (ret)
-				goto exit;
-
-			ret = lt7182s_read_value(dev, chan,
-						 LT7182S_TEMP, &vals[3]);
-			if (ret)
-				goto exit;
+		ret = lt7182s_read_telemetry(dev, &telemetry);
+		if (ret)
+			goto exit;
 
+		for (chan = LT7182S_CHAN_0; chan <= LT7182S_CHAN_1; chan++) {
 			ret = lt7182s_read_status(dev, chan,
 						  LT7182S_STATUS_ALL_TYPE,
 						  &status);
@@ -93,8 +78,9 @@ int basic_example_main()
 				pr_info("Status mfr_specific asserted.\n");
 
 			pr_info("Channel: %d: vin = %d mV | vout = %d mV | iout = %d mA | temp = %d C\n",
-				chan, vals[0], vals[1], vals[2],
-				vals[3] / 1000);
+				chan, telemetry.vin[chan], telemetry.vout[chan],
+				telemetry.iout[chan],
+				telemetry.temp[chan] / 1000);
 		}
 
 		pr_info("\n");
@@ -42,6 +42,11 @@
 #include "no_os_print_log.h"
 #include "iio_app.h"
 
+#define DATA_BUFFER_SIZE 400
+
+/* One byte for each input channel and scan */
+uint8_t iio_data_buffer[DATA_BUFFER_SIZE * MAX14906_CHANNELS];
+
 int iio_example_main()
 {
 	int ret;
@@ -72,6 +77,11 @@ int iio_example_main()
 		},
 	};
 
+	struct iio_data_buffer buff = {
+		.buff = (void *)iio_data_buffer,
+		.size = sizeof(iio_data_buffer),
+	};
+
 	/** IIO app. */
 	struct iio_app_desc *app;
 	struct iio_app_init_param app_init_param = { 0 };
@@ -86,6 +96,7 @@ int iio_example_main()
 			.name = "max14906",
 			.dev = max14906_iio_desc,
 			.dev_descriptor = max14906_iio_desc->iio_dev,
+			.read_buff = &buff,
 		}
 	};
 
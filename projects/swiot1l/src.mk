@@ -35,12 +35,14 @@ INCS += $(INCLUDE)/no_os_delay.h     \
 		$(INCLUDE)/no_os_mdio.h      \
 		$(INCLUDE)/no_os_timer.h      \
 		$(INCLUDE)/no_os_lf256fifo.h \
+		$(INCLUDE)/no_os_lf_ring.h \
 		$(INCLUDE)/no_os_util.h \
 		$(INCLUDE)/no_os_units.h \
 		$(INCLUDE)/no_os_alloc.h
 
 SRCS += $(DRIVERS)/api/no_os_gpio.c \
 		$(NO-OS)/util/no_os_lf256fifo.c \
+		$(NO-OS)/util/no_os_lf_ring.c \
 		$(DRIVERS)/api/no_os_irq.c  \
 		$(DRIVERS)/api/no_os_spi.c  \
 		$(DRIVERS)/api/no_os_uart.c \
@@ -0,0 +1,334 @@
+/***************************************************************************//**
+ *   @file   test_ad74413r.c
+ *   @brief  Tests of the AD74413R continuous conversion engine.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "ad74413r.h"
+#include "no_os_alloc.h"
+#include "no_os_crc8.h"
+#include "no_os_lf_ring.h"
+#include "no_os_util.h"
+#include "mock_no_os_spi.h"
+#include "mock_no_os_gpio.h"
+#include "mock_no_os_irq.h"
+#include "mock_no_os_delay.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define TEST_FRAME_SIZE		4
+#define TEST_NB_REGS		0x50
+
+NO_OS_DECLARE_CRC8_TABLE(test_crc_table);
+
+static struct no_os_spi_desc spi;
+static struct no_os_irq_ctrl_desc irq_ctrl;
+static struct ad74413r_desc *dev;
+static struct no_os_callback_desc *adc_rdy;
+
+/* Device model: register map and register selected for readback */
+static uint16_t regs[TEST_NB_REGS];
+static uint8_t read_sel;
+/* MOSI frames of the last burst */
+static uint8_t burst[AD74413R_BURST_MAX + 1][TEST_FRAME_SIZE];
+static uint32_t burst_len;
+static uint32_t bursts;
+/* Frame of the next burst returned with a bad CRC, 0 for none */
+static uint32_t corrupt_frame;
+
+/*
+ * One frame: MISO is the register selected by the previous READ_SELECT,
+ * MOSI is a register write.
+ */
+static void spi_frame(uint8_t *mosi, uint8_t *miso)
+{
+	uint8_t out[TEST_FRAME_SIZE];
+	uint16_t val;
+
+	out[0] = read_sel;
+	no_os_put_unaligned_be16(regs[read_sel], &out[1]);
+	out[3] = no_os_crc8(test_crc_table, out, 3, 0);
+
+	TEST_ASSERT_EQUAL_HEX8(no_os_crc8(test_crc_table, mosi, 3, 0), mosi[3]);
+	TEST_ASSERT_LESS_THAN_UINT32(TEST_NB_REGS, mosi[0]);
+	val = no_os_get_unaligned_be16(&mosi[1]);
+	if (mosi[0] == AD74413R_READ_SELECT)
+		read_sel = val;
+	else if (mosi[0] != AD74413R_NOP)
+		regs[mosi[0]] = val;
+
+	memcpy(miso, out, sizeof(out));
+}
+
+static int32_t spi_write_and_read(struct no_os_spi_desc *desc, uint8_t *data,
+				  uint16_t bytes_number, int cmock_num_calls)
+{
+	TEST_ASSERT_EQUAL_UINT16(TEST_FRAME_SIZE, bytes_number);
+	spi_frame(data, data);
+
+	return 0;
+}
+
+/* The ADC_RDY handler reads the whole sequence in one transfer */
+static int32_t spi_transfer(struct no_os_spi_desc *desc,
+			    struct no_os_spi_msg *msgs, uint32_t len,
+			    int cmock_num_calls)
+{
+	uint32_t i;
+
+	TEST_ASSERT_LESS_OR_EQUAL_UINT32(AD74413R_BURST_MAX + 1, len);
+	for (i = 0; i < len; i++) {
+		TEST_ASSERT_EQUAL_UINT32(TEST_FRAME_SIZE, msgs[i].bytes_number);
+		TEST_ASSERT_EQUAL_UINT8(1, msgs[i].cs_change);
+		memcpy(burst[i], msgs[i].tx_buff, TEST_FRAME_SIZE);
+		spi_frame(msgs[i].tx_buff, msgs[i].rx_buff);
+		if (corrupt_frame && i == corrupt_frame)
+			msgs[i].rx_buff[3] ^= 0xFF;
+	}
+	corrupt_frame = 0;
+	burst_len = len;
+	bursts++;
+
+	return 0;
+}
+
+static int32_t spi_init(struct no_os_spi_desc **desc,
+			const struct no_os_spi_init_param *param,
+			int cmock_num_calls)
+{
+	*desc = &spi;
+
+	return 0;
+}
+
+static int32_t irq_register_callback(struct no_os_irq_ctrl_desc *desc,
+				     uint32_t irq_id,
+				     struct no_os_callback_desc *cb,
+				     int cmock_num_calls)
+{
+	adc_rdy = cb;
+
+	return 0;
+}
+
+/* Set the results of the next conversion sequence */
+static void set_results(uint16_t base)
+{
+	uint32_t i;
+
+	for (i = 0; i < AD74413R_N_CHANNELS; i++)
+		regs[AD74413R_ADC_RESULT(i)] = base + i;
+	for (i = 0; i < AD74413R_N_DIAG_CHANNELS; i++)
+		regs[AD74413R_DIAG_RESULT(i)] = base + 0x10 + i;
+}
+
+static void start(uint8_t ch_mask, uint8_t diag_mask, uint32_t ring_size)
+{
+	struct ad74413r_cont_param param = {
+		.irq_ctrl = &irq_ctrl,
+		.adc_rdy_irq = 3,
+		.ch_mask = ch_mask,
+		.diag_mask = diag_mask,
+		.ring_size = ring_size,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_start(dev, &param));
+	TEST_ASSERT_NOT_NULL(adc_rdy);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct ad74413r_init_param init_param = {
+		.chip_id = AD74413R,
+	};
+
+	memset(regs, 0, sizeof(regs));
+	no_os_crc8_populate_msb(test_crc_table, 0x7);
+	read_sel = AD74413R_NOP;
+	adc_rdy = NULL;
+	burst_len = 0;
+	bursts = 0;
+	corrupt_frame = 0;
+
+	no_os_spi_init_StubWithCallback(spi_init);
+	no_os_spi_remove_IgnoreAndReturn(0);
+	no_os_gpio_get_optional_IgnoreAndReturn(0);
+	no_os_spi_write_and_read_StubWithCallback(spi_write_and_read);
+	no_os_spi_transfer_StubWithCallback(spi_transfer);
+	no_os_irq_register_callback_StubWithCallback(irq_register_callback);
+	no_os_irq_unregister_callback_IgnoreAndReturn(0);
+	no_os_irq_trigger_level_set_IgnoreAndReturn(0);
+	no_os_irq_enable_IgnoreAndReturn(0);
+	no_os_irq_disable_IgnoreAndReturn(0);
+	no_os_udelay_Ignore();
+	no_os_mdelay_Ignore();
+
+	/* Reset, then the scratch register test through the model */
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_init(&dev, &init_param));
+}
+
+void tearDown(void)
+{
+	/* Stops the conversions and frees the rings */
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_remove(dev));
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_ad74413r_cont_burst(void)
+{
+	struct ad74413r_cont_stats stats;
+	uint16_t vals[4];
+
+	start(NO_OS_BIT(0) | NO_OS_BIT(2), NO_OS_BIT(1), 8);
+
+	/* Channels A and C and diagnostic 1 enabled, continuous sequence */
+	TEST_ASSERT_EQUAL_HEX16(AD74413R_CH_EN_MASK(0) |
+				AD74413R_CH_EN_MASK(2) |
+				AD74413R_DIAG_EN_MASK(1),
+				regs[AD74413R_ADC_CONV_CTRL] & 0xFF);
+	TEST_ASSERT_EQUAL_HEX16(AD74413R_START_CONT,
+				no_os_field_get(AD74413R_CONV_SEQ_MASK,
+						regs[AD74413R_ADC_CONV_CTRL]));
+
+	set_results(0x100);
+	adc_rdy->callback(adc_rdy->ctx);
+
+	/* Each frame selects the next result, the NOP clocks out the last */
+	TEST_ASSERT_EQUAL_UINT32(1, bursts);
+	TEST_ASSERT_EQUAL_UINT32(4, burst_len);
+	TEST_ASSERT_EQUAL_HEX8(AD74413R_READ_SELECT, burst[0][0]);
+	TEST_ASSERT_EQUAL_HEX16(AD74413R_ADC_RESULT(0),
+				no_os_get_unaligned_be16(&burst[0][1]));
+	TEST_ASSERT_EQUAL_HEX16(AD74413R_ADC_RESULT(2),
+				no_os_get_unaligned_be16(&burst[1][1]));
+	TEST_ASSERT_EQUAL_HEX16(AD74413R_DIAG_RESULT(1),
+				no_os_get_unaligned_be16(&burst[2][1]));
+	TEST_ASSERT_EQUAL_HEX8(AD74413R_NOP, burst[3][0]);
+
+	TEST_ASSERT_EQUAL_INT(1, ad74413r_cont_read(dev, 0, vals, 4));
+	TEST_ASSERT_EQUAL_HEX16(0x100, vals[0]);
+	TEST_ASSERT_EQUAL_INT(1, ad74413r_cont_read(dev, 2, vals, 4));
+	TEST_ASSERT_EQUAL_HEX16(0x102, vals[0]);
+	TEST_ASSERT_EQUAL_INT(1, ad74413r_cont_read(dev,
+			      AD74413R_N_CHANNELS + 1, vals, 4));
+	TEST_ASSERT_EQUAL_HEX16(0x111, vals[0]);
+	TEST_ASSERT_EQUAL_INT(-EBUSY, ad74413r_cont_read(dev, 1, vals, 4));
+
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_latest(dev, 2, vals));
+	TEST_ASSERT_EQUAL_HEX16(0x102, vals[0]);
+
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_stats_get(dev, &stats, false));
+	TEST_ASSERT_EQUAL_UINT32(1, stats.sequences);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.crc_errors);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.overflows);
+}
+
+void test_ad74413r_cont_crc(void)
+{
+	struct ad74413r_cont_stats stats;
+	uint16_t vals[4];
+
+	start(NO_OS_BIT(0) | NO_OS_BIT(1), 0, 8);
+
+	/* Frame 1 carries the result of channel A */
+	set_results(0x200);
+	corrupt_frame = 1;
+	adc_rdy->callback(adc_rdy->ctx);
+
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_read(dev, 0, vals, 4));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, ad74413r_cont_latest(dev, 0, vals));
+	TEST_ASSERT_EQUAL_INT(1, ad74413r_cont_read(dev, 1, vals, 4));
+	TEST_ASSERT_EQUAL_HEX16(0x201, vals[0]);
+
+	/* The next sequence is good again */
+	set_results(0x300);
+	adc_rdy->callback(adc_rdy->ctx);
+	TEST_ASSERT_EQUAL_INT(1, ad74413r_cont_read(dev, 0, vals, 4));
+	TEST_ASSERT_EQUAL_HEX16(0x300, vals[0]);
+
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_stats_get(dev, &stats, true));
+	TEST_ASSERT_EQUAL_UINT32(2, stats.sequences);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.crc_errors);
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_stats_get(dev, &stats, false));
+	TEST_ASSERT_EQUAL_UINT32(0, stats.crc_errors);
+}
+
+void test_ad74413r_cont_overflow(void)
+{
+	struct ad74413r_cont_stats stats;
+	uint16_t vals[8];
+	uint32_t i;
+
+	start(NO_OS_BIT(3), NO_OS_BIT(0), 4);
+
+	for (i = 0; i < 6; i++) {
+		set_results(0x400 + 0x100 * i);
+		adc_rdy->callback(adc_rdy->ctx);
+	}
+
+	/* The oldest results are kept, the latest one is still updated */
+	TEST_ASSERT_EQUAL_INT(4, ad74413r_cont_read(dev, 3, vals, 8));
+	TEST_ASSERT_EQUAL_HEX16(0x403, vals[0]);
+	TEST_ASSERT_EQUAL_HEX16(0x703, vals[3]);
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_latest(dev, 3, vals));
+	TEST_ASSERT_EQUAL_HEX16(0x903, vals[0]);
+
+	TEST_ASSERT_EQUAL_INT(0, ad74413r_cont_stats_get(dev, &stats, false));
+	TEST_ASSERT_EQUAL_UINT32(6, stats.sequences);
+	TEST_ASSERT_EQUAL_UINT32(2 * 2, stats.overflows);
+
+	/* Room again after the read */
+	adc_rdy->callback(adc_rdy->ctx);
+	TEST_ASSERT_EQUAL_INT(1, ad74413r_cont_read(dev, 3, vals, 8));
+	TEST_ASSERT_EQUAL_INT(4, ad74413r_cont_read(dev,
+			      AD74413R_N_CHANNELS, vals, 8));
+	TEST_ASSERT_EQUAL_HEX16(0x410, vals[0]);
+}
@@ -0,0 +1,290 @@
+/***************************************************************************//**
+ *   @file   test_bia_measurement.c
+ *   @brief  Tests and host benchmark of the AD5940 BIA batch processing.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "bia_measurement.h"
+#include "mock_ad5940.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define BIA_TEST_RESULTS	256
+#define BIA_BENCH_RESULTS	4096
+#define BIA_BENCH_LOOPS		50
+
+static AppBiaCfg_Type *pCfg;
+static uint32_t fifo[BIA_BENCH_RESULTS * 4];
+static fImpCar_Type results[BIA_BENCH_RESULTS];
+static fImpPol_Type polar[BIA_BENCH_RESULTS];
+
+/* Implemented by the application, used by AppBiaInit */
+int ClrMCUIntFlag(void)
+{
+	return 0;
+}
+
+/* Random 18 bit DFT result with the upper bits set like the FIFO ECC */
+static uint32_t fifo_word(int32_t min_abs)
+{
+	int32_t val = min_abs + rand() % (0x1ffff - min_abs);
+
+	if (rand() & 1)
+		val = -val;
+
+	return ((uint32_t)val & 0x3ffff) | 0x1c0000;
+}
+
+static void fill_fifo(uint32_t nb_results, uint32_t rec_len)
+{
+	uint32_t i;
+
+	for (i = 0; i < nb_results * rec_len; i++)
+		/* Keep the current far from 0, for a stable reference */
+		fifo[i] = fifo_word((i % 4) >= 2 ? 1000 : 0);
+}
+
+/* Per result float path, as used by the applications */
+static fImpCar_Type float_impedance(const uint32_t *pData)
+{
+	uint32_t res[4];
+
+	memcpy(res, pData, sizeof(res));
+	signExtend18To32(res, 4);
+
+	return computeImpedance(res);
+}
+
+static void check_result(const fImpCar_Type *pRes, fImpCar_Type ref)
+{
+	float tol = 1e-5f * sqrtf(ref.Real * ref.Real + ref.Image * ref.Image);
+
+	TEST_ASSERT_FLOAT_WITHIN(tol, ref.Real, pRes->Real);
+	TEST_ASSERT_FLOAT_WITHIN(tol, ref.Image, pRes->Image);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	AppBiaGetCfg(&pCfg);
+	pCfg->bImpedanceReadMode = true;
+	pCfg->SweepCfg.SweepEn = false;
+	pCfg->RtiaCurrValue[0] = 10020.5f;
+	pCfg->RtiaCurrValue[1] = -152.25f;
+	pCfg->BatchSweepIndex = 0;
+	srand(1);
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_bia_batch_invalid(void)
+{
+	uint32_t cnt = 1;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL,
+			      AppBiaProcessBatch(NULL, 4, results, &cnt));
+	TEST_ASSERT_EQUAL_INT(-EINVAL,
+			      AppBiaProcessBatch(fifo, 4, NULL, &cnt));
+	TEST_ASSERT_EQUAL_INT(-EINVAL,
+			      AppBiaProcessBatch(fifo, 4, results, NULL));
+}
+
+void test_bia_batch_count(void)
+{
+	uint32_t cnt = BIA_TEST_RESULTS;
+
+	fill_fifo(3, 4);
+	/* Incomplete results are not processed */
+	TEST_ASSERT_EQUAL_INT(0, AppBiaProcessBatch(fifo, 11, results, &cnt));
+	TEST_ASSERT_EQUAL_UINT32(2, cnt);
+	/* Results are limited by the size of the output */
+	cnt = 1;
+	TEST_ASSERT_EQUAL_INT(0, AppBiaProcessBatch(fifo, 12, results, &cnt));
+	TEST_ASSERT_EQUAL_UINT32(1, cnt);
+}
+
+void test_bia_batch_impedance(void)
+{
+	uint32_t cnt = BIA_TEST_RESULTS;
+	uint32_t i;
+
+	fill_fifo(BIA_TEST_RESULTS, 4);
+	TEST_ASSERT_EQUAL_INT(0, AppBiaProcessBatch(fifo, BIA_TEST_RESULTS * 4,
+			      results, &cnt));
+	TEST_ASSERT_EQUAL_UINT32(BIA_TEST_RESULTS, cnt);
+
+	/* The FIFO is not modified */
+	for (i = 0; i < cnt; i++)
+		check_result(&results[i], float_impedance(&fifo[i * 4]));
+}
+
+void test_bia_batch_voltage(void)
+{
+	uint32_t cnt = BIA_TEST_RESULTS;
+	uint32_t i;
+
+	pCfg->bImpedanceReadMode = false;
+	fill_fifo(BIA_TEST_RESULTS, 2);
+	TEST_ASSERT_EQUAL_INT(0, AppBiaProcessBatch(fifo, BIA_TEST_RESULTS * 2,
+			      results, &cnt));
+	TEST_ASSERT_EQUAL_UINT32(BIA_TEST_RESULTS, cnt);
+
+	signExtend18To32(fifo, BIA_TEST_RESULTS * 2);
+	for (i = 0; i < cnt; i++) {
+		TEST_ASSERT_EQUAL_FLOAT((int32_t)fifo[i * 2], results[i].Real);
+		TEST_ASSERT_EQUAL_FLOAT((int32_t)fifo[i * 2 + 1],
+					results[i].Image);
+	}
+}
+
+void test_bia_batch_sweep(void)
+{
+	uint32_t cnt = 8;
+	uint32_t i;
+
+	pCfg->SweepCfg.SweepEn = true;
+	pCfg->SweepCfg.SweepPoints = 3;
+	for (i = 0; i < 3; i++) {
+		pCfg->RtiaCalTable[i][0] = 10000.0f - i * 50;
+		pCfg->RtiaCalTable[i][1] = -100.0f * (i + 1);
+	}
+
+	fill_fifo(8, 4);
+	TEST_ASSERT_EQUAL_INT(0,
+			      AppBiaProcessBatch(fifo, 8 * 4, results, &cnt));
+	TEST_ASSERT_EQUAL_UINT32(8 % 3, pCfg->BatchSweepIndex);
+
+	/* Each result is calibrated with the Rtia of its sweep point */
+	for (i = 0; i < cnt; i++) {
+		pCfg->RtiaCurrValue[0] = pCfg->RtiaCalTable[i % 3][0];
+		pCfg->RtiaCurrValue[1] = pCfg->RtiaCalTable[i % 3][1];
+		check_result(&results[i], float_impedance(&fifo[i * 4]));
+	}
+}
+
+void test_bia_batch_polar(void)
+{
+	static const float ref[][2] = {
+		{1.0f, 0.0f}, {0.0f, 1.0f}, {-1.0f, 0.0f}, {0.0f, -1.0f},
+		{0.0f, 0.0f}, {-3.0f, -4.0f}, {1e-3f, 2e4f}, {-7e4f, 5.0f},
+	};
+	uint32_t nb = sizeof(ref) / sizeof(ref[0]);
+	uint32_t cnt = BIA_TEST_RESULTS;
+	uint32_t i;
+
+	for (i = 0; i < nb; i++) {
+		results[i].Real = ref[i][0];
+		results[i].Image = ref[i][1];
+	}
+	AppBiaBatchToPolar(results, polar, nb);
+	for (i = 0; i < nb; i++) {
+		TEST_ASSERT_EQUAL_FLOAT(hypotf(ref[i][0], ref[i][1]),
+					polar[i].Magnitude);
+		TEST_ASSERT_FLOAT_WITHIN(2e-5f, atan2f(ref[i][1], ref[i][0]),
+					 polar[i].Phase);
+	}
+
+	fill_fifo(BIA_TEST_RESULTS, 4);
+	AppBiaProcessBatch(fifo, BIA_TEST_RESULTS * 4, results, &cnt);
+	AppBiaBatchToPolar(results, polar, cnt);
+	for (i = 0; i < cnt; i++) {
+		TEST_ASSERT_EQUAL_FLOAT(hypotf(results[i].Real,
+					       results[i].Image),
+					polar[i].Magnitude);
+		TEST_ASSERT_FLOAT_WITHIN(2e-5f, atan2f(results[i].Image,
+						       results[i].Real),
+					 polar[i].Phase);
+	}
+}
+
+void test_bia_batch_benchmark(void)
+{
+	char msg[128];
+	fImpCar_Type z;
+	float sum = 0;
+	clock_t start, t_float, t_batch;
+	uint32_t cnt, i, l;
+	int total;
+
+	fill_fifo(BIA_BENCH_RESULTS, 4);
+
+	/* What the applications did for each result, magnitude only */
+	start = clock();
+	for (l = 0; l < BIA_BENCH_LOOPS; l++) {
+		for (i = 0; i < BIA_BENCH_RESULTS; i++) {
+			z = float_impedance(&fifo[i * 4]);
+			sum += sqrtf(z.Real * z.Real + z.Image * z.Image);
+		}
+	}
+	t_float = clock() - start;
+
+	/* What they do now */
+	start = clock();
+	for (l = 0; l < BIA_BENCH_LOOPS; l++) {
+		cnt = BIA_BENCH_RESULTS;
+		AppBiaProcessBatch(fifo, BIA_BENCH_RESULTS * 4, results, &cnt);
+		for (i = 0; i < cnt; i++)
+			sum += sqrtf(results[i].Real * results[i].Real +
+				     results[i].Image * results[i].Image);
+	}
+	t_batch = clock() - start;
+
+	total = BIA_BENCH_RESULTS * BIA_BENCH_LOOPS;
+	snprintf(msg, sizeof(msg),
+		 "%d results: float %.1f ns/result, batch %.1f ns/result (%g)",
+		 total, t_float * 1e9 / CLOCKS_PER_SEC / total,
+		 t_batch * 1e9 / CLOCKS_PER_SEC / total, sum);
+	TEST_MESSAGE(msg);
+	TEST_ASSERT_EQUAL_UINT32(BIA_BENCH_RESULTS, cnt);
+}
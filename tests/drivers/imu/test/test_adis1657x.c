@@ -60,6 +60,41 @@
 const struct adis_chip_info *adis_chip_info = &adis1657x_chip_info;;
 enum adis_device_id adis_dev_id = ADIS16577_2;
 
+/*******************************************************************************
+ *    PRIVATE FUNCTIONS
+ ******************************************************************************/
+
+/* Frame 0: empty FIFO, frame 1: valid data, frame 2: corrupted checksum */
+static int32_t fifo_spi_transfer_cb(struct no_os_spi_desc *desc,
+				    struct no_os_spi_msg *msgs, uint32_t len,
+				    int cmock_num_calls)
+{
+	uint16_t checksum;
+	uint32_t i, j;
+	uint8_t *frame;
+
+	for (i = 0; i < len; i++) {
+		frame = msgs[i].rx_buff;
+		checksum = 0;
+		for (j = 2; j < msgs[i].bytes_number - 2; j++) {
+			frame[j] = i ? j : 0;
+			if (j >= 4)
+				checksum += frame[j];
+		}
+		if (i == 2)
+			checksum++;
+		frame[j] = i ? checksum >> 8 : 0;
+		frame[j + 1] = i ? checksum : 0;
+	}
+
+	return 0;
+}
+
+static uint16_t get_unaligned_be16_cb(uint8_t *buf, int cmock_num_calls)
+{
+	return (buf[0] << 8) | buf[1];
+}
+
 /*******************************************************************************
  *    SETUP, TEARDOWN
  ******************************************************************************/
@@ -557,6 +592,37 @@ void test_adis1657x_write_burst_sel(void)
 	test_adis_write_burst_sel_2();
 }
 
+void test_adis1657x_read_fifo_bursts(void)
+{
+	uint8_t buf[3 * 36];
+	uint32_t valid;
+
+	device_alloc.info = adis_chip_info;
+	device_alloc.burst32 = false;
+	device_alloc.burst_sel = 0;
+
+	retval = adis_read_fifo_bursts(&device_alloc, buf, 0, false, 0, &valid);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, retval);
+	retval = adis_read_fifo_bursts(&device_alloc, buf,
+				       ADIS_FIFO_BURSTS_MAX + 1, false, 0,
+				       &valid);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, retval);
+
+	no_os_spi_transfer_IgnoreAndReturn(-1);
+	retval = adis_read_fifo_bursts(&device_alloc, buf, 3, false, 0, &valid);
+	TEST_ASSERT_EQUAL_INT(-1, retval);
+
+	no_os_spi_transfer_StubWithCallback(fifo_spi_transfer_cb);
+	no_os_get_unaligned_be16_StubWithCallback(get_unaligned_be16_cb);
+	no_os_field_get_IgnoreAndReturn(0);
+	retval = adis_read_fifo_bursts(&device_alloc, buf, 3, false, 0, &valid);
+	TEST_ASSERT_EQUAL_INT(0, retval);
+	TEST_ASSERT_EQUAL_HEX32(NO_OS_BIT(1), valid);
+	TEST_ASSERT_TRUE(device_alloc.diag_flags.checksum_err);
+	TEST_ASSERT_EQUAL_HEX8(ADIS_READ_BURST_DATA_CMD_MSB, buf[0]);
+	TEST_ASSERT_EQUAL_HEX8(0x00, buf[2 * 22]);
+}
+
 void test_adis1657x_read_burst32(void)
 {
 	test_adis_read_burst32_1();
@@ -0,0 +1,381 @@
+/***************************************************************************//**
+ *   @file   test_ade9430_wfb.c
+ *   @brief  Tests of the ADE9430 waveform buffer streaming.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "ade9430.h"
+#include "no_os_lf_ring.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include "mock_no_os_spi.h"
+#include "mock_no_os_delay.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define TEST_RING_SIZE	4096
+#define TEST_MAX_WRITES	32
+
+/* One page full event: STATUS0, then WFB_TRG_STAT before/after the burst */
+struct test_event {
+	uint32_t status;
+	uint32_t stat_before;
+	uint32_t stat_after;
+};
+
+/* Register values recorded while streaming, LAST_PAGE is in bits 15:12 */
+static const struct test_event trace_stream[] = {
+	{ 0x00020000, 0x7000, 0x8000 },
+	{ 0x00000000, 0, 0 },
+	{ 0x00020000, 0xf000, 0x0000 },
+	{ 0x00020000, 0x7000, 0x9000 },
+};
+
+/* Late servicing, a missed half and a half torn by the device */
+static const struct test_event trace_errors[] = {
+	{ 0x00020000, 0x9000, 0xa000 },
+	{ 0x00020000, 0x7000, 0x8000 },
+	{ 0x00020000, 0xf000, 0x7000 },
+};
+
+static struct no_os_spi_desc spi;
+static struct ade9430_dev dev;
+static const struct test_event *trace;
+static const struct test_event *event;
+static uint32_t trace_idx;
+static uint32_t stat_reads;
+static uint32_t bursts;
+static uint16_t writes_addr[TEST_MAX_WRITES];
+static uint32_t writes_val[TEST_MAX_WRITES];
+static uint32_t nb_writes;
+static int32_t samples[TEST_RING_SIZE];
+
+/* Waveform buffer content, the set number and the word position in the set */
+static int32_t wfb_word(uint32_t idx)
+{
+	int32_t val = (idx / 8) << 4 | (idx % 8);
+
+	return idx & 1 ? -val : val;
+}
+
+static uint16_t reg_size(uint16_t addr)
+{
+	return addr >= ADE9430_REG_RUN && addr <= ADE9430_REG_VERSION ? 2 : 4;
+}
+
+/* Every ade9430_wfb_process() call starts with a STATUS0 read */
+static uint32_t reg_read(uint16_t addr)
+{
+	switch (addr) {
+	case ADE9430_REG_STATUS0:
+		event = &trace[trace_idx++];
+		stat_reads = 0;
+		return event->status;
+	case ADE9430_REG_WFB_TRG_STAT:
+		return stat_reads++ ? event->stat_after : event->stat_before;
+	default:
+		return 0;
+	}
+}
+
+static uint32_t last_write(uint16_t addr);
+
+/*
+ * The burst returns the BURST_CHAN words of each 8 word sample set stored in
+ * the buffer half.
+ */
+static void wfb_burst(uint32_t idx, uint8_t *data, uint16_t bytes_number)
+{
+	uint32_t chan = no_os_field_get(ADE9430_BURST_CHAN,
+					last_write(ADE9430_REG_WFB_CFG));
+	uint32_t first = 0, set_words = ADE9430_WFB_SET_WORDS;
+	uint32_t i, j;
+
+	if (chan >= ADE9430_BURST_CHAN_SINGLE(0)) {
+		first = chan - ADE9430_BURST_CHAN_SINGLE(0);
+		set_words = 1;
+	} else if (chan >= ADE9430_BURST_CHAN_PAIR(0)) {
+		first = 2 * (chan - ADE9430_BURST_CHAN_PAIR(0));
+		set_words = 2;
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(ADE9430_WFB_BURST_SIZE(set_words),
+				 bytes_number);
+	for (i = 0; i < ADE9430_WFB_HALF_SETS; i++)
+		for (j = 0; j < set_words; j++, data += 4)
+			no_os_put_unaligned_be32(wfb_word(idx + i * 8 +
+							  first + j), data);
+}
+
+static int32_t spi_trace(struct no_os_spi_desc *desc, uint8_t *data,
+			 uint16_t bytes_number, int cmock_num_calls)
+{
+	uint16_t addr = (data[0] << 4) | (data[1] >> 4);
+
+	if (addr >= ADE9430_WFB_ADDR) {
+		TEST_ASSERT_TRUE(data[1] & ADE9430_SPI_READ);
+		wfb_burst(addr - ADE9430_WFB_ADDR, &data[2], bytes_number);
+		bursts++;
+		return 0;
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(2 + reg_size(addr), bytes_number);
+	if (data[1] & ADE9430_SPI_READ) {
+		if (reg_size(addr) == 2)
+			no_os_put_unaligned_be16(reg_read(addr), &data[2]);
+		else
+			no_os_put_unaligned_be32(reg_read(addr), &data[2]);
+		return 0;
+	}
+
+	TEST_ASSERT_LESS_THAN_UINT32(TEST_MAX_WRITES, nb_writes);
+	writes_addr[nb_writes] = addr;
+	writes_val[nb_writes++] = reg_size(addr) == 2 ?
+				  no_os_get_unaligned_be16(&data[2]) :
+				  no_os_get_unaligned_be32(&data[2]);
+
+	return 0;
+}
+
+static uint32_t last_write(uint16_t addr)
+{
+	uint32_t i = nb_writes;
+
+	while (i--)
+		if (writes_addr[i] == addr)
+			return writes_val[i];
+
+	TEST_FAIL_MESSAGE("register not written");
+
+	return 0;
+}
+
+static void start(uint8_t chan_mask, uint32_t ring_size)
+{
+	struct ade9430_wfb_param param = {
+		.src = ADE9430_WFB_SRC_SINC4,
+		.chan_mask = chan_mask,
+		.ring_size = ring_size,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_start(&dev, &param));
+}
+
+static void check_half(uint32_t half, uint8_t chan_mask, uint32_t nb)
+{
+	uint32_t base = half * ADE9430_WFB_HALF_WORDS;
+	uint32_t i, j = 0;
+
+	TEST_ASSERT_EQUAL_INT(nb, ade9430_wfb_read(&dev, samples,
+			      TEST_RING_SIZE));
+
+	for (i = 0; i < ADE9430_WFB_HALF_WORDS; i++) {
+		if (!(chan_mask & NO_OS_BIT(i % ADE9430_WFB_SET_WORDS)))
+			continue;
+		TEST_ASSERT_EQUAL_INT32(wfb_word(base + i), samples[j++]);
+	}
+	TEST_ASSERT_EQUAL_UINT32(nb, j);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	memset(&dev, 0, sizeof(dev));
+	dev.spi_desc = &spi;
+	trace = trace_stream;
+	trace_idx = 0;
+	event = NULL;
+	stat_reads = 0;
+	bursts = 0;
+	nb_writes = 0;
+	no_os_spi_write_and_read_StubWithCallback(spi_trace);
+}
+
+void tearDown(void)
+{
+	if (dev.wfb)
+		ade9430_wfb_stop(&dev);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_ade9430_wfb_start_invalid(void)
+{
+	struct ade9430_wfb_param param = {
+		.chan_mask = 0,
+		.ring_size = TEST_RING_SIZE,
+	};
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, ade9430_wfb_start(&dev, &param));
+	param.chan_mask = NO_OS_BIT(ADE9430_WFB_NB_CHAN);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, ade9430_wfb_start(&dev, &param));
+	/* The ring cannot hold one buffer half of the 7 channels */
+	param.chan_mask = NO_OS_GENMASK(6, 0);
+	param.ring_size = 512;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, ade9430_wfb_start(&dev, &param));
+	TEST_ASSERT_NULL(dev.wfb);
+	TEST_ASSERT_EQUAL_UINT32(0, nb_writes);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, ade9430_wfb_process(&dev));
+}
+
+void test_ade9430_wfb_start_config(void)
+{
+	struct ade9430_wfb_param param = {
+		.chan_mask = NO_OS_BIT(ADE9430_WFB_IA),
+		.ring_size = TEST_RING_SIZE,
+	};
+	uint32_t cfg;
+
+	start(NO_OS_GENMASK(6, 0), TEST_RING_SIZE);
+	TEST_ASSERT_EQUAL_UINT32(0x8080, last_write(ADE9430_REG_WFB_PG_IRQEN));
+	TEST_ASSERT_EQUAL_UINT32(ADE9430_MASK0_PAGE_FULL,
+				 last_write(ADE9430_REG_MASK0));
+	cfg = last_write(ADE9430_REG_WFB_CFG);
+	TEST_ASSERT_EQUAL_UINT32(ADE9430_WF_IN_EN | ADE9430_WF_CAP_EN |
+				 ADE9430_WF_CAP_SEL | ADE9430_WF_MODE, cfg);
+	TEST_ASSERT_EQUAL_INT(-EBUSY, ade9430_wfb_start(&dev, &param));
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_stop(&dev));
+
+	/* IB and VB only, a pair burst */
+	start(NO_OS_BIT(ADE9430_WFB_IB) | NO_OS_BIT(ADE9430_WFB_VB),
+	      TEST_RING_SIZE);
+	cfg = last_write(ADE9430_REG_WFB_CFG);
+	TEST_ASSERT_EQUAL_UINT32(2, no_os_field_get(ADE9430_BURST_CHAN, cfg));
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_stop(&dev));
+
+	/* VC alone */
+	start(NO_OS_BIT(ADE9430_WFB_VC), TEST_RING_SIZE);
+	cfg = last_write(ADE9430_REG_WFB_CFG);
+	TEST_ASSERT_EQUAL_UINT32(13, no_os_field_get(ADE9430_BURST_CHAN, cfg));
+	TEST_ASSERT_FALSE(cfg & ADE9430_WF_IN_EN);
+}
+
+void test_ade9430_wfb_stream(void)
+{
+	struct ade9430_wfb_stats stats;
+	/* IA, VA, IC and IN out of the 8 word sample sets */
+	uint8_t mask = NO_OS_BIT(ADE9430_WFB_IA) | NO_OS_BIT(ADE9430_WFB_VA) |
+		       NO_OS_BIT(ADE9430_WFB_IC) | NO_OS_BIT(ADE9430_WFB_IN);
+	uint32_t nb = ADE9430_WFB_HALF_SETS * 4;
+
+	start(mask, TEST_RING_SIZE);
+
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	check_half(0, mask, nb);
+	/* No page full event, no burst */
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_process(&dev));
+	TEST_ASSERT_EQUAL_UINT32(1, bursts);
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	check_half(1, mask, nb);
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	check_half(0, mask, nb);
+
+	TEST_ASSERT_EQUAL_UINT32(ADE9430_STATUS0_PAGE_FULL,
+				 last_write(ADE9430_REG_STATUS0));
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_stats_get(&dev, &stats));
+	TEST_ASSERT_EQUAL_UINT32(3, stats.halves);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.late);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.ring_full);
+}
+
+void test_ade9430_wfb_pair(void)
+{
+	uint8_t mask = NO_OS_BIT(ADE9430_WFB_IC) | NO_OS_BIT(ADE9430_WFB_VC);
+
+	start(mask, TEST_RING_SIZE);
+
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	/* The burst only holds the IC/VC words of each set, all are kept */
+	check_half(0, mask, ADE9430_WFB_HALF_SETS * 2);
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_process(&dev));
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	check_half(1, mask, ADE9430_WFB_HALF_SETS * 2);
+}
+
+void test_ade9430_wfb_errors(void)
+{
+	struct ade9430_wfb_stats stats;
+
+	trace = trace_errors;
+	start(NO_OS_GENMASK(5, 0), TEST_RING_SIZE);
+
+	/* Serviced while page 9 was written, half 0 is still safe */
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	/* Half 0 again, half 1 was overwritten in between */
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	/* The device wrapped into half 1 during the burst */
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_process(&dev));
+	TEST_ASSERT_EQUAL_UINT32(3, bursts);
+
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_stats_get(&dev, &stats));
+	TEST_ASSERT_EQUAL_UINT32(2, stats.halves);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.late);
+	TEST_ASSERT_EQUAL_UINT32(2, stats.overruns);
+	TEST_ASSERT_EQUAL_INT(2 * ADE9430_WFB_HALF_SETS * 6,
+			      ade9430_wfb_read(&dev, samples, TEST_RING_SIZE));
+}
+
+void test_ade9430_wfb_ring_full(void)
+{
+	struct ade9430_wfb_stats stats;
+
+	start(NO_OS_BIT(ADE9430_WFB_IA), ADE9430_WFB_HALF_SETS);
+
+	/* The ring holds one half, the next one is dropped without a burst */
+	TEST_ASSERT_EQUAL_INT(1, ade9430_wfb_process(&dev));
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_process(&dev));
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_process(&dev));
+	TEST_ASSERT_EQUAL_UINT32(1, bursts);
+
+	TEST_ASSERT_EQUAL_INT(0, ade9430_wfb_stats_get(&dev, &stats));
+	TEST_ASSERT_EQUAL_UINT32(1, stats.halves);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.ring_full);
+	check_half(0, NO_OS_BIT(ADE9430_WFB_IA), ADE9430_WFB_HALF_SETS);
+}
@@ -0,0 +1,198 @@
+/***************************************************************************//**
+ *   @file   test_adin1110.c
+ *   @brief  Tests of the ADIN1110 zero-copy FIFO access.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "adin1110.h"
+#include "no_os_alloc.h"
+#include "no_os_crc8.h"
+#include "no_os_util.h"
+#include "mock_no_os_spi.h"
+#include "mock_no_os_gpio.h"
+#include "mock_no_os_delay.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define TEST_MAX_BYTES	(ADIN1110_BUFF_LEN + 16)
+
+static struct no_os_spi_desc spi;
+static struct adin1110_desc dev;
+/* Bytes clocked by the last transfer, as seen on MOSI */
+static uint8_t mosi[TEST_MAX_BYTES];
+static uint32_t nb_bytes;
+static uint32_t nb_msgs;
+static uint32_t transfers;
+
+/*
+ * The bus only clocks the messages with a buffer, like the Maxim SPI
+ * controllers, so every message must have one. The RX FIFO content is
+ * the position of the byte in the transfer.
+ */
+static int32_t spi_transfer(struct no_os_spi_desc *desc,
+			    struct no_os_spi_msg *msgs, uint32_t len,
+			    int cmock_num_calls)
+{
+	uint32_t i, j;
+
+	nb_bytes = 0;
+	nb_msgs = len;
+	transfers++;
+	for (i = 0; i < len; i++) {
+		TEST_ASSERT_TRUE(msgs[i].tx_buff || msgs[i].rx_buff);
+		TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_MAX_BYTES - nb_bytes,
+						 msgs[i].bytes_number);
+		for (j = 0; j < msgs[i].bytes_number; j++, nb_bytes++) {
+			mosi[nb_bytes] = msgs[i].tx_buff ?
+					 msgs[i].tx_buff[j] : 0;
+			if (msgs[i].rx_buff)
+				msgs[i].rx_buff[j] = nb_bytes;
+		}
+		TEST_ASSERT_EQUAL_UINT8(i == len - 1, msgs[i].cs_change);
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	memset(&dev, 0, sizeof(dev));
+	dev.chip_type = ADIN1110;
+	dev.comm_desc = &spi;
+	dev.tx_space = 0x1000;
+	nb_bytes = 0;
+	nb_msgs = 0;
+	transfers = 0;
+	no_os_spi_transfer_StubWithCallback(spi_transfer);
+}
+
+void tearDown(void) {}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_adin1110_write_fifo_sg_padding(void)
+{
+	uint8_t hdr[14], payload[7];
+	struct adin1110_buf_seg segs[] = {
+		{ hdr, sizeof(hdr) },
+		{ NULL, 0 },
+		{ payload, sizeof(payload) },
+	};
+	uint32_t i;
+
+	memset(hdr, 0x11, sizeof(hdr));
+	memset(payload, 0x22, sizeof(payload));
+	TEST_ASSERT_EQUAL_INT(0, adin1110_write_fifo_sg(&dev, 0, segs, 3));
+
+	/* TX_FSIZE write, then the frame padded to 60 bytes plus the FCS */
+	TEST_ASSERT_EQUAL_UINT32(2, transfers);
+	TEST_ASSERT_EQUAL_UINT32(4, nb_msgs);
+	TEST_ASSERT_EQUAL_UINT32(ADIN1110_WR_HEADER_LEN +
+				 no_os_align(ADIN1110_FRAME_HEADER_LEN + 60, 4),
+				 nb_bytes);
+	i = ADIN1110_WR_HEADER_LEN + ADIN1110_FRAME_HEADER_LEN;
+	TEST_ASSERT_EACH_EQUAL_HEX8(0x11, &mosi[i], sizeof(hdr));
+	i += sizeof(hdr);
+	TEST_ASSERT_EACH_EQUAL_HEX8(0x22, &mosi[i], sizeof(payload));
+	i += sizeof(payload);
+	TEST_ASSERT_EACH_EQUAL_HEX8(0, &mosi[i], nb_bytes - i);
+}
+
+void test_adin1110_write_fifo_sg_align(void)
+{
+	uint8_t frame[61];
+	struct adin1110_buf_seg seg = { frame, sizeof(frame) };
+
+	/* No padding, the alignment bytes are still clocked */
+	memset(frame, 0x33, sizeof(frame));
+	TEST_ASSERT_EQUAL_INT(0, adin1110_write_fifo_sg(&dev, 0, &seg, 1));
+	TEST_ASSERT_EQUAL_UINT32(3, nb_msgs);
+	TEST_ASSERT_EQUAL_UINT32(ADIN1110_WR_HEADER_LEN +
+				 no_os_align(ADIN1110_FRAME_HEADER_LEN +
+					     sizeof(frame), 4), nb_bytes);
+	TEST_ASSERT_EACH_EQUAL_HEX8(0, &mosi[nb_bytes - 1], 1);
+}
+
+void test_adin1110_read_fifo_sg_segs(void)
+{
+	uint8_t a[20], b[30];
+	struct adin1110_buf_seg segs[] = {
+		{ a, sizeof(a) },
+		{ b, sizeof(b) },
+	};
+	uint32_t start = ADIN1110_RD_HEADER_LEN + ADIN1110_FRAME_HEADER_LEN;
+	uint32_t i;
+
+	/* 50 bytes in the segments, 11 dropped and 1 for the alignment */
+	TEST_ASSERT_EQUAL_INT(0, adin1110_read_fifo_sg(&dev, 0, segs, 2, 61));
+	TEST_ASSERT_EQUAL_UINT32(4, nb_msgs);
+	TEST_ASSERT_EQUAL_UINT32(start + 62, nb_bytes);
+	for (i = 0; i < sizeof(a); i++)
+		TEST_ASSERT_EQUAL_UINT8(start + i, a[i]);
+	for (i = 0; i < sizeof(b); i++)
+		TEST_ASSERT_EQUAL_UINT8(start + sizeof(a) + i, b[i]);
+}
+
+void test_adin1110_read_fifo_sg_drop(void)
+{
+	uint32_t start = ADIN1110_RD_HEADER_LEN + ADIN1110_FRAME_HEADER_LEN;
+
+	/* The whole frame is discarded, the FIFO stays aligned */
+	TEST_ASSERT_EQUAL_INT(0, adin1110_read_fifo_sg(&dev, 0, NULL, 0,
+			      ADIN1110_BUFF_LEN - ADIN1110_FRAME_HEADER_LEN));
+	TEST_ASSERT_EQUAL_UINT32(2, nb_msgs);
+	TEST_ASSERT_EQUAL_UINT32(start + no_os_align(ADIN1110_BUFF_LEN, 4) -
+				 ADIN1110_FRAME_HEADER_LEN, nb_bytes);
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adin1110_read_fifo_sg(&dev, 0, NULL, 0,
+			      ADIN1110_BUFF_LEN + 1));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, adin1110_read_fifo_sg(&dev, 0, NULL, 0,
+			      0));
+}
@@ -0,0 +1,466 @@
+/***************************************************************************//**
+ *   @file   test_linux_spi.c
+ *   @brief  Tests of the Linux spidev message batching.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "linux_spi.h"
+#include "no_os_spi.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/spi/spidev.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/*
+ * open, ioctl and close are replaced by a spidev model for /dev/spidev*,
+ * the other files go to the kernel. The model loops tx_buf back to rx_buf
+ * and fills rx_buf with 0xA5 when there is nothing to send.
+ */
+#define TEST_SPIDEV_FD		1000
+#define TEST_BUFSIZ		4096
+#define TEST_LEN_ALIGN		128
+#define TEST_MAX_TRANSFERS	511
+
+static uint32_t nb_ioctl;
+static uint32_t last_nb_tr;
+static uint8_t cs_change[TEST_MAX_TRANSFERS];
+static uint32_t lens[TEST_MAX_TRANSFERS];
+/* errno of the next SPI_IOC_MESSAGE() calls, 0 for success */
+static int fail_errno;
+static uint32_t bufsiz;
+
+static struct no_os_spi_desc *desc;
+static pthread_t main_thread;
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t async_cond = PTHREAD_COND_INITIALIZER;
+static bool async_done;
+static bool async_other_thread;
+static int32_t async_status;
+static bool gate_entered;
+static bool gate_open;
+static int32_t remove_ret;
+
+int open(const char *path, int flags, ...)
+{
+	va_list ap;
+	int mode = 0;
+
+	if (!strncmp(path, "/dev/spidev", strlen("/dev/spidev")))
+		return TEST_SPIDEV_FD;
+
+	if (flags & O_CREAT) {
+		va_start(ap, flags);
+		mode = va_arg(ap, int);
+		va_end(ap);
+	}
+
+	return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+int close(int fd)
+{
+	if (fd == TEST_SPIDEV_FD)
+		return 0;
+
+	return syscall(SYS_close, fd);
+}
+
+static int spidev_message(struct spi_ioc_transfer *tr, uint32_t nb_tr)
+{
+	uint32_t total = 0;
+	uint32_t i;
+	void *rx;
+
+	if (fail_errno) {
+		errno = fail_errno;
+		return -1;
+	}
+
+	for (i = 0; i < nb_tr; i++) {
+		total += NO_OS_DIV_ROUND_UP(tr[i].len, TEST_LEN_ALIGN) *
+			 TEST_LEN_ALIGN;
+		rx = (void *)(uintptr_t)tr[i].rx_buf;
+		if (rx && tr[i].tx_buf)
+			memmove(rx, (void *)(uintptr_t)tr[i].tx_buf, tr[i].len);
+		else if (rx)
+			memset(rx, 0xA5, tr[i].len);
+		cs_change[i] = tr[i].cs_change;
+		lens[i] = tr[i].len;
+	}
+
+	/* spidev rejects what doesn't fit its buffer */
+	if (total > bufsiz) {
+		errno = EMSGSIZE;
+		return -1;
+	}
+
+	nb_ioctl++;
+	last_nb_tr = nb_tr;
+
+	return total;
+}
+
+int ioctl(int fd, unsigned long req, ...)
+{
+	va_list ap;
+	void *arg;
+
+	va_start(ap, req);
+	arg = va_arg(ap, void *);
+	va_end(ap);
+
+	if (fd != TEST_SPIDEV_FD)
+		return syscall(SYS_ioctl, fd, req, arg);
+
+	if (_IOC_TYPE(req) == SPI_IOC_MAGIC && _IOC_NR(req) == 0 &&
+	    _IOC_DIR(req) == _IOC_WRITE)
+		return spidev_message(arg, _IOC_SIZE(req) /
+				      sizeof(struct spi_ioc_transfer));
+
+	/* Mode, bits per word and speed */
+	return 0;
+}
+
+/* Same source as the driver, the module may be loaded on the host */
+static uint32_t spidev_bufsiz(void)
+{
+	unsigned int val;
+	FILE *f;
+	int ret;
+
+	f = fopen("/sys/module/spidev/parameters/bufsiz", "r");
+	if (!f)
+		return TEST_BUFSIZ;
+
+	ret = fscanf(f, "%u", &val);
+	fclose(f);
+
+	return ret == 1 && val ? val : TEST_BUFSIZ;
+}
+
+static void default_bufsiz(void)
+{
+	if (bufsiz != TEST_BUFSIZ)
+		TEST_IGNORE_MESSAGE("spidev bufsiz is not the default");
+}
+
+static void async_callback(void *ctx)
+{
+	pthread_mutex_lock(&async_lock);
+	async_other_thread = !pthread_equal(pthread_self(), main_thread);
+	async_status = linux_spi_async_status(ctx);
+	async_done = true;
+	pthread_cond_signal(&async_cond);
+	pthread_mutex_unlock(&async_lock);
+}
+
+/* Hold the worker in the callback until the test opens the gate */
+static void gate_callback(void *ctx)
+{
+	pthread_mutex_lock(&async_lock);
+	gate_entered = true;
+	pthread_cond_broadcast(&async_cond);
+	while (!gate_open)
+		pthread_cond_wait(&async_cond, &async_lock);
+	pthread_mutex_unlock(&async_lock);
+}
+
+static void *remove_thread(void *arg)
+{
+	remove_ret = linux_spi_ops.remove(arg);
+
+	return NULL;
+}
+
+static void async_wait(void)
+{
+	struct timespec deadline;
+	bool done;
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += 10;
+
+	pthread_mutex_lock(&async_lock);
+	while (!async_done &&
+	       !pthread_cond_timedwait(&async_cond, &async_lock, &deadline))
+		;
+	done = async_done;
+	async_done = false;
+	pthread_mutex_unlock(&async_lock);
+
+	TEST_ASSERT_TRUE(done);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct no_os_spi_init_param param = {
+		.device_id = 0,
+		.chip_select = 0,
+		.max_speed_hz = 1000000,
+	};
+
+	nb_ioctl = 0;
+	last_nb_tr = 0;
+	fail_errno = 0;
+	async_done = false;
+	gate_entered = false;
+	gate_open = false;
+	bufsiz = spidev_bufsiz();
+
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.init(&desc, &param));
+}
+
+void tearDown(void)
+{
+	if (desc)
+		TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.remove(desc));
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_linux_spi_transfer(void)
+{
+	uint8_t a[4] = {1, 2, 3, 4};
+	uint8_t b[2] = {5, 6};
+	uint8_t rx[4];
+	struct no_os_spi_msg msgs[] = {
+		{
+			.tx_buff = a, .rx_buff = rx, .bytes_number = 4,
+			.cs_change = 1
+		},
+		{.tx_buff = b, .bytes_number = 2},
+		{.rx_buff = rx, .bytes_number = 3},
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.transfer(desc, msgs, 3));
+
+	/* One call, spidev inverts cs_change on the last transfer */
+	TEST_ASSERT_EQUAL_UINT32(1, nb_ioctl);
+	TEST_ASSERT_EQUAL_UINT32(3, last_nb_tr);
+	TEST_ASSERT_EQUAL_UINT8(1, cs_change[0]);
+	TEST_ASSERT_EQUAL_UINT8(0, cs_change[1]);
+	TEST_ASSERT_EQUAL_UINT8(0, cs_change[2]);
+	TEST_ASSERT_EQUAL_HEX8(0xA5, rx[0]);
+	TEST_ASSERT_EQUAL_HEX8(4, rx[3]);
+}
+
+void test_linux_spi_queue(void)
+{
+	uint8_t reg[3] = {0x80, 0x12, 0x34};
+	struct no_os_spi_msg msg = {.tx_buff = reg, .bytes_number = 3};
+	uint32_t i;
+
+	default_bufsiz();
+
+	/* 32 transfers fill the buffer, the queue is sent when full */
+	for (i = 0; i < 1000; i++)
+		TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.queue(desc, &msg, 1));
+	TEST_ASSERT_EQUAL_UINT32(31, nb_ioctl);
+	TEST_ASSERT_EQUAL_UINT32(32, last_nb_tr);
+
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.flush(desc));
+	TEST_ASSERT_EQUAL_UINT32(32, nb_ioctl);
+	TEST_ASSERT_EQUAL_UINT32(1000 - 31 * 32, last_nb_tr);
+	TEST_ASSERT_EQUAL_UINT8(1, cs_change[0]);
+	TEST_ASSERT_EQUAL_UINT8(0, cs_change[last_nb_tr - 1]);
+
+	/* Nothing left */
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.flush(desc));
+	TEST_ASSERT_EQUAL_UINT32(32, nb_ioctl);
+}
+
+void test_linux_spi_max_transfers(void)
+{
+	struct no_os_spi_msg msg = {0};
+	uint32_t i;
+
+	for (i = 0; i < 1200; i++)
+		TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.queue(desc, &msg, 1));
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.flush(desc));
+
+	TEST_ASSERT_EQUAL_UINT32(3, nb_ioctl);
+	TEST_ASSERT_EQUAL_UINT32(1200 - 2 * TEST_MAX_TRANSFERS, last_nb_tr);
+}
+
+void test_linux_spi_split(void)
+{
+	static uint8_t tx[10000];
+	static uint8_t rx[10000];
+	struct no_os_spi_msg msg = {
+		.tx_buff = tx,
+		.rx_buff = rx,
+		.bytes_number = sizeof(tx),
+		.cs_change = 1,
+	};
+	uint32_t i;
+
+	default_bufsiz();
+
+	for (i = 0; i < sizeof(tx); i++)
+		tx[i] = i * 7;
+
+	/* CS stays asserted between the parts */
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.transfer(desc, &msg, 1));
+	TEST_ASSERT_EQUAL_UINT32(3, nb_ioctl);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(tx) - 2 * TEST_BUFSIZ, lens[0]);
+	TEST_ASSERT_EQUAL_UINT8(0, cs_change[0]);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx, rx, sizeof(tx));
+}
+
+void test_linux_spi_write_and_read(void)
+{
+	uint8_t reg[3] = {0x80, 0x12, 0x34};
+	uint8_t data[2] = {9, 8};
+	struct no_os_spi_msg msg = {.tx_buff = reg, .bytes_number = 3};
+
+	/* The queued message goes out in the same call */
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.queue(desc, &msg, 1));
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.write_and_read(desc, data, 2));
+	TEST_ASSERT_EQUAL_UINT32(1, nb_ioctl);
+	TEST_ASSERT_EQUAL_UINT32(2, last_nb_tr);
+	TEST_ASSERT_EQUAL_UINT8(1, cs_change[0]);
+	TEST_ASSERT_EQUAL_UINT8(0, cs_change[1]);
+	TEST_ASSERT_EQUAL_HEX8(9, data[0]);
+}
+
+void test_linux_spi_error(void)
+{
+	uint8_t data[2] = {9, 8};
+	struct no_os_spi_msg msg = {.tx_buff = data, .bytes_number = 2};
+
+	/* The errno of the ioctl, not the one left by the error message */
+	fail_errno = ETIMEDOUT;
+	TEST_ASSERT_EQUAL_INT(-ETIMEDOUT, linux_spi_ops.transfer(desc, &msg,
+			      1));
+	TEST_ASSERT_EQUAL_INT(-1, linux_spi_ops.write_and_read(desc, data, 2));
+
+	fail_errno = 0;
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.transfer(desc, &msg, 1));
+}
+
+void test_linux_spi_async(void)
+{
+	uint8_t tx[4] = {1, 2, 3, 4};
+	uint8_t rx[4] = {0};
+	struct no_os_spi_msg msg = {
+		.tx_buff = tx,
+		.rx_buff = rx,
+		.bytes_number = 4,
+		.cs_change = 1,
+	};
+
+	main_thread = pthread_self();
+
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.dma_transfer_async(desc, &msg,
+			      1, async_callback, desc));
+	async_wait();
+	TEST_ASSERT_TRUE(async_other_thread);
+	TEST_ASSERT_EQUAL_INT(0, async_status);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(tx, rx, 4);
+
+	/* A failure is reported to the callback and kept afterwards */
+	fail_errno = EIO;
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.dma_transfer_async(desc, &msg,
+			      1, async_callback, desc));
+	async_wait();
+	TEST_ASSERT_EQUAL_INT(-EIO, async_status);
+	TEST_ASSERT_EQUAL_INT(-EIO, linux_spi_async_status(desc));
+
+	fail_errno = 0;
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.dma_transfer_sync(desc, &msg,
+			      1));
+}
+
+void test_linux_spi_remove_pending(void)
+{
+	uint8_t tx[4] = {1, 2, 3, 4};
+	struct no_os_spi_msg msg = {.tx_buff = tx, .bytes_number = 4};
+	pthread_t remover;
+
+	main_thread = pthread_self();
+
+	/* The first request holds the worker in its callback */
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.dma_transfer_async(desc, &msg,
+			      1, gate_callback, desc));
+	pthread_mutex_lock(&async_lock);
+	while (!gate_entered)
+		pthread_cond_wait(&async_cond, &async_lock);
+	pthread_mutex_unlock(&async_lock);
+
+	/* The second one is pending when the descriptor is removed */
+	TEST_ASSERT_EQUAL_INT(0, linux_spi_ops.dma_transfer_async(desc, &msg,
+			      1, async_callback, desc));
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&remover, NULL, remove_thread,
+						desc));
+	while (linux_spi_async_status(desc) == -EINPROGRESS)
+		usleep(1000);
+
+	pthread_mutex_lock(&async_lock);
+	gate_open = true;
+	pthread_cond_broadcast(&async_cond);
+	pthread_mutex_unlock(&async_lock);
+
+	async_wait();
+	pthread_join(remover, NULL);
+	desc = NULL;
+
+	TEST_ASSERT_EQUAL_INT(0, remove_ret);
+	TEST_ASSERT_EQUAL_INT(-ECANCELED, async_status);
+	TEST_ASSERT_EQUAL_UINT32(1, nb_ioctl);
+}
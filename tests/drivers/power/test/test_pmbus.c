@@ -0,0 +1,434 @@
+/***************************************************************************//**
+ *   @file   test_pmbus.c
+ *   @brief  Tests of the PMBus PEC and page handling.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "pmbus.h"
+#include "no_os_crc8.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define TEST_ADDR	0x4F
+#define TEST_NB_PAGES	8
+
+/* Device model: one register file per page */
+static uint16_t regs[TEST_NB_PAGES][256];
+static uint8_t dev_page;
+/* Set to ignore PAGE writes */
+static bool page_stuck;
+/* Number of writes rejected because of a bad PEC */
+static uint32_t bad_writes;
+/* Transfer whose responses get a corrupted PEC, 0 for none */
+static uint32_t corrupt_xfer;
+static uint32_t nb_xfers;
+
+static struct no_os_i2c_desc i2c_desc;
+static struct no_os_i2c_init_param i2c_ip = {
+	.slave_address = TEST_ADDR,
+};
+static struct pmbus_dev *dev;
+
+/* Bitwise CRC-8, x^8 + x^2 + x + 1 */
+static uint8_t crc8_bitwise(const uint8_t *buf, uint32_t len, uint8_t crc)
+{
+	uint32_t i;
+	int k;
+
+	for (i = 0; i < len; i++) {
+		crc ^= buf[i];
+		for (k = 0; k < 8; k++)
+			crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+
+	return crc;
+}
+
+static uint8_t model_pec(const uint8_t *wbuf, uint32_t wlen,
+			 const uint8_t *rbuf, uint32_t rlen)
+{
+	uint8_t byte = TEST_ADDR << 1;
+	uint8_t crc;
+
+	crc = crc8_bitwise(&byte, 1, 0);
+	crc = crc8_bitwise(wbuf, wlen, crc);
+	if (!rlen)
+		return crc;
+
+	byte |= 1;
+	crc = crc8_bitwise(&byte, 1, crc);
+
+	return crc8_bitwise(rbuf, rlen, crc);
+}
+
+static void model_write(uint8_t *buf, uint32_t len)
+{
+	uint8_t page = dev_page;
+
+	if (dev->pec_en) {
+		if (model_pec(buf, len - 1, NULL, 0) != buf[len - 1]) {
+			bad_writes++;
+			return;
+		}
+		len--;
+	}
+
+	switch (buf[0]) {
+	case PMBUS_PAGE:
+		if (!page_stuck)
+			dev_page = buf[1];
+		return;
+	case PMBUS_PAGE_PLUS_WRITE:
+		TEST_ASSERT_EQUAL_UINT8(len - 2, buf[1]);
+		page = buf[2];
+		buf += 3;
+		len -= 3;
+		break;
+	default:
+		break;
+	}
+
+	if (len == 3)
+		regs[page][buf[0]] = no_os_get_unaligned_le16(&buf[1]);
+	else if (len == 2)
+		regs[page][buf[0]] = buf[1];
+}
+
+static void model_read(const uint8_t *wbuf, uint32_t wlen, uint8_t *rbuf,
+		       uint32_t rlen)
+{
+	uint8_t page = dev_page;
+	uint8_t cmd = wbuf[0];
+	uint32_t n = 0;
+
+	if (cmd == PMBUS_PAGE_PLUS_READ) {
+		TEST_ASSERT_EQUAL_UINT32(4, wlen);
+		page = wbuf[2];
+		cmd = wbuf[3];
+		rbuf[n++] = 2;
+	}
+
+	if (cmd == PMBUS_PAGE) {
+		rbuf[n++] = dev_page;
+	} else {
+		no_os_put_unaligned_le16(regs[page][cmd], &rbuf[n]);
+		n += 2;
+	}
+
+	if (dev->pec_en) {
+		rbuf[n] = model_pec(wbuf, wlen, rbuf, n);
+		if (nb_xfers == corrupt_xfer)
+			rbuf[n] ^= 0x01;
+		n++;
+	}
+
+	TEST_ASSERT_EQUAL_UINT32(n, rlen);
+}
+
+static void fill_regs(void)
+{
+	int page, cmd;
+
+	for (page = 0; page < TEST_NB_PAGES; page++)
+		for (cmd = 0; cmd < 256; cmd++)
+			regs[page][cmd] = page << 8 | cmd;
+}
+
+int32_t no_os_i2c_init(struct no_os_i2c_desc **desc,
+		       const struct no_os_i2c_init_param *param)
+{
+	i2c_desc.slave_address = param->slave_address;
+	*desc = &i2c_desc;
+
+	return 0;
+}
+
+int32_t no_os_i2c_remove(struct no_os_i2c_desc *desc)
+{
+	return 0;
+}
+
+int32_t no_os_i2c_write(struct no_os_i2c_desc *desc, uint8_t *data,
+			uint8_t bytes_number, uint8_t stop_bit)
+{
+	TEST_FAIL_MESSAGE("unexpected plain write");
+
+	return -EIO;
+}
+
+int32_t no_os_i2c_transfer(struct no_os_i2c_desc *desc,
+			   struct no_os_i2c_msg *msgs, uint32_t len)
+{
+	uint32_t i;
+
+	nb_xfers++;
+
+	for (i = 0; i < len; i++) {
+		TEST_ASSERT_FALSE(msgs[i].read);
+		if (i + 1 < len && msgs[i + 1].read) {
+			model_read(msgs[i].buff, msgs[i].bytes_number,
+				   msgs[i + 1].buff, msgs[i + 1].bytes_number);
+			i++;
+		} else {
+			model_write(msgs[i].buff, msgs[i].bytes_number);
+		}
+	}
+
+	return 0;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct pmbus_init_param ip = {
+		.i2c_init = &i2c_ip,
+		.pec_en = true,
+		.chain_max = 4,
+	};
+
+	memset(regs, 0, sizeof(regs));
+	dev_page = 0;
+	page_stuck = false;
+	bad_writes = 0;
+	corrupt_xfer = 0;
+	nb_xfers = 0;
+
+	TEST_ASSERT_EQUAL_INT(0, pmbus_init(&dev, &ip));
+}
+
+void tearDown(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, pmbus_remove(dev));
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_pmbus_pec(void)
+{
+	uint8_t wbuf[5], rbuf[7];
+	uint32_t i, j;
+
+	/* The read address is only part of the PEC when bytes are read */
+	for (i = 0; i < 32; i++) {
+		for (j = 0; j < sizeof(wbuf); j++)
+			wbuf[j] = i * 37 + j * 11;
+		for (j = 0; j < sizeof(rbuf); j++)
+			rbuf[j] = i * 53 + j * 29;
+
+		TEST_ASSERT_EQUAL_HEX8(model_pec(wbuf, i % 6, NULL, 0),
+				       pmbus_pec(TEST_ADDR, wbuf, i % 6,
+						 NULL, 0));
+		TEST_ASSERT_EQUAL_HEX8(model_pec(wbuf, i % 6, rbuf, i % 8),
+				       pmbus_pec(TEST_ADDR, wbuf, i % 6,
+						 rbuf, i % 8));
+		TEST_ASSERT_EQUAL_HEX8(model_pec(wbuf, i % 6, rbuf, 0),
+				       pmbus_pec(TEST_ADDR, wbuf, i % 6,
+						 rbuf, 0));
+	}
+}
+
+void test_pmbus_page_cache(void)
+{
+	uint16_t word;
+
+	TEST_ASSERT_EQUAL_INT(0, pmbus_write_word(dev, 2, PMBUS_VOUT_COMMAND,
+			      0xABCD));
+	TEST_ASSERT_EQUAL_UINT32(2, nb_xfers);
+	TEST_ASSERT_EQUAL_INT(2, dev->page);
+	TEST_ASSERT_EQUAL_UINT8(2, dev_page);
+
+	/* PAGE is not written again while it is cached */
+	TEST_ASSERT_EQUAL_INT(0, pmbus_read_word(dev, 2, PMBUS_VOUT_COMMAND,
+			      &word));
+	TEST_ASSERT_EQUAL_UINT32(3, nb_xfers);
+	TEST_ASSERT_EQUAL_HEX16(0xABCD, word);
+	TEST_ASSERT_EQUAL_HEX16(0xABCD, regs[2][PMBUS_VOUT_COMMAND]);
+
+	pmbus_invalidate(dev);
+	TEST_ASSERT_EQUAL_INT(PMBUS_PAGE_NONE, dev->page);
+	TEST_ASSERT_EQUAL_INT(0, pmbus_read_word(dev, 2, PMBUS_VOUT_COMMAND,
+			      &word));
+	TEST_ASSERT_EQUAL_UINT32(5, nb_xfers);
+
+	TEST_ASSERT_EQUAL_UINT32(0, bad_writes);
+	TEST_ASSERT_EQUAL_UINT32(0, dev->pec_errors);
+	TEST_ASSERT_EQUAL_UINT32(nb_xfers, dev->transfers);
+}
+
+void test_pmbus_read_word_bad_pec(void)
+{
+	uint16_t word = 0x5555;
+
+	fill_regs();
+	TEST_ASSERT_EQUAL_INT(0, pmbus_set_page(dev, 1));
+
+	corrupt_xfer = nb_xfers + 1;
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, pmbus_read_word(dev, 1,
+			      PMBUS_READ_VOUT, &word));
+	TEST_ASSERT_EQUAL_HEX16(0x5555, word);
+	TEST_ASSERT_EQUAL_UINT32(1, dev->pec_errors);
+
+	TEST_ASSERT_EQUAL_INT(0, pmbus_read_word(dev, 1, PMBUS_READ_VOUT,
+			      &word));
+	TEST_ASSERT_EQUAL_HEX16(0x0100 | PMBUS_READ_VOUT, word);
+}
+
+/* The readback only depends on page_verify, its PEC is checked when enabled */
+void test_pmbus_page_verify_pec(void)
+{
+	dev->page_verify = true;
+
+	TEST_ASSERT_EQUAL_INT(0, pmbus_set_page(dev, 3));
+	TEST_ASSERT_EQUAL_UINT32(2, nb_xfers);
+	TEST_ASSERT_EQUAL_INT(3, dev->page);
+
+	corrupt_xfer = nb_xfers + 2;
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, pmbus_set_page(dev, 1));
+	TEST_ASSERT_EQUAL_UINT32(1, dev->pec_errors);
+	TEST_ASSERT_EQUAL_INT(PMBUS_PAGE_NONE, dev->page);
+
+	/* Not cached, so PAGE is written and read back again */
+	TEST_ASSERT_EQUAL_INT(0, pmbus_set_page(dev, 1));
+	TEST_ASSERT_EQUAL_UINT32(6, nb_xfers);
+	TEST_ASSERT_EQUAL_INT(1, dev->page);
+	TEST_ASSERT_EQUAL_UINT8(1, dev_page);
+}
+
+void test_pmbus_page_verify_mismatch(void)
+{
+	dev->page_verify = true;
+	dev->pec_en = false;
+	page_stuck = true;
+
+	TEST_ASSERT_EQUAL_INT(-EIO, pmbus_set_page(dev, 4));
+	TEST_ASSERT_EQUAL_UINT32(2, nb_xfers);
+	TEST_ASSERT_EQUAL_INT(PMBUS_PAGE_NONE, dev->page);
+
+	page_stuck = false;
+	TEST_ASSERT_EQUAL_INT(0, pmbus_set_page(dev, 4));
+	TEST_ASSERT_EQUAL_INT(4, dev->page);
+}
+
+void test_pmbus_page_plus(void)
+{
+	uint16_t word;
+
+	fill_regs();
+	dev->page_plus = true;
+	TEST_ASSERT_EQUAL_INT(0, pmbus_set_page(dev, 0));
+	nb_xfers = 0;
+
+	/* PAGE_PLUS accesses leave the selected page untouched */
+	TEST_ASSERT_EQUAL_INT(0, pmbus_read_word(dev, 4, PMBUS_READ_IOUT,
+			      &word));
+	TEST_ASSERT_EQUAL_HEX16(0x0400 | PMBUS_READ_IOUT, word);
+	TEST_ASSERT_EQUAL_INT(0, pmbus_write_word(dev, 5, PMBUS_VOUT_COMMAND,
+			      0x1234));
+	TEST_ASSERT_EQUAL_HEX16(0x1234, regs[5][PMBUS_VOUT_COMMAND]);
+	TEST_ASSERT_EQUAL_UINT32(2, nb_xfers);
+	TEST_ASSERT_EQUAL_INT(0, dev->page);
+	TEST_ASSERT_EQUAL_UINT8(0, dev_page);
+	TEST_ASSERT_EQUAL_UINT32(0, bad_writes);
+
+	corrupt_xfer = nb_xfers + 1;
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, pmbus_read_word(dev, 3,
+			      PMBUS_READ_IOUT, &word));
+	TEST_ASSERT_EQUAL_UINT32(1, dev->pec_errors);
+}
+
+void test_pmbus_scan(void)
+{
+	const uint8_t pages[] = {0, 1, 2, 3, 4, 5};
+	const uint8_t cmds[] = {
+		PMBUS_READ_VIN, PMBUS_READ_VOUT, PMBUS_READ_IOUT,
+		PMBUS_READ_TEMPERATURE_1
+	};
+	struct pmbus_scan scan = {
+		.pages = pages,
+		.nb_pages = NO_OS_ARRAY_SIZE(pages),
+		.cmds = cmds,
+		.nb_cmds = NO_OS_ARRAY_SIZE(cmds),
+	};
+	uint16_t raw[NO_OS_ARRAY_SIZE(pages) * NO_OS_ARRAY_SIZE(cmds)];
+	uint32_t i;
+
+	fill_regs();
+
+	/* One PAGE write and one chain of four reads per page */
+	TEST_ASSERT_EQUAL_INT(0, pmbus_scan(dev, &scan, raw));
+	TEST_ASSERT_EQUAL_UINT32(12, nb_xfers);
+	for (i = 0; i < NO_OS_ARRAY_SIZE(raw); i++)
+		TEST_ASSERT_EQUAL_HEX16(pages[i / 4] << 8 | cmds[i % 4],
+					raw[i]);
+
+	/* Chains cross pages with PAGE_PLUS_READ */
+	dev->page_plus = true;
+	nb_xfers = 0;
+	memset(raw, 0, sizeof(raw));
+	TEST_ASSERT_EQUAL_INT(0, pmbus_scan(dev, &scan, raw));
+	TEST_ASSERT_EQUAL_UINT32(6, nb_xfers);
+	for (i = 0; i < NO_OS_ARRAY_SIZE(raw); i++)
+		TEST_ASSERT_EQUAL_HEX16(pages[i / 4] << 8 | cmds[i % 4],
+					raw[i]);
+
+	/*
+	 * The scan starts on the cached page 5, so the second transfer reads
+	 * page 0. A bad PEC only drops the responses of that transfer.
+	 */
+	corrupt_xfer = nb_xfers + 2;
+	memset(raw, 0, sizeof(raw));
+	TEST_ASSERT_EQUAL_INT(-EBADMSG, pmbus_scan(dev, &scan, raw));
+	TEST_ASSERT_EQUAL_UINT32(4, dev->pec_errors);
+	for (i = 0; i < NO_OS_ARRAY_SIZE(raw); i++)
+		TEST_ASSERT_EQUAL_HEX16(i / 4 == 0 ? 0 :
+					pages[i / 4] << 8 | cmds[i % 4],
+					raw[i]);
+}
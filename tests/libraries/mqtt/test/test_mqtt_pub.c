@@ -0,0 +1,603 @@
+/***************************************************************************//**
+ *   @file   test_mqtt_pub.c
+ *   @brief  Tests of the MQTT batched publish queue.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "mqtt_pub.h"
+#include "tcp_socket.h"
+#include "linux_socket.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define TEST_STREAM_SIZE	65536
+#define TEST_TIMEOUT_MS		1000
+
+/* One PUBLISH as seen by the broker */
+struct test_publish {
+	uint8_t flags;
+	uint16_t id;
+	char topic[32];
+	uint8_t payload[2048];
+	uint32_t len;
+};
+
+static int listen_fd = -1;
+static int broker_fd = -1;
+static uint16_t broker_port;
+static struct tcp_socket_desc *sock;
+static struct mqtt_pub_desc *pub;
+static uint8_t stream[TEST_STREAM_SIZE];
+static uint32_t stream_len;
+static struct test_publish pkt;
+
+/*******************************************************************************
+ *    HELPER FUNCTIONS
+ ******************************************************************************/
+
+/* Read what the client sent, return 0 if nothing came within the timeout */
+static uint32_t broker_fill(int timeout_ms)
+{
+	struct pollfd pfd = {.fd = broker_fd, .events = POLLIN};
+	ssize_t ret;
+
+	if (poll(&pfd, 1, timeout_ms) <= 0)
+		return 0;
+
+	ret = recv(broker_fd, &stream[stream_len], sizeof(stream) - stream_len,
+		   MSG_DONTWAIT);
+	if (ret <= 0)
+		return 0;
+
+	stream_len += ret;
+
+	return ret;
+}
+
+/* Take one complete PUBLISH out of the received stream */
+static int broker_parse(struct test_publish *p)
+{
+	uint32_t rem = 0, shift = 0, i = 1, hdr, total, tlen;
+
+	do {
+		if (i >= stream_len)
+			return -1;
+		rem |= (stream[i] & 0x7f) << shift;
+		shift += 7;
+	} while (stream[i++] & 0x80);
+
+	total = i + rem;
+	if (stream_len < total)
+		return -1;
+
+	TEST_ASSERT_EQUAL_HEX8(0x30, stream[0] & 0xf0);
+	p->flags = stream[0] & 0x0f;
+	tlen = no_os_get_unaligned_be16(&stream[i]);
+	TEST_ASSERT_LESS_THAN(sizeof(p->topic), tlen);
+	memcpy(p->topic, &stream[i + 2], tlen);
+	p->topic[tlen] = '\0';
+	hdr = i + 2 + tlen;
+	p->id = 0;
+	if (p->flags & 0x06) {
+		p->id = no_os_get_unaligned_be16(&stream[hdr]);
+		hdr += 2;
+	}
+	p->len = total - hdr;
+	TEST_ASSERT_LESS_OR_EQUAL(sizeof(p->payload), p->len);
+	memcpy(p->payload, &stream[hdr], p->len);
+
+	stream_len -= total;
+	memmove(stream, &stream[total], stream_len);
+
+	return 0;
+}
+
+static int broker_recv(struct test_publish *p, int timeout_ms)
+{
+	while (broker_parse(p))
+		if (!broker_fill(timeout_ms))
+			return -1;
+
+	return 0;
+}
+
+static void broker_send(const uint8_t *data, uint32_t len)
+{
+	TEST_ASSERT_EQUAL_INT(len, send(broker_fd, data, len, 0));
+}
+
+static void broker_puback(uint16_t id)
+{
+	uint8_t ack[4] = {0x40, 0x02, id >> 8, id & 0xff};
+
+	broker_send(ack, sizeof(ack));
+}
+
+/* Acks are read by the next poll, give the loopback time to deliver them */
+static void settle(void)
+{
+	usleep(10000);
+}
+
+static void init_pub(const struct mqtt_pub_topic *topics, uint32_t nb_topics,
+		     uint32_t nb_slots, uint32_t slot_size, uint32_t window)
+{
+	struct mqtt_pub_init_param param = {
+		.sock = sock,
+		.topics = topics,
+		.nb_topics = nb_topics,
+		.nb_slots = nb_slots,
+		.slot_size = slot_size,
+		.window = window,
+		.retry_ms = 100,
+		.read_socket = true,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_init(&pub, &param));
+}
+
+static uint32_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct sockaddr_in saddr = {
+		.sin_family = AF_INET,
+		.sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+	};
+	struct tcp_socket_init_param sock_param = {.net = &linux_net};
+	struct socket_address addr = {.addr = "127.0.0.1"};
+	socklen_t len = sizeof(saddr);
+	int one = 1;
+	int32_t ret;
+
+	listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+	TEST_ASSERT_GREATER_OR_EQUAL(0, listen_fd);
+	TEST_ASSERT_EQUAL_INT(0, bind(listen_fd, (struct sockaddr *)&saddr,
+				      sizeof(saddr)));
+	TEST_ASSERT_EQUAL_INT(0, listen(listen_fd, 1));
+	TEST_ASSERT_EQUAL_INT(0, getsockname(listen_fd,
+					     (struct sockaddr *)&saddr, &len));
+	broker_port = ntohs(saddr.sin_port);
+
+	TEST_ASSERT_EQUAL_INT(0, socket_init(&sock, &sock_param));
+	addr.port = broker_port;
+	ret = socket_connect(sock, &addr);
+	TEST_ASSERT_TRUE(!ret || ret == -EINPROGRESS);
+
+	broker_fd = accept(listen_fd, NULL, NULL);
+	TEST_ASSERT_GREATER_OR_EQUAL(0, broker_fd);
+	/* Small packets must not wait for the delayed ACK of the previous */
+	setsockopt(broker_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+	setsockopt(sock->id, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	stream_len = 0;
+	pub = NULL;
+}
+
+void tearDown(void)
+{
+	if (pub)
+		mqtt_pub_remove(pub);
+	socket_remove(sock);
+	close(broker_fd);
+	close(listen_fd);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_mqtt_pub_init_invalid(void)
+{
+	struct mqtt_pub_topic topic = {
+		.name = "t",
+		.qos = MQTT_QOS1,
+		.format = MQTT_PUB_FORMAT_CBOR,
+		.sample_size = 8,
+	};
+	struct mqtt_pub_init_param param = {
+		.sock = sock,
+		.topics = &topic,
+		.nb_topics = 1,
+		.nb_slots = 4,
+		.slot_size = 256,
+		.window = 1,
+	};
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_init(NULL, &param));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_init(&pub, NULL));
+
+	param.sock = NULL;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_init(&pub, &param));
+	param.sock = sock;
+
+	/* QoS1 needs a window */
+	param.window = 0;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_init(&pub, &param));
+	param.window = 1;
+
+	/* CBOR samples are int32_t values */
+	topic.sample_size = 6;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_init(&pub, &param));
+	topic.sample_size = 8;
+
+	/* Headers and one sample must fit a slot */
+	param.slot_size = 16;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_init(&pub, &param));
+	param.slot_size = 256;
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_init(&pub, &param));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, mqtt_pub_enqueue(pub, 1, &param));
+}
+
+void test_mqtt_pub_coalesce(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "meter/raw",
+		.qos = MQTT_QOS0,
+		.format = MQTT_PUB_FORMAT_RAW,
+		.sample_size = 8,
+		.flush_samples = 10,
+	};
+	struct mqtt_pub_stats stats;
+	int32_t sample[2];
+	int32_t val[2];
+	uint32_t i, j, n = 0;
+
+	init_pub(&topic, 1, 4, 256, 0);
+
+	for (i = 0; i < 25; i++) {
+		sample[0] = i;
+		sample[1] = -i;
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_enqueue(pub, 0, sample));
+	}
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+
+	/* Two full publishes, the last 5 samples are still pending */
+	for (i = 0; i < 2; i++) {
+		TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+		TEST_ASSERT_EQUAL_HEX8(0, pkt.flags);
+		TEST_ASSERT_EQUAL_STRING("meter/raw", pkt.topic);
+		TEST_ASSERT_EQUAL_UINT32(80, pkt.len);
+		for (j = 0; j < 10; j++, n++) {
+			memcpy(val, &pkt.payload[j * 8], sizeof(val));
+			TEST_ASSERT_EQUAL_INT32(n, val[0]);
+			TEST_ASSERT_EQUAL_INT32(-(int32_t)n, val[1]);
+		}
+	}
+	TEST_ASSERT_EQUAL_INT(-1, broker_recv(&pkt, 20));
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_flush(pub));
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+	TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(40, pkt.len);
+	memcpy(val, pkt.payload, sizeof(val));
+	TEST_ASSERT_EQUAL_INT32(20, val[0]);
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_stats_get(pub, &stats));
+	TEST_ASSERT_EQUAL_UINT32(25, stats.samples);
+	TEST_ASSERT_EQUAL_UINT32(3, stats.packets);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
+
+void test_mqtt_pub_flush_interval(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "meter/slow",
+		.qos = MQTT_QOS0,
+		.format = MQTT_PUB_FORMAT_RAW,
+		.sample_size = 4,
+		.flush_ms = 10,
+	};
+	uint32_t sample = 0x11223344;
+	uint32_t i;
+
+	init_pub(&topic, 1, 4, 256, 0);
+
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_enqueue(pub, 0, &sample));
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 1000));
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 1009));
+	TEST_ASSERT_EQUAL_INT(-1, broker_recv(&pkt, 20));
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 1010));
+	TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(12, pkt.len);
+}
+
+void test_mqtt_pub_cbor(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "c",
+		.qos = MQTT_QOS0,
+		.format = MQTT_PUB_FORMAT_CBOR,
+		.sample_size = 8,
+		.flush_samples = 3,
+	};
+	const int32_t samples[3][2] = {{0, 23}, {24, -1}, {-500, 70000}};
+	const uint8_t expected[] = {
+		0x86, 0x00, 0x17, 0x18, 0x18, 0x20, 0x39, 0x01, 0xf3,
+		0x1a, 0x00, 0x01, 0x11, 0x70
+	};
+	uint32_t i;
+
+	init_pub(&topic, 1, 2, 128, 0);
+
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_enqueue(pub, 0, samples[i]));
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+
+	TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_UINT32(sizeof(expected), pkt.len);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, pkt.payload, sizeof(expected));
+}
+
+void test_mqtt_pub_qos1_window(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "meter/q1",
+		.qos = MQTT_QOS1,
+		.format = MQTT_PUB_FORMAT_RAW,
+		.sample_size = 4,
+		.flush_samples = 1,
+	};
+	/* Packets the acks must be told apart from */
+	const uint8_t noise[] = {
+		0xd0, 0x00,
+		0x30, 0x05, 0x00, 0x01, 'x', 0x40, 0x02
+	};
+	struct mqtt_pub_stats stats;
+	uint32_t i;
+
+	init_pub(&topic, 1, 4, 64, 2);
+
+	for (i = 0; i < 4; i++)
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_enqueue(pub, 0, &i));
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+
+	/* Only the window is sent */
+	for (i = 0; i < 2; i++) {
+		TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+		TEST_ASSERT_EQUAL_HEX8(0x02, pkt.flags);
+		TEST_ASSERT_EQUAL_HEX16(MQTT_PUB_ID_FIRST + i, pkt.id);
+	}
+	TEST_ASSERT_EQUAL_INT(-1, broker_recv(&pkt, 20));
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_stats_get(pub, &stats));
+	TEST_ASSERT_EQUAL_UINT32(2, stats.inflight);
+
+	broker_send(noise, sizeof(noise));
+	broker_puback(MQTT_PUB_ID_FIRST);
+	settle();
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 1));
+	TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_HEX16(MQTT_PUB_ID_FIRST + 2, pkt.id);
+
+	/* Not acked within retry_ms, both are sent again with DUP */
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 200));
+	for (i = 1; i < 3; i++) {
+		TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+		TEST_ASSERT_EQUAL_HEX8(0x0a, pkt.flags);
+		TEST_ASSERT_EQUAL_HEX16(MQTT_PUB_ID_FIRST + i, pkt.id);
+	}
+	TEST_ASSERT_EQUAL_INT(-1, broker_recv(&pkt, 20));
+
+	broker_puback(MQTT_PUB_ID_FIRST + 1);
+	broker_puback(MQTT_PUB_ID_FIRST + 2);
+	settle();
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 201));
+	TEST_ASSERT_EQUAL_INT(0, broker_recv(&pkt, TEST_TIMEOUT_MS));
+	TEST_ASSERT_EQUAL_HEX8(0x02, pkt.flags);
+	TEST_ASSERT_EQUAL_HEX16(MQTT_PUB_ID_FIRST + 3, pkt.id);
+
+	broker_puback(MQTT_PUB_ID_FIRST + 3);
+	settle();
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 202));
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_stats_get(pub, &stats));
+	TEST_ASSERT_EQUAL_UINT32(0, stats.inflight);
+	TEST_ASSERT_EQUAL_UINT32(4, stats.acked);
+	TEST_ASSERT_EQUAL_UINT32(2, stats.retries);
+	TEST_ASSERT_EQUAL_UINT32(6, stats.packets);
+}
+
+void test_mqtt_pub_backpressure(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "meter/bulk",
+		.qos = MQTT_QOS0,
+		.format = MQTT_PUB_FORMAT_RAW,
+		.sample_size = 16,
+	};
+	struct mqtt_pub_stats stats;
+	uint32_t sample[4] = {0};
+	uint32_t received = 0;
+	uint32_t start;
+	int32_t ret;
+	int size = 4096;
+
+	setsockopt(sock->id, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	setsockopt(broker_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	init_pub(&topic, 1, 8, 1024, 0);
+
+	/* The broker does not read, enqueue and poll must still return */
+	start = now_ms();
+	for (sample[0] = 0; sample[0] < 100000; sample[0]++) {
+		ret = mqtt_pub_enqueue(pub, 0, sample);
+		TEST_ASSERT_TRUE(!ret || ret == -ENOSPC);
+		if (!(sample[0] % 64))
+			TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+	}
+	TEST_ASSERT_LESS_THAN(TEST_TIMEOUT_MS, now_ms() - start);
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_stats_get(pub, &stats));
+	TEST_ASSERT_GREATER_THAN(0, stats.blocked);
+	TEST_ASSERT_GREATER_THAN(0, stats.dropped);
+	TEST_ASSERT_EQUAL_UINT32(100000, stats.samples + stats.dropped);
+
+	/* Everything accepted is delivered once the broker reads again */
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_flush(pub));
+	do {
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+		while (!broker_recv(&pkt, 10)) {
+			TEST_ASSERT_EQUAL_UINT32(0, pkt.len % 16);
+			received += pkt.len / 16;
+		}
+	} while (received < stats.samples);
+
+	TEST_ASSERT_EQUAL_UINT32(stats.samples, received);
+}
+
+void test_mqtt_pub_resume(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "meter/bulk",
+		.qos = MQTT_QOS0,
+		.format = MQTT_PUB_FORMAT_RAW,
+		.sample_size = 16,
+	};
+	const uint8_t pingreq[] = {0xc0, 0x00};
+	struct mqtt_pub_stats stats;
+	uint32_t sample[4] = {0};
+	int32_t ret;
+	int size = 4096;
+
+	setsockopt(sock->id, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+	setsockopt(broker_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+	init_pub(&topic, 1, 8, 1024, 0);
+
+	/* Fill the socket until a publish is only partially written */
+	do {
+		mqtt_pub_enqueue(pub, 0, sample);
+		sample[0]++;
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_stats_get(pub, &stats));
+	} while (!stats.blocked);
+
+	/* What the MQTT client does before writing a PINGREQ */
+	while ((ret = mqtt_pub_resume(pub)) == -EAGAIN) {
+		broker_fill(10);
+		while (!broker_parse(&pkt))
+			TEST_ASSERT_EQUAL_UINT32(0, pkt.len % 16);
+	}
+	TEST_ASSERT_EQUAL_INT(0, ret);
+	while ((ret = socket_send(sock, pingreq, sizeof(pingreq))) == -EAGAIN) {
+		broker_fill(10);
+		while (stream[0] == 0x30 && !broker_parse(&pkt))
+			TEST_ASSERT_EQUAL_UINT32(0, pkt.len % 16);
+	}
+	TEST_ASSERT_EQUAL_INT(sizeof(pingreq), ret);
+
+	/* The PINGREQ follows the last complete publish */
+	while (broker_fill(50))
+		while (stream[0] == 0x30 && !broker_parse(&pkt))
+			TEST_ASSERT_EQUAL_UINT32(0, pkt.len % 16);
+	TEST_ASSERT_EQUAL_UINT32(sizeof(pingreq), stream_len);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(pingreq, stream, sizeof(pingreq));
+}
+
+void test_mqtt_pub_throughput(void)
+{
+	const struct mqtt_pub_topic topic = {
+		.name = "meter/rate",
+		.qos = MQTT_QOS0,
+		.format = MQTT_PUB_FORMAT_RAW,
+		.sample_size = 8,
+		.flush_samples = 64,
+	};
+	struct mqtt_pub_stats stats;
+	uint32_t sample[2] = {0};
+	uint32_t received = 0;
+	uint32_t start, elapsed;
+	int32_t ret;
+
+	init_pub(&topic, 1, 16, 1024, 0);
+
+	start = now_ms();
+	for (sample[0] = 0; sample[0] < 200000; sample[0]++) {
+		do {
+			ret = mqtt_pub_enqueue(pub, 0, sample);
+			if (ret == -ENOSPC) {
+				TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+				while (!broker_recv(&pkt, 0))
+					received += pkt.len / 8;
+			}
+		} while (ret == -ENOSPC);
+		TEST_ASSERT_EQUAL_INT(0, ret);
+	}
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_flush(pub));
+	while (received < 200000) {
+		TEST_ASSERT_EQUAL_INT(0, mqtt_pub_poll(pub, 0));
+		while (!broker_recv(&pkt, 10))
+			received += pkt.len / 8;
+	}
+	elapsed = no_os_max(now_ms() - start, 1u);
+
+	TEST_ASSERT_EQUAL_INT(0, mqtt_pub_stats_get(pub, &stats));
+	TEST_ASSERT_EQUAL_UINT32(200000, received);
+	TEST_ASSERT_EQUAL_UINT32(200000, stats.samples);
+	printf("mqtt_pub: %u samples/s, %u publishes\n",
+	       200000u * 1000 / elapsed, stats.packets);
+}
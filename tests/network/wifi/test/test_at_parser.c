@@ -0,0 +1,249 @@
+/***************************************************************************//**
+ *   @file   test_at_parser.c
+ *   @brief  Tests of the chunked AT parser receive path.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "at_parser.h"
+#include "no_os_lf_ring.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include "mock_no_os_uart.h"
+#include "mock_no_os_irq.h"
+#include "mock_no_os_delay.h"
+#include <stdio.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Small, so the data wraps around and is parsed in several chunks */
+#define TEST_RING_SIZE	64
+
+/* Answer the module gives to a command */
+struct test_reply {
+	const char *cmd;
+	const char *reply;
+};
+
+static const struct test_reply replies[] = {
+	{"ATE0\r\n", "ATE0\r\n\r\nOK\r\n"},
+	{"AT\r\n", "\r\nOK\r\n"},
+	{"AT+CIPMUX?\r\n", "+CIPMUX:1\r\n\r\nOK\r\n"},
+	{
+		"AT+GMR\r\n",
+		"AT version:1.7\r\nWIFI DISCONNECT\r\n2,CLOSED\r\n\r\nOK\r\n"
+	},
+	{"AT+CIPSEND=0,5\r\n", "\r\nOK\r\n> "},
+	{"hello", "\r\nRecv 5 bytes\r\n\r\n+IPD,0,3:abc\r\nSEND OK\r\n"},
+	{NULL, NULL}
+};
+
+static struct no_os_uart_desc uart;
+static struct no_os_lf_ring *ring;
+static struct at_desc *at;
+static struct no_os_circular_buffer *conn_cb[MAX_CONNECTIONS];
+static uint32_t opened;
+static uint32_t closed;
+
+/*******************************************************************************
+ *    HELPER FUNCTIONS
+ ******************************************************************************/
+
+/* The parser formats numbers with the non standard itoa() */
+char *itoa(int value, char *str, int base)
+{
+	NO_OS_UNUSED_PARAM(base);
+	sprintf(str, "%d", value);
+
+	return str;
+}
+
+/* Data received from the module, as an idle line UART handler would store it */
+static void feed(const char *data, uint32_t len)
+{
+	TEST_ASSERT_EQUAL_UINT32(len, no_os_lf_ring_write_n(ring, data, len));
+}
+
+static int32_t uart_write_stub(struct no_os_uart_desc *desc,
+			       const uint8_t *data, uint32_t len,
+			       int cmock_num_calls)
+{
+	const struct test_reply *r;
+
+	for (r = replies; r->cmd; r++)
+		if (strlen(r->cmd) == len && !memcmp(r->cmd, data, len)) {
+			feed(r->reply, strlen(r->reply));
+			return len;
+		}
+
+	TEST_FAIL_MESSAGE("Unexpected command");
+
+	return -1;
+}
+
+static void conn_callback(void *ctx, enum at_event event, uint32_t conn_id,
+			  struct no_os_circular_buffer **cb)
+{
+	if (event == AT_NEW_CONNECTION) {
+		*cb = conn_cb[conn_id];
+		opened |= NO_OS_BIT(conn_id);
+	} else {
+		closed |= NO_OS_BIT(conn_id);
+	}
+}
+
+static void check_conn(uint32_t id, const char *expected)
+{
+	char data[32] = {0};
+	uint32_t size;
+
+	no_os_cb_size(conn_cb[id], &size);
+	TEST_ASSERT_EQUAL_UINT32(strlen(expected), size);
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(conn_cb[id], data, size));
+	TEST_ASSERT_EQUAL_STRING(expected, data);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct at_init_param param = {
+		.uart_desc = &uart,
+		.connection_callback = conn_callback,
+		.rx_ring = NULL,
+	};
+	uint32_t i;
+
+	no_os_mdelay_Ignore();
+	no_os_uart_write_StubWithCallback(uart_write_stub);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&ring, TEST_RING_SIZE, 1));
+	for (i = 0; i < MAX_CONNECTIONS; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_init(&conn_cb[i], 64));
+	opened = 0;
+	closed = 0;
+
+	param.rx_ring = ring;
+	TEST_ASSERT_EQUAL_INT(0, at_init(&at, &param));
+}
+
+void tearDown(void)
+{
+	uint32_t i;
+
+	at_remove(at);
+	for (i = 0; i < MAX_CONNECTIONS; i++)
+		no_os_cb_remove(conn_cb[i]);
+	no_os_lf_ring_remove(ring);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_at_ipd_split(void)
+{
+	const char msg[] = "\r\n+IPD,1,10:0123456789";
+	union in_out_param param;
+	uint32_t len = strlen(msg);
+	uint32_t i;
+
+	/* The header and the payload may end up in any chunk */
+	for (i = 1; i < len; i++) {
+		feed(msg, i);
+		TEST_ASSERT_EQUAL_INT(0, at_poll(at));
+		feed(&msg[i], len - i);
+		TEST_ASSERT_EQUAL_INT(0, at_poll(at));
+		check_conn(1, "0123456789");
+	}
+	TEST_ASSERT_EQUAL_HEX32(NO_OS_BIT(1), opened);
+
+	/* Nothing of the header is left in the command response */
+	TEST_ASSERT_EQUAL_INT(0, at_run_cmd(at, AT_ATTENTION, AT_EXECUTE_OP,
+					    &param));
+	TEST_ASSERT_EQUAL_UINT32(0, param.out.result.len);
+}
+
+void test_at_ipd_bad_header(void)
+{
+	const char msg[] = "+IPD,9,3:abc\r\n+IPDX:\r\n";
+	union in_out_param param;
+
+	/* Not a valid header, handled as text */
+	feed(msg, strlen(msg));
+	TEST_ASSERT_EQUAL_INT(0, at_poll(at));
+	TEST_ASSERT_EQUAL_HEX32(0, opened);
+
+	TEST_ASSERT_EQUAL_INT(0, at_run_cmd(at, AT_ATTENTION, AT_EXECUTE_OP,
+					    &param));
+	TEST_ASSERT_EQUAL_UINT32(strlen(msg), param.out.result.len);
+	TEST_ASSERT_EQUAL_INT(0, memcmp(msg, param.out.result.buff,
+					strlen(msg)));
+}
+
+void test_at_async_messages(void)
+{
+	union in_out_param param;
+
+	TEST_ASSERT_EQUAL_INT(0, at_run_cmd(at, AT_GET_VERSION, AT_EXECUTE_OP,
+					    &param));
+	TEST_ASSERT_EQUAL_UINT32(16, param.out.result.len);
+	TEST_ASSERT_EQUAL_INT(0, memcmp("AT version:1.7\r\n",
+					param.out.result.buff, 16));
+	TEST_ASSERT_EQUAL_HEX32(NO_OS_BIT(2), closed);
+}
+
+void test_at_send_prompt(void)
+{
+	union in_out_param param = {0};
+
+	param.in.send_data.id = 0;
+	str_to_at(&param.in.send_data.data, (const uint8_t *)"hello");
+
+	/* Payload received while waiting for SEND OK */
+	TEST_ASSERT_EQUAL_INT(0, at_run_cmd(at, AT_SEND, AT_SET_OP, &param));
+	check_conn(0, "abc");
+}
@@ -0,0 +1,320 @@
+/***************************************************************************//**
+ *   @file   test_no_os_adc_stream.c
+ *   @brief  Unit tests of the sigma-delta ADC streaming engine.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_adc_stream.h"
+#include "no_os_circular_buffer.h"
+#include "no_os_alloc.h"
+#include "mock_no_os_spi.h"
+#include "mock_no_os_irq.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define TEST_CMD	0x42
+#define TEST_BLOCK	4
+/* Command, 16 bit big endian counter, error flag */
+#define TEST_FRAME	4
+/* Every TEST_BAD_EVERY th frame has the error flag set */
+#define TEST_BAD_EVERY	5
+
+static struct no_os_spi_desc spi;
+static struct no_os_irq_ctrl_desc irq;
+static struct no_os_circular_buffer *sink;
+static struct no_os_adc_stream_desc *stream;
+static uint16_t counter;
+static uint32_t cmd_errors;
+
+static int32_t test_decode(void *dev, const uint8_t *frames,
+			   uint8_t frame_size, uint32_t nb_frames,
+			   uint32_t *samples)
+{
+	uint32_t n, nb = 0;
+
+	for (n = 0; n < nb_frames; n++, frames += frame_size) {
+		if (frames[3])
+			continue;
+		samples[nb++] = (frames[1] << 8) | frames[2];
+	}
+
+	return nb;
+}
+
+/* Emulate the converter: check the command and return the next conversion */
+static void fill_frame(struct no_os_spi_msg *msg)
+{
+	uint8_t *buf = msg->rx_buff;
+
+	if (msg->bytes_number != TEST_FRAME || buf[0] != TEST_CMD ||
+	    msg->tx_buff != msg->rx_buff)
+		cmd_errors++;
+
+	buf[0] = 0xff;
+	buf[1] = counter >> 8;
+	buf[2] = counter & 0xff;
+	buf[3] = (counter % TEST_BAD_EVERY) == TEST_BAD_EVERY - 1;
+	counter++;
+}
+
+static int32_t spi_transfer_cb(struct no_os_spi_desc *desc,
+			       struct no_os_spi_msg *msgs, uint32_t len,
+			       int cmock_num_calls)
+{
+	fill_frame(msgs);
+
+	return 0;
+}
+
+static int spi_dma_cb(struct no_os_spi_desc *desc, struct no_os_spi_msg *msgs,
+		      uint32_t len, void (*callback)(void *), void *ctx,
+		      int cmock_num_calls)
+{
+	/* The transfer completes right away */
+	fill_frame(msgs);
+	callback(ctx);
+
+	return 0;
+}
+
+static void init_stream(bool dma)
+{
+	struct no_os_adc_stream_init_param param = {
+		.spi_desc = &spi,
+		.irq_ctrl = &irq,
+		.drdy_irq = 3,
+		.drdy_trig = NO_OS_IRQ_EDGE_FALLING,
+		.cmd = {TEST_CMD},
+		.cmd_size = 1,
+		.frame_size = TEST_FRAME,
+		.block_size = TEST_BLOCK,
+		.dma = dma,
+		.decode = test_decode,
+		.sink = sink,
+	};
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_init(&stream, &param));
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_start(stream));
+}
+
+static void drdy(uint32_t nb)
+{
+	while (nb--)
+		stream->irq_cb.callback(stream->irq_cb.ctx);
+}
+
+/* Check the next samples of the sink against the emulated counter */
+static uint32_t check_sink(uint16_t *expected, uint32_t nb)
+{
+	uint32_t sample, n;
+
+	for (n = 0; n < nb; n++, (*expected)++) {
+		if ((*expected % TEST_BAD_EVERY) == TEST_BAD_EVERY - 1)
+			(*expected)++;
+		TEST_ASSERT_EQUAL_INT(0, no_os_cb_read(sink, &sample,
+						       sizeof(sample)));
+		TEST_ASSERT_EQUAL_UINT32(*expected, sample);
+	}
+
+	return n;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	no_os_irq_register_callback_IgnoreAndReturn(0);
+	no_os_irq_unregister_callback_IgnoreAndReturn(0);
+	no_os_irq_trigger_level_set_IgnoreAndReturn(0);
+	no_os_irq_enable_IgnoreAndReturn(0);
+	no_os_irq_disable_IgnoreAndReturn(0);
+	no_os_spi_transfer_StubWithCallback(spi_transfer_cb);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_cb_init(&sink, 256));
+	stream = NULL;
+	counter = 0;
+	cmd_errors = 0;
+}
+
+void tearDown(void)
+{
+	if (stream)
+		no_os_adc_stream_remove(stream);
+	no_os_cb_remove(sink);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_adc_stream_init_invalid(void)
+{
+	struct no_os_adc_stream_init_param param = {
+		.spi_desc = &spi,
+		.irq_ctrl = &irq,
+		.cmd_size = 1,
+		.frame_size = TEST_FRAME,
+		.block_size = TEST_BLOCK,
+		.decode = test_decode,
+		.sink = sink,
+	};
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_adc_stream_init(NULL, &param));
+
+	param.frame_size = 1;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_adc_stream_init(&stream, &param));
+	param.frame_size = NO_OS_ADC_STREAM_FRAME_MAX + 1;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_adc_stream_init(&stream, &param));
+	param.frame_size = TEST_FRAME;
+
+	param.block_size = 0;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_adc_stream_init(&stream, &param));
+	param.block_size = TEST_BLOCK;
+
+	param.decode = NULL;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_adc_stream_init(&stream, &param));
+	TEST_ASSERT_NULL(stream);
+}
+
+void test_adc_stream_blocks(void)
+{
+	struct no_os_adc_stream_stats stats;
+	uint16_t expected = 0;
+
+	init_stream(false);
+
+	/* Nothing is pushed until a block is complete */
+	drdy(TEST_BLOCK - 1);
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_process(stream));
+
+	drdy(TEST_BLOCK + 1);
+	TEST_ASSERT_EQUAL_INT(2, no_os_adc_stream_process(stream));
+	TEST_ASSERT_EQUAL_INT(0, cmd_errors);
+
+	/* Frames 0..7, frame 4 has the error flag set */
+	check_sink(&expected, 2 * TEST_BLOCK - 1);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_stats_get(stream, &stats,
+			      true));
+	TEST_ASSERT_EQUAL_UINT32(2 * TEST_BLOCK, stats.frames);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.invalid);
+	TEST_ASSERT_EQUAL_UINT32(2, stats.blocks);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+
+	/* The blocks keep alternating between the two halves, frames 8..15 */
+	drdy(2 * TEST_BLOCK);
+	TEST_ASSERT_EQUAL_INT(2, no_os_adc_stream_process(stream));
+	check_sink(&expected, 2 * TEST_BLOCK - 2);
+}
+
+void test_adc_stream_overrun(void)
+{
+	struct no_os_adc_stream_stats stats;
+	uint16_t expected = 0;
+
+	init_stream(false);
+
+	/* Both halves are full, the third block of conversions is skipped */
+	drdy(3 * TEST_BLOCK);
+	no_os_adc_stream_stats_get(stream, &stats, false);
+	TEST_ASSERT_EQUAL_UINT32(2 * TEST_BLOCK, stats.frames);
+	TEST_ASSERT_EQUAL_UINT32(TEST_BLOCK, stats.dropped);
+
+	TEST_ASSERT_EQUAL_INT(2, no_os_adc_stream_process(stream));
+	check_sink(&expected, 2 * TEST_BLOCK - 1);
+
+	/* Streaming resumes in order once the halves are free */
+	drdy(TEST_BLOCK);
+	TEST_ASSERT_EQUAL_INT(1, no_os_adc_stream_process(stream));
+	check_sink(&expected, TEST_BLOCK - 1);
+}
+
+void test_adc_stream_dma(void)
+{
+	struct no_os_adc_stream_stats stats;
+	uint16_t expected = 0;
+
+	no_os_spi_transfer_dma_async_StubWithCallback(spi_dma_cb);
+	init_stream(true);
+
+	drdy(2 * TEST_BLOCK);
+	TEST_ASSERT_EQUAL_INT(2, no_os_adc_stream_process(stream));
+	TEST_ASSERT_EQUAL_INT(0, cmd_errors);
+	check_sink(&expected, 2 * TEST_BLOCK - 1);
+
+	no_os_adc_stream_stats_get(stream, &stats, false);
+	TEST_ASSERT_EQUAL_UINT32(2 * TEST_BLOCK, stats.frames);
+}
+
+void test_adc_stream_dma_fallback(void)
+{
+	uint16_t expected = 0;
+
+	no_os_spi_transfer_dma_async_IgnoreAndReturn(-ENOSYS);
+	init_stream(true);
+
+	drdy(TEST_BLOCK);
+	TEST_ASSERT_FALSE(stream->dma);
+	TEST_ASSERT_EQUAL_INT(1, no_os_adc_stream_process(stream));
+	check_sink(&expected, TEST_BLOCK);
+}
+
+void test_adc_stream_stop(void)
+{
+	init_stream(false);
+
+	drdy(TEST_BLOCK + 2);
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_stop(stream));
+	TEST_ASSERT_FALSE(stream->running);
+
+	/* Completed blocks are still available after stop */
+	TEST_ASSERT_EQUAL_INT(1, no_os_adc_stream_process(stream));
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_process(stream));
+
+	/* Restarting drops the partial block */
+	TEST_ASSERT_EQUAL_INT(0, no_os_adc_stream_start(stream));
+	TEST_ASSERT_EQUAL_UINT32(0, stream->fill);
+}
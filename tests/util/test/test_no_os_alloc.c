@@ -0,0 +1,415 @@
+/***************************************************************************//**
+ *   @file   test_no_os_alloc.c
+ *   @brief  Unit tests of the pool and arena allocator.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define ARENA_SIZE	256
+
+static uint64_t mem[1024];
+
+static const struct no_os_alloc_pool_param pools[] = {
+	{.block_size = 16, .nb_blocks = 8},
+	{.block_size = 64, .nb_blocks = 4},
+	{.block_size = 256, .nb_blocks = 2},
+};
+
+/* 16 * 8 + 64 * 4 + 256 * 2 */
+#define POOLS_SIZE	896
+
+static const struct no_os_alloc_init_param init_param = {
+	.mem = mem,
+	.mem_size = POOLS_SIZE + ARENA_SIZE,
+	.pools = pools,
+	.nb_pools = NO_OS_ARRAY_SIZE(pools),
+};
+
+static uint32_t lock_depth;
+static uint32_t nb_locks;
+
+static void lock(void *ctx)
+{
+	TEST_ASSERT_TRUE(ctx == &lock_depth);
+	TEST_ASSERT_EQUAL_UINT32(0, lock_depth);
+	lock_depth++;
+	nb_locks++;
+}
+
+static void unlock(void *ctx)
+{
+	TEST_ASSERT_TRUE(ctx == &lock_depth);
+	TEST_ASSERT_EQUAL_UINT32(1, lock_depth);
+	lock_depth--;
+}
+
+static size_t seal_failure_size;
+
+static void seal_failure(size_t size)
+{
+	seal_failure_size = size;
+}
+
+static double elapsed_ns(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start->tv_sec) * 1e9 +
+	       (end.tv_nsec - start->tv_nsec);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void) {}
+
+void tearDown(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_remove());
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_alloc_init_invalid(void)
+{
+	struct no_os_alloc_pool_param unsorted[] = {
+		{.block_size = 64, .nb_blocks = 1},
+		{.block_size = 60, .nb_blocks = 1},
+	};
+	struct no_os_alloc_init_param param = init_param;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_alloc_init(NULL));
+
+	param.mem = (uint8_t *)mem + 1;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_alloc_init(&param));
+
+	param = init_param;
+	param.pools = unsorted;
+	param.nb_pools = NO_OS_ARRAY_SIZE(unsorted);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_alloc_init(&param));
+
+	param = init_param;
+	param.mem_size = POOLS_SIZE - 1;
+	TEST_ASSERT_EQUAL_INT(-ENOMEM, no_os_alloc_init(&param));
+
+	/* Locking needs both callbacks */
+	param = init_param;
+	param.lock = lock;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_alloc_init(&param));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&init_param));
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_alloc_init(&init_param));
+}
+
+void test_alloc_arena_seal(void)
+{
+	struct no_os_alloc_stats stats;
+	uint8_t *arena = (uint8_t *)mem + POOLS_SIZE;
+	uint8_t *a, *b, *c;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&init_param));
+
+	/* Init time allocations are packed in the arena */
+	a = no_os_alloc_malloc(5);
+	b = no_os_alloc_calloc(3, 4);
+	TEST_ASSERT_TRUE(a == arena);
+	TEST_ASSERT_TRUE(b == arena + NO_OS_ALLOC_ALIGN);
+
+	/* The last one can be given back */
+	no_os_alloc_free(b);
+	c = no_os_alloc_malloc(200);
+	TEST_ASSERT_TRUE(c == b);
+
+	/* The others are kept and the free is reported */
+	no_os_alloc_free(a);
+
+	no_os_alloc_arena_stats(&stats);
+	TEST_ASSERT_EQUAL_UINT32(ARENA_SIZE, stats.nb_blocks);
+	TEST_ASSERT_EQUAL_UINT32(208, stats.used);
+	TEST_ASSERT_EQUAL_UINT32(208, stats.high_water);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.invalid_frees);
+
+	/* Does not fit in the arena anymore, served by a pool */
+	a = no_os_alloc_malloc(64);
+	TEST_ASSERT_TRUE(a >= (uint8_t *)mem && a < arena);
+	no_os_alloc_free(a);
+
+	/* After sealing, the arena is closed */
+	no_os_alloc_seal();
+	a = no_os_alloc_malloc(8);
+	TEST_ASSERT_TRUE(a < arena);
+	no_os_alloc_free(a);
+	TEST_ASSERT_NULL(no_os_alloc_malloc(1000));
+
+	no_os_alloc_arena_stats(&stats);
+	TEST_ASSERT_EQUAL_UINT32(208, stats.used);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.failures);
+}
+
+void test_alloc_pools(void)
+{
+	struct no_os_alloc_stats stats;
+	void *small[9];
+	uint8_t *p;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&init_param));
+	no_os_alloc_seal();
+
+	/* The smallest class first, then the next one when it is empty */
+	for (i = 0; i < 9; i++) {
+		small[i] = no_os_alloc_malloc(10);
+		TEST_ASSERT_NOT_NULL(small[i]);
+	}
+	TEST_ASSERT_TRUE((uint8_t *)small[7] < (uint8_t *)mem + 128);
+	TEST_ASSERT_TRUE((uint8_t *)small[8] >= (uint8_t *)mem + 128);
+
+	no_os_alloc_pool_stats(0, &stats);
+	TEST_ASSERT_EQUAL_UINT32(16, stats.block_size);
+	TEST_ASSERT_EQUAL_UINT32(8, stats.used);
+	/* Served by the next class, not a failure */
+	TEST_ASSERT_EQUAL_UINT32(0, stats.failures);
+
+	/* Freed blocks are reused first */
+	no_os_alloc_free(small[3]);
+	p = no_os_alloc_calloc(2, 8);
+	TEST_ASSERT_TRUE(p == small[3]);
+	for (i = 0; i < 16; i++)
+		TEST_ASSERT_EQUAL_HEX8(0, p[i]);
+
+	/* Overflowing requests are rejected */
+	TEST_ASSERT_NULL(no_os_alloc_calloc(SIZE_MAX / 2, 4));
+
+	/* Blocks in use keep the allocator alive */
+	TEST_ASSERT_EQUAL_INT(-EBUSY, no_os_alloc_remove());
+
+	for (i = 0; i < 9; i++)
+		no_os_alloc_free(small[i]);
+
+	no_os_alloc_pool_stats(0, &stats);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.used);
+	TEST_ASSERT_EQUAL_UINT32(8, stats.high_water);
+	no_os_alloc_pool_stats(1, &stats);
+	TEST_ASSERT_EQUAL_UINT32(64, stats.block_size);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.high_water);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_alloc_pool_stats(3, &stats));
+
+	/* All the fitting classes are empty */
+	small[0] = no_os_alloc_malloc(200);
+	small[1] = no_os_alloc_malloc(200);
+	TEST_ASSERT_NULL(no_os_alloc_malloc(200));
+	no_os_alloc_pool_stats(2, &stats);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.failures);
+	no_os_alloc_free(small[0]);
+	no_os_alloc_free(small[1]);
+}
+
+void test_alloc_lock(void)
+{
+	struct no_os_alloc_init_param param = init_param;
+	void *p;
+
+	param.lock = lock;
+	param.unlock = unlock;
+	param.lock_ctx = &lock_depth;
+	nb_locks = 0;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&param));
+	p = no_os_alloc_malloc(10);
+	no_os_alloc_free(p);
+	no_os_alloc_seal();
+	p = no_os_alloc_calloc(1, 10);
+	no_os_alloc_free(p);
+
+	/* Balanced, one lock for each call */
+	TEST_ASSERT_EQUAL_UINT32(0, lock_depth);
+	TEST_ASSERT_EQUAL_UINT32(5, nb_locks);
+}
+
+void test_alloc_libc_pointers(void)
+{
+	void *p;
+
+	/* Allocated before the pools are set up, released after */
+	p = no_os_alloc_malloc(100);
+	TEST_ASSERT_NOT_NULL(p);
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&init_param));
+	no_os_alloc_free(p);
+	no_os_alloc_free(NULL);
+}
+
+void test_alloc_realloc(void)
+{
+	uint8_t *arena = (uint8_t *)mem + POOLS_SIZE;
+	struct no_os_alloc_stats stats;
+	uint8_t *a, *b, *p;
+	uint32_t i;
+
+	/* libc before the init */
+	p = no_os_alloc_realloc(NULL, 10);
+	TEST_ASSERT_NOT_NULL(p);
+	p[9] = 0x5a;
+	p = no_os_alloc_realloc(p, 1000);
+	TEST_ASSERT_EQUAL_HEX8(0x5a, p[9]);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&init_param));
+
+	/* libc memory stays in libc */
+	p = no_os_alloc_realloc(p, 20);
+	TEST_ASSERT_EQUAL_HEX8(0x5a, p[9]);
+	no_os_alloc_free(p);
+
+	/* The last arena allocation is resized in place */
+	a = no_os_alloc_realloc(NULL, 8);
+	b = no_os_alloc_malloc(8);
+	TEST_ASSERT_TRUE(b == arena + 8);
+	memset(b, 0xa5, 8);
+	TEST_ASSERT_TRUE(no_os_alloc_realloc(b, 100) == b);
+	no_os_alloc_arena_stats(&stats);
+	TEST_ASSERT_EQUAL_UINT32(8 + 104, stats.used);
+	TEST_ASSERT_TRUE(no_os_alloc_realloc(b, 16) == b);
+	no_os_alloc_arena_stats(&stats);
+	TEST_ASSERT_EQUAL_UINT32(8 + 16, stats.used);
+
+	/* Other arena allocations move, the content goes along */
+	memset(a, 0x3c, 8);
+	p = no_os_alloc_realloc(a, 40);
+	TEST_ASSERT_TRUE(p == arena + 24);
+	for (i = 0; i < 8; i++)
+		TEST_ASSERT_EQUAL_HEX8(0x3c, p[i]);
+
+	no_os_alloc_seal();
+
+	/* A pool block keeps the sizes it can hold */
+	a = no_os_alloc_malloc(10);
+	TEST_ASSERT_TRUE(no_os_alloc_realloc(a, 16) == a);
+	memset(a, 0x11, 16);
+	b = no_os_alloc_realloc(a, 60);
+	TEST_ASSERT_TRUE(b != a);
+	for (i = 0; i < 16; i++)
+		TEST_ASSERT_EQUAL_HEX8(0x11, b[i]);
+	no_os_alloc_pool_stats(0, &stats);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.used);
+
+	/* A failed resize keeps the memory */
+	TEST_ASSERT_NULL(no_os_alloc_realloc(b, 1000));
+	TEST_ASSERT_EQUAL_HEX8(0x11, b[15]);
+	no_os_alloc_free(b);
+}
+
+void test_alloc_seal_failure(void)
+{
+	struct no_os_alloc_init_param param = init_param;
+	void *p;
+
+	param.seal_failure = seal_failure;
+	seal_failure_size = 0;
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&param));
+
+	/* Before sealing, a failure is only counted */
+	TEST_ASSERT_NULL(no_os_alloc_malloc(1000));
+	TEST_ASSERT_EQUAL_UINT32(0, seal_failure_size);
+
+	no_os_alloc_seal();
+	p = no_os_alloc_malloc(200);
+	TEST_ASSERT_NOT_NULL(p);
+	TEST_ASSERT_EQUAL_UINT32(0, seal_failure_size);
+	TEST_ASSERT_NULL(no_os_alloc_calloc(100, 3));
+	TEST_ASSERT_EQUAL_UINT32(300, seal_failure_size);
+	no_os_alloc_free(p);
+}
+
+void test_alloc_benchmark(void)
+{
+	static const uint32_t sizes[] = {12, 40, 8, 200, 16, 64};
+	struct no_os_alloc_init_param param = init_param;
+	struct timespec start;
+	void *live[4] = {0};
+	double libc_ns;
+	double pool_ns;
+	uint32_t i;
+
+	/* Enough blocks for the live set */
+	param.mem_size = sizeof(mem);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < 1000000; i++) {
+		free(live[i & 3]);
+		live[i & 3] = malloc(sizes[i % NO_OS_ARRAY_SIZE(sizes)]);
+	}
+	libc_ns = elapsed_ns(&start);
+	for (i = 0; i < 4; i++) {
+		free(live[i]);
+		live[i] = NULL;
+	}
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_alloc_init(&param));
+	no_os_alloc_seal();
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < 1000000; i++) {
+		no_os_alloc_free(live[i & 3]);
+		live[i & 3] = no_os_alloc_malloc(sizes[i %
+						 NO_OS_ARRAY_SIZE(sizes)]);
+	}
+	pool_ns = elapsed_ns(&start);
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT_NOT_NULL(live[i]);
+		no_os_alloc_free(live[i]);
+	}
+
+	printf("free + malloc: libc %.1f ns, pools %.1f ns\n",
+	       libc_ns / 1000000, pool_ns / 1000000);
+}
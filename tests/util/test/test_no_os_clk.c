@@ -0,0 +1,325 @@
+/***************************************************************************//**
+ *   @file   test_no_os_clk.c
+ *   @brief  Unit tests of the clock framework.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_clk.h"
+#include "no_os_alloc.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/*
+ * Fake device with a PLL (channel 0) feeding output dividers (channels 1 to
+ * 3), the rate of an output is the PLL rate divided by its divider.
+ */
+struct test_clk_dev {
+	uint64_t pll_rate;
+	uint32_t div[4];
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t batches;
+};
+
+static struct test_clk_dev dev;
+
+static int test_recalc_rate(struct no_os_clk_desc *desc, uint64_t *rate)
+{
+	struct test_clk_dev *d = desc->dev_desc;
+
+	d->reads++;
+	if (!desc->hw_ch_num)
+		*rate = d->pll_rate;
+	else
+		*rate = d->pll_rate / d->div[desc->hw_ch_num];
+
+	return 0;
+}
+
+static int test_round_rate(struct no_os_clk_desc *desc, uint64_t rate,
+			   uint64_t *rounded_rate)
+{
+	struct test_clk_dev *d = desc->dev_desc;
+
+	if (!rate)
+		return -EINVAL;
+	if (!desc->hw_ch_num)
+		*rounded_rate = rate;
+	else
+		*rounded_rate = d->pll_rate / (d->pll_rate / rate);
+
+	return 0;
+}
+
+static int test_set_rate(struct no_os_clk_desc *desc, uint64_t rate)
+{
+	struct test_clk_dev *d = desc->dev_desc;
+
+	d->writes++;
+	if (!desc->hw_ch_num)
+		d->pll_rate = rate;
+	else
+		d->div[desc->hw_ch_num] = d->pll_rate / rate;
+
+	return 0;
+}
+
+static int test_set_rates(struct no_os_clk_desc **descs, const uint64_t *rates,
+			  uint32_t nb_clks)
+{
+	uint32_t i;
+
+	dev.batches++;
+	for (i = 0; i < nb_clks; i++)
+		test_set_rate(descs[i], rates[i]);
+
+	return 0;
+}
+
+static const struct no_os_clk_platform_ops test_ops = {
+	.clk_recalc_rate = test_recalc_rate,
+	.clk_round_rate = test_round_rate,
+	.clk_set_rate = test_set_rate,
+};
+
+static const struct no_os_clk_platform_ops test_batch_ops = {
+	.clk_recalc_rate = test_recalc_rate,
+	.clk_round_rate = test_round_rate,
+	.clk_set_rate = test_set_rate,
+	.clk_set_rates = test_set_rates,
+};
+
+static struct no_os_clk_desc *clks[4];
+
+static void init_tree(const struct no_os_clk_platform_ops *ops, uint32_t flags)
+{
+	struct no_os_clk_init_param param = {
+		.platform_ops = ops,
+		.dev_desc = &dev,
+		.flags = flags,
+	};
+	uint32_t i;
+
+	for (i = 0; i < 4; i++) {
+		param.hw_ch_num = i;
+		param.parent = i ? clks[0] : NULL;
+		TEST_ASSERT_EQUAL_INT(0, no_os_clk_init(&clks[i], &param));
+	}
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	memset(&dev, 0, sizeof(dev));
+	dev.pll_rate = 3000000000ULL;
+	dev.div[1] = 10;
+	dev.div[2] = 20;
+	dev.div[3] = 30;
+	memset(clks, 0, sizeof(clks));
+}
+
+void tearDown(void)
+{
+	uint32_t i;
+
+	for (i = 4; i > 0; i--)
+		if (clks[i - 1])
+			no_os_clk_remove(clks[i - 1]);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_clk_no_cache(void)
+{
+	uint64_t rate;
+
+	init_tree(&test_ops, 0);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[1], &rate));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[1], &rate));
+	TEST_ASSERT_EQUAL_UINT32(2, dev.reads);
+
+	/* Without the cache, all the requests reach the device */
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rate(clks[1], 300000000));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rate(clks[1], 300000000));
+	TEST_ASSERT_EQUAL_UINT32(2, dev.writes);
+}
+
+void test_clk_cache(void)
+{
+	struct no_os_clk_stats stats;
+	uint64_t rate;
+
+	init_tree(&test_ops, NO_OS_CLK_CACHE_RATE);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[2], &rate));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[2], &rate));
+	TEST_ASSERT_EQUAL_UINT32(150000000, rate);
+	TEST_ASSERT_EQUAL_UINT32(1, dev.reads);
+
+	/* Setting the cached rate again is skipped */
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rate(clks[2], 150000000));
+	TEST_ASSERT_EQUAL_UINT32(0, dev.writes);
+
+	/* A parent change drops the rates of all the descendants */
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rate(clks[0], 1500000000));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[2], &rate));
+	TEST_ASSERT_EQUAL_UINT32(75000000, rate);
+	TEST_ASSERT_EQUAL_UINT32(2, dev.reads);
+
+	/* And so does an explicit invalidation */
+	no_os_clk_invalidate(clks[0]);
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[2], &rate));
+	TEST_ASSERT_EQUAL_UINT32(3, dev.reads);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_get_stats(clks[2], &stats, true));
+	TEST_ASSERT_EQUAL_UINT32(3, stats.hw_reads);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.cached_reads);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.hw_writes);
+	TEST_ASSERT_EQUAL_UINT32(1, stats.skipped_writes);
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_get_stats(clks[2], &stats, false));
+	TEST_ASSERT_EQUAL_UINT32(0, stats.hw_reads);
+}
+
+void test_clk_parent(void)
+{
+	uint64_t rate;
+
+	init_tree(&test_ops, NO_OS_CLK_CACHE_RATE);
+
+	TEST_ASSERT_EQUAL_PTR(clks[0], no_os_clk_get_parent(clks[3]));
+	TEST_ASSERT_NULL(no_os_clk_get_parent(clks[0]));
+
+	/* Loops are refused */
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_clk_set_parent(clks[0], clks[3]));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_clk_set_parent(clks[0], clks[0]));
+
+	/* Once detached, a parent change doesn't touch the clock */
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_parent(clks[3], NULL));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[3], &rate));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rate(clks[0], 1500000000));
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[3], &rate));
+	TEST_ASSERT_EQUAL_UINT32(100000000, rate);
+
+	/* Removing a parent turns its children into root clocks */
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_remove(clks[0]));
+	clks[0] = NULL;
+	TEST_ASSERT_NULL(no_os_clk_get_parent(clks[1]));
+	TEST_ASSERT_NULL(no_os_clk_get_parent(clks[2]));
+}
+
+void test_clk_set_rates(void)
+{
+	struct no_os_clk_desc *descs[4];
+	uint64_t rates[4];
+	uint64_t rate;
+	uint32_t i;
+
+	init_tree(&test_batch_ops, NO_OS_CLK_CACHE_RATE);
+	for (i = 0; i < 4; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[i], &rate));
+	dev.reads = 0;
+
+	/* Children listed first are still programmed after their parent */
+	descs[0] = clks[1];
+	rates[0] = 200000000;
+	descs[1] = clks[2];
+	rates[1] = 100000000;
+	descs[2] = clks[0];
+	rates[2] = 2000000000;
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rates(descs, rates, 3));
+	TEST_ASSERT_EQUAL_UINT32(10, dev.div[1]);
+	TEST_ASSERT_EQUAL_UINT32(20, dev.div[2]);
+	TEST_ASSERT_EQUAL_UINT32(3, dev.writes);
+	/* The PLL first, then both outputs in one call */
+	TEST_ASSERT_EQUAL_UINT32(2, dev.batches);
+
+	/* The rates already set are skipped */
+	dev.writes = 0;
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(descs[i],
+				      &rate));
+	rates[1] = 50000000;
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rates(descs, rates, 3));
+	TEST_ASSERT_EQUAL_UINT32(1, dev.writes);
+	TEST_ASSERT_EQUAL_UINT32(40, dev.div[2]);
+
+	/* Nothing is programmed if one of the rates can't be reached */
+	dev.writes = 0;
+	rates[0] = 250000000;
+	rates[1] = 0;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_clk_set_rates(descs, rates, 3));
+	TEST_ASSERT_EQUAL_UINT32(0, dev.writes);
+
+	/* Nor if a clock is listed twice */
+	descs[1] = clks[1];
+	rates[1] = 250000000;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_clk_set_rates(descs, rates, 3));
+	TEST_ASSERT_EQUAL_UINT32(0, dev.writes);
+}
+
+void test_clk_set_rates_parent_change(void)
+{
+	struct no_os_clk_desc *descs[2];
+	uint64_t rates[2] = { 1500000000, 300000000 };
+	uint64_t rate;
+
+	init_tree(&test_ops, NO_OS_CLK_CACHE_RATE);
+	descs[0] = clks[0];
+	descs[1] = clks[1];
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[1], &rate));
+	TEST_ASSERT_EQUAL_UINT32(300000000, rate);
+
+	/* The output has the rate now, but not once the PLL is changed */
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_set_rates(descs, rates, 2));
+	TEST_ASSERT_EQUAL_UINT32(2, dev.writes);
+	TEST_ASSERT_EQUAL_UINT32(5, dev.div[1]);
+	TEST_ASSERT_EQUAL_INT(0, no_os_clk_recalc_rate(clks[1], &rate));
+	TEST_ASSERT_EQUAL_UINT32(300000000, rate);
+}
@@ -0,0 +1,231 @@
+/***************************************************************************//**
+ *   @file   test_no_os_irq_table.c
+ *   @brief  Unit tests of the IRQ callback dispatch table.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_irq_table.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+/* Table covering NO_OS_EVT_UART_ERROR to NO_OS_EVT_TIM_ELAPSED */
+#define TEST_NB_EVENTS	(NO_OS_EVT_TIM_ELAPSED - NO_OS_EVT_UART_ERROR + 1)
+#define TEST_NB_SLOTS	4
+
+static struct no_os_irq_slot slots[TEST_NB_EVENTS * TEST_NB_SLOTS];
+static struct no_os_irq_table table = {
+	.slots = slots,
+	.first_event = NO_OS_EVT_UART_ERROR,
+	.nb_events = TEST_NB_EVENTS,
+	.nb_slots = TEST_NB_SLOTS,
+};
+static uint32_t calls[2];
+static uint32_t ticks;
+static uint32_t ticks_per_call;
+
+static void callback0(void *ctx)
+{
+	calls[0]++;
+	ticks += ticks_per_call;
+	TEST_ASSERT_EQUAL_PTR(&calls[0], ctx);
+}
+
+static void callback1(void *ctx)
+{
+	calls[1]++;
+	TEST_ASSERT_EQUAL_PTR(&calls[1], ctx);
+}
+
+static uint32_t get_ticks(void)
+{
+	return ticks;
+}
+
+static struct no_os_callback_desc cb0 = {
+	.callback = callback0,
+	.ctx = &calls[0],
+	.event = NO_OS_EVT_TIM_ELAPSED,
+	.peripheral = NO_OS_TIM_IRQ,
+};
+
+static struct no_os_callback_desc cb1 = {
+	.callback = callback1,
+	.ctx = &calls[1],
+	.event = NO_OS_EVT_TIM_ELAPSED,
+	.peripheral = NO_OS_TIM_IRQ,
+};
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	memset(slots, 0, sizeof(slots));
+	memset(calls, 0, sizeof(calls));
+	table.get_ticks = NULL;
+	ticks = 0;
+	ticks_per_call = 0;
+}
+
+void tearDown(void) {}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_irq_table_out_of_range(void)
+{
+	struct no_os_callback_desc cb = cb0;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_irq_table_register(&table,
+			      TEST_NB_SLOTS, 0, &cb0));
+	cb.event = NO_OS_EVT_UART_RX_COMPLETE;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_irq_table_register(&table, 0, 0,
+			      &cb));
+	cb.event = NO_OS_EVT_TIM_PWM_PULSE_FINISHED;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_irq_table_register(&table, 0, 0,
+			      &cb));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_irq_table_register(&table, 0, 0,
+			      NULL));
+	TEST_ASSERT_NULL(no_os_irq_table_get(NULL, 0, 0));
+	TEST_ASSERT_NULL(no_os_irq_table_get(&table, 0, TEST_NB_SLOTS));
+	TEST_ASSERT_FALSE(no_os_irq_table_dispatch(&table, NO_OS_EVT_GPIO, 0));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_irq_table_unregister(&table,
+			      NO_OS_EVT_TIM_ELAPSED, TEST_NB_SLOTS));
+}
+
+void test_irq_table_dispatch(void)
+{
+	struct no_os_irq_slot *s;
+
+	TEST_ASSERT_FALSE(no_os_irq_table_dispatch(&table,
+			  NO_OS_EVT_TIM_ELAPSED, 1));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_register(&table, 1, 42, &cb0));
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_register(&table, 2, 43, &cb1));
+
+	TEST_ASSERT_TRUE(no_os_irq_table_dispatch(&table,
+			 NO_OS_EVT_TIM_ELAPSED, 1));
+	TEST_ASSERT_TRUE(no_os_irq_table_dispatch(&table,
+			 NO_OS_EVT_TIM_ELAPSED, 1));
+	TEST_ASSERT_TRUE(no_os_irq_table_dispatch(&table,
+			 NO_OS_EVT_TIM_ELAPSED, 2));
+	TEST_ASSERT_EQUAL_UINT32(2, calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(1, calls[1]);
+
+	/* Same slot of another event is independent */
+	TEST_ASSERT_FALSE(no_os_irq_table_dispatch(&table,
+			  NO_OS_EVT_UART_ERROR, 1));
+
+	s = no_os_irq_table_get(&table, NO_OS_EVT_TIM_ELAPSED, 1);
+	TEST_ASSERT_NOT_NULL(s);
+	TEST_ASSERT_EQUAL_UINT32(42, s->irq_id);
+	TEST_ASSERT_TRUE(no_os_irq_slot_dispatch(&table, s));
+	TEST_ASSERT_EQUAL_UINT32(3, calls[0]);
+}
+
+void test_irq_table_update_and_unregister(void)
+{
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_register(&table, 0, 0, &cb0));
+	TEST_ASSERT_TRUE(no_os_irq_table_dispatch(&table,
+			 NO_OS_EVT_TIM_ELAPSED, 0));
+
+	/* Registering again replaces the callback */
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_register(&table, 0, 0, &cb1));
+	TEST_ASSERT_TRUE(no_os_irq_table_dispatch(&table,
+			 NO_OS_EVT_TIM_ELAPSED, 0));
+	TEST_ASSERT_EQUAL_UINT32(1, calls[0]);
+	TEST_ASSERT_EQUAL_UINT32(1, calls[1]);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_unregister(&table,
+			      NO_OS_EVT_TIM_ELAPSED, 0));
+	TEST_ASSERT_EQUAL_INT(-ENODEV, no_os_irq_table_unregister(&table,
+			      NO_OS_EVT_TIM_ELAPSED, 0));
+	TEST_ASSERT_FALSE(no_os_irq_table_dispatch(&table,
+			  NO_OS_EVT_TIM_ELAPSED, 0));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_register(&table, 3, 0, &cb0));
+	no_os_irq_table_clear(&table);
+	TEST_ASSERT_FALSE(no_os_irq_table_dispatch(&table,
+			  NO_OS_EVT_TIM_ELAPSED, 3));
+	TEST_ASSERT_EQUAL_UINT32(1, calls[0]);
+}
+
+void test_irq_table_stats(void)
+{
+	uint32_t count, max_ticks;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_register(&table, 1, 0, &cb0));
+
+	/* Without a tick source only the counter is updated */
+	no_os_irq_table_dispatch(&table, NO_OS_EVT_TIM_ELAPSED, 1);
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_stats(&table,
+			      NO_OS_EVT_TIM_ELAPSED, 1, &count, &max_ticks));
+	TEST_ASSERT_EQUAL_UINT32(1, count);
+	TEST_ASSERT_EQUAL_UINT32(0, max_ticks);
+
+	table.get_ticks = get_ticks;
+	ticks_per_call = 10;
+	no_os_irq_table_dispatch(&table, NO_OS_EVT_TIM_ELAPSED, 1);
+	ticks_per_call = 30;
+	no_os_irq_table_dispatch(&table, NO_OS_EVT_TIM_ELAPSED, 1);
+	ticks_per_call = 20;
+	/* The tick counter wrapping around is handled */
+	ticks = UINT32_MAX - 5;
+	no_os_irq_table_dispatch(&table, NO_OS_EVT_TIM_ELAPSED, 1);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_stats(&table,
+			      NO_OS_EVT_TIM_ELAPSED, 1, &count, &max_ticks));
+	TEST_ASSERT_EQUAL_UINT32(4, count);
+	TEST_ASSERT_EQUAL_UINT32(30, max_ticks);
+
+	no_os_irq_table_stats_reset(&table);
+	TEST_ASSERT_EQUAL_INT(0, no_os_irq_table_stats(&table,
+			      NO_OS_EVT_TIM_ELAPSED, 1, &count, &max_ticks));
+	TEST_ASSERT_EQUAL_UINT32(0, count);
+	TEST_ASSERT_EQUAL_UINT32(0, max_ticks);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_irq_table_stats(&table,
+			      NO_OS_EVT_USB, 1, &count, &max_ticks));
+}
@@ -0,0 +1,289 @@
+/***************************************************************************//**
+ *   @file   test_no_os_lf_ring.c
+ *   @brief  Unit tests and benchmark of the lock-free SPSC ring.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_lf_ring.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define STRESS_ELEMS	2000000
+#define PING_PONGS	20000
+
+static struct no_os_lf_ring *ring;
+static struct no_os_lf_ring *back;
+
+static double elapsed_ns(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start->tv_sec) * 1e9 +
+	       (end.tv_nsec - start->tv_nsec);
+}
+
+/* Producer of the stress test, writes an increasing sequence in bursts */
+static void *producer(void *arg)
+{
+	uint32_t burst[37];
+	uint32_t next = 0;
+	uint32_t nb, i;
+
+	while (next < STRESS_ELEMS) {
+		nb = no_os_min(NO_OS_ARRAY_SIZE(burst), STRESS_ELEMS - next);
+		for (i = 0; i < nb; i++)
+			burst[i] = next + i;
+		nb = no_os_lf_ring_write_n(ring, burst, nb);
+		if (!nb)
+			sched_yield();
+		next += nb;
+	}
+
+	return NULL;
+}
+
+/* Echoes every element of ring back through back */
+static void *echo(void *arg)
+{
+	uint32_t v;
+	uint32_t i;
+
+	for (i = 0; i < PING_PONGS; i++) {
+		while (no_os_lf_ring_read(ring, &v))
+			sched_yield();
+		while (no_os_lf_ring_write(back, &v))
+			sched_yield();
+	}
+
+	return NULL;
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	ring = NULL;
+	back = NULL;
+}
+
+void tearDown(void)
+{
+	if (ring)
+		no_os_lf_ring_remove(ring);
+	if (back)
+		no_os_lf_ring_remove(back);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_lf_ring_init_invalid(void)
+{
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_init(NULL, 8, 4));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_init(&ring, 12, 4));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_init(&ring, 1, 4));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_init(&ring, 8, 0));
+	TEST_ASSERT_NULL(ring);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_remove(NULL));
+}
+
+void test_lf_ring_full_empty(void)
+{
+	uint32_t v;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&ring, 8, sizeof(v)));
+	TEST_ASSERT_TRUE(no_os_lf_ring_is_empty(ring));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_lf_ring_read(ring, &v));
+
+	for (i = 0; i < 8; i++)
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write(ring, &i));
+	TEST_ASSERT_TRUE(no_os_lf_ring_is_full(ring));
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_lf_ring_space(ring));
+	TEST_ASSERT_EQUAL_INT(-ENOSPC, no_os_lf_ring_write(ring, &i));
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_lf_ring_write_n(ring, &i, 1));
+
+	for (i = 0; i < 8; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_read(ring, &v));
+		TEST_ASSERT_EQUAL_UINT32(i, v);
+	}
+	TEST_ASSERT_TRUE(no_os_lf_ring_is_empty(ring));
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, no_os_lf_ring_read(ring, &v));
+
+	/* Flush drops what is left */
+	no_os_lf_ring_write_n(ring, &i, 1);
+	no_os_lf_ring_flush(ring);
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_lf_ring_count(ring));
+	TEST_ASSERT_EQUAL_UINT32(8, no_os_lf_ring_space(ring));
+}
+
+void test_lf_ring_wraparound(void)
+{
+	uint8_t in[5 * 3];
+	uint8_t out[5 * 3];
+	uint32_t seq = 0;
+	uint32_t i, j;
+
+	/* 3 byte elements, 5 at a time in 8 slots: every copy position */
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&ring, 8, 3));
+	for (i = 0; i < 100; i++) {
+		for (j = 0; j < sizeof(in); j++)
+			in[j] = seq + j;
+		TEST_ASSERT_EQUAL_UINT32(5, no_os_lf_ring_write_n(ring, in, 5));
+		TEST_ASSERT_EQUAL_UINT32(3, no_os_lf_ring_write_n(ring, in, 5));
+		TEST_ASSERT_EQUAL_UINT32(5, no_os_lf_ring_read_n(ring, out, 5));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(in, out, sizeof(in));
+		TEST_ASSERT_EQUAL_UINT32(3, no_os_lf_ring_read_n(ring, out, 6));
+		TEST_ASSERT_EQUAL_HEX8_ARRAY(in, out, 3 * 3);
+		seq += 7;
+	}
+}
+
+void test_lf_ring_peek_commit(void)
+{
+	uint32_t *p;
+	uint32_t nb;
+	uint32_t v;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&ring, 8, sizeof(v)));
+
+	/* Move the indexes to slot 6 */
+	for (i = 0; i < 6; i++) {
+		no_os_lf_ring_write(ring, &i);
+		no_os_lf_ring_read(ring, &v);
+	}
+
+	/* The free region stops at the end of the storage */
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write_peek(ring, (void **)&p,
+			      &nb));
+	TEST_ASSERT_EQUAL_UINT32(2, nb);
+	p[0] = 100;
+	p[1] = 101;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_write_commit(ring, 9));
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write_commit(ring, 2));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write_peek(ring, (void **)&p,
+			      &nb));
+	TEST_ASSERT_EQUAL_UINT32(6, nb);
+	p[0] = 102;
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write_commit(ring, 1));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_read_peek(ring, (void **)&p,
+			      &nb));
+	TEST_ASSERT_EQUAL_UINT32(2, nb);
+	TEST_ASSERT_EQUAL_UINT32(100, p[0]);
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_lf_ring_read_commit(ring, 4));
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_read_commit(ring, 2));
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_read_peek(ring, (void **)&p,
+			      &nb));
+	TEST_ASSERT_EQUAL_UINT32(1, nb);
+	TEST_ASSERT_EQUAL_UINT32(102, p[0]);
+}
+
+void test_lf_ring_two_threads(void)
+{
+	struct timespec start;
+	uint32_t buff[64];
+	uint32_t expected = 0;
+	pthread_t thread;
+	double ns;
+	uint32_t nb, i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&ring, 1024,
+			      sizeof(*buff)));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, producer, NULL));
+	while (expected < STRESS_ELEMS) {
+		nb = no_os_lf_ring_read_n(ring, buff, NO_OS_ARRAY_SIZE(buff));
+		if (!nb)
+			sched_yield();
+		for (i = 0; i < nb; i++)
+			TEST_ASSERT_EQUAL_UINT32(expected + i, buff[i]);
+		expected += nb;
+	}
+	ns = elapsed_ns(&start);
+	pthread_join(thread, NULL);
+
+	TEST_ASSERT_TRUE(no_os_lf_ring_is_empty(ring));
+	printf("lf_ring throughput: %.1f M elements/s\n",
+	       STRESS_ELEMS / ns * 1e3);
+}
+
+void test_lf_ring_latency(void)
+{
+	struct timespec start;
+	pthread_t thread;
+	uint32_t v;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&ring, 2, sizeof(v)));
+	TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_init(&back, 2, sizeof(v)));
+	TEST_ASSERT_EQUAL_INT(0, pthread_create(&thread, NULL, echo, NULL));
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < PING_PONGS; i++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_lf_ring_write(ring, &i));
+		while (no_os_lf_ring_read(back, &v))
+			sched_yield();
+		TEST_ASSERT_EQUAL_UINT32(i, v);
+	}
+	printf("lf_ring round trip: %.0f ns\n",
+	       elapsed_ns(&start) / PING_PONGS);
+
+	pthread_join(thread, NULL);
+}
@@ -0,0 +1,234 @@
+/***************************************************************************//**
+ *   @file   test_no_os_log_deferred.c
+ *   @brief  Unit tests of the deferred logging backend.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_log_deferred.h"
+#include "no_os_print_log.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+static char line[NO_OS_LOG_LINE_SIZE];
+
+/* Pop one record and format it in line. */
+static int format_next(void)
+{
+	struct no_os_log_record rec;
+	int ret;
+
+	ret = no_os_log_read(&rec);
+	if (ret)
+		return ret;
+
+	return no_os_log_format(&rec, line, sizeof(line));
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	struct no_os_log_record rec;
+	struct no_os_log_stats stats;
+
+	while (!no_os_log_read(&rec))
+		;
+	no_os_log_stats_get(&stats, true);
+	memset(line, 0, sizeof(line));
+}
+
+void tearDown(void) {}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_log_deferred_format(void)
+{
+	const char *name = "adc0";
+	float f = 1.5f;
+	long long big = -1234567890123LL;
+
+	no_os_log_deferred(NO_OS_LOG_INFO, "plain\n");
+	no_os_log_deferred(NO_OS_LOG_INFO, "%s ch%u = %d (0x%04x) 100%%\n",
+			   name, 3u, -42, 0xbeef);
+	no_os_log_deferred(NO_OS_LOG_INFO, "%.2f %g %lld [%*d] [%-6s]\n", f,
+			   0.25, big, 5, 7, "ab");
+	no_os_log_deferred(NO_OS_LOG_INFO, "%c%c %hhu %lu %zu\n", 'o', 'k',
+			   (unsigned char)200, 4000000000UL, sizeof(line));
+
+	TEST_ASSERT_EQUAL_INT(6, format_next());
+	TEST_ASSERT_EQUAL_STRING("plain\n", line);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("adc0 ch3 = -42 (0xbeef) 100%\n", line);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("1.50 0.25 -1234567890123 [    7] [ab    ]\n",
+				 line);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("ok 200 4000000000 256\n", line);
+	TEST_ASSERT_EQUAL_INT(-EAGAIN, format_next());
+}
+
+void test_log_deferred_prefix(void)
+{
+	char expected[NO_OS_LOG_LINE_SIZE];
+	int line_nb;
+
+	line_nb = __LINE__ + 1;
+	no_os_log_deferred(NO_OS_LOG_ERR, "failed %d\n", -5);
+	no_os_log_deferred(NO_OS_LOG_WARNING, "check\n");
+	no_os_log_deferred(NO_OS_LOG_DEBUG, "x=%d\n", 1);
+
+	snprintf(expected, sizeof(expected),
+		 "ERR: %s:%d:%s(): failed -5\n", __FILE__, line_nb, __func__);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING(expected, line);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("WARNING: check\n", line);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("DEBUG: x=1\n", line);
+}
+
+void test_log_deferred_truncate(void)
+{
+	struct no_os_log_record rec;
+	char small[8];
+
+	no_os_log_deferred(NO_OS_LOG_INFO, "%s %d\n", "0123456789", 42);
+	TEST_ASSERT_EQUAL_INT(0, no_os_log_read(&rec));
+	TEST_ASSERT_EQUAL_INT(14, no_os_log_format(&rec, small, sizeof(small)));
+	TEST_ASSERT_EQUAL_STRING("0123456", small);
+	TEST_ASSERT_EQUAL_INT(14, no_os_log_format(&rec, NULL, 0));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_log_format(NULL, small,
+			      sizeof(small)));
+}
+
+void test_log_deferred_full_and_stats(void)
+{
+	struct no_os_log_stats stats;
+	uint32_t i;
+
+	for (i = 0; i < NO_OS_LOG_RING_SIZE + 3; i++)
+		no_os_log_deferred(NO_OS_LOG_INFO, "%u\n", i);
+
+	no_os_log_stats_get(&stats, false);
+	TEST_ASSERT_EQUAL_UINT32(NO_OS_LOG_RING_SIZE, stats.recorded);
+	TEST_ASSERT_EQUAL_UINT32(3, stats.dropped);
+
+	/* The oldest records are kept, the new ones are dropped */
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("0\n", line);
+	no_os_log_deferred(NO_OS_LOG_INFO, "%u\n", 1000u);
+	for (i = 1; i < NO_OS_LOG_RING_SIZE; i++)
+		format_next();
+	TEST_ASSERT_EQUAL_STRING("63\n", line);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("1000\n", line);
+
+	no_os_log_stats_get(&stats, true);
+	TEST_ASSERT_EQUAL_UINT32(NO_OS_LOG_RING_SIZE + 1, stats.recorded);
+	TEST_ASSERT_EQUAL_UINT32(NO_OS_LOG_RING_SIZE, stats.high_water);
+	no_os_log_stats_get(&stats, false);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.recorded);
+	TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
+
+void test_log_deferred_laps(void)
+{
+	uint32_t i;
+	char expected[16];
+
+	/* Several times around the ring, one record at a time */
+	for (i = 0; i < 5 * NO_OS_LOG_RING_SIZE; i++) {
+		no_os_log_deferred(NO_OS_LOG_INFO, "%u\n", i);
+		TEST_ASSERT_TRUE(format_next() > 0);
+		snprintf(expected, sizeof(expected), "%u\n", i);
+		TEST_ASSERT_EQUAL_STRING(expected, line);
+	}
+	TEST_ASSERT_EQUAL_UINT32(0, no_os_log_drain(0));
+}
+
+void test_log_deferred_strings(void)
+{
+	char name[16] = "adc0";
+	char longest[2 * NO_OS_LOG_STR_SIZE];
+	const char *none = NULL;
+
+	/* The record keeps its own copy of the string */
+	no_os_log_deferred(NO_OS_LOG_INFO, "%s %s\n", name, none);
+	strcpy(name, "gone");
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("adc0 (null)\n", line);
+
+	/* Strings beyond NO_OS_LOG_STR_SIZE are truncated */
+	memset(longest, 'a', sizeof(longest) - 1);
+	longest[sizeof(longest) - 1] = '\0';
+	no_os_log_deferred(NO_OS_LOG_INFO, "[%s][%s]\n", longest, name);
+	format_next();
+	TEST_ASSERT_EQUAL_INT(NO_OS_LOG_STR_SIZE - 1 + 5, strlen(line));
+	TEST_ASSERT_EQUAL_STRING("][]\n", &line[NO_OS_LOG_STR_SIZE]);
+}
+
+void test_log_deferred_zero_args(void)
+{
+	static const struct no_os_log_site site = {
+		.fmt = "%d %d\n", .level = NO_OS_LOG_INFO,
+	};
+	struct no_os_log_record *rec;
+	uint32_t i;
+
+	/* Leave stale arguments in every slot of the ring */
+	for (i = 0; i < NO_OS_LOG_RING_SIZE; i++) {
+		no_os_log_deferred(NO_OS_LOG_INFO, "%d %d\n", 11, 22);
+		format_next();
+	}
+
+	rec = no_os_log_reserve(&site);
+	TEST_ASSERT_NOT_NULL(rec);
+	no_os_log_commit(rec);
+	format_next();
+	TEST_ASSERT_EQUAL_STRING("0 0\n", line);
+}
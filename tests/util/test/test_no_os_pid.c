@@ -0,0 +1,309 @@
+/***************************************************************************//**
+ *   @file   test_no_os_pid.c
+ *   @brief  Unit tests of the batch PID controller.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "no_os_pid.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <stdio.h>
+#include <time.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define NB_LOOPS	32
+#define BENCH_ROUNDS	9
+#define BENCH_UPDATES	20000
+
+static struct no_os_pid_batch *batch;
+
+static struct no_os_pid_batch_config config = {
+	.Kp = NO_OS_PID_BATCH_GAIN(1),
+	.d_alpha = NO_OS_PID_BATCH_GAIN(1),
+	.output_clip = {.high = 10000, .low = -10000},
+};
+
+/* Update the first loop of the batch */
+static int32_t control(int32_t SP, int32_t PV)
+{
+	int32_t output;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_control(batch, &SP, &PV,
+				 &output));
+
+	return output;
+}
+
+static double elapsed_ns(struct timespec *start)
+{
+	struct timespec end;
+
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	return (end.tv_sec - start->tv_sec) * 1e9 +
+	       (end.tv_nsec - start->tv_nsec);
+}
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	batch = NULL;
+}
+
+void tearDown(void)
+{
+	if (batch)
+		no_os_pid_batch_remove(batch);
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_pid_batch_invalid(void)
+{
+	struct no_os_pid_batch_config cfg = config;
+	int32_t v = 0;
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_init(&batch, 0));
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&batch, 2));
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_config(batch, 2, &cfg));
+	cfg.d_alpha = 0;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_config(batch, 0, &cfg));
+	cfg.d_alpha = NO_OS_PID_BATCH_GAIN(1) + 1;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_config(batch, 0, &cfg));
+	cfg = config;
+	cfg.output_clip.low = 10001;
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_config(batch, 0, &cfg));
+
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_control(batch, &v, NULL,
+			      &v));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_pid_batch_reset(batch, 2));
+}
+
+void test_pid_batch_proportional(void)
+{
+	struct no_os_pid_batch_config cfg = config;
+
+	cfg.Kp = NO_OS_PID_BATCH_GAIN(2.5);
+	cfg.output_clip.high = 1000;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&batch, 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, 0, &cfg));
+
+	TEST_ASSERT_EQUAL_INT32(150, control(100, 40));
+	TEST_ASSERT_EQUAL_INT32(-250, control(0, 100));
+	TEST_ASSERT_EQUAL_INT32(1000, control(1000, 0));
+	TEST_ASSERT_EQUAL_INT32(-10000, control(-5000, 0));
+}
+
+void test_pid_batch_anti_windup(void)
+{
+	struct no_os_pid_batch_config cfg = config;
+	uint32_t i;
+
+	cfg.Ki = NO_OS_PID_BATCH_GAIN(0.5);
+	cfg.output_clip.high = 100;
+	cfg.output_clip.low = 0;
+	cfg.i_clip.high = 10000;
+	cfg.i_clip.low = -10000;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&batch, 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, 0, &cfg));
+
+	/* Saturated for a long time, the integral must not wind up */
+	for (i = 0; i < 50; i++)
+		TEST_ASSERT_EQUAL_INT32(100, control(200, 0));
+	TEST_ASSERT_EQUAL_INT32(0, control(0, 0));
+
+	/* Out of the saturation the integral works again */
+	TEST_ASSERT_EQUAL_INT32(15, control(10, 0));
+	TEST_ASSERT_EQUAL_INT32(20, control(10, 0));
+
+	/* Integral clip, defaults to the output clip */
+	cfg.Kp = 0;
+	cfg.i_clip.high = 0;
+	cfg.i_clip.low = 0;
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, 0, &cfg));
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_reset(batch, 0));
+	for (i = 0; i < 50; i++)
+		control(30, 0);
+	TEST_ASSERT_EQUAL_INT32(95, control(-10, 0));
+}
+
+void test_pid_batch_derivative(void)
+{
+	struct no_os_pid_batch_config cfg = config;
+
+	cfg.Kp = 0;
+	cfg.Kd = NO_OS_PID_BATCH_GAIN(1);
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&batch, 1));
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, 0, &cfg));
+
+	/* No kick on the first update nor on set point steps */
+	TEST_ASSERT_EQUAL_INT32(0, control(0, 500));
+	TEST_ASSERT_EQUAL_INT32(0, control(1000, 500));
+
+	TEST_ASSERT_EQUAL_INT32(-100, control(1000, 600));
+	TEST_ASSERT_EQUAL_INT32(0, control(1000, 600));
+
+	/* Filtered: a quarter of the step, then decaying */
+	cfg.d_alpha = NO_OS_PID_BATCH_GAIN(0.25);
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, 0, &cfg));
+	TEST_ASSERT_EQUAL_INT32(-25, control(1000, 700));
+	TEST_ASSERT_EQUAL_INT32(-19, control(1000, 700));
+	TEST_ASSERT_EQUAL_INT32(-15, control(1000, 700));
+}
+
+void test_pid_batch_loops_independent(void)
+{
+	struct no_os_pid_batch *single[8];
+	struct no_os_pid_batch_config cfg[8];
+	int32_t SP[8], PV[8], out[8], ref;
+	uint32_t i, n;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&batch, 8));
+	for (n = 0; n < 8; n++) {
+		cfg[n] = config;
+		cfg[n].Kp = NO_OS_PID_BATCH_GAIN(0.5) * n - 60000;
+		cfg[n].Ki = NO_OS_PID_BATCH_GAIN(0.125) * (n % 3);
+		cfg[n].Kd = NO_OS_PID_BATCH_GAIN(0.75) * (n % 2);
+		cfg[n].d_alpha = NO_OS_PID_BATCH_GAIN(1) >> (n % 4);
+		cfg[n].output_clip.high = 100 * (n + 1);
+		cfg[n].output_clip.low = -50 * n;
+		TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, n,
+				      &cfg[n]));
+		TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&single[n], 1));
+		TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(single[n], 0,
+				      &cfg[n]));
+		SP[n] = 1000 * n;
+	}
+
+	for (i = 0; i < 200; i++) {
+		for (n = 0; n < 8; n++)
+			PV[n] = (int32_t)((i * 7919 + n * 104729) % 4001) -
+				2000;
+		no_os_pid_batch_control(batch, SP, PV, out);
+		for (n = 0; n < 8; n++) {
+			no_os_pid_batch_control(single[n], &SP[n], &PV[n],
+						&ref);
+			TEST_ASSERT_EQUAL_INT32(ref, out[n]);
+		}
+	}
+
+	for (n = 0; n < 8; n++)
+		no_os_pid_batch_remove(single[n]);
+}
+
+void test_pid_batch_benchmark(void)
+{
+	struct no_os_pid_config pid_config = {
+		.Kp = 500000,
+		.Ki = 10000,
+		.Kd = 100000,
+		.i_clip = {.high = 100000, .low = -100000},
+		.output_clip = {.high = 255, .low = 0},
+	};
+	struct no_os_pid_batch_config cfg = config;
+	struct no_os_pid *pid[NB_LOOPS];
+	int32_t SP[NB_LOOPS], PV[NB_LOOPS], out[NB_LOOPS];
+	struct timespec start;
+	double scalar_ns = 0;
+	double batch_ns = 0;
+	double ns;
+	int output;
+	uint32_t i, n, round;
+
+	cfg.Kp = NO_OS_PID_BATCH_GAIN(0.5);
+	cfg.Ki = NO_OS_PID_BATCH_GAIN(0.01);
+	cfg.Kd = NO_OS_PID_BATCH_GAIN(0.1);
+	cfg.d_alpha = NO_OS_PID_BATCH_GAIN(0.5);
+	cfg.output_clip.high = 255;
+	cfg.output_clip.low = 0;
+
+	TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_init(&batch, NB_LOOPS));
+	for (n = 0; n < NB_LOOPS; n++) {
+		TEST_ASSERT_EQUAL_INT(0, no_os_pid_init(&pid[n], pid_config));
+		TEST_ASSERT_EQUAL_INT(0, no_os_pid_batch_config(batch, n,
+				      &cfg));
+		SP[n] = 40000 + n;
+		PV[n] = 25000 + 10 * n;
+	}
+
+	/* Interleaved rounds, the fastest of each is kept */
+	for (round = 0; round < BENCH_ROUNDS; round++) {
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < BENCH_UPDATES; i++) {
+			for (n = 0; n < NB_LOOPS; n++) {
+				no_os_pid_control(pid[n], SP[n],
+						  PV[n] + (i & 63), &output);
+				out[n] = output;
+			}
+		}
+		ns = elapsed_ns(&start);
+		if (!round || ns < scalar_ns)
+			scalar_ns = ns;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (i = 0; i < BENCH_UPDATES; i++) {
+			PV[i % NB_LOOPS] += (i & 1) ? 1 : -1;
+			no_os_pid_batch_control(batch, SP, PV, out);
+		}
+		ns = elapsed_ns(&start);
+		if (!round || ns < batch_ns)
+			batch_ns = ns;
+	}
+
+	for (n = 0; n < NB_LOOPS; n++)
+		no_os_pid_remove(pid[n]);
+
+	printf("%d loops update: no_os_pid_control %.1f ns, batch %.1f ns\n",
+	       NB_LOOPS, scalar_ns / BENCH_UPDATES, batch_ns / BENCH_UPDATES);
+	TEST_ASSERT_TRUE(batch_ns < scalar_ns);
+}
@@ -0,0 +1,174 @@
+/***************************************************************************//**
+ *   @file   test_no_os_zstd.c
+ *   @brief  Unit tests of the Zstandard encoder.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*******************************************************************************
+ *    INCLUDED FILES
+ ******************************************************************************/
+
+#include "unity.h"
+#include "unity.h"
+#include "no_os_zstd.h"
+#include "no_os_alloc.h"
+#include "no_os_util.h"
+#include <errno.h>
+#include <string.h>
+
+/*******************************************************************************
+ *    PRIVATE DATA
+ ******************************************************************************/
+
+#define FRAME_HDR	9
+#define BLOCK_HDR	3
+#define RAND_LEN	1000
+#define LONG_LEN	300000
+
+/* Expected frames, checked with "zstd -d" */
+static const char xml[] = "<device id=\"iio:device0\">"
+			  "<device id=\"iio:device1\">"
+			  "<device id=\"iio:device2\">";
+
+static const uint8_t xml_frame[] = {
+	0x28, 0xb5, 0x2f, 0xfd, 0xa0, 0x4b, 0x00, 0x00, 0x00, 0x15, 0x01, 0x00,
+	0xb8, 0x3c, 0x64, 0x65, 0x76, 0x69, 0x63, 0x65, 0x20, 0x69, 0x64, 0x3d,
+	0x22, 0x69, 0x69, 0x6f, 0x3a, 0x30, 0x22, 0x3e, 0x31, 0x32, 0x22, 0x3e,
+	0x03, 0x00, 0x3c, 0x41, 0xc1, 0x53, 0x0d, 0x32, 0xcc, 0x25
+};
+
+static const uint8_t empty_frame[] = {
+	0x28, 0xb5, 0x2f, 0xfd, 0xa0, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00
+};
+
+static const uint8_t short_frame[] = {
+	0x28, 0xb5, 0x2f, 0xfd, 0xa0, 0x05, 0x00, 0x00, 0x00, 0x29, 0x00, 0x00,
+	0x6e, 0x6f, 0x2d, 0x4f, 0x53
+};
+
+static uint8_t out[NO_OS_ZSTD_BOUND(LONG_LEN)];
+
+/*******************************************************************************
+ *    SETUP, TEARDOWN
+ ******************************************************************************/
+
+void setUp(void)
+{
+	memset(out, 0xAA, sizeof(out));
+}
+
+void tearDown(void)
+{
+}
+
+/*******************************************************************************
+ *    TESTS
+ ******************************************************************************/
+
+void test_zstd_invalid(void)
+{
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_zstd_compress(NULL, 0, out,
+			      sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(-EINVAL, no_os_zstd_compress(xml, 1, NULL,
+			      sizeof(out)));
+	TEST_ASSERT_EQUAL_INT(-ENOSPC, no_os_zstd_compress(xml, 1, out,
+			      FRAME_HDR - 1));
+}
+
+void test_zstd_known_frames(void)
+{
+	int32_t ret;
+
+	ret = no_os_zstd_compress(xml, strlen(xml), out, sizeof(out));
+	TEST_ASSERT_EQUAL_INT32(sizeof(xml_frame), ret);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(xml_frame, out, ret);
+
+	ret = no_os_zstd_compress("", 0, out, sizeof(out));
+	TEST_ASSERT_EQUAL_INT32(sizeof(empty_frame), ret);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(empty_frame, out, ret);
+
+	ret = no_os_zstd_compress("no-OS", 5, out, sizeof(out));
+	TEST_ASSERT_EQUAL_INT32(sizeof(short_frame), ret);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(short_frame, out, ret);
+}
+
+void test_zstd_exact_output_size(void)
+{
+	TEST_ASSERT_EQUAL_INT32(sizeof(xml_frame),
+				no_os_zstd_compress(xml, strlen(xml), out,
+						sizeof(xml_frame)));
+
+	memset(out, 0xAA, sizeof(out));
+	TEST_ASSERT_EQUAL_INT(-ENOSPC, no_os_zstd_compress(xml, strlen(xml),
+			      out, sizeof(xml_frame) - 1));
+	/* Nothing is written past dst_len */
+	TEST_ASSERT_EQUAL_HEX8(0xAA, out[sizeof(xml_frame) - 1]);
+}
+
+void test_zstd_incompressible_raw_block(void)
+{
+	static uint8_t src[RAND_LEN];
+	uint32_t seed = 1;
+	uint32_t i;
+
+	for (i = 0; i < RAND_LEN; i++) {
+		seed = seed * 1103515245 + 12345;
+		src[i] = seed >> 16;
+	}
+
+	/* One raw block: the input follows the two headers unchanged */
+	TEST_ASSERT_EQUAL_INT32(FRAME_HDR + BLOCK_HDR + RAND_LEN,
+				no_os_zstd_compress(src, RAND_LEN, out,
+						NO_OS_ZSTD_BOUND(RAND_LEN)));
+	TEST_ASSERT_EQUAL_HEX8((RAND_LEN << 3 | 1) & 0xFF, out[FRAME_HDR]);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY(src, out + FRAME_HDR + BLOCK_HDR,
+				     RAND_LEN);
+}
+
+void test_zstd_multiple_blocks(void)
+{
+	static uint8_t src[LONG_LEN];
+	int32_t ret;
+
+	memset(src, 'x', sizeof(src));
+
+	ret = no_os_zstd_compress(src, LONG_LEN, out, sizeof(out));
+	TEST_ASSERT_GREATER_THAN_INT32(FRAME_HDR, ret);
+	TEST_ASSERT_LESS_THAN_INT32(LONG_LEN / 100, ret);
+	TEST_ASSERT_EQUAL_HEX8_ARRAY("\x28\xb5\x2f\xfd\xa0\xe0\x93\x04\x00",
+				     out, FRAME_HDR);
+	/* The first block is not the last one */
+	TEST_ASSERT_EQUAL_HEX8(0, out[FRAME_HDR] & 1);
+}
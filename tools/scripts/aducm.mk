@@ -76,6 +76,10 @@ DFP_IGNORED_FILES += $(DFP_DRIVERS)/flash/adi_flash_data.c $(DFP_DRIVERS)/rtc/ad
 
 PLATFORM_SRCS += $(filter-out $(DFP_IGNORED_FILES), $(DFP_FILES))
 
+# Callback dispatch table used by aducm3029_irq.c
+SRCS += $(NO-OS)/util/no_os_irq_table.c
+INCS += $(INCLUDE)/no_os_irq_table.h
+
 PLATFORM_INCS = -I"$(ADUCM_DFP)/Include"
 PLATFORM_INCS += -I"$(CMSIS_CORE)/Include"
 PIN_MUX = $(PROJECT)/pinmux_config.c
@@ -174,6 +174,10 @@ ifeq (y,$(strip $(DISABLE_SECURE_SOCKET)))
 CFLAGS += -DDISABLE_SECURE_SOCKET
 endif
 
+ifeq (y,$(strip $(NO_OS_ALLOC_POOLS)))
+CFLAGS += -DNO_OS_ALLOC_POOLS
+endif
+
 SRC_DIRS := $(patsubst %/,%,$(SRC_DIRS))
 
 # Get all .c, .cpp and .h files from SRC_DIRS
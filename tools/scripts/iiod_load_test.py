@@ -0,0 +1,117 @@
+#!/bin/python
+
+import argparse
+import socket
+import statistics
+import threading
+import time
+
+description_help='''Load test for the no-OS iiod server
+Opens many simultaneous clients to an iiod server (e.g. an iio project built
+with PLATFORM=linux) and measures the latency of the commands they send.
+Examples:\n
+	Run 20 clients sending VERSION and PRINT for 10 seconds
+	>python iiod_load_test.py -clients=20 -time=10
+	Read a device attribute from 50 clients
+	>python iiod_load_test.py -clients=50 -cmd="READ iio:device0 sample_rate"
+'''
+
+def recv_line(sock):
+	line = b''
+	while not line.endswith(b'\n'):
+		data = sock.recv(1)
+		if not data:
+			raise ConnectionError('Connection closed by server')
+		line += data
+	return line.strip()
+
+def recv_exact(sock, size):
+	data = b''
+	while len(data) < size:
+		chunk = sock.recv(size - len(data))
+		if not chunk:
+			raise ConnectionError('Connection closed by server')
+		data += chunk
+	return data
+
+def run_cmd(sock, cmd):
+	sock.sendall(cmd.encode() + b'\n')
+	if cmd == 'VERSION':
+		return recv_line(sock)
+	ret = int(recv_line(sock))
+	if ret > 0 and cmd.split()[0] in ('PRINT', 'READ'):
+		# Payload is followed by a new line
+		recv_exact(sock, ret + 1)
+	return ret
+
+def client(args, idx, stats, lock, stop):
+	latencies = []
+	errors = 0
+	try:
+		sock = socket.create_connection((args.host, args.port), timeout=5)
+	except OSError:
+		with lock:
+			stats['refused'] += 1
+		return
+
+	with sock:
+		while not stop.is_set():
+			for cmd in args.cmd:
+				start = time.perf_counter()
+				try:
+					run_cmd(sock, cmd)
+				except (OSError, ValueError, ConnectionError):
+					errors += 1
+					stop.wait(0.1)
+					break
+				latencies.append(time.perf_counter() - start)
+		try:
+			sock.sendall(b'EXIT\n')
+		except OSError:
+			pass
+
+	with lock:
+		stats['latencies'] += latencies
+		stats['errors'] += errors
+
+def main():
+	parser = argparse.ArgumentParser(description=description_help,
+					 formatter_class=argparse.RawTextHelpFormatter)
+	parser.add_argument('-host', default='127.0.0.1', help='iiod address')
+	parser.add_argument('-port', type=int, default=30431, help='iiod port')
+	parser.add_argument('-clients', type=int, default=10,
+			    help='Number of simultaneous clients')
+	parser.add_argument('-time', type=float, default=5,
+			    help='Test duration in seconds')
+	parser.add_argument('-cmd', action='append',
+			    help='Command sent by each client in a loop. '
+				 'Can be used multiple times (default VERSION, PRINT)')
+	args = parser.parse_args()
+	if not args.cmd:
+		args.cmd = ['VERSION', 'PRINT']
+
+	stats = {'latencies': [], 'errors': 0, 'refused': 0}
+	lock = threading.Lock()
+	stop = threading.Event()
+	threads = [threading.Thread(target=client,
+				    args=(args, i, stats, lock, stop))
+		   for i in range(args.clients)]
+	for t in threads:
+		t.start()
+	time.sleep(args.time)
+	stop.set()
+	for t in threads:
+		t.join()
+
+	lat = sorted(stats['latencies'])
+	print('clients: %d refused: %d errors: %d' %
+	      (args.clients, stats['refused'], stats['errors']))
+	if not lat:
+		return
+	print('commands: %d (%.1f cmd/s)' % (len(lat), len(lat) / args.time))
+	print('latency ms: mean %.3f median %.3f p99 %.3f max %.3f' %
+	      (statistics.mean(lat) * 1e3, statistics.median(lat) * 1e3,
+	       lat[int(len(lat) * 0.99)] * 1e3, lat[-1] * 1e3))
+
+if __name__ == '__main__':
+	main()
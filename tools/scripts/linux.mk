@@ -8,6 +8,9 @@ PROJECT_BUILD = $(BUILD_DIR)/app
 CFLAGS +=  -g3 \
 		-DLINUX_PLATFORM \
 
+# linux_spi runs the asynchronous transfers in a worker thread
+LIB_FLAGS += -lpthread
+
 $(PLATFORM)_project:
 	$(call mk_dir, $(BUILD_DIR)) $(HIDE)
 
@@ -94,6 +94,10 @@ SRC_TMP = $(foreach src,$(PERIPH_DRIVER_C_FILES),$(word 2,$(subst PeriphDrivers,
 DRIVER_C_FILES = $(foreach src,$(SRC_TMP),$(addprefix $(MAXIM_LIBRARIES)/PeriphDrivers,$(src)))
 
 SRCS += $(DRIVER_C_FILES)
+
+# Callback dispatch table used by maxim_irq.c and maxim_gpio_irq.c
+SRCS += $(NO-OS)/util/no_os_irq_table.c
+INCS += $(INCLUDE)/no_os_irq_table.h
 INCLUDE_DIR_TMP = $(foreach src,$(PERIPH_DRIVER_INCLUDE_DIR),$(word 2,$(subst PeriphDrivers, ,$(src))))
 DRIVER_INCLUDE_DIR = $(foreach src,$(INCLUDE_DIR_TMP),$(addprefix $(MAXIM_LIBRARIES)/PeriphDrivers,$(src)))
 
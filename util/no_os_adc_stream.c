@@ -0,0 +1,338 @@
+/***************************************************************************//**
+ *   @file   no_os_adc_stream.c
+ *   @brief  DRDY driven continuous-read streaming engine for sigma-delta ADCs.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include "no_os_adc_stream.h"
+#include "no_os_error.h"
+#include "no_os_alloc.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Account a frame read into the active half, hand the half over to
+ * the consumer when it is full and re-arm the DRDY interrupt.
+ * @param ctx - Stream descriptor.
+ */
+static void no_os_adc_stream_frame_done(void *ctx)
+{
+	struct no_os_adc_stream_desc *desc = ctx;
+
+	desc->stats.frames++;
+	if (++desc->fill == desc->block_size) {
+		desc->fill = 0;
+		desc->ready[desc->active] = true;
+		desc->active ^= 1;
+	}
+
+	if (desc->running)
+		no_os_irq_enable(desc->irq_ctrl, desc->drdy_irq);
+}
+
+/**
+ * @brief DRDY interrupt handler, reads one frame into the active half.
+ * @param ctx - Stream descriptor.
+ */
+static void no_os_adc_stream_drdy(void *ctx)
+{
+	struct no_os_adc_stream_desc *desc = ctx;
+	uint8_t *frame;
+	int ret;
+
+	/*
+	 * Both halves wait to be decoded, skip the conversion. The converter
+	 * overwrites its data register with the next one anyway.
+	 */
+	if (desc->ready[desc->active]) {
+		desc->stats.dropped++;
+		return;
+	}
+
+	/*
+	 * DRDY is usually multiplexed on the data output, so it stays masked
+	 * until the frame is read out.
+	 */
+	no_os_irq_disable(desc->irq_ctrl, desc->drdy_irq);
+
+	frame = desc->frames[desc->active] + desc->fill * desc->frame_size;
+	memcpy(frame, desc->cmd, desc->cmd_size);
+	memset(frame + desc->cmd_size, 0, desc->frame_size - desc->cmd_size);
+
+	desc->msg.tx_buff = frame;
+	desc->msg.rx_buff = frame;
+	desc->msg.bytes_number = desc->frame_size;
+
+	if (desc->dma) {
+		ret = no_os_spi_transfer_dma_async(desc->spi_desc, &desc->msg,
+						   1,
+						   no_os_adc_stream_frame_done,
+						   desc);
+		if (!ret)
+			return;
+		/* Fall back to blocking transfers if the platform has no DMA */
+		if (ret == -ENOSYS)
+			desc->dma = false;
+	}
+
+	ret = no_os_spi_transfer(desc->spi_desc, &desc->msg, 1);
+	if (ret) {
+		/* Keep the slot, the frame is read again on the next DRDY */
+		if (desc->running)
+			no_os_irq_enable(desc->irq_ctrl, desc->drdy_irq);
+		return;
+	}
+
+	no_os_adc_stream_frame_done(desc);
+}
+
+/**
+ * @brief Initialize the streaming engine.
+ * @param desc - Pointer to the stream descriptor pointer.
+ * @param param - Initialization parameters.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_adc_stream_init(struct no_os_adc_stream_desc **desc,
+			  struct no_os_adc_stream_init_param *param)
+{
+	struct no_os_adc_stream_desc *d;
+	int ret;
+
+	if (!desc || !param || !param->spi_desc || !param->irq_ctrl ||
+	    !param->decode || !param->sink || !param->block_size)
+		return -EINVAL;
+
+	if (param->cmd_size > NO_OS_ADC_STREAM_CMD_MAX ||
+	    param->frame_size <= param->cmd_size ||
+	    param->frame_size > NO_OS_ADC_STREAM_FRAME_MAX)
+		return -EINVAL;
+
+	d = no_os_calloc(1, sizeof(*d));
+	if (!d)
+		return -ENOMEM;
+
+	/* Both halves in one allocation, the second one follows the first */
+	d->frames[0] = no_os_calloc(2 * param->block_size, param->frame_size);
+	if (!d->frames[0]) {
+		ret = -ENOMEM;
+		goto free_desc;
+	}
+	d->frames[1] = d->frames[0] + param->block_size * param->frame_size;
+
+	d->samples = no_os_calloc(param->block_size, sizeof(*d->samples));
+	if (!d->samples) {
+		ret = -ENOMEM;
+		goto free_frames;
+	}
+
+	d->spi_desc = param->spi_desc;
+	d->irq_ctrl = param->irq_ctrl;
+	d->drdy_irq = param->drdy_irq;
+	memcpy(d->cmd, param->cmd, param->cmd_size);
+	d->cmd_size = param->cmd_size;
+	d->frame_size = param->frame_size;
+	d->block_size = param->block_size;
+	d->dma = param->dma;
+	d->dev = param->dev;
+	d->decode = param->decode;
+	d->sink = param->sink;
+
+	d->irq_cb.callback = no_os_adc_stream_drdy;
+	d->irq_cb.ctx = d;
+	d->irq_cb.event = NO_OS_EVT_GPIO;
+	d->irq_cb.peripheral = NO_OS_GPIO_IRQ;
+
+	ret = no_os_irq_register_callback(d->irq_ctrl, d->drdy_irq, &d->irq_cb);
+	if (ret)
+		goto free_samples;
+
+	ret = no_os_irq_trigger_level_set(d->irq_ctrl, d->drdy_irq,
+					  param->drdy_trig);
+	if (ret)
+		goto unregister;
+
+	*desc = d;
+
+	return 0;
+
+unregister:
+	no_os_irq_unregister_callback(d->irq_ctrl, d->drdy_irq, &d->irq_cb);
+free_samples:
+	no_os_free(d->samples);
+free_frames:
+	no_os_free(d->frames[0]);
+free_desc:
+	no_os_free(d);
+
+	return ret;
+}
+
+/**
+ * @brief Stop the stream and free the resources allocated by
+ * no_os_adc_stream_init().
+ * @param desc - Stream descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_adc_stream_remove(struct no_os_adc_stream_desc *desc)
+{
+	int ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	ret = no_os_adc_stream_stop(desc);
+	if (ret)
+		return ret;
+
+	ret = no_os_irq_unregister_callback(desc->irq_ctrl, desc->drdy_irq,
+					    &desc->irq_cb);
+	if (ret)
+		return ret;
+
+	no_os_free(desc->samples);
+	no_os_free(desc->frames[0]);
+	no_os_free(desc);
+
+	return 0;
+}
+
+/**
+ * @brief Start streaming. The converter must already be in continuous
+ * conversion (and continuous read, if used) mode.
+ * @param desc - Stream descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_adc_stream_start(struct no_os_adc_stream_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	if (desc->running)
+		return 0;
+
+	desc->active = 0;
+	desc->fill = 0;
+	desc->ready[0] = false;
+	desc->ready[1] = false;
+	desc->next = 0;
+	desc->running = true;
+
+	return no_os_irq_enable(desc->irq_ctrl, desc->drdy_irq);
+}
+
+/**
+ * @brief Stop streaming. Completed blocks can still be processed, the
+ * partially filled one is dropped.
+ * @param desc - Stream descriptor.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_adc_stream_stop(struct no_os_adc_stream_desc *desc)
+{
+	if (!desc)
+		return -EINVAL;
+
+	desc->running = false;
+
+	return no_os_irq_disable(desc->irq_ctrl, desc->drdy_irq);
+}
+
+/**
+ * @brief Decode the completed blocks and push the samples to the sink. Must
+ * be called from thread context at least once every block period, otherwise
+ * conversions are skipped until a half is free again.
+ * @param desc - Stream descriptor.
+ * @return Number of blocks processed, negative error code otherwise.
+ */
+int no_os_adc_stream_process(struct no_os_adc_stream_desc *desc)
+{
+	int32_t nb;
+	int ret = 0;
+
+	if (!desc)
+		return -EINVAL;
+
+	while (desc->ready[desc->next]) {
+		nb = desc->decode(desc->dev, desc->frames[desc->next],
+				  desc->frame_size, desc->block_size,
+				  desc->samples);
+		if (nb < 0)
+			return nb;
+
+		desc->stats.invalid += desc->block_size - nb;
+
+		/* The sink keeps the newest data if the reader falls behind */
+		if (nb) {
+			nb = no_os_cb_write(desc->sink, desc->samples,
+					    nb * sizeof(*desc->samples));
+			if (nb)
+				return nb;
+		}
+
+		desc->stats.blocks++;
+		desc->ready[desc->next] = false;
+		desc->next ^= 1;
+		ret++;
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Get the streaming statistics.
+ * @param desc - Stream descriptor.
+ * @param stats - Output statistics.
+ * @param clear - Reset the statistics after reading them.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_adc_stream_stats_get(struct no_os_adc_stream_desc *desc,
+			       struct no_os_adc_stream_stats *stats,
+			       bool clear)
+{
+	if (!desc || !stats)
+		return -EINVAL;
+
+	*stats = desc->stats;
+	if (clear)
+		memset(&desc->stats, 0, sizeof(desc->stats));
+
+	return 0;
+}
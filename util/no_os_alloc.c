@@ -37,7 +37,480 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 
+#include <errno.h>
+#include <string.h>
 #include "no_os_alloc.h"
+#include "no_os_util.h"
+
+/**
+ * @struct no_os_alloc_pool
+ * @brief Fixed-block pool, the free blocks are linked through their first
+ * word.
+ */
+struct no_os_alloc_pool {
+	uint8_t *start;
+	uint8_t *end;
+	void *free_list;
+	struct no_os_alloc_stats stats;
+};
+
+/**
+ * @struct no_os_alloc_state
+ * @brief State of the deterministic allocator.
+ */
+struct no_os_alloc_state {
+	struct no_os_alloc_pool pools[NO_OS_ALLOC_MAX_POOLS];
+	uint32_t nb_pools;
+	uint8_t *arena;
+	/* Offset of the last arena allocation, it can be given back */
+	uint32_t arena_last;
+	struct no_os_alloc_stats arena_stats;
+	void (*lock)(void *ctx);
+	void (*unlock)(void *ctx);
+	void *lock_ctx;
+	void (*seal_failure)(size_t size);
+	bool active;
+	bool sealed;
+};
+
+static struct no_os_alloc_state alloc_state;
+
+static inline uint32_t no_os_alloc_round(uint32_t size)
+{
+	return (size + NO_OS_ALLOC_ALIGN - 1) & ~(NO_OS_ALLOC_ALIGN - 1);
+}
+
+static void no_os_alloc_lock(void)
+{
+	if (alloc_state.lock)
+		alloc_state.lock(alloc_state.lock_ctx);
+}
+
+static void no_os_alloc_unlock(void)
+{
+	if (alloc_state.unlock)
+		alloc_state.unlock(alloc_state.lock_ctx);
+}
+
+/**
+ * @brief Take a block from the smallest non empty class that fits.
+ * @param size - Size of the request, in bytes.
+ * @return Pointer to the block, or NULL if all the fitting classes are empty.
+ */
+static void *no_os_alloc_pool_get(size_t size)
+{
+	struct no_os_alloc_pool *pool;
+	struct no_os_alloc_pool *fit = NULL;
+	void *block;
+	uint32_t i;
+
+	for (i = 0; i < alloc_state.nb_pools; i++) {
+		pool = &alloc_state.pools[i];
+		if (pool->stats.block_size < size)
+			continue;
+		if (!fit)
+			fit = pool;
+		if (!pool->free_list)
+			continue;
+
+		block = pool->free_list;
+		pool->free_list = *(void **)block;
+		pool->stats.used++;
+		if (pool->stats.used > pool->stats.high_water)
+			pool->stats.high_water = pool->stats.used;
+
+		return block;
+	}
+
+	/* Accounted on the class the request belongs to */
+	if (fit)
+		fit->stats.failures++;
+
+	return NULL;
+}
+
+/**
+ * @brief Bump allocation from the arena.
+ * @param size - Size of the request, in bytes.
+ * @return Pointer to the memory, or NULL if the arena is full or sealed.
+ */
+static void *no_os_alloc_arena_get(size_t size)
+{
+	struct no_os_alloc_stats *stats = &alloc_state.arena_stats;
+	uint32_t offset = stats->used;
+
+	if (alloc_state.sealed ||
+	    size > stats->nb_blocks - offset ||
+	    no_os_alloc_round(size) > stats->nb_blocks - offset)
+		return NULL;
+
+	stats->used += no_os_alloc_round(size);
+	if (stats->used > stats->high_water)
+		stats->high_water = stats->used;
+	alloc_state.arena_last = offset;
+
+	return alloc_state.arena + offset;
+}
+
+/**
+ * @brief Serve a request from the arena until sealed, then from the pools.
+ * @param size - Size of the request, in bytes.
+ * @return Pointer to the memory, or NULL if the request fails.
+ */
+static void *no_os_alloc_get(size_t size)
+{
+	bool sealed;
+	void *ptr;
+
+	if (!size)
+		size = 1;
+
+	no_os_alloc_lock();
+	ptr = no_os_alloc_arena_get(size);
+	if (!ptr)
+		ptr = no_os_alloc_pool_get(size);
+	if (!ptr)
+		alloc_state.arena_stats.failures++;
+	sealed = alloc_state.sealed;
+	no_os_alloc_unlock();
+
+	if (!ptr && sealed && alloc_state.seal_failure)
+		alloc_state.seal_failure(size);
+
+	return ptr;
+}
+
+/**
+ * @brief Resize memory that belongs to the pools or to the arena in place.
+ *
+ * A pool block keeps any size up to its block size. The last arena
+ * allocation grows or shrinks while the arena is open.
+ * @param ptr - Pointer to the memory.
+ * @param size - New size, in bytes.
+ * @param avail - Set to the number of bytes that can be read from ptr.
+ * @return 1 if the memory was resized in place, 0 if it has to move, -ENOENT
+ * if it comes from libc.
+ */
+static int no_os_alloc_resize(void *ptr, size_t size, size_t *avail)
+{
+	struct no_os_alloc_stats *stats = &alloc_state.arena_stats;
+	struct no_os_alloc_pool *pool;
+	uint8_t *p = ptr;
+	uint32_t offset;
+	uint32_t i;
+	int ret = 0;
+
+	if (p >= alloc_state.arena &&
+	    p < alloc_state.arena + stats->nb_blocks) {
+		offset = p - alloc_state.arena;
+
+		no_os_alloc_lock();
+		if (offset == alloc_state.arena_last && offset < stats->used &&
+		    !alloc_state.sealed && size <= stats->nb_blocks - offset &&
+		    no_os_alloc_round(size) <= stats->nb_blocks - offset) {
+			stats->used = offset + no_os_alloc_round(size);
+			if (stats->used > stats->high_water)
+				stats->high_water = stats->used;
+			ret = 1;
+		}
+		/* The size of an arena allocation isn't kept, only bounded */
+		*avail = offset < stats->used ? stats->used - offset : 0;
+		no_os_alloc_unlock();
+
+		return ret;
+	}
+
+	for (i = 0; i < alloc_state.nb_pools; i++) {
+		pool = &alloc_state.pools[i];
+		if (p < pool->start || p >= pool->end)
+			continue;
+
+		*avail = pool->stats.block_size;
+
+		return size <= pool->stats.block_size;
+	}
+
+	return -ENOENT;
+}
+
+/**
+ * @brief Give back memory that belongs to the pools or to the arena.
+ * @param ptr - Pointer to the memory.
+ * @return true if the memory was handled, false if it comes from libc.
+ */
+static bool no_os_alloc_put(void *ptr)
+{
+	struct no_os_alloc_stats *stats = &alloc_state.arena_stats;
+	struct no_os_alloc_pool *pool;
+	uint8_t *p = ptr;
+	uint32_t i;
+
+	if (p >= alloc_state.arena &&
+	    p < alloc_state.arena + stats->nb_blocks) {
+		/* Only the last allocation can be given back */
+		no_os_alloc_lock();
+		if (p == alloc_state.arena + alloc_state.arena_last &&
+		    alloc_state.arena_last < stats->used)
+			stats->used = alloc_state.arena_last;
+		else
+			stats->invalid_frees++;
+		no_os_alloc_unlock();
+
+		return true;
+	}
+
+	for (i = 0; i < alloc_state.nb_pools; i++) {
+		pool = &alloc_state.pools[i];
+		if (p < pool->start || p >= pool->end)
+			continue;
+
+		no_os_alloc_lock();
+		*(void **)ptr = pool->free_list;
+		pool->free_list = ptr;
+		pool->stats.used--;
+		no_os_alloc_unlock();
+
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Serve no_os_alloc_malloc/no_os_alloc_calloc from fixed-block pools
+ * and an arena.
+ *
+ * The memory allocated from libc before this call may still be given to
+ * no_os_alloc_free().
+ *
+ * @param param - Backing memory and size classes.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_alloc_init(const struct no_os_alloc_init_param *param)
+{
+	struct no_os_alloc_state state = {0};
+	struct no_os_alloc_pool *pool;
+	uint32_t block_size;
+	uint32_t offset = 0;
+	uint8_t *mem;
+	uint32_t i, j;
+
+	if (!param || !param->mem || param->nb_pools > NO_OS_ALLOC_MAX_POOLS ||
+	    (param->nb_pools && !param->pools) ||
+	    !param->lock != !param->unlock ||
+	    ((uintptr_t)param->mem & (NO_OS_ALLOC_ALIGN - 1)))
+		return -EINVAL;
+
+	if (alloc_state.active)
+		return -EBUSY;
+
+	mem = param->mem;
+	for (i = 0; i < param->nb_pools; i++) {
+		pool = &state.pools[i];
+		block_size = no_os_alloc_round(no_os_max_t(uint32_t,
+					       param->pools[i].block_size,
+					       sizeof(void *)));
+		if (i && block_size <= state.pools[i - 1].stats.block_size)
+			return -EINVAL;
+		if (param->pools[i].nb_blocks >
+		    (param->mem_size - offset) / block_size)
+			return -ENOMEM;
+
+		pool->start = mem + offset;
+		offset += block_size * param->pools[i].nb_blocks;
+		pool->end = mem + offset;
+		pool->stats.block_size = block_size;
+		pool->stats.nb_blocks = param->pools[i].nb_blocks;
+
+		for (j = pool->stats.nb_blocks; j; j--) {
+			*(void **)(pool->start + (j - 1) * block_size) =
+				pool->free_list;
+			pool->free_list = pool->start + (j - 1) * block_size;
+		}
+	}
+	state.nb_pools = param->nb_pools;
+
+	state.arena = mem + offset;
+	state.arena_stats.block_size = 1;
+	state.arena_stats.nb_blocks = (param->mem_size - offset) &
+				      ~(NO_OS_ALLOC_ALIGN - 1);
+	state.arena_last = state.arena_stats.nb_blocks;
+
+	state.lock = param->lock;
+	state.unlock = param->unlock;
+	state.lock_ctx = param->lock_ctx;
+	state.seal_failure = param->seal_failure;
+	state.active = true;
+	alloc_state = state;
+
+	return 0;
+}
+
+/**
+ * @brief Go back to the libc allocator.
+ *
+ * The arena memory is dropped, it must not be used anymore.
+ *
+ * @return 0 in case of success, -EBUSY if pool blocks are still in use.
+ */
+int no_os_alloc_remove(void)
+{
+	uint32_t i;
+
+	if (!alloc_state.active)
+		return 0;
+
+	for (i = 0; i < alloc_state.nb_pools; i++)
+		if (alloc_state.pools[i].stats.used)
+			return -EBUSY;
+
+	memset(&alloc_state, 0, sizeof(alloc_state));
+
+	return 0;
+}
+
+/**
+ * @brief Close the arena at the end of the initialization.
+ *
+ * From now on the allocations come only from the pools. A request the pools
+ * cannot serve fails, is counted in the arena failures and is reported to the
+ * seal_failure callback of the init parameters.
+ *
+ * @return None.
+ */
+void no_os_alloc_seal(void)
+{
+	no_os_alloc_lock();
+	alloc_state.sealed = true;
+	no_os_alloc_unlock();
+}
+
+/**
+ * @brief Get the statistics of a pool.
+ * @param pool - Index of the size class.
+ * @param stats - Filled with the statistics.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_alloc_pool_stats(uint32_t pool, struct no_os_alloc_stats *stats)
+{
+	if (!stats || pool >= alloc_state.nb_pools)
+		return -EINVAL;
+
+	no_os_alloc_lock();
+	*stats = alloc_state.pools[pool].stats;
+	no_os_alloc_unlock();
+
+	return 0;
+}
+
+/**
+ * @brief Get the statistics of the arena, in bytes.
+ * @param stats - Filled with the statistics.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int no_os_alloc_arena_stats(struct no_os_alloc_stats *stats)
+{
+	if (!stats || !alloc_state.active)
+		return -EINVAL;
+
+	no_os_alloc_lock();
+	*stats = alloc_state.arena_stats;
+	no_os_alloc_unlock();
+
+	return 0;
+}
+
+/**
+ * @brief Allocate memory from the pools or the arena, from libc if
+ * no_os_alloc_init() wasn't called.
+ * @param size - Size of the memory block, in bytes.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+void *no_os_alloc_malloc(size_t size)
+{
+	if (alloc_state.active)
+		return no_os_alloc_get(size);
+
+	return malloc(size);
+}
+
+/**
+ * @brief Allocate zeroed memory from the pools or the arena, from libc if
+ * no_os_alloc_init() wasn't called.
+ * @param nitems - Number of elements to be allocated.
+ * @param size - Size of elements.
+ * @return Pointer to the allocated memory, or NULL if the request fails.
+ */
+void *no_os_alloc_calloc(size_t nitems, size_t size)
+{
+	void *ptr;
+
+	if (!alloc_state.active)
+		return calloc(nitems, size);
+
+	if (size && nitems > SIZE_MAX / size)
+		return NULL;
+
+	ptr = no_os_alloc_get(nitems * size);
+	if (ptr)
+		memset(ptr, 0, nitems * size);
+
+	return ptr;
+}
+
+/**
+ * @brief Resize memory allocated by no_os_alloc_malloc or no_os_alloc_calloc,
+ * from libc if no_os_alloc_init() wasn't called.
+ *
+ * The memory is resized in place when possible. Otherwise new memory is
+ * allocated, the content is copied and the old memory is given back.
+ * @param ptr - Pointer to the memory block, NULL to allocate a new one.
+ * @param size - New size, in bytes.
+ * @return Pointer to the resized memory, or NULL if the request fails, in which
+ * case ptr is left untouched.
+ */
+void *no_os_alloc_realloc(void *ptr, size_t size)
+{
+	size_t avail = 0;
+	void *new_ptr;
+	int ret;
+
+	if (!alloc_state.active)
+		return realloc(ptr, size);
+
+	if (!ptr)
+		return no_os_alloc_get(size);
+
+	ret = no_os_alloc_resize(ptr, size, &avail);
+	if (ret == -ENOENT)
+		return realloc(ptr, size);
+	if (ret)
+		return ptr;
+
+	new_ptr = no_os_alloc_get(size);
+	if (!new_ptr)
+		return NULL;
+
+	memcpy(new_ptr, ptr, no_os_min(avail, size));
+	no_os_alloc_put(ptr);
+
+	return new_ptr;
+}
+
+/**
+ * @brief Give back memory allocated by no_os_alloc_malloc or
+ * no_os_alloc_calloc. Arena memory other than the last allocation is not
+ * given back and is counted in the arena invalid_frees.
+ * @param ptr - Pointer to the memory block.
+ * @return None.
+ */
+void no_os_alloc_free(void *ptr)
+{
+	if (alloc_state.active && ptr && no_os_alloc_put(ptr))
+		return;
+
+	free(ptr);
+}
 
 /**
  * @brief Allocate memory and return a pointer to it.
@@ -46,7 +519,11 @@
  */
 __attribute__((weak)) void *no_os_malloc(size_t size)
 {
+#ifdef NO_OS_ALLOC_POOLS
+	return no_os_alloc_malloc(size);
+#else
 	return malloc(size);
+#endif
 }
 
 /**
@@ -57,7 +534,27 @@ __attribute__((weak)) void *no_os_malloc(size_t size)
  */
 __attribute__((weak)) void *no_os_calloc(size_t nitems, size_t size)
 {
+#ifdef NO_OS_ALLOC_POOLS
+	return no_os_alloc_calloc(nitems, size);
+#else
 	return calloc(nitems, size);
+#endif
+}
+
+/**
+ * @brief Change the size of memory allocated by no_os_malloc or no_os_calloc.
+ * @param ptr - Pointer to the memory block, NULL to allocate a new one.
+ * @param size - New size, in bytes.
+ * @return Pointer to the resized memory, or NULL if the request fails, in which
+ * case ptr is left untouched.
+ */
+__attribute__((weak)) void *no_os_realloc(void *ptr, size_t size)
+{
+#ifdef NO_OS_ALLOC_POOLS
+	return no_os_alloc_realloc(ptr, size);
+#else
+	return realloc(ptr, size);
+#endif
 }
 
 /**
@@ -69,5 +566,9 @@ __attribute__((weak)) void *no_os_calloc(size_t nitems, size_t size)
  */
 __attribute__((weak)) void no_os_free(void *ptr)
 {
+#ifdef NO_OS_ALLOC_POOLS
+	no_os_alloc_free(ptr);
+#else
 	free(ptr);
+#endif
 }
@@ -40,13 +40,95 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#include <string.h>
 #include "no_os_alloc.h"
 #include "no_os_error.h"
 #include "no_os_clk.h"
 
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* Entry of a no_os_clk_set_rates() solution. */
+struct no_os_clk_plan {
+	struct no_os_clk_desc *desc;
+	uint64_t rate;
+	uint32_t depth;
+	bool done;
+};
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
+/**
+ * @brief Remove a clock from the children list of its parent.
+ * @param desc - The clock descriptor.
+ */
+static void no_os_clk_unlink(struct no_os_clk_desc *desc)
+{
+	struct no_os_clk_desc **it;
+
+	if (!desc->parent)
+		return;
+
+	for (it = &desc->parent->child; *it; it = &(*it)->sibling) {
+		if (*it == desc) {
+			*it = desc->sibling;
+			break;
+		}
+	}
+	desc->parent = NULL;
+	desc->sibling = NULL;
+}
+
+/**
+ * @brief Add a clock to the children list of a parent.
+ * @param desc - The clock descriptor.
+ * @param parent - The new parent, may be NULL.
+ */
+static void no_os_clk_link(struct no_os_clk_desc *desc,
+			   struct no_os_clk_desc *parent)
+{
+	desc->parent = parent;
+	if (!parent)
+		return;
+
+	desc->sibling = parent->child;
+	parent->child = desc;
+}
+
+/**
+ * @brief Number of ancestors of a clock.
+ * @param desc - The clock descriptor.
+ * @return The depth of the clock in its tree, 0 for a root clock.
+ */
+static uint32_t no_os_clk_depth(struct no_os_clk_desc *desc)
+{
+	uint32_t depth = 0;
+
+	while (desc->parent) {
+		desc = desc->parent;
+		depth++;
+	}
+
+	return depth;
+}
+
+/**
+ * @brief Check if a clock is an ancestor of another one.
+ * @param ancestor - The candidate ancestor.
+ * @param desc - The clock descriptor.
+ * @return true if ancestor is the parent of desc or one of its ancestors.
+ */
+static bool no_os_clk_is_ancestor(struct no_os_clk_desc *ancestor,
+				  struct no_os_clk_desc *desc)
+{
+	for (desc = desc->parent; desc; desc = desc->parent)
+		if (desc == ancestor)
+			return true;
+
+	return false;
+}
+
 /**
  * Initialize clock.
  * @param desc - CLK descriptor.
@@ -70,6 +152,8 @@ int32_t no_os_clk_init(struct no_os_clk_desc **desc,
 	clk->hw_ch_num = param->hw_ch_num;
 	clk->dev_desc = param->dev_desc;
 	clk->platform_ops = param->platform_ops;
+	clk->flags = param->flags;
+	no_os_clk_link(clk, param->parent);
 
 	if (param->platform_ops->init) {
 		ret = param->platform_ops->init(desc, param);
@@ -82,6 +166,7 @@ int32_t no_os_clk_init(struct no_os_clk_desc **desc,
 	return 0;
 
 error:
+	no_os_clk_unlink(clk);
 	no_os_free(clk);
 
 	return ret;
@@ -94,6 +179,7 @@ error:
  */
 int32_t no_os_clk_remove(struct no_os_clk_desc *desc)
 {
+	struct no_os_clk_desc *child;
 	int ret;
 
 	if (!desc || !desc->platform_ops)
@@ -105,6 +191,16 @@ int32_t no_os_clk_remove(struct no_os_clk_desc *desc)
 			return ret;
 	}
 
+	/* The children become root clocks */
+	while (desc->child) {
+		child = desc->child;
+		desc->child = child->sibling;
+		child->parent = NULL;
+		child->sibling = NULL;
+		no_os_clk_invalidate(child);
+	}
+	no_os_clk_unlink(desc);
+
 	no_os_free(desc);
 
 	return 0;
@@ -151,13 +247,31 @@ int32_t no_os_clk_disable(struct no_os_clk_desc *desc)
 int32_t no_os_clk_recalc_rate(struct no_os_clk_desc *desc,
 			      uint64_t *rate)
 {
+	int ret;
+
 	if (!desc || !desc->platform_ops || !rate)
 		return -EINVAL;
 
+	if ((desc->flags & NO_OS_CLK_CACHE_RATE) && desc->rate_valid) {
+		desc->stats.cached_reads++;
+		*rate = desc->rate;
+		return 0;
+	}
+
 	if (!desc->platform_ops->clk_recalc_rate)
 		return -ENOSYS;
 
-	return desc->platform_ops->clk_recalc_rate(desc, rate);
+	desc->stats.hw_reads++;
+	ret = desc->platform_ops->clk_recalc_rate(desc, rate);
+	if (ret)
+		return ret;
+
+	if (desc->flags & NO_OS_CLK_CACHE_RATE) {
+		desc->rate = *rate;
+		desc->rate_valid = true;
+	}
+
+	return 0;
 }
 
 /**
@@ -181,7 +295,9 @@ int32_t no_os_clk_round_rate(struct no_os_clk_desc *desc,
 }
 
 /**
- * Change the frequency of the clock.
+ * Change the frequency of the clock. The request is skipped if the cached rate
+ * of the clock is already the desired one. The cached rates of the clock and of
+ * its descendants are dropped otherwise.
  * @param clk - The clock descriptor.
  * @param rate - The desired frequency.
  * @return 0 in case of success, negative error code otherwise.
@@ -189,11 +305,263 @@ int32_t no_os_clk_round_rate(struct no_os_clk_desc *desc,
 int32_t no_os_clk_set_rate(struct no_os_clk_desc *desc,
 			   uint64_t rate)
 {
+	int ret;
+
 	if (!desc || !desc->platform_ops)
 		return -EINVAL;
 
 	if (!desc->platform_ops->clk_set_rate)
 		return -ENOSYS;
 
-	return desc->platform_ops->clk_set_rate(desc, rate);
+	if ((desc->flags & NO_OS_CLK_CACHE_RATE) && desc->rate_valid &&
+	    desc->rate == rate) {
+		desc->stats.skipped_writes++;
+		return 0;
+	}
+
+	desc->stats.hw_writes++;
+	ret = desc->platform_ops->clk_set_rate(desc, rate);
+	no_os_clk_invalidate(desc);
+
+	return ret;
+}
+
+/**
+ * @brief Build the solution of a no_os_clk_set_rates() request: round all the
+ * rates and drop the clocks that already have the desired rate.
+ * @param plan - The solution, one entry for each clock.
+ * @param descs - The clock descriptors.
+ * @param rates - The desired frequencies.
+ * @param nb_clks - Number of clocks.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int no_os_clk_plan_rates(struct no_os_clk_plan *plan,
+				struct no_os_clk_desc **descs,
+				const uint64_t *rates, uint32_t nb_clks)
+{
+	const struct no_os_clk_platform_ops *ops;
+	struct no_os_clk_desc *desc;
+	uint64_t rounded;
+	uint32_t i, j;
+	bool changed;
+	int ret;
+
+	for (i = 0; i < nb_clks; i++) {
+		desc = descs[i];
+		if (!desc || !desc->platform_ops)
+			return -EINVAL;
+
+		ops = desc->platform_ops;
+		if (!ops->clk_set_rate && !ops->clk_set_rates)
+			return -ENOSYS;
+
+		for (j = 0; j < i; j++)
+			if (descs[j] == desc)
+				return -EINVAL;
+
+		rounded = rates[i];
+		if (ops->clk_round_rate) {
+			ret = ops->clk_round_rate(desc, rates[i], &rounded);
+			if (ret)
+				return ret;
+		}
+
+		plan[i].desc = desc;
+		plan[i].rate = rates[i];
+		plan[i].depth = no_os_clk_depth(desc);
+		plan[i].done = (desc->flags & NO_OS_CLK_CACHE_RATE) &&
+			       desc->rate_valid && desc->rate == rounded;
+	}
+
+	/* A clock whose parent is reprogrammed can't be skipped */
+	do {
+		changed = false;
+		for (i = 0; i < nb_clks; i++) {
+			if (!plan[i].done)
+				continue;
+			for (j = 0; j < nb_clks; j++) {
+				if (plan[j].done ||
+				    !no_os_clk_is_ancestor(plan[j].desc,
+						    plan[i].desc))
+					continue;
+				plan[i].done = false;
+				changed = true;
+				break;
+			}
+		}
+	} while (changed);
+
+	for (i = 0; i < nb_clks; i++)
+		if (plan[i].done)
+			plan[i].desc->stats.skipped_writes++;
+
+	return 0;
+}
+
+/**
+ * Change the frequency of several clocks. The full solution is computed first
+ * and nothing is programmed if one of the rates can't be rounded. The clocks
+ * are then programmed parents first, the clocks of a device that implements
+ * clk_set_rates at the same depth being programmed with a single call.
+ * @param descs - The clock descriptors.
+ * @param rates - The desired frequencies.
+ * @param nb_clks - Number of clocks.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_clk_set_rates(struct no_os_clk_desc **descs,
+			    const uint64_t *rates,
+			    uint32_t nb_clks)
+{
+	const struct no_os_clk_platform_ops *ops;
+	struct no_os_clk_desc **group;
+	struct no_os_clk_plan *plan;
+	uint32_t i, j, depth, nb, left;
+	uint64_t *group_rates;
+	int ret;
+
+	if (!descs || !rates || !nb_clks)
+		return -EINVAL;
+
+	plan = no_os_calloc(nb_clks, sizeof(*plan));
+	group = no_os_calloc(nb_clks, sizeof(*group));
+	group_rates = no_os_calloc(nb_clks, sizeof(*group_rates));
+	if (!plan || !group || !group_rates) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	ret = no_os_clk_plan_rates(plan, descs, rates, nb_clks);
+	if (ret)
+		goto out;
+
+	left = 0;
+	for (i = 0; i < nb_clks; i++)
+		if (!plan[i].done)
+			left++;
+
+	for (depth = 0; left; depth++) {
+		for (i = 0; i < nb_clks; i++) {
+			if (plan[i].done || plan[i].depth != depth)
+				continue;
+
+			ops = plan[i].desc->platform_ops;
+			if (!ops->clk_set_rates) {
+				plan[i].done = true;
+				left--;
+				plan[i].desc->stats.hw_writes++;
+				ret = ops->clk_set_rate(plan[i].desc,
+							plan[i].rate);
+				no_os_clk_invalidate(plan[i].desc);
+				if (ret)
+					goto out;
+				continue;
+			}
+
+			/* All the clocks of the device at this depth */
+			nb = 0;
+			for (j = i; j < nb_clks; j++) {
+				if (plan[j].done || plan[j].depth != depth ||
+				    plan[j].desc->platform_ops != ops ||
+				    plan[j].desc->dev_desc !=
+				    plan[i].desc->dev_desc)
+					continue;
+				plan[j].done = true;
+				left--;
+				plan[j].desc->stats.hw_writes++;
+				group[nb] = plan[j].desc;
+				group_rates[nb++] = plan[j].rate;
+			}
+
+			ret = ops->clk_set_rates(group, group_rates, nb);
+			for (j = 0; j < nb; j++)
+				no_os_clk_invalidate(group[j]);
+			if (ret)
+				goto out;
+		}
+	}
+
+out:
+	no_os_free(group_rates);
+	no_os_free(group);
+	no_os_free(plan);
+
+	return ret;
+}
+
+/**
+ * Get the parent of the clock.
+ * @param desc - The clock descriptor.
+ * @return The parent clock, NULL for a root clock.
+ */
+struct no_os_clk_desc *no_os_clk_get_parent(struct no_os_clk_desc *desc)
+{
+	if (!desc)
+		return NULL;
+
+	return desc->parent;
+}
+
+/**
+ * Attach the clock to a new parent. The cached rates of the clock and of its
+ * descendants are dropped.
+ * @param desc - The clock descriptor.
+ * @param parent - The new parent, NULL to make the clock a root clock.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_clk_set_parent(struct no_os_clk_desc *desc,
+			     struct no_os_clk_desc *parent)
+{
+	struct no_os_clk_desc *it;
+
+	if (!desc)
+		return -EINVAL;
+
+	/* A clock can't be its own ancestor */
+	for (it = parent; it; it = it->parent)
+		if (it == desc)
+			return -EINVAL;
+
+	no_os_clk_unlink(desc);
+	no_os_clk_link(desc, parent);
+	no_os_clk_invalidate(desc);
+
+	return 0;
+}
+
+/**
+ * Drop the cached rate of the clock and of all its descendants, to be called
+ * when the rate changed without going through the framework.
+ * @param desc - The clock descriptor.
+ */
+void no_os_clk_invalidate(struct no_os_clk_desc *desc)
+{
+	struct no_os_clk_desc *child;
+
+	if (!desc)
+		return;
+
+	desc->rate_valid = false;
+	for (child = desc->child; child; child = child->sibling)
+		no_os_clk_invalidate(child);
+}
+
+/**
+ * Read the access statistics of the clock.
+ * @param desc - The clock descriptor.
+ * @param stats - The statistics since the last clear.
+ * @param clear - Restart the statistics.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t no_os_clk_get_stats(struct no_os_clk_desc *desc,
+			    struct no_os_clk_stats *stats,
+			    bool clear)
+{
+	if (!desc || !stats)
+		return -EINVAL;
+
+	*stats = desc->stats;
+	if (clear)
+		memset(&desc->stats, 0, sizeof(desc->stats));
+
+	return 0;
 }
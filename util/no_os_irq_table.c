@@ -0,0 +1,242 @@
+/***************************************************************************//**
+ *   @file   no_os_irq_table.c
+ *   @brief  Constant time IRQ callback dispatch table.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stddef.h>
+#include "no_os_irq_table.h"
+#include "no_os_error.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Get the slot of an (event, peripheral instance) pair.
+ * @param table - The dispatch table.
+ * @param event - The enum no_os_irq_event value of the row.
+ * @param slot - Peripheral instance index.
+ * @return Pointer to the slot, NULL if it is out of the table.
+ */
+struct no_os_irq_slot *no_os_irq_table_get(struct no_os_irq_table *table,
+		uint32_t event, uint32_t slot)
+{
+	if (!table || slot >= table->nb_slots)
+		return NULL;
+
+	event -= table->first_event;
+	if (event >= table->nb_events)
+		return NULL;
+
+	return &table->slots[event * table->nb_slots + slot];
+}
+
+/**
+ * @brief Register or update the callback of an (event, peripheral) pair.
+ * @param table - The dispatch table.
+ * @param slot - Peripheral instance index.
+ * @param irq_id - Interrupt id, stored for the platform driver.
+ * @param callback_desc - Callback, context, handle and event to register.
+ * @return 0 in case of success, -EINVAL otherwise.
+ */
+int no_os_irq_table_register(struct no_os_irq_table *table, uint32_t slot,
+			     uint32_t irq_id,
+			     const struct no_os_callback_desc *callback_desc)
+{
+	struct no_os_irq_slot *s;
+
+	if (!callback_desc)
+		return -EINVAL;
+
+	s = no_os_irq_table_get(table, callback_desc->event, slot);
+	if (!s)
+		return -EINVAL;
+
+	atomic_store_explicit(&s->callback, NULL, memory_order_release);
+	s->irq_id = irq_id;
+	s->handle = callback_desc->handle;
+	s->ctx = callback_desc->ctx;
+	atomic_store_explicit(&s->callback, callback_desc->callback,
+			      memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @brief Free the slot of an (event, peripheral) pair.
+ * @param table - The dispatch table.
+ * @param event - The enum no_os_irq_event value of the row.
+ * @param slot - Peripheral instance index.
+ * @return 0 in case of success, -EINVAL if out of the table, -ENODEV if the
+ * slot was already free.
+ */
+int no_os_irq_table_unregister(struct no_os_irq_table *table, uint32_t event,
+			       uint32_t slot)
+{
+	struct no_os_irq_slot *s;
+
+	s = no_os_irq_table_get(table, event, slot);
+	if (!s)
+		return -EINVAL;
+
+	if (!atomic_exchange_explicit(&s->callback, NULL, memory_order_acq_rel))
+		return -ENODEV;
+
+	s->handle = NULL;
+	s->ctx = NULL;
+
+	return 0;
+}
+
+/**
+ * @brief Free all the slots of the table.
+ * @param table - The dispatch table.
+ */
+void no_os_irq_table_clear(struct no_os_irq_table *table)
+{
+	uint32_t i;
+
+	if (!table)
+		return;
+
+	for (i = 0; i < table->nb_events * table->nb_slots; i++) {
+		atomic_store_explicit(&table->slots[i].callback, NULL,
+				      memory_order_release);
+		table->slots[i].handle = NULL;
+		table->slots[i].ctx = NULL;
+	}
+}
+
+/**
+ * @brief Call the callback of a slot and update its statistics. Meant to be
+ * called from interrupt context.
+ * @param table - The dispatch table.
+ * @param slot - The slot, as returned by no_os_irq_table_get().
+ * @return true if a callback was called, false if the slot is free.
+ */
+bool no_os_irq_slot_dispatch(struct no_os_irq_table *table,
+			     struct no_os_irq_slot *slot)
+{
+	void (*callback)(void *context);
+	uint32_t start, ticks;
+
+	callback = atomic_load_explicit(&slot->callback, memory_order_acquire);
+	if (!callback)
+		return false;
+
+	if (!table->get_ticks) {
+		callback(slot->ctx);
+		slot->count++;
+		return true;
+	}
+
+	start = table->get_ticks();
+	callback(slot->ctx);
+	ticks = table->get_ticks() - start;
+	slot->count++;
+	if (ticks > slot->max_ticks)
+		slot->max_ticks = ticks;
+
+	return true;
+}
+
+/**
+ * @brief Call the callback of an (event, peripheral) pair. Meant to be called
+ * from interrupt context.
+ * @param table - The dispatch table.
+ * @param event - The enum no_os_irq_event value of the row.
+ * @param slot - Peripheral instance index.
+ * @return true if a callback was called, false otherwise.
+ */
+bool no_os_irq_table_dispatch(struct no_os_irq_table *table, uint32_t event,
+			      uint32_t slot)
+{
+	struct no_os_irq_slot *s;
+
+	s = no_os_irq_table_get(table, event, slot);
+	if (!s)
+		return false;
+
+	return no_os_irq_slot_dispatch(table, s);
+}
+
+/**
+ * @brief Read the statistics of an (event, peripheral) pair.
+ * @param table - The dispatch table.
+ * @param event - The enum no_os_irq_event value of the row.
+ * @param slot - Peripheral instance index.
+ * @param count - Number of dispatched interrupts, may be NULL.
+ * @param max_ticks - Worst case dispatch time in get_ticks() units, 0 if the
+ * table has no tick source. May be NULL.
+ * @return 0 in case of success, -EINVAL otherwise.
+ */
+int no_os_irq_table_stats(struct no_os_irq_table *table, uint32_t event,
+			  uint32_t slot, uint32_t *count, uint32_t *max_ticks)
+{
+	struct no_os_irq_slot *s;
+
+	s = no_os_irq_table_get(table, event, slot);
+	if (!s)
+		return -EINVAL;
+
+	if (count)
+		*count = s->count;
+	if (max_ticks)
+		*max_ticks = s->max_ticks;
+
+	return 0;
+}
+
+/**
+ * @brief Clear the statistics of all the slots.
+ * @param table - The dispatch table.
+ */
+void no_os_irq_table_stats_reset(struct no_os_irq_table *table)
+{
+	uint32_t i;
+
+	if (!table)
+		return;
+
+	for (i = 0; i < table->nb_events * table->nb_slots; i++) {
+		table->slots[i].count = 0;
+		table->slots[i].max_ticks = 0;
+	}
+}
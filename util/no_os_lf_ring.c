@@ -0,0 +1,395 @@
+/***************************************************************************//**
+ *   @file   no_os_lf_ring.c
+ *   @brief  SPSC lock-free ring of power-of-two size and arbitrary element size.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include <stdatomic.h>
+#include "no_os_lf_ring.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include "no_os_alloc.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct no_os_lf_ring
+ * @brief Ring descriptor.
+ *
+ * head and tail are free running element counters, the slot index is obtained
+ * by masking them with (size - 1). head is only stored by the producer and
+ * tail only by the consumer, each with release semantics, so that the other
+ * side observes the element data before it observes the index update.
+ */
+struct no_os_lf_ring {
+	/** Element storage, size * elem_size bytes */
+	uint8_t *buff;
+	/** Number of elements in the ring (power of two) */
+	uint32_t size;
+	/** Size of an element in bytes */
+	uint32_t elem_size;
+	/** Next slot to be written by the producer */
+	_Atomic uint32_t head;
+	/** Next slot to be read by the consumer */
+	_Atomic uint32_t tail;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Initialize and allocate a lock-free ring.
+ * @param ring - Pointer to a ring descriptor pointer.
+ * @param nb_elem - Number of elements, must be a power of two.
+ * @param elem_size - Size of an element in bytes.
+ * @return 0 if successful, negative error code otherwise.
+ */
+int no_os_lf_ring_init(struct no_os_lf_ring **ring, uint32_t nb_elem,
+		       uint32_t elem_size)
+{
+	struct no_os_lf_ring *r;
+
+	if (!ring || !elem_size || nb_elem < 2 || nb_elem > NO_OS_BIT(30))
+		return -EINVAL;
+
+	if (nb_elem & (nb_elem - 1))
+		return -EINVAL;
+
+	r = no_os_calloc(1, sizeof(*r));
+	if (!r)
+		return -ENOMEM;
+
+	r->buff = no_os_calloc(nb_elem, elem_size);
+	if (!r->buff) {
+		no_os_free(r);
+		return -ENOMEM;
+	}
+
+	r->size = nb_elem;
+	r->elem_size = elem_size;
+	atomic_init(&r->head, 0);
+	atomic_init(&r->tail, 0);
+
+	*ring = r;
+
+	return 0;
+}
+
+/**
+ * @brief Free the resources allocated for the ring.
+ * @param ring - Ring descriptor.
+ * @return 0 if successful, negative error code otherwise.
+ */
+int no_os_lf_ring_remove(struct no_os_lf_ring *ring)
+{
+	if (!ring)
+		return -EINVAL;
+
+	no_os_free(ring->buff);
+	no_os_free(ring);
+
+	return 0;
+}
+
+/**
+ * @brief Get the number of elements available for reading.
+ * @param ring - Ring descriptor.
+ * @return Number of elements in the ring.
+ */
+uint32_t no_os_lf_ring_count(struct no_os_lf_ring *ring)
+{
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	return head - tail;
+}
+
+/**
+ * @brief Get the number of free element slots.
+ * @param ring - Ring descriptor.
+ * @return Number of elements that can be written.
+ */
+uint32_t no_os_lf_ring_space(struct no_os_lf_ring *ring)
+{
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	return ring->size - (head - tail);
+}
+
+/**
+ * @brief Test whether the ring is empty.
+ * @param ring - Ring descriptor.
+ * @return true if the ring is empty, false otherwise.
+ */
+bool no_os_lf_ring_is_empty(struct no_os_lf_ring *ring)
+{
+	return no_os_lf_ring_count(ring) == 0;
+}
+
+/**
+ * @brief Test whether the ring is full.
+ * @param ring - Ring descriptor.
+ * @return true if the ring is full, false otherwise.
+ */
+bool no_os_lf_ring_is_full(struct no_os_lf_ring *ring)
+{
+	return no_os_lf_ring_space(ring) == 0;
+}
+
+/**
+ * @brief Copy elements into the ring storage, wrapping around if needed.
+ * @param ring - Ring descriptor.
+ * @param idx - Free running index of the first slot.
+ * @param src - Source elements.
+ * @param nb_elem - Number of elements to copy.
+ */
+static void no_os_lf_ring_copy_in(struct no_os_lf_ring *ring, uint32_t idx,
+				  const uint8_t *src, uint32_t nb_elem)
+{
+	uint32_t off = idx & (ring->size - 1);
+	uint32_t first = no_os_min(nb_elem, ring->size - off);
+
+	memcpy(ring->buff + off * ring->elem_size, src, first * ring->elem_size);
+	if (nb_elem > first)
+		memcpy(ring->buff, src + first * ring->elem_size,
+		       (nb_elem - first) * ring->elem_size);
+}
+
+/**
+ * @brief Copy elements out of the ring storage, wrapping around if needed.
+ * @param ring - Ring descriptor.
+ * @param idx - Free running index of the first slot.
+ * @param dst - Destination buffer.
+ * @param nb_elem - Number of elements to copy.
+ */
+static void no_os_lf_ring_copy_out(struct no_os_lf_ring *ring, uint32_t idx,
+				   uint8_t *dst, uint32_t nb_elem)
+{
+	uint32_t off = idx & (ring->size - 1);
+	uint32_t first = no_os_min(nb_elem, ring->size - off);
+
+	memcpy(dst, ring->buff + off * ring->elem_size, first * ring->elem_size);
+	if (nb_elem > first)
+		memcpy(dst + first * ring->elem_size, ring->buff,
+		       (nb_elem - first) * ring->elem_size);
+}
+
+/**
+ * @brief Write up to nb_elem elements to the ring.
+ * @param ring - Ring descriptor.
+ * @param elems - Elements to write.
+ * @param nb_elem - Number of elements to write.
+ * @return Number of elements written.
+ */
+uint32_t no_os_lf_ring_write_n(struct no_os_lf_ring *ring, const void *elems,
+			       uint32_t nb_elem)
+{
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+	nb_elem = no_os_min(nb_elem, ring->size - (head - tail));
+	if (!nb_elem)
+		return 0;
+
+	no_os_lf_ring_copy_in(ring, head, elems, nb_elem);
+	atomic_store_explicit(&ring->head, head + nb_elem, memory_order_release);
+
+	return nb_elem;
+}
+
+/**
+ * @brief Read up to nb_elem elements from the ring.
+ * @param ring - Ring descriptor.
+ * @param elems - Where to store the elements.
+ * @param nb_elem - Number of elements to read.
+ * @return Number of elements read.
+ */
+uint32_t no_os_lf_ring_read_n(struct no_os_lf_ring *ring, void *elems,
+			      uint32_t nb_elem)
+{
+	uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	nb_elem = no_os_min(nb_elem, head - tail);
+	if (!nb_elem)
+		return 0;
+
+	no_os_lf_ring_copy_out(ring, tail, elems, nb_elem);
+	atomic_store_explicit(&ring->tail, tail + nb_elem, memory_order_release);
+
+	return nb_elem;
+}
+
+/**
+ * @brief Write one element to the ring.
+ * @param ring - Ring descriptor.
+ * @param elem - Element to write.
+ * @return 0 if successful, -ENOSPC if the ring is full.
+ */
+int no_os_lf_ring_write(struct no_os_lf_ring *ring, const void *elem)
+{
+	return no_os_lf_ring_write_n(ring, elem, 1) ? 0 : -ENOSPC;
+}
+
+/**
+ * @brief Read one element from the ring.
+ * @param ring - Ring descriptor.
+ * @param elem - Where to store the element.
+ * @return 0 if successful, -EAGAIN if the ring is empty.
+ */
+int no_os_lf_ring_read(struct no_os_lf_ring *ring, void *elem)
+{
+	return no_os_lf_ring_read_n(ring, elem, 1) ? 0 : -EAGAIN;
+}
+
+/**
+ * @brief Get the contiguous free region of the ring for in-place writing.
+ *
+ * The data is published only after no_os_lf_ring_write_commit() is called.
+ * @param ring - Ring descriptor.
+ * @param buff - Where to store the address of the first free slot.
+ * @param nb_elem - Where to store the number of contiguous free slots.
+ * @return 0 if successful, negative error code otherwise.
+ */
+int no_os_lf_ring_write_peek(struct no_os_lf_ring *ring, void **buff,
+			     uint32_t *nb_elem)
+{
+	uint32_t head, tail, off;
+
+	if (!ring || !buff || !nb_elem)
+		return -EINVAL;
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	off = head & (ring->size - 1);
+
+	*buff = ring->buff + off * ring->elem_size;
+	*nb_elem = no_os_min(ring->size - (head - tail), ring->size - off);
+
+	return 0;
+}
+
+/**
+ * @brief Publish elements written in place after no_os_lf_ring_write_peek().
+ * @param ring - Ring descriptor.
+ * @param nb_elem - Number of elements written.
+ * @return 0 if successful, negative error code otherwise.
+ */
+int no_os_lf_ring_write_commit(struct no_os_lf_ring *ring, uint32_t nb_elem)
+{
+	uint32_t head;
+
+	if (!ring)
+		return -EINVAL;
+
+	if (nb_elem > no_os_lf_ring_space(ring))
+		return -EINVAL;
+
+	head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	atomic_store_explicit(&ring->head, head + nb_elem, memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @brief Get the contiguous filled region of the ring for in-place reading.
+ *
+ * The slots are released only after no_os_lf_ring_read_commit() is called.
+ * @param ring - Ring descriptor.
+ * @param buff - Where to store the address of the first filled slot.
+ * @param nb_elem - Where to store the number of contiguous filled slots.
+ * @return 0 if successful, negative error code otherwise.
+ */
+int no_os_lf_ring_read_peek(struct no_os_lf_ring *ring, void **buff,
+			    uint32_t *nb_elem)
+{
+	uint32_t head, tail, off;
+
+	if (!ring || !buff || !nb_elem)
+		return -EINVAL;
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	head = atomic_load_explicit(&ring->head, memory_order_acquire);
+	off = tail & (ring->size - 1);
+
+	*buff = ring->buff + off * ring->elem_size;
+	*nb_elem = no_os_min(head - tail, ring->size - off);
+
+	return 0;
+}
+
+/**
+ * @brief Release elements consumed in place after no_os_lf_ring_read_peek().
+ * @param ring - Ring descriptor.
+ * @param nb_elem - Number of elements consumed.
+ * @return 0 if successful, negative error code otherwise.
+ */
+int no_os_lf_ring_read_commit(struct no_os_lf_ring *ring, uint32_t nb_elem)
+{
+	uint32_t tail;
+
+	if (!ring)
+		return -EINVAL;
+
+	if (nb_elem > no_os_lf_ring_count(ring))
+		return -EINVAL;
+
+	tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	atomic_store_explicit(&ring->tail, tail + nb_elem, memory_order_release);
+
+	return 0;
+}
+
+/**
+ * @brief Drop all the elements currently in the ring.
+ *
+ * Must be called from the consumer side.
+ * @param ring - Ring descriptor.
+ */
+void no_os_lf_ring_flush(struct no_os_lf_ring *ring)
+{
+	uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	atomic_store_explicit(&ring->tail, head, memory_order_release);
+}
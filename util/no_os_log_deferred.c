@@ -0,0 +1,528 @@
+/***************************************************************************//**
+ *   @file   no_os_log_deferred.c
+ *   @brief  Deferred binary logging backend for the pr_* macros.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include "no_os_log_deferred.h"
+#include "no_os_print_log.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#if defined(PRINT_TIME)
+#include "no_os_delay.h"
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define LOG_RING_MASK	(NO_OS_LOG_RING_SIZE - 1)
+
+_Static_assert((NO_OS_LOG_RING_SIZE & LOG_RING_MASK) == 0,
+	       "NO_OS_LOG_RING_SIZE must be a power of two");
+_Static_assert(NO_OS_LOG_MAX_ARGS <= 8,
+	       "NO_OS_LOG_MAX_ARGS is limited by NO_OS_LOG_ARGS_n");
+_Static_assert(NO_OS_LOG_STR_SIZE > 0 && NO_OS_LOG_STR_SIZE <= UINT16_MAX,
+	       "NO_OS_LOG_STR_SIZE must fit in str_len");
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/*
+ * Bounded multi producer, single consumer ring. A slot at free running
+ * position pos is stored in log_ring[pos & LOG_RING_MASK] and its seq is:
+ *  - lap (pos & ~LOG_RING_MASK) when it is free for pos,
+ *  - lap + 1 once the producer published it,
+ *  - lap + NO_OS_LOG_RING_SIZE once the consumer released it, which is the
+ *    free value of the next lap.
+ * Producers claim positions with a compare and swap on log_head, so calls from
+ * interrupt handlers preempting a producer are safe. All the slots start free
+ * with a zero seq, no initialization is required before the first log call.
+ */
+static struct no_os_log_record log_ring[NO_OS_LOG_RING_SIZE];
+/* Next position to be claimed by a producer, also the number of records */
+static _Atomic uint32_t log_head;
+/* Next position to be read, only accessed by the consumer */
+static uint32_t log_tail;
+static _Atomic uint32_t log_dropped;
+static uint32_t log_high_water;
+static uint32_t log_recorded_base;
+
+static const char *const log_level_names[] = {
+	[NO_OS_LOG_EMERG] = "EMERG",
+	[NO_OS_LOG_ALERT] = "ALERT",
+	[NO_OS_LOG_CRIT] = "CRIT",
+	[NO_OS_LOG_ERR] = "ERR",
+	[NO_OS_LOG_WARNING] = "WARNING",
+	[NO_OS_LOG_NOTICE] = "NOTICE",
+	[NO_OS_LOG_INFO] = "",
+	[NO_OS_LOG_DEBUG] = "DEBUG",
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Claim a ring slot for a log call.
+ * @param site - Call site.
+ * @return The record to be filled and passed to no_os_log_commit(), NULL if
+ * the ring is full, in which case the call is counted as dropped.
+ */
+struct no_os_log_record *no_os_log_reserve(const struct no_os_log_site *site)
+{
+	struct no_os_log_record *rec;
+	uint32_t pos, lap, seq;
+#if defined(PRINT_TIME)
+	struct no_os_time t;
+#endif
+
+	pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+	while (1) {
+		rec = &log_ring[pos & LOG_RING_MASK];
+		lap = pos & ~LOG_RING_MASK;
+		seq = atomic_load_explicit(&rec->seq, memory_order_acquire);
+		if (seq == lap) {
+			if (atomic_compare_exchange_weak_explicit(&log_head,
+					&pos, pos + 1, memory_order_relaxed,
+					memory_order_relaxed))
+				break;
+		} else if ((int32_t)(seq - lap) < 0) {
+			/* Still holding a record of the previous lap */
+			atomic_fetch_add_explicit(&log_dropped, 1,
+						  memory_order_relaxed);
+			return NULL;
+		} else {
+			pos = atomic_load_explicit(&log_head,
+						   memory_order_relaxed);
+		}
+	}
+
+	rec->site = site;
+	rec->float_mask = 0;
+	rec->str_mask = 0;
+	rec->str_len = 0;
+	/* Conversions without a matching argument print 0, not a stale value */
+	memset(rec->args, 0, sizeof(rec->args));
+#if defined(PRINT_TIME)
+	t = no_os_get_time();
+	rec->s = t.s;
+	rec->us = t.us;
+#endif
+
+	return rec;
+}
+
+/**
+ * @brief Copy a string argument in a record, truncated to the space left.
+ * @param rec - Record claimed with no_os_log_reserve().
+ * @param i - Index of the argument.
+ * @param str - Address of the char pointer argument.
+ */
+void no_os_log_str(struct no_os_log_record *rec, uint32_t i, const void *str)
+{
+	const char *s;
+	uint32_t n, max;
+
+	memcpy(&s, str, sizeof(s));
+	if (!s) {
+		/* Printed as "(null)" like a NULL pointer */
+		rec->args[i] = 0;
+		return;
+	}
+
+	if (rec->str_len == NO_OS_LOG_STR_SIZE) {
+		/* No room left, point to the end of the last copy */
+		rec->args[i] = NO_OS_LOG_STR_SIZE - 1;
+	} else {
+		max = NO_OS_LOG_STR_SIZE - rec->str_len - 1;
+		for (n = 0; n < max && s[n]; n++)
+			rec->strs[rec->str_len + n] = s[n];
+		rec->strs[rec->str_len + n] = '\0';
+		rec->args[i] = rec->str_len;
+		rec->str_len += n + 1;
+	}
+	rec->str_mask |= NO_OS_BIT(i);
+}
+
+/**
+ * @brief Publish a record claimed with no_os_log_reserve().
+ * @param rec - The record.
+ */
+void no_os_log_commit(struct no_os_log_record *rec)
+{
+	uint32_t seq = atomic_load_explicit(&rec->seq, memory_order_relaxed);
+
+	atomic_store_explicit(&rec->seq, seq + 1, memory_order_release);
+}
+
+/**
+ * @brief Pop the oldest record. Must only be called from one context.
+ * @param rec - Copy of the record.
+ * @return 0 in case of success, -EAGAIN if there is no published record.
+ */
+int no_os_log_read(struct no_os_log_record *rec)
+{
+	struct no_os_log_record *slot;
+	uint32_t lap, pending;
+
+	if (!rec)
+		return -EINVAL;
+
+	slot = &log_ring[log_tail & LOG_RING_MASK];
+	lap = log_tail & ~LOG_RING_MASK;
+	if (atomic_load_explicit(&slot->seq, memory_order_acquire) != lap + 1)
+		return -EAGAIN;
+
+	pending = atomic_load_explicit(&log_head, memory_order_relaxed) -
+		  log_tail;
+	if (pending > log_high_water)
+		log_high_water = pending;
+
+	rec->float_mask = slot->float_mask;
+	rec->str_mask = slot->str_mask;
+	rec->str_len = slot->str_len;
+	rec->site = slot->site;
+#if defined(PRINT_TIME)
+	rec->s = slot->s;
+	rec->us = slot->us;
+#endif
+	memcpy(rec->args, slot->args, sizeof(rec->args));
+	memcpy(rec->strs, slot->strs, slot->str_len);
+
+	atomic_store_explicit(&slot->seq, lap + NO_OS_LOG_RING_SIZE,
+			      memory_order_release);
+	log_tail++;
+
+	return 0;
+}
+
+/**
+ * @brief snprintf() to the end of a line, keeping track of the full length.
+ * @param buf - Line buffer.
+ * @param size - Size of the line buffer.
+ * @param len - Length of the line, updated.
+ * @param fmt - Format.
+ */
+static void log_append(char *buf, size_t size, int *len, const char *fmt, ...)
+{
+	va_list ap;
+	int ret;
+
+	va_start(ap, fmt);
+	if ((size_t)*len < size)
+		ret = vsnprintf(buf + *len, size - *len, fmt, ap);
+	else
+		ret = vsnprintf(NULL, 0, fmt, ap);
+	va_end(ap);
+
+	if (ret > 0)
+		*len += ret;
+}
+
+/**
+ * @brief Write the prefix the pr_* macro of the level would print.
+ * @param site - Call site.
+ * @param buf - Line buffer.
+ * @param size - Size of the line buffer.
+ * @param len - Length of the line, updated.
+ */
+static void log_prefix(const struct no_os_log_site *site, char *buf,
+		       size_t size, int *len)
+{
+	if (site->level <= NO_OS_LOG_ERR)
+		log_append(buf, size, len, "%s: %s:%d:%s(): ",
+			   log_level_names[site->level], site->file,
+			   (int)site->line, site->func);
+	else if (site->level != NO_OS_LOG_INFO &&
+		 site->level <= NO_OS_LOG_DEBUG)
+		log_append(buf, size, len, "%s: ",
+			   log_level_names[site->level]);
+}
+
+/* Print one conversion, with the '*' width and precision if any. */
+#define LOG_EMIT(val) do {						\
+	if (nb_stars == 2)						\
+		log_append(buf, size, &len, spec, stars[0], stars[1], val); \
+	else if (nb_stars == 1)						\
+		log_append(buf, size, &len, spec, stars[0], val);	\
+	else								\
+		log_append(buf, size, &len, spec, val);			\
+} while (0)
+
+/* Read the next argument as type. */
+#define LOG_ARG(type, var) do {						\
+	memcpy(&var, &rec->args[arg], sizeof(type));			\
+	arg++;								\
+} while (0)
+
+/**
+ * @brief Format a record the same way the direct pr_* call would have.
+ * @param rec - The record.
+ * @param buf - Line buffer.
+ * @param size - Size of the line buffer, the line is truncated if needed.
+ * @return Length of the full line, as snprintf(), negative error code if the
+ * parameters are invalid.
+ */
+int no_os_log_format(const struct no_os_log_record *rec, char *buf,
+		     size_t size)
+{
+	const char *p, *start;
+	char spec[16];
+	char length[3];
+	uint32_t arg = 0;
+	int stars[2];
+	int nb_stars;
+	int len = 0;
+	size_t n;
+
+	if (!rec || !rec->site || (!buf && size))
+		return -EINVAL;
+
+	if (size)
+		buf[0] = '\0';
+
+#if defined(PRINT_TIME)
+	log_append(buf, size, &len, "[%5d.%06d] ", rec->s, rec->us);
+#endif
+	log_prefix(rec->site, buf, size, &len);
+
+	p = rec->site->fmt;
+	while (*p) {
+		/* Literal text up to the next conversion */
+		start = p;
+		while (*p && *p != '%')
+			p++;
+		if (p != start)
+			log_append(buf, size, &len, "%.*s", (int)(p - start),
+				   start);
+		if (!*p)
+			break;
+
+		start = p++;
+		if (*p == '%') {
+			log_append(buf, size, &len, "%%");
+			p++;
+			continue;
+		}
+
+		nb_stars = 0;
+		while (*p && strchr("-+ #0", *p))
+			p++;
+		/* Width and precision */
+		while (*p && strchr("0123456789.*", *p)) {
+			if (*p == '*') {
+				if (arg >= NO_OS_LOG_MAX_ARGS || nb_stars == 2)
+					return len;
+				LOG_ARG(int, stars[nb_stars]);
+				nb_stars++;
+			}
+			p++;
+		}
+		n = 0;
+		while (*p && strchr("hljztL", *p) && n < sizeof(length) - 1)
+			length[n++] = *p++;
+		length[n] = '\0';
+		if (!*p)
+			break;
+		p++;
+
+		n = p - start;
+		if (n >= sizeof(spec) || arg >= NO_OS_LOG_MAX_ARGS)
+			return len;
+		memcpy(spec, start, n);
+		spec[n] = '\0';
+
+		switch (p[-1]) {
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+		case 'c':
+			if (!strcmp(length, "ll") || !strcmp(length, "j")) {
+				long long v;
+				LOG_ARG(long long, v);
+				LOG_EMIT(v);
+			} else if (!strcmp(length, "l")) {
+				long v;
+				LOG_ARG(long, v);
+				LOG_EMIT(v);
+			} else if (!strcmp(length, "z") ||
+				   !strcmp(length, "t")) {
+				size_t v;
+				LOG_ARG(size_t, v);
+				LOG_EMIT(v);
+			} else {
+				int v;
+				LOG_ARG(int, v);
+				LOG_EMIT(v);
+			}
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			if (length[0] == 'L') {
+				/* long double does not fit in a record */
+				log_append(buf, size, &len, "?");
+				arg++;
+			} else if (rec->float_mask & NO_OS_BIT(arg)) {
+				float f;
+				LOG_ARG(float, f);
+				LOG_EMIT((double)f);
+			} else {
+				double v;
+				LOG_ARG(double, v);
+				LOG_EMIT(v);
+			}
+			break;
+		case 's': {
+			const char *v;
+			if (rec->str_mask & NO_OS_BIT(arg)) {
+				if (rec->args[arg] < NO_OS_LOG_STR_SIZE)
+					v = &rec->strs[rec->args[arg]];
+				else
+					v = "?";
+				arg++;
+			} else {
+				LOG_ARG(const char *, v);
+			}
+			LOG_EMIT(v ? v : "(null)");
+			break;
+		}
+		case 'p': {
+			void *v;
+			LOG_ARG(void *, v);
+			LOG_EMIT(v);
+			break;
+		}
+		case 'n':
+			arg++;
+			break;
+		default:
+			/* Unknown conversion, print it as it is */
+			log_append(buf, size, &len, "%s", spec);
+			break;
+		}
+	}
+
+	return len;
+}
+
+/**
+ * @brief Format and print a call right away, used by the calls with more than
+ * NO_OS_LOG_MAX_ARGS arguments.
+ * @param site - Call site.
+ */
+void no_os_log_direct(const struct no_os_log_site *site, ...)
+{
+	char prefix[NO_OS_LOG_LINE_SIZE];
+	int len = 0;
+	va_list ap;
+#if defined(PRINT_TIME)
+	struct no_os_time t = no_os_get_time();
+
+	log_append(prefix, sizeof(prefix), &len, "[%5d.%06d] ", t.s, t.us);
+#endif
+
+	log_prefix(site, prefix, sizeof(prefix), &len);
+	printf("%s", prefix);
+
+	va_start(ap, site);
+	vprintf(site->fmt, ap);
+	va_end(ap);
+}
+
+/**
+ * @brief Format and print the pending records. Meant to be called from a low
+ * priority thread or from the main loop, never from the hot paths.
+ * @param max - Maximum number of records to print, 0 for all of them.
+ * @return Number of printed records.
+ */
+uint32_t no_os_log_drain(uint32_t max)
+{
+	static char line[NO_OS_LOG_LINE_SIZE];
+	struct no_os_log_record rec;
+	uint32_t nb = 0;
+
+	while (!max || nb < max) {
+		if (no_os_log_read(&rec))
+			break;
+		no_os_log_format(&rec, line, sizeof(line));
+		printf("%s", line);
+		nb++;
+	}
+
+	return nb;
+}
+
+/**
+ * @brief Read the logging statistics.
+ * @param stats - Statistics since the last clear.
+ * @param clear - Restart the statistics.
+ */
+void no_os_log_stats_get(struct no_os_log_stats *stats, bool clear)
+{
+	uint32_t head = atomic_load_explicit(&log_head, memory_order_relaxed);
+
+	if (!stats)
+		return;
+
+	stats->recorded = head - log_recorded_base;
+	stats->high_water = log_high_water;
+	if (clear) {
+		stats->dropped = atomic_exchange_explicit(&log_dropped, 0,
+				 memory_order_relaxed);
+		log_recorded_base = head;
+		log_high_water = 0;
+	} else {
+		stats->dropped = atomic_load_explicit(&log_dropped,
+						      memory_order_relaxed);
+	}
+}
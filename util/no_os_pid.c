@@ -37,10 +37,15 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
 #include <errno.h>
+#include <stdbool.h>
 #include "no_os_pid.h"
 #include "no_os_alloc.h"
+#include "no_os_util.h"
 #include "no_os_print_log.h"
 
+/* Fractional bits of the filtered process variable rate */
+#define NO_OS_PID_BATCH_D_Q	8
+
 struct no_os_pid {
 	int iacc; // integral accumulator
 	int dacc; // derivative accumulator
@@ -48,6 +53,33 @@ struct no_os_pid {
 	struct no_os_pid_config config; // copy of the user-provided configuration
 };
 
+/*
+ * State and configuration of one loop of a batch. The update walks the
+ * records with a single pointer, so the loop body doesn't run out of
+ * registers on Cortex-M.
+ */
+struct no_os_pid_batch_loop {
+	int64_t integ; // integral component (Q16)
+	int64_t i_high; // integral clip (Q16)
+	int64_t i_low;
+	int64_t out_high; // output clip (Q16)
+	int64_t out_low;
+	int32_t Kp;
+	int32_t Ki;
+	int32_t Kd;
+	int32_t d_alpha;
+	int32_t d_filt; // filtered process variable rate (Q8)
+	int32_t pv_prev; // process variable of the previous update
+	int32_t primed; // 1 once pv_prev is valid
+};
+
+/* Batch of PID loops, updated by the same straight line code */
+struct no_os_pid_batch {
+	uint32_t nb_loops;
+	uint32_t nb_unprimed; // loops waiting for their first update
+	struct no_os_pid_batch_loop *loops;
+};
+
 /**
  * @brief Initialize a PID controller with given configuration
  * @param pid - Double pointer to a PID descriptor that the function allocates
@@ -206,3 +238,211 @@ int no_os_pid_remove(struct no_os_pid *pid)
 
 	return 0;
 }
+
+/**
+ * @brief Allocate a batch of PID loops.
+ *
+ * All the loops must be configured with no_os_pid_batch_config() before
+ * the first update.
+ *
+ * @param batch - Double pointer to the batch descriptor that the function
+ * 		  allocates
+ * @param nb_loops - Number of loops
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Invalid input
+ *  - -ENOMEM : Memory allocation failure
+ */
+int no_os_pid_batch_init(struct no_os_pid_batch **batch, uint32_t nb_loops)
+{
+	struct no_os_pid_batch *b;
+	size_t size;
+
+	if (!batch || !nb_loops)
+		return -EINVAL;
+
+	/* The descriptor and the loop records, in one allocation */
+	size = NO_OS_DIV_ROUND_UP(sizeof(*b), sizeof(int64_t)) *
+	       sizeof(int64_t);
+	b = no_os_calloc(1, size + nb_loops * sizeof(*b->loops));
+	if (!b)
+		return -ENOMEM;
+
+	b->nb_loops = nb_loops;
+	b->nb_unprimed = nb_loops;
+	b->loops = (struct no_os_pid_batch_loop *)((uint8_t *)b + size);
+
+	*batch = b;
+
+	return 0;
+}
+
+/**
+ * @brief Configure one loop of a batch.
+ *
+ * The loop state is kept, so the gains can be changed while running.
+ *
+ * @param batch - Batch descriptor created with no_os_pid_batch_init()
+ * @param loop - Index of the loop
+ * @param config - Loop configuration. When the integral clip is not set,
+ * 		   the output clip is used.
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Invalid input
+ */
+int no_os_pid_batch_config(struct no_os_pid_batch *batch, uint32_t loop,
+			   const struct no_os_pid_batch_config *config)
+{
+	const struct no_os_pid_range *i_clip;
+	struct no_os_pid_batch_loop *l;
+
+	if (!batch || !config || loop >= batch->nb_loops)
+		return -EINVAL;
+
+	if (config->output_clip.high < config->output_clip.low ||
+	    config->d_alpha <= 0 || config->d_alpha > 1 << NO_OS_PID_BATCH_Q)
+		return -EINVAL;
+
+	i_clip = &config->i_clip;
+	if (i_clip->high <= i_clip->low)
+		i_clip = &config->output_clip;
+
+	l = &batch->loops[loop];
+	l->Kp = config->Kp;
+	l->Ki = config->Ki;
+	l->Kd = config->Kd;
+	l->d_alpha = config->d_alpha;
+	l->out_high = (int64_t)config->output_clip.high *
+		      (1 << NO_OS_PID_BATCH_Q) + (1 << NO_OS_PID_BATCH_Q) - 1;
+	l->out_low = (int64_t)config->output_clip.low *
+		     (1 << NO_OS_PID_BATCH_Q);
+	l->i_high = (int64_t)i_clip->high * (1 << NO_OS_PID_BATCH_Q);
+	l->i_low = (int64_t)i_clip->low * (1 << NO_OS_PID_BATCH_Q);
+
+	return 0;
+}
+
+/*
+ * Update of all the loops. The loop body has no data dependent branches: the
+ * clamps and the anti-windup compile to conditional selects (SSAT only takes
+ * a constant bit position, the clip limits are per loop) and the products are
+ * 32 x 32 -> 64 bits multiply-accumulates (SMULL/SMLAL on Cortex-M). The
+ * output clip is kept in Q16 so that the output is clamped before the shift.
+ */
+static void no_os_pid_batch_run(struct no_os_pid_batch_loop *l,
+				uint32_t nb_loops, const int32_t *SP,
+				const int32_t *PV, int32_t *output)
+{
+	int64_t ki_err, dpv, in, acc, lower, upper;
+	int32_t err, pv, d;
+	bool high, low;
+	uint32_t n;
+
+	for (n = 0; n < nb_loops; n++, l++) {
+		pv = PV[n];
+		err = SP[n] - pv;
+		ki_err = (int64_t)l->Ki * err;
+
+		// first order low pass on the process variable rate
+		d = l->d_filt;
+		dpv = (int64_t)(l->pv_prev - pv) * (1 << NO_OS_PID_BATCH_D_Q);
+		d += (dpv - d) * l->d_alpha >> NO_OS_PID_BATCH_Q;
+
+		in = l->integ + ki_err;
+		in = in > l->i_high ? l->i_high : in;
+		in = in < l->i_low ? l->i_low : in;
+
+		acc = in + (int64_t)l->Kp * err;
+		acc += (int64_t)l->Kd * d >> NO_OS_PID_BATCH_D_Q;
+		high = acc > l->out_high;
+		low = acc < l->out_low;
+		acc = high ? l->out_high : acc;
+		acc = low ? l->out_low : acc;
+
+		// anti-windup: don't integrate further into the saturation
+		lower = in < l->integ ? in : l->integ;
+		upper = in > l->integ ? in : l->integ;
+		in = high ? lower : in;
+		l->integ = low ? upper : in;
+		l->d_filt = d;
+		l->pv_prev = pv;
+		output[n] = acc >> NO_OS_PID_BATCH_Q;
+	}
+}
+
+/**
+ * @brief Update all the loops of a batch.
+ * @param batch - Batch descriptor created with no_os_pid_batch_init()
+ * @param SP - Set-points, one per loop
+ * @param PV - Process variables, one per loop
+ * @param output - The outputs of the PID control, one per loop
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Invalid input
+ */
+int no_os_pid_batch_control(struct no_os_pid_batch *batch, const int32_t *SP,
+			    const int32_t *PV, int32_t *output)
+{
+	struct no_os_pid_batch_loop *l;
+	uint32_t n;
+
+	if (!batch || !SP || !PV || !output)
+		return -EINVAL;
+
+	// no derivative on the first update after init or reset
+	if (batch->nb_unprimed) {
+		for (n = 0; n < batch->nb_loops; n++) {
+			l = &batch->loops[n];
+			if (!l->primed)
+				l->pv_prev = PV[n];
+			l->primed = 1;
+		}
+		batch->nb_unprimed = 0;
+	}
+
+	no_os_pid_batch_run(batch->loops, batch->nb_loops, SP, PV, output);
+
+	return 0;
+}
+
+/**
+ * @brief Reset the state of one loop of a batch.
+ * @param batch - Batch descriptor created with no_os_pid_batch_init()
+ * @param loop - Index of the loop
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Invalid input
+ */
+int no_os_pid_batch_reset(struct no_os_pid_batch *batch, uint32_t loop)
+{
+	struct no_os_pid_batch_loop *l;
+
+	if (!batch || loop >= batch->nb_loops)
+		return -EINVAL;
+
+	l = &batch->loops[loop];
+	l->integ = 0;
+	l->d_filt = 0;
+	if (l->primed)
+		batch->nb_unprimed++;
+	l->primed = 0;
+
+	return 0;
+}
+
+/**
+ * @brief Free a batch of PID loops.
+ * @param batch - Batch descriptor created with no_os_pid_batch_init()
+ * @return
+ *  - 0 : On success
+ *  - -EINVAL : Invalid input
+ */
+int no_os_pid_batch_remove(struct no_os_pid_batch *batch)
+{
+	if (!batch)
+		return -EINVAL;
+
+	no_os_free(batch);
+
+	return 0;
+}
@@ -0,0 +1,503 @@
+/***************************************************************************//**
+ *   @file   no_os_zstd.c
+ *   @brief  Minimal Zstandard (RFC 8878) compressor.
+********************************************************************************
+ * Copyright 2024(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include <stdbool.h>
+#include "no_os_zstd.h"
+#include "no_os_error.h"
+#include "no_os_util.h"
+#include "no_os_alloc.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define NO_OS_ZSTD_MAGIC	0xFD2FB528
+/* Frame header descriptor: single segment, 4 bytes content size */
+#define NO_OS_ZSTD_FHD		0xA0
+#define NO_OS_ZSTD_FRAME_HDR	9
+#define NO_OS_ZSTD_BLOCK_HDR	3
+#define NO_OS_ZSTD_BLOCK_MAX	(128 * 1024)
+#define NO_OS_ZSTD_BLOCK_RAW	0
+#define NO_OS_ZSTD_BLOCK_COMP	2
+#define NO_OS_ZSTD_MIN_MATCH	4
+/* A block is closed early when this many sequences were found */
+#define NO_OS_ZSTD_MAX_SEQS	256
+
+#define NO_OS_ZSTD_LL_CODES	36
+#define NO_OS_ZSTD_ML_CODES	53
+#define NO_OS_ZSTD_OF_CODES	29
+#define NO_OS_ZSTD_LL_LOG	6
+#define NO_OS_ZSTD_ML_LOG	6
+#define NO_OS_ZSTD_OF_LOG	5
+
+/* Predefined distributions, RFC 8878 section 3.1.1.3.2.2 */
+static const int8_t no_os_zstd_ll_norm[NO_OS_ZSTD_LL_CODES] = {
+	4, 3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1,
+	2, 2, 2, 2, 2, 2, 2, 2, 2, 3, 2, 1, 1, 1, 1, 1,
+	-1, -1, -1, -1,
+};
+
+static const int8_t no_os_zstd_ml_norm[NO_OS_ZSTD_ML_CODES] = {
+	1, 4, 3, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, -1, -1,
+	-1, -1, -1, -1, -1,
+};
+
+static const int8_t no_os_zstd_of_norm[NO_OS_ZSTD_OF_CODES] = {
+	1, 1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1,
+	1, 1, 1, 1, 1, 1, 1, 1, -1, -1, -1, -1, -1,
+};
+
+/* Literal length codes, RFC 8878 section 3.1.1.3.2.1.1 */
+static const uint32_t no_os_zstd_ll_base[NO_OS_ZSTD_LL_CODES] = {
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+	16, 18, 20, 22, 24, 28, 32, 40, 48, 64, 0x80, 0x100,
+	0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000, 0x8000, 0x10000,
+};
+
+static const uint8_t no_os_zstd_ll_bits[NO_OS_ZSTD_LL_CODES] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 6, 7, 8,
+	9, 10, 11, 12, 13, 14, 15, 16,
+};
+
+/* Match length codes, RFC 8878 section 3.1.1.3.2.1.1 */
+static const uint32_t no_os_zstd_ml_base[NO_OS_ZSTD_ML_CODES] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18,
+	19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34,
+	35, 37, 39, 41, 43, 47, 51, 59, 67, 83, 99, 131, 259, 515,
+	1027, 2051, 4099, 8195, 16387, 32771, 65539,
+};
+
+static const uint8_t no_os_zstd_ml_bits[NO_OS_ZSTD_ML_CODES] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 2, 2, 3, 3, 4, 4, 5, 7, 8, 9,
+	10, 11, 12, 13, 14, 15, 16,
+};
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct no_os_zstd_seq {
+	uint32_t lit_len;
+	uint32_t match_len;
+	uint32_t offset;
+};
+
+/* FSE encoding table built from a predefined distribution, and its state */
+struct no_os_zstd_fse {
+	uint16_t state[64];
+	int16_t find_state[NO_OS_ZSTD_ML_CODES];
+	uint32_t nb_bits[NO_OS_ZSTD_ML_CODES];
+	uint32_t log;
+	uint32_t value;
+};
+
+/* Backward bit stream, the decoder reads it from the end */
+struct no_os_zstd_bits {
+	uint8_t *p;
+	uint8_t *end;
+	uint64_t acc;
+	uint32_t nb;
+};
+
+struct no_os_zstd_work {
+	uint32_t hash[1 << NO_OS_ZSTD_HASH_LOG];
+	struct no_os_zstd_seq seqs[NO_OS_ZSTD_MAX_SEQS];
+	struct no_os_zstd_fse ll;
+	struct no_os_zstd_fse ml;
+	struct no_os_zstd_fse of;
+};
+
+_Static_assert(sizeof(struct no_os_zstd_work) <= NO_OS_ZSTD_WORK_SIZE,
+	       "NO_OS_ZSTD_WORK_SIZE is smaller than the work area");
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static void no_os_zstd_put_le(uint8_t *p, uint32_t val, uint32_t bytes)
+{
+	while (bytes--) {
+		*p++ = val;
+		val >>= 8;
+	}
+}
+
+static void no_os_zstd_add_bits(struct no_os_zstd_bits *b, uint32_t val,
+				uint32_t nb)
+{
+	b->acc |= (uint64_t)(val & (uint32_t)((1ULL << nb) - 1)) << b->nb;
+	b->nb += nb;
+	while (b->nb >= 8) {
+		/* On overflow only count the bytes, checked when closing */
+		if (b->p < b->end)
+			*b->p = b->acc;
+		b->p++;
+		b->acc >>= 8;
+		b->nb -= 8;
+	}
+}
+
+/* Same table as the reference FSE_buildCTable(), for a distribution */
+static void no_os_zstd_fse_build(struct no_os_zstd_fse *t, const int8_t *norm,
+				 uint32_t nb_codes, uint32_t log)
+{
+	uint32_t size = 1 << log;
+	uint32_t step = (size >> 1) + (size >> 3) + 3;
+	uint32_t high = size - 1;
+	uint32_t pos = 0;
+	uint32_t total = 0;
+	uint16_t cumul[NO_OS_ZSTD_ML_CODES + 1];
+	uint8_t symbol[64];
+	uint32_t s, i, out;
+	int32_t cnt;
+
+	/* Low probability symbols go at the end of the table */
+	cumul[0] = 0;
+	for (s = 0; s < nb_codes; s++) {
+		if (norm[s] == -1) {
+			cumul[s + 1] = cumul[s] + 1;
+			symbol[high--] = s;
+		} else {
+			cumul[s + 1] = cumul[s] + norm[s];
+		}
+	}
+
+	for (s = 0; s < nb_codes; s++) {
+		for (cnt = 0; cnt < norm[s]; cnt++) {
+			symbol[pos] = s;
+			do {
+				pos = (pos + step) & (size - 1);
+			} while (pos > high);
+		}
+	}
+
+	for (i = 0; i < size; i++)
+		t->state[cumul[symbol[i]]++] = size + i;
+
+	for (s = 0; s < nb_codes; s++) {
+		cnt = norm[s];
+		if (cnt == -1 || cnt == 1) {
+			t->nb_bits[s] = (log << 16) - size;
+			t->find_state[s] = total - 1;
+			total++;
+		} else {
+			out = log - no_os_find_last_set_bit(cnt - 1);
+			t->nb_bits[s] = (out << 16) - (cnt << out);
+			t->find_state[s] = total - cnt;
+			total += cnt;
+		}
+	}
+
+	t->log = log;
+}
+
+static void no_os_zstd_fse_init(struct no_os_zstd_fse *t, uint32_t code)
+{
+	uint32_t nb = (t->nb_bits[code] + (1 << 15)) >> 16;
+	uint32_t val = (nb << 16) - t->nb_bits[code];
+
+	t->value = t->state[(val >> nb) + t->find_state[code]];
+}
+
+static void no_os_zstd_fse_encode(struct no_os_zstd_bits *b,
+				  struct no_os_zstd_fse *t, uint32_t code)
+{
+	uint32_t nb = (t->value + t->nb_bits[code]) >> 16;
+
+	no_os_zstd_add_bits(b, t->value, nb);
+	t->value = t->state[(t->value >> nb) + t->find_state[code]];
+}
+
+/* Largest code whose baseline is not above val */
+static uint32_t no_os_zstd_code(const uint32_t *base, uint32_t nb_codes,
+				uint32_t val)
+{
+	uint32_t code = nb_codes - 1;
+
+	while (base[code] > val)
+		code--;
+
+	return code;
+}
+
+static uint32_t no_os_zstd_hash(const uint8_t *p)
+{
+	uint32_t val = p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+
+	return (val * 2654435761U) >> (32 - NO_OS_ZSTD_HASH_LOG);
+}
+
+/*
+ * Greedy match search from pos to *end. Matches may reference any earlier
+ * position of the frame. *end is moved back to the end of the last match
+ * when the sequence table is full.
+ */
+static uint32_t no_os_zstd_parse(struct no_os_zstd_work *w, const uint8_t *src,
+				 uint32_t pos, uint32_t *end)
+{
+	uint32_t anchor = pos;
+	uint32_t nb_seqs = 0;
+	uint32_t cand, len, h;
+
+	while (pos + NO_OS_ZSTD_MIN_MATCH <= *end &&
+	       nb_seqs < NO_OS_ZSTD_MAX_SEQS) {
+		h = no_os_zstd_hash(src + pos);
+		cand = w->hash[h];
+		w->hash[h] = pos;
+		if (cand >= pos ||
+		    memcmp(src + cand, src + pos, NO_OS_ZSTD_MIN_MATCH)) {
+			pos++;
+			continue;
+		}
+
+		len = NO_OS_ZSTD_MIN_MATCH;
+		while (pos + len < *end && src[cand + len] == src[pos + len])
+			len++;
+
+		w->seqs[nb_seqs].lit_len = pos - anchor;
+		w->seqs[nb_seqs].match_len = len;
+		w->seqs[nb_seqs].offset = pos - cand;
+		nb_seqs++;
+		pos += len;
+		anchor = pos;
+	}
+
+	if (nb_seqs == NO_OS_ZSTD_MAX_SEQS)
+		*end = anchor;
+
+	return nb_seqs;
+}
+
+/*
+ * Compressed block content: raw literals, then the sequences encoded with the
+ * predefined tables. Returns the size or -ENOSPC if it doesn't fit in limit.
+ */
+static int32_t no_os_zstd_write_comp(struct no_os_zstd_work *w,
+				     const uint8_t *src, uint32_t pos,
+				     uint32_t end, uint32_t nb_seqs,
+				     uint8_t *out, uint32_t limit)
+{
+	struct no_os_zstd_bits b = { 0 };
+	struct no_os_zstd_seq *seq;
+	uint32_t ll, ml, of, i;
+	uint32_t lit = end - pos;
+	uint32_t n;
+
+	for (i = 0; i < nb_seqs; i++)
+		lit -= w->seqs[i].match_len;
+
+	/* Literals section header and content */
+	n = 1 + (lit > 31) + (lit > 4095);
+	if (n + lit + 4 > limit)
+		return -ENOSPC;
+
+	/* Raw literals, size format depends on the header size */
+	if (n == 1)
+		out[0] = lit << 3;
+	else
+		no_os_zstd_put_le(out, (n == 2 ? 0x4 : 0xC) | lit << 4, n);
+
+	for (i = 0; i < nb_seqs; i++) {
+		memcpy(out + n, src + pos, w->seqs[i].lit_len);
+		n += w->seqs[i].lit_len;
+		pos += w->seqs[i].lit_len + w->seqs[i].match_len;
+	}
+	memcpy(out + n, src + pos, end - pos);
+	n += end - pos;
+
+	/* Sequences section header, all the tables are predefined */
+	if (nb_seqs < 128) {
+		out[n++] = nb_seqs;
+	} else {
+		out[n++] = (nb_seqs >> 8) + 0x80;
+		out[n++] = nb_seqs;
+	}
+	if (!nb_seqs)
+		return n;
+	out[n++] = 0;
+
+	/* The sequences are encoded from the last one to the first one */
+	b.p = out + n;
+	b.end = out + limit;
+	i = nb_seqs;
+	while (i--) {
+		seq = &w->seqs[i];
+		ll = no_os_zstd_code(no_os_zstd_ll_base, NO_OS_ZSTD_LL_CODES,
+				     seq->lit_len);
+		ml = no_os_zstd_code(no_os_zstd_ml_base, NO_OS_ZSTD_ML_CODES,
+				     seq->match_len);
+		of = no_os_find_last_set_bit(seq->offset + 3);
+
+		if (i == nb_seqs - 1) {
+			no_os_zstd_fse_init(&w->ml, ml);
+			no_os_zstd_fse_init(&w->of, of);
+			no_os_zstd_fse_init(&w->ll, ll);
+		} else {
+			no_os_zstd_fse_encode(&b, &w->of, of);
+			no_os_zstd_fse_encode(&b, &w->ml, ml);
+			no_os_zstd_fse_encode(&b, &w->ll, ll);
+		}
+
+		no_os_zstd_add_bits(&b, seq->lit_len - no_os_zstd_ll_base[ll],
+				    no_os_zstd_ll_bits[ll]);
+		no_os_zstd_add_bits(&b, seq->match_len - no_os_zstd_ml_base[ml],
+				    no_os_zstd_ml_bits[ml]);
+		no_os_zstd_add_bits(&b, seq->offset + 3 - (1 << of), of);
+	}
+
+	no_os_zstd_add_bits(&b, w->ml.value, w->ml.log);
+	no_os_zstd_add_bits(&b, w->of.value, w->of.log);
+	no_os_zstd_add_bits(&b, w->ll.value, w->ll.log);
+
+	/* End mark, then the last partial byte */
+	no_os_zstd_add_bits(&b, 1, 1);
+	if (b.nb)
+		no_os_zstd_add_bits(&b, 0, 8 - b.nb);
+	if (b.p > b.end)
+		return -ENOSPC;
+
+	return b.p - out;
+}
+
+/* Write one block, compressed if that is smaller than the raw data */
+static int32_t no_os_zstd_block(struct no_os_zstd_work *w, const uint8_t *src,
+				uint32_t pos, uint32_t len, uint8_t *out,
+				uint32_t out_len, uint32_t *consumed)
+{
+	uint32_t end = no_os_min(len, pos + NO_OS_ZSTD_BLOCK_MAX);
+	uint32_t nb_seqs, raw, type;
+	int32_t size;
+
+	if (out_len < NO_OS_ZSTD_BLOCK_HDR)
+		return -ENOSPC;
+	out_len -= NO_OS_ZSTD_BLOCK_HDR;
+
+	nb_seqs = no_os_zstd_parse(w, src, pos, &end);
+	raw = end - pos;
+
+	size = no_os_zstd_write_comp(w, src, pos, end, nb_seqs,
+				     out + NO_OS_ZSTD_BLOCK_HDR,
+				     no_os_min(out_len, raw));
+	if (size >= 0 && (uint32_t)size < raw) {
+		type = NO_OS_ZSTD_BLOCK_COMP;
+	} else {
+		if (out_len < raw)
+			return -ENOSPC;
+		memcpy(out + NO_OS_ZSTD_BLOCK_HDR, src + pos, raw);
+		size = raw;
+		type = NO_OS_ZSTD_BLOCK_RAW;
+	}
+
+	no_os_zstd_put_le(out, (end == len) | type << 1 | size << 3,
+			  NO_OS_ZSTD_BLOCK_HDR);
+	*consumed = raw;
+
+	return size + NO_OS_ZSTD_BLOCK_HDR;
+}
+
+/**
+ * @brief Compress a buffer into a single Zstandard frame.
+ *
+ * The frame records the content size and has no checksum. The literals are
+ * stored raw and the matches are encoded with the predefined tables, which
+ * is enough for repetitive text such as the IIO context xml. The work area,
+ * at most NO_OS_ZSTD_WORK_SIZE bytes, is allocated for the duration of the
+ * call.
+ *
+ * @param src - Data to be compressed.
+ * @param len - Size of src in bytes.
+ * @param dst - Output buffer.
+ * @param dst_len - Size of dst, NO_OS_ZSTD_BOUND(len) is always enough.
+ * @return Size of the frame in bytes, or negative error code.
+ */
+int32_t no_os_zstd_compress(const void *src, uint32_t len, void *dst,
+			    uint32_t dst_len)
+{
+	struct no_os_zstd_work *w;
+	uint8_t *out = dst;
+	uint32_t pos = 0;
+	uint32_t consumed;
+	int32_t n, ret;
+
+	if (!src || !dst)
+		return -EINVAL;
+
+	if (dst_len < NO_OS_ZSTD_FRAME_HDR)
+		return -ENOSPC;
+
+	w = no_os_calloc(1, sizeof(*w));
+	if (!w)
+		return -ENOMEM;
+
+	no_os_zstd_fse_build(&w->ll, no_os_zstd_ll_norm, NO_OS_ZSTD_LL_CODES,
+			     NO_OS_ZSTD_LL_LOG);
+	no_os_zstd_fse_build(&w->ml, no_os_zstd_ml_norm, NO_OS_ZSTD_ML_CODES,
+			     NO_OS_ZSTD_ML_LOG);
+	no_os_zstd_fse_build(&w->of, no_os_zstd_of_norm, NO_OS_ZSTD_OF_CODES,
+			     NO_OS_ZSTD_OF_LOG);
+
+	no_os_zstd_put_le(out, NO_OS_ZSTD_MAGIC, 4);
+	out[4] = NO_OS_ZSTD_FHD;
+	no_os_zstd_put_le(out + 5, len, 4);
+	n = NO_OS_ZSTD_FRAME_HDR;
+
+	do {
+		ret = no_os_zstd_block(w, src, pos, len, out + n, dst_len - n,
+				       &consumed);
+		if (ret < 0)
+			goto free_work;
+		n += ret;
+		pos += consumed;
+	} while (pos < len);
+
+	ret = n;
+free_work:
+	no_os_free(w);
+
+	return ret;
+}